@@ -41,8 +41,45 @@ LD:=$(ARCHTUPLE)g++
 OBJCOPY:=$(ARCHTUPLE)objcopy
 SIZETOOL:=$(ARCHTUPLE)size
 READELF:=$(ARCHTUPLE)readelf
+NM:=$(ARCHTUPLE)nm
 STRIP:=$(ARCHTUPLE)strip
 
+# Release profile (PROFILE=release in the Makefile; the default is debug, the flags above)
+# -O3 and LTO; -ffat-lto-objects keeps regular code in every object, so the cold package is linked
+# without LTO (its exported symbols stay as they are for the hot package) and the prebuilt libpros.a
+# and okapilib.a link as before. The math flags keep IEEE results (std::isfinite, NaN checks, signed
+# zeros for atan2): only errno and FP trap semantics are dropped, so sqrt and friends inline.
+# PROFILE_RELEASE enables HOT_PATH placement (refer to mathUtils.hpp).
+# The project's C++ files are built without exceptions and RTTI (LEAN_CXXFLAGS): the motion library throws
+# nothing and asks no object for its type, so the landing pads and type info only cost flash. The files of
+# FULL_CXX_SRC (in the Makefile: code calling into okapi, which throws) keep both, and parse main.h instead
+# of the precompiled header. The prebuilt libraries are unchanged; unused sections go with --gc-sections.
+ifeq ($(PROFILE),release)
+MFLAGS:=$(filter-out -Os,$(MFLAGS)) -O3 -flto -ffat-lto-objects
+CPPFLAGS+=-DPROFILE_RELEASE
+GCCFLAGS+=-fno-math-errno -fno-trapping-math
+LEAN_CXXFLAGS=-fno-exceptions -fno-rtti
+$(patsubst $(SRCDIR)/%,$(BINDIR)/%.o,$(FULL_CXX_SRC)): private LEAN_CXXFLAGS=
+COLD_LDFLAGS=-fno-lto
+AR:=$(ARCHTUPLE)gcc-ar
+endif
+
+# Allocation tripwire (ALLOC_GUARD in the Makefile): newlib's reentrant allocator, under malloc, new and stdio, is
+# wrapped by allocGuard.cpp
+ifneq ($(ALLOC_GUARD),0)
+CPPFLAGS+=-DALLOC_GUARD=$(ALLOC_GUARD)
+LDFLAGS+=$(call wlprefix,--wrap=_malloc_r --wrap=_calloc_r --wrap=_realloc_r)
+endif
+
+# Per-symbol size report after every link: the sized symbols of the ELF by decreasing size (bytes, nm type,
+# demangled name) in <elf>.symbols.txt, the SYMBOL_REPORT_TOP largest printed
+SYMBOL_REPORT_TOP?=20
+SYMBOLFLAGS=--print-size --size-sort --reverse-sort --radix=d --demangle
+define symbol_report
+@printf "%s\n" "Largest symbols (all in $(basename $1).symbols.txt):"
+-$(VV)$(NM) $(SYMBOLFLAGS) $1 | cut -d' ' -f2- > $(basename $1).symbols.txt && head -n $(SYMBOL_REPORT_TOP) $(basename $1).symbols.txt
+endef
+
 ifneq (, $(shell command -v gnumfmt 2> /dev/null))
 	SIZES_NUMFMT:=| gnumfmt --field=-4 --header $(NUMFMTFLAGS)
 else
@@ -221,16 +258,18 @@ $(MONOLITH_ELF): $(ELF_DEPS) $(LIBRARIES)
 	$(call test_output_2,Linking project with $(ARCHIVE_TEXT_LIST) ,$(LD) $(LDFLAGS) $(ELF_DEPS) $(LDTIMEOBJ) $(call wlprefix,-T$(FWDIR)/v5.ld $(LNK_FLAGS)) -o $@,$(OK_STRING))
 	@echo Section sizes:
 	-$(VV)$(SIZETOOL) $(SIZEFLAGS) $@ $(SIZES_SED) $(SIZES_NUMFMT)
+	$(call symbol_report,$@)
 
 $(COLD_BIN): $(COLD_ELF)
 	$(call test_output_2,Creating cold package binary for $(DEVICE) ,$(OBJCOPY) $< -O binary -R .hot_init $@,$(DONE_STRING))
 
 $(COLD_ELF): $(COLD_LIBRARIES)
 	$(VV)mkdir -p $(dir $@)
-	$(call test_output_2,Creating cold package with $(ARCHIVE_TEXT_LIST) ,$(LD) $(LDFLAGS) $(call wlprefix,--gc-keep-exported --whole-archive $^ -lstdc++ --no-whole-archive) $(call wlprefix,-T$(FWDIR)/v5.ld $(LNK_FLAGS) -o $@),$(OK_STRING))
+	$(call test_output_2,Creating cold package with $(ARCHIVE_TEXT_LIST) ,$(LD) $(LDFLAGS) $(COLD_LDFLAGS) $(call wlprefix,--gc-keep-exported --whole-archive $^ -lstdc++ --no-whole-archive) $(call wlprefix,-T$(FWDIR)/v5.ld $(LNK_FLAGS) -o $@),$(OK_STRING))
 	$(call test_output_2,Stripping cold package ,$(OBJCOPY) --strip-symbol=install_hot_table --strip-symbol=__libc_init_array --strip-symbol=_PROS_COMPILE_DIRECTORY --strip-symbol=_PROS_COMPILE_TIMESTAMP $@ $@, $(DONE_STRING))
 	@echo Section sizes:
 	-$(VV)$(SIZETOOL) $(SIZEFLAGS) $@ $(SIZES_SED) $(SIZES_NUMFMT)
+	$(call symbol_report,$@)
 
 $(HOT_BIN): $(HOT_ELF) $(COLD_BIN)
 	$(call test_output_2,Creating $@ for $(DEVICE) ,$(OBJCOPY) $< -O binary $@,$(DONE_STRING))
@@ -240,6 +279,7 @@ $(HOT_ELF): $(COLD_ELF) $(ELF_DEPS)
 	$(call test_output_2,Linking hot project with $(COLD_ELF) and $(ARCHIVE_TEXT_LIST) ,$(LD) $(LDFLAGS) $(call wlprefix,-nostartfiles -R $<) $(filter-out $<,$^) $(LDTIMEOBJ) $(LIBRARIES) $(call wlprefix,-T$(FWDIR)/v5-hot.ld $(LNK_FLAGS) -o $@),$(OK_STRING))
 	@printf "%s\n" "Section sizes:"
 	-$(VV)$(SIZETOOL) $(SIZEFLAGS) $@ $(SIZES_SED) $(SIZES_NUMFMT)
+	$(call symbol_report,$@)
 
 define asm_rule
 $(BINDIR)/%.$1.o: $(SRCDIR)/%.$1
@@ -258,12 +298,32 @@ $(BINDIR)/%.$1.o: $(SRCDIR)/%.$1 $(DEPDIR)/$(basename $1).d
 endef
 $(foreach cext,$(CEXTS),$(eval $(call c_rule,$(cext))))
 
+# Precompiled main.h (USE_PACKAGE-style switch: set USE_PCH:=1 in the Makefile)
+# GCC looks for main.h.gch in each include directory before main.h, so PCHDIR goes first in the quote
+# path; a TU whose flags do not match the header's falls back to parsing include/main.h (-Winvalid-pch)
+PCHDIR=$(BINDIR)/pch
+PCH=
+PCHINCLUDE=
+ifeq ($(USE_PCH),1)
+PCH=$(PCHDIR)/main.h.gch
+PCHINCLUDE=-iquote"$(PCHDIR)" -Winvalid-pch
+
+$(PCH): $(INCDIR)/main.h $(DEPDIR)/main.h.gch.d
+	$(VV)mkdir -p $(dir $@)
+	$(call test_output_2,Precompiled $< ,$(CXX) -x c++-header $(INCLUDE) $(CXXFLAGS) $(LEAN_CXXFLAGS) $(EXTRA_CXXFLAGS) -MT $@ -MMD -MP -MF $(DEPDIR)/main.h.gch.d -o $@ $<,$(OK_STRING))
+
+.PHONY: pch
+pch: $(PCH)
+
+-include $(DEPDIR)/main.h.gch.d
+endif
+
 define cxx_rule
 $(BINDIR)/%.$1.o: $(SRCDIR)/%.$1
-$(BINDIR)/%.$1.o: $(SRCDIR)/%.$1 $(DEPDIR)/$(basename %).d
+$(BINDIR)/%.$1.o: $(SRCDIR)/%.$1 $(DEPDIR)/$(basename %).d $(PCH)
 	$(VV)mkdir -p $$(dir $$@)
 	$(MAKEDEPFOLDER)
-	$$(call test_output_2,Compiled $$< ,$(CXX) -c $(INCLUDE) -iquote"$(INCDIR)/$$(dir $$*)" $(CXXFLAGS) $(EXTRA_CXXFLAGS) $(DEPFLAGS) -o $$@ $$<,$(OK_STRING))
+	$$(call test_output_2,Compiled $$< ,$(CXX) -c $(PCHINCLUDE) $(INCLUDE) -iquote"$(INCDIR)/$$(dir $$*)" $(CXXFLAGS) $$(LEAN_CXXFLAGS) $(EXTRA_CXXFLAGS) $(DEPFLAGS) -o $$@ $$<,$(OK_STRING))
 	$(RENAMEDEPENDENCYFILE)
 endef
 $(foreach cxxext,$(CXXEXTS),$(eval $(call cxx_rule,$(cxxext))))
@@ -1,6 +1,6 @@
 /**
  * Overall API header file for the 8059MotionProfileLib
- * Includes header files for: baseControl, baseOdometry, mathUtils, structs, auton_sets
+ * Includes header files for: baseControl, baseOdometry, mathUtils, structs, auton_sets, timeUtils, scheduler, seqlock, inlineFunction, motionProfile, trajectoryCache, purePursuit, motionQueue, settleDetector, fixedPoint, poseHistory, telemetry, serialProtocol, flightRecorder, controllerDisplay, controllerService, inputMacro, taskTiming, timeline, paramTable, benchmark, resourceMonitor, taskConfig, taskRegistry, velocityController, inputService, stallDetector, impactDetector, motorOutput, drivetrain, gainSchedule, gainTuner, latencyProbe, baseModel, baseCharacterizer, robotConfig, driverInput, autonSelector, dashboard, autonScript, staticRoutine, actionGroup, pathPlanner, fieldIndex, motionArena, splinePath, visionService, matrix, poseEstimator, ramsete, bootSequence, devices, motorHealth, motorSnapshot, batteryModel, dryRun, trajectoryStream, poseCheckpoint
  */
 #ifndef _8059_MOTION_PROFILE_LIB_API_HPP_
 #define _8059_MOTION_PROFILE_LIB_API_HPP_
@@ -9,5 +9,84 @@
 #include "8059MotionProfileLib/include/mathUtils.hpp"
 #include "8059MotionProfileLib/include/structs.hpp"
 #include "8059MotionProfileLib/include/auton_sets.hpp"
+#include "8059MotionProfileLib/include/timeUtils.hpp"
+#include "8059MotionProfileLib/include/scheduler.hpp"
+#include "8059MotionProfileLib/include/seqlock.hpp"
+#include "8059MotionProfileLib/include/inlineFunction.hpp"
+#include "8059MotionProfileLib/include/mailbox.hpp"
+#include "8059MotionProfileLib/include/motionProfile.hpp"
+#include "8059MotionProfileLib/include/trajectoryCache.hpp"
+#include "8059MotionProfileLib/include/learnedFeedforward.hpp"
+#include "8059MotionProfileLib/include/purePursuit.hpp"
+#include "8059MotionProfileLib/include/matchClock.hpp"
+#include "8059MotionProfileLib/include/motionQueue.hpp"
+#include "8059MotionProfileLib/include/settleDetector.hpp"
+#include "8059MotionProfileLib/include/fixedPoint.hpp"
+#include "8059MotionProfileLib/include/poseHistory.hpp"
+#include "8059MotionProfileLib/include/telemetry.hpp"
+#include "8059MotionProfileLib/include/serialProtocol.hpp"
+#include "8059MotionProfileLib/include/flightRecorder.hpp"
+#include "8059MotionProfileLib/include/controllerDisplay.hpp"
+#include "8059MotionProfileLib/include/controllerService.hpp"
+#include "8059MotionProfileLib/include/inputMacro.hpp"
+#include "8059MotionProfileLib/include/taskTiming.hpp"
+#include "8059MotionProfileLib/include/timeline.hpp"
+#include "8059MotionProfileLib/include/paramTable.hpp"
+#include "8059MotionProfileLib/include/configFile.hpp"
+#include "8059MotionProfileLib/include/benchmark.hpp"
+#include "8059MotionProfileLib/include/resourceMonitor.hpp"
+#include "8059MotionProfileLib/include/allocGuard.hpp"
+#include "8059MotionProfileLib/include/taskConfig.hpp"
+#include "8059MotionProfileLib/include/taskRegistry.hpp"
+#include "8059MotionProfileLib/include/velocityController.hpp"
+#include "8059MotionProfileLib/include/inputService.hpp"
+#include "8059MotionProfileLib/include/stallDetector.hpp"
+#include "8059MotionProfileLib/include/impactDetector.hpp"
+#include "8059MotionProfileLib/include/motorOutput.hpp"
+#include "8059MotionProfileLib/include/drivetrain.hpp"
+#include "8059MotionProfileLib/include/gainSchedule.hpp"
+#include "8059MotionProfileLib/include/gainTuner.hpp"
+#include "8059MotionProfileLib/include/tuningPanel.hpp"
+#include "8059MotionProfileLib/include/latencyProbe.hpp"
+#include "8059MotionProfileLib/include/baseModel.hpp"
+#include "8059MotionProfileLib/include/baseCharacterizer.hpp"
+#include "8059MotionProfileLib/include/lqrGains.hpp"
+#include "8059MotionProfileLib/include/robotConfig.hpp"
+#include "8059MotionProfileLib/include/driverInput.hpp"
+#include "8059MotionProfileLib/include/autonSelector.hpp"
+#include "8059MotionProfileLib/include/dashboard.hpp"
+#include "8059MotionProfileLib/include/autonScript.hpp"
+#include "8059MotionProfileLib/include/staticRoutine.hpp"
+#include "8059MotionProfileLib/include/actionGroup.hpp"
+#include "8059MotionProfileLib/include/pathPlanner.hpp"
+#include "8059MotionProfileLib/include/latticePlanner.hpp"
+#include "8059MotionProfileLib/include/fieldIndex.hpp"
+#include "8059MotionProfileLib/include/motionArena.hpp"
+#include "8059MotionProfileLib/include/splinePath.hpp"
+#include "8059MotionProfileLib/include/visionService.hpp"
+#include "8059MotionProfileLib/include/matrix.hpp"
+#include "8059MotionProfileLib/include/poseEstimator.hpp"
+#include "8059MotionProfileLib/include/ramsete.hpp"
+#include "8059MotionProfileLib/include/mpcTracker.hpp"
+#include "8059MotionProfileLib/include/moveToPose.hpp"
+#include "8059MotionProfileLib/include/bootSequence.hpp"
+#include "8059MotionProfileLib/include/devices.hpp"
+#include "8059MotionProfileLib/include/motorHealth.hpp"
+#include "8059MotionProfileLib/include/motorSnapshot.hpp"
+#include "8059MotionProfileLib/include/batteryModel.hpp"
+#include "8059MotionProfileLib/include/currentBudget.hpp"
+#include "8059MotionProfileLib/include/routeOptimizer.hpp"
+#include "8059MotionProfileLib/include/tickVelocity.hpp"
+#include "8059MotionProfileLib/include/filterPipeline.hpp"
+#include "8059MotionProfileLib/include/watchdog.hpp"
+#include "8059MotionProfileLib/include/chassisBackend.hpp"
+#include "8059MotionProfileLib/include/units.hpp"
+#include "8059MotionProfileLib/include/chassisModel.hpp"
+#include "8059MotionProfileLib/include/coprocessor.hpp"
+#include "8059MotionProfileLib/include/bakedTrajectories.hpp"
+#include "8059MotionProfileLib/include/precompute.hpp"
+#include "8059MotionProfileLib/include/dryRun.hpp"
+#include "8059MotionProfileLib/include/trajectoryStream.hpp"
+#include "8059MotionProfileLib/include/poseCheckpoint.hpp"
 
 #endif
@@ -0,0 +1,80 @@
+/**
+ * Header file for actionGroup.cpp
+ * Defines class ActionGroup that overlaps mechanism actions with the queued motions of an autonomous
+ * routine: every action starts when its trigger holds (distance into a motion, end of a motion, shooter
+ * at speed, ball count, time), while the base keeps driving the motion queue
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_ACTION_GROUP_HPP_
+#define _8059_MOTION_PROFILE_LIB_ACTION_GROUP_HPP_
+#include "8059MotionProfileLib/include/inlineFunction.hpp"
+#include <cstdint>
+// Maximum number of actions in a group
+#define ACTION_GROUP_SIZE 8
+// Poll period of the triggers in ms
+#define ACTION_POLL_DT 10
+/** Conditions that start an action or end a race */
+enum TriggerType{
+  TRIGGER_NOW,            // at once
+  TRIGGER_TIME,           // value ms after the group started running
+  TRIGGER_TRAVEL,         // value inches travelled into motion `motion` (or once it has ended)
+  TRIGGER_MOTION_DONE,    // motion `motion` has ended
+  TRIGGER_QUEUE_IDLE,     // every queued motion has ended
+  TRIGGER_SHOOTER_READY,  // the shooter is at speed
+  TRIGGER_BALLS           // the robot holds at least value balls
+};
+/**
+ * A trigger
+ * type: condition (refer to TriggerType)
+ * motion: motion of TRIGGER_TRAVEL & TRIGGER_MOTION_DONE, numbered from 0 in queueing order
+ *   from the creation of the group
+ * value: parameter of the condition
+ */
+struct ActionTrigger{
+  TriggerType type;
+  int motion;
+  double value;
+};
+/** An action of a group: started once, when its trigger first holds */
+struct GroupAction{
+  ActionTrigger trigger;
+  InlineFunction<void()> start;
+  bool started;
+};
+/**
+ * refer to actionGroup.cpp for function documentation
+ */
+ActionTrigger atOnce();
+ActionTrigger afterTime(uint32_t ms);
+ActionTrigger afterTravel(int motion, double inches);
+ActionTrigger afterMotion(int motion);
+ActionTrigger whenQueueIdle();
+ActionTrigger whenShooterReady();
+ActionTrigger whenBalls(int count);
+/**
+ * The class ActionGroup holds actions and their triggers. Create it before queueing the motions
+ * its triggers refer to, then run it in parallel (until every action has started and the queue is idle)
+ * or as a race (until a finish trigger holds, which stops the base).
+ */
+class ActionGroup{
+public:
+  /**
+   * refer to actionGroup.cpp for function documentation
+   */
+  ActionGroup();
+  bool add(const ActionTrigger &trigger, InlineFunction<void()> start);
+  bool runParallel(uint32_t timeout);
+  bool runRace(const ActionTrigger &finish, uint32_t timeout);
+private:
+  bool poll();
+  bool holds(const ActionTrigger &trigger);
+  GroupAction actions[ACTION_GROUP_SIZE];
+  int count;
+  /** number of the group's motion 0 (refer to getMotionSequence) */
+  uint32_t firstMotion;
+  /** start of the run (millis), motion being tracked and the distance travelled into it */
+  uint32_t runStart;
+  int64_t travelMotion;
+  double travelled, prevX, prevY;
+};
+
+#endif
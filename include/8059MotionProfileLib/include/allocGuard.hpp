@@ -0,0 +1,45 @@
+/**
+ * Header file for allocGuard.cpp
+ * Defines the allocation tripwire: a build mode (`make ALLOC_GUARD=1`, or `make sim ALLOC_GUARD=1`) that
+ * wraps the heap allocator at link time, counts the allocations of every task and flags each one made
+ * by a real-time task once initialize() has returned, so the loops stay free of heap calls (and of the
+ * lock and the unbounded search time of the allocator) as features are added
+ * Allocations made before the guard is armed (initialize(), the tasks' first iterations) are only counted.
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_ALLOC_GUARD_HPP_
+#define _8059_MOTION_PROFILE_LIB_ALLOC_GUARD_HPP_
+#include "8059MotionProfileLib/include/taskTiming.hpp"
+#include <cstdint>
+/**
+ * ALLOC_GUARD (set by the Makefile): 0: off (no wrapper is linked); 1: count, and log the flagged allocations
+ * (resource monitor, on stderr); 2: also stop the program at the first flagged allocation (trap: the brain
+ * shows the backtrace of the allocating call, the simulation gets SIGILL)
+ */
+#ifndef ALLOC_GUARD
+#define ALLOC_GUARD 0
+#endif
+// Real-time tasks (bits of TimedTask): those at the sensing, control and mechanism priorities
+#define ALLOC_GUARD_TASK_MASK ((1u << TIMING_ODOMETRY) | (1u << TIMING_CONTROL) | (1u << TIMING_SHOOTER) \
+  | (1u << TIMING_CONTROLLER) | (1u << TIMING_INPUT) | (1u << TIMING_VISION))
+/**
+ * Allocation counts
+ * tasks: allocations of each watched task (refer to watchTaskStack), indexed by TimedTask
+ * other: allocations of the other tasks (competition tasks, boot stages, LVGL)
+ * flagged: allocations of the real-time tasks since the guard was armed
+ * flaggedTask & flaggedSize: task (TimedTask) and size in bytes of the last flagged allocation
+ */
+struct AllocCounts{
+  uint32_t tasks[TIMING_TASKS];
+  uint32_t other, flagged;
+  int flaggedTask;
+  uint32_t flaggedSize;
+};
+/**
+ * refer to allocGuard.cpp for function documentation
+ */
+void armAllocGuard();
+AllocCounts getAllocCounts();
+void reportAllocGuard();
+void printAllocCounts();
+
+#endif
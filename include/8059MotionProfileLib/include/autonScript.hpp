@@ -0,0 +1,73 @@
+/**
+ * Header file for autonScript.cpp
+ * Defines autonomous scripts: a routine written as text on the microSD card, compiled before the match
+ * into a compact bytecode and run by an interpreter that feeds the motion command queue, so a route
+ * changes without a new upload
+ *
+ * Script format: one command per line, arguments separated by spaces, '#' starts a comment
+ * (read by ConfigFile, so the script holds at most CONFIG_FILE_SIZE bytes)
+ *   move <in>                 queueMove
+ *   moveto <x> <y>            queueMoveTo
+ *   turn <deg>                queueTurn
+ *   turnto <x> <y> [reverse]  queueTurnTo
+ *   turnby <deg>              queueTurnRelative
+ *   arc <radius> <deg>        queueArc
+ *   arcto <x> <y>             queueArcTo
+ *   swing <deg> <left|right>  queueSwing (the side held in place)
+ *   movepose <x> <y> <deg> [reverse]  queueMoveToPose
+ *   exit <in> <ms>            setMotionEarlyExit (of the following motions; exit 0 0: off)
+ *   by <ms>                   setNextMotionDeadline (match time, of the next motion)
+ *   optional <ms>             setNextMotionOptional (estimate, of the next motion)
+ *   follow <trajectory>       queueTrajectory (the trajectory must be generated before the compilation)
+ *   intake <power>            intakeMove (-127 to 127)
+ *   cycle                     cycle
+ *   sort <red|blue|none>      setSortColor
+ *   wait queue <ms>           waitMotionQueue
+ *   wait balls <count> <ms>   waitBallCount
+ *   wait shooter <ms>         waitShooter
+ *   delay <ms>                delay
+ * Distances (inches) and angles (degrees) are kept to 0.01 within +-327.67.
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_AUTON_SCRIPT_HPP_
+#define _8059_MOTION_PROFILE_LIB_AUTON_SCRIPT_HPP_
+#include <cstdint>
+// Script of the "Script" routine (refer to auton_sets.cpp)
+#ifndef SCRIPT_PATH
+#define SCRIPT_PATH "/usd/auton.txt"
+#endif
+// Size of the bytecode in bytes (a command takes 1 to 8)
+#define SCRIPT_MAX_CODE 1024
+/** Instructions: an opcode byte followed by its operands (refer to scriptCommands in autonScript.cpp) */
+enum ScriptOp{
+  SCRIPT_END,
+  SCRIPT_MOVE,
+  SCRIPT_MOVE_TO,
+  SCRIPT_TURN,
+  SCRIPT_TURN_TO,
+  SCRIPT_TURN_RELATIVE,
+  SCRIPT_ARC,
+  SCRIPT_ARC_TO,
+  SCRIPT_SWING,
+  SCRIPT_MOVE_TO_POSE,
+  SCRIPT_EARLY_EXIT,
+  SCRIPT_DEADLINE,
+  SCRIPT_OPTIONAL,
+  SCRIPT_FOLLOW,
+  SCRIPT_INTAKE,
+  SCRIPT_CYCLE,
+  SCRIPT_SORT,
+  SCRIPT_WAIT_QUEUE,
+  SCRIPT_WAIT_BALLS,
+  SCRIPT_WAIT_SHOOTER,
+  SCRIPT_DELAY,
+  SCRIPT_OPS
+};
+/**
+ * refer to autonScript.cpp for function documentation
+ */
+bool compileAutonScript(const char *path);
+void prepareAutonScript();
+int getAutonScriptSize();
+void runAutonScript();
+
+#endif
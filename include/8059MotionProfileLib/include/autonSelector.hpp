@@ -0,0 +1,33 @@
+/**
+ * Header file for autonSelector.cpp
+ * Defines the autonomous selector: a button matrix of the routines (auton_sets.cpp) on the brain
+ * screen during competition_initialize(); the chosen routine's trajectories and gains are prepared
+ * right away in the background (refer to precompute.hpp), so autonomous() starts moving on its first tick
+ * The selector is part of the cold package (the library), the routines of the hot package; the table
+ * is handed over by setAutonRoutines, so editing a routine only rebuilds and uploads the hot package
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_AUTON_SELECTOR_HPP_
+#define _8059_MOTION_PROFILE_LIB_AUTON_SELECTOR_HPP_
+// Routine selected at boot (index into the routine table), before anything is pressed
+#define AUTON_DEFAULT 0
+// Most routines the selector shows (size of its button map, fixed in the cold package)
+#define AUTON_SELECTOR_MAX 12
+// Buttons per row of the selector
+#define AUTON_SELECTOR_COLUMNS 3
+/**
+ * refer to autonSelector.cpp for function documentation
+ */
+void setAutonRoutines(const AutonRoutine *table, int count);
+int getAutonCount();
+const char *getAutonName(int id);
+void prepareAuton(int id);
+void buildAutonSelector();
+void showAutonSelector();
+void updateAutonSelector();
+void setSelectedAuton(int id);
+int getSelectedAuton();
+int getPreparedAuton();
+void runSelectedAuton();
+void runAuton(int id);
+
+#endif
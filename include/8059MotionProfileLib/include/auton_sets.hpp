@@ -1,9 +1,31 @@
 /**
  * Header file for auton_sets.cpp
- * Defines sets of autonomous routines
+ * Defines sets of autonomous routines and the table the selector (autonSelector.cpp) shows
+ * (hot package: the routines change between matches, the library they call does not)
  */
 #ifndef _8059_MOTION_PROFILE_LIB_AUTON_SETS_HPP_
 #define _8059_MOTION_PROFILE_LIB_AUTON_SETS_HPP_
+#include "mech_lib.hpp"
+// Number of entries of autonRoutines
+#define AUTON_COUNT 12
+/**
+ * An autonomous routine
+ * name: text of its selector button
+ * prepare: loads its data (generates its trajectories) before the match; NULL if it has none
+ * run: the routine
+ * sortColor: alliance ball color to keep (BALL_NONE: keep the current sort color)
+ */
+struct AutonRoutine{
+  const char *name;
+  void (*prepare)();
+  void (*run)();
+  BallColor sortColor;
+};
+extern const AutonRoutine autonRoutines[AUTON_COUNT];
+extern const uint8_t *const trajectoryBlob;
+extern const uint32_t trajectoryBlobSize;
+void skillsTrajectories();
+void scriptTrajectories();
 void skills();
 void blueLeft();
 void blueRight();
@@ -0,0 +1,57 @@
+/**
+ * Header file for bakedTrajectories.cpp
+ * Defines the baked trajectories: a host step (`make bake`, `./bin/sim bake <file>`) prepares every routine in the
+ * simulation and packs the trajectories they generate, with the skills route, into a blob that the next build
+ * links into the hot package as read-only data (TRAJECTORY_BLOB_PATH, refer to auton_sets.cpp). At boot
+ * generateTrajectory finds a trajectory there by the hash of its inputs and points the cache at it (no generation,
+ * no microSD card, no arena space), and prepareRoute takes the baked route instead of parsing the route file.
+ * A trajectory whose inputs changed since the bake (waypoints, limits, base width, refer to hashTrajectory)
+ * is not found, and is generated as before.
+ * The blob is keyed by content: trajectories of the same inputs under other names (a renamed one, a path shared
+ * by two routines) are the same entry, and a bake reuses the entries of the previous blob whose inputs did not
+ * change, so only the edited trajectories are generated again.
+ *
+ * Blob layout (little endian on the computer and the V5, 8 byte aligned):
+ *   BakedHeader, BakedTrajectory[count], then each trajectory's left and right PackedSegment arrays and its
+ *   PackedPose array, from its offset
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_BAKED_TRAJECTORIES_HPP_
+#define _8059_MOTION_PROFILE_LIB_BAKED_TRAJECTORIES_HPP_
+#include <cstdint>
+#define BAKED_MAGIC 0x454B4142
+// Longest trajectory name in a blob, with its terminator
+#define BAKED_NAME_SIZE 24
+// Most trajectories of a blob (those of every routine)
+#define BAKED_MAX_TRAJECTORIES 64
+/**
+ * Header of a blob
+ * magic: BAKED_MAGIC; version: TRAJECTORY_FILE_VERSION of the bake (another version is ignored)
+ * count: number of trajectories
+ * hasRoute, route: the skills route the legs were generated from (refer to prepareRoute)
+ */
+struct BakedHeader{
+  uint32_t magic, version;
+  int32_t count, hasRoute;
+  SkillsRoute route;
+};
+/**
+ * A trajectory of a blob (refer to CachedTrajectory)
+ * name: the name it was first baked under (for listings only; the blob is looked up by hash)
+ * offset: bytes from the start of the blob to its segments and poses
+ */
+struct BakedTrajectory{
+  char name[BAKED_NAME_SIZE];
+  uint32_t hash;
+  int32_t length;
+  float dt, velScale, accScale;
+  uint32_t offset;
+};
+/**
+ * refer to bakedTrajectories.cpp for function documentation
+ */
+bool setBakedTrajectories(const void *blob, uint32_t size);
+bool findBakedTrajectory(const char *name, uint32_t hash, CachedTrajectory &trajectory);
+const SkillsRoute *getBakedRoute();
+int bakeTrajectories(const char *path, int routines, int *reused = NULL);
+
+#endif
@@ -0,0 +1,72 @@
+/**
+ * Header file for baseCharacterizer.cpp
+ * Defines the system identification of the base: quasistatic ramps and steps of the base power,
+ * fitted per side by least squares to power = kS*sgn(v) + kV*v + kA*a, and spins in place that
+ * give the effective track widths; the result becomes the base model (refer to baseModel.hpp)
+ * Also defines the calibration of the odometry geometry from drives between two field walls and
+ * whole turns in place, both ended by squaring to a wall (refer to calibrateOdometry)
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_BASE_CHARACTERIZER_HPP_
+#define _8059_MOTION_PROFILE_LIB_BASE_CHARACTERIZER_HPP_
+#include "8059MotionProfileLib/include/baseModel.hpp"
+#include "8059MotionProfileLib/include/matrix.hpp"
+/**
+ * Characterization run (refer to characterizeBase); every test runs forwards, then backwards
+ * SYSID_DT: sample period in ms (the accelerations are second differences of the motor encoders)
+ * SYSID_RAMP_RATE & SYSID_RAMP_TIME: quasistatic test, the power grows by SYSID_RAMP_RATE per second
+ * for SYSID_RAMP_TIME ms (slow enough for the acceleration term to vanish)
+ * SYSID_STEP_POWER & SYSID_STEP_TIME: step test (the acceleration term)
+ * SYSID_TURN_POWER & SYSID_TURN_TIME: spin in place (the track widths)
+ * SYSID_REST: pause in ms between the tests, so each starts from rest
+ * SYSID_MIN_VEL: samples slower than this (in/s) are left out of the fit (static friction)
+ */
+#define SYSID_DT 20
+#define SYSID_RAMP_RATE 6
+#define SYSID_RAMP_TIME 4000
+#define SYSID_STEP_POWER 60
+#define SYSID_STEP_TIME 1000
+#define SYSID_TURN_POWER 40
+#define SYSID_TURN_TIME 2000
+#define SYSID_REST 500
+#define SYSID_MIN_VEL 0.5
+/**
+ * Odometry calibration (refer to calibrateOdometry)
+ * ODOM_CAL_WALL_POWER & ODOM_CAL_WALL_TIMEOUT: power and time limit (ms) of baseSquareToWall at each wall
+ * ODOM_CAL_APPROACH: the base drives to this many inches short of the far wall, then squares to it
+ * ODOM_CAL_SETTLE: time limit (ms) of a drive across the field
+ * ODOM_CAL_CLEARANCE: inches the base moves off the wall before a spin (its corners clear the wall)
+ * ODOM_CAL_TURNS & ODOM_CAL_TURN_POWER: whole turns of each spin and power of the spins
+ * ODOM_CAL_SPIN_TIMEOUT: time limit (ms) of a spin
+ */
+#define ODOM_CAL_WALL_POWER 50
+#define ODOM_CAL_WALL_TIMEOUT 3000
+#define ODOM_CAL_APPROACH 6
+#define ODOM_CAL_SETTLE 6000
+#define ODOM_CAL_CLEARANCE 12
+#define ODOM_CAL_TURNS 3
+#define ODOM_CAL_TURN_POWER 60
+#define ODOM_CAL_SPIN_TIMEOUT 15000
+/**
+ * Least squares fit of one side: the normal equations of power = kS*sgn(v) + kV*v + kA*a,
+ * accumulated sample by sample (so the run logs nothing but these sums)
+ */
+class FeedforwardFit{
+public:
+  /**
+   * refer to baseCharacterizer.cpp for function documentation
+   */
+  void addSample(double power, double vel, double acc);
+  bool solve(BaseFeedforward &feedforward) const;
+  int getSamples() const;
+private:
+  Matrix<3, 3> normal = {};
+  Matrix<3, 1> moment = {};
+  int samples = 0;
+};
+/**
+ * refer to baseCharacterizer.cpp for function documentation
+ */
+void characterizeBase();
+void calibrateOdometry();
+
+#endif
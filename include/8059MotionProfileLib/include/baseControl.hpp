@@ -1,40 +1,413 @@
 /**
  * Header file for baseControl.cpp
- * Defines baseMotorControl task that handles the power setting of the motors
+ * Defines baseControl task that runs the control pipeline of the base motors
  *
  */
 #ifndef _8059_MOTION_PROFILE_LIB_BASE_CONTROL_HPP_
 #define _8059_MOTION_PROFILE_LIB_BASE_CONTROL_HPP_
+#include "8059MotionProfileLib/include/motionProfile.hpp"
+#include "8059MotionProfileLib/include/baseOdometry.hpp"
+#include "8059MotionProfileLib/include/settleDetector.hpp"
+#include "8059MotionProfileLib/include/fixedPoint.hpp"
+#include "8059MotionProfileLib/include/taskConfig.hpp"
+#include "8059MotionProfileLib/include/robotConfig.hpp"
+#include "8059MotionProfileLib/include/gainSchedule.hpp"
+#include "8059MotionProfileLib/include/lqrGains.hpp"
+#include "8059MotionProfileLib/include/baseModel.hpp"
+#include "8059MotionProfileLib/include/trajectoryCache.hpp"
+#include "8059MotionProfileLib/include/ramsete.hpp"
+#include "8059MotionProfileLib/include/mpcTracker.hpp"
+#include "8059MotionProfileLib/include/moveToPose.hpp"
+#include "8059MotionProfileLib/include/stallDetector.hpp"
+#include "8059MotionProfileLib/include/impactDetector.hpp"
+#include "8059MotionProfileLib/include/dashboard.hpp"
+#include <cstdint>
+// Debugging output: DEBUG_MODE and the trace channels (refer to telemetry.hpp)
+// Maximum power allowed: MAX_POW (refer to robotConfig.hpp)
 /**
- * DEBUG_MODE can be used to debug & test functions and tasks via the terminal (aka command line)
- * 0: None
- * 1: Odometry (print Coordinates position)
- * 2: Encoders (print errorEncdL & errorEncdR)
- * 3: Power (print powerL & powerR)
- * 4: Raw encoder values (print raw encdL & encdR)
+ * BASE_FIXED_POINT selects the arithmetic of the PD + ramp + cap stages
+ * 0: double
+ * 1: Q16.16 fixed point (refer to fixedPoint.hpp)
  */
-#define DEBUG_MODE 4
-// Maximum power allowed
-#define MAX_POW 100
+#define BASE_FIXED_POINT 0
 /**
- * Maximum power increment every 20ms (20ms is the refresh rate of Task baseMotorControl)
- * This is to prevent too rapid changes to the motor power
+ * Maximum power increment every 20ms (20ms is the refresh rate of Task baseControl): RAMPING_POW
+ * (refer to robotConfig.hpp; changed live by PARAM_RAMPING_POW). This is to prevent too rapid changes to the motor power
  * Mathematically: |V - V previous| <= RAMPING_POW
  */
-#define RAMPING_POW 8
+/**
+ * Traction-limited ramp (refer to adaptBaseRamp): the power increment of each side adapts online,
+ * starting from the frame's rampPow, so the base accelerates at the traction limit of the carpet
+ * BASE_TRACTION_CONTROL: 0 fixed RAMPING_POW increment, 1 adaptive increment
+ * TRACTION_SLIP_LIMIT: slip of a side (motor wheel speed minus ground speed from the tracking wheels, in/s)
+ * above which it has lost traction
+ * TRACTION_SLIP_FILTER: fraction of the new slip taken per control cycle (low-pass filter)
+ * TRACTION_RAMP_GROW: increment growth per cycle in which a side is ramp-limited, grips and accelerates
+ * TRACTION_RAMP_BACKOFF: increment factor per cycle in which a side slips
+ * TRACTION_RAMP_MIN, TRACTION_RAMP_MAX: bounds of the increment
+ */
+#define BASE_TRACTION_CONTROL 1
+#define TRACTION_SLIP_LIMIT ODOM_SLIP_RATE
+#define TRACTION_SLIP_FILTER 0.3
+#define TRACTION_RAMP_GROW 1
+#define TRACTION_RAMP_BACKOFF 0.5
+#define TRACTION_RAMP_MIN 4
+#define TRACTION_RAMP_MAX 25
+/**
+ * Cascaded control (refer to computeBaseVelocity): the position loop (profile, pose correction, PD,
+ * settle detection, motion queue) runs every BASE_CONTROL_DT and commands a velocity per side; an
+ * inner wheel velocity loop runs every BASE_INNER_DT (on every BASE_INNER_DT/ODOM_DT odometry tick),
+ * closes it on the motor encoders and writes the motors in between the outer cycles
+ * BASE_CASCADE: 0 single loop (the PD gives the power), 1 cascaded
+ * BASE_VEL_KP: power per in/s of side velocity error
+ * BASE_VEL_FILTER: fraction of the new wheel velocity taken per inner cycle (low-pass filter)
+ * BASE_VEL_TICKS: 1 to close the loop on the tracking wheels, their velocities from the timing of their ticks
+ *   (refer to tickVelocity.hpp), so a creeping base is closed on its velocity; 0 on the motor encoders, differenced
+ * BASE_RAMP_SHARE: share of the power increment (per BASE_CONTROL_DT) taken per cycle writing the motors
+ */
+#define BASE_CASCADE 0
+#define BASE_VEL_KP 1.5
+#define BASE_VEL_FILTER 0.5
+#define BASE_VEL_TICKS 1
+#define BASE_RAMP_SHARE (BASE_CASCADE? (double)BASE_INNER_DT/BASE_CONTROL_DT : 1)
 /**
  * Default values of the proportional and derivative constants
- * for straight and turning movements.
+ * for straight and turning movements (trajectories; the movement functions
+ * default to the gain schedule, refer to gainSchedule.hpp).
  */
 #define DEFAULT_KP 0.5
 #define DEFAULT_KD 2
 #define DEFAULT_TURN_KP 0.7
 #define DEFAULT_TURN_KD 0.3
 /**
- * DISTANCE_LEEWAY is the distance (in inches) within which from the target
- * the robot would register that it has arrived at the target.
+ * LQR gains (refer to lqrGains.hpp): 0 off, 1 on
+ * A straight movement with scheduled gains (both GAIN_SCHEDULED), and a trajectory started with
+ * GAIN_SCHEDULED gains, takes kP/kD from the LQR table at the velocity of its setpoints every cycle
+ * (turns keep the turn schedule). Generate the table from the robot's model first (`make lqr`).
+ */
+#define BASE_LQR_GAINS 0
+/**
+ * Motion profile limits, in inches of wheel travel (turns: travel of each side).
+ * PROFILE_SHAPE is the default shape, refer to motionProfile.hpp.
+ * PROFILE_MAX_VEL and PROFILE_MAX_ACC are the defaults of PARAM_PROFILE_MAX_VEL and PARAM_PROFILE_MAX_ACC (refer to paramTable.hpp).
+ */
+#define PROFILE_SHAPE PROFILE_SCURVE
+#define PROFILE_MAX_VEL 30
+#define PROFILE_MAX_ACC 60
+#define PROFILE_MAX_JERK 300
+#define PROFILE_TURN_MAX_VEL 20
+#define PROFILE_TURN_MAX_ACC 40
+#define PROFILE_TURN_MAX_JERK 200
+/**
+ * Arc limits, in inches of travel of the outer side: the outer side keeps within what the power cap
+ * reaches, so neither side saturates and the curvature is held through the whole arc
+ */
+#define PROFILE_ARC_MAX_VEL 20
+#define PROFILE_ARC_MAX_ACC 40
+#define PROFILE_ARC_MAX_JERK 200
+/**
+ * Feedforward model on the profile setpoints: power = kS*sgn(v) + kV*v + kA*a
+ * PROFILE_KS: power to overcome static friction
+ * PROFILE_KV: power per inch per second of profile velocity.
+ * At 200rpm the base travels about 29 in/s, so 127/29 is the upper bound.
+ * PROFILE_KA: power per inch per second squared of profile acceleration
+ * These are the defaults of the base model; a characterized model replaces them per side (refer to baseModel.hpp).
+ */
+#define PROFILE_KS 4
+#define PROFILE_KV 3.5
+#define PROFILE_KA 0.2
+/**
+ * BASE_LOOKAHEAD: lead in ms of the setpoint velocities and accelerations (the feedforward, and the
+ * velocity commands of BASE_OUTPUT_VELOCITY) over the position setpoint, which makes up for the
+ * actuation latency of the smart motors (10-20 ms from a command to its torque); 0 for no lead.
+ * The PD loop still tracks the position setpoint of the current time.
+ */
+#define BASE_LOOKAHEAD 15
+// Maximum velocity of the base motors (green cartridge) in rpm, used by BASE_OUTPUT_VELOCITY
+#define BASE_MOTOR_RPM 200
+/**
+ * How the control pipeline drives the motors
+ * BASE_OUTPUT_POWER: Motor::move with the power (original behaviour)
+ * BASE_OUTPUT_VOLTAGE: Motor::move_voltage with the power converted to millivolts (finer resolution)
+ * BASE_OUTPUT_VELOCITY: Motor::move_velocity with the profile velocity plus the PD correction,
+ * so the motors' internal velocity loop keeps the speed under load and battery sag
+ * BASE_OUTPUT_MODE is the default mode.
+ */
+enum BaseOutputMode{
+  BASE_OUTPUT_POWER,
+  BASE_OUTPUT_VOLTAGE,
+  BASE_OUTPUT_VELOCITY
+};
+#define BASE_OUTPUT_MODE BASE_OUTPUT_POWER
+/**
+ * Pose control: close the movements on the odometry pose instead of the encoder targets alone
+ * BASE_POSE_CONTROL: default for setBasePoseControl (0 encoder targets, 1 pose goals)
+ * POSE_AIM_DIST: distance (inches) from the goal point below which a movement to a point holds
+ * the goal heading instead of aiming at the point (so the base does not spin round close to it)
+ */
+#define BASE_POSE_CONTROL 0
+#define POSE_AIM_DIST 6
+/**
+ * Heading hold of straight movements (refer to holdBaseHeading): the PD runs on the distance (mean of the
+ * side errors) and on the heading of the odometry pose (IMU fused if ODOM_USE_IMU) against the bearing of
+ * the movement, instead of on each side alone, so scrub or slip of one side is steered out during the
+ * movement rather than left for a corrective turn. Not used with pose control, which steers on its own.
+ * BASE_HEADING_HOLD: default for setBaseHeadingHold (0 independent sides, 1 cross-coupled)
+ * BASE_HEADING_GAIN: weight of the heading error against the distance error (1: a heading error counts
+ *   as the side travel that turns it out)
+ */
+#define BASE_HEADING_HOLD 0
+#define BASE_HEADING_GAIN 1
+/**
+ * IMU turns (refer to measureBaseHeading): a point turn (baseTurn, baseTurnRelative) is closed on the heading
+ * instead of on the side encoders alone. Its profile still gives the angular motion, and the heading it holds
+ * follows the profile to the goal bearing, so scrub (the sides slipping against baseWidth) is turned out during
+ * the turn and the turn settles on the heading at its goal, without a corrective turn. The heading is the IMU's
+ * turn since the start of the turn (with ODOM_USE_IMU, while it responds), else the odometry heading (encoders).
+ * Not used with pose control, which steers on its own.
+ * BASE_TURN_IMU: default for setBaseTurnImu (0 side encoders, 1 heading)
+ * BASE_TURN_HEADING_GAIN: weight of the heading error of such a turn (refer to BASE_HEADING_GAIN); above that of
+ *   the straight movements, so the base does not lag the profile into an overshoot as it ends
+ * BASE_TURN_TOLERANCE: largest heading error (degrees) at which such a turn settles, on top of the settle rule
+ */
+#define BASE_TURN_IMU 0
+#define BASE_TURN_HEADING_GAIN 4
+#define BASE_TURN_TOLERANCE 1
+/**
+ * End of a movement (refer to brakeBase): the control task schedules the brake mode of the base motors,
+ * so a zero power command (waitBase, a pause) stops the base where it is instead of letting it roll on
+ * BASE_MOVE_BRAKE_MODE: brake mode while the profile runs
+ * BASE_SETTLE_BRAKE_MODE: brake mode once the setpoints are at the targets
+ * BASE_ACTIVE_BRAKE: 0 off, 1 a reverse power pulse on each side still moving when the profile ends
+ *   (power modes only; the motors' velocity loop brakes by itself in BASE_OUTPUT_VELOCITY)
+ * BASE_BRAKE_GAIN: reverse power per in/s of side velocity
+ * BASE_BRAKE_MAX_POW: largest reverse power
+ * BASE_BRAKE_MIN_VEL: side velocity (in/s) below which the pulse ends (or does not start)
+ * BASE_BRAKE_TIME: longest pulse in ms
+ * The time from the end of the profile to the settle is traced as TELEMETRY_STOP (TRACE_CONTROL).
  */
-#define DISTANCE_LEEWAY 3
+#define BASE_MOVE_BRAKE_MODE pros::E_MOTOR_BRAKE_COAST
+#define BASE_SETTLE_BRAKE_MODE pros::E_MOTOR_BRAKE_HOLD
+#define BASE_ACTIVE_BRAKE 0
+#define BASE_BRAKE_GAIN 4
+#define BASE_BRAKE_MAX_POW 60
+#define BASE_BRAKE_MIN_VEL 2
+#define BASE_BRAKE_TIME 60
+/**
+ * Swing turns (refer to baseSwing): the pivot side is held where it is by its motors (hold brake mode)
+ * while the other side drives around it.
+ * BASE_SWING_HOLD_TOL: error of the pivot side (inches) within which it gets 0 power, so the motors' own
+ * position hold keeps it; beyond it the PD loop pulls it back
+ */
+#define BASE_SWING_HOLD_TOL 0.25
+/**
+ * Impacts (refer to detectBaseImpact; needs the IMU, ODOM_USE_IMU): at every new IMU sample the control task
+ * compares the horizontal acceleration with the one the movement commands and watches the tilt. A collision
+ * or a tip during a movement aborts it: the base holds where it is, waitBase returns at once (isBaseAborted)
+ * and the motion queue is cleared, instead of pushing on until the cutoff. The impact is published
+ * (getBaseImpact) for the autonomous code to go on, e.g. around the robot it hit (replanAroundImpact).
+ * Nothing is detected while the base is paused (timerBase and baseSquareToWall drive into walls on purpose).
+ * BASE_IMPACT_DETECTION: 0 off, 1 on
+ * BASE_IMPACT_RECOVERY: time in ms after an impact during which the power increments are limited to BASE_IMPACT_RAMP
+ * BASE_IMPACT_TILT: tilt in degrees (pitch or roll) above which they are limited as well (climbing, or about to tip)
+ * BASE_IMPACT_RAMP: the limited power increment per BASE_CONTROL_DT
+ */
+#define BASE_IMPACT_DETECTION 1
+#define BASE_IMPACT_RECOVERY 1000
+#define BASE_IMPACT_TILT 10
+#define BASE_IMPACT_RAMP 4
+/**
+ * BaseImpact: an impact seen by the control task
+ * type: ImpactType; motionId: the movement it aborted (0 if none was running)
+ * x, y, angle: pose at the impact (angle in radians); reverse: the base was driving backward
+ * time: time of the IMU sample that showed it (micros)
+ */
+struct BaseImpact{
+  ImpactType type;
+  uint32_t motionId;
+  double x, y, angle;
+  bool reverse;
+  uint64_t time;
+};
+/**
+ * BasePoseGoal is the pose a movement ends at, for pose control.
+ * (x, y): goal point; angle: goal bearing (radians)
+ * toPoint: the heading aims at the goal point (movements), else it is held at angle (turns)
+ * direction: 1 forward, -1 backward (the back faces the goal point)
+ */
+struct BasePoseGoal{
+  double x, y, angle;
+  bool toPoint;
+  int direction;
+};
+/**
+ * Squaring to a wall (baseSquareToWall): the base drives into a field wall at a fixed power, and each
+ * motor is in contact once its velocity drops while it draws current (WALL_CONTACT_RULE, refer to
+ * StallDetector). A side is seated once both of its motors are in contact; contacts only count once the
+ * side has moved faster than WALL_MOVING_VELOCITY (rpm) or WALL_ARM_TIME (ms) has passed (a robot
+ * that starts against the wall), so the current of the start does not count.
+ * WALL_MAX_ANGLE: largest difference in degrees between the odometry bearing once seated and the bearing
+ * square to the wall (a larger one: seated against another wall or an obstacle)
+ * WALL_FIELD_SIZE: side of the field in inches; WALL_ORIGIN_X, WALL_ORIGIN_Y: odometry origin in inches
+ * from the field's bottom left corner
+ * The coordinate along the wall keeps its uncertainty (refer to ODOM_KEEP_X), and baseRelocalize only squares
+ * while the pose is uncertain (refer to isPoseUncertain).
+ */
+#define WALL_CONTACT_RULE {20, 800, 5, 60}
+#define WALL_MOVING_VELOCITY 30
+#define WALL_ARM_TIME 250
+#define WALL_MAX_ANGLE 30
+#define WALL_FIELD_SIZE DASHBOARD_FIELD_SIZE
+#define WALL_ORIGIN_X DASHBOARD_ORIGIN_X
+#define WALL_ORIGIN_Y DASHBOARD_ORIGIN_Y
+/**
+ * Who drives the base (refer to setBaseControlMode). The base controller runs in autonomous and in
+ * driver control, so the hand-over between the two is a mode switch between two of its cycles
+ * instead of a task teardown, and the odometry and the movements stay available to the driver.
+ */
+enum BaseControlMode{
+  BASE_MODE_AUTON,    // the movement commands and the motion queue drive the base
+  BASE_MODE_DRIVER,   // the driver pipeline writes the motors (refer to driverInput.hpp); the controller holds no movement and records the base
+  BASE_MODE_ASSIST    // a movement commanded during driver control drives the base, until it settles or aborts, or the driver takes over
+};
+/** field walls, by the bearing facing them (top: +y) */
+enum FieldWall{
+  WALL_TOP,
+  WALL_RIGHT,
+  WALL_BOTTOM,
+  WALL_LEFT
+};
+/**
+ * Way round of a turn to a bearing (baseTurn). The bearings of the pose are continuous (refer to getHeading),
+ * so the turn is the difference to the goal, not the goal itself.
+ */
+enum TurnDirection{
+  TURN_SHORTEST,        // the smaller rotation, at most half a turn (the default)
+  TURN_CLOCKWISE,       // clockwise, up to a whole turn
+  TURN_COUNTERCLOCKWISE // counterclockwise, up to a whole turn
+};
+/** sides of the base (pivot of a swing turn) */
+enum BaseSide{
+  BASE_SIDE_NONE,
+  BASE_SIDE_LEFT,
+  BASE_SIDE_RIGHT
+};
+/**
+ * Movement commands: a movement function describes the whole new movement in one BaseCommand and
+ * hands it to the baseControl task, which applies it at the start of its next cycle (at once when the
+ * movement function runs on the control task, e.g. from the motion queue). The targets, profile,
+ * gains, output mode and goal pose of a movement therefore change together between two cycles,
+ * and only the control task writes them.
+ * BASE_COMMAND_QUEUE: commands waiting for the control task (a caller waits while it is full)
+ */
+#define BASE_COMMAND_QUEUE 8
+enum BaseCommandType{
+  BASE_COMMAND_PROFILE,     // startBaseMotion
+  BASE_COMMAND_TRAJECTORY,  // startBaseTrajectory
+  BASE_COMMAND_RAMSETE,     // startBaseRamsete
+  BASE_COMMAND_MPC,         // startBaseMpc
+  BASE_COMMAND_PURSUIT,     // startBasePursuit
+  BASE_COMMAND_MOVE_POSE,   // startBaseMoveToPose
+  BASE_COMMAND_STOP,        // stopBase
+  BASE_COMMAND_RESET        // resetCoords
+};
+/**
+ * id: number of the movement (isBaseSettled compares it); time: micros when the movement was started
+ * (its profile or trajectory is timed from there)
+ * deltaL & deltaR: change of the targets in encoder degrees; kp & kd: gains (GAIN_SCHEDULED: from the
+ * gain schedule); turn: turn limits and schedule; arc: arc limits; duration: shortest duration of the profile (s,
+ * 0: none, refer to stretchBaseMotion); chain: blend into the current profile (chainBaseMotion)
+ * shape & output: profile shape and output mode of the movement
+ * poseGoalSet & poseGoal: the staged goal pose (pose control)
+ * headingSet & heading: the bearing held by a straight movement (heading hold, radians), or the goal bearing of a
+ * turn closed on the heading (headingTurn, refer to BASE_TURN_IMU)
+ * strafeSet, strafe & strafeAxis: the travel to the right (inches) of a holonomic translation, across the bearing strafeAxis (radians)
+ * pivot: side held in place (swing turn)
+ * poseMove: the goal of a move to pose
+ * trajectory: the trajectory replayed or followed
+ */
+struct BaseCommand{
+  BaseCommandType type;
+  uint32_t id;
+  uint64_t time;
+  double deltaL, deltaR;
+  double kp, kd;
+  bool turn, arc, chain;
+  double duration;
+  ProfileShape shape;
+  BaseOutputMode output;
+  bool poseGoalSet;
+  BasePoseGoal poseGoal;
+  bool headingSet, headingTurn;
+  BaseSide pivot;
+  double heading;
+  bool strafeSet;
+  double strafe, strafeAxis;
+  PoseMoveGoal poseMove;
+  const CachedTrajectory *trajectory;
+};
+/**
+ * BaseControlFrame holds everything one cycle of the control pipeline works on.
+ * Stages: read sensors -> profile -> PD -> ramp/cap -> write motors.
+ * readTime & writeTime (micros) give the end-to-end latency of the cycle.
+ * setpointEncdL/R are in encoder degrees, setpointVelL/R in inches per second,
+ * setpointAccL/R in inches per second squared (both BASE_LOOKAHEAD ahead of the position setpoints).
+ * trackPosition is false when only the setpoint velocities are commanded (pure pursuit).
+ * output is the output mode of the cycle; targetVelL/R (rpm) are only used by BASE_OUTPUT_VELOCITY.
+ * kp, kd, ffL/R (the feedforward of the sides), learnedL/R (the learned feedforward of a trajectory, power, refer
+ * to learnedFeedforward.hpp), powerCap & rampPow (the power increment without traction control)
+ * are the gains and power limits of the cycle, so the PD and ramp stages only depend on the frames (and can be
+ * replayed from a flight record).
+ * groundVelL/R (in/s), slipL/R (in/s, filtered) and rampL/R (power increment) are the traction state
+ * of the ramp stage, carried from frame to frame (refer to BASE_TRACTION_CONTROL).
+ * With BASE_CASCADE, outer is true when the position loop ran in the cycle (the other cycles carry its
+ * outputs); velCmdL/R (in/s) are the velocities it commands and wheelVelL/R (in/s, filtered) the
+ * wheel velocities the inner loop measured; tickL/R carry the tick velocity estimates of the tracking wheels
+ * (refer to BASE_VEL_TICKS).
+ * holdHeading is true when the PD holds the bearing of the movement, headingError (radians) is then the
+ * bearing less the heading of the pose (refer to holdBaseHeading), weighted by headingGain (refer to measureBaseHeading).
+ * pivot is the side a swing turn holds in place (BaseSide, refer to holdBasePivot).
+ * rampLimit is the largest power increment of the cycle while the base recovers from an impact (0: none,
+ * refer to detectBaseImpact).
+ * motorVelL/R (encoder degrees per second) are the side velocities of the motor encoders over the motors'
+ * own sample times, for the D term (kept from frame to frame while the motors have no new sample).
+ * strafe is true when the strafe of a holonomic base is driven (refer to computeBaseStrafe): setpointS, lateralS
+ * and errorS (inches) are the setpoint, the pose and the error across the bearing of a translation,
+ * setpointVelS/AccS the strafe setpoint velocity and acceleration, targetPowerS, powerS and targetVelS (rpm)
+ * the strafe commands (mixed into the motors by the drivetrain, refer to chassisModel.hpp).
+ */
+struct BaseControlFrame{
+  uint64_t readTime, writeTime;
+  SensorFrame sensors;
+  double encdL, encdR;
+  bool trackPosition;
+  double setpointEncdL, setpointEncdR;
+  double setpointVelL, setpointVelR;
+  double setpointAccL, setpointAccR;
+  double errorEncdL, errorEncdR;
+  BaseOutputMode output;
+  double kp, kd, powerCap, rampPow;
+  BaseFeedforward ffL, ffR;
+  double learnedL, learnedR;
+  double targetPowerL, targetPowerR;
+  double powerL, powerR;
+  double targetVelL, targetVelR;
+  double groundVelL, groundVelR;
+  double slipL, slipR;
+  double rampL, rampR;
+  bool outer, holdHeading;
+  uint8_t pivot;
+  double headingError, headingGain;
+  double rampLimit;
+  double velCmdL, velCmdR;
+  double wheelVelL, wheelVelR;
+  TickVelocity tickL, tickR;
+  double motorVelL, motorVelR;
+  bool strafe;
+  double setpointS, lateralS, errorS;
+  double setpointVelS, setpointAccS;
+  double targetPowerS, powerS, targetVelS;
+};
 /**
  * refer to baseControl.cpp for function documentation
  */
@@ -42,19 +415,70 @@ void baseMove(double dis, double kp, double kd);
 void baseMove(double dis);
 void baseMove(double x, double y, double kp, double kd);
 void baseMove(double x, double y);
-void baseTurn(double angleDeg, double kp, double kd);
-void baseTurn(double angleDeg);
+void baseTranslate(double x, double y, double kp, double kd);
+void baseTranslate(double x, double y);
+void baseStrafe(double dis, double kp, double kd);
+void baseStrafe(double dis);
+void baseTurn(double angleDeg, double kp, double kd, TurnDirection direction = TURN_SHORTEST);
+void baseTurn(double angleDeg, TurnDirection direction = TURN_SHORTEST);
 void baseTurn(double x, double y, double kp, double kd, bool reverse);
 void baseTurnRelative(double angle, double kp, double kd);
+void baseArc(double radius, double angleDeg, double kp, double kd);
+void baseArc(double radius, double angleDeg);
+void baseArcTo(double x, double y, double kp, double kd);
+void baseArcTo(double x, double y);
+void baseSwing(double angleDeg, BaseSide pivot, double kp, double kd);
+void baseSwing(double angleDeg, BaseSide pivot);
+
+void setProfileShape(ProfileShape shape);
+void chainBaseMotion();
+void stretchBaseMotion(double seconds);
+void setBaseOutputMode(BaseOutputMode mode);
+void setBasePoseControl(bool enable);
+void setBaseHeadingHold(bool enable);
+void setBaseTurnImu(bool enable);
+bool canChainBase(uint64_t now);
+void getBaseRemaining(const BaseControlFrame &frame, double &distance, double &time);
+void getBaseTargets(double &left, double &right);
+void getBaseTrackingError(double &left, double &right);
+void startBaseMotion(double deltaL, double deltaR, double kp, double kd, bool turn, bool arc = false,
+  BaseSide pivot = BASE_SIDE_NONE);
+void startBaseTrajectory(const CachedTrajectory *trajectory, double kp, double kd);
+void startBaseRamsete(const CachedTrajectory *trajectory);
+void startBaseMpc(const CachedTrajectory *trajectory);
+void startBasePursuit();
+void startBaseMoveToPose(const PoseMoveGoal &goal);
 
+void setBaseSettleRule(const SettleRule &rule);
+bool isBaseSettled();
+bool isBaseAborted();
+BaseImpact getBaseImpact(uint32_t *count = NULL);
 void waitBase(double cutoff);
 void capBasePow(double cap);
 void rmBaseCap();
 void pauseBase(bool pause);
+void setBaseControlMode(BaseControlMode mode);
+BaseControlMode getBaseControlMode();
 void timerBase(double powL, double powR, double time);
-void resetCoords(double x, double y, double angleDeg);
+void resetCoords(double x, double y, double angleDeg, uint8_t keep = 0);
+bool baseSquareToWall(FieldWall wall, double power, uint32_t timeout);
+bool baseRelocalize(FieldWall wall, double power, uint32_t timeout);
+void stopBase();
 
+uint64_t getBaseControlLatency();
+void estimateMotorVelocity(BaseControlFrame &frame, const BaseControlFrame &prevFrame);
+void computeBasePD(BaseControlFrame &frame, const BaseControlFrame &prevFrame);
+void computeBaseVelocity(BaseControlFrame &frame, const BaseControlFrame &prevFrame);
+void computeBaseStrafe(BaseControlFrame &frame, const BaseControlFrame &prevFrame);
+void rampBaseStrafe(BaseControlFrame &frame, const BaseControlFrame &prevFrame);
+double tractionRamp(double ramp, double slip, double acc, double step);
+void adaptBaseRamp(BaseControlFrame &frame, const BaseControlFrame &prevFrame);
+void rampBasePower(BaseControlFrame &frame, const BaseControlFrame &prevFrame);
+void computeBasePDFixed(BaseControlFrame &frame, const BaseControlFrame &prevFrame);
+void rampBasePowerFixed(BaseControlFrame &frame, const BaseControlFrame &prevFrame);
+BaseControlFrame benchmarkFrame(int i);
+double compareBasePDFixed(int cycles, double &rms);
+void benchmarkBasePD(int iterations);
 void baseControl(void * ignore);
-void baseMotorControl(void * ignore);
 
 #endif
@@ -0,0 +1,43 @@
+/**
+ * Header file for baseModel.cpp
+ * Defines the drivetrain model of the base: the kS/kV/kA feedforward of each side and the effective
+ * track widths, identified on the robot by characterizeBase (refer to baseCharacterizer.hpp) and saved
+ * on the microSD card
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_BASE_MODEL_HPP_
+#define _8059_MOTION_PROFILE_LIB_BASE_MODEL_HPP_
+/**
+ * Model file on the microSD card, loaded with the gain schedule if it exists
+ * Lines: "left" ks kv ka, "right" ks kv ka, "width" motorWidth trackingWidth
+ */
+#ifndef BASE_MODEL_FILE_PATH
+#define BASE_MODEL_FILE_PATH "/usd/model.txt"
+#endif
+/**
+ * Feedforward of a side: power = ks*sgn(v) + kv*v + ka*a
+ * ks: power to overcome static friction
+ * kv: power per inch per second
+ * ka: power per inch per second squared
+ */
+struct BaseFeedforward{
+  double ks, kv, ka;
+};
+/**
+ * left, right: feedforward of the sides (PROFILE_KS, PROFILE_KV & PROFILE_KA until a model is loaded)
+ * motorWidth: effective width between the base wheels in turns (inches, for motorBaseWidth)
+ * trackingWidth: effective width between the tracking wheels (inches, for baseWidth; only measured with the IMU)
+ * The widths are only reported: the odometry geometry is calibrated on its own (refer to calibrateOdometry).
+ */
+struct BaseModel{
+  BaseFeedforward left, right;
+  double motorWidth, trackingWidth;
+};
+/**
+ * refer to baseModel.cpp for function documentation
+ */
+void setBaseModel(const BaseModel &model);
+BaseModel getBaseModel();
+bool loadBaseModel();
+bool saveBaseModel();
+
+#endif
@@ -7,19 +7,304 @@
 #ifndef _8059_MOTION_PROFILE_LIB_BASE_ODOMETRY_HPP_
 #define _8059_MOTION_PROFILE_LIB_BASE_ODOMETRY_HPP_
 #include "8059MotionProfileLib/include/structs.hpp"
+#include "8059MotionProfileLib/include/robotConfig.hpp"
+#include "8059MotionProfileLib/include/poseEstimator.hpp"
+#include "8059MotionProfileLib/include/tickVelocity.hpp"
+#include "8059MotionProfileLib/include/filterPipeline.hpp"
+#include <cstdint>
 /**
- * Essential variables for odometry task and functions
+ * Essential variables for odometry task and functions:
+ * baseWidth, inPerDeg & perpOffset are part of the robot configuration (refer to robotConfig.hpp)
  */
- //Tuning: turn at least 2 rotations and compare results in program & real life
-#define baseWidth 10.83798252962012
-//Tuning: go straight and compare results in program & real life
-#define inPerDeg 0.0241043549920626
-// Make Coordinates position a universally accessible object
-extern Coordinates position;
+/**
+ * Three tracking wheel odometry
+ * ODOM_THREE_WHEEL: 0 left & right wheels only, 1 also the perpendicular (sideways) wheel on encdS_port,
+ * which measures lateral slip
+ * perpOffset: distance of the perpendicular wheel behind the tracking centre (inches; negative if in front)
+ * The perpendicular encoder counts up when the robot moves to the right.
+ */
+#define ODOM_THREE_WHEEL 0
+/**
+ * ODOM_FAST_TRIG selects the trigonometry of the odometry tick
+ * 0: libm sin & cos
+ * 1: fastSin & fastCos (table, refer to mathUtils.hpp for the error bounds)
+ */
+#define ODOM_FAST_TRIG 1
+/**
+ * The tick moves the pose along the arc of its twist (the exponential map of SE(2), refer to integrateTwist)
+ * ODOM_TAYLOR_ANGLE: below this turn per tick (radians) the chord factor of the arc is its Taylor series
+ * (error under 5e-8 at the limit), so no sine is taken and nothing is divided by a vanishing angle
+ */
+#define ODOM_TAYLOR_ANGLE 0.5
+/**
+ * Heading fusion with the V5 inertial sensor (on imuPort)
+ * ODOM_USE_IMU: 0 encoder heading only, 1 encoder heading corrected by the IMU
+ * ODOM_IMU_GAIN: fraction of the difference between the IMU and the fused heading that is
+ * corrected per new IMU sample (complementary filter); the encoders give the short-term heading
+ * and the IMU removes the long-term drift from wheel scrub and baseWidth error
+ */
+#define ODOM_USE_IMU 0
+#define ODOM_IMU_GAIN 0.05
+/**
+ * ODOM_ESTIMATOR selects how the pose is computed
+ * 0: arc integration of the tracking wheels (dead reckoning), with the complementary IMU filter and the
+ *    pose corrections of the vision landmarks and the wall ranges applied by their gains
+ * 1: the pose estimator (refer to poseEstimator.hpp), which weighs the tracking wheels, the IMU, the vision
+ *    landmarks (observeLandmark) and the wall ranges by their uncertainties
+ * ODOM_LANDMARK_QUEUE: landmark observations that can wait for the next tick
+ */
+#define ODOM_ESTIMATOR 1
+#define ODOM_LANDMARK_QUEUE 8
+/**
+ * Uncertainty of the pose (refer to getPoseUncertainty), published every tick: with ODOM_ESTIMATOR the
+ * estimator's covariance, which the IMU, the landmarks and the wall ranges shrink; without it the covariance
+ * grown with the distance travelled and turned (the corrections applied by their gains do not shrink it).
+ * A reset (setCoords) sets it to ESTIMATOR_INITIAL_POSITION & ESTIMATOR_INITIAL_ANGLE, except on the
+ * coordinates the reset keeps (ODOM_KEEP_X, ODOM_KEEP_Y, ODOM_KEEP_ANGLE: bits of setCoords' keep).
+ * A routine relocalizes (e.g. baseRelocalize) only once it is above a threshold (refer to isPoseUncertain):
+ * ODOM_UNCERTAIN_POSITION: default standard deviation of the position in inches
+ * ODOM_UNCERTAIN_ANGLE: default standard deviation of the bearing in degrees
+ */
+#define ODOM_KEEP_X (1 << ESTIMATE_X)
+#define ODOM_KEEP_Y (1 << ESTIMATE_Y)
+#define ODOM_KEEP_ANGLE (1 << ESTIMATE_ANGLE)
+#define ODOM_UNCERTAIN_POSITION 1
+#define ODOM_UNCERTAIN_ANGLE 2
+/**
+ * Calibrated tracking wheel geometry on the microSD card (refer to calibrateOdometry), loaded with the
+ * gain schedule if it exists, in place of inPerDeg & baseWidth: "inPerDeg" value, then "baseWidth" value
+ */
+#ifndef ODOM_GEOMETRY_FILE_PATH
+#define ODOM_GEOMETRY_FILE_PATH "/usd/odometry.txt"
+#endif
+/**
+ * Cross-check of the tracking wheels against the integrated motor encoders
+ * ODOM_MOTOR_CHECK: 0 tracking wheels only, 1 also compare every step with the motor encoders:
+ * report wheel slip, and integrate the motor encoders instead once a tracking wheel fails
+ * inPerMotorDeg: base wheel travel per motor degree (inches; baseControl also converts the motor positions with inPerDeg)
+ * motorBaseWidth: effective width between the base wheels (inches)
+ * ODOM_SLIP_RATE: filtered difference between the wheel travel and the ground travel of a side (in/s)
+ * above which the side slips
+ * ODOM_SLIP_FILTER: fraction of the new difference taken per step (low-pass filter)
+ * ODOM_TRACKING_FAIL_DIST: motor travel of a side (inches) while its tracking wheel does not count,
+ * and the other wheel travels at least half of it, after which the tracking wheel has failed (for the rest of the run)
+ * ODOM_TRACKING_BOTH_DIST: motor travel of both sides (inches) while neither tracking wheel counts, after which
+ * both have failed (a shared cable or expander; longer than a wheel spin against a wall)
+ * ODOM_TRACKING_IMU_TURN: turn of the IMU (degrees) while neither tracking wheel counts and both sides drive
+ * (ODOM_TRACKING_FAIL_DIST), after which both have failed (sooner than ODOM_TRACKING_BOTH_DIST when turning)
+ * ODOM_TRACKING_JUMP: difference (inches) between a tracking wheel's change and its side's motor change over one
+ * step beyond which the wheel has failed (a glitch or PROS_ERR of the port; checked over steps up to ODOM_IDLE_DT)
+ * ODOM_FAILED_IMU: 1 to take the heading from the IMU's turn once a tracking wheel has failed (while the IMU is
+ * valid), 0 from the motor encoders (whose wheels scrub when turning)
+ */
+#define ODOM_MOTOR_CHECK 1
+#define inPerMotorDeg inPerDeg
+ //Tuning: turn at least 2 rotations with ODOM_MOTOR_CHECK and compare the slip rates to 0
+#define motorBaseWidth baseWidth
+#define ODOM_SLIP_RATE 4
+#define ODOM_SLIP_FILTER 0.1
+#define ODOM_TRACKING_FAIL_DIST 1.0
+#define ODOM_TRACKING_BOTH_DIST 6.0
+#define ODOM_TRACKING_IMU_TURN 5.0
+#define ODOM_TRACKING_JUMP 3.0
+#define ODOM_FAILED_IMU 1
+/**
+ * Wall ranging with an ultrasonic sensor (ADIUltrasonic on ultrasonicPort, mounted as in robotConfig.hpp)
+ * ODOM_USE_ULTRASONIC: 0 off, 1 correct the pose from the range to the field wall the beam hits
+ * Every ULTRASONIC_TICKS odometry ticks, the measured range is compared with the range expected from the
+ * pose; once ULTRASONIC_SAMPLES consecutive samples on the same wall are in, their median difference
+ * (Median, refer to filterPipeline.hpp), across the wall, corrects the coordinate perpendicular to that wall
+ * (the heading and the coordinate along the wall are kept), while the robot keeps moving.
+ * ULTRASONIC_IN_PER_UNIT: inches per unit of the reading (10000 per meter)
+ * ULTRASONIC_MIN_RANGE, ULTRASONIC_MAX_RANGE: usable ranges in inches
+ * ULTRASONIC_MAX_INCIDENCE: largest angle in degrees between the beam and the wall's normal (the echo of a
+ *   wall hit at a shallower angle is unreliable)
+ * ULTRASONIC_GATE: largest difference in inches of a sample (larger: an obstacle or a robot in the beam)
+ * ULTRASONIC_MAX_ANG_VEL: samples taken while turning faster (degrees per second) are dropped
+ * ULTRASONIC_GAIN: fraction of the median difference corrected; ULTRASONIC_MAX_SHIFT: bound of a correction (inches)
+ */
+#define ODOM_USE_ULTRASONIC 0
+#define ULTRASONIC_TICKS 10
+#define ULTRASONIC_SAMPLES 5
+#define ULTRASONIC_IN_PER_UNIT (1/254.0)
+#define ULTRASONIC_MIN_RANGE 2
+#define ULTRASONIC_MAX_RANGE 100
+#define ULTRASONIC_MAX_INCIDENCE 20
+#define ULTRASONIC_GATE 4
+#define ULTRASONIC_MAX_ANG_VEL 60
+#define ULTRASONIC_GAIN 0.5
+#define ULTRASONIC_MAX_SHIFT 1
+static_assert(!(ODOM_USE_ULTRASONIC && ODOM_THREE_WHEEL && ultrasonicPort == encdS_port), "the ultrasonic and the perpendicular wheel share ports");
+static_assert(!HOLONOMIC_BASE || ODOM_THREE_WHEEL, "a holonomic base needs the perpendicular wheel to measure its strafe");
+/**
+ * Adaptive odometry rate
+ * ODOM_ADAPTIVE_RATE: 0 always every ODOM_DT, 1 every ODOM_IDLE_DT once the base has stood still for
+ * ODOM_IDLE_TIME (ms), back to ODOM_DT at the first tick it moves, or at once when a movement is
+ * commanded (wakeOdometry). The subscribers keep their rates down to ODOM_IDLE_DT (refer to scheduler.cpp).
+ * ODOM_IDLE_MOTOR: largest change of a side's motor encoder (degrees per tick) that still counts as
+ * standing still; the tracking wheels and the IMU must not change at all
+ */
+#define ODOM_ADAPTIVE_RATE 1
+#define ODOM_IDLE_TIME 250
+#define ODOM_IDLE_MOTOR 0.5
+/**
+ * Phase lock of the odometry ticks to the sensor updates (every SENSOR_DEVICE_DT)
+ * ODOM_PHASE_LOCK: 1 to shift the ticks until each reads a fresh motor sample ODOM_PHASE_LAG ms after its
+ * update (the device time of Motor::get_raw_position; the ADI ports update on the same cycle), so no tick
+ * reads stale data and the control cycle, triggered by the tick, acts on the newest sample
+ * ODOM_PHASE_STEP: largest shift in ms per tick (a late sample moves the schedule by little)
+ */
+#define ODOM_PHASE_LOCK 1
+#define ODOM_PHASE_LAG 1
+#define ODOM_PHASE_STEP 2
+/**
+ * ODOM_TICK_VELOCITY: 1 to take the velocities of the pose (without ODOM_ESTIMATOR) from the timing of the
+ * tracking wheel ticks (refer to tickVelocity.hpp), 0 from the travel over the tick; a creeping base then
+ * reads its velocity instead of 0 and a tick's worth. The motor encoders are still differenced.
+ */
+#define ODOM_TICK_VELOCITY 1
+/** Failed tracking wheels (bits of OdometryHealth::trackingFailed) */
+#define ODOM_FAILED_LEFT 1
+#define ODOM_FAILED_RIGHT 2
+/** Sources the pose is integrated from (refer to OdometryHealth::source) */
+enum OdometrySource{
+  ODOM_SOURCE_TRACKING,     // tracking wheels
+  ODOM_SOURCE_MOTORS,       // motor encoders (a tracking wheel failed)
+  ODOM_SOURCE_MOTORS_IMU    // motor encoders, heading from the IMU (refer to ODOM_FAILED_IMU)
+};
+/**
+ * Pose corrections (correctPose, e.g. from the landmarks seen by the vision sensor) are added to
+ * the pose at the next tick. A correction computed from a pose older than the last setCoords is dropped.
+ */
+// Pose of the robot; only the odometry task may use it, other tasks should use getPose()
+extern Pose<double> position;
+/**
+ * PoseSnapshot is a consistent copy of the robot's pose and velocity (refer to PoseState), published
+ * atomically by the odometry task once per tick; timestamp is the time of the sensor frame that produced it.
+ * The velocities are computed with the measured time between ticks,
+ * so a late tick does not change their scale.
+ * The bearing (angle) is continuous: it is never wrapped and counts whole turns (7.85 rad after one and a quarter
+ * turns clockwise from 0), so it has no jump for a controller to see and a turn can be tracked across several
+ * turns. getHeading gives it on its own, getWrappedHeading within 0<=angle<2PI (for displays and field lookups);
+ * differences to a wrapped bearing are taken with angleDiff.
+ */
+typedef PoseState<double> PoseSnapshot;
+/**
+ * SensorFrame holds one reading of every base sensor, taken once per odometry tick.
+ * Odometry, debugging output and baseControl all work on the same frame.
+ * encdL, encdR: raw tracking encoder values (encoder degrees)
+ * encdS: raw perpendicular wheel encoder value (encoder degrees, 0 unless ODOM_THREE_WHEEL)
+ * motorL, motorR: integrated encoder positions of the sides, front & back averaged, or the one that
+ * responds (encoder degrees)
+ * rawL, rawR: raw encoder counts of the sides, front & back summed (PROS_ERR if a motor does not respond), and
+ * motorTimeL, motorTimeR: device time of them (ms), for velocities on the motors' own timeline
+ * imuRotation: IMU rotation, clockwise (degrees); only meaningful if imuValid
+ * imuAccelX, imuAccelY: IMU acceleration along its x and y axes (g), imuPitch, imuRoll: IMU tilt (degrees);
+ * only meaningful if imuValid (refer to detectBaseImpact)
+ * imuValid: IMU installed (ODOM_USE_IMU), calibrated and responding
+ * timestamp: time of the reading (micros)
+ */
+struct SensorFrame{
+  int32_t encdL, encdR, encdS;
+  double motorL, motorR;
+  int32_t rawL, rawR;
+  uint32_t motorTimeL, motorTimeR;
+  double imuRotation;
+  double imuAccelX, imuAccelY, imuPitch, imuRoll;
+  bool imuValid;
+  uint64_t timestamp;
+};
+/**
+ * Tracking wheel geometry: inPerDeg (inches per encoder degree) & baseWidth (inches) of robotConfig.hpp
+ * until a calibration is loaded
+ */
+struct OdometryGeometry{
+  double inPerDeg, baseWidth;
+};
+/**
+ * OdometryState holds everything one odometry step carries over to the next,
+ * so the integration can run outside the odometry task (e.g. replaying a flight record).
+ * (x, y, angle): the pose being integrated (angle in radians)
+ * prevEncdL, prevEncdR, prevEncdS, prevAngle: tracking wheel distances (inches) and bearing of the previous step
+ * prevTimestamp: time of the previous sensor frame (micros); 0 before the first step
+ * linVel & angVel: velocity estimates (refer to PoseSnapshot)
+ * angleOffset: offset between the encoder heading and the bearing (changed by resets and the IMU)
+ * imuAligned, imuOffset & prevImuRotation: IMU fusion state (refer to ODOM_USE_IMU)
+ * prevMotorL & prevMotorR: motor encoder distances of the previous step (inches)
+ * slipL, slipR, stuckL, stuckR, crossL, crossR, stillTurn & trackingFailed: cross-check state (refer to ODOM_MOTOR_CHECK and OdometryHealth)
+ * imuHeading: the heading of the latest step followed the IMU's turn (refer to ODOM_FAILED_IMU)
+ * estimate: the pose estimator (refer to ODOM_ESTIMATOR)
+ * tickL, tickR: velocity estimates of the tracking wheels (refer to ODOM_TICK_VELOCITY)
+ * geometry: tracking wheel geometry of the integration, taken from getOdometryGeometry at the first
+ * step and at every reset (so a new calibration never moves the pose in the middle of a path)
+ */
+struct OdometryState{
+  double x, y, angle;
+  double prevEncdL, prevEncdR, prevEncdS, prevAngle;
+  uint64_t prevTimestamp;
+  double linVel, angVel;
+  double angleOffset;
+  bool imuAligned;
+  double imuOffset, prevImuRotation;
+  double prevMotorL, prevMotorR;
+  double slipL, slipR, stuckL, stuckR, crossL, crossR, stillTurn;
+  uint8_t trackingFailed;
+  bool imuHeading;
+  PoseEstimate estimate;
+  TickVelocity tickL, tickR;
+  OdometryGeometry geometry;
+};
+/**
+ * OdometryHealth: result of the cross-check of the tracking wheels (refer to ODOM_MOTOR_CHECK)
+ * slipL, slipR: filtered difference between the wheel travel and the ground travel of each side (in/s)
+ * slipping: a side slips (above ODOM_SLIP_RATE)
+ * trackingFailed: ODOM_FAILED_LEFT | ODOM_FAILED_RIGHT; the pose is integrated from the motor encoders when not 0
+ * source: what the pose is integrated from
+ */
+struct OdometryHealth{
+  double slipL, slipR;
+  bool slipping;
+  uint8_t trackingFailed;
+  OdometrySource source;
+};
+/**
+ * A landmark seen by the vision sensor, for the pose estimator
+ * landmarkX, landmarkY: the landmark (odometry coordinates, inches)
+ * bearing, distance: as measured (radians clockwise from the heading, inches)
+ * timestamp: capture time (micros)
+ */
+struct LandmarkObservation{
+  double landmarkX, landmarkY;
+  double bearing, distance;
+  uint64_t timestamp;
+};
 /**
  * refer to baseOdometry.cpp for function documentation
  */
+SensorFrame readSensorFrame();
+double chordFactor(double angle);
+void integrateTwist(OdometryState &state, double forward, double lateral, double deltaAngle);
+PoseSnapshot stepOdometry(OdometryState &state, const SensorFrame &frame, const PoseSnapshot *reset);
+SensorFrame getSensorFrame(uint32_t *version = NULL);
+void calibrateImu();
+void recalibrateImu();
 void baseOdometry(void * ignore);
-void setCoords(double x, double y, double angle);
+void wakeOdometry();
+void setCoords(double x, double y, double angleDeg, uint8_t keep = 0);
+void correctPose(double dx, double dy, double dAngle, uint64_t timestamp);
+bool observeLandmark(const LandmarkObservation &observation);
+uint32_t getPoseCorrections();
+PoseSnapshot getPose();
+uint32_t getPoseVersion();
+double getHeading();
+double getWrappedHeading();
+PoseUncertainty getPoseUncertainty();
+bool isPoseUncertain(double position = ODOM_UNCERTAIN_POSITION, double angleDeg = ODOM_UNCERTAIN_ANGLE);
+OdometryHealth getOdometryHealth();
+const char *getOdometrySourceName(OdometrySource source);
+void setOdometryGeometry(const OdometryGeometry &geometry);
+OdometryGeometry getOdometryGeometry();
+bool loadOdometryGeometry();
+bool saveOdometryGeometry();
 
 #endif
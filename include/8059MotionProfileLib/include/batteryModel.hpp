@@ -0,0 +1,52 @@
+/**
+ * Header file for batteryModel.cpp
+ * Defines the battery model: the battery is an open-circuit voltage behind an internal resistance, so it sags by the
+ * resistance times the current the motors draw, and the more as it drains and warms over a match. The motor health
+ * task samples the battery's voltage and current with the motor currents (refer to motorHealth.hpp) and fits both
+ * (refer to updateBatteryModel); the voltage under a planned current is then predicted instead of read after the sag:
+ * - the voltage compensation scales the commands for the voltage at the current the arbiter plans (refer to motorOutput.hpp)
+ * - the current arbiter shares at most the current that keeps the battery above BATTERY_MIN_VOLTAGE (refer to currentBudget.hpp)
+ * - the base power cap follows the voltage at the base's full draw (refer to motorHealth.hpp)
+ * Until the battery has been seen under a varied load, the resistance is not known and every stage uses the
+ * measured voltage as before.
+ *
+ * Fit, per sample (v: voltage in mV, i: current in mA, a: BATTERY_FILTER), over exponentially weighted means:
+ *   mean(i) += a*(i - mean(i)), mean(v) += a*(v - mean(v)), var(i), cov(v, i) likewise
+ *   resistance = -cov(v, i)/var(i) once var(i) >= BATTERY_MIN_SPREAD^2 (kept while the load is steady)
+ *   open-circuit voltage = mean(v) + resistance*mean(i)
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_BATTERY_MODEL_HPP_
+#define _8059_MOTION_PROFILE_LIB_BATTERY_MODEL_HPP_
+#include <cstdint>
+/**
+ * Fit
+ * BATTERY_FILTER: weight of a sample in the means (at MOTOR_HEALTH_DT, a time constant of one second)
+ * BATTERY_MIN_SPREAD: standard deviation of the current (mA) a resistance is fitted from
+ * BATTERY_MIN_RESISTANCE, BATTERY_MAX_RESISTANCE: range of a plausible fit in ohms (a fit outside it is dropped)
+ * BATTERY_REPORT_CHANGE: relative change of the resistance that is reported (TELEMETRY_BATTERY)
+ */
+#define BATTERY_FILTER 0.1
+#define BATTERY_MIN_SPREAD 1000
+#define BATTERY_MIN_RESISTANCE 0.01
+#define BATTERY_MAX_RESISTANCE 0.5
+#define BATTERY_REPORT_CHANGE 0.05
+// Lowest battery voltage (mV) the current budget lets the motors pull the battery down to
+#define BATTERY_MIN_VOLTAGE 10500
+/**
+ * State of the model
+ * voltage, current: means of the samples (mV, mA)
+ * openVoltage: open-circuit voltage (mV)
+ * resistance: internal resistance in ohms (0: not known yet)
+ */
+struct BatteryState{
+  float voltage, current, openVoltage, resistance;
+};
+/**
+ * refer to batteryModel.cpp for function documentation
+ */
+void updateBatteryModel(int32_t voltage, int32_t current);
+BatteryState getBatteryState();
+double predictBatteryVoltage(double current);
+int32_t getBatteryCurrentLimit();
+
+#endif
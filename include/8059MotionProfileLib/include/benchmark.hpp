@@ -0,0 +1,48 @@
+/**
+ * Header file for benchmark.cpp
+ * Defines the microbenchmark suite of the hot kernels (math, odometry step, matrix operations, control step,
+ * pure-pursuit lookahead search, spline path query, path planning on the grid and on the lattice, RAMSETE and MPC
+ * tracking, pose batches in double and float), run on the V5 (DEBUG_MODE 5) or on the computer (`./bin/sim bench`),
+ * and the accuracy suite of the approximate kernels
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_BENCHMARK_HPP_
+#define _8059_MOTION_PROFILE_LIB_BENCHMARK_HPP_
+// Number of precomputed inputs each kernel cycles through (power of 2)
+#define BENCHMARK_INPUTS 64
+/**
+ * CPU clock in MHz used to convert the timings to cycles (the V5's Cortex-A9 runs at 667 MHz);
+ * 0 prints nanoseconds only (the host simulation build)
+ */
+#ifndef BENCHMARK_CPU_MHZ
+#define BENCHMARK_CPU_MHZ 667
+#endif
+/**
+ * Tracker comparison (refer to benchmarkTrackers): an S-curve trajectory of TRACKER_BENCH_TIME seconds at up to
+ * TRACKER_BENCH_VEL in/s, segments every TRACKER_BENCH_DT seconds; the base's sides lag their commands by
+ * TRACKER_BENCH_LAG seconds (the motors' velocity loop) and it starts TRACKER_BENCH_OFFSET inches off the start
+ */
+#define TRACKER_BENCH_TIME 3.0
+#define TRACKER_BENCH_VEL 30
+#define TRACKER_BENCH_DT 0.01
+#define TRACKER_BENCH_LAG 0.05
+#define TRACKER_BENCH_OFFSET 1.0
+/**
+ * Accuracy suite of the approximate kernels (`./bin/sim accuracy`, `make accuracy`, or DEBUG_MODE 5 on the V5):
+ * each is swept over its input domain against its reference (libm in double, the double control path), with
+ * its largest and RMS error and its cost next to the reference's. An approximation is only worth enabling while
+ * its largest error stays below the quantization of what it feeds:
+ *   fastSin, fastCos, fastAtan2: the heading resolution of the tracking wheels, inPerDeg/baseWidth radians
+ *   integrateTwist (SE(2) tick with ODOM_FAST_TRIG and the ODOM_TAYLOR_ANGLE series): an encoder step, inPerDeg inches
+ *   fixed-point PD + ramp (BASE_FIXED_POINT): the resolution of the motor command in power units
+ * ACCURACY_SAMPLES: samples of each sweep
+ * ACCURACY_TIMED_INPUTS: sweep samples the timed loops cycle through (power of 2)
+ */
+#define ACCURACY_SAMPLES 1000000
+#define ACCURACY_TIMED_INPUTS 256
+/**
+ * refer to benchmark.cpp for function documentation
+ */
+void runBenchmarks(int iterations);
+bool runAccuracySuite(int samples);
+
+#endif
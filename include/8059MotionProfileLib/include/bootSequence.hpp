@@ -0,0 +1,66 @@
+/**
+ * Header file for bootSequence.cpp
+ * Defines the staged start of the robot: initialize() only does the critical sensing (devices,
+ * tares, tasks); the slow stages run in background tasks and publish when they are ready, so
+ * initialize() returns within milliseconds and autonomous only waits for data that is still loading
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_BOOT_SEQUENCE_HPP_
+#define _8059_MOTION_PROFILE_LIB_BOOT_SEQUENCE_HPP_
+#include "8059MotionProfileLib/include/inlineFunction.hpp"
+#include <cstdint>
+// Poll rate of a task waiting for a stage in ms
+#define BOOT_POLL_DT 5
+// Longest wait of autonomous for the sensor calibration in ms (the IMU takes about 2 s)
+#define BOOT_CALIBRATION_TIMEOUT 3000
+// Timeout of waitBootReady that never expires
+#define BOOT_WAIT_FOREVER UINT32_MAX
+/**
+ * Stages of the start, in the order they usually finish
+ * BOOT_SENSING: devices constructed, encoders tared, tasks started (initialize())
+ * BOOT_CALIBRATION: IMU and color sensor calibrated (the robot must stay still)
+ * BOOT_TRAJECTORIES: default routine prepared and gain schedule loaded
+ * BOOT_UI: brain screen objects built (selector, dashboard)
+ */
+enum BootStage{
+  BOOT_SENSING,
+  BOOT_CALIBRATION,
+  BOOT_TRAJECTORIES,
+  BOOT_UI,
+  BOOT_STAGES
+};
+/**
+ * Boot timeline: instants of the start in micros() since the program started (the brain's power-on to
+ * the program start is not visible to it), in the order they usually happen; each is recorded once,
+ * reported to the telemetry (TELEMETRY_BOOT) and summed up on the dashboard
+ * BOOT_MARK_DEVICES: every device of the registry constructed (before initialize())
+ * BOOT_MARK_TARE: motors and encoders tared
+ * BOOT_MARK_TASKS: the robot's tasks started
+ * BOOT_MARK_INITIALIZED: initialize() returned
+ * BOOT_MARK_ODOMETRY: first pose published by the odometry task
+ * BOOT_MARK_TRAJECTORIES: default routine prepared (BOOT_TRAJECTORIES)
+ * BOOT_MARK_CONTROL: first cycle of the base control task (parked until autonomous or driver control)
+ */
+enum BootMark{
+  BOOT_MARK_DEVICES,
+  BOOT_MARK_TARE,
+  BOOT_MARK_TASKS,
+  BOOT_MARK_INITIALIZED,
+  BOOT_MARK_ODOMETRY,
+  BOOT_MARK_TRAJECTORIES,
+  BOOT_MARK_CONTROL,
+  BOOT_MARKS
+};
+/**
+ * refer to bootSequence.cpp for function documentation
+ */
+void startBootStage(BootStage stage, InlineFunction<void()> work);
+void markBootReady(BootStage stage);
+bool isBootReady(BootStage stage);
+bool waitBootReady(BootStage stage, uint32_t timeout = BOOT_WAIT_FOREVER);
+uint32_t getBootTime(BootStage stage);
+void markBoot(BootMark mark);
+bool getBootMark(BootMark mark, uint64_t &time);
+const char *getBootMarkName(BootMark mark);
+void reportBootMarks();
+
+#endif
@@ -0,0 +1,58 @@
+/**
+ * Header file for chassisBackend.cpp
+ * Defines the chassis backend adapter: the movement calls of a routine (drive, turn, wait) run on the
+ * 8059 base controller or on an okapi ChassisControllerPID built on the same ports, and a benchmark that
+ * runs one test sequence on a backend and measures its settle times, so the two can be chosen by measurement
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_CHASSIS_BACKEND_HPP_
+#define _8059_MOTION_PROFILE_LIB_CHASSIS_BACKEND_HPP_
+#include <cstdint>
+/**
+ * CHASSIS_OKAPI_LINKED: 1 okapilib.a is linked (the V5 build), 0 the okapi backend is unavailable
+ * (the host simulation: okapilib.a is only built for the V5)
+ */
+#ifndef CHASSIS_OKAPI_LINKED
+#define CHASSIS_OKAPI_LINKED 1
+#endif
+/** Backends of the chassis calls */
+enum ChassisBackend{
+  CHASSIS_8059,     // the base controller (refer to baseControl.hpp)
+  CHASSIS_OKAPI     // okapi's ChassisControllerPID on the tracking wheels (the base controller is paused)
+};
+/**
+ * okapi backend gains, as okapi's IterativePosPIDController::Gains {kP, kI, kD, kBias}: motor output
+ * (-1 to 1) per tracking wheel degree of error of the distance, turn and angle (straightness) loops
+ */
+#define CHASSIS_OKAPI_DISTANCE_GAINS {0.002, 0, 0.0001, 0}
+#define CHASSIS_OKAPI_TURN_GAINS {0.003, 0, 0.0001, 0}
+#define CHASSIS_OKAPI_ANGLE_GAINS {0.002, 0, 0.0001, 0}
+// Cutoff in ms of a benchmark movement on the 8059 backend (okapi waits for its own settle)
+#define CHASSIS_BENCH_CUTOFF 4000
+/**
+ * Result of a benchmark run (refer to runChassisBenchmark)
+ * moves: movements run; settled: those that settled (8059: before CHASSIS_BENCH_CUTOFF)
+ * totalTime, maxTime: time from the command to the end of the wait, summed and largest (ms)
+ * maxError: largest distance of the pose from where the sequence puts it after a movement (inches)
+ * p99Exec, maxExec: execution time of the base control loop (micros, refer to taskTiming.hpp); 0 when not
+ * measured (okapi's loops run in its own tasks, which taskTiming does not time; the simulated tasks run on the
+ * virtual clock, the cost of the control step on the computer is in `./bin/sim bench`)
+ */
+struct ChassisBenchResult{
+  uint32_t moves, settled;
+  uint32_t totalTime, maxTime;
+  double maxError;
+  uint32_t p99Exec, maxExec;
+};
+/**
+ * refer to chassisBackend.cpp for function documentation
+ */
+bool setChassisBackend(ChassisBackend backend);
+ChassisBackend getChassisBackend();
+const char *getChassisBackendName(ChassisBackend backend);
+void chassisMove(double dis);
+void chassisTurn(double angleDeg);
+bool chassisWait(double cutoff);
+bool runChassisBenchmark(ChassisBackend backend, ChassisBenchResult &result);
+void compareChassisBackends();
+
+#endif
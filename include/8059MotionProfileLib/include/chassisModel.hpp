@@ -0,0 +1,29 @@
+/**
+ * Header file for chassisModel.cpp
+ * Defines the kinematics of the base, as okapi's SkidSteerModel and XDriveModel do: how the commands of the
+ * control pipeline (a power, voltage or velocity per side, and a strafe on a holonomic base) map to the four
+ * base motors. The pipeline plans and closes its loops on the sides and the strafe; only the motor writes mix them.
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_CHASSIS_MODEL_HPP_
+#define _8059_MOTION_PROFILE_LIB_CHASSIS_MODEL_HPP_
+#include "8059MotionProfileLib/include/robotConfig.hpp"
+/**
+ * Holonomic base (HOLONOMIC_BASE, refer to robotConfig.hpp): an X-drive drives forward and turns as a tank
+ * drive does (the sides), and strafes with the front left and back right wheels forward and the others back.
+ * With wheels at 45 degrees a strafe rolls the wheels as far as a drive of the same length, so the strafe
+ * uses the side model (feedforward, gains, profile limits in inches of wheel travel).
+ * HOLONOMIC_HEADING_GAIN: angular velocity per radian of heading error (1/s) with which the velocity
+ *   controllers (pure pursuit) hold the bearing of a holonomic base
+ */
+#define HOLONOMIC_HEADING_GAIN 4
+/** commands of the four base motors (in the unit of the side commands) */
+struct WheelCommands{
+  double frontLeft, backLeft, frontRight, backRight;
+};
+/**
+ * refer to chassisModel.cpp for function documentation
+ */
+WheelCommands mixChassis(double left, double right, double strafe, double limit);
+void splitHolonomicVelocity(double forward, double lateral, double angular, double maxVel, double &velL, double &velR, double &velS);
+
+#endif
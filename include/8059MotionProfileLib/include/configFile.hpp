@@ -0,0 +1,62 @@
+/**
+ * Header file for configFile.cpp
+ * Defines class ConfigFile that reads the text files of the microSD card (gain schedule, base model,
+ * odometry geometry, parameters, scripts) without the heap: the whole file is read into one fixed
+ * buffer and split in place in a single pass, each entry handing out string_views into the buffer
+ *
+ * File format: one entry per line, a key followed by its values
+ *   [section]              starts a section (the entries after it carry its name)
+ *   key value value ...    values separated by spaces, tabs, ',' or '=' ("key = 1, 2" is "key 1 2")
+ *   '#' or ';'             starts a comment
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_CONFIG_FILE_HPP_
+#define _8059_MOTION_PROFILE_LIB_CONFIG_FILE_HPP_
+#include <string_view>
+/**
+ * CONFIG_FILE_SIZE: largest file in bytes (a larger one is refused rather than cut)
+ * CONFIG_MAX_VALUES: most values of an entry
+ */
+#define CONFIG_FILE_SIZE 8192
+#define CONFIG_MAX_VALUES 8
+/**
+ * An entry of the file
+ * section: name of the section it is in (empty before the first [section])
+ * key, values: the words of the line; each ends with a '\0' in the buffer, so data() is also a C string
+ * line: line number (from 1), for error messages
+ */
+struct ConfigEntry{
+  std::string_view section, key;
+  std::string_view values[CONFIG_MAX_VALUES];
+  int valueCount, line;
+  /**
+   * refer to configFile.cpp for function documentation
+   */
+  bool getNumbers(double *numbers, int count) const;
+};
+/**
+ * The class ConfigFile holds the shared file buffer from open() until it is destroyed
+ * (another task opening a file meanwhile waits for it): read the entries with next() and
+ * copy out what is kept, as the views are only valid while the file is open.
+ */
+class ConfigFile{
+public:
+  /**
+   * refer to configFile.cpp for function documentation
+   */
+  ConfigFile();
+  ~ConfigFile();
+  bool open(const char *path);
+  bool next(ConfigEntry &entry);
+  bool failed() const;
+  int getErrorLine() const;
+  void close();
+private:
+  /** unread part of the buffer */
+  char *cursor, *end;
+  std::string_view section;
+  /** number of the line at the cursor, line of the error (0: none, -1: the file is too large) */
+  int line, errorLine;
+  bool holding;
+};
+
+#endif
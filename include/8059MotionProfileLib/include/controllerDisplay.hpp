@@ -0,0 +1,27 @@
+/**
+ * Header file for controllerDisplay.cpp
+ * Defines the controller display: tasks set the text of each controller line, and the
+ * controllerService task sends the changed lines at the rate the controller accepts
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_CONTROLLER_DISPLAY_HPP_
+#define _8059_MOTION_PROFILE_LIB_CONTROLLER_DISPLAY_HPP_
+#include "8059MotionProfileLib/include/taskConfig.hpp"
+#include <cstdarg>
+#include <cstdint>
+// Number of lines and visible columns of the controller screen
+#define DISPLAY_LINES 3
+#define DISPLAY_WIDTH 15
+/**
+ * Text of one controller line, padded with spaces to DISPLAY_WIDTH
+ */
+struct DisplayLine{
+  char text[DISPLAY_WIDTH + 1];
+};
+/**
+ * refer to controllerDisplay.cpp for function documentation
+ */
+void setDisplayLine(int line, const char *fmt, ...);
+void clearDisplay();
+void sendDisplayUpdate();
+
+#endif
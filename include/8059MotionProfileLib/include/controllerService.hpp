@@ -0,0 +1,79 @@
+/**
+ * Header file for controllerService.cpp
+ * Defines the controller service: one task owns all traffic with the master and partner controllers.
+ * It samples the sticks and buttons at a fixed rate into timestamped snapshots, publishes the button
+ * edges on the input event queues (refer to inputService.hpp), and sends the display lines between
+ * samples (refer to controllerDisplay.hpp), so a display write never delays an input read.
+ * Also defines which controller runs the mechanisms when a partner is connected
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_CONTROLLER_SERVICE_HPP_
+#define _8059_MOTION_PROFILE_LIB_CONTROLLER_SERVICE_HPP_
+#include "8059MotionProfileLib/include/inputService.hpp"
+#include "api.h"
+#include <cstdint>
+// Number of controllers (indexed by pros::controller_id_e_t), of stick axes and of buttons of a controller
+#define CONTROLLERS 2
+#define CONTROLLER_AXES 4
+#define CONTROLLER_BUTTONS 12
+/**
+ * Input numbers of the buttons on the input event queues: after the digital inputs, the master's
+ * buttons, then the partner's, each by index (0 for L1 to 11 for A), so
+ * subscribeInputs(controllerInputMask(...)) subscribes to button edges
+ */
+#define CONTROLLER_INPUT_BASE MAX_DIGITAL_INPUTS
+static_assert(CONTROLLER_INPUT_BASE + CONTROLLERS*CONTROLLER_BUTTONS <= 32, "the button inputs must fit the subscription mask");
+static_assert(DISPLAY_DT % CONTROLLER_DT == 0, "DISPLAY_DT must be a multiple of CONTROLLER_DT");
+/**
+ * @param button
+ * a button
+ *
+ * @return
+ * its bit in ControllerState::buttons
+ */
+constexpr uint16_t buttonBit(pros::controller_digital_e_t button){
+  return 1u << (button - pros::E_CONTROLLER_DIGITAL_L1);
+}
+/** Who runs the mechanisms in opcontrol (the master always drives the base) */
+enum MechanismControl{
+  MECHANISM_MASTER,   // the master only (the partner is ignored)
+  MECHANISM_PARTNER,  // the partner while it is connected, else the master
+  MECHANISM_SHARED    // whichever holds a mechanism button; the partner wins when both do
+};
+/**
+ * Mechanism arbitration
+ * MECHANISM_CONTROL: the rule (refer to MechanismControl)
+ * MECHANISM_BUTTONS: buttons of the mechanisms in opcontrol (intake R1 & R2, cycle L1, discard L2),
+ * taken from one controller at a time; the stop (X) works from either controller
+ */
+#define MECHANISM_CONTROL MECHANISM_SHARED
+#define MECHANISM_BUTTONS (buttonBit(DIGITAL_R1) | buttonBit(DIGITAL_R2) | buttonBit(DIGITAL_L1) | buttonBit(DIGITAL_L2))
+/**
+ * One sample of a controller
+ * axes: stick values (-127 to 127), indexed by pros::controller_analog_e_t
+ * buttons: bit i set while button i (pros::controller_digital_e_t - DIGITAL_L1) is held
+ * presses: count of the presses of each button (wraps), so a reader detects new presses by comparing samples
+ * connected: whether the controller is connected (all sticks & buttons read 0 otherwise)
+ * time: micros of the sample
+ */
+struct ControllerState{
+  int8_t axes[CONTROLLER_AXES];
+  uint16_t buttons;
+  uint8_t presses[CONTROLLER_BUTTONS];
+  bool connected;
+  uint64_t time;
+  /**
+   * refer to controllerService.cpp for function documentation
+   */
+  int32_t axis(pros::controller_analog_e_t axis) const;
+  bool held(pros::controller_digital_e_t button) const;
+  bool pressedSince(const ControllerState &prev, pros::controller_digital_e_t button) const;
+};
+/**
+ * refer to controllerService.cpp for function documentation
+ */
+uint32_t controllerInputMask(pros::controller_digital_e_t button, pros::controller_id_e_t id = pros::E_CONTROLLER_MASTER);
+ControllerState getControllerState(pros::controller_id_e_t id = pros::E_CONTROLLER_MASTER);
+const ControllerState &mechanismController(const ControllerState &master, const ControllerState &partner);
+void controllerService(void * ignore);
+
+#endif
@@ -0,0 +1,95 @@
+/**
+ * Header file for coprocessor.cpp
+ * Defines the link to a coprocessor on a smart port in generic serial mode, which takes the heavy work
+ * (path planning, advanced vision) off the brain: the coprocessor task streams the pose out, sends the
+ * requests of the robot's tasks and receives the responses into preallocated slots, which the requesting
+ * task reads in place, so the control loop never waits on the link
+ *
+ * Frame: COBS(payload + CRC) followed by a 0x00 delimiter (as the telemetry frames, refer to serialProtocol.hpp)
+ * payload: type (1 byte, CoprocMessage), id (uint16), body
+ *   COPROC_POSE (out): the pose and the velocity of getPose(), x, y, angle, linVel, angVel (float, refer to PoseState),
+ *   and its timestamp (uint32, micros); the id counts the poses
+ *   COPROC_REQUEST (out): the id of the request, its kind (1 byte, agreed with the coprocessor), its data
+ *   COPROC_RESPONSE (in): the id of the request it answers, its data
+ *   COPROC_MESSAGE (in): unsolicited data (e.g. a new plan), any id
+ * All multi-byte values are little endian.
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_COPROCESSOR_HPP_
+#define _8059_MOTION_PROFILE_LIB_COPROCESSOR_HPP_
+#include <cstdint>
+/**
+ * Link
+ * COPROC_PORT: 0 no coprocessor (the task sleeps), 1-21 the smart port of the coprocessor
+ * COPROC_BAUDRATE: baud rate of the port (the V5 generic serial mode reaches 921600)
+ * COPROC_POSE_DT: the pose is streamed every this many ms
+ */
+#define COPROC_PORT 0
+#define COPROC_BAUDRATE 921600
+#define COPROC_POSE_DT 20
+/**
+ * Buffers (all preallocated)
+ * COPROC_MAX_BODY: largest body of a frame in bytes (a payload with its CRC stays within one COBS block)
+ * COPROC_RX_SLOTS: received frames held at once (responses and messages not released yet, and the one being received)
+ * COPROC_TX_QUEUE: requests queued for sending
+ * COPROC_EXPIRY: a received frame nobody takes within this many ms is dropped, so its slot is not lost
+ */
+#define COPROC_MAX_BODY 240
+#define COPROC_RX_SLOTS 8
+#define COPROC_TX_QUEUE 8
+#define COPROC_EXPIRY 1000
+// Bytes of a received frame before decoding: payload (type, id, body) and CRC, COBS overhead and the delimiter
+#define COPROC_FRAME_BYTES (3 + COPROC_MAX_BODY + 2 + 2)
+/** Frame types */
+enum CoprocMessage{
+  COPROC_POSE = 1,
+  COPROC_REQUEST,
+  COPROC_RESPONSE,
+  COPROC_MESSAGE
+};
+/**
+ * A received frame, in its slot
+ * type, id: refer to CoprocMessage
+ * body, length: its data (pointing into the slot's buffer, decoded in place) and its length in bytes
+ * time: millis() at its reception
+ * data: the bytes as received, then decoded
+ */
+struct CoprocFrame{
+  uint8_t type;
+  uint16_t id;
+  const uint8_t *body;
+  int length;
+  uint32_t time;
+  uint8_t data[COPROC_FRAME_BYTES];
+};
+/**
+ * A queued request
+ * id, kind: refer to COPROC_REQUEST
+ * length, data: its data
+ */
+struct CoprocRequest{
+  uint16_t id;
+  uint8_t kind;
+  uint8_t length;
+  uint8_t data[COPROC_MAX_BODY - 1];
+};
+/**
+ * Link counters since the start
+ * received: frames received; corrupt: frames dropped for their CRC, length or type; expired: frames
+ * dropped after COPROC_EXPIRY; posesSent, requestsSent: frames sent; requestDrops: requests refused (full queue)
+ */
+struct CoprocStats{
+  uint32_t received, corrupt, expired;
+  uint32_t posesSent, requestsSent, requestDrops;
+};
+/**
+ * refer to coprocessor.cpp for function documentation
+ */
+uint16_t coprocRequest(uint8_t kind, const void *data, int length);
+const CoprocFrame *coprocTakeResponse(uint16_t id);
+const CoprocFrame *coprocWaitResponse(uint16_t id, uint32_t timeout);
+const CoprocFrame *coprocTakeMessage();
+void coprocRelease(const CoprocFrame *frame);
+CoprocStats getCoprocStats();
+void coprocessor(void * ignore);
+
+#endif
@@ -0,0 +1,56 @@
+/**
+ * Header file for currentBudget.cpp
+ * Defines the current budget arbiter: the brain can only share so much current among its motors, and
+ * when every subsystem pulls at once the firmware cuts them all alike, so the base loses torque mid-path.
+ * Instead, each subsystem states its demand (the base from its profile, the mechanisms from the shooter
+ * state machine) and the arbiter splits a total budget by demand, then by priority, through the motors'
+ * current limits: the base gets full current while launching, the shooter while firing
+ * Once the battery model knows the battery's resistance (refer to batteryModel.hpp), the total is also held to
+ * the current that keeps the battery above BATTERY_MIN_VOLTAGE, so a drained battery never browns out the brain,
+ * and the sum of the limits of the subsystems at work is the current the voltage compensation plans for
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_CURRENT_BUDGET_HPP_
+#define _8059_MOTION_PROFILE_LIB_CURRENT_BUDGET_HPP_
+#include "8059MotionProfileLib/include/motorHealth.hpp"
+/**
+ * Budget (mA)
+ * BUDGET_TOTAL_CURRENT: current shared by the eight motors (all at HEALTH_CURRENT_LIMIT would be 20000)
+ * BUDGET_IDLE_CURRENT: limit every motor keeps, whatever the demands (enough to hold a mechanism)
+ * BUDGET_RUNNING_CURRENT: limit a running subsystem is raised to before the leftover is shared
+ * A subsystem at its peak is raised to HEALTH_CURRENT_LIMIT.
+ * BUDGET_TOTAL_STEP: change of the battery's reach that resends the limits (refer to refreshCurrentBudget)
+ * BUDGET_LAUNCH_ACC: profile acceleration (inches per second squared) above which a side speeding up
+ *   is a launch (refer to baseCurrentDemand)
+ */
+#define BUDGET_TOTAL_CURRENT 15000
+#define BUDGET_IDLE_CURRENT 500
+#define BUDGET_RUNNING_CURRENT 1800
+#define BUDGET_TOTAL_STEP 500
+#define BUDGET_LAUNCH_ACC 10
+/**
+ * Subsystems, in priority order (the first gets the budget first at the same demand)
+ */
+enum BudgetSubsystem{
+  BUDGET_BASE,      // the four base motors
+  BUDGET_SHOOTER,
+  BUDGET_INDEXER,
+  BUDGET_ROLLERS,   // both rollers
+  BUDGET_SUBSYSTEMS
+};
+/** Demand of a subsystem */
+enum CurrentDemand{
+  CURRENT_IDLE,     // stopped or holding: BUDGET_IDLE_CURRENT, plus what is left over
+  CURRENT_RUNNING,  // moving: BUDGET_RUNNING_CURRENT once the peaks are served
+  CURRENT_PEAK      // launching (base) or firing (shooter): HEALTH_CURRENT_LIMIT first
+};
+/**
+ * refer to currentBudget.cpp for function documentation
+ */
+void allocateCurrentBudget(const CurrentDemand *demands, int32_t total, int32_t *limits);
+void setCurrentDemand(BudgetSubsystem subsystem, CurrentDemand demand);
+void refreshCurrentBudget();
+CurrentDemand getCurrentDemand(BudgetSubsystem subsystem);
+int32_t getCurrentLimit(HealthMotor motor);
+int32_t getPlannedCurrent();
+
+#endif
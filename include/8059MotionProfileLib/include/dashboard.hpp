@@ -0,0 +1,44 @@
+/**
+ * Header file for dashboard.cpp
+ * Defines the brain screen dashboard: the robot on a field map, the planned (pursuit) path and the loop
+ * timing of the sensing & control tasks, drawn with LVGL by a task at the lowest priority that only touches
+ * the objects whose pixels changed, within a time budget per frame
+ * Rendering: the dashboard task only changes objects; LVGL then redraws the invalidated areas through its
+ * virtual display buffer and flushes them from the PROS display task (lv_task_handler, in libpros.a), so
+ * neither ever runs in a real-time task.
+ * Display memory: LVGL is built into libpros.a, whose lv_conf.h (LV_MEM_CUSTOM) allocates every object
+ * from the kernel heap (kmalloc), shared with the task stacks, not from the user heap. buildDisplay()
+ * creates every object of the brain screen in initialize() and the labels show static buffers, so the
+ * screen never allocates afterwards; its footprint and the kernel heap high-water mark are reported
+ * by the resource monitor (TELEMETRY_DISPLAY) and on the dashboard.
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_DASHBOARD_HPP_
+#define _8059_MOTION_PROFILE_LIB_DASHBOARD_HPP_
+#include <cstdint>
+/**
+ * Field map
+ * DASHBOARD_FIELD_PX: side of the map in pixels (the screen is 480x240)
+ * DASHBOARD_FIELD_SIZE: side of the field in inches
+ * DASHBOARD_ORIGIN_X, DASHBOARD_ORIGIN_Y: odometry origin in inches from the field's bottom left corner
+ * DASHBOARD_ROBOT_PX: side of the robot marker in pixels
+ * DASHBOARD_HEADING_PX: length of the heading line in pixels
+ */
+#define DASHBOARD_FIELD_PX 240
+#define DASHBOARD_FIELD_SIZE 144
+#define DASHBOARD_ORIGIN_X 72
+#define DASHBOARD_ORIGIN_Y 72
+#define DASHBOARD_ROBOT_PX 10
+#define DASHBOARD_HEADING_PX 14
+// Refresh period of the timing statistics in ms (the pose is redrawn every DASHBOARD_DT)
+#define DASHBOARD_STATS_DT 1000
+// Drawing time of a frame in micros after which the remaining jobs wait for the next frame (at least one runs)
+#define DASHBOARD_FRAME_BUDGET 2000
+/**
+ * refer to dashboard.cpp for function documentation
+ */
+void buildDisplay();
+uint32_t getDisplayFootprint();
+void showDashboard();
+void dashboard(void * ignore);
+
+#endif
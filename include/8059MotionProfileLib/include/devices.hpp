@@ -0,0 +1,38 @@
+/**
+ * Header file for devices.cpp
+ * Declares every device of the robot. Each is constructed once, statically, with its full
+ * configuration (gearset, reversal, encoder units), and every module uses these objects:
+ * no module or competition function constructs a device of its own
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_DEVICES_HPP_
+#define _8059_MOTION_PROFILE_LIB_DEVICES_HPP_
+#include "api.h"
+#include "8059MotionProfileLib/include/drivetrain.hpp"
+#include "8059MotionProfileLib/include/baseOdometry.hpp"
+/**
+ * Devices (ports from robotConfig.hpp)
+ * drivetrain: the four base motors (refer to drivetrain.hpp)
+ * lRoller, rRoller, indexer, shooter: mechanism motors (refer to mech_lib.hpp)
+ * encoderL, encoderR, encoderS: tracking wheels (encoderS if ODOM_THREE_WHEEL)
+ * imu: inertial sensor (if ODOM_USE_IMU); ultrasonic: wall ranging (if ODOM_USE_ULTRASONIC)
+ * color: ball color sensor; vision: vision sensor (refer to visionService.hpp)
+ * master, partner: the controllers (only used by the controllerService task, refer to controllerService.hpp)
+ * The limit switch is read by the input service (refer to addDigitalInput), which configures its port.
+ */
+extern Drivetrain drivetrain;
+extern pros::Motor lRoller, rRoller, indexer, shooter;
+extern pros::ADIEncoder encoderL, encoderR;
+#if ODOM_THREE_WHEEL
+extern pros::ADIEncoder encoderS;
+#endif
+#if ODOM_USE_IMU
+extern pros::Imu imu;
+#endif
+#if ODOM_USE_ULTRASONIC
+extern pros::ADIUltrasonic ultrasonic;
+#endif
+extern pros::ADIAnalogIn color;
+extern pros::Vision vision;
+extern pros::Controller master, partner;
+
+#endif
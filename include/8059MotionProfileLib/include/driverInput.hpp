@@ -0,0 +1,93 @@
+/**
+ * Header file for driverInput.cpp
+ * Defines the driver input pipeline of opcontrol: stick deadband and response curve (a 256-entry
+ * table generated at compile time), arcade & tank mixing, slew limiting of each side, the
+ * driver assists (turn closed on the odometry heading while a button is held) and the button
+ * bindings, run on controller samples (live, or replayed by inputMacro.hpp)
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_DRIVER_INPUT_HPP_
+#define _8059_MOTION_PROFILE_LIB_DRIVER_INPUT_HPP_
+#include "8059MotionProfileLib/include/controllerService.hpp"
+#include "api.h"
+#include <cstdint>
+/** Shapes of the stick response past the deadband (x: stick travel, 0 to 1) */
+enum ResponseCurve{
+  CURVE_LINEAR,       // x
+  CURVE_EXPONENTIAL,  // (e^(k*x) - 1)/(e^k - 1), k = DRIVE_EXPO_K
+  CURVE_CUBIC         // (1 - w)*x + w*x^3, w = DRIVE_CUBIC_WEIGHT
+};
+/**
+ * Stick response
+ * DRIVE_CURVE: shape of the response (fine control near the centre, full power at the end)
+ * DRIVE_DEADBAND: stick values (sign ignored) that give 0, so stick drift does not creep the base
+ * DRIVE_EXPO_K: steepness of CURVE_EXPONENTIAL
+ * DRIVE_CUBIC_WEIGHT: share of x^3 in CURVE_CUBIC (0 linear to 1 pure cubic)
+ * DRIVE_TURN_SCALE: fraction of the turn stick that is mixed into arcade drive
+ */
+#define DRIVE_CURVE CURVE_CUBIC
+#define DRIVE_DEADBAND 5
+#define DRIVE_EXPO_K 3
+#define DRIVE_CUBIC_WEIGHT 0.6
+#define DRIVE_TURN_SCALE 1
+/**
+ * Output
+ * DRIVE_SLEW: largest power change of a side per call (opcontrol loop); 254 for none
+ * DRIVE_BRAKE_MODE: brake mode of the base motors while driving (refer to pros::motor_brake_mode_e_t)
+ */
+#define DRIVE_SLEW 20
+#define DRIVE_BRAKE_MODE pros::E_MOTOR_BRAKE_COAST
+/** Driver assists of arcade drive: what closes the turn on the live heading */
+enum DriverAssist{
+  ASSIST_NONE,          // turn stick only
+  ASSIST_HOLD_HEADING,  // hold the heading while the turn stick is centred (the stick still turns)
+  ASSIST_AIM_GOAL       // turn to face the goal (the vision target, else setAssistGoal's point), ignoring the turn stick
+};
+/**
+ * Driver assist
+ * ASSIST_HOLD_BUTTON, ASSIST_AIM_BUTTON: controller buttons that engage the assists while held
+ * ASSIST_GOAL_X, ASSIST_GOAL_Y: default goal point of ASSIST_AIM_GOAL in inches (odometry coordinates)
+ * ASSIST_AIM_RANGE, ASSIST_AIM_CONE: ASSIST_AIM_GOAL turns to the nearest field goal within this many inches and
+ *   degrees either side of the heading as it engages (refer to fieldElementAhead), else to the goal point
+ * ASSIST_KP: turn power per degree of heading error
+ * ASSIST_KD: turn power per degree/s of heading error change
+ * ASSIST_MAX_TURN: largest turn power of an assist
+ */
+#define ASSIST_HOLD_BUTTON DIGITAL_B
+#define ASSIST_AIM_BUTTON DIGITAL_A
+#define ASSIST_GOAL_X 0
+#define ASSIST_GOAL_Y 72
+#define ASSIST_AIM_RANGE 72
+#define ASSIST_AIM_CONE 30
+#define ASSIST_KP 3
+#define ASSIST_KD 0.08
+#define ASSIST_MAX_TURN 80
+// Controller button that toggles between arcade and tank drive
+#define DRIVE_TANK_BUTTON DIGITAL_Y
+/**
+ * Stick value (sign ignored) of a drive stick that takes the base back from a movement the base
+ * controller drives in BASE_MODE_ASSIST (refer to baseControl.hpp)
+ */
+#define DRIVE_ASSIST_OVERRIDE 30
+/**
+ * State of the driver pipeline between its cycles (refer to runDriverControls)
+ * tankDrive: tank drive chosen, else arcade
+ * prev: master sample of the previous cycle (new presses are counted from it)
+ * assisted: the base controller drove the base in the previous cycle (BASE_MODE_ASSIST)
+ */
+struct DriverControls{
+  bool tankDrive;
+  ControllerState prev;
+  bool assisted;
+};
+/**
+ * refer to driverInput.cpp for function documentation
+ */
+int32_t shapeStick(int32_t stick);
+void resetDriverInput();
+void setAssistGoal(double x, double y);
+void driveArcade(int32_t forward, int32_t turn, DriverAssist assist = ASSIST_NONE);
+void driveTank(int32_t left, int32_t right);
+void resetDriverControls(DriverControls &controls, const ControllerState &master);
+void runDriverControls(DriverControls &controls, const ControllerState &master, const ControllerState &partner);
+
+#endif
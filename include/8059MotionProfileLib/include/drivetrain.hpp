@@ -0,0 +1,58 @@
+/**
+ * Header file for drivetrain.cpp
+ * Defines class Drivetrain that groups the base motors by side (like okapi::MotorGroup, which the
+ * host simulation cannot link), so each side is set in one call and read as one encoder
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_DRIVETRAIN_HPP_
+#define _8059_MOTION_PROFILE_LIB_DRIVETRAIN_HPP_
+#include "api.h"
+#include <cstdint>
+/** base motors, as indexed by the per-motor readings */
+enum BaseMotor{
+  BASE_FRONT_LEFT,
+  BASE_BACK_LEFT,
+  BASE_FRONT_RIGHT,
+  BASE_BACK_RIGHT,
+  BASE_MOTORS
+};
+// Raw encoder counts per encoder degree of the base motors (900 counts per turn on the green cartridge)
+#define DRIVE_COUNTS_PER_DEG (900.0/360)
+/**
+ * The class Drivetrain owns the four base motors (green cartridge, degrees, right side reversed).
+ * Every write goes through the motor output layer (refer to motorOutput.hpp).
+ */
+class Drivetrain{
+public:
+  /**
+   * refer to drivetrain.cpp for function documentation
+   */
+  Drivetrain(uint8_t frontLeft, uint8_t backLeft, uint8_t frontRight, uint8_t backRight);
+  void setPower(int32_t left, int32_t right);
+  void setPower(int32_t left, int32_t right, int32_t strafe);
+  void setVoltage(int32_t left, int32_t right);
+  void setVoltage(int32_t left, int32_t right, int32_t strafe);
+  void setVelocity(int32_t left, int32_t right);
+  void setVelocity(int32_t left, int32_t right, int32_t strafe);
+  void stop();
+  void setBrakeMode(pros::motor_brake_mode_e_t mode);
+  void setBrakeMode(pros::motor_brake_mode_e_t left, pros::motor_brake_mode_e_t right);
+  void setCurrentLimit(BaseMotor motor, int32_t limit);
+  void tare();
+  double getLeftPosition() const;
+  double getRightPosition() const;
+  int32_t getLeftRawPosition(uint32_t *timestamp) const;
+  int32_t getRightRawPosition(uint32_t *timestamp) const;
+  int32_t getLeftVoltage() const;
+  int32_t getRightVoltage() const;
+  int32_t getCurrent(BaseMotor motor) const;
+  double getPosition(BaseMotor motor) const;
+  double getVelocity(BaseMotor motor) const;
+  double getTemperature(BaseMotor motor) const;
+  bool isOverTemp(BaseMotor motor) const;
+private:
+  const pros::Motor &getMotor(BaseMotor motor) const;
+  pros::Motor frontLeft, backLeft, frontRight, backRight;
+};
+// the base is constructed by the device registry (refer to devices.hpp)
+
+#endif
@@ -0,0 +1,53 @@
+/**
+ * Header file for dryRun.cpp
+ * Defines the dry run of an autonomous routine on the robot, to time an edited route in the pits without field
+ * space: the motor outputs are held at 0 (refer to holdMotorOutputs), the base sensors are replaced by the
+ * drivetrain model (the kS/kV/kA sides of baseModel.hpp) driven by the commands the base would have received,
+ * and the motions and waits of the routine are logged and printed as a predicted timeline with its total.
+ * The model is stepped by the odometry task in place of the sensor reads, so the odometry, the control loop and the
+ * motion queue run unchanged on it. The run takes real time: the V5 clock cannot be sped up (the host simulation
+ * runs the same routines faster than real time, `./bin/sim golden`). The model has no field walls and no
+ * mechanisms: wall squaring and the mechanism waits run out of time, which the timeline shows.
+ * A tank drive is modelled (the strafe of a holonomic base is left out).
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_DRY_RUN_HPP_
+#define _8059_MOTION_PROFILE_LIB_DRY_RUN_HPP_
+#include "8059MotionProfileLib/include/baseOdometry.hpp"
+#include <cstdint>
+/**
+ * DRY_RUN_BUTTON: master button that dry runs the selected routine in opcontrol (off the competition switch)
+ * DRY_RUN_ACTIONS: motions and waits logged per run (more are counted, not logged)
+ * DRY_RUN_STEP: integration step of the model in micros
+ * DRY_RUN_VELOCITY_KP: power per in/s of error of a velocity command (the motors' own velocity loop)
+ * DRY_RUN_TIMEOUT: time in ms the dry run waits for the motions after the routine returns
+ */
+#define DRY_RUN_BUTTON DIGITAL_DOWN
+#define DRY_RUN_ACTIONS 128
+#define DRY_RUN_STEP 1000
+#define DRY_RUN_VELOCITY_KP 2
+#define DRY_RUN_TIMEOUT 15000
+/**
+ * A logged action
+ * start, end: micros() of its start and end (lower 32 bits)
+ * type: TIMELINE_MOTION_START for a motion, TIMELINE_WAIT_BEGIN for a wait of the routine
+ * id: MotionType or TimelineWait; outcome: TimelineMotionEnd of a motion, 1 for a wait that ran out of time
+ * done: the action ended
+ */
+struct DryRunAction{
+  uint32_t start, end;
+  uint8_t type, id, outcome;
+  bool done;
+};
+/**
+ * refer to dryRun.cpp for function documentation
+ */
+void startDryRun();
+void stopDryRun();
+bool isDryRun();
+void stepDryRun();
+SensorFrame getDryRunFrame();
+void logDryRunEvent(int type, int id, int arg, uint32_t time);
+void printDryRun(const char *name, uint32_t total);
+uint32_t dryRunAuton(int id);
+
+#endif
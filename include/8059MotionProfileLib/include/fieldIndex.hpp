@@ -0,0 +1,68 @@
+/**
+ * Header file for fieldIndex.cpp
+ * Defines the spatial index of the field elements: a uniform grid over the field, generated at compile time (read-only),
+ * so the driver assists and the autonomous logic can ask every cycle for the nearest goal to a point, the goals within
+ * a range, or the goal in front of the robot. Each cell keeps the elements inside it, and per type the candidates for
+ * the nearest element to any point of the cell: the elements no farther from the cell than the closest one's farthest
+ * corner. A nearest query is a table lookup and at most FIELD_INDEX_CANDIDATES distances; a range query only visits
+ * the cells the range covers.
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_FIELD_INDEX_HPP_
+#define _8059_MOTION_PROFILE_LIB_FIELD_INDEX_HPP_
+#include "8059MotionProfileLib/include/dashboard.hpp"
+#include <cstdint>
+/**
+ * Grid
+ * FIELD_INDEX_CELL: side of a cell in inches
+ * FIELD_INDEX_GRID: cells per side (the field is 144 inches)
+ * FIELD_INDEX_CANDIDATES: most nearest candidates of a type in a cell (checked at compile time)
+ * FIELD_ORIGIN_X, FIELD_ORIGIN_Y: odometry origin in inches from the field's bottom left corner
+ */
+#define FIELD_INDEX_CELL 24
+#define FIELD_INDEX_GRID 6
+#define FIELD_INDEX_CANDIDATES 4
+#define FIELD_ORIGIN_X DASHBOARD_ORIGIN_X
+#define FIELD_ORIGIN_Y DASHBOARD_ORIGIN_Y
+// Number of field elements (refer to fieldElements in fieldIndex.cpp)
+#define FIELD_ELEMENTS 9
+/** Types of the field elements */
+enum FieldElementType{
+  FIELD_GOAL,
+  FIELD_ELEMENT_TYPES
+};
+/** An element of fixed position, in inches from the field's bottom left corner */
+struct FieldElement{
+  FieldElementType type;
+  double x, y;
+};
+/**
+ * The index (generated by makeFieldIndex)
+ * cellStart, cellElements: the elements inside cell c (row major from the bottom left) are
+ *   cellElements[cellStart[c]] to cellElements[cellStart[c + 1] - 1]
+ * nearest: per type and cell, the candidates for the nearest element (FIELD_ELEMENTS after the last)
+ * overflow: a cell has more than FIELD_INDEX_CANDIDATES candidates of a type
+ */
+struct FieldIndex{
+  uint8_t cellStart[FIELD_INDEX_GRID*FIELD_INDEX_GRID + 1];
+  uint8_t cellElements[FIELD_ELEMENTS];
+  uint8_t nearest[FIELD_ELEMENT_TYPES][FIELD_INDEX_GRID*FIELD_INDEX_GRID][FIELD_INDEX_CANDIDATES];
+  bool overflow;
+};
+/**
+ * An element found by a query
+ * element: its index in fieldElements (fieldIndex.cpp)
+ * x, y: its position in inches (odometry coordinates)
+ * distance: from the point of the query in inches
+ */
+struct FieldHit{
+  int element;
+  double x, y, distance;
+};
+/**
+ * refer to fieldIndex.cpp for function documentation
+ */
+bool nearestFieldElement(FieldElementType type, double x, double y, FieldHit &hit);
+int fieldElementsInRange(FieldElementType type, double x, double y, double range, FieldHit *hits, int size);
+bool fieldElementAhead(FieldElementType type, double x, double y, double angle, double range, double halfAngle, FieldHit &hit);
+
+#endif
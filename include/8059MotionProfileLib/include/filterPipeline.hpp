@@ -0,0 +1,87 @@
+/**
+ * Header file for statically composed filters
+ * Defines the filter stages Median<N>, Mean<N> and Ema<NUM, DEN> and Pipeline<Stages...>, which runs a sample
+ * through its stages in order (e.g. Pipeline<Median<3>, Ema<1, 5>>: the median of the last 3 samples, smoothed).
+ * Header only, and unlike okapi's filters (a virtual filter() per stage, ComposableFilter holding its stages on
+ * the heap) the stages are template arguments: a pipeline is a plain aggregate with its state inline, the calls
+ * inline into the caller (with constant loop bounds), and it can sit in a frame or an array of channels.
+ * Every stage has double filter(double) (returns the new output), double getOutput() and void reset(); a stage
+ * zero-initialized by = {} is reset.
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_FILTER_PIPELINE_HPP_
+#define _8059_MOTION_PROFILE_LIB_FILTER_PIPELINE_HPP_
+/**
+ * Median of the last N samples (as okapi's MedianFilter: the window starts filled with zeros, and the lower
+ * of the two middle samples is taken for an even N)
+ */
+template<int N> struct Median{
+  static_assert(N > 0, "a median needs a sample");
+  double samples[N];
+  int index;
+  double output;
+  double filter(double value){
+    samples[index] = value;
+    index = index + 1 < N? index + 1 : 0;
+    /** insertion sort of a copy (N is small, and the bounds are constant) */
+    double sorted[N];
+    for(int i = 0; i < N; i++){
+      int j = i;
+      for(; j > 0 && sorted[j - 1] > samples[i]; j--) sorted[j] = sorted[j - 1];
+      sorted[j] = samples[i];
+    }
+    return output = sorted[(N - 1)/2];
+  }
+  double getOutput() const{ return output; }
+  void reset(){ *this = {}; }
+};
+/**
+ * Mean of the last N samples (of the samples so far until N are in)
+ */
+template<int N> struct Mean{
+  static_assert(N > 0, "a mean needs a sample");
+  double samples[N];
+  int count, index;
+  double output;
+  double filter(double value){
+    samples[index] = value;
+    index = index + 1 < N? index + 1 : 0;
+    if(count < N) count++;
+    double sum = 0;
+    for(int i = 0; i < count; i++) sum += samples[i];
+    return output = sum/count;
+  }
+  double getOutput() const{ return output; }
+  void reset(){ *this = {}; }
+};
+/**
+ * Exponential moving average: a new sample weighs NUM/DEN (the output starts at 0)
+ */
+template<int NUM, int DEN> struct Ema{
+  static_assert(NUM > 0 && NUM <= DEN, "the weight of a sample is in (0, 1]");
+  static constexpr double alpha = (double)NUM/DEN;
+  double output;
+  double filter(double value){ return output += alpha*(value - output); }
+  double getOutput() const{ return output; }
+  void reset(){ *this = {}; }
+};
+/**
+ * The stages in order: each filters the output of the one before it, and the output is the last one's
+ */
+template<typename First, typename... Rest> struct Pipeline{
+  First first;
+  Pipeline<Rest...> rest;
+  double filter(double value){ return rest.filter(first.filter(value)); }
+  double getOutput() const{ return rest.getOutput(); }
+  void reset(){
+    first.reset();
+    rest.reset();
+  }
+};
+template<typename Last> struct Pipeline<Last>{
+  Last last;
+  double filter(double value){ return last.filter(value); }
+  double getOutput() const{ return last.getOutput(); }
+  void reset(){ last.reset(); }
+};
+
+#endif
@@ -0,0 +1,79 @@
+/**
+ * Header file for fixed-point arithmetic
+ * Defines the Q16.16 type and its operations, used by the fixed-point control path
+ * (header only so that the operations are inlined into the control loop)
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_FIXED_POINT_HPP_
+#define _8059_MOTION_PROFILE_LIB_FIXED_POINT_HPP_
+#include <cstdint>
+/**
+ * Q16.16: 16 integer bits (range about -32768 to 32767) and 16 fraction bits
+ * (resolution 1/65536). Products are computed in 64 bits before shifting back.
+ */
+typedef int32_t fixed_t;
+#define FIXED_SHIFT 16
+#define FIXED_ONE (1 << FIXED_SHIFT)
+/**
+ * Convert a double to Q16.16 (rounded to nearest).
+ * @param x
+ * value within the Q16.16 range
+ *
+ * @return
+ * fixed-point value
+ */
+inline fixed_t toFixed(double x){
+  return (fixed_t)(x*FIXED_ONE + (x < 0? -0.5 : 0.5));
+}
+/**
+ * Convert an integer to Q16.16.
+ * @param x
+ * integer within the Q16.16 range
+ *
+ * @return
+ * fixed-point value
+ */
+inline fixed_t intToFixed(int32_t x){
+  return (fixed_t)((uint32_t)x << FIXED_SHIFT);
+}
+/**
+ * Convert Q16.16 to a double.
+ * @param x
+ * fixed-point value
+ *
+ * @return
+ * value as a double
+ */
+inline double fromFixed(fixed_t x){
+  return x/(double)FIXED_ONE;
+}
+/**
+ * Convert Q16.16 to the nearest integer.
+ * @param x
+ * fixed-point value
+ *
+ * @return
+ * rounded integer
+ */
+inline int32_t fixedToInt(fixed_t x){
+  return (x + (FIXED_ONE >> 1)) >> FIXED_SHIFT;
+}
+/**
+ * Multiply two Q16.16 values.
+ * @return
+ * a*b in Q16.16
+ */
+inline fixed_t fixedMul(fixed_t a, fixed_t b){
+  return (fixed_t)(((int64_t)a*b) >> FIXED_SHIFT);
+}
+/**
+ * Cap a Q16.16 value to |x| <= cap (fixed-point version of abscap).
+ * @return
+ * capped value
+ */
+inline fixed_t fixedCap(fixed_t x, fixed_t cap){
+  if(x > cap) return cap;
+  else if(x < -cap) return -cap;
+  else return x;
+}
+
+#endif
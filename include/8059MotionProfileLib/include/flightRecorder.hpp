@@ -0,0 +1,87 @@
+/**
+ * Header file for flightRecorder.cpp
+ * Defines the flight recorder that logs every control frame of a run to the microSD card,
+ * writing whole blocks from a background task so the control tasks never wait on the card;
+ * the same task writes the execution timeline of each run (refer to timeline.hpp)
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_FLIGHT_RECORDER_HPP_
+#define _8059_MOTION_PROFILE_LIB_FLIGHT_RECORDER_HPP_
+#include "8059MotionProfileLib/include/baseControl.hpp"
+#include "8059MotionProfileLib/include/baseOdometry.hpp"
+#include "8059MotionProfileLib/include/serialProtocol.hpp"
+#include "8059MotionProfileLib/include/taskConfig.hpp"
+#include <cstdint>
+#include <cstdio>
+// Size of each of the two buffers (a multiple of the card's 512 byte sectors)
+#define RECORDER_BLOCK 8192
+// printf format of the run file names (the host simulation writes them to bin/ instead)
+#ifndef RECORDER_PATH
+#define RECORDER_PATH "/usd/run%03d.bin"
+#endif
+// File header identification ("8059" in ASCII) and format version
+#define RECORDER_FILE_MAGIC 0x39353038
+#define RECORDER_FILE_VERSION 14
+/**
+ * Delta coding of the records (refer to deltaEncode in serialProtocol.hpp)
+ * RECORDER_KEYFRAME_INTERVAL: every this many records one is a keyframe (coded from 0), and so is
+ * the first record after a dropped one
+ * RECORDER_KEYFRAME & RECORDER_DELTA: kind byte of a coded record
+ */
+#define RECORDER_KEYFRAME_INTERVAL 50
+#define RECORDER_KEYFRAME 1
+#define RECORDER_DELTA 0
+/** which part of the match a record comes from */
+enum RecorderMode{
+  RECORDER_AUTON,
+  RECORDER_DRIVER
+};
+/**
+ * One record per control cycle
+ * mode: RecorderMode
+ * frame: the control frame, including its sensor frame
+ * pose: pose at the time of the frame
+ * corrections: number of pose corrections applied so far (refer to correctPose)
+ */
+struct FlightRecord{
+  uint32_t mode;
+  BaseControlFrame frame;
+  PoseSnapshot pose;
+  uint32_t corrections;
+};
+// Words of a record (the unit of the delta coding) and the largest coded record
+#define RECORDER_WORDS (sizeof(FlightRecord)/sizeof(uint64_t))
+#define RECORDER_MAX_CODED (3 + DELTA_MAX_BYTES(RECORDER_WORDS))
+static_assert(sizeof(FlightRecord) % sizeof(uint64_t) == 0, "records are coded in 64-bit words");
+/**
+ * Reading state of a run file (refer to readFlightRecord)
+ * prev: words of the previous record
+ * synced: a keyframe has been read (the deltas before the first one cannot be decoded)
+ */
+struct FlightRecordReader{
+  FILE *file;
+  uint64_t prev[RECORDER_WORDS];
+  bool synced;
+};
+/**
+ * Header at the start of each file (/usd/runNNN.bin), followed by the coded FlightRecords:
+ * kind (1 byte, RECORDER_KEYFRAME or RECORDER_DELTA), length of the rest (uint16, little endian), then
+ * the 64-bit words of the record coded by deltaEncode against the previous record (from 0 in a keyframe).
+ * The lengths let a reader skip records without decoding them, and start decoding at any keyframe.
+ * recordSize lets a decoder reject files written by a different FlightRecord layout.
+ * geometry: tracking wheel geometry of the odometry when the file was opened (refer to OdometryGeometry)
+ */
+struct RecorderFileHeader{
+  uint32_t magic, version, recordSize;
+  OdometryGeometry geometry;
+};
+/**
+ * refer to flightRecorder.cpp for function documentation
+ */
+void startRecorder();
+void stopRecorder();
+bool recordFlight(RecorderMode mode, const BaseControlFrame &frame);
+uint32_t getRecorderDrops();
+bool readFlightRecord(FlightRecordReader &reader, FlightRecord &record);
+void flightRecorder(void * ignore);
+
+#endif
@@ -0,0 +1,58 @@
+/**
+ * Header file for gainSchedule.cpp
+ * Defines the gain schedule of the base: PD gains looked up per movement by its type and size,
+ * optionally compensated for the battery voltage, and saved on the microSD card (refer to gainTuner.hpp)
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_GAIN_SCHEDULE_HPP_
+#define _8059_MOTION_PROFILE_LIB_GAIN_SCHEDULE_HPP_
+// Pass as kp or kd to a movement function to look the gain up in the schedule (the default)
+#define GAIN_SCHEDULED -1
+/**
+ * Gain bands: a movement takes the gains of the first band its size fits in
+ * (moves: inches of travel, turns: degrees). Short movements need more kP to settle
+ * quickly from a small error; long ones less, so they do not overshoot.
+ * The middle bands hold DEFAULT_KP/KD and DEFAULT_TURN_KP/KD.
+ * A movement multiplies the gains it looks up by PARAM_GAIN_KP_SCALE and PARAM_GAIN_KD_SCALE (1 by default,
+ * refer to paramTable.hpp), so the whole schedule can be scaled live without retuning each band.
+ */
+#define GAIN_BANDS 3
+#define MOVE_GAIN_SCHEDULE {{6, 0.8, 2.5}, {36, 0.5, 2}, {1e9, 0.4, 2}}
+#define TURN_GAIN_SCHEDULE {{30, 1.0, 0.4}, {120, 0.7, 0.3}, {1e9, 0.6, 0.3}}
+/**
+ * Battery compensation of the scheduled gains: the same power gives less torque on a
+ * drained battery, so the gains are scaled by GAIN_BATTERY_NOMINAL / battery voltage
+ * GAIN_BATTERY_COMP: 0 off, 1 on (off while the motor output layer compensates the commands
+ *   themselves, refer to MOTOR_VOLTAGE_COMPENSATION)
+ * GAIN_BATTERY_NOMINAL: voltage the schedule is tuned at (mV)
+ * GAIN_BATTERY_MIN_SCALE & GAIN_BATTERY_MAX_SCALE: limits of the scale
+ */
+#define GAIN_BATTERY_COMP (!MOTOR_VOLTAGE_COMPENSATION)
+#define GAIN_BATTERY_NOMINAL 12800
+#define GAIN_BATTERY_MIN_SCALE 0.9
+#define GAIN_BATTERY_MAX_SCALE 1.25
+/**
+ * Schedule file on the microSD card, loaded at initialization if it exists
+ * One band per line: "move" or "turn", maxSize, kp, kd (the moves first, by increasing maxSize)
+ */
+#ifndef GAIN_FILE_PATH
+#define GAIN_FILE_PATH "/usd/gains.txt"
+#endif
+/**
+ * One band of the schedule
+ * maxSize: largest movement size of the band (inches or degrees)
+ * kp, kd: gains of the band
+ */
+struct GainBand{
+  double maxSize, kp, kd;
+};
+/**
+ * refer to gainSchedule.cpp for function documentation
+ */
+void setGainSchedule(bool turn, const GainBand *bands);
+void setGainBand(bool turn, double size, double kp, double kd);
+bool loadGainSchedule();
+bool saveGainSchedule();
+GainBand getScheduledGains(bool turn, double size);
+double getBatteryGainScale();
+
+#endif
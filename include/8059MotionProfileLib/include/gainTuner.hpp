@@ -0,0 +1,60 @@
+/**
+ * Header file for gainTuner.cpp
+ * Defines class GainTuner that tunes the base PD gains on the robot with a particle swarm
+ * (after okapi::PIDTuner, which drives its own controller and cannot run the control pipeline)
+ * Every particle runs a test movement out and back through the movement functions;
+ * the score is the settle time plus the overshoot, and the best gains go to the gain schedule.
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_GAIN_TUNER_HPP_
+#define _8059_MOTION_PROFILE_LIB_GAIN_TUNER_HPP_
+#include "8059MotionProfileLib/include/gainSchedule.hpp"
+/**
+ * Default tuning run
+ * TUNER_ITERATIONS & TUNER_PARTICLES: swarm size (every particle runs 2 test movements per iteration)
+ * TUNER_MAX_PARTICLES: largest swarm (the particles are on the stack of the calling task)
+ * TUNER_TIMEOUT: longest test movement in ms; an unsettled movement scores its full timeout
+ * TUNER_K_SETTLE: score per second of settle time
+ * TUNER_K_OVERSHOOT: score per inch of overshoot (turns: of side travel)
+ * TUNER_MOVE_SIZE & TUNER_TURN_SIZE: test movements of autotuneBase (inches & degrees)
+ */
+#define TUNER_ITERATIONS 5
+#define TUNER_PARTICLES 8
+#define TUNER_MAX_PARTICLES 16
+#define TUNER_TIMEOUT 3000
+#define TUNER_K_SETTLE 1
+#define TUNER_K_OVERSHOOT 2
+#define TUNER_MOVE_SIZE 24
+#define TUNER_TURN_SIZE 90
+/**
+ * Swarm constants (those of okapi::PIDTuner)
+ * TUNER_INERTIA: share of a particle's velocity kept per iteration
+ * TUNER_CONF_SELF & TUNER_CONF_SWARM: pull towards the particle's and the swarm's best gains
+ */
+#define TUNER_INERTIA 0.5
+#define TUNER_CONF_SELF 1.1
+#define TUNER_CONF_SWARM 1.2
+/**
+ * The class GainTuner searches kP & kD of one movement type and size within bounds.
+ * autotune blocks for the whole run (TUNER_ITERATIONS*TUNER_PARTICLES*2 test movements),
+ * so call it from autonomous with room in front of and behind the robot.
+ */
+class GainTuner{
+public:
+  /**
+   * refer to gainTuner.cpp for function documentation
+   */
+  GainTuner(bool turn, double size, double kPMin, double kPMax, double kDMin, double kDMax,
+            int iterations = TUNER_ITERATIONS, int particles = TUNER_PARTICLES);
+  GainBand autotune();
+private:
+  double runTest(double kp, double kd, double size);
+  bool turn;
+  double size, kPMin, kPMax, kDMin, kDMax;
+  int iterations, particles;
+};
+/**
+ * refer to gainTuner.cpp for function documentation
+ */
+void autotuneBase();
+
+#endif
@@ -0,0 +1,63 @@
+/**
+ * Header file for impactDetector.cpp
+ * Defines class ImpactDetector that spots a collision (a jolt of the IMU's horizontal acceleration that the
+ * movement does not account for) and a tipping robot (pitch or roll held beyond a limit)
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_IMPACT_DETECTOR_HPP_
+#define _8059_MOTION_PROFILE_LIB_IMPACT_DETECTOR_HPP_
+#include <cstdint>
+/**
+ * Default impact rule. The IMU is mounted flat; only the magnitudes of the horizontal acceleration and
+ * of the tilt are used, so the direction of the IMU on the robot does not matter.
+ * IMPACT_JERK: least change of the horizontal acceleration between two samples, in g per second
+ * (driving changes it by a few g/s, hitting a robot by tens)
+ * IMPACT_ACCEL: least horizontal acceleration in g beyond the one the movement commands
+ * IMPACT_TILT: pitch or roll in degrees above which the robot tips
+ * IMPACT_TILT_TIME: time in ms the tilt must hold for (driving over a field element is shorter)
+ * IMPACT_HOLDOFF: time in ms after an impact during which no other is reported (the stop that follows jolts the IMU too)
+ */
+#define IMPACT_JERK 30
+#define IMPACT_ACCEL 1
+#define IMPACT_TILT 20
+#define IMPACT_TILT_TIME 100
+#define IMPACT_HOLDOFF 500
+#define DEFAULT_IMPACT_RULE {IMPACT_JERK, IMPACT_ACCEL, IMPACT_TILT, IMPACT_TILT_TIME, IMPACT_HOLDOFF}
+// Standard gravity in inches per second squared (IMU accelerations are in g)
+#define IMPACT_G 386.09
+/**
+ * Impact rule
+ * jerk, accel, tilt, tiltTime, holdoff: refer to IMPACT_JERK, IMPACT_ACCEL, IMPACT_TILT, IMPACT_TILT_TIME, IMPACT_HOLDOFF
+ */
+struct ImpactRule{
+  double jerk, accel, tilt;
+  uint32_t tiltTime, holdoff;
+};
+/** Impacts */
+enum ImpactType{
+  IMPACT_NONE,
+  IMPACT_COLLISION,   // jolt of the horizontal acceleration
+  IMPACT_TIP          // pitch or roll beyond the rule's tilt
+};
+/**
+ * The class ImpactDetector is fed the IMU readings and the acceleration the movement commands
+ * at every new IMU sample, and reports an impact at the sample that shows it.
+ */
+class ImpactDetector{
+public:
+  /**
+   * refer to impactDetector.cpp for function documentation
+   */
+  ImpactDetector();
+  void setRule(const ImpactRule &rule);
+  ImpactType update(double accel, double expected, double tilt, uint64_t now);
+  void reset();
+private:
+  ImpactRule rule;
+  /** previous horizontal acceleration (g) and its time (micros, 0 before the first sample) */
+  double prevAccel;
+  uint64_t prevTime;
+  /** time (micros) the tilt went beyond the rule's, 0 when within; time of the last impact reported, 0 if none */
+  uint64_t tiltedSince, lastImpact;
+};
+
+#endif
@@ -0,0 +1,67 @@
+/**
+ * Header-only inline function
+ * Holds any callable of a signature (a function, or a lambda with captures) in a fixed buffer inside the
+ * object, for the triggers and actions of the motion library (path triggers, action groups, boot stages):
+ * - no heap: std::function allocates a capture that does not fit its own small buffer, which fragments the
+ *   heap over a day of matches; a capture larger than the buffer is a compile error instead
+ * - captures must be trivially copyable (numbers, pointers, references taken by pointer), so an
+ *   InlineFunction is trivially copyable too, and the structs holding one can be copied and sorted as before
+ * - a call costs one indirect call through the stored invoker
+ * E.g. atPathDistance(24, [power]{intakeMove(power);}) with an int power in the routine.
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_INLINE_FUNCTION_HPP_
+#define _8059_MOTION_PROFILE_LIB_INLINE_FUNCTION_HPP_
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+/** Default capture buffer in bytes (two doubles or pointers) */
+#define INLINE_FUNCTION_SIZE 16
+/** Alignment of the capture buffer in bytes */
+#define INLINE_FUNCTION_ALIGN 8
+
+template <typename Signature, int Size = INLINE_FUNCTION_SIZE>
+class InlineFunction;
+
+template <typename R, typename... Args, int Size>
+class InlineFunction<R(Args...), Size>{
+  /** the callable, copied in place */
+  alignas(INLINE_FUNCTION_ALIGN) unsigned char storage[Size];
+  /** calls the callable in storage with its own type; NULL when empty */
+  R (*invoker)(const void *callable, Args... args);
+public:
+  /** An empty function (calling it is an error; test it first) */
+  InlineFunction() : storage(), invoker(NULL){}
+  InlineFunction(std::nullptr_t) : InlineFunction(){}
+  /**
+   * Hold a callable.
+   * @param callable
+   * a function or a lambda: its captures must fit in Size bytes and be trivially copyable (checked at compile time)
+   */
+  template <typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, InlineFunction>::value>::type>
+  InlineFunction(F callable) : storage(), invoker(NULL){
+    static_assert(sizeof(F) <= Size, "the captures of the callable do not fit in the InlineFunction (capture less or raise its Size)");
+    static_assert(alignof(F) <= INLINE_FUNCTION_ALIGN, "the captures of the callable are over-aligned for the InlineFunction");
+    static_assert(std::is_trivially_copyable<F>::value && std::is_trivially_destructible<F>::value,
+                  "an InlineFunction only holds trivially copyable captures (capture values or pointers, not objects that own memory)");
+    new (storage) F(callable);
+    invoker = [](const void *stored, Args... args) -> R{
+      return (*static_cast<const F*>(stored))(std::forward<Args>(args)...);
+    };
+  }
+  /**
+   * @return
+   * whether it holds a callable
+   */
+  explicit operator bool() const{
+    return invoker != NULL;
+  }
+  /**
+   * Call the callable (must not be empty).
+   */
+  R operator()(Args... args) const{
+    return invoker(storage, std::forward<Args>(args)...);
+  }
+};
+
+#endif
@@ -0,0 +1,70 @@
+/**
+ * Header file for inputMacro.cpp
+ * Defines the driver input macros: opcontrol records the controller samples of a driven run into
+ * a compact binary file on the microSD card, and autonomous replays them through the same driver
+ * pipeline (refer to runDriverControls), or follows the recorded path with pure pursuit
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_INPUT_MACRO_HPP_
+#define _8059_MOTION_PROFILE_LIB_INPUT_MACRO_HPP_
+#include "8059MotionProfileLib/include/controllerService.hpp"
+#include "8059MotionProfileLib/include/purePursuit.hpp"
+#include <cstdint>
+// Macro file on the microSD card (the host simulation writes it to bin/ instead)
+#ifndef MACRO_FILE_PATH
+#define MACRO_FILE_PATH "/usd/macro.bin"
+#endif
+// File header identification ("805M" in ASCII) and format version
+#define MACRO_FILE_MAGIC 0x4D353038
+#define MACRO_FILE_VERSION 1
+/**
+ * Recording
+ * MACRO_MAX_FRAMES: frames of a recording (kept in memory until it is saved); a full recording stops
+ * MACRO_KEYFRAME_DT: a frame is recorded when the inputs change, and at least every this many ms (the pose trace)
+ * MACRO_POSE_SCALE: steps per inch of the recorded pose
+ * MACRO_RECORD_BUTTON: master button that starts and stops a recording in opcontrol (off the competition switch)
+ * MACRO_WAYPOINT_SPACING: default spacing in inches of the waypoints resampled from the pose trace
+ * MACRO_PATH_TIMEOUT: time in ms runMacroPath waits for the path past the recorded duration
+ */
+#define MACRO_MAX_FRAMES 8192
+#define MACRO_KEYFRAME_DT 50
+#define MACRO_POSE_SCALE 16
+#define MACRO_RECORD_BUTTON DIGITAL_UP
+#define MACRO_WAYPOINT_SPACING 6
+#define MACRO_PATH_TIMEOUT 3000
+// Bit of MacroFrame::partnerButtons set while the partner controller is connected
+#define MACRO_PARTNER_CONNECTED 0x8000
+/**
+ * One recorded frame: the inputs hold from its time until the next frame's
+ * time: ms from the start of the recording
+ * axes, buttons: master sticks and buttons (refer to ControllerState)
+ * partnerButtons: partner buttons, and MACRO_PARTNER_CONNECTED (the partner's sticks are not used)
+ * x, y: pose at the frame in 1/MACRO_POSE_SCALE inches
+ */
+struct MacroFrame{
+  uint32_t time;
+  int8_t axes[CONTROLLER_AXES];
+  uint16_t buttons, partnerButtons;
+  int16_t x, y;
+};
+/**
+ * Header at the start of the macro file, followed by `frames` MacroFrames
+ */
+struct MacroFileHeader{
+  uint32_t magic, version, frameSize, frames;
+};
+/**
+ * refer to inputMacro.cpp for function documentation
+ */
+void startMacroRecording();
+bool isMacroRecording();
+void recordMacroFrame(const ControllerState &master, const ControllerState &partner);
+bool stopMacroRecording();
+bool loadMacro();
+int getMacroFrames();
+void playMacro();
+int getMacroWaypoints(PursuitPoint *points, int maxPoints, double spacing = MACRO_WAYPOINT_SPACING);
+void prepareMacro();
+void runMacro();
+void runMacroPath();
+
+#endif
@@ -0,0 +1,53 @@
+/**
+ * Header file for inputService.cpp
+ * Defines the ADI input service: one task samples the digital inputs at a fixed high rate,
+ * debounces them and queues timestamped edge events to the subscribed tasks, which can block on them
+ * (the controller buttons are published on the same queues, refer to controllerService.hpp)
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_INPUT_SERVICE_HPP_
+#define _8059_MOTION_PROFILE_LIB_INPUT_SERVICE_HPP_
+#include "8059MotionProfileLib/include/taskConfig.hpp"
+#include "8059MotionProfileLib/include/mailbox.hpp"
+#include <atomic>
+#include <cstdint>
+// Maximum number of sampled digital inputs
+#define MAX_DIGITAL_INPUTS 8
+// Maximum number of subscribed tasks
+#define MAX_INPUT_SUBSCRIBERS 4
+// Events queued per subscriber (power of 2); a full queue drops the new event
+#define INPUT_EVENT_QUEUE 16
+// Consecutive samples (one per INPUT_DT) a new level must hold to count as an edge
+#define INPUT_DEBOUNCE 3
+/**
+ * An edge of a debounced input
+ * input: input number (returned by addDigitalInput, or a controller button, refer to CONTROLLER_INPUT_BASE)
+ * rising: true for a low to high edge
+ * time: micros of the first sample at the new level
+ */
+struct InputEvent{
+  uint8_t input;
+  bool rising;
+  uint64_t time;
+};
+/**
+ * A subscribed task and its event queue, from the input service to the subscriber
+ * (which is woken by every event)
+ */
+struct InputSubscriber{
+  std::atomic<pros::task_t> task;
+  uint32_t inputMask;
+  Mailbox<InputEvent, INPUT_EVENT_QUEUE> events;
+};
+/**
+ * refer to inputService.cpp for function documentation
+ */
+int addDigitalInput(uint8_t port);
+bool getInputState(int input);
+int subscribeInputs(uint32_t inputMask);
+bool popInputEvent(int subscriber, InputEvent &event);
+bool waitInputEvent(int subscriber, InputEvent &event, uint32_t timeout);
+uint32_t getInputDrops(int subscriber);
+void publishInputEvent(const InputEvent &event);
+void inputService(void * ignore);
+
+#endif
@@ -0,0 +1,48 @@
+/**
+ * Header file for latencyProbe.cpp
+ * Defines the actuation latency probe: the base is pulsed with power steps while every base motor
+ * is polled, and the time from each command to the first response of the motor's velocity and
+ * encoder is recorded, so BASE_LOOKAHEAD and the controller tuning rest on measured numbers
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_LATENCY_PROBE_HPP_
+#define _8059_MOTION_PROFILE_LIB_LATENCY_PROBE_HPP_
+#include "8059MotionProfileLib/include/drivetrain.hpp"
+#include <cstdint>
+/**
+ * Probe run (refer to measureBaseLatency)
+ * LATENCY_PULSES: power steps per run, alternately forwards and backwards so the base stays in place
+ * LATENCY_MAX_PULSES: largest run (the samples are on the stack of the calling task)
+ * LATENCY_POWER: power of a step
+ * LATENCY_TIMEOUT: longest wait in ms for the responses to a step (a motor that has not responded is not counted)
+ * LATENCY_REST: time in ms the base is stopped between steps, so every step starts from rest
+ * LATENCY_POLL_DT: polling period of the motors in ms (the resolution of the measurement)
+ * LATENCY_VEL_THRESHOLD: velocity (rpm) that counts as a response of the velocity reading
+ * LATENCY_POS_THRESHOLD: travel (encoder degrees) that counts as a response of the encoder
+ */
+#define LATENCY_PULSES 10
+#define LATENCY_MAX_PULSES 32
+#define LATENCY_POWER 60
+#define LATENCY_TIMEOUT 300
+#define LATENCY_REST 500
+#define LATENCY_POLL_DT 1
+#define LATENCY_VEL_THRESHOLD 5
+#define LATENCY_POS_THRESHOLD 2
+/**
+ * Latency distribution of a base motor, in micros from the command
+ * samples: steps the motor responded to (both readings)
+ * velMedian, velP90, velMax: to the first velocity of LATENCY_VEL_THRESHOLD
+ * posMedian, posP90, posMax: to the first travel of LATENCY_POS_THRESHOLD
+ */
+struct LatencyStats{
+  uint8_t port;
+  uint32_t samples;
+  uint32_t velMedian, velP90, velMax;
+  uint32_t posMedian, posP90, posMax;
+};
+/**
+ * refer to latencyProbe.cpp for function documentation
+ */
+void measureBaseLatency(LatencyStats stats[BASE_MOTORS], int pulses = LATENCY_PULSES);
+void probeBaseLatency();
+
+#endif
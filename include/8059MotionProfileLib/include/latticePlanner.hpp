@@ -0,0 +1,92 @@
+/**
+ * Header file for latticePlanner.cpp
+ * Defines the lattice planner: a plan is a chain of motion primitives (straights, arcs and point turns between
+ * the poses of a lattice over the field, driven at a few speeds) instead of a chain of grid cells, so it is
+ * drivable as it is (no corner sharper than the base takes at its speed) and the fastest under the durations of
+ * the primitives. The primitive table (each primitive's geometry, the grid cells it sweeps and its durations
+ * between the speeds) is generated at compile time; a search only adds durations and checks swept cells, fast
+ * enough to replan during a match. Plans are checked on the occupancy grid of the path planner (the field
+ * obstacles and the obstacles added at run time, refer to pathPlanner.hpp).
+ *
+ * Lattice pose: a lattice point (x, y), a heading (0: +y, clockwise in 45 degree steps) and a speed class
+ * (0: at rest, up to LATTICE_SPEEDS - 1: LATTICE_MAX_VEL). Primitives drive forward; point turns only start a
+ * plan from rest, so a plan is a turn on the spot and one pure-pursuit path.
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_LATTICE_PLANNER_HPP_
+#define _8059_MOTION_PROFILE_LIB_LATTICE_PLANNER_HPP_
+#include "8059MotionProfileLib/include/pathPlanner.hpp"
+#include <cstdint>
+/**
+ * Lattice
+ * LATTICE_CELL: spacing of the lattice points in inches (a multiple of PLANNER_CELL); a lattice point is at the
+ *   centre of every LATTICE_CELL/PLANNER_CELL-th grid cell, from the field's bottom left corner
+ * LATTICE_GRID: lattice points per side
+ * LATTICE_HEADINGS: headings of a lattice pose
+ * LATTICE_SPEEDS: speed classes of a lattice pose, evenly from rest to LATTICE_MAX_VEL
+ */
+#define LATTICE_CELL (2*PLANNER_CELL)
+#define LATTICE_GRID (PLANNER_GRID*PLANNER_CELL/LATTICE_CELL)
+#define LATTICE_HEADINGS 8
+#define LATTICE_SPEEDS 3
+/**
+ * Limits the durations of the primitives are computed with (inches, seconds)
+ * LATTICE_MAX_VEL: top speed of the centre; along an arc the outer side keeps within it
+ * LATTICE_MAX_ACC: acceleration and deceleration along a primitive
+ * LATTICE_TURN_VEL, LATTICE_TURN_ACC: side travel limits of a point turn
+ */
+#define LATTICE_MAX_VEL PURSUIT_MAX_VEL
+#define LATTICE_MAX_ACC PURSUIT_MAX_DECEL
+#define LATTICE_TURN_VEL PROFILE_TURN_MAX_VEL
+#define LATTICE_TURN_ACC PROFILE_TURN_MAX_ACC
+/**
+ * Primitive table
+ * LATTICE_AXIS_PRIMITIVES, LATTICE_BASE_PRIMITIVES: primitives drawn from heading 0 (the first ones) and from
+ *   heading 1, turned by 90 degree steps to the other headings (refer to latticeBases in latticePlanner.cpp)
+ * LATTICE_SAMPLES: samples along a primitive for its length, curvature and swept cells (at most half a grid cell apart)
+ * LATTICE_MAX_SWEPT: most grid cells swept by a primitive
+ * LATTICE_MAX_STEPS: most steps of a plan
+ */
+#define LATTICE_AXIS_PRIMITIVES 6
+#define LATTICE_BASE_PRIMITIVES 11
+#define LATTICE_PRIMITIVES (LATTICE_BASE_PRIMITIVES*4)
+#define LATTICE_SAMPLES 32
+#define LATTICE_MAX_SWEPT 16
+#define LATTICE_MAX_STEPS 48
+/**
+ * A motion primitive, from a lattice point
+ * dx, dy: lattice points to its end; heading, endHeading: its lattice headings at the start and the end
+ * length: length of its path in inches; maxVel: its top speed (the outer side of its sharpest curve at LATTICE_MAX_VEL)
+ * time: duration in seconds from each start speed class to each end speed class (INFINITY: not drivable)
+ * swept, sweptCount: grid cells its centre crosses, from the grid cell of its start point (the grid is inflated
+ *   by the robot's clearance, refer to PLANNER_CLEARANCE)
+ */
+struct LatticePrimitive{
+  int8_t dx, dy;
+  uint8_t heading, endHeading;
+  float length, maxVel;
+  float time[LATTICE_SPEEDS][LATTICE_SPEEDS];
+  int8_t swept[LATTICE_MAX_SWEPT][2];
+  uint8_t sweptCount;
+};
+/**
+ * A step of a lattice plan
+ * primitive: index of the primitive driven (refer to getLatticePrimitive), -1 for a point turn
+ * x, y, heading, speed: the lattice pose it ends at
+ * time: its duration in seconds
+ */
+struct LatticeStep{
+  int16_t primitive;
+  uint8_t x, y, heading, speed;
+  float time;
+};
+/**
+ * refer to latticePlanner.cpp for function documentation
+ */
+const LatticePrimitive *getLatticePrimitive(int index);
+int planLattice(double startX, double startY, double startAngle, double startVel, double goalX, double goalY,
+  LatticeStep *steps, int maxSteps, double &time);
+int latticeWaypoints(const LatticeStep *steps, int count, PursuitPoint *points, int maxPoints);
+int getLatticeExpansions();
+bool baseLatticePursuit(double x, double y);
+
+#endif
@@ -0,0 +1,67 @@
+/**
+ * Header file for learnedFeedforward.cpp
+ * Defines the learned feedforward of the cached trajectories (iterative learning control): a skills route runs
+ * the same trajectories every time, so the tracking error the PD leaves repeats from run to run. In learning mode
+ * (setLearningMode, e.g. for practice runs) the control loop records the side errors of every trajectory it
+ * follows to the end, one bin per control cycle; after the run (updateLearning, from disabled()) the correction
+ * of each bin is moved by the error LEARNING_LEAD bins later (the base answers a change of power that late), the
+ * corrections are smoothed and saved to the microSD card next to the trajectory (TRAJECTORY_DIR/<name>.ilc).
+ * The next run adds the corrections to the kS/kV/kA feedforward of its side setpoints, learning or not.
+ * Only the side profiles of followTrajectory learn (RAMSETE and the MPC tracker close on the pose instead);
+ * a file of another trajectory (the hash, length or end of its sides changed) is ignored, and learns anew.
+ *
+ * Update of a bin j of a side, after a complete run with errors e (inches, setpoint less measured):
+ *   c[j] = LEARNING_FORGET*(c[j] + LEARNING_KP*e[j + LEARNING_LEAD] + LEARNING_KD*(e[j + LEARNING_LEAD] - e[j + LEARNING_LEAD - 1])/dt)
+ * then the mean over bins j - 1 to j + 1, within +-LEARNING_MAX_POWER
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_LEARNED_FEEDFORWARD_HPP_
+#define _8059_MOTION_PROFILE_LIB_LEARNED_FEEDFORWARD_HPP_
+#include <cstdint>
+/**
+ * LEARNED_FEEDFORWARD: 0 off (nothing is allocated, loaded or added), 1 on
+ * Learned corrections take 16 bytes of the motion arena per control cycle of a trajectory.
+ */
+#define LEARNED_FEEDFORWARD 1
+/**
+ * Learning law (refer to the update above)
+ * LEARNING_KP: power per inch of error; LEARNING_KD: power per in/s of change of the error
+ * LEARNING_LEAD: bins (control cycles) the error is taken ahead of the correction it moves
+ * LEARNING_FORGET: share of the correction kept from run to run (forgets a change of the robot)
+ * LEARNING_MAX_POWER: largest correction of a bin
+ */
+#define LEARNING_KP 6
+#define LEARNING_KD 0.2
+#define LEARNING_LEAD 2
+#define LEARNING_FORGET 0.98
+#define LEARNING_MAX_POWER 30
+/**
+ * Learning files: TRAJECTORY_DIR/<name>.ilc, a LearningFileHeader then the left and right corrections
+ * (float per bin). Bump LEARNING_FILE_VERSION when the layout or the bins change.
+ */
+#define LEARNING_FILE_MAGIC 0x434C4938
+#define LEARNING_FILE_VERSION 1
+/**
+ * Header of a learning file
+ * hash, length, endL, endR: hash (refer to hashTrajectory), number of segments and end positions of the sides
+ * of the trajectory it was learned on
+ * bins: corrections per side; runs: runs learned from
+ */
+struct LearningFileHeader{
+  uint32_t magic, version, hash;
+  int32_t length, bins, runs;
+  float endL, endR;
+};
+/**
+ * refer to learnedFeedforward.cpp for function documentation
+ */
+void prepareLearning(int id);
+void clearLearning();
+void setLearningMode(bool value);
+bool isLearningMode();
+void startLearningRun(int id);
+void getLearnedFeedforward(int id, int bin, double &powerL, double &powerR);
+void recordLearning(int id, int bin, double errorL, double errorR);
+int updateLearning();
+int getLearningRuns(int id);
+
+#endif
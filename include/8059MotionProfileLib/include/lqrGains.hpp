@@ -0,0 +1,46 @@
+/**
+ * Header file for lqrGains.cpp
+ * Defines the LQR gains of the base's position loop: a host step (`make lqr`, `./bin/sim lqr <file>`) solves the
+ * discrete LQR of a side of the identified drivetrain model (refer to baseModel.hpp) at LQR_BANDS velocities from
+ * rest to the top speed, and writes the gains to lqrTable.hpp as a constexpr table that the next build compiles in.
+ * With BASE_LQR_GAINS (refer to baseControl.hpp) the control loop interpolates the table at the velocity of the
+ * setpoints every cycle in place of the scheduled kP/kD.
+ *
+ * Plant of a side, about its setpoint: state x = (position error in, velocity error in/s), input u = power on top
+ * of the feedforward; the side accelerates at (u - kv*v)/ka, so x' = [0 1; 0 -kv/ka] x + [0; 1/ka] u, held over
+ * BASE_CONTROL_DT (exact discretization). Weights by Bryson's rule: LQR_MAX_ERROR and LQR_MAX_VEL_ERROR are the
+ * errors worth full power, and full power is the headroom above the feedforward at the velocity of the band
+ * (MAX_POW - ks - kv*v, at least LQR_MIN_HEADROOM). Less headroom makes power dearer, so the gains fall with the
+ * velocity: a fast segment is not kicked into the power cap by an error a slow one would take out hard.
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_LQR_GAINS_HPP_
+#define _8059_MOTION_PROFILE_LIB_LQR_GAINS_HPP_
+#include "8059MotionProfileLib/include/baseModel.hpp"
+/**
+ * LQR_BANDS: velocities of the table, evenly from rest to the model's top speed ((MAX_POW - ks)/kv)
+ * LQR_MAX_ERROR: position error worth full power (inches)
+ * LQR_MAX_VEL_ERROR: velocity error worth full power (in/s)
+ * LQR_MIN_HEADROOM: least power counted as full power (near the top speed)
+ * LQR_ITERATIONS: Riccati iterations (the solution converges in well under a hundred)
+ */
+#define LQR_BANDS 8
+#define LQR_MAX_ERROR 1.5
+#define LQR_MAX_VEL_ERROR 12
+#define LQR_MIN_HEADROOM 20
+#define LQR_ITERATIONS 500
+/**
+ * One band of the table
+ * vel: velocity of the band (in/s)
+ * kp: power per inch of position error; kd: power per in/s of velocity error
+ */
+struct LqrBand{
+  double vel, kp, kd;
+};
+/**
+ * refer to lqrGains.cpp for function documentation
+ */
+LqrBand computeLqrGains(const BaseFeedforward &side, double vel);
+bool writeLqrTable(const char *path);
+LqrBand getLqrGains(double vel);
+
+#endif
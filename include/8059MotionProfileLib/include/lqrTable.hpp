@@ -0,0 +1,21 @@
+/**
+ * LQR gains of the base's position loop by velocity (refer to lqrGains.hpp)
+ * Generated by `make lqr` from the drivetrain model ks 4, kv 3.5, ka 0.2 (the sides averaged); do not
+ * edit, generate it again after characterizing the base or changing the weights
+ * Bands: vel (in/s), kp (power per inch), kd (power per in/s)
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_LQR_TABLE_HPP_
+#define _8059_MOTION_PROFILE_LIB_LQR_TABLE_HPP_
+#include "8059MotionProfileLib/include/lqrGains.hpp"
+constexpr LqrBand lqrTable[] = {
+  {0, 56.082, 2.4669},
+  {3.918, 48.8024, 2.2015},
+  {7.837, 41.3232, 1.91659},
+  {11.76, 33.6245, 1.60842},
+  {15.67, 25.6815, 1.27194},
+  {19.59, 17.462, 0.899997},
+  {23.51, 12.8795, 0.680134},
+  {27.43, 12.8795, 0.680134}
+};
+
+#endif
@@ -0,0 +1,151 @@
+/**
+ * Header-only mailbox: a typed, lock-free ring buffer carrying commands or events from one
+ * task to another (e.g. autonomous to the base controller, or the input service to a subscriber)
+ * - single producer and single consumer: only the producer moves tail and only the consumer moves
+ *   head, so neither ever waits on a lock
+ * - an item is published only after it is fully written, so the consumer never sees half of it
+ * - nothing is lost silently: a post to a full mailbox fails and is counted
+ * - an optional receiver task is notified on every post, so a consumer blocked in wait (or in
+ *   task_notify_take between its ticks) picks the item up at once instead of at its next tick
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_MAILBOX_HPP_
+#define _8059_MOTION_PROFILE_LIB_MAILBOX_HPP_
+#include "api.h"
+#include <atomic>
+#include <cstdint>
+
+template <typename T, uint32_t SIZE>
+class Mailbox{
+  static_assert(SIZE > 0, "a mailbox holds at least one item");
+  T items[SIZE];
+  /** items taken by the consumer and posted by the producer since the start, and posts that failed */
+  std::atomic<uint32_t> head, tail, drops;
+  /** task notified on every post (NULL: none) */
+  std::atomic<pros::task_t> receiver;
+public:
+  Mailbox() : head(0), tail(0), drops(0), receiver(NULL){}
+  /**
+   * Notify a task on every post (usually the consumer, from its own task).
+   * @param task
+   * the task to notify (NULL: none)
+   */
+  void setReceiver(pros::task_t task){
+    receiver.store(task, std::memory_order_release);
+  }
+  /**
+   * Post an item. Producer only; never blocks.
+   * @param item
+   * to-be-posted item
+   *
+   * @return
+   * false if the mailbox is full (the item is dropped and counted)
+   */
+  bool post(const T &item){
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    if(t - head.load(std::memory_order_acquire) >= SIZE){
+      drops.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    items[t%SIZE] = item;
+    tail.store(t + 1, std::memory_order_release);
+    pros::task_t task = receiver.load(std::memory_order_acquire);
+    if(task != NULL) pros::c::task_notify(task);
+    return true;
+  }
+  /**
+   * Consumer only: an item, left in the mailbox.
+   * @param index (optional)
+   * 0 for the oldest item, 1 for the one after it, ...
+   *
+   * @return
+   * the item (valid until it is taken), NULL if the mailbox holds no more than index items
+   */
+  const T *peek(uint32_t index = 0) const{
+    uint32_t h = head.load(std::memory_order_relaxed);
+    if(tail.load(std::memory_order_acquire) - h <= index) return NULL;
+    return &items[(h + index)%SIZE];
+  }
+  /**
+   * Take the oldest item without blocking. Consumer only.
+   * @param item
+   * set to the item
+   *
+   * @return
+   * false if the mailbox is empty
+   */
+  bool take(T &item){
+    uint32_t h = head.load(std::memory_order_relaxed);
+    if(h == tail.load(std::memory_order_acquire)) return false;
+    item = items[h%SIZE];
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+  /**
+   * Remove the oldest item without copying it (once it was used through peek). Consumer only.
+   * @return
+   * false if the mailbox is empty
+   */
+  bool pop(){
+    uint32_t h = head.load(std::memory_order_relaxed);
+    if(h == tail.load(std::memory_order_acquire)) return false;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+  /**
+   * Take the oldest item, blocking until there is one. Consumer only, and the consumer must be
+   * the receiver (it is woken by the posts).
+   * @param item
+   * set to the item
+   *
+   * @param timeout
+   * maximum wait in ms
+   *
+   * @return
+   * false at the timeout
+   */
+  bool wait(T &item, uint32_t timeout){
+    uint32_t start = pros::c::millis();
+    while(!take(item)){
+      uint32_t waited = pros::c::millis() - start;
+      if(waited >= timeout) return false;
+      pros::c::task_notify_take(true, timeout - waited);
+    }
+    return true;
+  }
+  /**
+   * Drop every posted item. Consumer only.
+   */
+  void clear(){
+    head.store(tail.load(std::memory_order_acquire), std::memory_order_release);
+  }
+  /**
+   * @return
+   * true if no item is waiting
+   */
+  bool empty() const{
+    return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+  }
+  /**
+   * @return
+   * items posted since the start (the number of the next posted item)
+   */
+  uint32_t posted() const{
+    return tail.load(std::memory_order_acquire);
+  }
+  /**
+   * @return
+   * items taken or cleared since the start
+   */
+  uint32_t taken() const{
+    return head.load(std::memory_order_acquire);
+  }
+  /**
+   * @return
+   * posts that failed because the mailbox was full
+   */
+  uint32_t dropped() const{
+    return drops.load(std::memory_order_relaxed);
+  }
+};
+
+#endif
@@ -0,0 +1,22 @@
+/**
+ * Header file for matchClock.cpp
+ * Defines the match clock of the autonomous period: started by the routine runner when autonomous()
+ * starts, it tells the routine how much of the period is left, so optional actions are skipped when
+ * they would not finish in time and motions can be given a time to arrive by (refer to motionQueue.hpp)
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_MATCH_CLOCK_HPP_
+#define _8059_MOTION_PROFILE_LIB_MATCH_CLOCK_HPP_
+#include <cstdint>
+// Length of the autonomous period in ms
+#define AUTON_PERIOD 15000
+// Time kept in hand by hasMatchTime, in ms (the last settle, the reaction to the end of the period)
+#define MATCH_TIME_MARGIN 250
+/**
+ * refer to matchClock.cpp for function documentation
+ */
+void startMatchClock(uint32_t period = AUTON_PERIOD, uint32_t elapsed = 0);
+uint32_t getMatchTime();
+int32_t getMatchTimeLeft();
+bool hasMatchTime(uint32_t estimate);
+
+#endif
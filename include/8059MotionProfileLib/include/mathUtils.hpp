@@ -4,6 +4,7 @@
  */
 #ifndef _8059_MOTION_PROFILE_LIB_MATH_UTILS_HPP_
 #define _8059_MOTION_PROFILE_LIB_MATH_UTILS_HPP_
+#include <cmath>
 /**
  * Mathematical constants
  */
@@ -17,11 +18,101 @@
  */
 #define toDeg   57.2957795130823208767981548141
 #define toRad   0.0174532925199432957692369076849
+/**
+ * Fast trigonometry (refer to mathUtils.cpp)
+ * TRIG_TABLE_SIZE: entries of the sine table over one turn (power of 2).
+ * Error bounds, for any input:
+ * fastSin, fastCos: |error| <= 4.8e-6 (linear interpolation, (twoPI/TRIG_TABLE_SIZE)^2/8)
+ * fastAtan2: |error| <= 2e-6 rad (0.0001 degrees)
+ */
+#define TRIG_TABLE_SIZE 1024
+/**
+ * Marks a function of the control cycle (odometry step, base control stages, fast trigonometry).
+ * In the release profile (PROFILE=release) it is optimized for speed and placed in .text.hot, which
+ * the linker scripts put ahead of the other code, so one cycle runs from a few adjacent cache lines.
+ * The debug profile compiles it like any other function.
+ */
+#ifdef PROFILE_RELEASE
+#define HOT_PATH __attribute__((hot))
+#else
+#define HOT_PATH
+#endif
 /**
  * refer to mathUtils.cpp for function documentation
  */
 double boundRad(double rad); //bound 0<=angle<twoPI
 double boundDeg(double deg); //bound 0<=angle<360
 double abscap(double x, double abscap);
+double fastSin(double x);
+double fastCos(double x);
+double fastAtan2(double y, double x);
+/**
+ * Inline angle normalization for the hot paths.
+ * An angle that is at most one turn out of range is wrapped with a single add or subtract
+ * (compiled to conditional selects); only further wraps fall back to fmod / remainder.
+ */
+/**
+ * Wrap an angle in radians to 0<=angle<twoPI (same result as boundRad).
+ * @param rad
+ * angle in radians
+ *
+ * @return
+ * angle in radians bounded within 0<=angle<twoPI
+ */
+inline double wrapRad(double rad){
+  rad += (rad < 0)? twoPI : 0;
+  rad -= (rad >= twoPI)? twoPI : 0;
+  if(rad < 0 || rad >= twoPI) rad = boundRad(rad);
+  return rad;
+}
+/**
+ * Wrap an angle in degrees to 0<=angle<360 (same result as boundDeg).
+ * @param deg
+ * angle in degrees
+ *
+ * @return
+ * angle in degrees bounded within 0<=angle<360
+ */
+inline double wrapDeg(double deg){
+  deg += (deg < 0)? 360 : 0;
+  deg -= (deg >= 360)? 360 : 0;
+  if(deg < 0 || deg >= 360) deg = boundDeg(deg);
+  return deg;
+}
+/**
+ * Shortest signed difference between two angles in radians.
+ * @param target
+ * angle to reach
+ *
+ * @param current
+ * current angle (need not be bounded)
+ *
+ * @return
+ * target - current wrapped within -PI<angle<=PI (positive: clockwise)
+ */
+inline double angleDiff(double target, double current){
+  double diff = target - current;
+  diff -= (diff > PI)? twoPI : 0;
+  diff += (diff <= -PI)? twoPI : 0;
+  if(diff > PI || diff <= -PI){
+    diff = remainder(diff, twoPI);
+    if(diff <= -PI) diff += twoPI;
+  }
+  return diff;
+}
+/**
+ * Shortest signed difference between two angles in degrees.
+ * @param target
+ * angle to reach
+ *
+ * @param current
+ * current angle (need not be bounded)
+ *
+ * @return
+ * target - current wrapped within -180<angle<=180 (positive: clockwise)
+ */
+inline double angleDiffDeg(double target, double current){
+  return angleDiff(target*toRad, current*toRad)*toDeg;
+}
 
 #endif
@@ -0,0 +1,162 @@
+/**
+ * Header file for fixed-size matrices
+ * Defines Matrix<R, C>, a matrix of doubles whose size is part of its type, and the operations the
+ * estimators and controllers need (header only: the sizes are template arguments, so the loops have
+ * constant bounds and unroll)
+ * A Matrix is a plain aggregate on the stack or inside another struct, so it never allocates, and every
+ * operation is constexpr (a gain or model matrix can be computed at compile time).
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_MATRIX_HPP_
+#define _8059_MOTION_PROFILE_LIB_MATRIX_HPP_
+/**
+ * MATRIX_UNROLL: loop unrolling of the element loops (the project builds with -Os, which does not unroll
+ * on its own; a 5x5 product is 125 multiply-adds on the VFP either way, the unrolled loops save the
+ * branches and index arithmetic around them)
+ */
+#define MATRIX_UNROLL 8
+#define MATRIX_PRAGMA(x) _Pragma(#x)
+#define MATRIX_UNROLL_PRAGMA(n) MATRIX_PRAGMA(GCC unroll n)
+#define MATRIX_LOOP MATRIX_UNROLL_PRAGMA(MATRIX_UNROLL)
+/**
+ * R rows by C columns, row major; zero-initialized by Matrix<R, C> m = {};
+ */
+template<int R, int C> struct Matrix{
+  double m[R][C];
+  constexpr double &operator()(int row, int col){ return m[row][col]; }
+  constexpr double operator()(int row, int col) const{ return m[row][col]; }
+};
+/** absolute value usable in constant expressions */
+constexpr double matrixAbs(double x){ return x < 0? -x : x; }
+/**
+ * @return
+ * the N by N identity matrix
+ */
+template<int N> constexpr Matrix<N, N> identityMatrix(){
+  Matrix<N, N> result = {};
+  for(int i = 0; i < N; i++) result.m[i][i] = 1;
+  return result;
+}
+/**
+ * @return
+ * a + b
+ */
+template<int R, int C> constexpr Matrix<R, C> operator+(const Matrix<R, C> &a, const Matrix<R, C> &b){
+  Matrix<R, C> result = {};
+  MATRIX_LOOP
+  for(int i = 0; i < R; i++) for(int j = 0; j < C; j++) result.m[i][j] = a.m[i][j] + b.m[i][j];
+  return result;
+}
+/**
+ * @return
+ * a - b
+ */
+template<int R, int C> constexpr Matrix<R, C> operator-(const Matrix<R, C> &a, const Matrix<R, C> &b){
+  Matrix<R, C> result = {};
+  MATRIX_LOOP
+  for(int i = 0; i < R; i++) for(int j = 0; j < C; j++) result.m[i][j] = a.m[i][j] - b.m[i][j];
+  return result;
+}
+/**
+ * @return
+ * the matrix a scaled by s
+ */
+template<int R, int C> constexpr Matrix<R, C> operator*(double s, const Matrix<R, C> &a){
+  Matrix<R, C> result = {};
+  MATRIX_LOOP
+  for(int i = 0; i < R; i++) for(int j = 0; j < C; j++) result.m[i][j] = s*a.m[i][j];
+  return result;
+}
+/**
+ * @return
+ * the product a*b
+ */
+template<int R, int K, int C> constexpr Matrix<R, C> operator*(const Matrix<R, K> &a, const Matrix<K, C> &b){
+  Matrix<R, C> result = {};
+  for(int i = 0; i < R; i++){
+    MATRIX_LOOP
+    for(int k = 0; k < K; k++){
+      double aik = a.m[i][k];
+      MATRIX_LOOP
+      for(int j = 0; j < C; j++) result.m[i][j] += aik*b.m[k][j];
+    }
+  }
+  return result;
+}
+/**
+ * @return
+ * the transpose of a
+ */
+template<int R, int C> constexpr Matrix<C, R> transpose(const Matrix<R, C> &a){
+  Matrix<C, R> result = {};
+  for(int i = 0; i < R; i++) for(int j = 0; j < C; j++) result.m[j][i] = a.m[i][j];
+  return result;
+}
+/**
+ * Invert a square matrix: by the adjugate for N <= 3 (the innovation covariances of the estimator,
+ * the small gains of the controllers), else by Gauss-Jordan elimination with partial pivoting.
+ * @param a
+ * the matrix
+ *
+ * @param inverse
+ * set to the inverse of a
+ *
+ * @return
+ * false if a is singular (inverse is not set)
+ */
+template<int N> constexpr bool invertMatrix(Matrix<N, N> a, Matrix<N, N> &inverse){
+  if constexpr(N == 1){
+    if(matrixAbs(a.m[0][0]) < 1e-12) return false;
+    inverse.m[0][0] = 1/a.m[0][0];
+    return true;
+  }
+  else if constexpr(N == 2){
+    double det = a.m[0][0]*a.m[1][1] - a.m[0][1]*a.m[1][0];
+    if(matrixAbs(det) < 1e-12) return false;
+    inverse.m[0][0] = a.m[1][1]/det;
+    inverse.m[0][1] = -a.m[0][1]/det;
+    inverse.m[1][0] = -a.m[1][0]/det;
+    inverse.m[1][1] = a.m[0][0]/det;
+    return true;
+  }
+  else if constexpr(N == 3){
+    Matrix<3, 3> adjugate = {{
+      {a.m[1][1]*a.m[2][2] - a.m[1][2]*a.m[2][1], a.m[0][2]*a.m[2][1] - a.m[0][1]*a.m[2][2], a.m[0][1]*a.m[1][2] - a.m[0][2]*a.m[1][1]},
+      {a.m[1][2]*a.m[2][0] - a.m[1][0]*a.m[2][2], a.m[0][0]*a.m[2][2] - a.m[0][2]*a.m[2][0], a.m[0][2]*a.m[1][0] - a.m[0][0]*a.m[1][2]},
+      {a.m[1][0]*a.m[2][1] - a.m[1][1]*a.m[2][0], a.m[0][1]*a.m[2][0] - a.m[0][0]*a.m[2][1], a.m[0][0]*a.m[1][1] - a.m[0][1]*a.m[1][0]}
+    }};
+    double det = a.m[0][0]*adjugate.m[0][0] + a.m[0][1]*adjugate.m[1][0] + a.m[0][2]*adjugate.m[2][0];
+    if(matrixAbs(det) < 1e-12) return false;
+    inverse = (1/det)*adjugate;
+    return true;
+  }
+  else{
+    Matrix<N, N> result = identityMatrix<N>();
+    for(int col = 0; col < N; col++){
+      int pivot = col;
+      for(int row = col + 1; row < N; row++) if(matrixAbs(a.m[row][col]) > matrixAbs(a.m[pivot][col])) pivot = row;
+      if(matrixAbs(a.m[pivot][col]) < 1e-12) return false;
+      for(int j = 0; j < N; j++){
+        double t = a.m[col][j]; a.m[col][j] = a.m[pivot][j]; a.m[pivot][j] = t;
+        t = result.m[col][j]; result.m[col][j] = result.m[pivot][j]; result.m[pivot][j] = t;
+      }
+      double scale = 1/a.m[col][col];
+      for(int j = 0; j < N; j++){
+        a.m[col][j] *= scale;
+        result.m[col][j] *= scale;
+      }
+      for(int row = 0; row < N; row++){
+        if(row == col) continue;
+        double factor = a.m[row][col];
+        MATRIX_LOOP
+        for(int j = 0; j < N; j++){
+          a.m[row][j] -= factor*a.m[col][j];
+          result.m[row][j] -= factor*result.m[col][j];
+        }
+      }
+    }
+    inverse = result;
+    return true;
+  }
+}
+
+#endif
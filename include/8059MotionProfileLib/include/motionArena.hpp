@@ -0,0 +1,39 @@
+/**
+ * Header file for motionArena.cpp
+ * Defines the motion arena: a fixed region owned by the motion library for trajectory and path data,
+ * so variable sized outputs (pathfinder segments, planner results) never fragment the heap
+ * over a day of matches without reboots.
+ * - persistent allocations bump up from the bottom (kept until resetArena, between routines)
+ * - scratch allocations bump down from the top (released by the caller once a generation is done)
+ * Allocation is lock-free (both ends are one atomic word), so any task may allocate; allocate
+ * during initialize() / competition_initialize() and never in the control loops.
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_MOTION_ARENA_HPP_
+#define _8059_MOTION_PROFILE_LIB_MOTION_ARENA_HPP_
+#include <cstdint>
+// Size of the arena in bytes (taken from the user heap once, as a static array)
+#define ARENA_SIZE 0x200000
+// Alignment of every allocation in bytes
+#define ARENA_ALIGN 8
+/**
+ * Arena usage in bytes
+ * used: persistent bytes, scratch: scratch bytes currently taken
+ * peak: most bytes taken at once (persistent + scratch) since boot
+ * failures: number of allocations that did not fit
+ */
+struct ArenaUsage{
+  uint32_t used, scratch, peak, failures;
+};
+/**
+ * refer to motionArena.cpp for function documentation
+ */
+void *arenaAlloc(uint32_t size);
+void *arenaScratch(uint32_t size);
+uint32_t getArenaMark();
+void releaseArena(uint32_t mark);
+uint32_t getScratchMark();
+void releaseScratch(uint32_t mark);
+void resetArena();
+ArenaUsage getArenaUsage();
+
+#endif
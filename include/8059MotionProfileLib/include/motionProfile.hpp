@@ -0,0 +1,52 @@
+/**
+ * Header file for motionProfile.cpp
+ * Defines class MotionProfile that generates time-parameterized
+ * position, velocity and acceleration setpoints for a movement
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_MOTION_PROFILE_HPP_
+#define _8059_MOTION_PROFILE_LIB_MOTION_PROFILE_HPP_
+/**
+ * Shape of the velocity profile
+ * PROFILE_NONE: no profile, the setpoint jumps to the target (original behaviour)
+ * PROFILE_TRAPEZOIDAL: acceleration limited (velocity is a trapezoid)
+ * PROFILE_SCURVE: acceleration and jerk limited (velocity is an S-curve)
+ */
+enum ProfileShape{
+  PROFILE_NONE,
+  PROFILE_TRAPEZOIDAL,
+  PROFILE_SCURVE
+};
+/**
+ * One sample of a profile
+ * pos: position along the movement (inches)
+ * vel: velocity (inches per second)
+ * acc: acceleration (inches per second squared)
+ */
+struct ProfileSetpoint{
+  double pos, vel, acc;
+};
+/**
+ * The class MotionProfile plans a rest-to-rest movement over a given distance.
+ * A trapezoidal profile is the special case of the S-curve with infinite jerk,
+ * so both shapes are stored as the same 7 constant-jerk segments:
+ * jerk up, constant acceleration, jerk down, cruise, jerk down, constant deceleration, jerk up
+ */
+class MotionProfile{
+public:
+  /**
+   * refer to motionProfile.cpp for function documentation
+   */
+  MotionProfile();
+  void generate(double distance, double maxVel, double maxAcc, double maxJerk, ProfileShape shape);
+  ProfileSetpoint sample(double t) const;
+  double getDuration() const;
+  double getDistance() const;
+  double getDecelStart() const;
+private:
+  /** starting time, position, velocity, acceleration and jerk of each segment */
+  double segTime[8], segPos[8], segVel[8], segAcc[8], segJerk[7];
+  /** direction of the movement (1 or -1) */
+  double sign;
+};
+
+#endif
@@ -0,0 +1,90 @@
+/**
+ * Header file for motionQueue.cpp
+ * Defines the motion command queue: autonomous code queues movements without blocking,
+ * and the baseControl task starts each one when the previous one has settled or timed out
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_MOTION_QUEUE_HPP_
+#define _8059_MOTION_PROFILE_LIB_MOTION_QUEUE_HPP_
+#include "8059MotionProfileLib/include/baseControl.hpp"
+#include "8059MotionProfileLib/include/purePursuit.hpp"
+#include <cstdint>
+// Maximum number of queued motions
+#define MOTION_QUEUE_SIZE 16
+/** Motion primitives, matching the movement functions in baseControl.cpp */
+enum MotionType{
+  MOTION_MOVE,            // baseMove(dis)
+  MOTION_MOVE_TO,         // baseMove(x, y)
+  MOTION_TURN,            // baseTurn(angleDeg)
+  MOTION_TURN_TO,         // baseTurn(x, y, reverse)
+  MOTION_TURN_RELATIVE,   // baseTurnRelative(angle)
+  MOTION_PURSUIT,         // basePursuit(points, count, reverse)
+  MOTION_TRAJECTORY,      // followTrajectory(name)
+  MOTION_ARC,             // baseArc(radius, angleDeg)
+  MOTION_ARC_TO,          // baseArcTo(x, y)
+  MOTION_SWING,           // baseSwing(angleDeg, pivot)
+  MOTION_MOVE_TO_POSE     // baseMoveToPose(x, y, angleDeg, reverse)
+};
+/**
+ * A queued motion
+ * type: motion primitive
+ * x, y, angle: parameters of the primitive (distance in x for MOTION_MOVE, radius in x for MOTION_ARC, angle in degrees)
+ * reverse: backward movement (MOTION_TURN_TO, MOTION_PURSUIT, MOTION_MOVE_TO_POSE)
+ * pivot: side held in place (MOTION_SWING)
+ * points, count: path of MOTION_PURSUIT (must stay valid until the motion starts)
+ * triggers, triggerCount: path triggers of MOTION_PURSUIT (must stay valid until the motion starts)
+ * name: trajectory of MOTION_TRAJECTORY
+ * kp, kd: gains
+ * settle: settle rule, including the timeout (refer to settleDetector.hpp)
+ * chain: start while the previous motion is decelerating (set by setMotionChaining)
+ * exitDistance, exitTime: early exit (set by setMotionEarlyExit, 0: off)
+ * output: motor output mode of the motion (set by setMotionOutputMode)
+ * deadline: match time in ms to arrive by (set by setNextMotionDeadline, 0: none)
+ * estimate: expected duration in ms of an optional motion (set by setNextMotionOptional, 0: not optional)
+ */
+struct MotionCommand{
+  MotionType type;
+  double x, y, angle;
+  bool reverse;
+  BaseSide pivot;
+  const PursuitPoint *points;
+  int count;
+  const PathTrigger *triggers;
+  int triggerCount;
+  const char *name;
+  double kp, kd;
+  SettleRule settle;
+  bool chain;
+  double exitDistance;
+  uint32_t exitTime;
+  BaseOutputMode output;
+  uint32_t deadline, estimate;
+};
+/**
+ * refer to motionQueue.cpp for function documentation
+ */
+void setMotionChaining(bool chain);
+void setMotionEarlyExit(double distance, uint32_t time);
+void setMotionOutputMode(BaseOutputMode mode);
+void setNextMotionDeadline(uint32_t matchTime);
+void setNextMotionOptional(uint32_t estimate);
+bool queueMotion(const MotionCommand &command);
+bool queueMove(double dis, double kp = GAIN_SCHEDULED, double kd = GAIN_SCHEDULED, SettleRule settle = DEFAULT_SETTLE_RULE);
+bool queueMoveTo(double x, double y, double kp = GAIN_SCHEDULED, double kd = GAIN_SCHEDULED, SettleRule settle = DEFAULT_SETTLE_RULE);
+bool queueTurn(double angleDeg, double kp = GAIN_SCHEDULED, double kd = GAIN_SCHEDULED, SettleRule settle = DEFAULT_SETTLE_RULE);
+bool queueTurnTo(double x, double y, bool reverse = false, double kp = GAIN_SCHEDULED, double kd = GAIN_SCHEDULED, SettleRule settle = DEFAULT_SETTLE_RULE);
+bool queueTurnRelative(double angleDeg, double kp = GAIN_SCHEDULED, double kd = GAIN_SCHEDULED, SettleRule settle = DEFAULT_SETTLE_RULE);
+bool queueArc(double radius, double angleDeg, double kp = GAIN_SCHEDULED, double kd = GAIN_SCHEDULED, SettleRule settle = DEFAULT_SETTLE_RULE);
+bool queueArcTo(double x, double y, double kp = GAIN_SCHEDULED, double kd = GAIN_SCHEDULED, SettleRule settle = DEFAULT_SETTLE_RULE);
+bool queueSwing(double angleDeg, BaseSide pivot, double kp = GAIN_SCHEDULED, double kd = GAIN_SCHEDULED, SettleRule settle = DEFAULT_SETTLE_RULE);
+bool queueMoveToPose(double x, double y, double angleDeg, bool reverse = false, SettleRule settle = DEFAULT_SETTLE_RULE);
+bool queuePursuit(const PursuitPoint *points, int count, bool reverse = false, SettleRule settle = DEFAULT_SETTLE_RULE);
+bool queuePursuit(const PursuitPoint *points, int count, const PathTrigger *triggers, int triggerCount,
+  bool reverse = false, SettleRule settle = DEFAULT_SETTLE_RULE);
+bool queueTrajectory(const char *name, double kp = DEFAULT_KP, double kd = DEFAULT_KD, SettleRule settle = DEFAULT_SETTLE_RULE);
+void clearMotionQueue();
+bool isMotionQueueIdle();
+bool getMotionSequence(uint32_t &queued, uint32_t &started);
+bool waitMotionQueue(uint32_t cutoff);
+void updateMotionQueue(const BaseControlFrame &frame);
+
+#endif
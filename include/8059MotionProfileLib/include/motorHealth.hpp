@@ -0,0 +1,70 @@
+/**
+ * Header file for motorHealth.cpp
+ * Defines the motor health monitor: a low-rate task samples the temperature, the current draw and
+ * the over-temperature flag of the eight motors, and derates the base power cap smoothly as the base
+ * motors heat up, before the firmware throttles them on its own in the middle of a path
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_MOTOR_HEALTH_HPP_
+#define _8059_MOTION_PROFILE_LIB_MOTOR_HEALTH_HPP_
+#include "8059MotionProfileLib/include/filterPipeline.hpp"
+#include <cstdint>
+/**
+ * Derating model (refer to thermalScale)
+ * HEALTH_DERATE_START: temperature (C) at which the base cap starts to drop
+ * HEALTH_DERATE_END: temperature at which it reaches HEALTH_DERATE_MIN (the firmware halves the current
+ *   limit at 55 C); a motor reporting over temperature is at HEALTH_DERATE_MIN at once
+ * HEALTH_CURRENT_LIMIT: current limit of a motor in mA
+ * HEALTH_CURRENT_LEAD: degrees C added to the reading at HEALTH_CURRENT_LIMIT (scaled by the squared load), so a
+ *   motor working hard derates before its reading steps up (the motors report in 5 C steps)
+ * HEALTH_CAP_SLEW: largest change of the cap fraction per second, so the cap never jumps mid-path
+ * HEALTH_VOLTAGE_HEADROOM: battery voltage (mV) lost before the motors under load; below
+ *   MOTOR_REFERENCE_VOLTAGE + headroom full power is out of reach, and the cap follows the battery (once the battery
+ *   model knows the battery's resistance, the cap follows the voltage it predicts at the base's full draw instead)
+ */
+#define HEALTH_DERATE_START 45
+#define HEALTH_DERATE_END 55
+#define HEALTH_DERATE_MIN 0.5
+#define HEALTH_CURRENT_LIMIT 2500
+#define HEALTH_CURRENT_LEAD 5
+#define HEALTH_CAP_SLEW 0.1
+#define HEALTH_VOLTAGE_HEADROOM 500
+/**
+ * Filter of the current samples of a motor: the median of the last 3 (a jam or a ball entering the rollers
+ * spikes single samples), then a moving average weighing a new sample 1/5
+ */
+typedef Pipeline<Median<3>, Ema<1, 5>> HealthCurrentFilter;
+/**
+ * Monitored motors: the base motors (in BaseMotor order), then the mechanisms
+ */
+enum HealthMotor{
+  HEALTH_FRONT_LEFT,
+  HEALTH_BACK_LEFT,
+  HEALTH_FRONT_RIGHT,
+  HEALTH_BACK_RIGHT,
+  HEALTH_LEFT_ROLLER,
+  HEALTH_RIGHT_ROLLER,
+  HEALTH_INDEXER,
+  HEALTH_SHOOTER,
+  HEALTH_MOTORS
+};
+// Smart port of each monitored motor (HealthMotor order)
+extern const uint8_t healthPorts[HEALTH_MOTORS];
+/**
+ * Last sample of a motor
+ * temperature: degrees C; current: moving average of the current draw in mA
+ * overTemp: the motor reports over temperature (the firmware is limiting it)
+ * scale: power fraction the model allows the motor (HEALTH_DERATE_MIN to 1)
+ */
+struct MotorHealth{
+  float temperature, current, scale;
+  bool overTemp;
+};
+/**
+ * refer to motorHealth.cpp for function documentation
+ */
+double thermalScale(double temperature, double current, bool overTemp);
+MotorHealth getMotorHealth(HealthMotor motor);
+double getBaseDerateCap();
+void motorHealth(void * ignore);
+
+#endif
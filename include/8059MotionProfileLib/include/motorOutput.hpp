@@ -0,0 +1,54 @@
+/**
+ * Header file for motorOutput.cpp
+ * Defines the shared motor output layer: the last command of every smart port is cached
+ * and a command is only sent when it changes (or as a periodic keep-alive); a dry run holds every output at 0
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_MOTOR_OUTPUT_HPP_
+#define _8059_MOTION_PROFILE_LIB_MOTOR_OUTPUT_HPP_
+#include "api.h"
+#include <cstdint>
+// Number of smart ports (1 to 21)
+#define MOTOR_PORTS 21
+// An unchanged command is sent again after this time in ms (e.g. to a motor that reconnected)
+#define MOTOR_KEEPALIVE 100
+/**
+ * Battery voltage compensation of the open-loop commands (power and voltage; velocity commands are
+ * closed by the motor itself): a voltage command is a fraction of the battery, so the same power
+ * pushes harder on a full battery than on a drained one
+ * MOTOR_VOLTAGE_COMPENSATION: 0 off, 1 scale the commands so that full power puts
+ *   MOTOR_REFERENCE_VOLTAGE on the motor whatever the battery (while the battery can reach it)
+ * MOTOR_REFERENCE_VOLTAGE: motor voltage (mV) of full power, reachable down to a sagging battery
+ * MOTOR_BATTERY_DT: the battery is read at most this often (ms)
+ * MOTOR_BATTERY_FILTER: weight of a new reading in the moving average, so a command does not
+ *   chase the sag of one acceleration
+ */
+#define MOTOR_VOLTAGE_COMPENSATION 1
+#define MOTOR_REFERENCE_VOLTAGE 12000
+#define MOTOR_BATTERY_DT 100
+#define MOTOR_BATTERY_FILTER 0.3
+/** Command kinds, matching pros::Motor::move, move_voltage and move_velocity */
+enum MotorCommandMode{
+  MOTOR_COMMAND_NONE,
+  MOTOR_COMMAND_POWER,      // -127 to 127
+  MOTOR_COMMAND_VOLTAGE,    // -12000 to 12000 mV
+  MOTOR_COMMAND_VELOCITY    // rpm of the cartridge
+};
+/**
+ * Commands sent to and skipped for all ports since the start
+ */
+struct MotorOutputStats{
+  uint32_t sent, skipped;
+};
+/**
+ * refer to motorOutput.cpp for function documentation
+ */
+int32_t compensateMotorVoltage(int32_t voltage);
+void setMotorPower(const pros::Motor &motor, int32_t power);
+void setMotorVoltage(const pros::Motor &motor, int32_t voltage);
+void setMotorVelocity(const pros::Motor &motor, int32_t velocity);
+void resendMotorOutput(const pros::Motor &motor);
+void holdMotorOutputs(bool hold);
+bool getMotorCommand(uint8_t port, MotorCommandMode &mode, int32_t &value);
+MotorOutputStats getMotorOutputStats();
+
+#endif
@@ -0,0 +1,37 @@
+/**
+ * Header file for motorSnapshot.cpp
+ * Defines the shared motor snapshot: each read of a smart motor's data is a call into the firmware, and the
+ * base controller, the shooter and the health monitor used to read the same motors on their own. Task
+ * motorSampler reads the eight motors instead (HealthMotor order) and publishes their data as one snapshot:
+ * - position, velocity, current every MOTOR_SNAPSHOT_DT (the motors' update period, SENSOR_DEVICE_DT)
+ * - temperature, over temperature every MOTOR_SNAPSHOT_SLOW_DT (the motors report temperature in 5 C steps)
+ * A consumer reads the snapshot (refer to getMotorSnapshot) without touching a device, at most one update old.
+ * Loops that difference a position against their own clock (odometry, the shooter's velocity loop) and the
+ * latency probe still read their motors directly, since a cached sample would skew their timing.
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_MOTOR_SNAPSHOT_HPP_
+#define _8059_MOTION_PROFILE_LIB_MOTOR_SNAPSHOT_HPP_
+#include "8059MotionProfileLib/include/motorHealth.hpp"
+// Refresh period of the temperatures (a multiple of MOTOR_SNAPSHOT_DT, refer to taskConfig.hpp)
+#define MOTOR_SNAPSHOT_SLOW_DT 100
+/**
+ * Data of the eight motors, one array per field (indexed by HealthMotor)
+ * position: integrated encoder position (encoder degrees); velocity: rpm; current: current draw in mA
+ * temperature: degrees C; overTemp: the motor reports over temperature
+ * fastTime, slowTime: when the fast and the slow fields were last read (millis, 0 before the first read)
+ */
+struct MotorSnapshot{
+  double position[HEALTH_MOTORS];
+  float velocity[HEALTH_MOTORS];
+  float current[HEALTH_MOTORS];
+  float temperature[HEALTH_MOTORS];
+  bool overTemp[HEALTH_MOTORS];
+  uint32_t fastTime, slowTime;
+};
+/**
+ * refer to motorSnapshot.cpp for function documentation
+ */
+MotorSnapshot getMotorSnapshot();
+void motorSampler(void * ignore);
+
+#endif
@@ -0,0 +1,51 @@
+/**
+ * Header file for moveToPose.cpp
+ * Defines the move-to-pose controller: the base drives to a point and arrives at a bearing in one
+ * movement, steering towards a carrot point set back from the goal along the goal bearing by a share
+ * of the distance left (a "boomerang" approach), so the turn, drive, turn of a goal approach (and two
+ * of their settles) become one curve. Uses the live pose from the odometry task.
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_MOVE_TO_POSE_HPP_
+#define _8059_MOTION_PROFILE_LIB_MOVE_TO_POSE_HPP_
+#include "8059MotionProfileLib/include/baseOdometry.hpp"
+/**
+ * Default move-to-pose parameters (inches, radians, seconds)
+ * MOVE_POSE_LEAD: carrot set back by this share of the distance to the goal (0: straight at the point,
+ *   larger: wider curve, closer to the goal bearing on arrival)
+ * MOVE_POSE_MAX_VEL: maximum forward velocity (the outer side is kept within it too)
+ * MOVE_POSE_MAX_DECEL: deceleration used to slow down towards the goal
+ * MOVE_POSE_LIN_GAIN: forward velocity per inch of distance (1/s)
+ * MOVE_POSE_ANG_GAIN: angular velocity per radian of heading error (1/s)
+ * MOVE_POSE_CLOSE_DIST: within this distance the carrot is dropped and the base turns to the goal
+ *   bearing while closing the distance along its heading
+ * MOVE_POSE_END_DIST & MOVE_POSE_END_ANGLE: distance along the heading and bearing error (degrees) at which
+ *   the movement is finished and the base is held where it is
+ */
+#define MOVE_POSE_LEAD 0.5
+#define MOVE_POSE_MAX_VEL 30
+#define MOVE_POSE_MAX_DECEL 40
+#define MOVE_POSE_LIN_GAIN 5
+#define MOVE_POSE_ANG_GAIN 6
+#define MOVE_POSE_CLOSE_DIST 4
+#define MOVE_POSE_END_DIST 0.5
+#define MOVE_POSE_END_ANGLE 2
+/**
+ * The goal of a move to pose
+ * (x, y): goal point; angle: bearing on arrival (radians)
+ * lead: MOVE_POSE_LEAD of the movement; maxVel: MOVE_POSE_MAX_VEL of the movement
+ * reverse: the base drives backwards (arriving with its front at the bearing)
+ */
+struct PoseMoveGoal{
+  double x, y, angle;
+  double lead, maxVel;
+  bool reverse;
+};
+/**
+ * refer to moveToPose.cpp for function documentation
+ */
+bool computeHolonomicMoveToPose(const PoseSnapshot &pose, const PoseMoveGoal &goal, double &velL, double &velR, double &velS);
+bool computeMoveToPose(const PoseSnapshot &pose, const PoseMoveGoal &goal, double &velL, double &velR, double &velS);
+void baseMoveToPose(double x, double y, double angleDeg, double lead, double maxVel, bool reverse);
+void baseMoveToPose(double x, double y, double angleDeg, bool reverse = false);
+
+#endif
@@ -0,0 +1,69 @@
+/**
+ * Header file for mpcTracker.cpp
+ * Defines the model-predictive tracker, an alternative to RAMSETE (refer to ramsete.hpp) for fast segments: the
+ * error to the trajectory's reference pose is predicted MPC_HORIZON steps ahead on a tank model linearized about
+ * the reference velocities, and the side velocities over the horizon minimize the weighted errors and velocity
+ * corrections within the side velocity limit (a box-constrained QP).
+ * The QP's matrices depend on the reference velocities only, so they are built for a grid of them at init
+ * (refer to prepareMpc); a control cycle takes the nearest entry and runs MPC_ITERATIONS of projected fast
+ * gradient on fixed-size matrices (refer to matrix.hpp), warm started from the previous cycle's solution.
+ *
+ * Error (the robot's frame, as RAMSETE): forward, to the right (inches) and bearing (radians, clockwise) of the
+ * reference pose; inputs: the corrections of the left and right side velocities (in/s). At reference velocities
+ * v and w (clockwise), over a step T:
+ *   forward' = forward + T*(w*right - (dL + dR)/2)
+ *   right'   = right + T*(v*bearing - w*forward)
+ *   bearing' = bearing - T*(dL - dR)/baseWidth
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_MPC_TRACKER_HPP_
+#define _8059_MOTION_PROFILE_LIB_MPC_TRACKER_HPP_
+#include "8059MotionProfileLib/include/matrix.hpp"
+#include "8059MotionProfileLib/include/baseOdometry.hpp"
+#include "8059MotionProfileLib/include/taskConfig.hpp"
+#include "8059MotionProfileLib/include/trajectoryCache.hpp"
+/**
+ * Horizon
+ * MPC_HORIZON: steps predicted; MPC_STEP: control cycles per step (the horizon is MPC_HORIZON*MPC_STEP cycles)
+ * MPC_ITERATIONS: fast gradient iterations per control cycle
+ */
+#define MPC_HORIZON 6
+#define MPC_STEP 2
+#define MPC_DT (MPC_STEP*BASE_CONTROL_DT/1000.0)
+#define MPC_INPUTS (2*MPC_HORIZON)
+#define MPC_ITERATIONS 8
+/**
+ * Cost per step: MPC_Q_FORWARD, MPC_Q_LATERAL per squared inch of error, MPC_Q_ANGLE per squared radian,
+ * MPC_R per squared in/s of velocity correction of a side
+ * MPC_MAX_VEL: side velocity limit (in/s)
+ */
+#define MPC_Q_FORWARD 1
+#define MPC_Q_LATERAL 1
+#define MPC_Q_ANGLE 100
+#define MPC_R 0.01
+#define MPC_MAX_VEL 40
+/**
+ * Linearization grid: MPC_SPEED_CLASSES reference velocities evenly over +-MPC_MAX_VEL and MPC_TURN_CLASSES
+ * reference turn rates evenly over +-MPC_MAX_TURN (rad/s); a control cycle takes the nearest of each
+ */
+#define MPC_SPEED_CLASSES 5
+#define MPC_TURN_CLASSES 5
+#define MPC_MAX_TURN 4
+/**
+ * The QP of a grid entry: cost 1/2 U'HU + (G e)'U over the inputs U of the horizon (dL, dR per step) from the error e
+ * hessian: H; gradient: G; step: 1/(largest eigenvalue of H); momentum: fast gradient momentum (from MPC_R,
+ * the smallest eigenvalue H can have)
+ */
+struct MpcStructure{
+  Matrix<MPC_INPUTS, MPC_INPUTS> hessian;
+  Matrix<MPC_INPUTS, 3> gradient;
+  double step, momentum;
+};
+/**
+ * refer to mpcTracker.cpp for function documentation
+ */
+void prepareMpc();
+const MpcStructure *getMpcStructure(double vel, double turn);
+void resetMpc();
+void computeMpc(const PoseSnapshot &pose, const CachedTrajectory &trajectory, double t, double &velL, double &velR);
+
+#endif
@@ -0,0 +1,81 @@
+/**
+ * Header file for paramTable.cpp
+ * Defines the live parameter table: named constants that can be changed while the robot runs, from
+ * the serial terminal or a file on the microSD card, without a rebuild. The control loops read the
+ * published table with one atomic pointer load; a change is written into the spare of two tables
+ * and published by swapping the pointer, so a reader never waits and never sees half a change
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_PARAM_TABLE_HPP_
+#define _8059_MOTION_PROFILE_LIB_PARAM_TABLE_HPP_
+#include <atomic>
+#include <cstdint>
+/**
+ * Parameter file on the microSD card, loaded with the gain schedule if it exists
+ * One parameter per line: name value (parameters left out keep their values)
+ */
+#ifndef PARAM_FILE_PATH
+#define PARAM_FILE_PATH "/usd/params.txt"
+#endif
+/**
+ * PARAM_GRACE: time in ms a replaced table stays untouched before the next change is written into it,
+ * so a reader that loaded the pointer just before the swap finishes with it (readers copy the values
+ * they need right after the load and never keep the pointer across a delay)
+ * PARAM_LINE: longest command line from the serial terminal
+ */
+#define PARAM_GRACE 20
+#define PARAM_LINE 64
+/** The parameters (refer to paramInfo in paramTable.cpp for the names, defaults and limits) */
+enum TunableParam{
+  PARAM_TRAJECTORY_KP,      // kp of followTrajectory without gains (DEFAULT_KP)
+  PARAM_TRAJECTORY_KD,      // kd of followTrajectory without gains (DEFAULT_KD)
+  PARAM_RAMPING_POW,        // base power increment per control cycle (RAMPING_POW; the start of the traction-limited ramp)
+  PARAM_MAX_POW,            // base power cap of the movements (MAX_POW)
+  PARAM_GAIN_KP_SCALE,      // scale of the scheduled kp of the movements (refer to gainSchedule.hpp)
+  PARAM_GAIN_KD_SCALE,      // scale of the scheduled kd of the movements
+  PARAM_PROFILE_MAX_VEL,    // velocity limit of the straight movements' profiles (PROFILE_MAX_VEL)
+  PARAM_PROFILE_MAX_ACC,    // acceleration limit of the straight movements' profiles (PROFILE_MAX_ACC)
+  PARAM_PURSUIT_LOOKAHEAD,  // lookahead of the pure-pursuit paths without one (PURSUIT_LOOKAHEAD)
+  PARAM_CYCLE_SPEED,        // indexer power of a shooter cycle (refer to mech_lib.cpp)
+  PARAMS
+};
+/**
+ * A published table
+ * values: the parameters, indexed by TunableParam
+ * version: number of changes published so far
+ */
+struct ParamTable{
+  double values[PARAMS];
+  uint32_t version;
+};
+extern std::atomic<const ParamTable *> paramTable;
+/**
+ * @return
+ * the published table (read the values right away; do not keep the pointer across a delay)
+ */
+inline const ParamTable *getParams(){
+  return paramTable.load(std::memory_order_acquire);
+}
+/**
+ * @param param
+ * a parameter
+ *
+ * @return
+ * its published value
+ */
+inline double getParam(TunableParam param){
+  return getParams()->values[param];
+}
+/**
+ * refer to paramTable.cpp for function documentation
+ */
+int findParam(const char *name);
+const char *getParamName(TunableParam param);
+bool setParam(TunableParam param, double value);
+bool setParams(const TunableParam *params, const double *values, int count);
+void resetParams();
+bool loadParams();
+bool saveParams();
+bool runParamCommand(const char *line);
+void pollParamCommands();
+
+#endif
@@ -0,0 +1,62 @@
+/**
+ * Header file for pathPlanner.cpp
+ * Defines the path planner: A* over a bit-packed occupancy grid of the field (generated at compile time
+ * from the field obstacles, inflated by the robot's clearance), smoothed into waypoints for the
+ * pure-pursuit follower, fast enough to replan during a match
+ * Obstacles seen during the match are added to the grid at run time; the incremental planner (D* Lite)
+ * keeps its search between plans and only repairs it around the changed cells, and the repaired path
+ * replaces the one being followed without the robot stopping
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_PATH_PLANNER_HPP_
+#define _8059_MOTION_PROFILE_LIB_PATH_PLANNER_HPP_
+#include "8059MotionProfileLib/include/purePursuit.hpp"
+#include "8059MotionProfileLib/include/dashboard.hpp"
+#include <cstdint>
+/**
+ * Grid
+ * PLANNER_CELL: side of a cell in inches
+ * PLANNER_GRID: cells per side (a row is one uint64_t, so at most 64)
+ * PLANNER_CLEARANCE: distance the robot's centre keeps from obstacles and walls in inches
+ *   (half the robot's diagonal plus a margin)
+ * PLANNER_ORIGIN_X, PLANNER_ORIGIN_Y: odometry origin in inches from the field's bottom left corner
+ */
+#define PLANNER_CELL 3
+#define PLANNER_GRID 48
+#define PLANNER_CLEARANCE 10
+#define PLANNER_ORIGIN_X DASHBOARD_ORIGIN_X
+#define PLANNER_ORIGIN_Y DASHBOARD_ORIGIN_Y
+// Number of field obstacles (refer to fieldObstacles in pathPlanner.cpp)
+#define FIELD_OBSTACLES 9
+// Most grid cells changed between two incremental plans that are tracked (more: the search starts over)
+#define PLANNER_MAX_CHANGES 256
+/**
+ * Robot hit during a planned pursuit (refer to replanAroundImpact)
+ * PLANNER_IMPACT_RADIUS: radius in inches of the obstacle marked for it (half a robot)
+ * PLANNER_IMPACT_GAP: cells left free between the robot and the obstacle's clearance, so a path leads away from it
+ */
+#define PLANNER_IMPACT_RADIUS 9
+#define PLANNER_IMPACT_GAP 2
+/** A round obstacle in inches from the field's bottom left corner */
+struct FieldObstacle{
+  double x, y, radius;
+};
+/** The occupancy grid: bit x of row y is set if cell (x, y) is blocked */
+struct OccupancyGrid{
+  uint64_t rows[PLANNER_GRID];
+};
+/**
+ * refer to pathPlanner.cpp for function documentation
+ */
+bool isPlannerCellFree(int x, int y);
+int setPlannerObstacle(double x, double y, double radius, bool blocked = true);
+void clearPlannerObstacles();
+int planPath(double startX, double startY, double goalX, double goalY, PursuitPoint *points, int maxPoints);
+int startReplanning(double startX, double startY, double goalX, double goalY, PursuitPoint *points, int maxPoints);
+int replanPath(double startX, double startY, PursuitPoint *points, int maxPoints);
+int getReplanExpansions();
+bool basePlannedPursuit(double x, double y, bool reverse = false);
+bool baseReplannedPursuit(double x, double y, bool reverse = false);
+bool repairPlannedPursuit();
+bool replanAroundImpact();
+
+#endif
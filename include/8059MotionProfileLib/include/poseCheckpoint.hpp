@@ -0,0 +1,54 @@
+/**
+ * Header file for poseCheckpoint.cpp
+ * Defines the pose checkpoints: a brownout or a static discharge restarts the program in the middle of a match, and
+ * the odometry would start over at (0, 0, 0). While the robot is enabled, Task poseCheckpoint saves the latest pose
+ * (from the odometry task, refer to getPose), the routine, its step (refer to staticRoutine.hpp) and the match time
+ * to the microSD card every CHECKPOINT_DT. When initialize() finds the robot enabled on a field, the program was
+ * restarted during the match: resumeCheckpoint puts the odometry back at the newest checkpoint, and the next
+ * autonomous() carries on from the step and the match time of the checkpoint instead of starting the routine over.
+ * A resume takes one read of the card; the sensors are not calibrated again (the robot is moving).
+ * Only a static routine or a script can be resumed: it starts again at the first step after the last motion that
+ * finished (the motion interrupted is driven again, relative motions in full), with the settings of the steps
+ * before (intake power, sort color, early exit) applied again. Any other routine is not run again.
+ * Checkpoints alternate between two files (CHECKPOINT_PATH, slot 0 and 1), so a write cut by the restart leaves
+ * the previous one; a checkpoint is checked by its CRC.
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_POSE_CHECKPOINT_HPP_
+#define _8059_MOTION_PROFILE_LIB_POSE_CHECKPOINT_HPP_
+#include <cstdint>
+// Checkpoint files (printf format of the slot, 0 or 1)
+#ifndef CHECKPOINT_PATH
+#define CHECKPOINT_PATH "/usd/checkpoint%d.bin"
+#endif
+// Bump CHECKPOINT_FILE_VERSION when PoseCheckpoint changes
+#define CHECKPOINT_FILE_MAGIC 0x50434B38
+#define CHECKPOINT_FILE_VERSION 1
+/**
+ * A checkpoint (the content of a checkpoint file)
+ * sequence: number of the checkpoint (the newest valid one is resumed)
+ * phase: RobotPhase it was saved in (a routine only resumes from PHASE_AUTON)
+ * routine: routine selected (index into the routine table)
+ * step: first step of the routine to run on a resume (-1: the routine does not run in steps)
+ * matchTime: ms since the start of the autonomous period (refer to getMatchTime)
+ * x, y, angle: pose in inches and radians
+ * crc: crc16 of the fields before it
+ */
+struct PoseCheckpoint{
+  uint32_t magic, version, sequence;
+  uint8_t phase;
+  int8_t routine;
+  int16_t step;
+  uint32_t matchTime;
+  float x, y, angle;
+  uint16_t crc;
+};
+/**
+ * refer to poseCheckpoint.cpp for function documentation
+ */
+bool resumeCheckpoint();
+int getResumeStep();
+int takeResumeStep();
+uint32_t takeResumeMatchTime();
+void poseCheckpoint(void * ignore);
+
+#endif
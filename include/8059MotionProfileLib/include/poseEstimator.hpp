@@ -0,0 +1,90 @@
+/**
+ * Header file for poseEstimator.cpp
+ * Defines the pose estimator: an extended Kalman filter over (x, y, bearing, linear velocity, angular
+ * velocity) that the odometry task runs instead of the arc integration (refer to ODOM_ESTIMATOR):
+ * - every tick, the tracking wheels measure the velocities and a constant velocity model predicts the pose
+ * - the IMU measures the bearing at each new sample
+ * - the vision landmarks (bearing & distance) and the ultrasonic wall ranges measure the pose at their own rates
+ * (the scalar pattern of okapi's EKFFilter, on fixed-size matrices; refer to matrix.hpp)
+ * Without the estimator the odometry still grows the covariance of the pose with the distance travelled and
+ * turned (growEstimateUncertainty), so the uncertainty of the pose is known either way (refer to PoseUncertainty).
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_POSE_ESTIMATOR_HPP_
+#define _8059_MOTION_PROFILE_LIB_POSE_ESTIMATOR_HPP_
+#include "8059MotionProfileLib/include/matrix.hpp"
+#include <cstdint>
+/** state vector indices */
+#define ESTIMATE_X 0
+#define ESTIMATE_Y 1
+#define ESTIMATE_ANGLE 2
+#define ESTIMATE_VEL 3
+#define ESTIMATE_ANG_VEL 4
+#define ESTIMATE_SIZE 5
+/**
+ * Process noise (standard deviations)
+ * ESTIMATOR_ACC_NOISE: linear acceleration, in/s^2; ESTIMATOR_ANG_ACC_NOISE: angular acceleration, rad/s^2
+ *   (larger: the velocities follow the tracking wheels more closely)
+ * ESTIMATOR_SLIP_NOISE: position error per square root inch travelled (wheel slip, diameter error)
+ * ESTIMATOR_SCRUB_NOISE: bearing error in radians per square root radian turned (scrub, base width error)
+ */
+#define ESTIMATOR_ACC_NOISE 400
+#define ESTIMATOR_ANG_ACC_NOISE 40
+#define ESTIMATOR_SLIP_NOISE 0.03
+#define ESTIMATOR_SCRUB_NOISE 0.02
+/**
+ * Measurement noise (standard deviations)
+ * ESTIMATOR_VEL_NOISE, ESTIMATOR_ANG_VEL_NOISE: velocities from one tick of the tracking wheels
+ *   (about the encoder resolution over ODOM_DT), in/s and rad/s
+ * ESTIMATOR_IMU_NOISE: IMU bearing, degrees
+ * ESTIMATOR_BEARING_NOISE: vision bearing, degrees; ESTIMATOR_DISTANCE_NOISE: vision distance, as a ratio of it
+ * ESTIMATOR_RANGE_NOISE: ultrasonic range across the wall, inches
+ */
+#define ESTIMATOR_VEL_NOISE 1.5
+#define ESTIMATOR_ANG_VEL_NOISE 0.15
+#define ESTIMATOR_IMU_NOISE 0.5
+#define ESTIMATOR_BEARING_NOISE 1
+#define ESTIMATOR_DISTANCE_NOISE 0.05
+#define ESTIMATOR_RANGE_NOISE 0.5
+/**
+ * ESTIMATOR_INITIAL_POSITION, ESTIMATOR_INITIAL_ANGLE: uncertainty of a pose set by setCoords (inches, degrees)
+ * ESTIMATOR_GATE: largest squared Mahalanobis distance of an accepted measurement (larger: an outlier)
+ */
+#define ESTIMATOR_INITIAL_POSITION 0.5
+#define ESTIMATOR_INITIAL_ANGLE 1
+#define ESTIMATOR_GATE 9
+/**
+ * PoseEstimate: the filter
+ * state: (x, y, bearing, linear velocity, angular velocity) in inches, radians and seconds
+ * covariance: covariance of the state
+ * initialized: set by resetEstimate
+ */
+struct PoseEstimate{
+  Matrix<ESTIMATE_SIZE, 1> state;
+  Matrix<ESTIMATE_SIZE, ESTIMATE_SIZE> covariance;
+  bool initialized;
+};
+/**
+ * PoseUncertainty: standard deviations of the pose (refer to getPoseUncertainty)
+ * position: along the most uncertain direction (square root of the largest eigenvalue of the x-y covariance), inches
+ * angle: of the bearing, radians
+ * timestamp: time of the sensor frame of the pose (micros)
+ */
+struct PoseUncertainty{
+  double position, angle;
+  uint64_t timestamp;
+};
+/**
+ * refer to poseEstimator.cpp for function documentation
+ */
+void resetEstimate(PoseEstimate &estimate, double x, double y, double angle);
+void predictEstimate(PoseEstimate &estimate, double dt);
+bool updateVelocityEstimate(PoseEstimate &estimate, double linVel, double angVel);
+bool updateHeadingEstimate(PoseEstimate &estimate, double angle);
+bool updateLandmarkEstimate(PoseEstimate &estimate, double x, double y, double angle,
+                            double landmarkX, double landmarkY, double bearing, double distance);
+bool updateAxisEstimate(PoseEstimate &estimate, double normalX, double normalY, double innovation, double sigma);
+void growEstimateUncertainty(PoseEstimate &estimate, double angle, double forward, double lateral, double deltaAngle);
+void keepEstimateVariance(PoseEstimate &estimate, const Matrix<ESTIMATE_SIZE, ESTIMATE_SIZE> &prior, int index);
+PoseUncertainty getEstimateUncertainty(const PoseEstimate &estimate);
+
+#endif
@@ -0,0 +1,18 @@
+/**
+ * Header file for poseHistory.cpp
+ * Defines the pose history: the last POSE_HISTORY_SIZE poses of the odometry task,
+ * for querying the pose at a past time (e.g. the capture time of another sensor)
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_POSE_HISTORY_HPP_
+#define _8059_MOTION_PROFILE_LIB_POSE_HISTORY_HPP_
+#include "8059MotionProfileLib/include/baseOdometry.hpp"
+#include <cstdint>
+// Number of poses kept (one per odometry tick: 128 * ODOM_DT = 1280 ms)
+#define POSE_HISTORY_SIZE 128
+/**
+ * refer to poseHistory.cpp for function documentation
+ */
+void recordPose(const PoseSnapshot &pose);
+bool getPoseAt(uint64_t timestamp, PoseSnapshot &pose);
+
+#endif
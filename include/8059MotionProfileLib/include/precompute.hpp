@@ -0,0 +1,45 @@
+/**
+ * Header file for precompute.cpp
+ * Defines the background precomputation of the disabled phase: the robot often waits for minutes in disabled()
+ * and competition_initialize() before a match, so a low priority task works through a queue of jobs then (prepare
+ * the selected routine, read its trajectories through, recalibrate the IMU). A job runs in short steps and the task
+ * only runs in PHASE_DISABLED (refer to taskRegistry.hpp): when the phase ends it parks after the step in progress,
+ * which cancels the job (it stays queued and starts over in the next disabled phase), so autonomous waits for one
+ * step at most (refer to waitPrecompute) and starts with everything ready.
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_PRECOMPUTE_HPP_
+#define _8059_MOTION_PROFILE_LIB_PRECOMPUTE_HPP_
+#include <cstdint>
+// Pause between two steps in ms (the selector and the brain screen run meanwhile)
+#define PRECOMPUTE_DT 10
+/**
+ * IMU recalibration (PRECOMPUTE_IMU, only with ODOM_USE_IMU)
+ * PRECOMPUTE_IMU_STILL: time in ms the IMU must stand still before it is recalibrated
+ * PRECOMPUTE_IMU_DRIFT: largest change of the IMU rotation in degrees over that time that still counts as standing still
+ */
+#define PRECOMPUTE_IMU_STILL 1000
+#define PRECOMPUTE_IMU_DRIFT 0.2
+/**
+ * Jobs, run in this order (a job queued while a later one runs cancels it; the later one starts over after it)
+ * PRECOMPUTE_PREPARE: prepare the selected routine unless it is prepared (refer to prepareAuton), once
+ *   BOOT_TRAJECTORIES is ready; queues PRECOMPUTE_WARM (one step, the longest: a trajectory that is not baked is generated)
+ * PRECOMPUTE_WARM: read the prepared trajectories through, a trajectory per step, so the first cycles of
+ *   autonomous find their segments in the cache
+ * PRECOMPUTE_IMU: recalibrate the IMU once it has stood still for PRECOMPUTE_IMU_STILL (its bias drifts over a long
+ *   wait), after BOOT_CALIBRATION; the odometry uses the encoders meanwhile (refer to recalibrateImu)
+ */
+enum PrecomputeJob{
+  PRECOMPUTE_PREPARE,
+  PRECOMPUTE_WARM,
+  PRECOMPUTE_IMU,
+  PRECOMPUTE_JOBS
+};
+/**
+ * refer to precompute.cpp for function documentation
+ */
+void queuePrecompute(PrecomputeJob job);
+bool isPrecomputeQueued(PrecomputeJob job);
+void waitPrecompute();
+void precompute(void * ignore);
+
+#endif
@@ -0,0 +1,88 @@
+/**
+ * Header file for purePursuit.cpp
+ * Defines the pure-pursuit path follower that drives the base along a list of
+ * waypoints (or a spline path) without stopping, using the live pose from the odometry task, and the path triggers:
+ * callbacks fired by the control task when the robot passes a distance along the path or enters
+ * a region, so mechanisms act on the move instead of after a stop
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_PURE_PURSUIT_HPP_
+#define _8059_MOTION_PROFILE_LIB_PURE_PURSUIT_HPP_
+#include "8059MotionProfileLib/include/baseOdometry.hpp"
+#include "8059MotionProfileLib/include/inlineFunction.hpp"
+// Maximum number of waypoints of a path
+#define MAX_PURSUIT_POINTS 64
+// Maximum number of triggers of a path
+#define MAX_PATH_TRIGGERS 16
+/**
+ * Most path segments the closest point and the lookahead searches examine per control cycle
+ * (each search resumes from where it stopped), so a tick costs the same on any path length
+ */
+#define PURSUIT_SEARCH_WINDOW 8
+/**
+ * Default pure-pursuit parameters (inches, seconds)
+ * PURSUIT_LOOKAHEAD: distance from the robot to the point it steers towards (default of PARAM_PURSUIT_LOOKAHEAD)
+ * PURSUIT_MAX_VEL: maximum forward velocity
+ * PURSUIT_MAX_DECEL: deceleration used to slow down towards the end of the path
+ * PURSUIT_MAX_LAT_ACC: lateral acceleration limit, slows the robot in sharp curves
+ * PURSUIT_END_LEEWAY: distance from the last waypoint at which the path is finished
+ */
+#define PURSUIT_LOOKAHEAD 12
+#define PURSUIT_MAX_VEL 30
+#define PURSUIT_MAX_DECEL 40
+#define PURSUIT_MAX_LAT_ACC 60
+#define PURSUIT_END_LEEWAY 1
+/**
+ * Projection of the robot on a spline path (refer to setPursuitSpline)
+ * SPLINE_PROJECTION_STEPS: Newton steps per control cycle
+ * SPLINE_PROJECTION_MAX_STEP: largest step of the parameter per Newton step (a fraction of a segment)
+ */
+#define SPLINE_PROJECTION_STEPS 2
+#define SPLINE_PROJECTION_MAX_STEP 0.25
+struct SplinePath;
+/** A waypoint of a path in field coordinates (inches) */
+struct PursuitPoint{
+  double x, y;
+};
+/** Conditions of a path trigger */
+enum PathTriggerType{
+  PATH_TRIGGER_DISTANCE,  // the robot has travelled `distance` inches along the path
+  PATH_TRIGGER_REGION     // the robot is within `radius` of (x, y)
+};
+/**
+ * A path trigger: callback is called once by the control task, so it must return at once
+ * (e.g. cycle, or [power]{intakeMove(power);}: refer to inlineFunction.hpp). The triggers of a path fire in path order: a region the robot misses
+ * fires once the robot is `radius` past the point of the path closest to it, and every trigger left
+ * fires at the end of the path.
+ * order: position along the path (inches) the triggers are sorted by (set by setPursuitPath)
+ */
+struct PathTrigger{
+  PathTriggerType type;
+  double distance, x, y, radius;
+  InlineFunction<void()> callback;
+  double order;
+};
+/**
+ * refer to purePursuit.cpp for function documentation
+ */
+PathTrigger atPathDistance(double distance, InlineFunction<void()> callback);
+PathTrigger inPathRegion(double x, double y, double radius, InlineFunction<void()> callback);
+bool setPursuitPath(const PursuitPoint *points, int count, double lookahead, double maxVel, bool reverse,
+  const PathTrigger *triggers = NULL, int triggerCount = 0);
+bool setPursuitSpline(const SplinePath *path, double lookahead, double maxVel, bool reverse,
+  const PathTrigger *triggers = NULL, int triggerCount = 0);
+void startPursuitPath(double lookahead, double maxVel, bool reverse, const PathTrigger *triggers, int triggerCount);
+bool replacePursuitPath(const PursuitPoint *points, int count);
+double getPathProgress();
+double getPathRemaining();
+bool isPursuitActive();
+int getPursuitPath(PursuitPoint *points, uint32_t &version);
+void stopPursuit();
+void findLookahead(const PoseSnapshot &pose, PursuitPoint &target);
+bool computePurePursuit(const PoseSnapshot &pose, double &velL, double &velR, double &velS);
+void basePursuit(const PursuitPoint *points, int count, double lookahead, double maxVel, bool reverse);
+void basePursuit(const PursuitPoint *points, int count, bool reverse = false);
+void basePursuit(const PursuitPoint *points, int count, const PathTrigger *triggers, int triggerCount, bool reverse = false);
+void baseSplinePursuit(const SplinePath *path, double lookahead, double maxVel, bool reverse);
+void baseSplinePursuit(const SplinePath *path, bool reverse = false);
+
+#endif
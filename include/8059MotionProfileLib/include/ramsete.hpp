@@ -0,0 +1,23 @@
+/**
+ * Header file for ramsete.cpp
+ * Defines the RAMSETE tracking controller: the base follows the poses of a time-parameterized
+ * trajectory (refer to trajectoryCache.hpp) on the live pose from the odometry task, so it recovers
+ * from a push or a slip instead of replaying the side profiles open-loop
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_RAMSETE_HPP_
+#define _8059_MOTION_PROFILE_LIB_RAMSETE_HPP_
+#include "8059MotionProfileLib/include/baseOdometry.hpp"
+/**
+ * RAMSETE gains (inches, radians, seconds)
+ * RAMSETE_B: aggressiveness, rad^2/in^2 (2 rad^2/m^2, the usual value, is 0.0013)
+ * RAMSETE_ZETA: damping ratio, between 0 and 1
+ */
+#define RAMSETE_B 0.0013
+#define RAMSETE_ZETA 0.7
+/**
+ * refer to ramsete.cpp for function documentation
+ */
+void computeRamsete(const PoseSnapshot &pose, double refX, double refY, double refAngle, double refLinVel, double refAngVel,
+                    double &velL, double &velR);
+
+#endif
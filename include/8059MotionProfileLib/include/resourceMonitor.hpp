@@ -0,0 +1,39 @@
+/**
+ * Header file for resourceMonitor.cpp
+ * Defines the resource monitor task that samples the stack high-water marks of the tasks
+ * and the heap usage (user heap and kernel heap), so stacks can be sized from data
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_RESOURCE_MONITOR_HPP_
+#define _8059_MOTION_PROFILE_LIB_RESOURCE_MONITOR_HPP_
+#include "8059MotionProfileLib/include/taskConfig.hpp"
+#include "8059MotionProfileLib/include/taskTiming.hpp"
+#include <cstdint>
+// Size of the user heap in bytes (_HEAP_SIZE in firmware/v5-common.ld)
+#define MONITOR_HEAP_SIZE 0x02E00000
+/**
+ * Stack usage of a monitored task (the tasks of taskTiming.hpp)
+ * depth: stack size in bytes
+ * minFree: least free stack since the task started, in bytes (FreeRTOS high-water mark)
+ */
+struct StackUsage{
+  uint32_t depth, minFree;
+};
+/**
+ * Heap usage in bytes
+ * free: currently free (user heap: MONITOR_HEAP_SIZE minus the allocated bytes)
+ * minFree: least free heap (user heap: seen by the monitor; kernel heap: since boot)
+ */
+struct HeapUsage{
+  uint32_t free, minFree;
+};
+/**
+ * refer to resourceMonitor.cpp for function documentation
+ */
+void watchTaskStack(TimedTask task, pros::task_t handle, uint32_t stackDepth);
+StackUsage getStackUsage(TimedTask task);
+int findWatchedTask(pros::task_t handle);
+HeapUsage getHeapUsage();
+HeapUsage getKernelHeapUsage();
+void resourceMonitor(void * ignore);
+
+#endif
@@ -0,0 +1,99 @@
+/**
+ * Header file for the robot configuration
+ * Defines the geometry, base power limits and ports of every robot built from this code as
+ * constexpr members of RobotConfig; ROBOT selects the robot of a build, and the library reads the
+ * constants at the end of this file, so every build is folded for its robot at compile time
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_ROBOT_CONFIG_HPP_
+#define _8059_MOTION_PROFILE_LIB_ROBOT_CONFIG_HPP_
+#include <cstdint>
+/**
+ * Robots; ROBOT selects the robot of the build (e.g. -DROBOT=1 in EXTRA_CXXFLAGS)
+ */
+#define ROBOT_PRIMARY 0
+#define ROBOT_SECONDARY 1
+#ifndef ROBOT
+#define ROBOT ROBOT_PRIMARY
+#endif
+template<int robot> struct RobotConfig;
+/**
+ * The primary robot
+ * baseWidth: distance between the tracking wheels (inches)
+ * inPerDeg: tracking wheel travel per encoder degree (inches)
+ * perpOffset: distance of the perpendicular wheel behind the tracking centre (inches; negative if in front)
+ * frontOffset, backOffset: distance from the tracking centre to the front and to the back bumper (inches)
+ * ultrasonicForward, ultrasonicLateral: position of the ultrasonic sensor ahead of and to the right of the
+ *   tracking centre (inches); ultrasonicAngle: bearing of its beam from the robot's heading (degrees, clockwise)
+ * holonomic: the base is an X-drive (wheels at 45 degrees, refer to chassisModel.hpp) that strafes, instead of a
+ *   tank drive; needs the perpendicular tracking wheel (ODOM_THREE_WHEEL) to measure the strafe
+ * maxPow: maximum base power allowed
+ * rampingPow: maximum base power increment every control cycle (|V - V previous| <= rampingPow)
+ * Ports: smart ports of the motors & the IMU, ADI ports of the sensors (an encoder also uses port + 1)
+ */
+template<> struct RobotConfig<ROBOT_PRIMARY>{
+  //Tuning: turn at least 2 rotations and compare results in program & real life
+  static constexpr double baseWidth = 10.83798252962012;
+  //Tuning: go straight and compare results in program & real life
+  static constexpr double inPerDeg = 0.0241043549920626;
+  //Tuning: turn at least 2 rotations in place; the x & y of the robot should not change
+  static constexpr double perpOffset = 4.5;
+  static constexpr double frontOffset = 9, backOffset = 9;
+  static constexpr double ultrasonicForward = 0, ultrasonicLateral = -7, ultrasonicAngle = -90;
+  static constexpr bool holonomic = false;
+  static constexpr int maxPow = 100;
+  static constexpr int rampingPow = 8;
+  // base ports
+  static constexpr uint8_t FLPort = 11, BLPort = 12, FRPort = 19, BRPort = 18;
+  // mech ports
+  static constexpr uint8_t rRollerPort = 16, lRollerPort = 15, indexerPort = 6, shooterPort = 5;
+  // sensor ports
+  static constexpr uint8_t encdL_port = 1, encdR_port = 3, encdS_port = 7, limitPort = 5, colorPort = 6, imuPort = 10;
+  // ultrasonic ping port (echo on ultrasonicPort + 1; shares the perpendicular wheel's ports, refer to ODOM_USE_ULTRASONIC)
+  static constexpr uint8_t ultrasonicPort = 7;
+  static constexpr uint8_t visionPort = 8;
+};
+/**
+ * The secondary robot: the primary robot's configuration; override the members that differ
+ */
+template<> struct RobotConfig<ROBOT_SECONDARY> : RobotConfig<ROBOT_PRIMARY>{
+};
+/** configuration of this build */
+typedef RobotConfig<ROBOT> Robot;
+/**
+ * Check that a list of ports has no port twice.
+ * @return
+ * true if the ports are distinct
+ */
+constexpr bool distinctPorts(const uint8_t *ports, int count){
+  for(int i = 0; i < count; i++){
+    for(int j = i + 1; j < count; j++) if(ports[i] == ports[j]) return false;
+  }
+  return true;
+}
+constexpr uint8_t robotSmartPorts[] = {Robot::FLPort, Robot::BLPort, Robot::FRPort, Robot::BRPort, Robot::rRollerPort,
+  Robot::lRollerPort, Robot::indexerPort, Robot::shooterPort, Robot::imuPort, Robot::visionPort};
+static_assert(distinctPorts(robotSmartPorts, sizeof(robotSmartPorts)), "two devices on one smart port");
+static_assert(Robot::baseWidth > 0 && Robot::inPerDeg > 0, "the odometry geometry must be positive");
+static_assert(Robot::frontOffset > 0 && Robot::backOffset > 0, "the bumpers must be outside the tracking centre");
+static_assert(Robot::maxPow > 0 && Robot::maxPow <= 127 && Robot::rampingPow > 0, "base powers are 1 to 127");
+/**
+ * Constants of the build's robot, under the names the library uses
+ */
+constexpr double baseWidth = Robot::baseWidth;
+constexpr double inPerDeg = Robot::inPerDeg;
+constexpr double perpOffset = Robot::perpOffset;
+constexpr double frontOffset = Robot::frontOffset, backOffset = Robot::backOffset;
+constexpr double ultrasonicForward = Robot::ultrasonicForward, ultrasonicLateral = Robot::ultrasonicLateral;
+constexpr double ultrasonicAngle = Robot::ultrasonicAngle;
+constexpr bool HOLONOMIC_BASE = Robot::holonomic;
+constexpr int MAX_POW = Robot::maxPow;
+constexpr int RAMPING_POW = Robot::rampingPow;
+constexpr uint8_t FLPort = Robot::FLPort, BLPort = Robot::BLPort, FRPort = Robot::FRPort, BRPort = Robot::BRPort;
+constexpr uint8_t rRollerPort = Robot::rRollerPort, lRollerPort = Robot::lRollerPort;
+constexpr uint8_t indexerPort = Robot::indexerPort, shooterPort = Robot::shooterPort;
+constexpr uint8_t encdL_port = Robot::encdL_port, encdR_port = Robot::encdR_port, encdS_port = Robot::encdS_port;
+constexpr uint8_t limitPort = Robot::limitPort, colorPort = Robot::colorPort, imuPort = Robot::imuPort;
+constexpr uint8_t visionPort = Robot::visionPort;
+constexpr uint8_t ultrasonicPort = Robot::ultrasonicPort;
+
+#endif
@@ -0,0 +1,53 @@
+/**
+ * Header file for routeOptimizer.cpp
+ * Defines the skills route: the goals of the skills run (poses where the robot scores) are visited in
+ * the order of a route file on the microSD card, each leg a cached trajectory, so a route change is a
+ * data update. The order is solved off the robot (`./bin/sim route <goals file>`): every leg is
+ * generated and timed as the cache would run it, and a branch-and-bound search finds the visit order
+ * with the shortest total time under that model
+ *
+ * Route and goals file format (ConfigFile, angles in degrees, field coordinates)
+ *   start <x> <y> <deg>    pose the run starts from (its odometry coordinates)
+ *   goal <x> <y> <deg>     a goal, reached facing the bearing; the route file lists them in visiting order
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_ROUTE_OPTIMIZER_HPP_
+#define _8059_MOTION_PROFILE_LIB_ROUTE_OPTIMIZER_HPP_
+#include <cstdint>
+// Route of the skills run (refer to auton_sets.cpp)
+#ifndef ROUTE_FILE_PATH
+#define ROUTE_FILE_PATH "/usd/route.txt"
+#endif
+/**
+ * ROUTE_MAX_GOALS: most goals of a route (a leg per goal in the trajectory cache, refer to MAX_TRAJECTORIES)
+ * ROUTE_LEG_TIMEOUT: longest wait in ms for a leg to settle
+ */
+#define ROUTE_MAX_GOALS 12
+#define ROUTE_LEG_TIMEOUT 5000
+/** A goal of the route (field coordinates: inches, bearing in radians) */
+struct RouteGoal{
+  double x, y, angle;
+};
+/**
+ * A skills route
+ * start: pose the run starts from
+ * goals, count: the goals in visiting order
+ */
+struct SkillsRoute{
+  RouteGoal start;
+  RouteGoal goals[ROUTE_MAX_GOALS];
+  int count;
+};
+/**
+ * refer to routeOptimizer.cpp for function documentation
+ */
+bool loadRoute(const char *path, SkillsRoute &route);
+bool saveRoute(const char *path, const SkillsRoute &route, double time);
+double timeRouteLeg(const RouteGoal &from, const RouteGoal &to);
+double solveRouteOrder(const double cost[][ROUTE_MAX_GOALS + 1], int count, int *order);
+double optimizeRoute(SkillsRoute &route, double &givenTime);
+bool prepareRoute();
+int getRouteLegs();
+const SkillsRoute *getPreparedRoute();
+bool runRoute();
+
+#endif
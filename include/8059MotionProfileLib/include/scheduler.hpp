@@ -0,0 +1,22 @@
+/**
+ * Header file for scheduler.cpp
+ * Defines the tick scheduler that links the odometry task to its consumers:
+ * odometry runs at a fixed rate (delay_until, slower while the base stands still) and
+ * notifies every subscribed task as soon as a new pose is published.
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_SCHEDULER_HPP_
+#define _8059_MOTION_PROFILE_LIB_SCHEDULER_HPP_
+#include "8059MotionProfileLib/include/taskConfig.hpp"
+#include <cstdint>
+// Maximum number of tasks that can subscribe to the odometry tick
+#define MAX_ODOM_SUBSCRIBERS 8
+/**
+ * refer to scheduler.cpp for function documentation
+ */
+bool subscribeOdometry(pros::task_t task, uint32_t divider);
+void unsubscribeOdometry(pros::task_t task);
+void notifyOdometrySubscribers(uint32_t ticks = 1);
+bool waitOdometry(uint32_t timeout);
+uint32_t getOdometryTick();
+
+#endif
@@ -0,0 +1,82 @@
+/**
+ * Header-only sequence lock (seqlock)
+ * Publishes a small trivially copyable value (e.g. a pose) from one writer task
+ * to any number of reader tasks:
+ * - the writer never waits (wait-free), so it can sit in a fixed-rate loop
+ * - readers never block the writer; they retry if a write overlapped their copy
+ * - every write bumps a version, so readers can tell whether the value is new
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_SEQLOCK_HPP_
+#define _8059_MOTION_PROFILE_LIB_SEQLOCK_HPP_
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+template <typename T>
+class SeqLock{
+  static_assert(std::is_trivially_copyable<T>::value, "SeqLock values must be trivially copyable");
+  /** number of 32-bit words needed to hold a T */
+  static const int WORDS = (sizeof(T) + 3) / 4;
+  /** odd while a write is in progress; incremented by 2 per write */
+  std::atomic<uint32_t> sequence;
+  /** the value is stored as atomic words so that overlapping reads are well defined */
+  std::atomic<uint32_t> words[WORDS];
+public:
+  SeqLock() : sequence(0){
+    for(int i = 0; i < WORDS; i++) words[i].store(0, std::memory_order_relaxed);
+  }
+  /**
+   * Initialize with a value.
+   * @param value
+   * initial value
+   */
+  explicit SeqLock(const T &value) : SeqLock(){
+    write(value);
+  }
+  /**
+   * Publish a new value. Only one task may write.
+   * @param value
+   * to-be-published value
+   */
+  void write(const T &value){
+    uint32_t buffer[WORDS] = {};
+    memcpy(buffer, &value, sizeof(T));
+    uint32_t seq = sequence.load(std::memory_order_relaxed);
+    sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for(int i = 0; i < WORDS; i++) words[i].store(buffer[i], std::memory_order_relaxed);
+    sequence.store(seq + 2, std::memory_order_release);
+  }
+  /**
+   * Read a consistent copy of the latest value.
+   * @param version (optional)
+   * set to the version of the copy that was returned
+   *
+   * @return
+   * latest published value
+   */
+  T read(uint32_t *version = NULL) const{
+    uint32_t buffer[WORDS];
+    uint32_t seqBefore, seqAfter;
+    do{
+      seqBefore = sequence.load(std::memory_order_acquire);
+      for(int i = 0; i < WORDS; i++) buffer[i] = words[i].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      seqAfter = sequence.load(std::memory_order_relaxed);
+    }while((seqBefore & 1) || seqBefore != seqAfter);
+    if(version != NULL) *version = seqBefore / 2;
+    T value;
+    memcpy(&value, buffer, sizeof(T));
+    return value;
+  }
+  /**
+   * @return
+   * number of completed writes
+   */
+  uint32_t version() const{
+    return sequence.load(std::memory_order_acquire) / 2;
+  }
+};
+
+#endif
@@ -0,0 +1,82 @@
+/**
+ * Header file for serialProtocol.cpp
+ * Defines the framed binary protocol used to stream telemetry records to a computer,
+ * and the varint delta coding it shares with the flight recorder
+ *
+ * Frame: COBS(payload + CRC) followed by a 0x00 delimiter
+ * payload (TELEMETRY_FRAMED): type (1 byte), timestamp (uint32, micros), values packed per type
+ *   TELEMETRY_POSE: x, y (int16, 0.01 in), angle (int16, 0.01 degree, -180 to 180)
+ *   TELEMETRY_ERROR: errorEncdL, errorEncdR (int16, 0.1 encoder degree)
+ *   TELEMETRY_POWER: powerL, powerR (int16, 0.01 power)
+ *   TELEMETRY_ENCODERS: encdL, encdR (int32, encoder degrees)
+ *   TELEMETRY_TIMING: task (1 byte), overruns, p99 & max execution time, p99 & max lateness (uint32, micros)
+ *   TELEMETRY_STACK: task (1 byte), least free stack, stack size (uint32, bytes)
+ *   TELEMETRY_HEAP: free heap, least free heap (uint32, bytes)
+ *   TELEMETRY_DEADLINE: task (1 byte), new & total deadline misses, latest finish past a deadline (uint32, micros)
+ *   TELEMETRY_JAM: motor port (1 byte), current (int16, mA), velocity (int16, rpm)
+ *   TELEMETRY_SLIP: slipL, slipR (int16, 0.01 in/s), failed tracking wheels, odometry source (1 byte each)
+ *   TELEMETRY_DISPLAY: display footprint, free kernel heap, least free kernel heap (uint32, bytes)
+ *   TELEMETRY_ARENA: persistent bytes, peak bytes, failed allocations (uint32)
+ *   TELEMETRY_MOTOR: motor port (1 byte), temperature (int16, C), current (int16, mA), power fraction (int16, 0.001)
+ *   TELEMETRY_LATENCY: motor port, steps (1 byte each), median, P90 & max velocity latency, median encoder latency (uint32, micros)
+ *   TELEMETRY_STOP: settle time (uint32, ms), side velocity (int16, 0.01 in/s), brake pulse (int16, ms)
+ *   TELEMETRY_WATCHDOG: task, fault (1 byte each), time since its last iteration (uint32, ms), deadline misses (int16),
+ *   base stopped (1 byte)
+ *   TELEMETRY_LOAD: task (1 byte), CPU share, summed share of the instrumented tasks (int16, 0.01 percent)
+ *   TELEMETRY_BOOT: BootMark (1 byte), time since the program start, time since the previous instant (uint32, micros)
+ *   TELEMETRY_CYCLE: cycle time (uint32, ms), shots (1 byte), mean intake to shot, indexing, spin-up & stalled time (uint32, ms)
+ *   TELEMETRY_STREAM: chunks read, underruns, failed reads, slowest read (uint32, micros)
+ *   TELEMETRY_BATTERY: open-circuit voltage (int16, mV), resistance (int16, milliohms), mean voltage, mean current (int16, mV & mA)
+ * payload (TELEMETRY_DELTA): type (1 byte, TELEMETRY_KEYFRAME set on a keyframe), then the timestamp and
+ *   the values above as integers, each coded as the zig-zag varint of its difference from the previous
+ *   record of the same type (from 0 in a keyframe); a reader starts each type at its first keyframe,
+ *   and again after a frame that fails its CRC
+ * CRC: CRC-16/CCITT-FALSE (polynomial 0x1021, initial 0xFFFF) of the payload, little endian
+ * All multi-byte values are little endian.
+ * Varint: 7 bits per byte, least significant first, the high bit set on every byte but the last;
+ * zig-zag: 2x for x >= 0, -2x - 1 for x < 0 (small steps either way stay short)
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_SERIAL_PROTOCOL_HPP_
+#define _8059_MOTION_PROFILE_LIB_SERIAL_PROTOCOL_HPP_
+#include "8059MotionProfileLib/include/telemetry.hpp"
+#include <cstdint>
+// Maximum bytes of count values coded by deltaEncode (a 64-bit varint takes up to 10 bytes)
+#define DELTA_MAX_BYTES(count) ((count)*10)
+// Maximum payload size (type + timestamp + 6 int32 values)
+#define TELEMETRY_MAX_PAYLOAD 29
+// Maximum delta payload size (type + 7 varints of differences of 32-bit values, 5 bytes each)
+#define TELEMETRY_MAX_DELTA_PAYLOAD 36
+// Maximum frame size: payload + CRC, COBS overhead and the delimiter
+#define TELEMETRY_MAX_FRAME (TELEMETRY_MAX_DELTA_PAYLOAD + 2 + 2 + 1)
+/**
+ * Delta frames (TELEMETRY_DELTA)
+ * TELEMETRY_KEYFRAME: flag of the type byte of a keyframe
+ * TELEMETRY_KEYFRAME_INTERVAL: every this many records of a type, one is a keyframe
+ */
+#define TELEMETRY_KEYFRAME 0x80
+#define TELEMETRY_KEYFRAME_INTERVAL 50
+/**
+ * Where the frames are written
+ * 0: the USB serial link (stdout, with the PROS stream multiplexing turned off)
+ * 1-21: a smart port in generic serial mode at TELEMETRY_BAUDRATE
+ */
+#define TELEMETRY_SERIAL_PORT 0
+#define TELEMETRY_BAUDRATE 115200
+/**
+ * refer to serialProtocol.cpp for function documentation
+ */
+uint16_t crc16(const uint8_t *data, int length);
+int cobsEncode(const uint8_t *data, int length, uint8_t *out);
+int cobsDecode(uint8_t *data, int length);
+int putVarint(uint8_t *buffer, int index, uint64_t x);
+int getVarint(const uint8_t *buffer, int length, int index, uint64_t &x);
+int deltaEncode(const uint64_t *values, uint64_t *prev, int count, uint8_t *out);
+int deltaDecode(const uint8_t *data, int length, uint64_t *prev, int count);
+int quantizeTelemetry(const TelemetryRecord &record, int64_t *fields, uint8_t *widths);
+int packTelemetry(const TelemetryRecord &record, uint8_t *payload);
+int packTelemetryDelta(const TelemetryRecord &record, uint8_t *payload);
+int frameTelemetry(const TelemetryRecord &record, uint8_t *frame);
+void initTelemetrySerial();
+void writeTelemetryFrame(const TelemetryRecord &record);
+
+#endif
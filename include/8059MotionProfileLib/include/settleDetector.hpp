@@ -0,0 +1,53 @@
+/**
+ * Header file for settleDetector.cpp
+ * Defines class SettleDetector that decides when a movement has settled at its target
+ * (modelled on okapi's SettledUtil: error, derivative and time in band)
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_SETTLE_DETECTOR_HPP_
+#define _8059_MOTION_PROFILE_LIB_SETTLE_DETECTOR_HPP_
+#include <cstdint>
+/**
+ * Default settle rule
+ * SETTLE_ERROR: maximum distance (inches) of both sides from their targets
+ * SETTLE_DERIVATIVE: maximum rate of change of that distance (inches per second)
+ * SETTLE_TIME: time (ms) the two conditions above must hold for
+ * SETTLE_TIMEOUT: a queued motion is given up after this time (ms)
+ */
+#define SETTLE_ERROR 0.5
+#define SETTLE_DERIVATIVE 2
+#define SETTLE_TIME 60
+#define SETTLE_TIMEOUT 3000
+#define DEFAULT_SETTLE_RULE {SETTLE_ERROR, SETTLE_DERIVATIVE, SETTLE_TIME, SETTLE_TIMEOUT}
+/**
+ * Settle rule of a movement
+ * error, derivative, time: refer to SETTLE_ERROR, SETTLE_DERIVATIVE, SETTLE_TIME
+ * timeout: maximum duration of a queued motion (ms); not used by SettleDetector
+ */
+struct SettleRule{
+  double error, derivative;
+  uint32_t time, timeout;
+};
+/**
+ * The class SettleDetector is fed the error of every control cycle
+ * and reports settled once the error and its derivative have stayed in band for long enough.
+ */
+class SettleDetector{
+public:
+  /**
+   * refer to settleDetector.cpp for function documentation
+   */
+  SettleDetector();
+  void setRule(const SettleRule &rule);
+  bool isSettled(double error, uint64_t now);
+  void reset();
+private:
+  SettleRule rule;
+  /** error & time (micros) of the previous sample, for the derivative */
+  double prevError;
+  uint64_t prevTime;
+  bool hasPrev;
+  /** time (micros) the error entered the band, 0 when outside */
+  uint64_t inBandSince;
+};
+
+#endif
@@ -0,0 +1,44 @@
+/**
+ * Header file for splinePath.cpp
+ * Defines the spline path: cubic Hermite segments through waypoints, with an arc-length table
+ * built once (buildSplinePath, at initialization), so a "point at distance s" query during the
+ * match is a binary search and a polynomial evaluation instead of a numerical integration.
+ * The pure-pursuit follower can follow a spline path directly (refer to setPursuitSpline).
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_SPLINE_PATH_HPP_
+#define _8059_MOTION_PROFILE_LIB_SPLINE_PATH_HPP_
+#include "8059MotionProfileLib/include/purePursuit.hpp"
+#include "8059MotionProfileLib/include/trajectoryCache.hpp"
+// Maximum number of waypoints of a spline path
+#define MAX_SPLINE_POINTS 16
+// Arc-length samples per spline segment
+#define SPLINE_TABLE_RESOLUTION 16
+#define SPLINE_TABLE_SIZE ((MAX_SPLINE_POINTS - 1)*SPLINE_TABLE_RESOLUTION + 1)
+/** A cubic segment: p(t) = a*t^3 + b*t^2 + c*t + d for t in [0, 1], per axis */
+struct SplineSegment{
+  double ax, bx, cx, dx;
+  double ay, by, cy, dy;
+};
+/**
+ * A spline path in field coordinates (inches)
+ * count: number of segments; the parameter u runs from 0 to count (segment floor(u), t = u - floor(u))
+ * arcLength: distance along the path at u = k/SPLINE_TABLE_RESOLUTION
+ * length: total length
+ */
+struct SplinePath{
+  SplineSegment segments[MAX_SPLINE_POINTS - 1];
+  int count;
+  double arcLength[SPLINE_TABLE_SIZE];
+  double length;
+};
+/**
+ * refer to splinePath.cpp for function documentation
+ */
+bool buildSplinePath(SplinePath &path, const Waypoint *points, int count);
+PursuitPoint splinePoint(const SplinePath &path, double u);
+PursuitPoint splineTangent(const SplinePath &path, double u);
+double splineDistanceAt(const SplinePath &path, double u);
+double splineParameterAt(const SplinePath &path, double distance);
+PursuitPoint splinePointAtDistance(const SplinePath &path, double distance);
+
+#endif
@@ -0,0 +1,47 @@
+/**
+ * Header file for stallDetector.cpp
+ * Defines class StallDetector that spots a jammed motor: driven, drawing high current, but not turning
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_STALL_DETECTOR_HPP_
+#define _8059_MOTION_PROFILE_LIB_STALL_DETECTOR_HPP_
+#include <cstdint>
+/**
+ * Default stall rule
+ * STALL_POWER: least commanded power (sign ignored) for a stall to count
+ * STALL_CURRENT: least current draw in mA (the V5 motor limit is 2500)
+ * STALL_VELOCITY: largest velocity in rpm (sign ignored)
+ * STALL_TIME: time in ms the three conditions above must hold for
+ */
+#define STALL_POWER 30
+#define STALL_CURRENT 2000
+#define STALL_VELOCITY 10
+#define STALL_TIME 100
+#define DEFAULT_STALL_RULE {STALL_POWER, STALL_CURRENT, STALL_VELOCITY, STALL_TIME}
+/**
+ * Stall rule of a motor
+ * power, current, velocity, time: refer to STALL_POWER, STALL_CURRENT, STALL_VELOCITY, STALL_TIME
+ */
+struct StallRule{
+  double power, current, velocity;
+  uint32_t time;
+};
+/**
+ * The class StallDetector is fed the command and the readings of a motor every tick
+ * and reports a stall once they have stayed in the stall band for long enough.
+ */
+class StallDetector{
+public:
+  /**
+   * refer to stallDetector.cpp for function documentation
+   */
+  StallDetector();
+  void setRule(const StallRule &rule);
+  bool isStalled(double power, double current, double velocity, uint64_t now);
+  void reset();
+private:
+  StallRule rule;
+  /** time (micros) the motor entered the stall band, 0 when outside */
+  uint64_t stalledSince;
+};
+
+#endif
@@ -0,0 +1,215 @@
+/**
+ * Header file for staticRoutine.cpp
+ * Defines static routines: an autonomous routine declared in auton_sets.cpp as a constexpr array of steps (the
+ * commands of the autonomous scripts, refer to autonScript.hpp), checked by the compiler and kept as read-only data,
+ * so autonomous() runs the first step at once (nothing is parsed, built or allocated):
+ * - units: lengths, angles and times are quantities (refer to units.hpp), so stepMove(90_deg) fails to compile
+ * - field: every absolute target lies inside the field, and the targets the robot drives to ROUTINE_WALL_MARGIN
+ *   from the walls (relative motions depend on the pose and are not checked)
+ * - values: powers, counts, sides, colors and times within range, a name for every trajectory
+ * - order: a deadline or optional mark is followed by a motion, a wait for the queue follows a motion
+ * E.g. in auton_sets.cpp (with `using namespace okapi::literals;`):
+ *   constexpr RoutineStep blueLeftSteps[] = {
+ *     stepIntake(127), stepMoveTo(24_in, 48_in), stepTurn(90_deg), stepWaitQueue(2_s), stepCycle()
+ *   };
+ *   CHECK_ROUTINE(blueLeftSteps);
+ *   void blueLeft(){
+ *     runStaticRoutine(blueLeftSteps);
+ *   }
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_STATIC_ROUTINE_HPP_
+#define _8059_MOTION_PROFILE_LIB_STATIC_ROUTINE_HPP_
+#include "8059MotionProfileLib/include/autonScript.hpp"
+#include "8059MotionProfileLib/include/units.hpp"
+#include "8059MotionProfileLib/include/dashboard.hpp"
+#include "mech_lib.hpp"
+/**
+ * Field of the checks
+ * ROUTINE_FIELD_MIN_X, ROUTINE_FIELD_MAX_X, ROUTINE_FIELD_MIN_Y, ROUTINE_FIELD_MAX_Y: walls in inches (odometry coordinates)
+ * ROUTINE_WALL_MARGIN: closest the robot's centre gets to a wall in inches (half its narrowest side, less a margin
+ *   for driving against the wall)
+ */
+#define ROUTINE_FIELD_MIN_X (-DASHBOARD_ORIGIN_X)
+#define ROUTINE_FIELD_MAX_X (DASHBOARD_FIELD_SIZE - DASHBOARD_ORIGIN_X)
+#define ROUTINE_FIELD_MIN_Y (-DASHBOARD_ORIGIN_Y)
+#define ROUTINE_FIELD_MAX_Y (DASHBOARD_FIELD_SIZE - DASHBOARD_ORIGIN_Y)
+#define ROUTINE_WALL_MARGIN 6
+/**
+ * A step of a static routine: a script command (refer to autonScript.hpp) with its operands decoded
+ * op: the command (never SCRIPT_END)
+ * a, b, c: its lengths (inches), angles (degrees) and times (ms), in the order of the script command
+ * option: its reverse flag, side (BaseSide), color (BallColor), power or ball count
+ * name: trajectory of SCRIPT_FOLLOW
+ */
+struct RoutineStep{
+  ScriptOp op;
+  double a, b, c;
+  int option;
+  const char *name;
+};
+/**
+ * Steps, one per script command (the same operands, as quantities)
+ */
+constexpr RoutineStep stepMove(okapi::QLength dis){
+  return {SCRIPT_MOVE, toInches(dis), 0, 0, 0, NULL};
+}
+constexpr RoutineStep stepMoveTo(okapi::QLength x, okapi::QLength y){
+  return {SCRIPT_MOVE_TO, toInches(x), toInches(y), 0, 0, NULL};
+}
+constexpr RoutineStep stepTurn(okapi::QAngle angle){
+  return {SCRIPT_TURN, toDegrees(angle), 0, 0, 0, NULL};
+}
+constexpr RoutineStep stepTurnTo(okapi::QLength x, okapi::QLength y, bool reverse = false){
+  return {SCRIPT_TURN_TO, toInches(x), toInches(y), 0, reverse, NULL};
+}
+constexpr RoutineStep stepTurnBy(okapi::QAngle angle){
+  return {SCRIPT_TURN_RELATIVE, toDegrees(angle), 0, 0, 0, NULL};
+}
+constexpr RoutineStep stepArc(okapi::QLength radius, okapi::QAngle angle){
+  return {SCRIPT_ARC, toInches(radius), toDegrees(angle), 0, 0, NULL};
+}
+constexpr RoutineStep stepArcTo(okapi::QLength x, okapi::QLength y){
+  return {SCRIPT_ARC_TO, toInches(x), toInches(y), 0, 0, NULL};
+}
+constexpr RoutineStep stepSwing(okapi::QAngle angle, BaseSide pivot){
+  return {SCRIPT_SWING, toDegrees(angle), 0, 0, pivot, NULL};
+}
+constexpr RoutineStep stepMovePose(okapi::QLength x, okapi::QLength y, okapi::QAngle angle, bool reverse = false){
+  return {SCRIPT_MOVE_TO_POSE, toInches(x), toInches(y), toDegrees(angle), reverse, NULL};
+}
+constexpr RoutineStep stepExit(okapi::QLength distance, okapi::QTime time){
+  return {SCRIPT_EARLY_EXIT, toInches(distance), toMilliseconds(time), 0, 0, NULL};
+}
+constexpr RoutineStep stepBy(okapi::QTime matchTime){
+  return {SCRIPT_DEADLINE, toMilliseconds(matchTime), 0, 0, 0, NULL};
+}
+constexpr RoutineStep stepOptional(okapi::QTime estimate){
+  return {SCRIPT_OPTIONAL, toMilliseconds(estimate), 0, 0, 0, NULL};
+}
+constexpr RoutineStep stepFollow(const char *trajectory){
+  return {SCRIPT_FOLLOW, 0, 0, 0, 0, trajectory};
+}
+constexpr RoutineStep stepIntake(int power){
+  return {SCRIPT_INTAKE, 0, 0, 0, power, NULL};
+}
+constexpr RoutineStep stepCycle(){
+  return {SCRIPT_CYCLE, 0, 0, 0, 0, NULL};
+}
+constexpr RoutineStep stepSort(BallColor color){
+  return {SCRIPT_SORT, 0, 0, 0, color, NULL};
+}
+constexpr RoutineStep stepWaitQueue(okapi::QTime timeout){
+  return {SCRIPT_WAIT_QUEUE, toMilliseconds(timeout), 0, 0, 0, NULL};
+}
+constexpr RoutineStep stepWaitBalls(int count, okapi::QTime timeout){
+  return {SCRIPT_WAIT_BALLS, toMilliseconds(timeout), 0, 0, count, NULL};
+}
+constexpr RoutineStep stepWaitShooter(okapi::QTime timeout){
+  return {SCRIPT_WAIT_SHOOTER, toMilliseconds(timeout), 0, 0, 0, NULL};
+}
+constexpr RoutineStep stepDelay(okapi::QTime time){
+  return {SCRIPT_DELAY, toMilliseconds(time), 0, 0, 0, NULL};
+}
+/** Faults of a static routine (refer to routineFault) */
+enum RoutineFault{
+  ROUTINE_VALID,
+  ROUTINE_OUTSIDE_FIELD,  // a target is outside the field, or a drive target within ROUTINE_WALL_MARGIN of a wall
+  ROUTINE_BAD_VALUE,      // a power, count, side, color or time is out of range, or a trajectory has no name
+  ROUTINE_DANGLING_MARK,  // a deadline or optional mark is not followed by a motion
+  ROUTINE_IDLE_WAIT       // a wait for the queue has no motion since the start or the previous one
+};
+/**
+ * @param step
+ * a step
+ *
+ * @return
+ * whether it queues a motion
+ */
+constexpr bool isRoutineMotion(const RoutineStep &step){
+  return (step.op >= SCRIPT_MOVE && step.op <= SCRIPT_MOVE_TO_POSE) || step.op == SCRIPT_FOLLOW;
+}
+/**
+ * @param x, y
+ * a point in inches
+ *
+ * @param margin
+ * its distance from the walls in inches
+ *
+ * @return
+ * whether it is inside the field, at least margin from the walls
+ */
+constexpr bool inRoutineField(double x, double y, double margin){
+  return x >= ROUTINE_FIELD_MIN_X + margin && x <= ROUTINE_FIELD_MAX_X - margin
+    && y >= ROUTINE_FIELD_MIN_Y + margin && y <= ROUTINE_FIELD_MAX_Y - margin;
+}
+/**
+ * @param step
+ * a step
+ *
+ * @return
+ * whether its own operands are valid (ROUTINE_VALID, ROUTINE_OUTSIDE_FIELD or ROUTINE_BAD_VALUE)
+ */
+constexpr RoutineFault stepFault(const RoutineStep &step){
+  switch(step.op){
+    case SCRIPT_MOVE_TO: case SCRIPT_ARC_TO: case SCRIPT_MOVE_TO_POSE:
+      return inRoutineField(step.a, step.b, ROUTINE_WALL_MARGIN)? ROUTINE_VALID : ROUTINE_OUTSIDE_FIELD;
+    case SCRIPT_TURN_TO: return inRoutineField(step.a, step.b, 0)? ROUTINE_VALID : ROUTINE_OUTSIDE_FIELD;
+    case SCRIPT_SWING: return step.option == BASE_SIDE_LEFT || step.option == BASE_SIDE_RIGHT? ROUTINE_VALID : ROUTINE_BAD_VALUE;
+    case SCRIPT_EARLY_EXIT: return step.a >= 0 && step.b >= 0? ROUTINE_VALID : ROUTINE_BAD_VALUE;
+    case SCRIPT_FOLLOW: return step.name != NULL? ROUTINE_VALID : ROUTINE_BAD_VALUE;
+    case SCRIPT_INTAKE: return step.option >= -127 && step.option <= 127? ROUTINE_VALID : ROUTINE_BAD_VALUE;
+    case SCRIPT_SORT: return step.option >= BALL_NONE && step.option <= BALL_BLUE? ROUTINE_VALID : ROUTINE_BAD_VALUE;
+    case SCRIPT_WAIT_BALLS: return step.option >= 0 && step.a >= 0? ROUTINE_VALID : ROUTINE_BAD_VALUE;
+    case SCRIPT_DEADLINE: case SCRIPT_OPTIONAL: case SCRIPT_WAIT_QUEUE: case SCRIPT_WAIT_SHOOTER: case SCRIPT_DELAY:
+      return step.a >= 0? ROUTINE_VALID : ROUTINE_BAD_VALUE;
+    case SCRIPT_END: case SCRIPT_OPS: return ROUTINE_BAD_VALUE;
+    default: return ROUTINE_VALID;
+  }
+}
+/**
+ * Check a static routine (at compile time, refer to CHECK_ROUTINE).
+ * @param steps, count
+ * its steps
+ *
+ * @return
+ * its first fault, or ROUTINE_VALID
+ */
+constexpr RoutineFault routineFault(const RoutineStep *steps, int count){
+  bool marked = false, moved = false;
+  for(int i = 0; i < count; i++){
+    RoutineFault fault = stepFault(steps[i]);
+    if(fault != ROUTINE_VALID) return fault;
+    if(steps[i].op == SCRIPT_WAIT_QUEUE && !moved) return ROUTINE_IDLE_WAIT;
+    if(steps[i].op == SCRIPT_WAIT_QUEUE) moved = false;
+    if(steps[i].op == SCRIPT_DEADLINE || steps[i].op == SCRIPT_OPTIONAL) marked = true;
+    if(isRoutineMotion(steps[i])){
+      marked = false;
+      moved = true;
+    }
+  }
+  return marked? ROUTINE_DANGLING_MARK : ROUTINE_VALID;
+}
+template<int N> constexpr RoutineFault routineFault(const RoutineStep (&steps)[N]){
+  return routineFault(steps, N);
+}
+/**
+ * Fail the build on a fault of a static routine (after its constexpr array), naming the fault
+ */
+#define CHECK_ROUTINE(steps) \
+  static_assert(routineFault(steps) != ROUTINE_OUTSIDE_FIELD, #steps ": a target is outside the field or too close to a wall"); \
+  static_assert(routineFault(steps) != ROUTINE_BAD_VALUE, #steps ": a power, count, side, color or time is out of range, or a trajectory has no name"); \
+  static_assert(routineFault(steps) != ROUTINE_DANGLING_MARK, #steps ": a deadline or optional mark is not followed by a motion"); \
+  static_assert(routineFault(steps) != ROUTINE_IDLE_WAIT, #steps ": a wait for the queue has no motion to wait for")
+/**
+ * refer to staticRoutine.cpp for function documentation
+ */
+void runRoutineStep(const RoutineStep &step);
+void resetRoutineProgress();
+void runIndexedStep(const RoutineStep &step, int index, int first);
+int getRoutineResumeStep();
+void runStaticRoutine(const RoutineStep *steps, int count);
+template<int N> void runStaticRoutine(const RoutineStep (&steps)[N]){
+  runStaticRoutine(steps, N);
+}
+
+#endif
@@ -0,0 +1,80 @@
+/**
+ * Header file for the task layout: the priority and the period of every task, in one place
+ * (the tasks are created by taskRegistry.cpp)
+ * Priorities follow what each task feeds: sensing > control > mechanisms > logging > telemetry > brain screen,
+ * so a slow lower priority loop (a shooter wait, a telemetry write) never delays the odometry.
+ * The competition tasks (opcontrol, autonomous) run at TASK_PRIORITY_DEFAULT, between control
+ * and mechanisms. A task misses its deadline when an iteration ends more than its period after
+ * its scheduled wake-up (refer to taskTiming.hpp).
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_TASK_CONFIG_HPP_
+#define _8059_MOTION_PROFILE_LIB_TASK_CONFIG_HPP_
+#include "api.h"
+/**
+ * Priorities (TASK_PRIORITY_MIN 1 to TASK_PRIORITY_MAX 16)
+ */
+// watchdog: above the tasks it watches, so a task stuck in a loop cannot starve it (it only reads counters)
+#define PRIORITY_WATCHDOG (TASK_PRIORITY_DEFAULT + 4)
+// baseOdometry, inputService, motorSampler: sensor reads and pose integration
+#define PRIORITY_SENSING (TASK_PRIORITY_DEFAULT + 3)
+// baseControl: motion profile following; controllerService: driver input samples (read by opcontrol)
+#define PRIORITY_CONTROL (TASK_PRIORITY_DEFAULT + 2)
+// shooterControl, visionService, coprocessor
+#define PRIORITY_MECHANISM (TASK_PRIORITY_DEFAULT - 1)
+// boot stages (sensor calibration, trajectory loading, brain screen objects, refer to bootSequence.hpp), precompute
+#define PRIORITY_BOOT (TASK_PRIORITY_DEFAULT - 2)
+// trajectoryStream: keeps ahead of the trajectory followed; above the logging that shares the card
+#define PRIORITY_STREAM (TASK_PRIORITY_MIN + 3)
+// flightRecorder (keeps up with the control loop's buffers), poseCheckpoint
+#define PRIORITY_LOGGING (TASK_PRIORITY_MIN + 2)
+// telemetryDrain
+#define PRIORITY_UI (TASK_PRIORITY_MIN + 1)
+// resourceMonitor, motorHealth
+#define PRIORITY_MONITOR TASK_PRIORITY_MIN
+// dashboard: the brain screen only gets the processor when every other task waits
+#define PRIORITY_RENDER TASK_PRIORITY_MIN
+/**
+ * Periods in ms (the deadline of every iteration)
+ */
+// Update period of the smart motors' and ADI ports' data (a read in between returns the same sample)
+#define SENSOR_DEVICE_DT 10
+// Refresh rate of Task baseOdometry: one tick per sensor update (phase locked to it, refer to ODOM_PHASE_LOCK)
+#define ODOM_DT 10
+// Refresh rate of Task baseOdometry while the base stands still (refer to ODOM_ADAPTIVE_RATE; a multiple of ODOM_DT)
+#define ODOM_IDLE_DT 20
+// Sample rate of Task inputService (digital inputs)
+#define INPUT_DT 1
+// Refresh rate of Task baseControl (of its outer position loop with BASE_CASCADE)
+#define BASE_CONTROL_DT 20
+// Refresh rate of the inner wheel velocity loop of Task baseControl with BASE_CASCADE
+#define BASE_INNER_DT 10
+// Refresh rate of Task shooterControl
+#define SHOOTER_DT 5
+// Refresh rate of Task telemetryDrain
+#define TELEMETRY_DRAIN_DT 20
+// Sample rate of Task controllerService (sticks & buttons)
+#define CONTROLLER_DT 5
+// Send rate of the controller display by Task controllerService (the controller accepts one line per 50 ms)
+#define DISPLAY_DT 50
+// Refresh rate of Task dashboard (brain screen)
+#define DASHBOARD_DT 100
+// Refresh rate of Task visionService (the sensor's frame rate)
+#define VISION_DT 20
+// Refresh rate of Task coprocessor (its serial link; the pose is streamed every COPROC_POSE_DT)
+#define COPROC_DT 5
+// Check rate of Task trajectoryStream (it reads at most one chunk per check)
+#define STREAM_DT 10
+// Save rate of Task poseCheckpoint (a resume loses at most this much of the routine's progress)
+#define CHECKPOINT_DT 250
+// Maximum time between checks of Task flightRecorder
+#define RECORDER_DT 50
+// Refresh rate of Task motorSampler (the fast fields of the motor snapshot, refer to motorSnapshot.hpp)
+#define MOTOR_SNAPSHOT_DT SENSOR_DEVICE_DT
+// Sample rate of Task motorHealth (the motors report temperature in 5 C steps)
+#define MOTOR_HEALTH_DT 100
+// Refresh rate of Task resourceMonitor
+#define MONITOR_DT 1000
+// Check rate of Task watchdog
+#define WATCHDOG_DT 10
+
+#endif
@@ -0,0 +1,76 @@
+/**
+ * Header file for taskRegistry.cpp
+ * Defines the task registry that owns the handles of the robot's tasks and decides,
+ * per competition phase, which of them run
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_TASK_REGISTRY_HPP_
+#define _8059_MOTION_PROFILE_LIB_TASK_REGISTRY_HPP_
+#include "8059MotionProfileLib/include/taskConfig.hpp"
+#include "8059MotionProfileLib/include/taskTiming.hpp"
+#include <cstdint>
+// Poll rate of a parked task in ms
+#define REGISTRY_POLL_DT 10
+// Longest wait of enterPhase for the tasks leaving the phase to park, in ms
+#define REGISTRY_HANDOVER_TIMEOUT 100
+/**
+ * Competition phases, as a bitmask so a task can run in several
+ */
+enum RobotPhase{
+  PHASE_DISABLED = 1,
+  PHASE_AUTON = 2,
+  PHASE_DRIVER = 4,
+  PHASE_ALL = 7
+};
+/**
+ * The registered tasks
+ */
+enum RobotTaskId{
+  ROBOT_ODOMETRY,
+  ROBOT_CONTROL,
+  ROBOT_SHOOTER,
+  ROBOT_TELEMETRY,
+  ROBOT_CONTROLLER,
+  ROBOT_RECORDER,
+  ROBOT_MONITOR,
+  ROBOT_INPUT,
+  ROBOT_DASHBOARD,
+  ROBOT_VISION,
+  ROBOT_HEALTH,
+  ROBOT_WATCHDOG,
+  ROBOT_COPROC,
+  ROBOT_PRECOMPUTE,
+  ROBOT_STREAM,
+  ROBOT_CHECKPOINT,
+  ROBOT_SNAPSHOT,
+  ROBOT_TASKS
+};
+/**
+ * How a registered task is created and when it runs
+ * name: task name (shown by the PROS task list)
+ * function: task function
+ * priority: initial priority
+ * stackDepth: stack size in words
+ * phases: RobotPhase bits of the phases it runs in
+ * timing: its TimedTask (taskTiming.hpp), for the stack monitor
+ */
+struct RobotTaskConfig{
+  const char *name;
+  pros::task_fn_t function;
+  uint32_t priority;
+  uint16_t stackDepth;
+  uint32_t phases;
+  TimedTask timing;
+};
+/**
+ * refer to taskRegistry.cpp for function documentation
+ */
+void startRobotTasks();
+void enterPhase(RobotPhase phase);
+RobotPhase getPhase();
+bool isTaskActive(RobotTaskId id);
+bool waitTaskActive(RobotTaskId id);
+void setTaskPhases(RobotTaskId id, uint32_t phases);
+void setRobotTaskPriority(RobotTaskId id, uint32_t priority);
+pros::task_t getTaskHandle(RobotTaskId id);
+
+#endif
@@ -0,0 +1,98 @@
+/**
+ * Header file for taskTiming.cpp
+ * Defines the loop timing instrumentation of the RTOS tasks: execution time,
+ * wake-up lateness, overruns and deadline misses of every iteration, kept in fixed histograms,
+ * and the CPU share of every task
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_TASK_TIMING_HPP_
+#define _8059_MOTION_PROFILE_LIB_TASK_TIMING_HPP_
+#include <atomic>
+#include <cstdint>
+/**
+ * Number of histogram bins. Bin 0 counts 0 us, bin i counts 2^(i-1) to 2^i - 1 us;
+ * the last bin counts everything from 2^(TIMING_BINS-2) us (16 ms) up
+ */
+#define TIMING_BINS 16
+// Period of the timing report (TRACE_TIMING, e.g. DEBUG_MODE 6) in ms
+#define TIMING_REPORT_DT 1000
+/** the instrumented tasks (timedTaskNames holds their short names) */
+enum TimedTask{
+  TIMING_ODOMETRY,
+  TIMING_CONTROL,
+  TIMING_SHOOTER,
+  TIMING_TELEMETRY,
+  TIMING_CONTROLLER,
+  TIMING_RECORDER,
+  TIMING_MONITOR,
+  TIMING_INPUT,
+  TIMING_DASHBOARD,
+  TIMING_VISION,
+  TIMING_HEALTH,
+  TIMING_WATCHDOG,
+  TIMING_OPCONTROL,
+  TIMING_COPROC,
+  TIMING_PRECOMPUTE,
+  TIMING_STREAM,
+  TIMING_CHECKPOINT,
+  TIMING_SNAPSHOT,
+  TIMING_TASKS
+};
+/**
+ * Timing statistics of one task, written only by the task itself
+ * execHist: execution time of the iterations (wake-up to end of the loop body)
+ * lateHist: wake-up time minus the scheduled wake-up time
+ * overruns: iterations that took longer than the period
+ * misses & maxMiss: iterations that ended more than a period after their scheduled wake-up
+ *   (deadline misses), and the latest of them past its deadline (micros)
+ * period: loop period in micros
+ * fixedRate: the loop wakes on a fixed schedule (delay_until), otherwise a period after each iteration (delay)
+ * expectedWake & wakeTime: scheduled and actual wake-up of the next and the current iteration (micros)
+ * releaseTime: scheduled wake-up of the current iteration (micros)
+ * busyTime: execution time of all the iterations (micros, wraps around; refer to sampleTaskLoad)
+ */
+struct TaskTiming{
+  std::atomic<uint32_t> execHist[TIMING_BINS], lateHist[TIMING_BINS];
+  std::atomic<uint32_t> iterations, overruns, maxExec, maxLate;
+  std::atomic<uint32_t> misses, maxMiss;
+  std::atomic<uint32_t> busyTime;
+  uint32_t period;
+  bool fixedRate;
+  uint64_t expectedWake, wakeTime, releaseTime;
+};
+/**
+ * Summary of the statistics of one task, all times in micros
+ * (percentiles are the upper bounds of their histogram bins)
+ */
+struct TaskTimingSummary{
+  uint32_t iterations, overruns;
+  uint32_t misses, maxMiss;
+  uint32_t p99Exec, maxExec;
+  uint32_t p99Late, maxLate;
+};
+/**
+ * Heartbeat of a task, for the watchdog (cheaper than the summary)
+ * iterations, misses: iterations ended and deadlines missed since the start
+ * period: loop period in micros
+ */
+struct TaskHeartbeat{
+  uint32_t iterations, misses, period;
+};
+extern const char *timedTaskNames[TIMING_TASKS];
+/**
+ * refer to taskTiming.cpp for function documentation
+ */
+void startTaskTiming(TimedTask task, uint32_t periodMs, bool fixedRate);
+void beginTaskIteration(TimedTask task);
+void endTaskIteration(TimedTask task);
+TaskTimingSummary getTaskTiming(TimedTask task);
+TaskHeartbeat getTaskHeartbeat(TimedTask task);
+void sampleTaskLoad();
+double getTaskLoad(TimedTask task);
+double getTotalTaskLoad();
+void printTaskTiming();
+void showTaskTiming();
+void reportTaskTiming();
+void reportDeadlineMisses();
+void reportTaskLoad();
+
+#endif
@@ -0,0 +1,115 @@
+/**
+ * Header file for telemetry.cpp
+ * Defines the telemetry ring buffer: control loops push fixed binary records without blocking,
+ * and a low priority drain task prints (or streams) them
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_TELEMETRY_HPP_
+#define _8059_MOTION_PROFILE_LIB_TELEMETRY_HPP_
+#include "8059MotionProfileLib/include/taskConfig.hpp"
+#include <cstdint>
+/**
+ * DEBUG_MODE can be used to debug & test functions and tasks via the terminal (aka command line)
+ * 0: None
+ * 1: Odometry (print the pose; TRACE_ODOM)
+ * 2: Encoders (print errorEncdL & errorEncdR; TRACE_CONTROL)
+ * 3: Power (print powerL & powerR; TRACE_POWER)
+ * 4: Raw encoder values (print raw encdL & encdR; TRACE_ENCODERS)
+ * 5: Benchmark (print the cost of the hot kernels once at initialization, refer to benchmark.hpp)
+ * 6: Task timing (report the loop timing and the CPU share of the tasks every second, refer to taskTiming.hpp; TRACE_TIMING)
+ * 7: Resources (report the stack high-water marks, the heap usage and the display memory every second, refer to resourceMonitor.hpp; TRACE_RESOURCES)
+ * Output of modes 1-4, 6 and 7 goes through the telemetry buffer, on the trace channel of the mode.
+ * Can be set from the build (e.g. -DDEBUG_MODE=1 in EXTRA_CXXFLAGS) without editing this file.
+ */
+#ifndef DEBUG_MODE
+#define DEBUG_MODE 0
+#endif
+/**
+ * Trace channels (bits of TRACE_CHANNELS), fixed at compile time: the trace points of a disabled
+ * channel compile to nothing, those of an enabled one push binary records into the ring buffer
+ * (refer to TracePoint). TRACE_CHANNELS defaults to the channel of DEBUG_MODE; set it from the
+ * build to trace several at once (e.g. -DTRACE_CHANNELS=0x5 for the odometry and the power).
+ */
+#define TRACE_ODOM 0x1
+#define TRACE_CONTROL 0x2
+#define TRACE_POWER 0x4
+#define TRACE_ENCODERS 0x8
+#define TRACE_TIMING 0x10
+#define TRACE_RESOURCES 0x20
+#ifndef TRACE_CHANNELS
+#define TRACE_CHANNELS (DEBUG_MODE == 1? TRACE_ODOM : DEBUG_MODE == 2? TRACE_CONTROL : DEBUG_MODE == 3? TRACE_POWER : \
+  DEBUG_MODE == 4? TRACE_ENCODERS : DEBUG_MODE == 6? TRACE_TIMING : DEBUG_MODE == 7? TRACE_RESOURCES : 0)
+#endif
+// Number of records in the ring buffer (power of 2)
+#define TELEMETRY_SIZE 256
+/**
+ * Output format of the drain task
+ * TELEMETRY_TEXT: one formatted line per record (same format as the old debugging printf)
+ * TELEMETRY_RAW: the raw TelemetryRecord bytes
+ * TELEMETRY_FRAMED: packed, CRC-checked COBS frames (refer to serialProtocol.hpp);
+ * compact enough to stream every odometry tick
+ * TELEMETRY_DELTA: the frames of TELEMETRY_FRAMED with each value delta coded against the previous
+ * record of its type, with periodic keyframes (a value that moves a little takes a byte or two instead of two or four)
+ */
+#define TELEMETRY_TEXT 0
+#define TELEMETRY_RAW 1
+#define TELEMETRY_FRAMED 2
+#define TELEMETRY_DELTA 3
+#define TELEMETRY_FORMAT TELEMETRY_TEXT
+/** Record types (the meaning of the values of a record) */
+enum TelemetryType{
+  TELEMETRY_POSE,       // x, y, angle (degrees)
+  TELEMETRY_ERROR,      // errorEncdL, errorEncdR
+  TELEMETRY_POWER,      // powerL, powerR
+  TELEMETRY_ENCODERS,   // raw encdL, encdR
+  TELEMETRY_TIMING,     // task, overruns, p99 & max execution time, p99 & max lateness (micros; refer to taskTiming.hpp)
+  TELEMETRY_STACK,      // task, least free stack, stack size (bytes; refer to resourceMonitor.hpp)
+  TELEMETRY_HEAP,       // free heap, least free heap (bytes)
+  TELEMETRY_DEADLINE,   // task, new deadline misses, total misses, latest finish past a deadline (micros)
+  TELEMETRY_JAM,        // motor port, current (mA), velocity (rpm) at the detection (refer to stallDetector.hpp)
+  TELEMETRY_SLIP,       // slip rate of the left & right side (in/s), failed tracking wheels, odometry source (refer to OdometryHealth)
+  TELEMETRY_DISPLAY,    // kernel heap taken by the brain screen, free kernel heap, least free kernel heap (bytes)
+  TELEMETRY_ARENA,      // persistent bytes, peak bytes, failed allocations of the motion arena (refer to motionArena.hpp)
+  TELEMETRY_MOTOR,      // motor port, temperature (C), average current (mA), allowed power fraction (refer to motorHealth.hpp)
+  TELEMETRY_LATENCY,    // motor port, steps, median, P90 & max velocity latency, median encoder latency (micros; refer to latencyProbe.hpp)
+  TELEMETRY_STOP,       // time from the end of the profile to the settle (ms), side velocity then (in/s), active brake pulse (ms)
+  TELEMETRY_WATCHDOG,   // task, WatchdogFault, time since its last iteration (ms), deadline misses in the window, 1 if the base was stopped
+  TELEMETRY_LOAD,       // task, its CPU share, summed share of the instrumented tasks (percent; refer to sampleTaskLoad)
+  TELEMETRY_BOOT,       // BootMark, its time since the program start, time since the previous instant (ms; refer to bootSequence.hpp)
+  TELEMETRY_CYCLE,      // goal cycle time, shots, mean intake to shot, indexing, spin-up & stalled time of the cycle (ms; refer to ShooterMetrics)
+  TELEMETRY_STREAM,     // chunks read, underruns, failed reads, slowest read of a chunk (micros; refer to trajectoryStream.hpp)
+  TELEMETRY_BATTERY,    // open-circuit voltage (mV), internal resistance (ohms), mean voltage (mV) & current (mA; refer to batteryModel.hpp)
+  TELEMETRY_TYPES
+};
+/**
+ * One telemetry record (32 bytes)
+ * timestamp: micros() when the record was pushed (lower 32 bits)
+ * type: TelemetryType
+ * values: up to 6 values, meaning given by type
+ */
+struct TelemetryRecord{
+  uint32_t timestamp;
+  uint32_t type;
+  float values[6];
+};
+/**
+ * refer to telemetry.cpp for function documentation
+ */
+bool pushTelemetry(TelemetryType type, float v0 = 0, float v1 = 0, float v2 = 0, float v3 = 0, float v4 = 0, float v5 = 0);
+bool popTelemetry(TelemetryRecord &record);
+uint32_t getTelemetryDrops();
+void telemetryDrain(void * ignore);
+/**
+ * Trace point of a channel: TracePoint<TRACE_POWER>::record(TELEMETRY_POWER, powerL, powerR) pushes a
+ * record if the channel is enabled and is discarded at compile time if not. Work that only feeds a
+ * channel goes under if constexpr(TracePoint<channel>::enabled), so it is discarded with it.
+ */
+template<uint32_t channel>
+struct TracePoint{
+  static constexpr bool enabled = (TRACE_CHANNELS & channel) != 0;
+  template<typename... Values>
+  static inline void record(TelemetryType type, Values... values){
+    if constexpr(enabled) pushTelemetry(type, values...);
+  }
+};
+
+#endif
@@ -0,0 +1,35 @@
+/**
+ * Header file for tickVelocity.cpp
+ * Defines the velocity estimate of an encoder from the timing of its ticks: at creep speed (a final approach,
+ * squaring on a wall) a tracking wheel moves 0 or 1 tick per sample, so the difference over a sample is mostly
+ * 0 or a spike. Below TICK_VEL_SWITCH ticks per sample the estimate is the ticks over the time between the
+ * ticks (the time of a tick is taken midway through the sample it shows up in), and the time since the last
+ * tick bounds it while none comes; from TICK_VEL_SWITCH on it is the difference over the sample, as in
+ * okapi's VelMath. The estimate is carried in a TickVelocity, so it steps outside its task (e.g. a replay).
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_TICK_VELOCITY_HPP_
+#define _8059_MOTION_PROFILE_LIB_TICK_VELOCITY_HPP_
+#include <cstdint>
+/**
+ * TICK_VEL_SWITCH: ticks per sample from which the difference over the sample is taken
+ * TICK_VEL_TIMEOUT: time in micros without a tick after which the encoder is at rest
+ */
+#define TICK_VEL_SWITCH 4
+#define TICK_VEL_TIMEOUT 250000
+/**
+ * State of the estimate of an encoder
+ * count, time: count and time (micros) of the previous sample; time is 0 before the first sample
+ * edgeCount, edgeTime: count and time of the latest tick (or of the latest sample differenced)
+ * velocity: the estimate in ticks per second
+ */
+struct TickVelocity{
+  int32_t count, edgeCount;
+  uint64_t time, edgeTime;
+  double velocity;
+};
+/**
+ * refer to tickVelocity.cpp for function documentation
+ */
+double stepTickVelocity(TickVelocity &estimate, int32_t count, uint64_t time);
+
+#endif
@@ -0,0 +1,48 @@
+/**
+ * Header file for timeUtils.cpp
+ * Defines high resolution timing functions and the clock of the loops: a stopwatch for timeouts and
+ * state times, and a fixed rate loop period that counts its ticks. Every loop reads time through
+ * these (and micros), i.e. through the PROS clock calls, which the host simulation links to its
+ * virtual clock (refer to sim/simKernel.cpp), so a simulated run is faster than real time and repeatable.
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_TIME_UTILS_HPP_
+#define _8059_MOTION_PROFILE_LIB_TIME_UTILS_HPP_
+#include <cstdint>
+/**
+ * refer to timeUtils.cpp for function documentation
+ */
+uint64_t micros();
+/**
+ * Stopwatch in ms (wraps safely), started at construction
+ */
+class Timer{
+public:
+  /**
+   * refer to timeUtils.cpp for function documentation
+   */
+  Timer();
+  void reset();
+  uint32_t elapsed() const;
+  bool passed(uint32_t ms) const;
+private:
+  uint32_t start;
+};
+/**
+ * Period of a fixed rate loop: each wait ends a whole period after the previous wake-up, whatever
+ * the loop body took, and counts one tick (the tick number of an iteration is the same on every run)
+ */
+class LoopRate{
+public:
+  /**
+   * refer to timeUtils.cpp for function documentation
+   */
+  explicit LoopRate(uint32_t period);
+  void restart();
+  void wait();
+  void shift(int32_t ms);
+  uint32_t getTicks() const;
+private:
+  uint32_t period, wake, ticks;
+};
+
+#endif
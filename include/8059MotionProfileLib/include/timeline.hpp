@@ -0,0 +1,97 @@
+/**
+ * Header file for timeline.cpp
+ * Defines the execution timeline of a run: the tasks' iterations (refer to taskTiming.hpp), the motion
+ * commands, the waits of the autonomous code and the mechanism states, pushed as small timestamped
+ * events without blocking and written by the flight recorder next to each run file; a timeline
+ * exports to a Chrome trace_event file (chrome://tracing or Perfetto) that shows where the time goes
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_TIMELINE_HPP_
+#define _8059_MOTION_PROFILE_LIB_TIMELINE_HPP_
+#include "8059MotionProfileLib/include/taskTiming.hpp"
+#include <cstdint>
+#include <cstdio>
+// Number of events in the ring buffer (power of 2), drained by the flight recorder every RECORDER_DT
+#define TIMELINE_SIZE 1024
+/**
+ * printf formats of the timeline files (the number of the run file) and of their exported traces
+ * (the host simulation writes them to bin/ instead)
+ */
+#ifndef TIMELINE_PATH
+#define TIMELINE_PATH "/usd/run%03d.tl"
+#endif
+#ifndef TIMELINE_TRACE_PATH
+#define TIMELINE_TRACE_PATH "/usd/run%03d.json"
+#endif
+// File header identification ("805T" in ASCII) and format version
+#define TIMELINE_FILE_MAGIC 0x54353038
+#define TIMELINE_FILE_VERSION 1
+/**
+ * TIMELINE_TASK_MASK: tasks (bits of TimedTask) whose iterations are logged; the input task is left out
+ * as its 1 ms loop would triple the size of the timeline, and the watchdog as its checks are only counters
+ * TIMELINE_EXPORT: 1 to export the trace of each run on the card when its file is closed (the flight
+ * recorder is busy during the conversion, so a run started right after opens its file late);
+ * 0 to export on a computer (`./bin/sim trace <file>`)
+ * TIMELINE_MECHANISMS: mechanisms with named states (refer to setTimelineMechanism)
+ */
+#define TIMELINE_TASK_MASK (((1u << TIMING_TASKS) - 1) & ~(1u << TIMING_INPUT) & ~(1u << TIMING_WATCHDOG))
+#define TIMELINE_EXPORT 0
+#define TIMELINE_MECHANISMS 4
+/** Event types (the meaning of id and arg) */
+enum TimelineType{
+  TIMELINE_TASK_BEGIN,    // id: TimedTask, an iteration starts
+  TIMELINE_TASK_END,      // id: TimedTask, the iteration ends
+  TIMELINE_MOTION_START,  // id: MotionType, arg: motion number (refer to getMotionSequence)
+  TIMELINE_MOTION_END,    // id: MotionType, arg: TimelineMotionEnd
+  TIMELINE_WAIT_BEGIN,    // id: TimelineWait, the autonomous code starts waiting
+  TIMELINE_WAIT_END,      // id: TimelineWait, arg: 1 if the wait ran out of time
+  TIMELINE_MECHANISM,     // id: mechanism, arg: the state it enters
+  TIMELINE_IMPACT,        // id: ImpactType, arg: 1 if it aborted a movement (refer to detectBaseImpact)
+  TIMELINE_WATCHDOG       // id: TimedTask, arg: WatchdogFault (refer to watchdog.hpp)
+};
+/** How a queued motion ended */
+enum TimelineMotionEnd{
+  TIMELINE_SETTLED,
+  TIMELINE_TIMED_OUT,
+  TIMELINE_CHAINED,       // the next motion blended into it
+  TIMELINE_CLEARED,
+  TIMELINE_EXITED,        // early exit (refer to setMotionEarlyExit)
+  TIMELINE_SKIPPED,       // optional motion left out for lack of match time (never started, refer to setNextMotionOptional)
+  TIMELINE_ABORTED        // an impact or the watchdog aborted it (refer to BASE_IMPACT_DETECTION and watchdog.hpp)
+};
+/** What the autonomous code waits on */
+enum TimelineWait{
+  TIMELINE_WAIT_BASE,     // waitBase
+  TIMELINE_WAIT_QUEUE,    // waitMotionQueue
+  TIMELINE_WAIT_SHOOTER   // waitShooter
+};
+/**
+ * One event (8 bytes)
+ * time: micros() of the event (lower 32 bits)
+ * type: TimelineType
+ * id & arg: meaning given by type
+ */
+struct TimelineEvent{
+  uint32_t time;
+  uint8_t type, id;
+  uint16_t arg;
+};
+/**
+ * Header at the start of each timeline file, followed by TimelineEvents
+ */
+struct TimelineFileHeader{
+  uint32_t magic, version, eventSize;
+};
+/** names of the motions (MotionType), the waits (TimelineWait) and the motion endings (TimelineMotionEnd) */
+extern const char *timelineMotionNames[], *timelineWaitNames[], *timelineEndNames[];
+/**
+ * refer to timeline.cpp for function documentation
+ */
+void setTimelineMechanism(int id, const char *name, const char *const *states, int stateCount);
+bool recordTimeline(TimelineType type, int id, int arg = 0, uint32_t time = 0);
+FILE *openTimelineFile(int run);
+void writeTimeline(FILE *file);
+void closeTimelineFile(FILE *file);
+uint32_t getTimelineDrops();
+int exportTimeline(const char *path, const char *tracePath);
+
+#endif
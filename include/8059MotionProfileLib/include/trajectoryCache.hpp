@@ -0,0 +1,223 @@
+/**
+ * Header file for trajectoryCache.cpp
+ * Defines the trajectory cache: tank trajectories are generated with the
+ * vendored pathfinder library during initialize() / competition_initialize(),
+ * stored in a static table and replayed during autonomous() without any
+ * generation at run time.
+ * Generated trajectories are saved to the microSD card and loaded
+ * at the next boot, unless the waypoints or limits have changed.
+ * Cached sides are packed (PackedSegment, 8 bytes instead of pathfinder's 64) in memory and on the card,
+ * and decoded by the follower one segment at a time, with the poses of the centre for the RAMSETE
+ * follower (refer to ramsete.hpp).
+ * Mirrored and backwards variants (deriveTrajectory) share the segments of the trajectory they are
+ * derived from, and are transformed as they are decoded.
+ * A long trajectory can be streamed from the card instead (streamTrajectory, refer to trajectoryStream.hpp); the
+ * followers read every trajectory through getSegment and getPackedPose.
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_TRAJECTORY_CACHE_HPP_
+#define _8059_MOTION_PROFILE_LIB_TRAJECTORY_CACHE_HPP_
+/** pathfinder.h is not included as its mathutil.h redefines PI */
+#include "okapi/pathfinder/include/pathfinder/structs.h"
+#include "okapi/pathfinder/include/pathfinder/fit.h"
+#include "okapi/pathfinder/include/pathfinder/spline.h"
+#include "okapi/pathfinder/include/pathfinder/trajectory.h"
+#include "okapi/pathfinder/include/pathfinder/modifiers/tank.h"
+#include "okapi/pathfinder/include/pathfinder/io.h"
+#include <cstdint>
+// Maximum number of cached trajectories
+#define MAX_TRAJECTORIES 16
+/**
+ * Time step of generated trajectories in seconds: the followers interpolate between the segments (refer to
+ * sampleTrajectory), so the step can be as long as a control cycle (BASE_CONTROL_DT) without stepping the setpoints
+ */
+#define TRAJECTORY_DT 0.02
+/**
+ * Trajectory files on the microSD card: TRAJECTORY_DIR/<name>.traj
+ * Bump TRAJECTORY_FILE_VERSION when the file layout or the generation changes,
+ * so that every stale file is regenerated.
+ */
+#define TRAJECTORY_DIR "/usd/"
+#define TRAJECTORY_FILE_MAGIC 0x39353038
+#define TRAJECTORY_FILE_VERSION 5
+/**
+ * Default trajectory limits (inches, seconds)
+ */
+#define TRAJECTORY_MAX_VEL 30
+#define TRAJECTORY_MAX_ACC 60
+#define TRAJECTORY_MAX_JERK 300
+/**
+ * Velocity planning (retimeTrajectory): pathfinder's profile is replaced by the
+ * time-optimal one under the limits below, so straight sections run at the maximum
+ * velocity and only the curves slow down (0: keep pathfinder's profile)
+ * TRAJECTORY_MAX_LAT_ACC: lateral acceleration limit of the robot's center
+ * TRAJECTORY_DS: spacing of the curvature samples along the path (inches)
+ * The velocity and acceleration limits apply to the outer side in curves
+ * (tank kinematics with baseWidth); the jerk limit is not kept by the planner.
+ */
+#define TRAJECTORY_VELOCITY_PLANNING 1
+#define TRAJECTORY_MAX_LAT_ACC 60
+#define TRAJECTORY_DS 0.25
+/**
+ * x of the line mirrored trajectories are reflected across (odometry coordinates, inches; the field's
+ * centre line between the alliances, refer to deriveTrajectory)
+ */
+#define TRAJECTORY_MIRROR_X 0
+/**
+ * Sides of a planned trajectory (packPlannedTrajectory): the velocity and acceleration of each side are the
+ * centre's plus or minus the turn rate times half of baseWidth, computed in float batches of
+ * TRAJECTORY_BATCH samples (float32x4 NEON on the V5) instead of pathfinder's tank modifier, which
+ * offsets every segment with trigonometry and a square root
+ */
+#define TRAJECTORY_BATCH 4
+/**
+ * A packed segment of a side (the follower only needs these three values)
+ * position: inches along the side
+ * velocity, acceleration: scaled by the velScale & accScale of the trajectory
+ */
+struct PackedSegment{
+  float position;
+  int16_t velocity, acceleration;
+};
+/** A pose of the centre of a trajectory (odometry coordinates: inches, bearing in radians) */
+struct PackedPose{
+  float x, y, angle;
+};
+/** A decoded segment (inches, seconds) */
+struct TrajectorySample{
+  double position, velocity, acceleration;
+};
+/**
+ * A cached trajectory
+ * name: identifier used by the routines
+ * left, right: packed side trajectories
+ * length: number of segments per side
+ * dt: time step of the segments in seconds
+ * velScale, accScale: in/s and in/s^2 per unit of the packed velocity & acceleration
+ * (the largest value of either side maps to INT16_MAX)
+ * poses: pose of the centre at every segment
+ * mirrored, reversed: transforms of a derived trajectory (refer to deriveTrajectory), applied by
+ * decodeSegment and decodePose; left and right are already swapped
+ * hash: hash of its inputs (refer to hashTrajectory; 0 for a derived trajectory)
+ * stream: the stream of a streamed trajectory (left, right and poses are NULL), NULL for the others
+ */
+struct TrajectoryStream;
+struct CachedTrajectory{
+  const char *name;
+  PackedSegment *left, *right;
+  int length;
+  float dt, velScale, accScale;
+  PackedPose *poses;
+  bool mirrored, reversed;
+  uint32_t hash;
+  TrajectoryStream *stream;
+};
+/** refer to trajectoryStream.cpp */
+PackedSegment streamSegment(TrajectoryStream &stream, bool right, int i);
+PackedPose streamPose(TrajectoryStream &stream, int i);
+/**
+ * @param trajectory
+ * a cached trajectory
+ *
+ * @param right
+ * true for the right side
+ *
+ * @param i
+ * index of the segment
+ *
+ * @return
+ * the packed segment of the side (read from the stream of a streamed trajectory)
+ */
+inline PackedSegment getSegment(const CachedTrajectory &trajectory, bool right, int i){
+  if(trajectory.stream != NULL) return streamSegment(*trajectory.stream, right, i);
+  return right? trajectory.right[i] : trajectory.left[i];
+}
+/**
+ * @param trajectory
+ * a cached trajectory
+ *
+ * @param i
+ * index of the segment
+ *
+ * @return
+ * the packed pose of the segment, before the transforms of decodePose
+ */
+inline PackedPose getPackedPose(const CachedTrajectory &trajectory, int i){
+  if(trajectory.stream != NULL) return streamPose(*trajectory.stream, i);
+  return trajectory.poses[i];
+}
+/**
+ * Decode a segment of a cached trajectory.
+ * @param trajectory
+ * the trajectory
+ *
+ * @param segment
+ * a segment of one of its sides
+ *
+ * @return
+ * the decoded segment
+ */
+inline TrajectorySample decodeSegment(const CachedTrajectory &trajectory, const PackedSegment &segment){
+  double sign = trajectory.reversed? -1 : 1;
+  return {sign*segment.position, sign*segment.velocity*trajectory.velScale, sign*segment.acceleration*trajectory.accScale};
+}
+/**
+ * Decode a pose of a cached trajectory: a mirrored trajectory is reflected across TRAJECTORY_MIRROR_X,
+ * and a backwards one is reflected through its first pose (driving backwards with the same turns).
+ * @param trajectory
+ * the trajectory
+ *
+ * @param i
+ * index of the segment
+ *
+ * @return
+ * the pose of the centre (odometry coordinates)
+ */
+inline PackedPose decodePose(const CachedTrajectory &trajectory, int i){
+  PackedPose pose = getPackedPose(trajectory, i), start = getPackedPose(trajectory, 0);
+  if(trajectory.mirrored){
+    pose.x = 2*TRAJECTORY_MIRROR_X - pose.x;
+    pose.angle = -pose.angle;
+    start.x = 2*TRAJECTORY_MIRROR_X - start.x;
+  }
+  if(trajectory.reversed){
+    pose.x = 2*start.x - pose.x;
+    pose.y = 2*start.y - pose.y;
+  }
+  return pose;
+}
+/**
+ * Header of a trajectory file, followed by the left and right PackedSegment arrays and the PackedPose array.
+ * hash covers the waypoints, limits and robot geometry the trajectory was generated from.
+ */
+struct TrajectoryFileHeader{
+  uint32_t magic, version, hash;
+  int32_t length;
+  float dt, velScale, accScale;
+};
+/**
+ * refer to trajectoryCache.cpp for function documentation
+ */
+uint32_t hashTrajectory(const Waypoint *points, int count, double maxVel, double maxAcc, double maxJerk);
+void trajectoryFilePath(const char *name, char *path, int size);
+int retimeTrajectory(const Segment *center, int length, double maxVel, double maxAcc, Segment **result);
+int splineCenter(const Waypoint *points, int count, Segment **center);
+void setSplineGeneration(bool value);
+void tankSides(const float *center, const float *turn, int count, float halfWidth, float *left, float *right);
+bool packPlannedTrajectory(const char *name, const Segment *center, int length, CachedTrajectory &trajectory);
+int generateTrajectory(const char *name, const Waypoint *points, int count, double maxVel, double maxAcc, double maxJerk);
+int generateTrajectory(const char *name, const Waypoint *points, int count);
+int streamTrajectory(const char *name, const Waypoint *points, int count, double maxVel, double maxAcc, double maxJerk);
+int streamTrajectory(const char *name, const Waypoint *points, int count);
+int deriveTrajectory(const char *name, const char *source, bool mirror, bool backwards);
+void clearTrajectories();
+int findTrajectory(const char *name);
+const CachedTrajectory *getTrajectory(int id);
+int trajectoryIndex(const CachedTrajectory &trajectory, double t, double &fraction);
+TrajectorySample sampleTrajectory(const CachedTrajectory &trajectory, bool right, double t);
+PackedPose sampleTrajectoryPose(const CachedTrajectory &trajectory, double t);
+bool followTrajectory(const char *name, double kp, double kd);
+bool followTrajectory(const char *name);
+bool followTrajectoryRamsete(const char *name);
+bool followTrajectoryMpc(const char *name);
+
+#endif
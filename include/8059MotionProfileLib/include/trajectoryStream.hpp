@@ -0,0 +1,73 @@
+/**
+ * Header file for trajectoryStream.cpp
+ * Defines the streamed trajectories: a long route (e.g. the whole skills run as one trajectory) does not have to fit
+ * in the motion arena next to everything else. streamTrajectory (refer to trajectoryCache.hpp) keeps only the first
+ * chunk of STREAM_CHUNK segments of a trajectory file (TRAJECTORY_DIR/<name>.traj, the same packed layout) in the
+ * arena; while it is followed, Task trajectoryStream reads the chunks after the follower's segment from the microSD
+ * card into two shared buffers (double buffering: the follower reads one while the next is loaded into the other),
+ * so any length of route takes the same memory.
+ * The follower never waits on the card: a segment whose chunk is not loaded yet (an underrun) repeats the last
+ * segment read, and is counted (TELEMETRY_STREAM). A chunk covers STREAM_CHUNK*TRAJECTORY_DT s of driving, and the
+ * next one is requested as soon as the follower enters it, so a read has seconds to finish.
+ * Streamed trajectories do not learn (refer to learnedFeedforward.hpp), are not baked and cannot be derived
+ * (mirrored or backwards).
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_TRAJECTORY_STREAM_HPP_
+#define _8059_MOTION_PROFILE_LIB_TRAJECTORY_STREAM_HPP_
+#include "8059MotionProfileLib/include/trajectoryCache.hpp"
+#include <atomic>
+#include <cstdint>
+/**
+ * Segments per chunk (28 bytes each: both sides and the pose), so a chunk is 3.5 KB and 2.56 s of driving at
+ * TRAJECTORY_DT; at least twice the lookahead of the followers (refer to trajectoryStream.cpp)
+ */
+#define STREAM_CHUNK 128
+/** Shared chunk buffers: the one being followed and the one being loaded */
+#define STREAM_BUFFERS 2
+/**
+ * A chunk of a trajectory file: its segments of both sides and its poses
+ */
+struct StreamChunk{
+  PackedSegment left[STREAM_CHUNK], right[STREAM_CHUNK];
+  PackedPose poses[STREAM_CHUNK];
+};
+/**
+ * A streamed trajectory (in the motion arena)
+ * name: identifier of the trajectory (its file); length: segments per side
+ * tag: tag of its chunks in the shared buffers (refer to streamTag); serial: its opening, for the file of the task
+ * position: segment of the follower (refer to advanceStream)
+ * head: its first chunk, always loaded (a follower starts without waiting for the card)
+ * endL, endR, endPose: its last segments and pose (the follower reads them as it starts)
+ * heldL, heldR, heldPose: the last segments and pose read (repeated on an underrun; control task only)
+ */
+struct TrajectoryStream{
+  const char *name;
+  int length;
+  uint32_t tag, serial;
+  std::atomic<int> position;
+  StreamChunk head;
+  PackedSegment endL, endR;
+  PackedPose endPose;
+  PackedSegment heldL, heldR;
+  PackedPose heldPose;
+};
+/**
+ * Stream counters since boot
+ * chunks: chunks read; underruns: segments read before their chunk was loaded; failures: chunks that could not be read
+ * slowest: longest read of a chunk (micros)
+ */
+struct StreamStats{
+  uint32_t chunks, underruns, failures, slowest;
+};
+/**
+ * refer to trajectoryStream.cpp for function documentation
+ */
+bool openStream(const char *name, uint32_t hash, CachedTrajectory &trajectory);
+void advanceStream(const CachedTrajectory &trajectory, int i);
+PackedSegment streamSegment(TrajectoryStream &stream, bool right, int i);
+PackedPose streamPose(TrajectoryStream &stream, int i);
+void closeStreams();
+StreamStats getStreamStats();
+void trajectoryStream(void * ignore);
+
+#endif
@@ -0,0 +1,42 @@
+/**
+ * Header file for tuningPanel.cpp
+ * Defines the brain screen tuning panel of the "Tune" routine: sliders (with +/- buttons for single steps)
+ * for the PD gains of the test move's band in the gain schedule, the ramping power and the power cap
+ * (parameter table), and a button that runs the test move out and back while the tracking error of
+ * both sides is plotted, so the base is tuned in the pits without a computer or an upload between tries
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_TUNING_PANEL_HPP_
+#define _8059_MOTION_PROFILE_LIB_TUNING_PANEL_HPP_
+#include "8059MotionProfileLib/include/gainTuner.hpp"
+/**
+ * Test move
+ * TUNING_MOVE_SIZE: distance in inches (the gains of its band are tuned)
+ * TUNING_TIMEOUT: longest leg in ms
+ */
+#define TUNING_MOVE_SIZE TUNER_MOVE_SIZE
+#define TUNING_TIMEOUT TUNER_TIMEOUT
+/**
+ * Error chart
+ * TUNING_CHART_POINTS: points per side (the chart scrolls once full)
+ * TUNING_SAMPLE_DT: time per point in ms
+ * TUNING_CHART_RANGE: error shown either side of 0, in tenths of an inch
+ */
+#define TUNING_CHART_POINTS 100
+#define TUNING_SAMPLE_DT 40
+#define TUNING_CHART_RANGE 40
+/** The controls of the panel */
+enum TuningControl{
+  TUNING_KP,    // kP of the test move's band
+  TUNING_KD,    // kD of the test move's band
+  TUNING_RAMP,  // PARAM_RAMPING_POW
+  TUNING_CAP,   // PARAM_MAX_POW
+  TUNING_CONTROLS
+};
+/**
+ * refer to tuningPanel.cpp for function documentation
+ */
+void buildTuningPanel();
+bool isTuningPanelShown();
+void tuningPanel();
+
+#endif
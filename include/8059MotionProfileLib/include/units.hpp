@@ -0,0 +1,119 @@
+/**
+ * Header file of the typed units of the library API
+ * Defines overloads of the movement and pose functions on okapi's RQuantity types (QLength, QAngle, QSpeed).
+ * A quantity is a double in SI units whose dimension the compiler checks, so a length passed as an angle
+ * (or inches read as degrees) fails to compile; its conversion to the units of the library (inches, degrees,
+ * radians) is one multiplication by a constant, folded away for a literal (e.g. baseMove(2_ft)).
+ * The library keeps plain doubles inside: the overloads are inline and call the double functions.
+ * Literals: `using namespace okapi::literals;` (the okapi namespace itself stays out, refer to main.h).
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_UNITS_HPP_
+#define _8059_MOTION_PROFILE_LIB_UNITS_HPP_
+#include "8059MotionProfileLib/include/motionQueue.hpp"
+#include "8059MotionProfileLib/include/mathUtils.hpp"
+#include "okapi/api/units/QLength.hpp"
+#include "okapi/api/units/QAngle.hpp"
+#include "okapi/api/units/QSpeed.hpp"
+#include "okapi/api/units/QTime.hpp"
+#include <type_traits>
+/** a quantity is passed and stored as the double it wraps */
+static_assert(sizeof(okapi::QLength) == sizeof(double) && std::is_trivially_copyable<okapi::QLength>::value,
+  "a quantity must cost what a double does");
+// Inches per meter (QLength and QSpeed hold meters)
+constexpr double UNITS_IN_PER_M = 1/0.0254;
+/**
+ * Conversions to the units of the library
+ * @return
+ * the quantity in inches, inches per second, degrees, radians or milliseconds (QAngle holds radians, QTime seconds)
+ */
+constexpr double toInches(okapi::QLength length){
+  return length.getValue()*UNITS_IN_PER_M;
+}
+constexpr double toInchesPerSecond(okapi::QSpeed speed){
+  return speed.getValue()*UNITS_IN_PER_M;
+}
+constexpr double toDegrees(okapi::QAngle angle){
+  return angle.getValue()*toDeg;
+}
+constexpr double toRadians(okapi::QAngle angle){
+  return angle.getValue();
+}
+constexpr double toMilliseconds(okapi::QTime time){
+  return time.getValue()*1000;
+}
+static_assert(toInches(okapi::foot) > 12 - 1e-9 && toInches(okapi::foot) < 12 + 1e-9, "a foot is 12 inches");
+static_assert(toDegrees(okapi::degree*90) > 90 - 1e-9 && toDegrees(okapi::degree*90) < 90 + 1e-9, "a right angle is 90 degrees");
+/**
+ * The pose as quantities (refer to PoseSnapshot)
+ */
+inline okapi::QLength getPoseX(const PoseSnapshot &pose){
+  return pose.x*okapi::inch;
+}
+inline okapi::QLength getPoseY(const PoseSnapshot &pose){
+  return pose.y*okapi::inch;
+}
+inline okapi::QAngle getPoseHeading(const PoseSnapshot &pose){
+  return pose.angle*okapi::radian;
+}
+inline okapi::QSpeed getPoseSpeed(const PoseSnapshot &pose){
+  return pose.linVel*okapi::inch/okapi::second;
+}
+/**
+ * Movement functions on quantities (refer to baseControl.cpp and motionQueue.cpp)
+ */
+inline void baseMove(okapi::QLength dis, double kp, double kd){
+  baseMove(toInches(dis), kp, kd);
+}
+inline void baseMove(okapi::QLength dis){
+  baseMove(toInches(dis));
+}
+inline void baseMove(okapi::QLength x, okapi::QLength y, double kp, double kd){
+  baseMove(toInches(x), toInches(y), kp, kd);
+}
+inline void baseMove(okapi::QLength x, okapi::QLength y){
+  baseMove(toInches(x), toInches(y));
+}
+inline void baseTranslate(okapi::QLength x, okapi::QLength y){
+  baseTranslate(toInches(x), toInches(y));
+}
+inline void baseStrafe(okapi::QLength dis){
+  baseStrafe(toInches(dis));
+}
+inline void baseTurn(okapi::QAngle angle, double kp, double kd, TurnDirection direction = TURN_SHORTEST){
+  baseTurn(toDegrees(angle), kp, kd, direction);
+}
+inline void baseTurn(okapi::QAngle angle, TurnDirection direction = TURN_SHORTEST){
+  baseTurn(toDegrees(angle), direction);
+}
+inline void baseTurnRelative(okapi::QAngle angle, double kp, double kd){
+  baseTurnRelative(toDegrees(angle), kp, kd);
+}
+inline void baseArc(okapi::QLength radius, okapi::QAngle angle, double kp, double kd){
+  baseArc(toInches(radius), toDegrees(angle), kp, kd);
+}
+inline void baseArc(okapi::QLength radius, okapi::QAngle angle){
+  baseArc(toInches(radius), toDegrees(angle));
+}
+inline void baseSwing(okapi::QAngle angle, BaseSide pivot){
+  baseSwing(toDegrees(angle), pivot);
+}
+inline void setCoords(okapi::QLength x, okapi::QLength y, okapi::QAngle angle){
+  setCoords(toInches(x), toInches(y), toDegrees(angle));
+}
+inline bool queueMove(okapi::QLength dis, double kp = GAIN_SCHEDULED, double kd = GAIN_SCHEDULED, SettleRule settle = DEFAULT_SETTLE_RULE){
+  return queueMove(toInches(dis), kp, kd, settle);
+}
+inline bool queueMoveTo(okapi::QLength x, okapi::QLength y, double kp = GAIN_SCHEDULED, double kd = GAIN_SCHEDULED, SettleRule settle = DEFAULT_SETTLE_RULE){
+  return queueMoveTo(toInches(x), toInches(y), kp, kd, settle);
+}
+inline bool queueTurn(okapi::QAngle angle, double kp = GAIN_SCHEDULED, double kd = GAIN_SCHEDULED, SettleRule settle = DEFAULT_SETTLE_RULE){
+  return queueTurn(toDegrees(angle), kp, kd, settle);
+}
+inline bool queueTurnRelative(okapi::QAngle angle, double kp = GAIN_SCHEDULED, double kd = GAIN_SCHEDULED, SettleRule settle = DEFAULT_SETTLE_RULE){
+  return queueTurnRelative(toDegrees(angle), kp, kd, settle);
+}
+inline bool queueSwing(okapi::QAngle angle, BaseSide pivot, double kp = GAIN_SCHEDULED, double kd = GAIN_SCHEDULED, SettleRule settle = DEFAULT_SETTLE_RULE){
+  return queueSwing(toDegrees(angle), pivot, kp, kd, settle);
+}
+
+#endif
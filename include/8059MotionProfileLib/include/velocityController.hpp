@@ -0,0 +1,47 @@
+/**
+ * Header file for velocityController.cpp
+ * Defines class VelocityController, a velocity PD controller with feedforward for flywheels and rollers
+ * (modelled on okapi's IterativeVelPIDController with VelMath: the velocity is estimated from
+ * the motor position, averaged over the last samples)
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_VELOCITY_CONTROLLER_HPP_
+#define _8059_MOTION_PROFILE_LIB_VELOCITY_CONTROLLER_HPP_
+#include "8059MotionProfileLib/include/settleDetector.hpp"
+#include "8059MotionProfileLib/include/filterPipeline.hpp"
+#include <cstdint>
+// Number of velocity samples averaged by the estimate (okapi's VelMath default is 2)
+#define VELOCITY_FILTER_SIZE 4
+// Largest output power
+#define VELOCITY_MAX_POW 127
+/**
+ * The class VelocityController is stepped with the motor position every tick and returns the power
+ * to apply: kV*target + kP*error + kD*d(error)/dt, with the error in rpm.
+ * It is at speed once the error has stayed within its ready rule (refer to SettleDetector).
+ */
+class VelocityController{
+public:
+  /**
+   * refer to velocityController.cpp for function documentation
+   */
+  VelocityController(double ticksPerRev, double kP, double kD, double kV, const SettleRule &ready);
+  void setTarget(double rpm);
+  double getTarget();
+  double step(double position, uint64_t now);
+  double getVelocity();
+  bool isAtSpeed();
+  void reset();
+private:
+  double ticksPerRev, kP, kD, kV;
+  double target;
+  /** average of the speed samples (rpm) */
+  Mean<VELOCITY_FILTER_SIZE> speedFilter;
+  /** position & time (micros) of the previous step */
+  double prevPosition;
+  uint64_t prevTime;
+  bool hasPrev;
+  double velocity, prevError, output;
+  bool atSpeed;
+  SettleDetector ready;
+};
+
+#endif
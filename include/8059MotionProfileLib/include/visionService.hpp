@@ -0,0 +1,118 @@
+/**
+ * Header file for visionService.cpp
+ * Defines the vision service: one task reads the objects of the goal and ball signatures from the
+ * vision sensor into a preallocated buffer, filters them and publishes, per target, a timestamped
+ * bearing and distance together with the target's field point (placed with the pose at the capture
+ * time from the pose history), so turns and the driver assist aim at where the target is now
+ * Targets that match a landmark of the field map also correct the odometry (refer to VISION_LANDMARK_CORRECTION).
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_VISION_SERVICE_HPP_
+#define _8059_MOTION_PROFILE_LIB_VISION_SERVICE_HPP_
+#include "8059MotionProfileLib/include/dashboard.hpp"
+#include "8059MotionProfileLib/include/seqlock.hpp"
+#include "pros/vision.h"
+#include <cstdint>
+// Objects read per signature and frame (largest first)
+#define VISION_MAX_OBJECTS 8
+/**
+ * Camera (the sensor is mounted on the robot's centre line, facing forward)
+ * VISION_FOV_DEG: horizontal field of view in degrees (VISION_FOV_WIDTH pixels)
+ * VISION_LATENCY: time from the capture of a frame to its read, in micros
+ */
+#define VISION_FOV_DEG 61
+#define VISION_LATENCY 30000
+/**
+ * Filter
+ * VISION_MIN_AREA: smallest object kept, in pixels (smaller blobs are noise)
+ * VISION_MAX_ASPECT: largest width/height (or height/width) ratio of a kept object
+ * VISION_TRACK_GATE: an object within this distance (inches) of the current target extends its track,
+ *   and is preferred over a larger one further away
+ * VISION_SMOOTHING: weight of a new frame in the target's field point (1: no smoothing)
+ * VISION_TARGET_TIMEOUT: age in ms after which a target is no longer trusted
+ */
+#define VISION_MIN_AREA 40
+#define VISION_MAX_ASPECT 3
+#define VISION_TRACK_GATE 6
+#define VISION_SMOOTHING 0.5
+#define VISION_TARGET_TIMEOUT 200
+/**
+ * Alignment (baseAlignVision), in degrees
+ * VISION_REAIM_ANGLE: re-aim once the bearing of the target's field point moved this far
+ *   (the distance from the apparent width is coarser, so it does not count)
+ * VISION_ALIGN_TOLERANCE: largest heading error accepted once the base settled
+ */
+#define VISION_REAIM_ANGLE 1
+#define VISION_ALIGN_TOLERANCE 2
+/**
+ * Targets: signature id (set in the vision utility) and width of the real object in inches
+ */
+enum VisionTargetType{
+  VISION_GOAL,
+  VISION_BALL,
+  VISION_TARGETS
+};
+#define VISION_GOAL_SIG 1
+#define VISION_GOAL_WIDTH 15
+#define VISION_BALL_SIG 2
+#define VISION_BALL_WIDTH 6.3
+/**
+ * Field map: landmarks of fixed, known position (refer to visionLandmarks in visionService.cpp)
+ * VISION_LANDMARKS: number of landmarks
+ * VISION_ORIGIN_X, VISION_ORIGIN_Y: odometry origin in inches from the field's bottom left corner
+ */
+#define VISION_LANDMARKS 9
+#define VISION_ORIGIN_X DASHBOARD_ORIGIN_X
+#define VISION_ORIGIN_Y DASHBOARD_ORIGIN_Y
+/**
+ * Odometry correction against the landmarks: every frame, each object that matches a landmark gives
+ * the difference between its expected and its observed bearing and distance. The differences are
+ * averaged over the matched objects, scaled by the gains and bounded, and the odometry task adds
+ * the result to its pose (refer to correctPose in baseOdometry.cpp).
+ * VISION_LANDMARK_CORRECTION: 0 off, 1 on
+ * VISION_LANDMARK_GATE: largest distance (inches) between an object's field point and its landmark
+ * VISION_LANDMARK_MAX_BEARING: largest bearing difference in degrees, VISION_LANDMARK_MAX_RANGE: largest
+ *   distance difference as a ratio of the expected distance (larger differences are outliers, e.g. another
+ *   robot in front of the landmark)
+ * VISION_CORRECTION_MAX_ANG_VEL: frames captured while turning faster (degrees per second) are not used
+ *   (the bearing is most sensitive to the capture time then)
+ * VISION_CORRECTION_ANGLE_GAIN: fraction of the bearing difference corrected per frame, on the heading
+ *   (or, with ODOM_USE_IMU, which keeps the heading, on the position across the line of sight)
+ * VISION_CORRECTION_RANGE_GAIN: fraction of the distance difference corrected per frame, along the line
+ *   of sight (the distance from the apparent width is coarse, so this gain is smaller)
+ * VISION_CORRECTION_MAX_ANGLE, VISION_CORRECTION_MAX_SHIFT: bounds of one correction (degrees, inches)
+ */
+#define VISION_LANDMARK_CORRECTION 1
+#define VISION_LANDMARK_GATE 12
+#define VISION_LANDMARK_MAX_BEARING 6
+#define VISION_LANDMARK_MAX_RANGE 0.25
+#define VISION_CORRECTION_MAX_ANG_VEL 90
+#define VISION_CORRECTION_ANGLE_GAIN 0.2
+#define VISION_CORRECTION_RANGE_GAIN 0.05
+#define VISION_CORRECTION_MAX_ANGLE 0.5
+#define VISION_CORRECTION_MAX_SHIFT 0.5
+/**
+ * A published target
+ * timestamp: capture time of the frame (micros)
+ * bearing: from the robot's heading at the capture, radians (positive: clockwise)
+ * distance: from the robot at the capture, inches (from the apparent width)
+ * x, y: field point of the target (odometry coordinates), smoothed along its track
+ */
+struct VisionTarget{
+  uint64_t timestamp;
+  float bearing, distance;
+  float x, y;
+};
+/** A landmark: target type and position in inches from the field's bottom left corner */
+struct VisionLandmark{
+  VisionTargetType type;
+  double x, y;
+};
+extern const VisionLandmark visionLandmarks[VISION_LANDMARKS];
+/**
+ * refer to visionService.cpp for function documentation
+ */
+bool getVisionTarget(VisionTargetType type, VisionTarget &target, uint32_t *version = NULL);
+bool baseAlignVision(VisionTargetType type, uint32_t timeout);
+void visionService(void * ignore);
+
+#endif
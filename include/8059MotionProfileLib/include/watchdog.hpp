@@ -0,0 +1,66 @@
+/**
+ * Header file for watchdog.cpp
+ * Defines the watchdog task that checks the heartbeat (the iterations counted by taskTiming) and the
+ * deadline misses of the real-time tasks, logs a task that stops or falls behind, and stops the base
+ * when the task the base depends on faults, so a stalled control loop never leaves the motors driving
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_WATCHDOG_HPP_
+#define _8059_MOTION_PROFILE_LIB_WATCHDOG_HPP_
+#include "8059MotionProfileLib/include/taskRegistry.hpp"
+#include <cstdint>
+/**
+ * WATCHDOG_ENABLED: 0 off, 1 watch the tasks of watchdogRules (refer to watchdog.cpp)
+ * WATCHDOG_GRACE: time in ms a task that becomes active has before its heartbeat is checked (its first
+ * iteration waits for the data it consumes)
+ * WATCHDOG_WINDOW: time in ms over which the deadline misses of a task are counted
+ */
+#define WATCHDOG_ENABLED 1
+#define WATCHDOG_GRACE 100
+#define WATCHDOG_WINDOW 500
+/** What the watchdog does when a task faults */
+enum WatchdogAction{
+  WATCHDOG_LOG,         // log only
+  WATCHDOG_STOP_BASE    // log, stop the base motors and abort the movement (while the base controller runs)
+};
+/** Task faults */
+enum WatchdogFault{
+  WATCHDOG_OK,
+  WATCHDOG_SILENT,      // no iteration for the rule's number of periods (stalled, blocked or exited)
+  WATCHDOG_LATE         // the rule's number of deadline misses within WATCHDOG_WINDOW
+};
+/**
+ * Watchdog rule of a task
+ * task, timing: the task and its timing statistics (refer to taskTiming.hpp)
+ * misses: periods without an iteration, and deadline misses within WATCHDOG_WINDOW, that make a fault
+ * action: what to do on a fault
+ */
+struct WatchdogRule{
+  RobotTaskId task;
+  TimedTask timing;
+  uint32_t misses;
+  WatchdogAction action;
+};
+/**
+ * The last fault
+ * task: the task (ROBOT_TASKS if none yet)
+ * fault: what it did
+ * silent: time since its last iteration at the fault (ms)
+ * misses: its deadline misses within WATCHDOG_WINDOW
+ * stopped: the base was stopped
+ * time: micros() of the fault
+ */
+struct WatchdogReport{
+  RobotTaskId task;
+  WatchdogFault fault;
+  uint32_t silent, misses;
+  bool stopped;
+  uint64_t time;
+};
+/**
+ * refer to watchdog.cpp for function documentation
+ */
+uint32_t getBaseFailsafeCount();
+WatchdogReport getWatchdogReport(uint32_t *count = NULL);
+void watchdog(void * ignore);
+
+#endif
@@ -76,14 +76,15 @@ void opcontrol(void);
 #ifdef __cplusplus
 /**
  * You can add C++-only headers here
+ * Only the headers the project uses (no bits/stdc++.h): every translation unit parses them, and
+ * main.h is precompiled (refer to USE_PCH in the Makefile)
  */
-#include "bits/stdc++.h"
 #include <cmath>
-#include <iostream>
-#include <vector>
+#include <cstdio>
+#include <cstring>
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
-//#include <iostream>
 #endif
 
 #endif  // _PROS_MAIN_H_
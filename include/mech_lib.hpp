@@ -1,13 +1,196 @@
 #ifndef _MECH_LIB_HPP_
 #define _MECH_LIB_HPP_
 
+// Maximum number of queued shooter commands
+#define SHOOTER_QUEUE_SIZE 16
+// Time in ms for a ball to reach the limit switch before the cycle is given up (no ball)
+#define SHOOTER_INDEX_TIMEOUT 1500
+// Time in ms for a ball to clear the limit switch before it is treated as jammed
+#define SHOOTER_FIRE_TIMEOUT 1000
+// Time in ms the indexer and shooter run backwards to clear a jam
+#define SHOOTER_JAM_REVERSE 200
+// Jam recoveries tried before the cycle is given up
+#define SHOOTER_JAM_RETRIES 2
+// Time in ms the rollers run backwards after a roller jam (the stall rule is DEFAULT_STALL_RULE)
+#define ROLLER_JAM_REVERSE 150
+/**
+ * Roller speed synchronized with the base (refer to intakeSync): the roller surface runs at
+ * INTAKE_SYNC_RATIO times the forward speed of the robot plus INTAKE_SYNC_OFFSET, so a ball is taken in
+ * at any driving speed without bouncing off
+ * INTAKE_SURFACE_PER_REV: roller surface travel in inches per revolution of the motor (the roller
+ *   circumference divided by the gear ratio)
+ * INTAKE_SYNC_RATIO: roller surface speed per forward speed of the robot
+ * INTAKE_SYNC_OFFSET: roller surface speed in inches per second at rest (and driving backwards)
+ * INTAKE_MAX_RPM: speed of the roller cartridge
+ */
+#define INTAKE_SURFACE_PER_REV 8.64
+#define INTAKE_SYNC_RATIO 1.2
+#define INTAKE_SYNC_OFFSET 10
+#define INTAKE_MAX_RPM 200
+/**
+ * Shooter velocity control (refer to VelocityController): target speed in rpm of the 600 rpm cartridge
+ * (without a goal, refer to setShooterGoal),
+ * gains, and the ready rule {error (rpm), derivative (rpm/s), time (ms), unused}
+ * A staged ball is only fired once the shooter is at speed.
+ */
+#define SHOOTER_RPM 500
+#define SHOOTER_KP 0.3
+#define SHOOTER_KD 0.002
+#define SHOOTER_KV (127.0/600)
+#define SHOOTER_READY_RULE {25, 1000, 50, 0}
+// Time in ms a staged ball waits for the shooter to reach speed before it is fired anyway
+#define SHOOTER_SPINUP_TIMEOUT 1500
+/**
+ * Shooter speed by distance to the goal (refer to setShooterGoal)
+ * SHOOTER_SPEED_TABLE: {distance to the goal (inches), rpm} by increasing distance, interpolated linearly
+ *   and held beyond both ends; measure the rpm that scores from a few spots and adjust
+ * SHOOTER_SPEED_STEP: the speed is rounded to this many rpm, so the pose noise does not keep
+ *   restarting the ready rule
+ */
+#define SHOOTER_SPEED_TABLE {{24, 400}, {48, 450}, {72, 500}, {108, 570}}
+#define SHOOTER_SPEED_STEP 10
+/**
+ * Burst fire (refer to burst): the shooter stays at speed and each staged ball fires as soon as
+ * SHOOTER_BURST_SPACING: least time in ms since the previous ball left (the flywheel recovers in between)
+ * SHOOTER_BURST_DROP: and the shooter is within this many rpm below its target (instead of the ready rule)
+ */
+#define SHOOTER_BURST_SPACING 150
+#define SHOOTER_BURST_DROP 60
+/**
+ * Indexing mode
+ * INDEXER_POSITION_CONTROL: 0 the indexer runs at PARAM_CYCLE_SPEED until the limit switch changes,
+ *   1 every advance is a profiled move of exactly one slot on the indexer's integrated encoder, held in between
+ *   (the slots must line up with the limit switch)
+ * INDEXER_SLOT: indexer travel in degrees from one ball slot to the next
+ * INDEXER_MAX_VEL, INDEXER_MAX_ACC: limits of the trapezoidal move, in degrees per second (squared)
+ * INDEXER_KP: rpm per degree of position error added to the velocity of the move
+ * INDEXER_SETTLE: position error in degrees within which a finished move is done
+ */
+#define INDEXER_POSITION_CONTROL 0
+#define INDEXER_SLOT 540
+#define INDEXER_MAX_VEL 3000
+#define INDEXER_MAX_ACC 30000
+#define INDEXER_KP 2
+#define INDEXER_SETTLE 10
+/**
+ * Color sorting thresholds, in calibrated high resolution counts of the color sensor
+ * (get_value_calibrated_HR: 1/16 of a 12 bit count, relative to the empty indexer at calibration)
+ * below COLOR_RED_THRESHOLD: red ball; below COLOR_BALL_THRESHOLD: blue ball; else no ball
+ * Measure both colors with getColorReading() and adjust.
+ */
+#define COLOR_RED_THRESHOLD -24000
+#define COLOR_BALL_THRESHOLD -8000
+// Readings the color sensor is classified on the median of (a single glitched reading does not restart the confirmation)
+#define COLOR_MEDIAN_SAMPLES 3
+// Consecutive samples (one per SHOOTER_DT) of a color before a ball is classified
+#define COLOR_CONFIRM_SAMPLES 3
+// Time in ms the shooter runs in reverse to eject a ball of the wrong color
+#define SORT_EJECT_TIME 300
+// Balls the robot holds (one per slot)
+#define BALL_CAPACITY 3
+// Roller current draw in mA above which a ball is in the rollers
+#define BALL_INTAKE_CURRENT 1500
+/**
+ * Scoring throughput (refer to getShooterMetrics)
+ * SHOOTER_VOLLEY_GAP: time in ms without a shot after which the shots so far are one volley (the balls scored
+ *   at one goal); a goal cycle runs from the last shot of a volley to the last shot of the next one
+ */
+#define SHOOTER_VOLLEY_GAP 1000
+
+/**
+ * States of the shooter state machine (stepped by shooterControl once per tick)
+ * SHOOTER_IDLE: waiting for a queued cycle
+ * SHOOTER_INDEXING: feeding the next ball up to the limit switch (and holding it there until the shooter is at speed)
+ * SHOOTER_FIRING: shooting the ball until it clears the limit switch
+ * SHOOTER_DISCARDING: ejecting balls (while setDiscard(true), or a ball of the other alliance's color)
+ * SHOOTER_JAM_RECOVERY: running backwards, then indexing again (after a ball stuck on the limit switch or an indexer stall)
+ */
+enum ShooterState{
+  SHOOTER_IDLE,
+  SHOOTER_INDEXING,
+  SHOOTER_FIRING,
+  SHOOTER_DISCARDING,
+  SHOOTER_JAM_RECOVERY
+};
+// Mechanism id of the shooter states on the run timeline (refer to timeline.hpp)
+#define SHOOTER_TIMELINE 0
+/** Point of SHOOTER_SPEED_TABLE: distance to the goal (inches) and shooter speed (rpm) */
+struct ShooterSpeedPoint{
+  double distance, rpm;
+};
+/** Ball colors; BALL_NONE as the sort color turns sorting off */
+enum BallColor{
+  BALL_NONE,
+  BALL_RED,
+  BALL_BLUE
+};
+/**
+ * Ball positions tracked by the shooter task, as bits of getBallSlots()
+ * BALL_SLOT_INTAKE: in the rollers (roller current), BALL_SLOT_INDEXER: at the color sensor,
+ * BALL_SLOT_STAGED: at the limit switch, ready to fire
+ */
+enum BallSlot{
+  BALL_SLOT_INTAKE = 1,
+  BALL_SLOT_INDEXER = 2,
+  BALL_SLOT_STAGED = 4
+};
+/**
+ * Throughput of the mechanisms since resetShooterMetrics, counted by the shooterControl task
+ * intaken, shot, discarded: balls taken in (at the color sensor), shot, and ejected
+ * jams: jam recoveries of the indexer and shooter, and roller reverse pulses
+ * lastIntakeToShot, meanIntakeToShot: time from a ball's intake to its shot (ms), of the latest ball and the mean
+ * cycles: goal cycles finished; lastCycle, meanCycle: their time (ms), of the latest and the mean
+ * lastShots: balls of the latest cycle's volley
+ * indexing, spinup, firing, stalled: time of the latest cycle (ms) spent bringing a ball up to the limit switch, with a
+ *   staged ball waiting for the shooter to reach speed, firing, and in jam recovery or a roller reverse pulse
+ */
+struct ShooterMetrics {
+  uint32_t intaken, shot, discarded, jams;
+  uint32_t lastIntakeToShot, meanIntakeToShot;
+  uint32_t cycles, lastCycle, meanCycle, lastShots;
+  uint32_t indexing, spinup, firing, stalled;
+};
+/** Commands queued by cycle, burst, setDiscard and forceStop */
+enum ShooterCommand{
+  SHOOTER_CYCLE,          // shoot one ball (queued cycles run back to back)
+  SHOOTER_BURST_CYCLE,    // shoot one ball of a burst (refer to burst)
+  SHOOTER_DISCARD_ON,
+  SHOOTER_DISCARD_OFF,
+  SHOOTER_SPIN_ON,        // keep the shooter at speed between cycles
+  SHOOTER_SPIN_OFF,
+  SHOOTER_STOP            // abort the current cycle and drop the queued ones
+};
+
 void intakeMove(int speed);
+void intakeSync();
+double intakeSyncSpeed(double velocity);
 
-void cycle();
+bool cycle();
+bool burst(int count);
 void setDiscard(bool value);
 void forceStop();
+void setShooterSpin(bool value);
+int getShooterPending();
+ShooterState getShooterState();
+bool isShooterReady();
+double getShooterVelocity();
+double shooterSpeedAt(double distance);
+void setShooterGoal(double x, double y);
+void clearShooterGoal();
+double getShooterTarget();
+double getBurstRate();
+bool waitShooter(uint32_t timeout);
+void calibrateColor();
+void setSortColor(BallColor alliance);
+BallColor getBallColor();
+int getColorReading();
+int getBallCount();
+uint32_t getBallSlots();
+bool isRobotFull();
+bool waitBallCount(int count, uint32_t timeout);
+ShooterMetrics getShooterMetrics();
+void resetShooterMetrics();
 void shooterControl(void * ignore);
-void shooterMotorControl(void * ignore);
 
 
 #endif
@@ -0,0 +1,226 @@
+/**
+ * Header file for the host simulation backend (simKernel.cpp, simDrivetrain.cpp)
+ * Stands in for libpros.a when the motion library is built for the computer with `make sim`:
+ * - a virtual clock and a cooperative, priority based task scheduler (simKernel.cpp)
+ * - a simulated drivetrain behind pros::Motor, pros::ADIEncoder and pros::Imu (simDrivetrain.cpp): a first order
+ *   model by default, or a detailed skid-steer model with traction, scrub and encoder steps (refer to SimDetail)
+ * - replay of flight records through the odometry and control stages (simReplay.cpp)
+ * - the golden path regression benchmark of the autonomous routines (simGolden.cpp)
+ * - the Monte Carlo robustness benchmark of the golden course, one simulation per process (simRobust.cpp)
+ * - the parameter optimizer, on the same process pool (simOptimize.cpp)
+ * Time only advances while every task is blocked, so a run takes as long as its computation,
+ * not as long as the match.
+ */
+#ifndef _8059_MOTION_PROFILE_LIB_SIM_BACKEND_HPP_
+#define _8059_MOTION_PROFILE_LIB_SIM_BACKEND_HPP_
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+// Physics step of the drivetrain model in micros
+#define SIM_STEP 1000
+// Time constant in seconds of the IMU's acceleration filter
+#define SIM_IMU_FILTER 0.01
+// Steps of true states kept for the delayed sensors (the vision sensor's VISION_LATENCY, the motor samples)
+#define SIM_PAST_STEPS 64
+// Period in ms of the smart motors' data updates (Motor::get_raw_position returns the last one)
+#define SIM_MOTOR_DT 10
+/**
+ * Field walls and motor current: the walls are the sides of the field (DASHBOARD_FIELD_SIZE), touched by
+ * the bumpers (frontOffset, backOffset and SIM_HALF_WIDTH from the tracking centre, inches); a base
+ * motor draws SIM_STALL_CURRENT (mA) at 12V stalled, which is also its current limit until one is set
+ * The battery stays at SIM_BATTERY_VOLTAGE (mV, simBatteryVoltage; a robustness run draws another) under any current;
+ * a voltage command is a fraction of it (12000 is all of it)
+ */
+#define SIM_HALF_WIDTH 9
+#define SIM_STALL_CURRENT 2500
+#define SIM_BATTERY_VOLTAGE 12800
+/**
+ * Replay tolerances (simReplay.cpp): largest accepted difference between the replayed and
+ * the recorded powers, motor velocities (rpm), positions (inches) and bearings (degrees)
+ * The pose tolerance allows for the replay integrating at the record rate (BASE_CONTROL_DT)
+ * instead of every odometry tick.
+ */
+#define REPLAY_POWER_TOLERANCE 1e-6
+#define REPLAY_VEL_TOLERANCE 1e-6
+#define REPLAY_POSE_TOLERANCE 0.05
+#define REPLAY_ANGLE_TOLERANCE 0.1
+/**
+ * Golden path benchmark (simGolden.cpp): a routine regresses when it finishes more than GOLDEN_TIME_TOLERANCE
+ * seconds later than its baseline, ends more than GOLDEN_POSE_TOLERANCE inches or GOLDEN_ANGLE_TOLERANCE
+ * degrees from the baseline's end pose, or peaks more than GOLDEN_POWER_TOLERANCE above the baseline's power
+ * GOLDEN_TIMEOUT: time limit (ms) of a routine and of its movements after it returns
+ * GOLDEN_SETTLE: pause (ms) between the routines, with the robot put back at the origin
+ * GOLDEN_COURSE: index of the course of the simulation (refer to goldenCourse), after the routine table
+ * GOLDEN_MOTION_MIN: peak base power below which a routine commanded no motion (e.g. a stub): it is not benchmarked
+ */
+#ifndef GOLDEN_PATH
+#define GOLDEN_PATH "sim/golden.txt"
+#endif
+#define GOLDEN_TIME_TOLERANCE 0.05
+#define GOLDEN_POSE_TOLERANCE 0.5
+#define GOLDEN_ANGLE_TOLERANCE 1
+#define GOLDEN_POWER_TOLERANCE 2
+#define GOLDEN_TIMEOUT 60000
+#define GOLDEN_SETTLE 200
+#define GOLDEN_COURSE AUTON_COUNT
+#define GOLDEN_MOTION_MIN 1
+/**
+ * Robustness benchmark (simRobust.cpp): the course (or a script) runs ROBUST_RUNS times (by default) on the
+ * detailed model with randomized conditions, and once without (its nominal run). A routine is fragile when the 90th percentile
+ * of its end pose's distance from the nominal end pose is over ROBUST_POSE_LIMIT inches or ROBUST_ANGLE_LIMIT
+ * degrees, or when a run does not finish within GOLDEN_TIMEOUT.
+ * Conditions of a run, drawn from its seed:
+ * - battery: uniform in ROBUST_BATTERY_MIN to ROBUST_BATTERY_MAX (mV)
+ * - wheel slip: traction, scrub and slip speed of SimDetail scaled by 1 +- ROBUST_TRACTION, ROBUST_SCRUB, ROBUST_SLIP (uniform)
+ * - sensors: tracking wheel scale of standard deviation ROBUST_TRACKING, IMU heading noise of ROBUST_IMU_NOISE
+ *   degrees per read, IMU drift of standard deviation ROBUST_IMU_DRIFT degrees per second (refer to SimNoise)
+ */
+#define ROBUST_RUNS 1000
+#define ROBUST_POSE_LIMIT 2
+#define ROBUST_ANGLE_LIMIT 3
+#define ROBUST_BATTERY_MIN 11200
+#define ROBUST_BATTERY_MAX 13000
+#define ROBUST_TRACTION 0.2
+#define ROBUST_SCRUB 0.3
+#define ROBUST_SLIP 0.3
+#define ROBUST_TRACKING 0.003
+#define ROBUST_IMU_NOISE 0.05
+#define ROBUST_IMU_DRIFT 0.01
+/**
+ * Parameter optimizer (simOptimize.cpp): a separable CMA-ES over live parameters (refer to optimizeParams), each
+ * candidate scored on the optimizer's course in the nominal conditions and OPTIMIZE_SEEDS randomized ones
+ * (refer to ROBUST_RUNS); the cost of a run is its time plus its errors at the ends of the legs, weighed in seconds
+ * OPTIMIZE_GENERATIONS: generations by default
+ * OPTIMIZE_POPULATION: candidates per generation
+ * OPTIMIZE_SIGMA: initial step size, as a fraction of the search ranges
+ * OPTIMIZE_POSE_WEIGHT: seconds per inch of error at the end of a move or a path
+ * OPTIMIZE_ANGLE_WEIGHT: seconds per degree of error at the end of a turn
+ * OPTIMIZE_FAILED_COST: cost of a run that does not finish
+ * OPTIMIZE_LEG_TIMEOUT: time limit of a leg of the course (ms)
+ */
+#define OPTIMIZE_GENERATIONS 30
+#define OPTIMIZE_POPULATION 12
+#define OPTIMIZE_SEEDS 3
+#define OPTIMIZE_SIGMA 0.3
+#define OPTIMIZE_POSE_WEIGHT 1
+#define OPTIMIZE_ANGLE_WEIGHT 0.2
+#define OPTIMIZE_FAILED_COST 1000
+#define OPTIMIZE_LEG_TIMEOUT 8000
+/**
+ * Drivetrain model parameters (a first order DC motor per side, like okapi's FlywheelSimulator
+ * without the arm): the side speed approaches freeRpm*voltage/12 with time constant tau
+ * freeRpm: motor free speed at 12V in rpm
+ * tau: time constant of the loaded drivetrain in seconds
+ * staticVolts: voltage lost to static friction
+ * velocityKP: gain of the motors' internal velocity controller (volts per rpm of error)
+ * widthScale: effective base width / baseWidth (wheel scrub in turns)
+ * trackingScale: tracking wheel distance / true distance (tracking wheel diameter error)
+ */
+struct SimConfig{
+  double freeRpm, tau, staticVolts, velocityKP;
+  double widthScale, trackingScale;
+};
+/**
+ * Detailed skid-steer model (`./bin/sim detailed <18|6> [command]`; a tank drive only, HOLONOMIC_BASE keeps the
+ * first order model): the wheels of each side and the robot's body move on their own, so the wheels can slip.
+ * - two motors per side, each with the torque-speed curve of its cartridge: stallTorque*(V/12 - speed/freeRpm),
+ *   held to the current limit the robot set (set_current_limit), less the gearbox friction (staticVolts)
+ * - traction: a side pushes the body with a force proportional to its slip (wheel surface speed less the ground
+ *   speed under it), up to traction*mass*g/2; beyond it the wheels spin (or lock) against the tiles
+ * - scrub: in a turn the wheels off the centre slide sideways, a yaw torque up to scrub*mass*g*wheelbase/2
+ * - rolling resistance of rolling*mass*g
+ * - the motor encoders read the wheels (slip included) in steps of the cartridge's counts; the tracking wheels,
+ *   the IMU and the pose follow the body
+ * The field walls stop the ground speed of a side; its wheels spin on if the motors beat the traction.
+ * freeRpm (SimConfig), stallTorque (Nm per motor), countsPerTurn: the cartridge (refer to simSetCartridge)
+ * mass (kg), inertia (yaw, kg m^2), wheelInertia (per side at the wheels with the rotors reflected, kg m^2)
+ * traction, scrub, rolling: friction coefficients; slipSpeed: slip in m/s at which the traction is all used
+ * wheelbase: distance between the front and the back wheels (m)
+ * The body is stepped SIM_DETAIL_SUBSTEPS times per SIM_STEP (the wheels are stiff against the tiles).
+ */
+struct SimDetail{
+  double stallTorque;
+  int countsPerTurn;
+  double mass, inertia, wheelInertia;
+  double traction, slipSpeed, scrub, rolling;
+  double wheelbase;
+};
+#define SIM_DETAIL_SUBSTEPS 4
+/**
+ * True state of the simulated robot
+ * x, y, angle: pose, in the conventions of the odometry (bearing clockwise from +y, radians)
+ * velL, velR: side speeds in rpm (motor shaft); velS: strafe speed in rpm of a holonomic base (HOLONOMIC_BASE)
+ * motorL, motorR: side motor positions in degrees
+ * distL, distR, distS: distance rolled by the tracking wheels in inches
+ * accelX, accelY: acceleration read by the IMU (g; x forward, y to the right, low-passed over SIM_IMU_FILTER)
+ * pitch, roll: tilt read by the IMU in degrees (the model drives flat; a test may tilt it)
+ * groundVel, yawRate: forward speed (m/s) and turn rate (rad/s, clockwise) of the body in the detailed model
+ */
+struct SimState{
+  double x, y, angle;
+  double velL, velR, velS;
+  double motorL, motorR;
+  double distL, distR, distS;
+  double accelX, accelY;
+  double pitch, roll;
+  double groundVel, yawRate;
+};
+/**
+ * Sensor noise (0 unless a robustness run draws it)
+ * imuNoise: standard deviation of each heading read of the IMU (degrees)
+ * imuDrift: drift of the IMU's heading (degrees per second)
+ */
+struct SimNoise{
+  double imuNoise, imuDrift;
+};
+extern SimConfig simConfig;
+extern SimDetail simDetail;
+extern SimNoise simNoise;
+extern bool simDetailed;
+extern double simBatteryVoltage;
+extern std::mt19937 simRandom;
+extern SimState simState;
+extern bool simWallClock;
+extern double simPeakVolts;
+/**
+ * simKernel.cpp
+ */
+void simStart();
+uint64_t simMicros();
+void simStop(int code);
+/**
+ * simDrivetrain.cpp
+ */
+void simStep(double dt);
+void simSetPose(double x, double y, double angleDeg);
+bool simSetCartridge(int ratio);
+/**
+ * simReplay.cpp
+ */
+int simReplay(const char *path);
+/**
+ * simGolden.cpp
+ */
+bool goldenRoutine(const AutonRoutine &routine);
+const char *goldenName(int id);
+void goldenStart(int id);
+int simGolden(bool update);
+/**
+ * simRobust.cpp
+ */
+void robustConditions(uint32_t seed);
+std::string simChildCommand(const char *self);
+int simChildWorkers();
+std::vector<std::vector<double>> simRunChildren(const std::vector<std::string> &commands);
+int simRobust(const char *self, int runs, const char *script);
+int simRobustRun(int id, uint32_t seed, const char *script);
+/**
+ * simOptimize.cpp
+ */
+void optimizeCourse(double &poseError, double &angleError);
+int simOptimize(const char *self, int generations);
+int simOptimizeRun(uint32_t seed, char **values, int count);
+int simOptimizeSave(char **values, int count);
+
+#endif
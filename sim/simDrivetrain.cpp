@@ -0,0 +1,561 @@
+/**
+ * Simulated drivetrain:
+ * - Side dynamics (first order DC motor model), the strafe of an X-drive, field walls and pose integration
+ * - Detailed skid-steer model: motor torque curves, wheel slip, scrub and encoder steps (refer to SimDetail)
+ * - pros::Motor, pros::ADIEncoder, pros::ADIUltrasonic, pros::Imu and pros::Vision backed by the model
+ *   (other devices read 0)
+ * - Controller, brain screen, microSD card and competition stubs
+ */
+#include "main.h"
+#include "simBackend.hpp"
+/** default parameters: green cartridge base (refer to SimConfig) */
+SimConfig simConfig = {200, 0.12, 0.35, 0.05, 1, 1};
+SimState simState = {};
+/** detailed model (off unless `./bin/sim detailed`): an 18:1 cartridge on a 15 lb robot with 2.75" wheels */
+SimDetail simDetail = {1.05, 900, 6.8, 0.12, 0.001, 1, 0.05, 0.15, 0.02, 0.28};
+bool simDetailed = false;
+SimNoise simNoise = {};
+double simBatteryVoltage = SIM_BATTERY_VOLTAGE;
+/** random source of the simulated conditions (seeded by a robustness run) */
+std::mt19937 simRandom;
+/** largest voltage applied to a base side so far (reset by the regression benchmark) */
+double simPeakVolts = 0;
+/** true states of the last SIM_PAST_STEPS steps, by step number (for the delayed sensors) */
+SimState simPast[SIM_PAST_STEPS];
+/**
+ * Smart port state
+ * velocityMode: command is a velocity (rpm) instead of a voltage (mV)
+ * positionOffset: subtracted from the reading (set by tare_position)
+ * brakeMode: set by set_brake_mode (reported only; the model always brakes on the back EMF)
+ * currentLimit: set by set_current_limit in mA (0: none set, SIM_STALL_CURRENT; only the detailed model holds to it)
+ */
+struct SimMotor{
+  bool reversed, velocityMode;
+  pros::motor_brake_mode_e_t brakeMode;
+  int32_t command, currentLimit;
+  double positionOffset;
+};
+SimMotor simMotors[22];
+/**
+ * @return
+ * which base side a smart port drives: -1 left, 1 right, 0 not a base motor
+ */
+int simSide(uint8_t port){
+  if(port == FLPort || port == BLPort) return -1;
+  if(port == FRPort || port == BRPort) return 1;
+  return 0;
+}
+/**
+ * @return
+ * direction in which a smart port drives the strafe of an X-drive (front left and back right forward):
+ * 1 or -1, 0 if not a base motor or the base is a tank drive
+ */
+int simStrafeSign(uint8_t port){
+  if(!HOLONOMIC_BASE) return 0;
+  if(port == FLPort || port == BRPort) return 1;
+  if(port == BLPort || port == FRPort) return -1;
+  return 0;
+}
+/**
+ * Voltage a motor applies (in the drive direction), including its velocity controller.
+ * @param motor
+ * the motor
+ *
+ * @param vel
+ * current speed of its side in rpm
+ */
+double simMotorVolts(const SimMotor &motor, double vel){
+  double sign = motor.reversed ? -1 : 1;
+  double volts = motor.velocityMode ? 12*motor.command*sign/simConfig.freeRpm + simConfig.velocityKP*(motor.command*sign - vel)
+                                    : motor.command*sign/1000.0*simBatteryVoltage/12000;
+  return fmax(-12, fmin(12, volts));
+}
+/**
+ * Step the speed of a side or of the strafe from the mean voltage of its motors (static friction, first order).
+ * @param volts
+ * mean voltage driving it
+ *
+ * @param vel
+ * its speed in rpm; updated
+ */
+void simStepSpeed(double volts, double &vel, double dt){
+  /** static friction holds a stopped side below staticVolts and opposes a moving one */
+  if(fabs(vel) < 0.5 && fabs(volts) <= simConfig.staticVolts) volts = -vel*12/simConfig.freeRpm;
+  else volts -= simConfig.staticVolts*((fabs(vel) < 0.5 ? volts : vel) < 0 ? -1 : 1);
+  vel += (simConfig.freeRpm*volts/12 - vel)*dt/simConfig.tau;
+}
+/**
+ * Set the cartridge of the base motors for the detailed model: its free speed, stall torque and encoder counts.
+ * @param ratio
+ * 18 (green, 200 rpm) or 6 (blue, 600 rpm)
+ *
+ * @return
+ * false for another ratio (nothing is changed)
+ */
+bool simSetCartridge(int ratio){
+  if(ratio != 18 && ratio != 6) return false;
+  simConfig.freeRpm = 3600.0/ratio;
+  simDetail.stallTorque = 0.35*ratio/6;
+  simDetail.countsPerTurn = 50*ratio;
+  return true;
+}
+/**
+ * Torque of a base motor at the wheels in the detailed model (refer to SimDetail).
+ * @param motor
+ * the motor
+ *
+ * @param vel
+ * current speed of its side's wheels in rpm
+ *
+ * @return
+ * torque in Nm (in the drive direction, before the gearbox friction)
+ */
+double simMotorTorque(const SimMotor &motor, double vel){
+  /** fraction of the stall torque, and of the stall current: the motor holds its current to the limit */
+  double load = simMotorVolts(motor, vel)/12 - vel/simConfig.freeRpm;
+  double limit = (motor.currentLimit > 0 ? motor.currentLimit : SIM_STALL_CURRENT)/(double)SIM_STALL_CURRENT;
+  return simDetail.stallTorque*fmax(-limit, fmin(limit, load));
+}
+/**
+ * Step the detailed model: the wheels of each side against the tiles, and the body (refer to SimDetail).
+ * The side speeds (simState.velL, velR) are those of the wheels; the body moves at simState.groundVel and yawRate.
+ */
+void simStepDetailed(double dt){
+  const double g = 9.81, radius = inPerDeg*toDeg*0.0254, width = baseWidth*0.0254;
+  double grip = simDetail.traction*simDetail.mass*g/2, friction = 2*simDetail.stallTorque*simConfig.staticVolts/12;
+  double h = dt/SIM_DETAIL_SUBSTEPS;
+  for(int step = 0; step < SIM_DETAIL_SUBSTEPS; step++){
+    double force[2];
+    for(int i = 0; i < 2; i++){
+      int side = i == 0 ? -1 : 1;
+      double &vel = side < 0 ? simState.velL : simState.velR;
+      double torque = 0;
+      for(int port = 1; port <= 21; port++){
+        if(simSide(port) == side) torque += simMotorTorque(simMotors[port], vel);
+      }
+      /** the slip of the side: surface speed of its wheels less the ground speed under them */
+      double slip = vel*2*M_PI/60*radius - (simState.groundVel - side*simState.yawRate*width/2);
+      force[i] = fmax(-grip, fmin(grip, grip*slip/simDetail.slipSpeed));
+      /** the gearbox friction holds stopped wheels below it and opposes turning ones */
+      double net = torque - force[i]*radius;
+      if(fabs(vel) < 0.5 && fabs(net) <= friction) vel = 0;
+      else vel += (net - friction*((fabs(vel) < 0.5 ? net : vel) < 0 ? -1 : 1))/simDetail.wheelInertia*h*60/(2*M_PI);
+    }
+    /** rolling resistance and scrub, smoothed through 0 over the slip speed so the body comes to rest */
+    double rolling = simDetail.rolling*simDetail.mass*g*fmax(-1, fmin(1, simState.groundVel/simDetail.slipSpeed));
+    double slide = simState.yawRate*simDetail.wheelbase/2;
+    double scrub = simDetail.scrub*simDetail.mass*g*simDetail.wheelbase/2*fmax(-1, fmin(1, slide/simDetail.slipSpeed));
+    simState.groundVel += (force[0] + force[1] - rolling)/simDetail.mass*h;
+    simState.yawRate += ((force[0] - force[1])*width/2 - scrub)/simDetail.inertia*h;
+  }
+  simPeakVolts = fmax(simPeakVolts, fmax(fabs(simMotorVolts(simMotors[FLPort], simState.velL)),
+    fabs(simMotorVolts(simMotors[FRPort], simState.velR))));
+}
+/**
+ * Step one side of the drivetrain.
+ * @param side
+ * -1 left, 1 right
+ *
+ * @param vel
+ * speed of the side in rpm; updated
+ */
+void simStepSide(int side, double &vel, double dt){
+  double volts = 0;
+  int motors = 0;
+  for(int port = 1; port <= 21; port++){
+    if(simSide(port) != side) continue;
+    /** the wheels of an X-drive also turn with the strafe */
+    volts += simMotorVolts(simMotors[port], vel + simStrafeSign(port)*simState.velS);
+    motors++;
+  }
+  volts /= motors;
+  simPeakVolts = fmax(simPeakVolts, fabs(volts));
+  simStepSpeed(volts, vel, dt);
+}
+/**
+ * Step the strafe of an X-drive: the motors driving it forward less those driving it back.
+ * @param vel
+ * strafe speed in rpm; updated
+ */
+void simStepStrafe(double &vel, double dt){
+  double volts = 0;
+  for(int port = 1; port <= 21; port++){
+    int sign = simStrafeSign(port);
+    if(sign == 0) continue;
+    double wheel = (simSide(port) < 0 ? simState.velL : simState.velR) + sign*simState.velS;
+    volts += sign*simMotorVolts(simMotors[port], wheel);
+  }
+  simStepSpeed(volts/4, vel, dt);
+}
+/**
+ * Whether a side pushes into a field wall: the bumper corner of the side on the side's way
+ * (front when driving forward, back when reversing) is at or beyond a wall and moving out of the field.
+ * @param side
+ * -1 left, 1 right
+ *
+ * @param vel
+ * speed of the side in rpm
+ */
+bool simAgainstWall(int side, double vel){
+  if(fabs(vel) < 1e-9) return false;
+  double forward = vel > 0 ? frontOffset : -backOffset, lateral = side*SIM_HALF_WIDTH;
+  double s = sin(simState.angle), c = cos(simState.angle);
+  /** the corner in field coordinates and its direction of travel */
+  double x = simState.x + DASHBOARD_ORIGIN_X + forward*s + lateral*c;
+  double y = simState.y + DASHBOARD_ORIGIN_Y + forward*c - lateral*s;
+  double dx = vel > 0 ? s : -s, dy = vel > 0 ? c : -c;
+  return (x <= 0 && dx < 0) || (x >= DASHBOARD_FIELD_SIZE && dx > 0) || (y <= 0 && dy < 0) || (y >= DASHBOARD_FIELD_SIZE && dy > 0);
+}
+/**
+ * Step the drivetrain model (called by the kernel while the clock advances).
+ * @param dt
+ * time step in seconds
+ */
+void simStep(double dt){
+  /** the strafe and the sides all step from the speeds of the previous step */
+  double velS = simState.velS;
+  bool detailed = simDetailed && !HOLONOMIC_BASE;
+  /** speeds of the ground under each side, in rpm of the wheels (the wheel speeds unless they slip) */
+  double groundL, groundR;
+  if(detailed){
+    simStepDetailed(dt);
+    const double rpmPerSpeed = 60/(2*M_PI*inPerDeg*toDeg*0.0254), halfWidth = baseWidth*0.0254/2;
+    groundL = (simState.groundVel + simState.yawRate*halfWidth)*rpmPerSpeed;
+    groundR = (simState.groundVel - simState.yawRate*halfWidth)*rpmPerSpeed;
+  }
+  else{
+    if(HOLONOMIC_BASE) simStepStrafe(velS, dt);
+    simStepSide(-1, simState.velL, dt);
+    simStepSide(1, simState.velR, dt);
+    simState.velS = velS;
+  }
+  /** a side pushing into a wall stops (the other side pivots the robot around it); the detailed model's wheels slip */
+  if(!detailed){
+    if(simAgainstWall(-1, simState.velL)) simState.velL = 0;
+    if(simAgainstWall(1, simState.velR)) simState.velR = 0;
+    groundL = simState.velL;
+    groundR = simState.velR;
+  }
+  else{
+    if(simAgainstWall(-1, groundL)) groundL = 0;
+    if(simAgainstWall(1, groundR)) groundR = 0;
+    const double speedPerRpm = 2*M_PI*inPerDeg*toDeg*0.0254/60;
+    simState.groundVel = (groundL + groundR)/2*speedPerRpm;
+    simState.yawRate = (groundL - groundR)*speedPerRpm/(baseWidth*0.0254);
+  }
+  /** rpm -> degrees & inches */
+  double degL = simState.velL*6*dt, degR = simState.velR*6*dt;
+  double disL = groundL*6*dt*inPerDeg, disR = groundR*6*dt*inPerDeg;
+  simState.motorL += degL;
+  simState.motorR += degR;
+  double deltaAngle = (disL - disR)/(baseWidth*(detailed ? 1 : simConfig.widthScale));
+  double dis = (disL + disR)/2, mid = simState.angle + deltaAngle/2;
+  /** the IMU's acceleration: change of the forward speed and centripetal acceleration, low-passed */
+  static double prevSpeed = 0;
+  double speed = dis/dt, share = fmin(1, dt/SIM_IMU_FILTER);
+  simState.accelX += ((speed - prevSpeed)/dt/IMPACT_G - simState.accelX)*share;
+  simState.accelY += (speed*deltaAngle/dt/IMPACT_G - simState.accelY)*share;
+  prevSpeed = speed;
+  simState.x += dis*sin(mid);
+  simState.y += dis*cos(mid);
+  simState.angle += deltaAngle;
+  if(HOLONOMIC_BASE){
+    /** the strafe moves the robot to the right of its heading (the walls do not stop it) and rolls the perpendicular wheel */
+    double disS = simState.velS*6*dt*inPerDeg;
+    simState.x += disS*cos(mid);
+    simState.y -= disS*sin(mid);
+    simState.distS += disS*simConfig.trackingScale;
+  }
+  /** the tracking wheels sit on the (unscrubbed) odometry base width */
+  simState.distL += (dis + deltaAngle*baseWidth/2)*simConfig.trackingScale;
+  simState.distR += (dis - deltaAngle*baseWidth/2)*simConfig.trackingScale;
+  simState.distS -= deltaAngle*perpOffset*simConfig.trackingScale;
+  /** the state at the end of this step (the kernel advances the clock after it) */
+  simPast[(simMicros()/SIM_STEP + 1)%SIM_PAST_STEPS] = simState;
+}
+/**
+ * Place the simulated robot (does not move the odometry; use setCoords for that).
+ */
+void simSetPose(double x, double y, double angleDeg){
+  simState.x = x;
+  simState.y = y;
+  simState.angle = angleDeg*toRad;
+}
+/**
+ * pros::Motor. Base motors read the position of their side; other motors do not move.
+ */
+pros::Motor::Motor(const std::uint8_t port, const motor_gearset_e_t gearset, const bool reverse, const motor_encoder_units_e_t encoder_units) : _port(port){
+  /** the right side motors face the other way, so the robot reverses them to drive forward */
+  simMotors[port].reversed = reverse != (simSide(port) > 0);
+}
+pros::Motor::Motor(const std::uint8_t port, const motor_gearset_e_t gearset, const bool reverse) : Motor(port, gearset, reverse, E_MOTOR_ENCODER_DEGREES){}
+pros::Motor::Motor(const std::uint8_t port, const motor_gearset_e_t gearset) : Motor(port, gearset, false, E_MOTOR_ENCODER_DEGREES){}
+pros::Motor::Motor(const std::uint8_t port, const bool reverse) : Motor(port, E_MOTOR_GEARSET_18, reverse, E_MOTOR_ENCODER_DEGREES){}
+pros::Motor::Motor(const std::uint8_t port) : Motor(port, E_MOTOR_GEARSET_18, false, E_MOTOR_ENCODER_DEGREES){}
+std::int32_t pros::Motor::operator=(std::int32_t voltage) const{ return move(voltage); }
+std::int32_t pros::Motor::move(std::int32_t voltage) const{ return move_voltage(voltage*12000/127); }
+std::int32_t pros::Motor::move_absolute(const double position, const std::int32_t velocity) const{ return PROS_ERR; }
+std::int32_t pros::Motor::move_relative(const double position, const std::int32_t velocity) const{ return PROS_ERR; }
+std::int32_t pros::Motor::move_velocity(const std::int32_t velocity) const{
+  simMotors[_port].velocityMode = true;
+  simMotors[_port].command = velocity;
+  return 1;
+}
+std::int32_t pros::Motor::move_voltage(const std::int32_t voltage) const{
+  simMotors[_port].velocityMode = false;
+  simMotors[_port].command = voltage;
+  return 1;
+}
+std::int32_t pros::Motor::modify_profiled_velocity(const std::int32_t velocity) const{ return PROS_ERR; }
+double pros::Motor::get_target_position(void) const{ return 0; }
+std::int32_t pros::Motor::get_target_velocity(void) const{ return simMotors[_port].velocityMode ? simMotors[_port].command : 0; }
+double pros::Motor::get_actual_velocity(void) const{
+  int side = simSide(_port);
+  double vel = side < 0 ? simState.velL : side > 0 ? simState.velR : 0;
+  return simMotors[_port].reversed ? -vel : vel;
+}
+/**
+ * @return
+ * current draw of the motor on a smart port in mA: for a base motor, proportional to the voltage not balanced by
+ * the back EMF, up to the stall current (the other motors do not move)
+ */
+int32_t simCurrentDraw(uint8_t port){
+  int side = simSide(port);
+  if(side == 0) return 0;
+  double vel = side < 0 ? simState.velL : simState.velR;
+  if(simDetailed) return lround(fabs(simMotorTorque(simMotors[port], vel))/simDetail.stallTorque*SIM_STALL_CURRENT);
+  double volts = simMotorVolts(simMotors[port], vel) - 12*vel/simConfig.freeRpm;
+  return lround(fmin(SIM_STALL_CURRENT, SIM_STALL_CURRENT*fabs(volts)/12));
+}
+std::int32_t pros::Motor::get_current_draw(void) const{ return simCurrentDraw(_port); }
+std::int32_t pros::Motor::get_direction(void) const{ return get_actual_velocity() < 0 ? -1 : 1; }
+double pros::Motor::get_efficiency(void) const{ return 100; }
+std::int32_t pros::Motor::is_over_current(void) const{ return 0; }
+std::int32_t pros::Motor::is_stopped(void) const{ return fabs(get_actual_velocity()) < 1; }
+std::int32_t pros::Motor::get_zero_position_flag(void) const{ return 0; }
+std::uint32_t pros::Motor::get_faults(void) const{ return 0; }
+std::uint32_t pros::Motor::get_flags(void) const{ return 0; }
+/**
+ * @param degrees
+ * position of a motor in degrees
+ *
+ * @return
+ * the position its encoder reads: in steps of the cartridge's counts in the detailed model, exact otherwise
+ */
+double simEncoderSteps(double degrees){
+  if(!simDetailed) return degrees;
+  return round(degrees*simDetail.countsPerTurn/360)*360/simDetail.countsPerTurn;
+}
+std::int32_t pros::Motor::get_raw_position(std::uint32_t* const timestamp) const{
+  /** the sample of the last SIM_MOTOR_DT update, in counts of the untared encoder */
+  uint32_t time = millis()/SIM_MOTOR_DT*SIM_MOTOR_DT;
+  if(timestamp != NULL) *timestamp = time;
+  const SimState &state = simPast[(uint64_t)time*1000/SIM_STEP%SIM_PAST_STEPS];
+  int side = simSide(_port);
+  double position = simEncoderSteps(side < 0 ? state.motorL : side > 0 ? state.motorR : 0);
+  return lround((simMotors[_port].reversed ? -position : position)*DRIVE_COUNTS_PER_DEG);
+}
+std::int32_t pros::Motor::is_over_temp(void) const{ return 0; }
+double pros::Motor::get_position(void) const{
+  int side = simSide(_port);
+  double position = simEncoderSteps(side < 0 ? simState.motorL : side > 0 ? simState.motorR : 0);
+  return (simMotors[_port].reversed ? -position : position) - simMotors[_port].positionOffset;
+}
+double pros::Motor::get_power(void) const{ return 0; }
+double pros::Motor::get_temperature(void) const{ return 25; }
+double pros::Motor::get_torque(void) const{ return 0; }
+std::int32_t pros::Motor::get_voltage(void) const{
+  const SimMotor &motor = simMotors[_port];
+  return motor.velocityMode ? 12000*motor.command/simConfig.freeRpm : motor.command;
+}
+std::int32_t pros::Motor::set_zero_position(const double position) const{
+  simMotors[_port].positionOffset += get_position() - position;
+  return 1;
+}
+std::int32_t pros::Motor::tare_position(void) const{ return set_zero_position(0); }
+std::int32_t pros::Motor::set_brake_mode(const motor_brake_mode_e_t mode) const{
+  simMotors[_port].brakeMode = mode;
+  return 1;
+}
+std::int32_t pros::Motor::set_current_limit(const std::int32_t limit) const{
+  simMotors[_port].currentLimit = limit;
+  return 1;
+}
+std::int32_t pros::Motor::set_encoder_units(const motor_encoder_units_e_t units) const{ return 1; }
+std::int32_t pros::Motor::set_gearing(const motor_gearset_e_t gearset) const{ return 1; }
+std::int32_t pros::Motor::set_pos_pid(const motor_pid_s_t pid) const{ return 1; }
+std::int32_t pros::Motor::set_pos_pid_full(const motor_pid_full_s_t pid) const{ return 1; }
+std::int32_t pros::Motor::set_vel_pid(const motor_pid_s_t pid) const{ return 1; }
+std::int32_t pros::Motor::set_vel_pid_full(const motor_pid_full_s_t pid) const{ return 1; }
+std::int32_t pros::Motor::set_reversed(const bool reverse) const{
+  simMotors[_port].reversed = reverse;
+  return 1;
+}
+std::int32_t pros::Motor::set_voltage_limit(const std::int32_t limit) const{ return 1; }
+pros::motor_brake_mode_e_t pros::Motor::get_brake_mode(void) const{ return simMotors[_port].brakeMode; }
+std::int32_t pros::Motor::get_current_limit(void) const{
+  return simMotors[_port].currentLimit > 0 ? simMotors[_port].currentLimit : SIM_STALL_CURRENT;
+}
+pros::motor_encoder_units_e_t pros::Motor::get_encoder_units(void) const{ return E_MOTOR_ENCODER_DEGREES; }
+pros::motor_gearset_e_t pros::Motor::get_gearing(void) const{ return E_MOTOR_GEARSET_18; }
+pros::motor_pid_full_s_t pros::Motor::get_pos_pid(void) const{ return motor_pid_full_s_t(); }
+pros::motor_pid_full_s_t pros::Motor::get_vel_pid(void) const{ return motor_pid_full_s_t(); }
+std::int32_t pros::Motor::is_reversed(void) const{ return simMotors[_port].reversed; }
+std::int32_t pros::Motor::get_voltage_limit(void) const{ return 12000; }
+std::uint8_t pros::Motor::get_port(void) const{ return _port; }
+/**
+ * Range of the ultrasonic sensor to the nearest field wall on its beam (the obstacles are not modelled)
+ * @return
+ * the reading (10000 per meter)
+ */
+std::int32_t simUltrasonic(){
+  double s = sin(simState.angle), c = cos(simState.angle);
+  double x = simState.x + DASHBOARD_ORIGIN_X + ultrasonicForward*s + ultrasonicLateral*c;
+  double y = simState.y + DASHBOARD_ORIGIN_Y + ultrasonicForward*c - ultrasonicLateral*s;
+  double beam = simState.angle + ultrasonicAngle*toRad;
+  double dx = sin(beam), dy = cos(beam), range = INFINITY;
+  if(dx > 0) range = fmin(range, (DASHBOARD_FIELD_SIZE - x)/dx);
+  if(dx < 0) range = fmin(range, -x/dx);
+  if(dy > 0) range = fmin(range, (DASHBOARD_FIELD_SIZE - y)/dy);
+  if(dy < 0) range = fmin(range, -y/dy);
+  return lround(range*254);
+}
+/**
+ * ADI: the tracking wheel encoders (by their top port) read the rolled distance, the ultrasonic sensor its range;
+ * other ports read 0
+ */
+pros::ADIPort::ADIPort(std::uint8_t port, adi_port_config_e_t type) : _port(port){}
+pros::ADIPort::ADIPort(void) : _port(0){}
+std::int32_t pros::ADIPort::get_value(void) const{ return _port == ultrasonicPort ? simUltrasonic() : 0; }
+pros::ADIUltrasonic::ADIUltrasonic(std::uint8_t port_ping, std::uint8_t port_echo) : ADIPort(port_ping){}
+pros::ADIAnalogIn::ADIAnalogIn(std::uint8_t port) : ADIPort(port){}
+std::int32_t pros::ADIAnalogIn::calibrate(void) const{ return 0; }
+std::int32_t pros::ADIAnalogIn::get_value_calibrated_HR(void) const{ return 0; }
+pros::ADIDigitalIn::ADIDigitalIn(std::uint8_t port) : ADIPort(port){}
+pros::ADIEncoder::ADIEncoder(std::uint8_t port_top, std::uint8_t port_bottom, bool reversed) : ADIPort(port_top){}
+std::int32_t pros::ADIEncoder::get_value(void) const{
+  double distance = _port == encdL_port ? simState.distL : _port == encdR_port ? simState.distR : _port == encdS_port ? simState.distS : 0;
+  return lround(distance/inPerDeg);
+}
+std::int32_t pros::ADIEncoder::reset(void) const{ return 1; }
+std::int32_t pros::c::adi_port_set_config(std::uint8_t port, adi_port_config_e_t type){ return 1; }
+std::int32_t pros::c::adi_digital_read(std::uint8_t port){ return 0; }
+/**
+ * pros::Vision: sees the landmarks of the field map (visionLandmarks) that are in view, from the true pose
+ * VISION_LATENCY ago, largest first (no other objects)
+ */
+pros::Vision::Vision(std::uint8_t port, vision_zero_e_t zero_point) : _port(port){}
+std::int32_t pros::Vision::read_by_sig(const std::uint32_t size_id, const std::uint32_t sig_id, const std::uint32_t object_count,
+    vision_object_s_t* const object_arr) const{
+  const double radPerPixel = VISION_FOV_DEG*toRad/VISION_FOV_WIDTH;
+  const SimState &state = simMicros() >= VISION_LATENCY ? simPast[((simMicros() - VISION_LATENCY)/SIM_STEP)%SIM_PAST_STEPS] : simState;
+  if(sig_id != VISION_GOAL_SIG || size_id > 0) return PROS_ERR;
+  std::uint32_t count = 0;
+  for(int i = 0; i < VISION_LANDMARKS && count < object_count; i++){
+    double dx = visionLandmarks[i].x - VISION_ORIGIN_X - state.x, dy = visionLandmarks[i].y - VISION_ORIGIN_Y - state.y;
+    double distance = hypot(dx, dy);
+    double bearing = angleDiff(atan2(dx, dy), state.angle);
+    /** out of view, or too close to fit in the frame */
+    if(fabs(bearing) > VISION_FOV_DEG*toRad/2 || distance < VISION_GOAL_WIDTH) continue;
+    vision_object_s_t object = {};
+    object.signature = sig_id;
+    object.width = lround(2*atan(VISION_GOAL_WIDTH/2.0/distance)/radPerPixel);
+    object.height = object.width;
+    object.x_middle_coord = lround(VISION_FOV_WIDTH/2.0 + bearing/radPerPixel);
+    object.y_middle_coord = VISION_FOV_HEIGHT/2;
+    object.left_coord = object.x_middle_coord - object.width/2;
+    object.top_coord = object.y_middle_coord - object.height/2;
+    /** insert, largest first */
+    std::uint32_t j = count++;
+    for(; j > 0 && object_arr[j - 1].width < object.width; j--) object_arr[j] = object_arr[j - 1];
+    object_arr[j] = object;
+  }
+  return count > 0 ? (std::int32_t)count : PROS_ERR;
+}
+/**
+ * pros::Imu: reads the true heading (with the noise of simNoise), acceleration and tilt, calibrated at once
+ */
+double simImuRotation(){
+  double rotation = simState.angle*toDeg;
+  if(simNoise.imuNoise == 0 && simNoise.imuDrift == 0) return rotation;
+  rotation += simNoise.imuDrift*simMicros()*1e-6;
+  if(simNoise.imuNoise > 0) rotation += std::normal_distribution<double>(0, simNoise.imuNoise)(simRandom);
+  return rotation;
+}
+std::int32_t pros::Imu::reset() const{ return 1; }
+double pros::Imu::get_rotation() const{ return simImuRotation(); }
+double pros::Imu::get_heading() const{ return boundDeg(simImuRotation()); }
+pros::c::quaternion_s_t pros::Imu::get_quaternion() const{ return pros::c::quaternion_s_t(); }
+pros::c::euler_s_t pros::Imu::get_euler() const{ return pros::c::euler_s_t(); }
+double pros::Imu::get_pitch() const{ return simState.pitch; }
+double pros::Imu::get_roll() const{ return simState.roll; }
+double pros::Imu::get_yaw() const{ return get_heading(); }
+pros::c::imu_gyro_s_t pros::Imu::get_gyro_rate() const{ return pros::c::imu_gyro_s_t(); }
+pros::c::imu_accel_s_t pros::Imu::get_accel() const{ return {simState.accelX, simState.accelY, 1}; }
+pros::c::imu_status_e_t pros::Imu::get_status() const{ return (pros::c::imu_status_e_t)0; }
+bool pros::Imu::is_calibrating() const{ return false; }
+/**
+ * Controller, brain screen, microSD card (RECORDER_PATH points to bin/) and competition control
+ */
+pros::Controller::Controller(controller_id_e_t id) : _id(id){}
+std::int32_t pros::Controller::clear(void){ return 1; }
+std::int32_t pros::Controller::set_text(std::uint8_t line, std::uint8_t col, const char* str){ return 1; }
+std::int32_t pros::Controller::is_connected(void){ return 1; }
+std::int32_t pros::Controller::get_analog(controller_analog_e_t channel){ return 0; }
+std::int32_t pros::Controller::get_digital(controller_digital_e_t button){ return 0; }
+bool pros::lcd::initialize(void){ return true; }
+bool pros::lcd::is_initialized(void){ return true; }
+bool pros::c::lcd_print(int16_t line, const char* fmt, ...){ return true; }
+/** LVGL (the autonomous selector, the dashboard) draws nothing */
+lv_style_t lv_style_plain, lv_style_plain_color;
+extern "C" lv_obj_t *lv_scr_act(void){ return NULL; }
+extern "C" lv_obj_t *lv_obj_create(lv_obj_t *parent, const lv_obj_t *copy){ return NULL; }
+extern "C" void lv_scr_load(lv_obj_t *scr){}
+extern "C" void lv_obj_set_pos(lv_obj_t *obj, lv_coord_t x, lv_coord_t y){}
+extern "C" void lv_obj_set_style(lv_obj_t *obj, lv_style_t *style){}
+extern "C" void lv_style_copy(lv_style_t *dest, const lv_style_t *src){ *dest = *src; }
+extern "C" lv_obj_t *lv_line_create(lv_obj_t *par, const lv_obj_t *copy){ return NULL; }
+extern "C" void lv_line_set_points(lv_obj_t *line, const lv_point_t *point_a, uint16_t point_num){}
+extern "C" lv_obj_t *lv_btnm_create(lv_obj_t *par, const lv_obj_t *copy){ return NULL; }
+extern "C" void lv_btnm_set_map(lv_obj_t *btnm, const char **map){}
+extern "C" void lv_btnm_set_action(lv_obj_t *btnm, lv_btnm_action_t action){}
+extern "C" void lv_btnm_set_toggle(lv_obj_t *btnm, bool en, uint16_t id){}
+extern "C" lv_obj_t *lv_label_create(lv_obj_t *par, const lv_obj_t *copy){ return NULL; }
+extern "C" void lv_label_set_static_text(lv_obj_t *label, const char *text){}
+extern "C" void lv_obj_set_size(lv_obj_t *obj, lv_coord_t w, lv_coord_t h){}
+extern "C" void lv_obj_align(lv_obj_t *obj, const lv_obj_t *base, lv_align_t align, lv_coord_t x_mod, lv_coord_t y_mod){}
+extern "C" void lv_obj_set_free_num(lv_obj_t *obj, LV_OBJ_FREE_NUM_TYPE free_num){}
+extern "C" LV_OBJ_FREE_NUM_TYPE lv_obj_get_free_num(const lv_obj_t *obj){ return 0; }
+extern "C" lv_obj_t *lv_btn_create(lv_obj_t *par, const lv_obj_t *copy){ return NULL; }
+extern "C" void lv_btn_set_action(lv_obj_t *btn, lv_btn_action_t type, lv_action_t action){}
+extern "C" lv_obj_t *lv_slider_create(lv_obj_t *par, const lv_obj_t *copy){ return NULL; }
+extern "C" void lv_slider_set_action(lv_obj_t *slider, lv_action_t action){}
+extern "C" int16_t lv_slider_get_value(const lv_obj_t *slider){ return 0; }
+extern "C" void lv_bar_set_value(lv_obj_t *bar, int16_t value){}
+extern "C" void lv_bar_set_range(lv_obj_t *bar, int16_t min, int16_t max){}
+extern "C" lv_obj_t *lv_chart_create(lv_obj_t *par, const lv_obj_t *copy){ return NULL; }
+extern "C" lv_chart_series_t *lv_chart_add_series(lv_obj_t *chart, lv_color_t color){ return NULL; }
+extern "C" void lv_chart_set_type(lv_obj_t *chart, lv_chart_type_t type){}
+extern "C" void lv_chart_set_point_count(lv_obj_t *chart, uint16_t point_cnt){}
+extern "C" void lv_chart_set_range(lv_obj_t *chart, lv_coord_t ymin, lv_coord_t ymax){}
+extern "C" void lv_chart_set_div_line_count(lv_obj_t *chart, uint8_t hdiv, uint8_t vdiv){}
+extern "C" void lv_chart_init_points(lv_obj_t *chart, lv_chart_series_t *ser, lv_coord_t y){}
+extern "C" void lv_chart_set_next(lv_obj_t *chart, lv_chart_series_t *ser, lv_coord_t y){}
+std::int32_t pros::usd::is_installed(void){ return 1; }
+std::uint8_t pros::competition::is_autonomous(void){ return 1; }
+/** a full battery (refer to simBatteryVoltage) */
+std::int32_t pros::battery::get_voltage(void){ return lround(simBatteryVoltage); }
+/** the draw of the base motors (the battery does not sag, so the battery model never fits a resistance) */
+std::int32_t pros::battery::get_current(void){
+  int32_t current = 0;
+  for(uint8_t port = 1; port <= 21; port++) current += simCurrentDraw(port);
+  return current;
+}
+/**
+ * Pathfinder is part of okapilib.a (V5 only): trajectory generation fails in the simulation
+ */
+int pathfinder_prepare(Waypoint *path, int path_length, void (*fit)(Waypoint,Waypoint,Spline*), int sample_count, double dt,
+    double max_velocity, double max_acceleration, double max_jerk, TrajectoryCandidate *cand){ return -1; }
+int pathfinder_generate(TrajectoryCandidate *c, Segment *segments){ return -1; }
+void pathfinder_modify_tank(Segment *original, int length, Segment *left, Segment *right, double wheelbase_width){}
+void pf_fit_hermite_cubic(Waypoint a, Waypoint b, Spline *s){}
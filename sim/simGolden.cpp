@@ -0,0 +1,210 @@
+/**
+ * Golden path regression benchmark (`./bin/sim golden`, or `make golden`):
+ * - Runs every autonomous routine of the table (auton_sets.cpp) end to end on the simulated drivetrain,
+ *   each from the origin at rest, except the tool routines (calibrations, tuner, macros, script), then the
+ *   course of the simulation (refer to goldenCourse)
+ * - Leaves out a routine that commands no motion (an empty stub): its baseline would be zeros, and any change
+ *   would pass against it; one that stops moving while it has a baseline regresses
+ * - Reports per routine the completion time, the end pose (and its odometry error) and the peak base power
+ * - Compares them against the stored baselines (GOLDEN_PATH), so a controller or planner change that
+ *   slows a routine or moves its end pose is caught before it reaches the robot
+ * `./bin/sim golden update` rewrites the baselines from the current tree.
+ */
+#include "main.h"
+#include "simBackend.hpp"
+/** routines that calibrate, tune or replay files rather than run a match (they would overwrite the saved data) */
+const char *goldenSkipped[] = {"Script", "Latency", "SysId", "OdomCal", "Macro", "MacroPath", "Tune"};
+/**
+ * Result of a routine
+ * time: seconds from the start until the routine returned and the base settled
+ * x, y, angle: true end pose (inches, degrees)
+ * power: peak base power (of 127, from the largest voltage applied to a side)
+ */
+struct GoldenResult{
+  char name[32];
+  double time, x, y, angle, power;
+};
+/**
+ * @return
+ * whether the routine is benchmarked
+ */
+bool goldenRoutine(const AutonRoutine &routine){
+  for(const char *name : goldenSkipped) if(strcmp(routine.name, name) == 0) return false;
+  return true;
+}
+/**
+ * The course of the simulation: the optimizer's (refer to optimizeCourse), so the baselines cover the moves, turns
+ * and pure pursuit even while the routines of the table are stubs; it ends with a turn, since the heading at the
+ * end of a path is not controlled.
+ */
+void goldenCourse(){
+  double poseError, angleError;
+  optimizeCourse(poseError, angleError);
+  baseTurn(-135);
+}
+/**
+ * @param id
+ * index into the routine table, or GOLDEN_COURSE
+ *
+ * @return
+ * name of the routine
+ */
+const char *goldenName(int id){
+  return id == GOLDEN_COURSE ? "Course" : autonRoutines[id].name;
+}
+/**
+ * Start a routine: runAuton, or the course.
+ * @param id
+ * index into the routine table, or GOLDEN_COURSE
+ */
+void goldenStart(int id){
+  if(id == GOLDEN_COURSE) goldenCourse();
+  else runAuton(id);
+}
+/**
+ * Put the robot back at the origin at rest, with the base holding and the odometry reset.
+ */
+void goldenReset(){
+  simState.velL = simState.velR = 0;
+  simState.groundVel = simState.yawRate = 0;
+  simSetPose(0, 0, 0);
+  resetCoords(0, 0, 0);
+  delay(GOLDEN_SETTLE);
+  simPeakVolts = 0;
+}
+/**
+ * Run a routine and wait until its movements are done.
+ * @param id
+ * index into the routine table, or GOLDEN_COURSE
+ *
+ * @param result
+ * written with the measurements
+ */
+void goldenRun(int id, GoldenResult &result){
+  goldenReset();
+  uint64_t start = simMicros();
+  startMatchClock();
+  goldenStart(id);
+  waitMotionQueue(GOLDEN_TIMEOUT);
+  Timer timer;
+  while(!isBaseSettled() && !timer.passed(GOLDEN_TIMEOUT)) delay(BASE_CONTROL_DT);
+  snprintf(result.name, sizeof(result.name), "%s", goldenName(id));
+  result.time = (simMicros() - start)*1e-6;
+  result.x = simState.x;
+  result.y = simState.y;
+  result.angle = simState.angle*toDeg;
+  result.power = simPeakVolts*127/12;
+}
+/**
+ * Load the baselines.
+ * @param baselines
+ * written with the baselines (at most AUTON_COUNT + 1: the routines and the course)
+ *
+ * @return
+ * number of baselines, -1 if there is no baseline file
+ */
+int loadGoldenBaselines(GoldenResult *baselines){
+  FILE *file = fopen(GOLDEN_PATH, "r");
+  if(file == NULL) return -1;
+  /** lines: name, time, x, y, angle and power, separated by tabs (the names contain spaces) */
+  char line[128];
+  int count = 0;
+  while(count < AUTON_COUNT + 1 && fgets(line, sizeof(line), file) != NULL){
+    GoldenResult &b = baselines[count];
+    if(sscanf(line, "%31[^\t]\t%lf\t%lf\t%lf\t%lf\t%lf", b.name, &b.time, &b.x, &b.y, &b.angle, &b.power) == 6) count++;
+  }
+  fclose(file);
+  return count;
+}
+/**
+ * Save the baselines.
+ * @return
+ * false if the file cannot be written
+ */
+bool saveGoldenBaselines(const GoldenResult *results, int count){
+  FILE *file = fopen(GOLDEN_PATH, "w");
+  if(file == NULL) return false;
+  for(int i = 0; i < count; i++){
+    const GoldenResult &r = results[i];
+    fprintf(file, "%s\t%.3f\t%.2f\t%.2f\t%.2f\t%.1f\n", r.name, r.time, r.x, r.y, r.angle, r.power);
+  }
+  fclose(file);
+  return true;
+}
+/**
+ * Compare a result against its baseline and print both.
+ * @return
+ * whether the routine regressed
+ */
+bool goldenCompare(const GoldenResult &r, const GoldenResult *baseline){
+  PoseSnapshot pose = getPose();
+  printf("%-10s %7.2fs  end (%6.2f, %6.2f, %7.2f)  odom error %5.2f in  peak power %5.1f", r.name, r.time,
+    r.x, r.y, r.angle, hypot(pose.x - r.x, pose.y - r.y), r.power);
+  if(baseline == NULL){
+    printf("\n");
+    return false;
+  }
+  double slower = r.time - baseline->time, moved = hypot(r.x - baseline->x, r.y - baseline->y);
+  double turned = fabs(angleDiff(r.angle*toRad, baseline->angle*toRad))*toDeg, harder = r.power - baseline->power;
+  bool regressed = slower > GOLDEN_TIME_TOLERANCE || moved > GOLDEN_POSE_TOLERANCE || turned > GOLDEN_ANGLE_TOLERANCE
+    || harder > GOLDEN_POWER_TOLERANCE;
+  printf("  %s (%+.2fs, %.2f in, %.2f deg, %+.1f power)\n", regressed ? "REGRESSED" : "ok", slower, moved, turned, harder);
+  return regressed;
+}
+/**
+ * Run the benchmark (the robot tasks must be running in the autonomous phase).
+ * The baselines are for the configured constants: a gain schedule, base model, odometry geometry or parameter
+ * file saved in bin/ (by tune, sysid, odomcal or a tuning session) is loaded by prepareAuton and changes the results.
+ * @param update
+ * rewrite the baselines instead of comparing against them
+ *
+ * @return
+ * exit code: 0 if no routine regressed (or the baselines were written), 1 if one did, 2 if the baselines are unusable
+ */
+int simGolden(bool update){
+  for(const char *path : {GAIN_FILE_PATH, BASE_MODEL_FILE_PATH, ODOM_GEOMETRY_FILE_PATH, PARAM_FILE_PATH, ROUTE_FILE_PATH}){
+    FILE *file = fopen(path, "r");
+    if(file == NULL) continue;
+    fclose(file);
+    printf("note: %s is loaded by the routines; the baselines are for the configured constants\n", path);
+  }
+  setAutonRoutines(autonRoutines, AUTON_COUNT);
+  GoldenResult baselines[AUTON_COUNT + 1], results[AUTON_COUNT + 1];
+  int baselineCount = update ? 0 : loadGoldenBaselines(baselines);
+  if(baselineCount < 0){
+    fprintf(stderr, "sim: no baselines in %s (run `./bin/sim golden update`)\n", GOLDEN_PATH);
+    return 2;
+  }
+  int count = 0, regressions = 0, idle = 0;
+  for(int i = 0; i <= GOLDEN_COURSE; i++){
+    if(i < AUTON_COUNT && !goldenRoutine(autonRoutines[i])) continue;
+    GoldenResult &r = results[count];
+    goldenRun(i, r);
+    const GoldenResult *baseline = NULL;
+    for(int j = 0; j < baselineCount; j++) if(strcmp(baselines[j].name, r.name) == 0) baseline = &baselines[j];
+    if(r.power < GOLDEN_MOTION_MIN){
+      bool stopped = !update && baseline != NULL;
+      printf("%-10s commands no motion, not benchmarked%s\n", r.name, stopped ? "  REGRESSED (it has a baseline)" : "");
+      if(stopped){
+        regressions++;
+        count++;
+      }
+      idle++;
+      continue;
+    }
+    count++;
+    if(goldenCompare(r, update ? NULL : baseline)) regressions++;
+    if(!update && baseline == NULL) printf("  %s has no baseline (run `./bin/sim golden update`)\n", r.name);
+  }
+  if(idle > 0) printf("warning: %d routines command no motion\n", idle);
+  if(update){
+    if(!saveGoldenBaselines(results, count)){
+      fprintf(stderr, "sim: cannot write %s\n", GOLDEN_PATH);
+      return 2;
+    }
+    printf("%d baselines written to %s\n", count, GOLDEN_PATH);
+    return 0;
+  }
+  printf("%d of %d routines regressed\n", regressions, count);
+  return regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,223 @@
+/**
+ * Simulation kernel:
+ * - Virtual clock (millis, micros) driving the drivetrain model
+ * - Cooperative scheduler: every pros::Task is a thread, but only one runs at a time
+ *   (the highest priority ready task, round robin among equals); a task runs until it blocks
+ * - pros::Task, delay, delay_until and the task notifications
+ */
+#include "main.h"
+#include "pros/apix.h"
+#include "pros/serial.h"
+#include "simBackend.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+/**
+ * One simulated task
+ * blocked: waiting for wakeTime (UINT64_MAX: forever) or, if waitingNotify, for a notification
+ * lastRun: order of the last switch to the task (round robin among equal priorities)
+ */
+struct SimTask{
+  std::condition_variable wake;
+  task_fn_t function;
+  void *parameters;
+  uint32_t priority;
+  bool blocked, waitingNotify, finished;
+  uint64_t wakeTime, lastRun;
+  uint32_t notifyValue;
+};
+std::mutex simMutex;
+std::vector<SimTask *> simTasks;
+SimTask *simCurrent = NULL;
+uint64_t simTime = 0, simSwitches = 0;
+/** micros() follows the computer's clock instead (for benchmarks) */
+bool simWallClock = false;
+/**
+ * @return
+ * simulated time in micros
+ */
+uint64_t simMicros(){
+  return simTime;
+}
+/**
+ * Advance the clock, stepping the drivetrain model every SIM_STEP.
+ * @param time
+ * new time in micros
+ */
+void simAdvance(uint64_t time){
+  while(simTime < time){
+    uint64_t step = time - simTime < SIM_STEP ? time - simTime : SIM_STEP;
+    simStep(step*1e-6);
+    simTime += step;
+  }
+}
+bool simReady(SimTask *task){
+  return !task->finished && (!task->blocked || task->wakeTime <= simTime || (task->waitingNotify && task->notifyValue > 0));
+}
+/**
+ * Hand the processor to the next ready task, advancing the clock if none is ready,
+ * and wait until self is scheduled again. Called with simMutex held after self set its state.
+ */
+void simSwitch(std::unique_lock<std::mutex> &lock, SimTask *self){
+  SimTask *next = NULL;
+  while(next == NULL){
+    for(SimTask *task : simTasks){
+      if(!simReady(task)) continue;
+      if(next == NULL || task->priority > next->priority || (task->priority == next->priority && task->lastRun < next->lastRun)) next = task;
+    }
+    if(next != NULL) break;
+    uint64_t earliest = UINT64_MAX;
+    for(SimTask *task : simTasks) if(!task->finished && task->wakeTime < earliest) earliest = task->wakeTime;
+    if(earliest == UINT64_MAX){
+      fprintf(stderr, "sim: every task is blocked forever\n");
+      simStop(1);
+    }
+    simAdvance(earliest);
+  }
+  next->blocked = next->waitingNotify = false;
+  next->lastRun = ++simSwitches;
+  simCurrent = next;
+  if(next == self) return;
+  next->wake.notify_one();
+  if(!self->finished) self->wake.wait(lock, [self]{return simCurrent == self;});
+}
+/**
+ * Block the current task until a time (or a notification).
+ */
+void simBlock(uint64_t wakeTime, bool waitNotify){
+  std::unique_lock<std::mutex> lock(simMutex);
+  SimTask *self = simCurrent;
+  self->blocked = true;
+  self->waitingNotify = waitNotify;
+  self->wakeTime = wakeTime;
+  simSwitch(lock, self);
+}
+/**
+ * Register the calling thread (main) as the first simulated task. Call before using the library.
+ */
+void simStart(){
+  std::unique_lock<std::mutex> lock(simMutex);
+  SimTask *task = new SimTask();
+  task->priority = TASK_PRIORITY_DEFAULT;
+  simTasks.push_back(task);
+  simCurrent = task;
+}
+/**
+ * End the simulation (the task threads are still parked, so skip the destructors).
+ * @param code
+ * exit code
+ */
+void simStop(int code){
+  fflush(stdout);
+  fflush(stderr);
+  std::_Exit(code);
+}
+/**
+ * The functions of libpros.a used by the library, on the virtual clock
+ */
+uint32_t pros::c::millis(){
+  return simTime/1000;
+}
+extern "C" uint64_t vexSystemHighResTimeGet(void){
+  if(simWallClock) return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  return simTime;
+}
+void pros::c::delay(const uint32_t milliseconds){
+  /** delay(0) yields to the other ready tasks of the same priority */
+  simBlock(simTime + milliseconds*1000ull, false);
+}
+void pros::c::task_delay(const uint32_t milliseconds){
+  pros::c::delay(milliseconds);
+}
+pros::task_t pros::c::task_get_current(){
+  return simCurrent;
+}
+uint32_t pros::c::task_notify(pros::task_t task){
+  std::unique_lock<std::mutex> lock(simMutex);
+  ((SimTask *)task)->notifyValue++;
+  return 1;
+}
+uint32_t pros::c::task_notify_take(bool clear_on_exit, uint32_t timeout){
+  SimTask *self = simCurrent;
+  if(self->notifyValue == 0 && timeout > 0) simBlock(timeout == TIMEOUT_MAX ? UINT64_MAX : simTime + timeout*1000ull, true);
+  std::unique_lock<std::mutex> lock(simMutex);
+  uint32_t value = self->notifyValue;
+  if(clear_on_exit) self->notifyValue = 0;
+  else if(value > 0) self->notifyValue--;
+  return value;
+}
+void pros::c::task_set_priority(pros::task_t task, uint32_t prio){
+  std::unique_lock<std::mutex> lock(simMutex);
+  ((SimTask *)task)->priority = prio;
+}
+extern "C" uint32_t uxTaskGetStackHighWaterMark(pros::task_t task){
+  /** host threads do not have FreeRTOS stacks */
+  return 0;
+}
+/** the kernel heap is the computer's memory (the display footprint reads 0) */
+extern "C" size_t xPortGetFreeHeapSize(void){
+  return 0;
+}
+extern "C" size_t xPortGetMinimumEverFreeHeapSize(void){
+  return 0;
+}
+int32_t pros::c::serctl(const uint32_t action, void* const extra_arg){
+  return 0;
+}
+/** nothing is ever received from the serial terminal */
+int32_t pros::c::fdctl(int file, const uint32_t action, void* const extra_arg){
+  return 0;
+}
+/** nothing is connected to the smart ports in generic serial mode: nothing is received, the writes are dropped */
+int32_t pros::c::serial_enable(uint8_t port){
+  return 1;
+}
+int32_t pros::c::serial_set_baudrate(uint8_t port, int32_t baudrate){
+  return 1;
+}
+int32_t pros::c::serial_get_read_avail(uint8_t port){
+  return 0;
+}
+int32_t pros::c::serial_get_write_free(uint8_t port){
+  return 1024;
+}
+int32_t pros::c::serial_read_byte(uint8_t port){
+  return -1;
+}
+int32_t pros::c::serial_read(uint8_t port, uint8_t* buffer, int32_t length){
+  return 0;
+}
+int32_t pros::c::serial_write(uint8_t port, uint8_t* buffer, int32_t length){
+  return length;
+}
+/**
+ * pros::Task: one thread per task, started when the scheduler first picks it
+ */
+pros::Task::Task(task_fn_t function, void* parameters, std::uint32_t prio, std::uint16_t stack_depth, const char* name){
+  std::unique_lock<std::mutex> lock(simMutex);
+  SimTask *simTask = new SimTask();
+  simTask->function = function;
+  simTask->parameters = parameters;
+  simTask->priority = prio;
+  simTask->lastRun = ++simSwitches;
+  simTasks.push_back(simTask);
+  task = simTask;
+  std::thread([simTask]{
+    {
+      std::unique_lock<std::mutex> lock(simMutex);
+      simTask->wake.wait(lock, [simTask]{return simCurrent == simTask;});
+    }
+    simTask->function(simTask->parameters);
+    std::unique_lock<std::mutex> lock(simMutex);
+    simTask->finished = true;
+    simSwitch(lock, simTask);
+  }).detach();
+}
+pros::Task::Task(task_fn_t function, void* parameters, const char* name)
+  : Task(function, parameters, TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT, name){}
+void pros::Task::delay_until(std::uint32_t* const prev_time, const std::uint32_t delta){
+  *prev_time += delta;
+  if(*prev_time*1000ull > simTime) simBlock(*prev_time*1000ull, false);
+}
@@ -0,0 +1,241 @@
+/**
+ * Host simulation entry point (`make sim`, then ./bin/sim):
+ * - Starts the registered tasks (taskRegistry.cpp) in the autonomous phase on the simulated drivetrain
+ * - Runs a test routine and prints, per movement, the settle time and the odometry error
+ * - The run is recorded to bin/runNNN.bin; `./bin/sim replay <file>` replays a run (refer to simReplay.cpp)
+ * - `./bin/sim trace <file>` exports the timeline of a run (bin/runNNN.tl, from the robot's card or the simulation)
+ *   to a Chrome trace file next to it (refer to timeline.hpp)
+ * - `./bin/sim bench` runs the microbenchmark suite on the computer's clock (refer to benchmark.hpp)
+ * - `./bin/sim accuracy` sweeps the approximate kernels against their references, and fails if one is over its limit
+ * - `./bin/sim tune` runs the base autotuner and writes bin/gains.txt (refer to gainTuner.hpp)
+ * - `./bin/sim sysid` characterizes the drivetrain model and writes bin/model.txt (refer to baseCharacterizer.hpp)
+ * - `./bin/sim odomcal` calibrates the odometry geometry from the bottom wall and writes bin/odometry.txt
+ *   (refer to calibrateOdometry; scale simConfig.trackingScale or widthScale to see it correct an error)
+ * - `./bin/sim macro` records a scripted driver macro to bin/macro.bin, replays it and follows its path (refer to inputMacro.hpp)
+ * - `./bin/sim golden [update]` runs the autonomous routines and the course against their baselines (refer to simGolden.cpp)
+ * - `./bin/sim latency` runs the actuation latency probe on the drivetrain model (refer to latencyProbe.hpp)
+ * - `./bin/sim chassis` runs the chassis benchmark on each backend linked in the build (refer to chassisBackend.hpp)
+ * - `./bin/sim script <file>` compiles and runs an autonomous script (refer to autonScript.hpp)
+ * - `./bin/sim route <file>` solves the fastest order of the skills goals in a goals file and writes
+ *   bin/route.txt, which the skills run follows (refer to routeOptimizer.hpp)
+ * - `./bin/sim bake <file>` prepares every routine and writes their trajectories and the skills route to a blob
+ *   for the robot's build (`make bake`, refer to bakedTrajectories.hpp); only the trajectories whose inputs changed
+ *   since the blob already in the file are generated
+ * - `./bin/sim lqr <file>` solves the LQR gains of the drivetrain model (bin/model.txt if `sysid` wrote it) per
+ *   velocity band and writes them to a header for the robot's build (`make lqr`, refer to lqrGains.hpp)
+ * - `./bin/sim detailed <18|6> [command]` runs the test routine or a command above on the detailed skid-steer model
+ *   with an 18:1 or a 6:1 cartridge (wheel slip, scrub, current limits and encoder steps, refer to SimDetail)
+ * - `./bin/sim robust [runs] [script]` runs the golden course (or a script) many times with randomized battery, wheel slip
+ *   and sensor noise, on every core, and reports which are fragile (refer to simRobust.cpp)
+ * - `./bin/sim optimize [generations]` searches the gain scales, ramp, profile limits and pure-pursuit lookahead on
+ *   every core and writes the best set to bin/params.txt (refer to simOptimize.cpp)
+ * Edit the routine (or simConfig, simDetail) to try gains and path timing on the computer.
+ */
+#include "main.h"
+#include "simBackend.hpp"
+#include <chrono>
+#include <string>
+/**
+ * Print the state after a movement.
+ * @param name
+ * name of the movement
+ *
+ * @param start
+ * simulated start time of the movement (micros)
+ */
+void simReport(const char *name, uint64_t start){
+  PoseSnapshot pose = getPose();
+  printf("%-10s %6.2fs  true (%6.2f, %6.2f, %7.2f)  odom (%6.2f, %6.2f, %7.2f)\n", name, (simMicros() - start)*1e-6,
+    simState.x, simState.y, simState.angle*toDeg, pose.x, pose.y, pose.angle*toDeg);
+}
+int main(int argc, char **argv){
+  const char *self = argv[0];
+  if(argc >= 3 && strcmp(argv[1], "detailed") == 0){
+    if(!simSetCartridge(atoi(argv[2]))){
+      fprintf(stderr, "sim: no %s:1 cartridge (18 or 6)\n", argv[2]);
+      return 2;
+    }
+    simDetailed = true;
+    /** the rest of the arguments are the command to run on the detailed model */
+    argc -= 2;
+    argv += 2;
+  }
+  if(argc == 3 && strcmp(argv[1], "replay") == 0) return simReplay(argv[2]);
+  if(argc == 3 && strcmp(argv[1], "trace") == 0){
+    std::string tracePath = argv[2];
+    tracePath = tracePath.substr(0, tracePath.rfind('.')) + ".json";
+    int count = exportTimeline(argv[2], tracePath.c_str());
+    if(count < 0){
+      fprintf(stderr, "sim: cannot export %s to %s\n", argv[2], tracePath.c_str());
+      return 2;
+    }
+    printf("%d events written to %s\n", count, tracePath.c_str());
+    return 0;
+  }
+  if(argc == 2 && strcmp(argv[1], "bench") == 0){
+    simStart();
+    simWallClock = true;
+    runBenchmarks(1000000);
+    simStop(0);
+  }
+  if(argc == 2 && strcmp(argv[1], "accuracy") == 0){
+    simStart();
+    simWallClock = true;
+    simStop(runAccuracySuite(ACCURACY_SAMPLES)? 0 : 1);
+  }
+  if(argc >= 2 && argc <= 4 && strcmp(argv[1], "robust") == 0){
+    return simRobust(self, argc >= 3 ? atoi(argv[2]) : ROBUST_RUNS, argc == 4 ? argv[3] : NULL);
+  }
+  if((argc == 2 || argc == 3) && strcmp(argv[1], "optimize") == 0){
+    return simOptimize(self, argc == 3 ? atoi(argv[2]) : OPTIMIZE_GENERATIONS);
+  }
+  auto wallStart = std::chrono::steady_clock::now();
+  simStart();
+  startRobotTasks();
+  enterPhase(PHASE_AUTON);
+  /** let the tasks start */
+  delay(50);
+  armAllocGuard();
+  if(argc == 2 && strcmp(argv[1], "tune") == 0){
+    autotuneBase();
+    simStop(0);
+  }
+  if(argc == 2 && strcmp(argv[1], "sysid") == 0){
+    characterizeBase();
+    simStop(0);
+  }
+  if(argc == 2 && strcmp(argv[1], "odomcal") == 0){
+    /** back bumper an inch off the bottom wall, facing the top wall */
+    simSetPose(0, backOffset + 1 - DASHBOARD_ORIGIN_Y, 0);
+    setCoords(0, backOffset + 1 - DASHBOARD_ORIGIN_Y, 0);
+    calibrateOdometry();
+    simStop(0);
+  }
+  if(argc == 2 && strcmp(argv[1], "macro") == 0){
+    /** drive forward, then curve right, as the controller samples of a driver */
+    const int8_t sticks[][2] = {{100, 0}, {100, 40}, {60, 0}};
+    ControllerState pad = {}, partner = {};
+    pad.connected = true;
+    DriverControls controls;
+    resetDriverControls(controls, pad);
+    /** opcontrol owns the base */
+    pauseBase(true);
+    startMacroRecording();
+    for(const int8_t *stick : sticks){
+      pad.axes[ANALOG_LEFT_Y] = stick[0];
+      pad.axes[ANALOG_RIGHT_X] = stick[1];
+      for(int i = 0; i < 100; i++){
+        recordMacroFrame(pad, partner);
+        runDriverControls(controls, pad, partner);
+        delay(CONTROLLER_DT);
+      }
+    }
+    pad = {};
+    runDriverControls(controls, pad, partner);
+    stopMacroRecording();
+    drivetrain.stop();
+    stopBase();
+    pauseBase(false);
+    delay(500);
+    PoseSnapshot recorded = getPose();
+    printf("recorded %d frames: pose %.2f %.2f %.1f\n", getMacroFrames(), recorded.x, recorded.y, recorded.angle*toDeg);
+    simSetPose(0, 0, 0);
+    setCoords(0, 0, 0);
+    delay(50);
+    if(!loadMacro()) simStop(2);
+    playMacro();
+    delay(500);
+    PoseSnapshot played = getPose();
+    printf("replayed: pose %.2f %.2f %.1f\n", played.x, played.y, played.angle*toDeg);
+    PursuitPoint points[MAX_PURSUIT_POINTS];
+    int count = getMacroWaypoints(points, MAX_PURSUIT_POINTS);
+    simSetPose(0, 0, 0);
+    setCoords(0, 0, 0);
+    delay(50);
+    runMacroPath();
+    PoseSnapshot followed = getPose();
+    printf("path of %d waypoints: end %.2f %.2f, pose %.2f %.2f\n", count, points[count - 1].x, points[count - 1].y, followed.x, followed.y);
+    simStop(0);
+  }
+  if((argc == 4 || argc == 5) && strcmp(argv[1], "robustrun") == 0){
+    simStop(simRobustRun(atoi(argv[2]), strtoul(argv[3], NULL, 10), argc == 5 ? argv[4] : NULL));
+  }
+  if(argc >= 3 && strcmp(argv[1], "optrun") == 0) simStop(simOptimizeRun(strtoul(argv[2], NULL, 10), argv + 3, argc - 3));
+  if(argc >= 2 && strcmp(argv[1], "optsave") == 0) simStop(simOptimizeSave(argv + 2, argc - 2));
+  if(argc >= 2 && strcmp(argv[1], "golden") == 0) simStop(simGolden(argc == 3 && strcmp(argv[2], "update") == 0));
+  if(argc == 2 && strcmp(argv[1], "latency") == 0){
+    probeBaseLatency();
+    simStop(0);
+  }
+  if(argc == 2 && strcmp(argv[1], "chassis") == 0){
+    compareChassisBackends();
+    simStop(0);
+  }
+  if(argc == 3 && strcmp(argv[1], "script") == 0){
+    if(!compileAutonScript(argv[2])) simStop(2);
+    printf("%d bytes of bytecode\n", getAutonScriptSize());
+    uint64_t start = simMicros();
+    runAutonScript();
+    waitMotionQueue(15000);
+    simReport("script", start);
+    simStop(0);
+  }
+  if(argc == 3 && strcmp(argv[1], "route") == 0){
+    SkillsRoute route;
+    if(!loadRoute(argv[2], route)){
+      fprintf(stderr, "sim: cannot read the goals in %s\n", argv[2]);
+      simStop(2);
+    }
+    double givenTime, time = optimizeRoute(route, givenTime);
+    if(time < 0 || !saveRoute(ROUTE_FILE_PATH, route, time)){
+      fprintf(stderr, "sim: no route through the goals of %s\n", argv[2]);
+      simStop(2);
+    }
+    if(givenTime >= 0) printf("given order: %.2f s\n", givenTime);
+    printf("fastest order: %.2f s, written to %s\n", time, ROUTE_FILE_PATH);
+    simStop(0);
+  }
+  if(argc == 3 && strcmp(argv[1], "bake") == 0){
+    setAutonRoutines(autonRoutines, AUTON_COUNT);
+    int reused = 0, count = bakeTrajectories(argv[2], AUTON_COUNT, &reused);
+    if(count < 0){
+      fprintf(stderr, "sim: cannot bake the trajectories into %s\n", argv[2]);
+      simStop(2);
+    }
+    printf("%d trajectories baked into %s (%d generated, %d unchanged)\n", count, argv[2], count - reused, reused);
+    simStop(0);
+  }
+  if(argc == 3 && strcmp(argv[1], "lqr") == 0){
+    loadBaseModel();
+    if(!writeLqrTable(argv[2])){
+      fprintf(stderr, "sim: cannot write the LQR gains to %s\n", argv[2]);
+      simStop(2);
+    }
+    printf("%d bands of LQR gains written to %s\n", LQR_BANDS, argv[2]);
+    simStop(0);
+  }
+  startRecorder();
+  uint64_t start = simMicros();
+  baseMove(24);
+  waitBase(3000);
+  simReport("move 24", start);
+  start = simMicros();
+  baseTurn(90);
+  waitBase(3000);
+  simReport("turn 90", start);
+  start = simMicros();
+  baseMove(24, 24);
+  waitBase(3000);
+  simReport("move to", start);
+  start = simMicros();
+  baseTurn(0);
+  waitBase(3000);
+  simReport("turn 0", start);
+  /** close the run file */
+  stopRecorder();
+  delay(2*RECORDER_DT);
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  printf("simulated %.2fs in %.3fs (%.0fx real time)\n", simMicros()*1e-6, wall, simMicros()*1e-6/wall);
+  if(ALLOC_GUARD) printAllocCounts();
+  simStop(0);
+}
@@ -0,0 +1,304 @@
+/**
+ * Parameter optimizer (`./bin/sim optimize [generations]`, on the 18:1 cartridge unless run as
+ * `./bin/sim detailed 6 optimize ...`):
+ * - Searches live parameters of the table (refer to optimizeParams: the scales of the scheduled gains, the ramp,
+ *   the straight profile limits and the pure-pursuit lookahead) with a separable CMA-ES: each generation samples
+ *   OPTIMIZE_POPULATION candidates around a mean, moves the mean towards the cheapest ones and adapts the step
+ *   size and the spread of each parameter
+ * - Each candidate runs the course (refer to optimizeCourse) on the detailed model, in the nominal conditions and
+ *   OPTIMIZE_SEEDS randomized ones shared by the candidates of its generation, so the candidates are compared on
+ *   the same floors; the runs are child processes on every core (refer to simRunChildren)
+ * - Writes the best candidate, if it beats the defaults, to the parameter file (PARAM_FILE_PATH, bin/params.txt):
+ *   the file the robot's parameter table loads from the microSD card (refer to loadParams)
+ */
+#include "main.h"
+#include "simBackend.hpp"
+#include <algorithm>
+#include <numeric>
+/**
+ * A parameter the optimizer searches
+ * param: the parameter
+ * min, max: search range (within the parameter's limits)
+ */
+struct OptimizeParam{
+  TunableParam param;
+  double min, max;
+};
+const OptimizeParam optimizeParams[] = {
+  {PARAM_GAIN_KP_SCALE, 0.5, 2},
+  {PARAM_GAIN_KD_SCALE, 0.25, 4},
+  {PARAM_RAMPING_POW, 2, 30},
+  {PARAM_PROFILE_MAX_VEL, 10, 36},
+  {PARAM_PROFILE_MAX_ACC, 20, 150},
+  {PARAM_PURSUIT_LOOKAHEAD, 6, 24}
+};
+#define OPTIMIZE_DIMENSIONS (int)(sizeof(optimizeParams)/sizeof(optimizeParams[0]))
+/** pure-pursuit leg of the course, from where the turns leave the robot */
+const PursuitPoint optimizePath[] = {{24, 24}, {24, 44}, {4, 52}, {-16, 40}};
+/**
+ * Run the course from the origin: the test routine of simMain (move 24, turn 90, move to (24, 24), turn 0), then
+ * a pure-pursuit path (optimizePath), each leg within OPTIMIZE_LEG_TIMEOUT.
+ * @param poseError
+ * written with the sum of the distances from the targets at the ends of the moves and the path (inches)
+ *
+ * @param angleError
+ * written with the sum of the heading errors at the ends of the turns (degrees)
+ */
+void optimizeCourse(double &poseError, double &angleError){
+  poseError = angleError = 0;
+  auto moved = [&](double x, double y){
+    waitBase(OPTIMIZE_LEG_TIMEOUT);
+    poseError += hypot(simState.x - x, simState.y - y);
+  };
+  auto turned = [&](double angleDeg){
+    waitBase(OPTIMIZE_LEG_TIMEOUT);
+    angleError += fabs(angleDiff(angleDeg*toRad, simState.angle))*toDeg;
+  };
+  baseMove(24);
+  moved(0, 24);
+  baseTurn(90);
+  turned(90);
+  baseMove(24, 24);
+  moved(24, 24);
+  baseTurn(0);
+  turned(0);
+  int count = sizeof(optimizePath)/sizeof(optimizePath[0]);
+  basePursuit(optimizePath, count);
+  moved(optimizePath[count - 1].x, optimizePath[count - 1].y);
+}
+/**
+ * Publish the values of a candidate (a child process, the robot tasks running).
+ * @param values
+ * the values of optimizeParams, as text
+ *
+ * @param count
+ * number of values
+ *
+ * @return
+ * false if there are not OPTIMIZE_DIMENSIONS numbers or the table refuses one
+ */
+bool optimizeApply(char **values, int count){
+  if(count != OPTIMIZE_DIMENSIONS) return false;
+  TunableParam params[OPTIMIZE_DIMENSIONS];
+  double numbers[OPTIMIZE_DIMENSIONS];
+  for(int i = 0; i < count; i++){
+    char *end;
+    numbers[i] = strtod(values[i], &end);
+    if(end == values[i] || *end != '\0') return false;
+    params[i] = optimizeParams[i].param;
+  }
+  return setParams(params, numbers, count);
+}
+/**
+ * Run the course once with a candidate and print its result (a child process of simOptimize; the robot tasks
+ * must be running in the autonomous phase).
+ * @param seed
+ * seed of the conditions of the run (refer to robustConditions)
+ *
+ * @param values, count
+ * the candidate (refer to optimizeApply)
+ *
+ * @return
+ * exit code: 0, or 2 if the candidate cannot be applied
+ */
+int simOptimizeRun(uint32_t seed, char **values, int count){
+  if(!optimizeApply(values, count)) return 2;
+  robustConditions(seed);
+  uint64_t start = simMicros();
+  double poseError, angleError;
+  optimizeCourse(poseError, angleError);
+  printf("result %.4f %.4f %.4f\n", (simMicros() - start)*1e-6, poseError, angleError);
+  return 0;
+}
+/**
+ * Save a candidate to the parameter file (a child process of simOptimize: the table saves what it publishes).
+ * @param values, count
+ * the candidate (refer to optimizeApply)
+ *
+ * @return
+ * exit code: 0, or 2 if the candidate cannot be applied or the file cannot be written
+ */
+int simOptimizeSave(char **values, int count){
+  return optimizeApply(values, count) && saveParams() ? 0 : 2;
+}
+/**
+ * @param x
+ * a candidate in search coordinates (0 to 1 across the range of each parameter)
+ *
+ * @return
+ * the values of its parameters (held within the ranges)
+ */
+std::vector<double> optimizeValues(const std::vector<double> &x){
+  std::vector<double> values(OPTIMIZE_DIMENSIONS);
+  for(int i = 0; i < OPTIMIZE_DIMENSIONS; i++){
+    const OptimizeParam &p = optimizeParams[i];
+    values[i] = p.min + fmax(0, fmin(1, x[i]))*(p.max - p.min);
+  }
+  return values;
+}
+/**
+ * Score candidates: each runs the course in the nominal conditions and OPTIMIZE_SEEDS randomized ones.
+ * @param self
+ * path of the simulation's executable (argv[0])
+ *
+ * @param candidates
+ * the values of the candidates (refer to optimizeValues)
+ *
+ * @param firstSeed
+ * seed of the first randomized conditions (the candidates share them)
+ *
+ * @return
+ * per candidate, its mean cost in seconds (refer to OPTIMIZE_POSE_WEIGHT)
+ */
+std::vector<double> optimizeCosts(const char *self, const std::vector<std::vector<double>> &candidates, uint32_t firstSeed){
+  std::vector<std::string> commands;
+  for(const std::vector<double> &values : candidates){
+    std::string args;
+    for(double value : values){
+      char number[32];
+      snprintf(number, sizeof(number), " %.6g", value);
+      args += number;
+    }
+    for(int run = 0; run <= OPTIMIZE_SEEDS; run++){
+      uint32_t seed = run == 0 ? 0 : firstSeed + run - 1;
+      commands.push_back(simChildCommand(self) + "optrun " + std::to_string(seed) + args);
+    }
+  }
+  std::vector<std::vector<double>> results = simRunChildren(commands);
+  std::vector<double> costs(candidates.size(), 0);
+  for(size_t job = 0; job < results.size(); job++){
+    const std::vector<double> &r = results[job];
+    double cost = r.size() == 3 ? r[0] + OPTIMIZE_POSE_WEIGHT*r[1] + OPTIMIZE_ANGLE_WEIGHT*r[2] : OPTIMIZE_FAILED_COST;
+    costs[job/(OPTIMIZE_SEEDS + 1)] += cost/(OPTIMIZE_SEEDS + 1);
+  }
+  return costs;
+}
+/**
+ * Print a candidate, one parameter per line.
+ */
+void optimizePrint(const std::vector<double> &values, const std::vector<double> &defaults){
+  for(int i = 0; i < OPTIMIZE_DIMENSIONS; i++){
+    printf("  %-18s %8.3f  (default %g)\n", getParamName(optimizeParams[i].param), values[i], defaults[i]);
+  }
+}
+/**
+ * Run the optimizer (before the robot tasks start: the runs are child processes).
+ * Separable CMA-ES (Ros & Hansen): the covariance of the samples is kept diagonal, which suits a handful of
+ * parameters with different scales and needs no eigendecomposition. A candidate outside the search ranges runs
+ * at the nearest edge, and pays OPTIMIZE_FAILED_COST times its squared distance from the ranges.
+ * @param self
+ * path of the simulation's executable (argv[0])
+ *
+ * @param generations
+ * number of generations
+ *
+ * @return
+ * exit code: 0 if a better parameter set was written, 1 if the defaults are kept, 2 if the runs or the file fail
+ */
+int simOptimize(const char *self, int generations){
+  if(generations < 1) return 2;
+  const int n = OPTIMIZE_DIMENSIONS, lambda = OPTIMIZE_POPULATION, mu = lambda/2;
+  /** recombination weights of the mu cheapest candidates, and the strategy's constants */
+  std::vector<double> weights(mu);
+  for(int i = 0; i < mu; i++) weights[i] = log(mu + 0.5) - log(i + 1);
+  double weightSum = std::accumulate(weights.begin(), weights.end(), 0.0), weightSquares = 0;
+  for(double &w : weights){
+    w /= weightSum;
+    weightSquares += w*w;
+  }
+  double mueff = 1/weightSquares;
+  double cs = (mueff + 2)/(n + mueff + 5), ds = 1 + 2*fmax(0, sqrt((mueff - 1)/(n + 1)) - 1) + cs;
+  double cc = (4 + mueff/n)/(n + 4 + 2*mueff/n);
+  double c1 = (n + 2)/3.0*2/((n + 1.3)*(n + 1.3) + mueff);
+  double cmu = fmin(1 - c1, (n + 2)/3.0*2*(mueff - 2 + 1/mueff)/((n + 2)*(n + 2) + mueff));
+  double chiN = sqrt(n)*(1 - 1.0/(4*n) + 1.0/(21*n*n));
+  /** state: mean, step size, diagonal covariance and the evolution paths, in search coordinates */
+  std::vector<double> mean(n), defaults(n), variance(n, 1), pathSigma(n, 0), pathC(n, 0);
+  for(int i = 0; i < n; i++){
+    const OptimizeParam &p = optimizeParams[i];
+    defaults[i] = getParam(p.param);
+    mean[i] = fmax(0, fmin(1, (defaults[i] - p.min)/(p.max - p.min)));
+  }
+  double sigma = OPTIMIZE_SIGMA;
+  std::mt19937 random(1);
+  std::normal_distribution<double> normal;
+  std::vector<double> best = defaults;
+  double bestCost = INFINITY;
+  printf("%d generations of %d candidates, %d runs each, on %d threads\n", generations, lambda, OPTIMIZE_SEEDS + 1,
+    simChildWorkers());
+  for(int generation = 0; generation < generations; generation++){
+    std::vector<std::vector<double>> z(lambda, std::vector<double>(n)), y = z, candidates(lambda);
+    std::vector<double> penalties(lambda, 0);
+    for(int k = 0; k < lambda; k++){
+      std::vector<double> x(n);
+      for(int i = 0; i < n; i++){
+        z[k][i] = normal(random);
+        y[k][i] = sqrt(variance[i])*z[k][i];
+        x[i] = mean[i] + sigma*y[k][i];
+        double outside = x[i] - fmax(0, fmin(1, x[i]));
+        penalties[k] += OPTIMIZE_FAILED_COST*outside*outside;
+      }
+      candidates[k] = optimizeValues(x);
+    }
+    std::vector<double> costs = optimizeCosts(self, candidates, 1 + generation*OPTIMIZE_SEEDS);
+    if(*std::min_element(costs.begin(), costs.end()) >= OPTIMIZE_FAILED_COST){
+      fprintf(stderr, "sim: no candidate finished the course\n");
+      return 2;
+    }
+    std::vector<int> order(lambda);
+    std::iota(order.begin(), order.end(), 0);
+    for(int k = 0; k < lambda; k++) costs[k] += penalties[k];
+    std::sort(order.begin(), order.end(), [&](int a, int b){ return costs[a] < costs[b]; });
+    if(penalties[order[0]] == 0 && costs[order[0]] < bestCost){
+      bestCost = costs[order[0]];
+      best = candidates[order[0]];
+    }
+    /** the mean moves to the weighted mean of the mu cheapest */
+    std::vector<double> yw(n, 0), zw(n, 0);
+    for(int j = 0; j < mu; j++){
+      for(int i = 0; i < n; i++){
+        yw[i] += weights[j]*y[order[j]][i];
+        zw[i] += weights[j]*z[order[j]][i];
+      }
+    }
+    double pathNorm = 0;
+    for(int i = 0; i < n; i++){
+      mean[i] = fmax(0, fmin(1, mean[i] + sigma*yw[i]));
+      pathSigma[i] = (1 - cs)*pathSigma[i] + sqrt(cs*(2 - cs)*mueff)*zw[i];
+      pathNorm += pathSigma[i]*pathSigma[i];
+    }
+    pathNorm = sqrt(pathNorm);
+    bool hsig = pathNorm/sqrt(1 - pow(1 - cs, 2*(generation + 1))) < (1.4 + 2.0/(n + 1))*chiN;
+    for(int i = 0; i < n; i++){
+      pathC[i] = (1 - cc)*pathC[i] + hsig*sqrt(cc*(2 - cc)*mueff)*yw[i];
+      double rankMu = 0;
+      for(int j = 0; j < mu; j++) rankMu += weights[j]*y[order[j]][i]*y[order[j]][i];
+      variance[i] = (1 - c1 - cmu)*variance[i] + c1*(pathC[i]*pathC[i] + (1 - hsig)*cc*(2 - cc)*variance[i])
+        + cmu*rankMu;
+    }
+    sigma *= exp(cs/ds*(pathNorm/chiN - 1));
+    printf("generation %2d  cheapest %6.2f s  median %6.2f s  best %6.2f s  step %.3f\n", generation + 1,
+      costs[order[0]], costs[order[lambda/2]], bestCost, sigma);
+    fflush(stdout);
+  }
+  /** the best and the defaults on conditions neither was chosen on */
+  std::vector<double> finalCosts = optimizeCosts(self, {best, defaults}, 1 + generations*OPTIMIZE_SEEDS);
+  printf("best: %.2f s against %.2f s with the defaults\n", finalCosts[0], finalCosts[1]);
+  optimizePrint(best, defaults);
+  if(finalCosts[0] >= finalCosts[1]){
+    printf("the defaults are kept, %s is not written\n", PARAM_FILE_PATH);
+    return 1;
+  }
+  std::string command = simChildCommand(self) + "optsave";
+  for(double value : best){
+    char number[32];
+    snprintf(number, sizeof(number), " %.6g", value);
+    command += number;
+  }
+  if(system((command + " > /dev/null 2>&1").c_str()) != 0){
+    fprintf(stderr, "sim: cannot write %s\n", PARAM_FILE_PATH);
+    return 2;
+  }
+  printf("written to %s (loaded by prepareAuton, or `load` from the serial terminal)\n", PARAM_FILE_PATH);
+  return 0;
+}
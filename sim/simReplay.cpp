@@ -0,0 +1,127 @@
+/**
+ * Replay of flight records (`./bin/sim replay <file>`):
+ * - Odometry: every recorded sensor frame goes through stepOdometry, starting from the first recorded pose
+ *   (and again from the recorded pose after each pose correction)
+ * - Control: the PD (on position loop cycles), velocity loop (BASE_CASCADE) and ramp stages rerun on the
+ *   recorded inputs of every autonomous cycle
+ * - Differences against the recorded poses and commands, so a change to either can be checked
+ *   against a real run without the robot
+ */
+#include "main.h"
+#include "simBackend.hpp"
+/**
+ * Inputs of the PD and ramp stages in a recorded frame (the outputs are left at 0).
+ * @param recorded
+ * the recorded frame
+ *
+ * @return
+ * frame as it was after the profile stage
+ */
+BaseControlFrame replayInputs(const BaseControlFrame &recorded){
+  BaseControlFrame frame = {};
+  frame.readTime = recorded.readTime;
+  frame.sensors = recorded.sensors;
+  frame.encdL = recorded.encdL;
+  frame.encdR = recorded.encdR;
+  frame.trackPosition = recorded.trackPosition;
+  frame.setpointEncdL = recorded.setpointEncdL;
+  frame.setpointEncdR = recorded.setpointEncdR;
+  frame.setpointVelL = recorded.setpointVelL;
+  frame.setpointVelR = recorded.setpointVelR;
+  frame.setpointAccL = recorded.setpointAccL;
+  frame.setpointAccR = recorded.setpointAccR;
+  frame.output = recorded.output;
+  frame.kp = recorded.kp;
+  frame.kd = recorded.kd;
+  frame.ffL = recorded.ffL;
+  frame.ffR = recorded.ffR;
+  frame.powerCap = recorded.powerCap;
+  frame.rampPow = recorded.rampPow;
+  frame.rampLimit = recorded.rampLimit;
+  frame.holdHeading = recorded.holdHeading;
+  frame.headingError = recorded.headingError;
+  frame.headingGain = recorded.headingGain;
+  frame.outer = recorded.outer;
+  return frame;
+}
+/**
+ * Replay a flight record and print the differences.
+ * @param path
+ * run file written by the flight recorder
+ *
+ * @return
+ * exit code: 0 if every difference is within the REPLAY tolerances, 1 if not, 2 if the file is unusable
+ */
+int simReplay(const char *path){
+  FILE *file = fopen(path, "rb");
+  if(file == NULL){
+    fprintf(stderr, "sim: cannot open %s\n", path);
+    return 2;
+  }
+  RecorderFileHeader header;
+  if(fread(&header, sizeof(header), 1, file) != 1 || header.magic != RECORDER_FILE_MAGIC
+    || header.version != RECORDER_FILE_VERSION || header.recordSize != sizeof(FlightRecord)){
+    fprintf(stderr, "sim: %s is not a flight record of this build\n", path);
+    fclose(file);
+    return 2;
+  }
+  /** integrate at the geometry of the run (applied at the first record, which reseeds the odometry) */
+  setOdometryGeometry(header.geometry);
+  FlightRecordReader reader = {file, {}, false};
+  FlightRecord record, prev;
+  OdometryState state = {};
+  int records = 0, controlCycles = 0, mismatches = 0;
+  double maxPower = 0, maxVel = 0, maxPose = 0, maxAngle = 0;
+  while(readFlightRecord(reader, record)){
+    /** odometry, from the first recorded pose and from the pose after a correction */
+    bool reseed = records == 0 || record.corrections != prev.corrections;
+    PoseSnapshot pose = stepOdometry(state, record.frame.sensors, reseed? &record.pose : NULL);
+    double poseDiff = hypot(pose.x - record.pose.x, pose.y - record.pose.y);
+    double angleError = fabs(angleDiff(pose.angle, record.pose.angle))*toDeg;
+    maxPose = fmax(maxPose, poseDiff);
+    maxAngle = fmax(maxAngle, angleError);
+    bool mismatch = poseDiff > REPLAY_POSE_TOLERANCE || angleError > REPLAY_ANGLE_TOLERANCE;
+    /** control, with the recorded previous frame (so every cycle is checked on its own) */
+    double powerDiff = 0, velDiff = 0;
+    if(records > 0 && record.mode == RECORDER_AUTON && prev.mode == RECORDER_AUTON){
+      BaseControlFrame frame = replayInputs(record.frame);
+      if(!frame.outer){
+        /** an inner cycle (BASE_CASCADE) carries the outputs of the position loop */
+        frame.errorEncdL = prev.frame.errorEncdL;
+        frame.errorEncdR = prev.frame.errorEncdR;
+        frame.targetPowerL = prev.frame.targetPowerL;
+        frame.targetPowerR = prev.frame.targetPowerR;
+        frame.velCmdL = prev.frame.velCmdL;
+        frame.velCmdR = prev.frame.velCmdR;
+        frame.targetVelL = prev.frame.targetVelL;
+        frame.targetVelR = prev.frame.targetVelR;
+      }
+#if BASE_FIXED_POINT
+      if(frame.outer) computeBasePDFixed(frame, prev.frame);
+      if(BASE_CASCADE) computeBaseVelocity(frame, prev.frame);
+      rampBasePowerFixed(frame, prev.frame);
+#else
+      if(frame.outer) computeBasePD(frame, prev.frame);
+      if(BASE_CASCADE) computeBaseVelocity(frame, prev.frame);
+      rampBasePower(frame, prev.frame);
+#endif
+      powerDiff = fmax(fabs(frame.powerL - record.frame.powerL), fabs(frame.powerR - record.frame.powerR));
+      velDiff = fmax(fabs(frame.targetVelL - record.frame.targetVelL), fabs(frame.targetVelR - record.frame.targetVelR));
+      maxPower = fmax(maxPower, powerDiff);
+      maxVel = fmax(maxVel, velDiff);
+      mismatch = mismatch || powerDiff > REPLAY_POWER_TOLERANCE || velDiff > REPLAY_VEL_TOLERANCE;
+      controlCycles++;
+    }
+    if(mismatch && ++mismatches <= 10){
+      printf("record %d (%.3fs): pose %.3f in %.3f deg, power %.6f, velocity %.6f rpm\n", records,
+        record.frame.readTime*1e-6, poseDiff, angleError, powerDiff, velDiff);
+    }
+    prev = record;
+    records++;
+  }
+  fclose(file);
+  printf("replayed %d records (%d control cycles): max difference pose %.4f in %.4f deg, power %.6f, velocity %.6f rpm\n",
+    records, controlCycles, maxPose, maxAngle, maxPower, maxVel);
+  printf("%d records outside the tolerances\n", mismatches);
+  return mismatches > 0 ? 1 : 0;
+}
@@ -0,0 +1,234 @@
+/**
+ * Monte Carlo robustness benchmark (`./bin/sim robust [runs] [script]`, on the 18:1 cartridge unless run as
+ * `./bin/sim detailed 6 robust ...`):
+ * - Runs the course of the golden benchmark (refer to goldenCourse), or the script given, many times on the
+ *   detailed model, each run with its own battery, wheel slip and sensor noise drawn from its seed (refer to ROBUST_RUNS)
+ * - The simulation is one process per run (the kernel and the robot's state are global): a pool of one thread
+ *   per core starts the runs as `./bin/sim detailed <cartridge> robustrun <routine> <seed> [script]` and reads
+ *   their results, so the runs spread over every core (refer to simRunChildren, also used by simOptimize.cpp)
+ * - Reports per routine the distributions of the completion time and of the end pose's distance from the
+ *   nominal run (seed 0, no randomization), and flags the fragile routines
+ */
+#include "main.h"
+#include "simBackend.hpp"
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+/**
+ * Result of a run
+ * time: seconds from the start until the routine returned and the base settled (-1: the run failed)
+ * x, y, angle: true end pose (inches, degrees)
+ * odomError: distance of the odometry's end pose from the true one (inches)
+ */
+struct RobustResult{
+  double time, x, y, angle, odomError;
+};
+/**
+ * Draw the conditions of a run (refer to ROBUST_RUNS).
+ * @param seed
+ * seed of the run (0: the nominal run, nothing is drawn)
+ */
+void robustConditions(uint32_t seed){
+  if(seed == 0) return;
+  simRandom.seed(seed);
+  auto spread = [](double range){ return std::uniform_real_distribution<double>(1 - range, 1 + range)(simRandom); };
+  simBatteryVoltage = std::uniform_real_distribution<double>(ROBUST_BATTERY_MIN, ROBUST_BATTERY_MAX)(simRandom);
+  simDetail.traction *= spread(ROBUST_TRACTION);
+  simDetail.scrub *= spread(ROBUST_SCRUB);
+  simDetail.slipSpeed *= spread(ROBUST_SLIP);
+  simConfig.trackingScale = std::normal_distribution<double>(1, ROBUST_TRACKING)(simRandom);
+  simNoise.imuNoise = ROBUST_IMU_NOISE;
+  simNoise.imuDrift = std::normal_distribution<double>(0, ROBUST_IMU_DRIFT)(simRandom);
+}
+/**
+ * Run a routine once and print its result (a child process of simRobust; the robot tasks must be running in
+ * the autonomous phase).
+ * @param id
+ * index into the routine table, or GOLDEN_COURSE (ignored with a script)
+ *
+ * @param seed
+ * seed of the conditions of the run
+ *
+ * @param script
+ * autonomous script to run instead of a routine (NULL: the routine)
+ *
+ * @return
+ * exit code: 0, or 2 if the routine or the script cannot be run
+ */
+int simRobustRun(int id, uint32_t seed, const char *script){
+  setAutonRoutines(autonRoutines, AUTON_COUNT);
+  if(script != NULL ? !compileAutonScript(script) : id < 0 || id > GOLDEN_COURSE) return 2;
+  robustConditions(seed);
+  uint64_t start = simMicros();
+  startMatchClock();
+  if(script != NULL) runAutonScript();
+  else goldenStart(id);
+  waitMotionQueue(GOLDEN_TIMEOUT);
+  Timer timer;
+  while(!isBaseSettled() && !timer.passed(GOLDEN_TIMEOUT)) delay(BASE_CONTROL_DT);
+  PoseSnapshot pose = getPose();
+  printf("result %.4f %.4f %.4f %.4f %.4f\n", (simMicros() - start)*1e-6, simState.x, simState.y, simState.angle*toDeg,
+    hypot(pose.x - simState.x, pose.y - simState.y));
+  return 0;
+}
+/**
+ * @return
+ * ratio of the cartridge the child runs use: this process's (`./bin/sim detailed <18|6> ...`), 18 by default
+ */
+int simChildCartridge(){
+  return simDetailed ? simDetail.countsPerTurn/50 : 18;
+}
+/**
+ * @param self
+ * path of the simulation's executable (argv[0])
+ *
+ * @return
+ * the start of the command line of a child run on the detailed model (refer to simChildCartridge)
+ */
+std::string simChildCommand(const char *self){
+  return std::string("'") + self + "' detailed " + std::to_string(simChildCartridge()) + " ";
+}
+/**
+ * @return
+ * threads of the pool that runs the child processes (one per core)
+ */
+int simChildWorkers(){
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+/**
+ * Run one child process.
+ * @param command
+ * its command line
+ *
+ * @return
+ * the numbers of the last "result" line it printed (empty if it printed none or exited with an error)
+ */
+std::vector<double> simChild(const std::string &command){
+  std::vector<double> result;
+  FILE *child = popen((command + " 2>/dev/null").c_str(), "r");
+  if(child == NULL) return result;
+  char line[256];
+  while(fgets(line, sizeof(line), child) != NULL){
+    if(strncmp(line, "result ", 7) != 0) continue;
+    result.clear();
+    char *end = line + 7;
+    for(char *start = end; ; start = end){
+      double value = strtod(start, &end);
+      if(end == start) break;
+      result.push_back(value);
+    }
+  }
+  if(pclose(child) != 0) result.clear();
+  return result;
+}
+/**
+ * Run child processes on a pool of simChildWorkers threads (the simulation is one process per run).
+ * @param commands
+ * their command lines
+ *
+ * @return
+ * per command, the numbers of its result (refer to simChild)
+ */
+std::vector<std::vector<double>> simRunChildren(const std::vector<std::string> &commands){
+  std::vector<std::vector<double>> results(commands.size());
+  std::atomic<size_t> next(0);
+  auto work = [&]{
+    for(size_t job = next++; job < commands.size(); job = next++) results[job] = simChild(commands[job]);
+  };
+  std::vector<std::thread> pool;
+  for(int i = 0; i < simChildWorkers(); i++) pool.emplace_back(work);
+  for(std::thread &thread : pool) thread.join();
+  return results;
+}
+/**
+ * @param values
+ * sorted values (not empty)
+ *
+ * @param fraction
+ * 0 to 1
+ *
+ * @return
+ * the value at that fraction of the distribution (nearest rank)
+ */
+double robustPercentile(const std::vector<double> &values, double fraction){
+  size_t rank = (size_t)ceil(fraction*values.size());
+  return values[std::min(std::max(rank, (size_t)1), values.size()) - 1];
+}
+/**
+ * Run the benchmark (before the robot tasks start: the runs are child processes).
+ * @param self
+ * path of the simulation's executable (argv[0])
+ *
+ * @param runs
+ * randomized runs per routine
+ *
+ * @param script
+ * autonomous script to benchmark instead of the course (NULL: the course)
+ *
+ * @return
+ * exit code: 0 if no routine is fragile, 1 if one is, 2 if the runs cannot be started
+ */
+int simRobust(const char *self, int runs, const char *script){
+  if(runs < 1) return 2;
+  /** the routines, by index into the routine table (GOLDEN_COURSE: the course, -1: the script) */
+  std::vector<int> routines = {script != NULL ? -1 : GOLDEN_COURSE};
+  /** the runs: per routine, the nominal run (seed 0) then the randomized ones; seeds differ across routines */
+  int perRoutine = runs + 1, total = routines.size()*perRoutine;
+  std::vector<std::string> commands;
+  for(int job = 0; job < total; job++){
+    int routine = routines[job/perRoutine], run = job%perRoutine;
+    uint32_t seed = run == 0 ? 0 : job + 1;
+    std::string command = simChildCommand(self) + "robustrun " + std::to_string(routine) + " " + std::to_string(seed);
+    if(script != NULL) command += std::string(" '") + script + "'";
+    commands.push_back(command);
+  }
+  printf("%d runs of %d routines on %d threads (%d:1 cartridge)\n", total, (int)routines.size(), simChildWorkers(),
+    simChildCartridge());
+  fflush(stdout);
+  std::vector<RobustResult> results;
+  for(const std::vector<double> &r : simRunChildren(commands)){
+    results.push_back(r.size() == 5 ? RobustResult{r[0], r[1], r[2], r[3], r[4]} : RobustResult{-1, 0, 0, 0, 0});
+  }
+  int fragile = 0;
+  for(size_t r = 0; r < routines.size(); r++){
+    const char *name = script != NULL ? "Script" : goldenName(routines[r]);
+    const RobustResult &nominal = results[r*perRoutine];
+    if(nominal.time < 0){
+      printf("%-10s nominal run failed\n", name);
+      fragile++;
+      continue;
+    }
+    std::vector<double> times, poseErrors, angleErrors, odomErrors;
+    int failures = 0;
+    for(int run = 1; run < perRoutine; run++){
+      const RobustResult &result = results[r*perRoutine + run];
+      if(result.time < 0 || result.time >= GOLDEN_TIMEOUT*1e-3){
+        failures++;
+        continue;
+      }
+      times.push_back(result.time);
+      poseErrors.push_back(hypot(result.x - nominal.x, result.y - nominal.y));
+      angleErrors.push_back(fabs(angleDiff(result.angle*toRad, nominal.angle*toRad))*toDeg);
+      odomErrors.push_back(result.odomError);
+    }
+    if(times.empty()){
+      printf("%-10s all %d runs failed  FRAGILE\n", name, runs);
+      fragile++;
+      continue;
+    }
+    for(std::vector<double> *values : {&times, &poseErrors, &angleErrors, &odomErrors}) std::sort(values->begin(), values->end());
+    bool isFragile = failures > 0 || robustPercentile(poseErrors, 0.9) > ROBUST_POSE_LIMIT
+      || robustPercentile(angleErrors, 0.9) > ROBUST_ANGLE_LIMIT;
+    printf("%-10s time %.2f/%.2f/%.2fs  end error %.2f/%.2f/%.2f in  %.2f/%.2f/%.2f deg  odom error %.2f in (p90)"
+      "  %d failed  %s\n", name, robustPercentile(times, 0.5), robustPercentile(times, 0.9), times.back(),
+      robustPercentile(poseErrors, 0.5), robustPercentile(poseErrors, 0.9), poseErrors.back(),
+      robustPercentile(angleErrors, 0.5), robustPercentile(angleErrors, 0.9), angleErrors.back(),
+      robustPercentile(odomErrors, 0.9), failures, isFragile ? "FRAGILE" : "ok");
+    if(isFragile) fragile++;
+  }
+  printf("(median/p90/max of %d runs per routine against the nominal run)\n%d of %d routines fragile\n", runs, fragile,
+    (int)routines.size());
+  return fragile > 0 ? 1 : 0;
+}
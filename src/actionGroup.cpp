@@ -0,0 +1,151 @@
+/**
+ * Action group functions:
+ * - Trigger constructors
+ * - Trigger evaluation against the motion queue, the odometry and the mechanisms
+ * - Parallel and race runs
+ */
+#include "main.h"
+/** trigger constructors (refer to TriggerType) */
+ActionTrigger atOnce(){
+  return {TRIGGER_NOW, 0, 0};
+}
+ActionTrigger afterTime(uint32_t ms){
+  return {TRIGGER_TIME, 0, (double)ms};
+}
+ActionTrigger afterTravel(int motion, double inches){
+  return {TRIGGER_TRAVEL, motion, inches};
+}
+ActionTrigger afterMotion(int motion){
+  return {TRIGGER_MOTION_DONE, motion, 0};
+}
+ActionTrigger whenQueueIdle(){
+  return {TRIGGER_QUEUE_IDLE, 0, 0};
+}
+ActionTrigger whenShooterReady(){
+  return {TRIGGER_SHOOTER_READY, 0, 0};
+}
+ActionTrigger whenBalls(int count){
+  return {TRIGGER_BALLS, 0, (double)count};
+}
+/**
+ * Create an empty group. Motions queued after this are the group's motions 0, 1, ...
+ */
+ActionGroup::ActionGroup(){
+  uint32_t started;
+  getMotionSequence(firstMotion, started);
+  count = 0;
+  runStart = 0;
+  travelMotion = -1;
+  travelled = prevX = prevY = 0;
+}
+/**
+ * Add an action.
+ * @param trigger
+ * when to start it
+ *
+ * @param start
+ * the action (a function or lambda that returns at once, e.g. [power]{intakeMove(power);})
+ *
+ * @return
+ * false if the group is full
+ */
+bool ActionGroup::add(const ActionTrigger &trigger, InlineFunction<void()> start){
+  if(count >= ACTION_GROUP_SIZE) return false;
+  actions[count++] = {trigger, start, false};
+  return true;
+}
+/**
+ * @param trigger
+ * a trigger
+ *
+ * @return
+ * whether it holds now
+ */
+bool ActionGroup::holds(const ActionTrigger &trigger){
+  uint32_t queued, started;
+  bool active = getMotionSequence(queued, started);
+  /** motion number, and whether it has ended (started after it, or started and nothing runs) */
+  uint32_t motion = firstMotion + trigger.motion;
+  bool ended = started > motion + 1 || (started == motion + 1 && !active);
+  switch(trigger.type){
+    case TRIGGER_NOW: return true;
+    case TRIGGER_TIME: return millis() - runStart >= trigger.value;
+    case TRIGGER_TRAVEL: return ended || (travelMotion == motion && travelled >= trigger.value);
+    case TRIGGER_MOTION_DONE: return ended;
+    case TRIGGER_QUEUE_IDLE: return isMotionQueueIdle();
+    case TRIGGER_SHOOTER_READY: return isShooterReady();
+    case TRIGGER_BALLS: return getBallCount() >= trigger.value;
+  }
+  return false;
+}
+/**
+ * Track the distance travelled into the running motion, then start the actions whose triggers hold.
+ * @return
+ * whether every action has started
+ */
+bool ActionGroup::poll(){
+  uint32_t queued, started;
+  bool active = getMotionSequence(queued, started);
+  PoseSnapshot pose = getPose();
+  int64_t motion = active? (int64_t)started - 1 : -1;
+  if(motion != travelMotion){
+    travelMotion = motion;
+    travelled = 0;
+  } else travelled += hypot(pose.x - prevX, pose.y - prevY);
+  prevX = pose.x;
+  prevY = pose.y;
+  bool all = true;
+  for(int i = 0; i < count; i++){
+    if(!actions[i].started && holds(actions[i].trigger)){
+      actions[i].started = true;
+      actions[i].start();
+    }
+    all = all && actions[i].started;
+  }
+  return all;
+}
+/**
+ * Run the group alongside the motion queue until every action has started and every queued motion
+ * has ended. Call from the autonomous task after queueing the motions.
+ * @param timeout
+ * maximum run time in ms
+ *
+ * @return
+ * false if the timeout ran out first (the actions that had not started are dropped)
+ */
+bool ActionGroup::runParallel(uint32_t timeout){
+  runStart = millis();
+  while(true){
+    if(poll() && isMotionQueueIdle()) return true;
+    if(millis() - runStart >= timeout) return false;
+    delay(ACTION_POLL_DT);
+  }
+}
+/**
+ * Run the group alongside the motion queue until a finish trigger holds, then stop the base
+ * (clear the motion queue, end the running motion) and drop the actions that have not started,
+ * e.g. drive until 3 balls are held.
+ * @param finish
+ * trigger that ends the race
+ *
+ * @param timeout
+ * maximum run time in ms (the base is stopped then too)
+ *
+ * @return
+ * false if the timeout ran out first
+ */
+bool ActionGroup::runRace(const ActionTrigger &finish, uint32_t timeout){
+  runStart = millis();
+  bool finished = false;
+  while(true){
+    poll();
+    finished = holds(finish);
+    if(finished || millis() - runStart >= timeout) break;
+    delay(ACTION_POLL_DT);
+  }
+  clearMotionQueue();
+  /** the queue drops its motions at the next control cycle; then end the one that was running */
+  waitMotionQueue(4*BASE_CONTROL_DT);
+  stopBase();
+  return finished;
+}
@@ -0,0 +1,124 @@
+/**
+ * Allocation tripwire:
+ * - Allocator wrappers (linked with --wrap by the Makefile when ALLOC_GUARD is set)
+ * - Allocation counts per task, flagging of the real-time tasks once armed
+ * - Report of the flagged allocations (resource monitor) and of the counts
+ * The wrappers only count with atomics: they run inside the allocator's callers, so they must not print or allocate.
+ */
+#include "main.h"
+#include <new>
+/** whether initialize() has returned (refer to armAllocGuard) */
+std::atomic<bool> allocGuardArmed(false);
+/** allocations of the watched tasks (indexed by TimedTask) and of the other tasks (last) */
+std::atomic<uint32_t> taskAllocs[TIMING_TASKS + 1];
+/** flagged allocations, the last one's task and size, and the number already reported */
+std::atomic<uint32_t> flaggedAllocs(0), flaggedAllocSize(0), reportedAllocs(0);
+std::atomic<int> flaggedAllocTask(-1);
+/**
+ * Count an allocation of the current task, and flag it if the task is real-time and the guard armed.
+ * @param size
+ * bytes requested
+ */
+void countAllocation(size_t size){
+  int task = findWatchedTask(pros::c::task_get_current());
+  taskAllocs[task < 0? TIMING_TASKS : task]++;
+  if(!allocGuardArmed || task < 0 || !((ALLOC_GUARD_TASK_MASK >> task) & 1)) return;
+  flaggedAllocTask = task;
+  flaggedAllocSize = size;
+  flaggedAllocs++;
+  if(ALLOC_GUARD >= 2) __builtin_trap();
+}
+#if ALLOC_GUARD
+#ifdef __GLIBC__
+/**
+ * Host simulation build: malloc, calloc and realloc of the library are wrapped, and operator new is
+ * replaced so that the containers of the standard library (compiled into libstdc++.so) go through malloc.
+ */
+extern "C" void *__real_malloc(size_t size);
+extern "C" void *__real_calloc(size_t count, size_t size);
+extern "C" void *__real_realloc(void *pointer, size_t size);
+extern "C" void *__wrap_malloc(size_t size){
+  countAllocation(size);
+  return __real_malloc(size);
+}
+extern "C" void *__wrap_calloc(size_t count, size_t size){
+  countAllocation(count*size);
+  return __real_calloc(count, size);
+}
+extern "C" void *__wrap_realloc(void *pointer, size_t size){
+  countAllocation(size);
+  return __real_realloc(pointer, size);
+}
+void *operator new(std::size_t size){
+  void *pointer = malloc(size);
+  if(pointer == NULL) throw std::bad_alloc();
+  return pointer;
+}
+void operator delete(void *pointer) noexcept{
+  free(pointer);
+}
+void operator delete(void *pointer, std::size_t size) noexcept{
+  free(pointer);
+}
+#else
+/**
+ * V5 build: newlib's reentrant allocator is wrapped, under malloc, operator new (libsupc++), printf's
+ * buffers and fopen alike.
+ */
+extern "C" void *__real__malloc_r(struct _reent *reent, size_t size);
+extern "C" void *__real__calloc_r(struct _reent *reent, size_t count, size_t size);
+extern "C" void *__real__realloc_r(struct _reent *reent, void *pointer, size_t size);
+extern "C" void *__wrap__malloc_r(struct _reent *reent, size_t size){
+  countAllocation(size);
+  return __real__malloc_r(reent, size);
+}
+extern "C" void *__wrap__calloc_r(struct _reent *reent, size_t count, size_t size){
+  countAllocation(count*size);
+  return __real__calloc_r(reent, count, size);
+}
+extern "C" void *__wrap__realloc_r(struct _reent *reent, void *pointer, size_t size){
+  countAllocation(size);
+  return __real__realloc_r(reent, pointer, size);
+}
+#endif
+#endif
+/**
+ * Arm the guard: from now on, every allocation of a real-time task is flagged.
+ * Call at the end of initialize(), once the tasks are started and the devices built.
+ */
+void armAllocGuard(){
+  allocGuardArmed = true;
+}
+/**
+ * @return
+ * the allocation counts (all 0 when ALLOC_GUARD is 0)
+ */
+AllocCounts getAllocCounts(){
+  AllocCounts counts;
+  for(int i = 0; i < TIMING_TASKS; i++) counts.tasks[i] = taskAllocs[i];
+  counts.other = taskAllocs[TIMING_TASKS];
+  counts.flagged = flaggedAllocs;
+  counts.flaggedTask = flaggedAllocTask;
+  counts.flaggedSize = flaggedAllocSize;
+  return counts;
+}
+/**
+ * Log the allocations flagged since the last call, on stderr. Called by the resource monitor every MONITOR_DT.
+ */
+void reportAllocGuard(){
+  uint32_t flagged = flaggedAllocs;
+  if(flagged == reportedAllocs) return;
+  int task = flaggedAllocTask;
+  fprintf(stderr, "alloc guard: %u allocations in real-time tasks after initialize (last: %s, %u bytes)\n",
+    flagged - reportedAllocs, task >= 0? timedTaskNames[task] : "?", (uint32_t)flaggedAllocSize);
+  reportedAllocs = flagged;
+}
+/**
+ * Print the allocation counts of every task and the number of flagged allocations.
+ */
+void printAllocCounts(){
+  AllocCounts counts = getAllocCounts();
+  printf("allocations:");
+  for(int i = 0; i < TIMING_TASKS; i++) printf(" %s %u", timedTaskNames[i], counts.tasks[i]);
+  printf(" other %u, flagged %u\n", counts.other, counts.flagged);
+}
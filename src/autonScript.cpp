@@ -0,0 +1,228 @@
+/**
+ * Autonomous script functions:
+ * - Compiler: script text to bytecode
+ * - Interpreter: bytecode to the steps of a static routine (refer to staticRoutine.hpp), run one at a time
+ */
+#include "main.h"
+/**
+ * Operand kinds (one character each in ScriptCommand::operands)
+ * 'l': length or angle, int16 in hundredths
+ * 'p': power, int8
+ * 'n': count, uint8
+ * 'm': time in ms, uint16
+ * 't': trajectory name, stored as its uint8 id in the trajectory cache
+ * 'c': ball color name (red, blue, none), uint8 BallColor
+ * 'r': optional "reverse" flag, uint8
+ * 's': side name (left, right), uint8 BaseSide
+ */
+struct ScriptCommand{
+  const char *name;
+  ScriptOp op;
+  const char *operands;
+};
+/** the commands, indexed by ScriptOp */
+const ScriptCommand scriptCommands[SCRIPT_OPS] = {
+  {"end", SCRIPT_END, ""},
+  {"move", SCRIPT_MOVE, "l"},
+  {"moveto", SCRIPT_MOVE_TO, "ll"},
+  {"turn", SCRIPT_TURN, "l"},
+  {"turnto", SCRIPT_TURN_TO, "llr"},
+  {"turnby", SCRIPT_TURN_RELATIVE, "l"},
+  {"arc", SCRIPT_ARC, "ll"},
+  {"arcto", SCRIPT_ARC_TO, "ll"},
+  {"swing", SCRIPT_SWING, "ls"},
+  {"movepose", SCRIPT_MOVE_TO_POSE, "lllr"},
+  {"exit", SCRIPT_EARLY_EXIT, "lm"},
+  {"by", SCRIPT_DEADLINE, "m"},
+  {"optional", SCRIPT_OPTIONAL, "m"},
+  {"follow", SCRIPT_FOLLOW, "t"},
+  {"intake", SCRIPT_INTAKE, "p"},
+  {"cycle", SCRIPT_CYCLE, ""},
+  {"sort", SCRIPT_SORT, "c"},
+  {"wait queue", SCRIPT_WAIT_QUEUE, "m"},
+  {"wait balls", SCRIPT_WAIT_BALLS, "nm"},
+  {"wait shooter", SCRIPT_WAIT_SHOOTER, "m"},
+  {"delay", SCRIPT_DELAY, "m"}
+};
+const char *ballColorNames[] = {"none", "red", "blue"};
+const char *sideNames[] = {"none", "left", "right"};
+/** compiled script (always ends with SCRIPT_END) */
+uint8_t scriptCode[SCRIPT_MAX_CODE] = {SCRIPT_END};
+int scriptSize = 0;
+/**
+ * Compile one operand.
+ * @param kind
+ * operand kind (refer to ScriptCommand)
+ *
+ * @param token
+ * its text (NULL if the line has no more tokens)
+ *
+ * @param code, size
+ * bytecode and its length (advanced)
+ *
+ * @return
+ * false if the text is not a valid operand of the kind
+ */
+bool compileOperand(char kind, const char *token, uint8_t *code, int &size){
+  if(kind == 'r'){
+    if(token != NULL && strcmp(token, "reverse") != 0) return false;
+    code[size++] = token != NULL;
+    return true;
+  }
+  if(token == NULL) return false;
+  char *end;
+  if(kind == 't'){
+    int id = findTrajectory(token);
+    if(id < 0) return false;
+    code[size++] = id;
+    return true;
+  }
+  if(kind == 'c'){
+    for(int i = 0; i < 3; i++){
+      if(strcmp(token, ballColorNames[i]) != 0) continue;
+      code[size++] = i;
+      return true;
+    }
+    return false;
+  }
+  if(kind == 's'){
+    for(int i = BASE_SIDE_LEFT; i <= BASE_SIDE_RIGHT; i++){
+      if(strcmp(token, sideNames[i]) != 0) continue;
+      code[size++] = i;
+      return true;
+    }
+    return false;
+  }
+  double value = strtod(token, &end);
+  if(*end != '\0') return false;
+  int32_t integer = (int32_t)round(kind == 'l'? value*100 : value);
+  if(kind == 'l' && (integer < INT16_MIN || integer > INT16_MAX)) return false;
+  if(kind == 'p' && (integer < -127 || integer > 127)) return false;
+  if(kind == 'n' && (integer < 0 || integer > UINT8_MAX)) return false;
+  if(kind == 'm' && (integer < 0 || integer > UINT16_MAX)) return false;
+  code[size++] = integer & 0xFF;
+  if(kind == 'l' || kind == 'm') code[size++] = (integer >> 8) & 0xFF;
+  return true;
+}
+/**
+ * Compile a script file into the bytecode run by runAutonScript.
+ * Errors are printed with their line number; the previous bytecode is kept if the script is invalid.
+ * @param path
+ * script file (refer to autonScript.hpp for the format)
+ *
+ * @return
+ * false if the file cannot be read or the script is invalid
+ */
+bool compileAutonScript(const char *path){
+  ConfigFile file;
+  if(!file.open(path)) return false;
+  uint8_t code[SCRIPT_MAX_CODE];
+  int size = 0;
+  bool valid = true;
+  ConfigEntry entry;
+  while(valid && file.next(entry)){
+    /** "wait" takes the event as the first value of the command */
+    int operand = 0;
+    char name[32];
+    snprintf(name, sizeof(name), "%s", entry.key.data());
+    if(entry.key == "wait") snprintf(name, sizeof(name), "wait %s", entry.valueCount > operand? entry.values[operand++].data() : "");
+    const ScriptCommand *command = NULL;
+    for(int i = 1; i < SCRIPT_OPS; i++) if(strcmp(name, scriptCommands[i].name) == 0) command = &scriptCommands[i];
+    /** opcode, at most 7 bytes of operands and the final SCRIPT_END */
+    valid = command != NULL && size + 9 <= SCRIPT_MAX_CODE;
+    if(valid) code[size++] = command->op;
+    for(const char *kind = valid? command->operands : ""; *kind != '\0' && valid; kind++){
+      valid = compileOperand(*kind, entry.valueCount > operand? entry.values[operand++].data() : NULL, code, size);
+    }
+    valid = valid && operand == entry.valueCount;
+    if(!valid) printf("%s:%d: invalid command \"%s\"\n", path, entry.line, name);
+  }
+  if(file.failed()) printf("%s:%d: invalid line\n", path, file.getErrorLine());
+  valid = valid && !file.failed();
+  if(!valid) return false;
+  code[size++] = SCRIPT_END;
+  memcpy(scriptCode, code, size);
+  scriptSize = size;
+  return true;
+}
+/**
+ * Compile SCRIPT_PATH (the prepare function of the "Script" routine).
+ */
+void prepareAutonScript(){
+  if(usd::is_installed()) compileAutonScript(SCRIPT_PATH);
+}
+/**
+ * @return
+ * size of the compiled bytecode in bytes (0: no script)
+ */
+int getAutonScriptSize(){
+  return scriptSize;
+}
+/** operand readers (little endian) */
+int16_t readScriptInt16(int &pc){
+  int16_t value = (int16_t)(scriptCode[pc] | scriptCode[pc+1] << 8);
+  pc += 2;
+  return value;
+}
+uint16_t readScriptUint16(int &pc){
+  return (uint16_t)readScriptInt16(pc);
+}
+/**
+ * Run the compiled script: motions go to the motion queue (so the script runs ahead of the base),
+ * the wait commands block until their event or timeout. A resumed script starts at the step of the checkpoint
+ * (refer to poseCheckpoint.hpp). Call from autonomous().
+ */
+void runAutonScript(){
+  int pc = 0, first = takeResumeStep();
+  for(int index = 0; true; index++){
+    RoutineStep step = {(ScriptOp)scriptCode[pc++], 0, 0, 0, 0, NULL};
+    switch(step.op){
+      case SCRIPT_END:
+        runIndexedStep(step, index, 0);
+        return;
+      case SCRIPT_MOVE: case SCRIPT_TURN: case SCRIPT_TURN_RELATIVE: step.a = readScriptInt16(pc)*0.01; break;
+      case SCRIPT_MOVE_TO: case SCRIPT_ARC: case SCRIPT_ARC_TO:
+        step.a = readScriptInt16(pc)*0.01;
+        step.b = readScriptInt16(pc)*0.01;
+        break;
+      case SCRIPT_TURN_TO:
+        step.a = readScriptInt16(pc)*0.01;
+        step.b = readScriptInt16(pc)*0.01;
+        step.option = scriptCode[pc++];
+        break;
+      case SCRIPT_SWING:
+        step.a = readScriptInt16(pc)*0.01;
+        step.option = scriptCode[pc++];
+        break;
+      case SCRIPT_MOVE_TO_POSE:
+        step.a = readScriptInt16(pc)*0.01;
+        step.b = readScriptInt16(pc)*0.01;
+        step.c = readScriptInt16(pc)*0.01;
+        step.option = scriptCode[pc++];
+        break;
+      case SCRIPT_EARLY_EXIT:
+        step.a = readScriptInt16(pc)*0.01;
+        step.b = readScriptUint16(pc);
+        break;
+      case SCRIPT_DEADLINE: case SCRIPT_OPTIONAL: case SCRIPT_WAIT_QUEUE: case SCRIPT_WAIT_SHOOTER: case SCRIPT_DELAY:
+        step.a = readScriptUint16(pc);
+        break;
+      case SCRIPT_FOLLOW:{
+        /** a trajectory cleared since the compilation is skipped */
+        const CachedTrajectory *trajectory = getTrajectory(scriptCode[pc++]);
+        step.name = trajectory != NULL? trajectory->name : NULL;
+        break;
+      }
+      case SCRIPT_INTAKE: step.option = (int8_t)scriptCode[pc++]; break;
+      case SCRIPT_CYCLE: break;
+      case SCRIPT_SORT: step.option = scriptCode[pc++]; break;
+      case SCRIPT_WAIT_BALLS:
+        step.option = scriptCode[pc++];
+        step.a = readScriptUint16(pc);
+        break;
+      /** not produced by the compiler */
+      default: return;
+    }
+    runIndexedStep(step, index, first);
+  }
+}
@@ -0,0 +1,188 @@
+/**
+ * Autonomous selector functions:
+ * - Button matrix of the routines on the brain screen (LVGL)
+ * - Preparation of the chosen routine (trajectories, gains) before the match
+ * - Running the chosen routine
+ * The routine table lives in the hot package (auton_sets.cpp) and is registered with setAutonRoutines,
+ * so this file (cold package) never references it by name.
+ */
+#include "main.h"
+#include "display/lvgl.h"
+/**
+ * Selector state
+ * selectedAuton: routine chosen on the screen (written by the LVGL task)
+ * preparedAuton: routine whose data is loaded (-1: none; written by the precompute task)
+ * labelledAuton: routine the label shows as ready (-1: none)
+ * routines, routineCount: the registered table (NULL, 0: none)
+ */
+std::atomic<int> selectedAuton(AUTON_DEFAULT);
+std::atomic<int> preparedAuton(-1);
+int labelledAuton = -1;
+const AutonRoutine *routines = NULL;
+int routineCount = 0;
+/** button matrix map: routine names, a "\n" every AUTON_SELECTOR_COLUMNS and the "" terminator */
+const char *selectorMap[AUTON_SELECTOR_MAX + AUTON_SELECTOR_MAX/AUTON_SELECTOR_COLUMNS + 1];
+/**
+ * Register the routine table. Call from initialize() before anything else of the selector.
+ * @param table
+ * the routines (kept, not copied)
+ *
+ * @param count
+ * number of entries of table (at most AUTON_SELECTOR_MAX are shown)
+ */
+void setAutonRoutines(const AutonRoutine *table, int count){
+  routines = table;
+  routineCount = count < AUTON_SELECTOR_MAX? count : AUTON_SELECTOR_MAX;
+}
+/**
+ * @return
+ * number of routines of the registered table (0: none registered)
+ */
+int getAutonCount(){
+  return routineCount;
+}
+/**
+ * @param id
+ * index into the routine table
+ *
+ * @return
+ * name of the routine, NULL if there is no such routine
+ */
+const char *getAutonName(int id){
+  if(id < 0 || id >= routineCount) return NULL;
+  return routines[id].name;
+}
+lv_obj_t *selectorScreen = NULL, *selectorButtons = NULL, *selectorLabel = NULL;
+/**
+ * Load the data of a routine into memory: its trajectories, the saved gain schedule, base model, odometry geometry
+ * and parameters.
+ * @param id
+ * index into the routine table
+ */
+void prepareAuton(int id){
+  if(id < 0 || id >= routineCount) return;
+  loadGainSchedule();
+  loadBaseModel();
+  loadOdometryGeometry();
+  loadParams();
+  /** the previous routine's trajectories go, so switching routines never grows the memory */
+  clearTrajectories();
+  resetArena();
+  if(routines[id].prepare != NULL) routines[id].prepare();
+  preparedAuton = id;
+}
+/**
+ * Button matrix action (LVGL task): select the pressed routine.
+ * @param buttons
+ * the button matrix
+ *
+ * @param text
+ * name of the pressed routine
+ */
+lv_res_t selectAuton(lv_obj_t *buttons, const char *text){
+  for(int i = 0; i < routineCount; i++){
+    if(strcmp(text, routines[i].name) != 0) continue;
+    selectedAuton = i;
+    lv_btnm_set_toggle(buttons, true, i);
+    lv_label_set_static_text(selectorLabel, "Preparing...");
+    labelledAuton = -1;
+  }
+  return LV_RES_OK;
+}
+/**
+ * Create the selector screen, with the selected routine highlighted (called by buildDisplay).
+ */
+void buildAutonSelector(){
+  int entry = 0;
+  for(int i = 0; i < routineCount; i++){
+    if(i > 0 && i%AUTON_SELECTOR_COLUMNS == 0) selectorMap[entry++] = "\n";
+    selectorMap[entry++] = routines[i].name;
+  }
+  selectorMap[entry] = "";
+  selectorScreen = lv_obj_create(NULL, NULL);
+  selectorButtons = lv_btnm_create(selectorScreen, NULL);
+  lv_btnm_set_map(selectorButtons, selectorMap);
+  lv_btnm_set_action(selectorButtons, selectAuton);
+  lv_btnm_set_toggle(selectorButtons, true, selectedAuton);
+  lv_obj_set_size(selectorButtons, LV_HOR_RES, LV_VER_RES*3/4);
+  lv_obj_align(selectorButtons, NULL, LV_ALIGN_IN_TOP_MID, 0, 0);
+  selectorLabel = lv_label_create(selectorScreen, NULL);
+  lv_obj_align(selectorLabel, selectorButtons, LV_ALIGN_OUT_BOTTOM_LEFT, 8, 8);
+  lv_label_set_static_text(selectorLabel, "");
+}
+/**
+ * Show the selector on the brain screen, in front of the dashboard. Call from competition_initialize().
+ */
+void showAutonSelector(){
+  /** the objects are built in the background by the BOOT_UI stage (refer to main.cpp) */
+  waitBootReady(BOOT_UI);
+  lv_scr_load(selectorScreen);
+}
+/**
+ * Have the selected routine prepared if it changed, and show when it is ready.
+ * Call periodically from competition_initialize() (the preparation may take a while, so it runs in the
+ * precompute task, refer to precompute.hpp).
+ */
+void updateAutonSelector(){
+  int id = selectedAuton;
+  if(id != preparedAuton){
+    queuePrecompute(PRECOMPUTE_PREPARE);
+    return;
+  }
+  if(id == labelledAuton || selectorLabel == NULL) return;
+  lv_label_set_static_text(selectorLabel, "Ready");
+  labelledAuton = id;
+}
+/**
+ * Select a routine without the screen (e.g. the routine of a resumed checkpoint, refer to poseCheckpoint.hpp).
+ * @param id
+ * index into the routine table (ignored if out of range)
+ */
+void setSelectedAuton(int id){
+  if(id >= 0 && id < routineCount) selectedAuton = id;
+}
+/**
+ * @return
+ * index into the routine table of the selected routine
+ */
+int getSelectedAuton(){
+  return selectedAuton;
+}
+/**
+ * @return
+ * index into the routine table of the prepared routine (-1: none)
+ */
+int getPreparedAuton(){
+  return preparedAuton;
+}
+/**
+ * Run the selected routine, preparing it first if competition_initialize() did not
+ * (e.g. no competition switch). Call from autonomous().
+ */
+void runSelectedAuton(){
+  int id = selectedAuton;
+  if(id < 0 || id >= routineCount) return;
+  /** a routine that does not run in steps is not run again after a restart in the match (refer to poseCheckpoint.hpp) */
+  if(getResumeStep() < 0) return;
+  /** the period runs from here, boot gates included; a resumed routine carries on at the time of its checkpoint */
+  startMatchClock(AUTON_PERIOD, takeResumeMatchTime());
+  /** gates: only wait while the start is still loading the trajectories or calibrating the sensors, or a precompute step runs */
+  waitPrecompute();
+  waitBootReady(BOOT_TRAJECTORIES);
+  waitBootReady(BOOT_CALIBRATION, BOOT_CALIBRATION_TIMEOUT);
+  runAuton(id);
+}
+/**
+ * Run a routine of the table, preparing it first unless it is the prepared one
+ * (e.g. the regression benchmark of the host simulation runs every routine in turn).
+ * @param id
+ * index into the routine table
+ */
+void runAuton(int id){
+  if(id < 0 || id >= routineCount) return;
+  if(id != preparedAuton) prepareAuton(id);
+  const AutonRoutine &routine = routines[id];
+  if(routine.sortColor != BALL_NONE) setSortColor(routine.sortColor);
+  resetRoutineProgress();
+  routine.run();
+}
@@ -1,42 +1,122 @@
-/**
- * Autonomous routines:
- * - Skills run
- * - 15s auton runs for each spawn
- */
-#include "main.h"
-/**
- * Programming skills run
- * @return void
- */
-void skills(){
-  // capBasePow(30);
-  // baseMove(30);
-}
-/**
- * Starting position on the left of the blue alliance spawn.
- * @return void
- */
-void blueLeft(){
-
-}
-/**
- * Starting position on the right of the blue alliance spawn.
- * @return void
- */
-void blueRight(){
-
-}
-/**
- * Starting position on the left of the red alliance spawn.
- * @return void
- */
-void redLeft(){
-
-}
-/**
- * Starting position on the right of the prevEncdR alliance spawn.
- * @return void
- */
-void redRight(){
-
-}
+/**
+ * Autonomous routines:
+ * - Skills run
+ * - 15s auton runs for each spawn
+ * - Table of the routines for the selector
+ * - Baked trajectories of the routines
+ */
+#include "main.h"
+/**
+ * Routines of the selector, in button order (refer to AutonRoutine)
+ * The base autotuner is kept last, so it cannot be chosen by a misplaced tap on the first row.
+ */
+const AutonRoutine autonRoutines[AUTON_COUNT] = {
+  {"Skills", skillsTrajectories, skills, BALL_NONE},
+  {"Blue L", NULL, blueLeft, BALL_BLUE},
+  {"Blue R", NULL, blueRight, BALL_BLUE},
+  {"Red L", NULL, redLeft, BALL_RED},
+  {"Red R", NULL, redRight, BALL_RED},
+  /** the routine written in SCRIPT_PATH on the microSD card (refer to autonScript.hpp) */
+  {"Script", scriptTrajectories, runAutonScript, BALL_NONE},
+  /** measure the actuation latency of the base motors (refer to latencyProbe.hpp) */
+  {"Latency", NULL, probeBaseLatency, BALL_NONE},
+  /** identify the feedforward and the track widths of the base and save them to the microSD card (refer to baseCharacterizer.hpp) */
+  {"SysId", NULL, characterizeBase, BALL_NONE},
+  /** calibrate the odometry geometry from the bottom wall and save it to the microSD card (refer to calibrateOdometry) */
+  {"OdomCal", NULL, calibrateOdometry, BALL_NONE},
+  /** replay the driver macro saved on the microSD card, or follow its path (refer to inputMacro.hpp) */
+  {"Macro", prepareMacro, runMacro, BALL_NONE},
+  {"MacroPath", prepareMacro, runMacroPath, BALL_NONE},
+  /** tune the base gains on the brain screen, or with the autotuner, and save them to the microSD card (refer to tuningPanel.hpp) */
+  {"Tune", NULL, tuningPanel, BALL_NONE}
+};
+static_assert(AUTON_COUNT <= AUTON_SELECTOR_MAX, "the selector (cold package) shows at most AUTON_SELECTOR_MAX routines");
+/**
+ * Trajectories baked by `make bake` (refer to bakedTrajectories.hpp), linked in as read-only data when the
+ * build finds the blob (TRAJECTORY_BLOB_PATH, set by the Makefile); registered by initialize()
+ */
+#ifdef TRAJECTORY_BLOB_PATH
+asm(".section .rodata.trajectoryBlob, \"a\", %progbits\n"
+    ".balign 8\n"
+    ".global bakedBlobStart, bakedBlobEnd\n"
+    "bakedBlobStart:\n"
+    ".incbin \"" TRAJECTORY_BLOB_PATH "\"\n"
+    "bakedBlobEnd:\n"
+    ".balign 8\n"
+    ".previous\n");
+extern "C" const uint8_t bakedBlobStart[], bakedBlobEnd[];
+const uint8_t *const trajectoryBlob = bakedBlobStart;
+const uint32_t trajectoryBlobSize = bakedBlobEnd - bakedBlobStart;
+#else
+const uint8_t *const trajectoryBlob = NULL;
+const uint32_t trajectoryBlobSize = 0;
+#endif
+/**
+ * Generate the trajectories of the skills run into the trajectory cache: the legs of the route on the
+ * microSD card (ROUTE_FILE_PATH, refer to routeOptimizer.hpp), if there is one.
+ * Called by the selector before the match so that autonomous only replays them.
+ * @return void
+ */
+void skillsTrajectories(){
+  prepareRoute();
+  // Waypoint skillsStart[] = {{0, 0, 0}, {24, 48, halfPI}};
+  // generateTrajectory("skillsStart", skillsStart, 2);
+}
+/**
+ * Generate every trajectory a script may follow, then compile the script on the microSD card.
+ * @return void
+ */
+void scriptTrajectories(){
+  skillsTrajectories();
+  prepareAutonScript();
+}
+/**
+ * Programming skills run
+ * @return void
+ */
+void skills(){
+  runRoute();
+  // setChassisBackend(CHASSIS_OKAPI);
+  // chassisMove(24);
+  // chassisWait(2000);
+  // capBasePow(30);
+  // baseMove(30);
+  // followTrajectory("skillsStart");
+  // queueMove(24);
+  // queueTurn(90);
+  // intakeMove(127);
+  // waitMotionQueue(5000);
+  // ActionGroup group;
+  // queueMove(36);
+  // group.add(afterTravel(0, 10), []{intakeMove(127);});
+  // group.add(whenShooterReady(), []{cycle();});
+  // group.runParallel(5000);
+}
+/**
+ * Starting position on the left of the blue alliance spawn.
+ * @return void
+ */
+void blueLeft(){
+
+}
+/**
+ * Starting position on the right of the blue alliance spawn.
+ * @return void
+ */
+void blueRight(){
+
+}
+/**
+ * Starting position on the left of the red alliance spawn.
+ * @return void
+ */
+void redLeft(){
+
+}
+/**
+ * Starting position on the right of the red alliance spawn.
+ * @return void
+ */
+void redRight(){
+
+}
@@ -0,0 +1,185 @@
+/**
+ * Baked trajectories:
+ * - Lookup of the trajectories and the skills route of the blob linked into the hot package (robot)
+ * - Bake of every routine's trajectories into a blob, reusing the unchanged ones of the previous blob (host tool, `./bin/sim bake`)
+ */
+#include "main.h"
+/** the registered blob (NULL: none, or not valid) and its size in bytes */
+const uint8_t *bakedBlob = NULL;
+uint32_t bakedSize = 0;
+/**
+ * Register the blob linked into the hot package (from initialize(), before the routines are prepared).
+ * @param blob
+ * the blob (kept, not copied; NULL: none)
+ *
+ * @param size
+ * its size in bytes
+ *
+ * @return
+ * false if it is not a blob of this version or its trajectories reach past its end (it is then ignored)
+ */
+bool setBakedTrajectories(const void *blob, uint32_t size){
+  bakedBlob = NULL;
+  bakedSize = 0;
+  if(blob == NULL || size < sizeof(BakedHeader)) return false;
+  const BakedHeader *header = (const BakedHeader*) blob;
+  if(header->magic != BAKED_MAGIC || header->version != TRAJECTORY_FILE_VERSION || header->count < 0
+    || sizeof(BakedHeader) + header->count*sizeof(BakedTrajectory) > size) return false;
+  const BakedTrajectory *entries = (const BakedTrajectory*)(header + 1);
+  for(int i = 0; i < header->count; i++){
+    uint64_t end = entries[i].offset + (uint64_t)entries[i].length*(2*sizeof(PackedSegment) + sizeof(PackedPose));
+    if(entries[i].length <= 0 || entries[i].offset%4 != 0 || end > size) return false;
+  }
+  bakedBlob = (const uint8_t*) blob;
+  bakedSize = size;
+  return true;
+}
+/**
+ * Point a cache entry at a baked trajectory (read in place, nothing is copied).
+ * @param name
+ * identifier of the trajectory
+ *
+ * @param hash
+ * hash of its inputs (refer to hashTrajectory), the key of the blob
+ *
+ * @param trajectory
+ * filled with the baked trajectory
+ *
+ * @return
+ * false if no blob is registered or it has no trajectory of that hash
+ */
+bool findBakedTrajectory(const char *name, uint32_t hash, CachedTrajectory &trajectory){
+  if(bakedBlob == NULL) return false;
+  const BakedHeader *header = (const BakedHeader*) bakedBlob;
+  const BakedTrajectory *entries = (const BakedTrajectory*)(header + 1);
+  for(int i = 0; i < header->count; i++){
+    const BakedTrajectory &entry = entries[i];
+    if(entry.hash != hash) continue;
+    /** the follower only reads the segments, so they stay in the read-only blob */
+    PackedSegment *left = (PackedSegment*)(bakedBlob + entry.offset);
+    trajectory = {name, left, left + entry.length, entry.length, entry.dt, entry.velScale, entry.accScale,
+      (PackedPose*)(left + 2*entry.length)};
+    return true;
+  }
+  return false;
+}
+/**
+ * @return
+ * the skills route of the registered blob, NULL if there is none
+ */
+const SkillsRoute *getBakedRoute(){
+  if(bakedBlob == NULL) return NULL;
+  const BakedHeader *header = (const BakedHeader*) bakedBlob;
+  return header->hasRoute? &header->route : NULL;
+}
+/**
+ * Read a blob file and register its trajectories (host tool only, refer to bakeTrajectories); its route is
+ * dropped, so prepareRoute reads the route file again.
+ * @param path
+ * the file
+ *
+ * @return
+ * the blob read (to be freed once it is no longer registered), NULL if there is no valid blob in the file
+ */
+uint8_t *loadBakedTrajectories(const char *path){
+  FILE *file = fopen(path, "rb");
+  if(file == NULL) return NULL;
+  long size = fseek(file, 0, SEEK_END) == 0? ftell(file) : -1;
+  /** malloc aligns for any type, as the blob's layout requires */
+  uint8_t *blob = size > 0? (uint8_t*) malloc(size) : NULL;
+  bool valid = blob != NULL && fseek(file, 0, SEEK_SET) == 0 && fread(blob, 1, size, file) == (size_t)size;
+  fclose(file);
+  if(valid && (size_t)size >= sizeof(BakedHeader)) ((BakedHeader*) blob)->hasRoute = 0;
+  if(valid && setBakedTrajectories(blob, size)) return blob;
+  free(blob);
+  return NULL;
+}
+/**
+ * Prepare every registered routine (refer to prepareAuton) and write the trajectories they generate, with the
+ * prepared skills route, to a blob. Trajectories of the same inputs (refer to hashTrajectory) are written once,
+ * whichever routines and names use them; derived variants are not written (they are derived again at boot from
+ * their baked source).
+ * The blob already at the path is registered during the bake, so generateTrajectory takes every trajectory
+ * whose inputs did not change from it, and only the new or edited ones are generated.
+ * Host tool only: the segments are staged in a temporary file until the table is complete. Pathfinder is not
+ * linked on the computer, so the trajectories are generated on the spline path (refer to setSplineGeneration),
+ * which requires TRAJECTORY_VELOCITY_PLANNING.
+ * @param path
+ * file to write (and the previous blob to reuse)
+ *
+ * @param routines
+ * number of registered routines (refer to setAutonRoutines)
+ *
+ * @param reused
+ * set to the number of trajectories taken from the previous blob (NULL: not needed)
+ *
+ * @return
+ * number of trajectories written, -1 if the file cannot be written or there are more than BAKED_MAX_TRAJECTORIES
+ */
+int bakeTrajectories(const char *path, int routines, int *reused){
+  static BakedTrajectory entries[BAKED_MAX_TRAJECTORIES];
+  BakedHeader header = {};
+  header.magic = BAKED_MAGIC;
+  header.version = TRAJECTORY_FILE_VERSION;
+  FILE *data = tmpfile();
+  if(data == NULL) return -1;
+  uint8_t *previous = loadBakedTrajectories(path);
+  int fromPrevious = 0;
+  bool valid = true;
+  setSplineGeneration(true);
+  for(int id = 0; id < routines && valid; id++){
+    prepareAuton(id);
+    const SkillsRoute *route = getPreparedRoute();
+    if(route != NULL && !header.hasRoute){
+      header.hasRoute = 1;
+      header.route = *route;
+    }
+    const CachedTrajectory *trajectory;
+    for(int i = 0; valid && (trajectory = getTrajectory(i)) != NULL; i++){
+      if(trajectory->hash == 0 || trajectory->stream != NULL) continue;
+      bool baked = false;
+      for(int j = 0; j < header.count; j++) baked = baked || entries[j].hash == trajectory->hash;
+      if(baked) continue;
+      if(header.count >= BAKED_MAX_TRAJECTORIES){
+        valid = false;
+        break;
+      }
+      BakedTrajectory &entry = entries[header.count++];
+      entry = {};
+      snprintf(entry.name, sizeof(entry.name), "%s", trajectory->name);
+      entry.hash = trajectory->hash;
+      entry.length = trajectory->length;
+      entry.dt = trajectory->dt;
+      entry.velScale = trajectory->velScale;
+      entry.accScale = trajectory->accScale;
+      /** from the start of the data for now; the header and the table go before it */
+      entry.offset = ftell(data);
+      /** a trajectory found in the previous blob points into it */
+      const uint8_t *segments = (const uint8_t*) trajectory->left;
+      if(previous != NULL && segments >= previous && segments < previous + bakedSize) fromPrevious++;
+      valid = fwrite(trajectory->left, sizeof(PackedSegment), entry.length, data) == (size_t)entry.length
+        && fwrite(trajectory->right, sizeof(PackedSegment), entry.length, data) == (size_t)entry.length
+        && fwrite(trajectory->poses, sizeof(PackedPose), entry.length, data) == (size_t)entry.length;
+    }
+  }
+  setSplineGeneration(false);
+  /** the previous blob is no longer needed once its segments are staged (the file is overwritten below) */
+  clearTrajectories();
+  setBakedTrajectories(NULL, 0);
+  free(previous);
+  if(reused != NULL) *reused = fromPrevious;
+  uint32_t start = sizeof(BakedHeader) + header.count*sizeof(BakedTrajectory);
+  for(int i = 0; i < header.count; i++) entries[i].offset += start;
+  FILE *file = valid? fopen(path, "wb") : NULL;
+  if(file != NULL){
+    valid = fwrite(&header, sizeof(header), 1, file) == 1
+      && fwrite(entries, sizeof(BakedTrajectory), header.count, file) == (size_t)header.count;
+    rewind(data);
+    char buffer[512];
+    size_t size;
+    while(valid && (size = fread(buffer, 1, sizeof(buffer), data)) > 0) valid = fwrite(buffer, 1, size, file) == size;
+    valid = fclose(file) == 0 && valid;
+  }
+  fclose(data);
+  return file != NULL && valid? header.count : -1;
+}
@@ -0,0 +1,273 @@
+/**
+ * Base characterization functions:
+ * - Least squares fit of the feedforward of a side
+ * - Quasistatic & step tests
+ * - Track widths from spins in place
+ * - Characterization run of the base, saved to the base model file
+ * - Calibration of the odometry geometry, saved to the odometry geometry file
+ */
+#include "main.h"
+/**
+ * Add a sample to the fit.
+ * @param power
+ * power applied (at the time of the velocity and the acceleration)
+ *
+ * @param vel
+ * velocity of the side in inches per second
+ *
+ * @param acc
+ * acceleration of the side in inches per second squared
+ */
+void FeedforwardFit::addSample(double power, double vel, double acc){
+  double x[3] = {vel > 0? 1.0 : -1.0, vel, acc};
+  for(int i = 0; i < 3; i++){
+    for(int j = 0; j < 3; j++) normal(i, j) += x[i]*x[j];
+    moment(i, 0) += x[i]*power;
+  }
+  samples++;
+}
+/**
+ * Solve the normal equations.
+ * @param feedforward
+ * set to the fitted kS, kV & kA (unchanged if the fit fails)
+ *
+ * @return
+ * false if the samples do not determine the three terms (e.g. no step test)
+ */
+bool FeedforwardFit::solve(BaseFeedforward &feedforward) const{
+  Matrix<3, 3> inverse;
+  if(samples < 3 || !invertMatrix(normal, inverse)) return false;
+  Matrix<3, 1> terms = inverse*moment;
+  if(terms(1, 0) <= 0) return false;
+  feedforward = {terms(0, 0), terms(1, 0), terms(2, 0)};
+  return true;
+}
+/**
+ * @return
+ * number of samples in the fit
+ */
+int FeedforwardFit::getSamples() const{
+  return samples;
+}
+/**
+ * Drive the base with a ramp or a step of power and add every sample to the fits of the sides.
+ * The velocity and the acceleration of a sample are central differences of the motor encoders
+ * over the two neighbouring periods, taken with the power commanded at its time.
+ * @param direction
+ * 1 forwards, -1 backwards
+ *
+ * @param power
+ * power at the start
+ *
+ * @param rate
+ * growth of the power per second
+ *
+ * @param duration
+ * length of the test in ms (followed by SYSID_REST at rest)
+ *
+ * @param left, right
+ * fits of the sides
+ */
+void runFeedforwardTest(int direction, double power, double rate, uint32_t duration, FeedforwardFit &left, FeedforwardFit &right){
+  const double dt = SYSID_DT/1000.0;
+  double posL[3], posR[3], prevPower = 0;
+  Timer timer;
+  LoopRate period(SYSID_DT);
+  for(int k = 0; !timer.passed(duration); k++){
+    for(int i = 0; i < 2; i++){
+      posL[i] = posL[i + 1];
+      posR[i] = posR[i + 1];
+    }
+    posL[2] = drivetrain.getLeftPosition();
+    posR[2] = drivetrain.getRightPosition();
+    if(k >= 2){
+      double velL = (posL[2] - posL[0])*inPerMotorDeg/(2*dt), velR = (posR[2] - posR[0])*inPerMotorDeg/(2*dt);
+      double accL = (posL[2] - 2*posL[1] + posL[0])*inPerMotorDeg/(dt*dt), accR = (posR[2] - 2*posR[1] + posR[0])*inPerMotorDeg/(dt*dt);
+      if(fabs(velL) >= SYSID_MIN_VEL) left.addSample(prevPower, velL, accL);
+      if(fabs(velR) >= SYSID_MIN_VEL) right.addSample(prevPower, velR, accR);
+    }
+    prevPower = direction*(power + rate*timer.elapsed()/1000.0);
+    int32_t voltage = prevPower*12000/127;
+    drivetrain.setVoltage(voltage, voltage);
+    period.wait();
+  }
+  drivetrain.stop();
+  delay(SYSID_REST);
+}
+/**
+ * Spin the base in place and measure the effective track widths.
+ * The turned angle comes from the IMU when the odometry uses it, else from the tracking wheels
+ * (then only the motor width is measured, against baseWidth).
+ * @param direction
+ * 1 clockwise, -1 counterclockwise
+ *
+ * @param motorWidth, trackingWidth
+ * set to the widths in inches
+ *
+ * @return
+ * false if the base did not turn
+ */
+bool measureTrackWidth(int direction, double &motorWidth, double &trackingWidth){
+  SensorFrame start = readSensorFrame();
+  int32_t voltage = direction*SYSID_TURN_POWER*12000/127;
+  drivetrain.setVoltage(voltage, -voltage);
+  delay(SYSID_TURN_TIME);
+  drivetrain.stop();
+  delay(SYSID_REST);
+  SensorFrame end = readSensorFrame();
+  double trackingTurn = ((end.encdL - start.encdL) - (end.encdR - start.encdR))*inPerDeg;
+  double motorTurn = ((end.motorL - start.motorL) - (end.motorR - start.motorR))*inPerMotorDeg;
+  bool imu = ODOM_USE_IMU && start.imuValid && end.imuValid;
+  double angle = imu? (end.imuRotation - start.imuRotation)*toRad : trackingTurn/baseWidth;
+  if(fabs(angle) < 0.1) return false;
+  motorWidth = motorTurn/angle;
+  trackingWidth = imu? trackingTurn/angle : baseWidth;
+  return true;
+}
+/**
+ * Characterize the base: quasistatic ramps and steps forwards and backwards, fitted per side,
+ * then spins in place both ways for the track widths. The base controller is paused for the run,
+ * so call it from autonomous with room in front of and behind the robot and around it.
+ * The feedforward becomes the base model and is saved for the next boot (refer to baseModel.hpp);
+ * the widths are printed for robotConfig.hpp. If a fit or a spin fails, the model is not changed.
+ */
+void characterizeBase(){
+  FeedforwardFit left, right;
+  pauseBase(true);
+  wakeOdometry();
+  drivetrain.stop();
+  delay(SYSID_REST);
+  for(int direction = 1; direction >= -1; direction -= 2) runFeedforwardTest(direction, 0, SYSID_RAMP_RATE, SYSID_RAMP_TIME, left, right);
+  for(int direction = 1; direction >= -1; direction -= 2) runFeedforwardTest(direction, SYSID_STEP_POWER, 0, SYSID_STEP_TIME, left, right);
+  double motorWidth[2], trackingWidth[2];
+  bool turned = measureTrackWidth(1, motorWidth[0], trackingWidth[0]) && measureTrackWidth(-1, motorWidth[1], trackingWidth[1]);
+  pauseBase(false);
+  BaseModel model = getBaseModel();
+  if(!left.solve(model.left) || !right.solve(model.right) || !turned){
+    printf("Characterization failed (%d & %d samples, turned: %d)\n", left.getSamples(), right.getSamples(), turned);
+    return;
+  }
+  model.motorWidth = (motorWidth[0] + motorWidth[1])/2;
+  model.trackingWidth = (trackingWidth[0] + trackingWidth[1])/2;
+  printf("Base model: left kS %.3f kV %.3f kA %.4f, right kS %.3f kV %.3f kA %.4f (%d & %d samples)\n",
+         model.left.ks, model.left.kv, model.left.ka, model.right.ks, model.right.kv, model.right.ka,
+         left.getSamples(), right.getSamples());
+  printf("Track width: motors %.3f in, tracking wheels %.3f in%s\n", model.motorWidth, model.trackingWidth,
+         ODOM_USE_IMU? "" : " (configured, no IMU)");
+  setBaseModel(model);
+  saveBaseModel();
+}
+/**
+ * Spin the base in place from the bottom wall and square back to it, so the base has turned
+ * exactly a whole number of turns between the two seated frames.
+ * The spin is stopped once the IMU (or, without it, the tracking wheels at the given geometry)
+ * reads ODOM_CAL_TURNS turns; the odometry bearing is then snapped to the whole turns so that
+ * squaring to the wall is accepted whatever the error of the geometry.
+ * @param direction
+ * 1 clockwise, -1 counterclockwise
+ *
+ * @param geometry
+ * geometry of the stopping rule (the calibrated scale, the old width)
+ *
+ * @param dL, dR
+ * set to the counts of the tracking wheels between the seated frames
+ *
+ * @return
+ * the angle turned in radians, 0 if the base did not make the whole turns or did not seat
+ */
+double spinWholeTurns(int direction, const OdometryGeometry &geometry, int32_t &dL, int32_t &dR){
+  /** the coordinates of the last squaring are applied at the next odometry tick */
+  delay(ODOM_IDLE_DT);
+  SensorFrame seated = readSensorFrame();
+  PoseSnapshot pose = getPose();
+  baseMove(ODOM_CAL_CLEARANCE);
+  waitBase(ODOM_CAL_SETTLE);
+  pauseBase(true);
+  wakeOdometry();
+  SensorFrame start = readSensorFrame(), now = start;
+  int32_t voltage = direction*ODOM_CAL_TURN_POWER*12000/127;
+  drivetrain.setVoltage(voltage, -voltage);
+  double turned = 0;
+  for(uint32_t begin = millis(); fabs(turned) < ODOM_CAL_TURNS*360 && millis() - begin < ODOM_CAL_SPIN_TIMEOUT; delay(SYSID_DT)){
+    now = readSensorFrame();
+    turned = start.imuValid && now.imuValid? now.imuRotation - start.imuRotation
+      : ((now.encdL - start.encdL) - (now.encdR - start.encdR))*geometry.inPerDeg/geometry.baseWidth*toDeg;
+  }
+  drivetrain.stop();
+  delay(SYSID_REST);
+  now = readSensorFrame();
+  if(start.imuValid && now.imuValid) turned = now.imuRotation - start.imuRotation;
+  double turns = round(turned/360);
+  /**
+   * the base spun in place, at the pose after moving off the wall: reset there before resuming the
+   * controller, which would otherwise turn the base back to the motor targets of the move (the position is not
+   * measured, so it keeps its uncertainty)
+   */
+  resetCoords(pose.x + ODOM_CAL_CLEARANCE*sin(pose.angle), pose.y + ODOM_CAL_CLEARANCE*cos(pose.angle), pose.angle*toDeg + turns*360,
+              ODOM_KEEP_X | ODOM_KEEP_Y);
+  pauseBase(false);
+  if(turns != direction*ODOM_CAL_TURNS) return 0;
+  if(!baseSquareToWall(WALL_BOTTOM, -ODOM_CAL_WALL_POWER, ODOM_CAL_WALL_TIMEOUT)) return 0;
+  SensorFrame end = readSensorFrame();
+  dL = end.encdL - seated.encdL;
+  dR = end.encdR - seated.encdR;
+  return turns*2*M_PI;
+}
+/**
+ * Calibrate the odometry geometry. Place the robot with its back against the bottom wall, facing
+ * the top wall, with the field clear in front of it.
+ * The base drives to the top wall and back, squaring to each wall, so each leg is exactly the field
+ * minus the bumpers; inPerDeg is fitted by least squares to the counts of both tracking wheels over
+ * both legs. The base then spins ODOM_CAL_TURNS whole turns each way, squaring back to the bottom
+ * wall each time, and baseWidth is fitted to the turned angles and the differences of the counts.
+ * The geometry is saved for the next boot (refer to OdometryGeometry) and applied at once; if a
+ * wall or a spin fails, the geometry is not changed. Without the IMU a spin ends on the old width, so
+ * a width error over WALL_MAX_ANGLE across the turns fails the squaring: run it again
+ * (each run narrows the error) or lower ODOM_CAL_TURNS.
+ */
+void calibrateOdometry(){
+  const double leg = WALL_FIELD_SIZE - frontOffset - backOffset;
+  OdometryGeometry geometry = getOdometryGeometry();
+  PoseSnapshot pose = getPose();
+  setCoords(pose.x, pose.y, 0);
+  delay(ODOM_IDLE_DT);
+  bool seated = baseSquareToWall(WALL_BOTTOM, -ODOM_CAL_WALL_POWER, ODOM_CAL_WALL_TIMEOUT);
+  /** scale: both legs, both wheels (distance = counts*inPerDeg, through the origin) */
+  double countsDis = 0, countsSq = 0;
+  for(int direction = 1; direction >= -1 && seated; direction -= 2){
+    SensorFrame start = readSensorFrame();
+    baseMove(direction*(leg - ODOM_CAL_APPROACH));
+    waitBase(ODOM_CAL_SETTLE);
+    seated = baseSquareToWall(direction > 0? WALL_TOP : WALL_BOTTOM, direction*ODOM_CAL_WALL_POWER, ODOM_CAL_WALL_TIMEOUT);
+    SensorFrame end = readSensorFrame();
+    for(int32_t counts : {end.encdL - start.encdL, end.encdR - start.encdR}){
+      countsDis += counts*direction*leg;
+      countsSq += (double)counts*counts;
+    }
+  }
+  if(!seated || countsSq == 0){
+    printf("Odometry calibration failed: the base did not seat on the walls\n");
+    return;
+  }
+  geometry.inPerDeg = countsDis/countsSq;
+  /** width: both spins (turn difference = angle*baseWidth, through the origin) */
+  double diffAngle = 0, angleSq = 0;
+  for(int direction = 1; direction >= -1; direction -= 2){
+    int32_t dL, dR;
+    double angle = spinWholeTurns(direction, geometry, dL, dR);
+    if(angle == 0){
+      printf("Odometry calibration failed: the spin did not make %d whole turns or did not seat\n", ODOM_CAL_TURNS);
+      return;
+    }
+    diffAngle += (dL - dR)*geometry.inPerDeg*angle;
+    angleSq += angle*angle;
+  }
+  geometry.baseWidth = diffAngle/angleSq;
+  OdometryGeometry old = getOdometryGeometry();
+  printf("Odometry geometry: inPerDeg %.6f (was %.6f), baseWidth %.3f in (was %.3f)\n",
+         geometry.inPerDeg, old.inPerDeg, geometry.baseWidth, old.baseWidth);
+  setOdometryGeometry(geometry);
+  saveOdometryGeometry();
+  /** the odometry takes the geometry at a reset */
+  baseSquareToWall(WALL_BOTTOM, -ODOM_CAL_WALL_POWER, ODOM_CAL_WALL_TIMEOUT);
+}
@@ -1,34 +1,785 @@
 /**
  * Functions and tasks that deal with the movements of the base:
  * - Movement functions
- * - Target power task
- * - Power control task
+ * - Control pipeline task (sensors -> profile -> PD -> ramp/cap -> motors)
  * - Miscellaneous & supporting functions
  */
 #include "main.h"
-/** declare motors */
-Motor FL (FLPort);
-Motor BL (BLPort);
-Motor FR (FRPort);
-Motor BR (BRPort);
-
 /**
  * targetEncdL & targetEncdR are target values for the 2 side encoders.
  * They are used to link movement functions to baseControl task.
- * Movement unctions will change the values of these 2 variables and the task will respond correspondingly.
+ * Movement functions hand a command to the task (through startBaseMotion), which moves these
+ * 2 variables and follows a motion profile towards them. Only the baseControl task writes them;
+ * other tasks read them through getBaseTargets.
  */
 double targetEncdL=0,targetEncdR=0;
-/**
- * targetPowerL & targetPowerR are target values for the power for side motors.
- * They are used to link baseControl to baseMotorControl.
- * Note that these values are only target and not final values, and subjected to calibration, capping and bounding by baseMotorControl
- */
-double targetPowerL=0,targetPowerR=0;
+struct BaseTargets{
+  double left, right;
+};
+SeqLock<BaseTargets> targetLock;
+/** tracking errors of the last control cycle (setpoint - encoder, degrees), read through getBaseTrackingError */
+SeqLock<BaseTargets> trackingErrorLock;
 /**
  * Proportional and derivative constants for use in baseControl task.
  * Form the PD loop.
  */
 double kP,kD;
+/**
+ * Motion profile of the current movement.
+ * The profile is planned in inches along the side that travels further;
+ * profileScaleL & profileScaleR convert it to encoder degrees of each side.
+ * setpointEncdL & setpointEncdR are the current setpoints tracked by the PD loop.
+ */
+MotionProfile baseProfile;
+ProfileShape profileShape = PROFILE_SHAPE;
+/**
+ * Output mode of the current movement, and the mode the following movements start with
+ * (refer to BaseOutputMode in baseControl.hpp).
+ */
+BaseOutputMode outputMode = BASE_OUTPUT_MODE, nextOutputMode = BASE_OUTPUT_MODE;
+double profileStartL = 0, profileStartR = 0;
+double profileScaleL = 0, profileScaleR = 0;
+uint64_t profileStartTime = 0;
+double setpointEncdL = 0, setpointEncdR = 0;
+/**
+ * Trajectory being replayed (NULL when following a motion profile).
+ * Side positions are in inches from the start of the trajectory.
+ */
+const CachedTrajectory *baseTrajectory = NULL;
+/** whether the trajectory is followed on its poses (RAMSETE) instead of its side profiles, and by the MPC tracker */
+bool ramseteMode = false, mpcMode = false;
+/**
+ * learned feedforward of the trajectory followed (refer to learnedFeedforward.hpp): its id, and the bin of the
+ * cycle (-1 while no trajectory's side profiles are followed)
+ */
+int learningId = -1, learningBin = -1;
+/** kP/kD of the current movement follow the LQR table (BASE_LQR_GAINS) */
+bool lqrGains = false;
+/**
+ * Gains of the LQR table at a velocity in the units of the PD loop.
+ * @param vel
+ * velocity of the setpoints (in/s)
+ *
+ * @param kp, kd
+ * set to the gains (per encoder degree of error, and per encoder degree of change of the error per cycle)
+ */
+HOT_PATH void getLqrPD(double vel, double &kp, double &kd){
+  LqrBand gains = getLqrGains(vel);
+  kp = gains.kp*inPerDeg;
+  kd = gains.kd*inPerDeg/(BASE_CONTROL_DT/1000.0);
+}
+/** whether the base is following a pure-pursuit path */
+bool pursuitMode = false;
+/** whether the base is driving to a pose (refer to moveToPose.hpp), and the goal */
+bool poseMoveMode = false;
+PoseMoveGoal poseMove;
+/**
+ * Pose control (refer to BASE_POSE_CONTROL): goal pose of the current movement.
+ * The movement functions stage nextPoseGoal before starting the movement, and
+ * startBaseMotion takes it over, so the control task never pairs the new targets with an old goal.
+ * Every cycle, correctBasePose moves the targets to where the live pose puts the goal.
+ */
+bool poseControl = BASE_POSE_CONTROL;
+BasePoseGoal poseGoal, nextPoseGoal;
+bool poseGoalActive = false, nextPoseGoalSet = false;
+/**
+ * Heading hold (refer to BASE_HEADING_HOLD): bearing held by the current straight movement.
+ * Staged by the movement functions and taken over by startBaseMotion, as for the goal pose.
+ */
+bool headingHold = BASE_HEADING_HOLD;
+double heldHeading = 0, nextHeading = 0;
+bool headingActive = false, nextHeadingSet = false;
+/**
+ * IMU turns (refer to BASE_TURN_IMU): the held heading is the goal bearing of the current turn, less the turn
+ * its profile has left. turnImuOffset (radians) takes the IMU rotation to the bearing of the pose at the start
+ * of the turn (turnImuAligned once it is taken).
+ */
+bool turnImu = BASE_TURN_IMU;
+bool headingTurn = false, nextHeadingTurn = false, turnImuAligned = false;
+double turnImuOffset = 0;
+/**
+ * Strafe of a holonomic translation (refer to HOLONOMIC_BASE): the profile of the movement is planned along the
+ * travel of its fastest wheel, and profileScaleS converts it to inches across strafeAxis, the bearing held.
+ * The strafe is closed on the pose (refer to lateralOffset), from profileStartS to targetS.
+ * Staged by the movement functions and taken over by startBaseMotion, as for the goal pose.
+ */
+bool strafeActive = false, nextStrafeSet = false;
+double strafeAxis = 0, profileStartS = 0, profileScaleS = 0, targetS = 0;
+double nextStrafe = 0, nextStrafeAxis = 0;
+/** side held in place by the current swing turn (baseControl task only) */
+BaseSide pivotSide = BASE_SIDE_NONE;
+/**
+ * Chaining: the next movement starts while the current one is still decelerating.
+ * The remainder of the current profile (blendProfile) is added to the new profile,
+ * so the velocities of the two movements blend instead of dropping to zero in between.
+ * blendScaleL & blendScaleR are 0 when no movement is being blended out.
+ */
+bool chainBase = false;
+/** shortest duration of the next profiled movement in seconds (0: as fast as the limits allow) */
+double nextDuration = 0;
+MotionProfile blendProfile;
+double blendScaleL = 0, blendScaleR = 0;
+uint64_t blendStartTime = 0;
+/**
+ * Settle detection of the current movement.
+ * Every movement function increments baseMotionId; the baseControl task sets
+ * settledMotionId to it once the movement has settled, then wakes the task waiting in waitBase.
+ */
+std::atomic<uint32_t> baseMotionId(0), settledMotionId(0);
+SeqLock<SettleRule> baseSettleRule(SettleRule DEFAULT_SETTLE_RULE);
+SettleDetector baseSettle;
+uint32_t lastMotionId = 0;
+std::atomic<pros::task_t> baseWaiter(NULL);
+/**
+ * End of the current movement (baseControl task only, refer to brakeBase)
+ * baseBrakeModeL/R: brake mode the task last set on each side (-1 when unknown, e.g. after the base was handed over)
+ * motionFinished: the setpoints of the movement are at its targets; finishedAt: since when (micros)
+ * finishVel: velocity of the faster side then (in/s)
+ * brakeSides: sides still braking (bit 0 left, bit 1 right); brakeTime: length of the pulse so far (ms)
+ */
+int baseBrakeModeL = -1, baseBrakeModeR = -1;
+bool motionFinished = false;
+uint64_t finishedAt = 0;
+double finishVel = 0;
+int brakeSides = 0;
+uint32_t brakeTime = 0;
+/**
+ * Movement commands waiting for the baseControl task (refer to BaseCommand), the task,
+ * and the id of the last command it applied (baseControl task only)
+ */
+Mailbox<BaseCommand, BASE_COMMAND_QUEUE> baseCommands;
+std::atomic<pros::task_t> baseControlTask(NULL);
+uint32_t appliedMotionId = 0;
+/**
+ * Select the settle rule for the following movements (refer to settleDetector.hpp).
+ * While the motion queue is running it sets the rule of every queued motion,
+ * so only call this when the queue is idle (one writer at a time).
+ * @param rule
+ * the settle rule
+ */
+void setBaseSettleRule(const SettleRule &rule){
+  baseSettleRule.write(rule);
+}
+/**
+ * @return
+ * true if the current movement has settled (false until the control task has applied it)
+ */
+bool isBaseSettled(){
+  return settledMotionId.load() == baseMotionId.load();
+}
+/**
+ * Impacts (refer to detectBaseImpact)
+ * baseImpacts: the detector; impactSample: time of the sensor frame it was last fed (baseControl task only)
+ * impactUntil: end of the recovery from the last impact (micros, baseControl task only)
+ * abortedMotionId: the last movement an impact (or the watchdog) aborted
+ * baseImpact & baseImpactCount: the last impact and the number of impacts so far
+ */
+ImpactDetector baseImpacts;
+uint64_t impactSample = 0, impactUntil = 0;
+std::atomic<uint32_t> abortedMotionId(UINT32_MAX), baseImpactCount(0);
+SeqLock<BaseImpact> baseImpact;
+/**
+ * @return
+ * true if the current movement was aborted by an impact (refer to BASE_IMPACT_DETECTION) or the watchdog
+ */
+bool isBaseAborted(){
+  return abortedMotionId.load() == baseMotionId.load();
+}
+/**
+ * Retrieve the last impact.
+ * @param count (optional)
+ * set to the number of impacts so far (a new impact changes it)
+ *
+ * @return
+ * the last impact (type IMPACT_NONE if there was none)
+ */
+BaseImpact getBaseImpact(uint32_t *count){
+  if(count != NULL) *count = baseImpactCount;
+  return baseImpact.read();
+}
+/**
+ * Select the shape of the motion profile for the following movements.
+ * @param shape
+ * PROFILE_NONE (jump to the target), PROFILE_TRAPEZOIDAL or PROFILE_SCURVE
+ */
+void setProfileShape(ProfileShape shape){
+  profileShape = shape;
+}
+/**
+ * Select how the motors are driven for the following movements.
+ * @param mode
+ * BASE_OUTPUT_POWER, BASE_OUTPUT_VOLTAGE or BASE_OUTPUT_VELOCITY
+ */
+void setBaseOutputMode(BaseOutputMode mode){
+  nextOutputMode = mode;
+}
+/**
+ * Select whether the following movements are closed on the odometry pose (refer to BASE_POSE_CONTROL).
+ * @param enable
+ * true: pose goals, false: encoder targets only
+ */
+void setBasePoseControl(bool enable){
+  poseControl = enable;
+}
+/**
+ * Stage the goal pose of the next movement (pose control only).
+ * @param x, y
+ * goal point
+ *
+ * @param angle
+ * goal bearing in radians
+ *
+ * @param toPoint
+ * true: aim at the goal point, false: hold the goal bearing
+ *
+ * @param direction
+ * 1 forward, -1 backward
+ */
+void stageBasePoseGoal(double x, double y, double angle, bool toPoint, int direction){
+  if(!poseControl) return;
+  nextPoseGoal = {x, y, angle, toPoint, direction};
+  nextPoseGoalSet = true;
+}
+/**
+ * Select whether the following straight movements hold their bearing (refer to BASE_HEADING_HOLD).
+ * @param enable
+ * true: cross-coupled distance and heading loops, false: independent side loops
+ */
+void setBaseHeadingHold(bool enable){
+  headingHold = enable;
+}
+/**
+ * Select whether the following point turns are closed on the heading (refer to BASE_TURN_IMU).
+ * @param enable
+ * true: the IMU heading (the odometry heading without it), false: the side encoders
+ */
+void setBaseTurnImu(bool enable){
+  turnImu = enable;
+}
+/**
+ * Stage the goal bearing of the next turn (IMU turns only).
+ * @param angle
+ * bearing in radians
+ */
+void stageBaseTurn(double angle){
+  if(!turnImu) return;
+  nextHeading = angle;
+  nextHeadingSet = nextHeadingTurn = true;
+}
+/**
+ * Stage the bearing the next movement holds (heading hold only).
+ * @param angle
+ * bearing in radians
+ */
+void stageBaseHeading(double angle){
+  if(!headingHold) return;
+  nextHeading = angle;
+  nextHeadingSet = true;
+}
+/**
+ * Stage the strafe of the next movement (holonomic base only).
+ * @param lateral
+ * travel to the right in inches
+ *
+ * @param axis
+ * bearing held during the movement in radians (the strafe is across it)
+ */
+void stageBaseStrafe(double lateral, double axis){
+  if(!HOLONOMIC_BASE) return;
+  nextStrafe = lateral;
+  nextStrafeAxis = axis;
+  nextStrafeSet = true;
+}
+/**
+ * @param pose
+ * a pose
+ *
+ * @param axis
+ * a bearing in radians
+ *
+ * @return
+ * offset of the pose to the right of the line through the origin along the bearing (inches), the coordinate
+ * a holonomic translation strafes along
+ */
+double lateralOffset(const PoseSnapshot &pose, double axis){
+  return pose.x*cos(axis) - pose.y*sin(axis);
+}
+/**
+ * Chain the next movement onto the current one: the next movement function blends
+ * into the current profile instead of starting from rest where the setpoint is.
+ * Only applies to the next baseMove / baseTurn / baseTurnRelative / baseArc / baseSwing.
+ */
+void chainBaseMotion(){
+  chainBase = true;
+}
+/**
+ * Stretch the next profiled movement (baseMove / baseTurn / baseTurnRelative / baseArc / baseSwing) to
+ * last at least a duration: its profile limits are scaled down together, so it keeps its shape and
+ * arrives at the end of the duration instead of waiting there (refer to setNextMotionDeadline).
+ * A movement that cannot be done in the duration runs at the full limits.
+ * @param seconds
+ * shortest duration of the movement
+ */
+void stretchBaseMotion(double seconds){
+  nextDuration = seconds;
+}
+/**
+ * Publish the targets to the other tasks (getBaseTargets). baseControl task only.
+ */
+void publishBaseTargets(){
+  targetLock.write({targetEncdL, targetEncdR});
+}
+/**
+ * Retrieve the targets of the current movement as of the last control cycle (or applied command).
+ * @param left, right
+ * set to the target encoder values in degrees
+ */
+void getBaseTargets(double &left, double &right){
+  BaseTargets targets = targetLock.read();
+  left = targets.left;
+  right = targets.right;
+}
+/**
+ * Retrieve the tracking errors of the PD loop as of the last control cycle (e.g. to plot them).
+ * @param left, right
+ * set to the setpoint minus the encoder value in degrees
+ */
+void getBaseTrackingError(double &left, double &right){
+  BaseTargets errors = trackingErrorLock.read();
+  left = errors.left;
+  right = errors.right;
+}
+/**
+ * Apply a movement command: the targets, profile, gains, output mode and goal pose of the movement
+ * all change here, between two control cycles. baseControl task only.
+ * @param command
+ * the command (refer to BaseCommand)
+ */
+void applyBaseCommand(const BaseCommand &command){
+  switch(command.type){
+    case BASE_COMMAND_PROFILE:{
+      if(command.chain && baseTrajectory == NULL && !pursuitMode && !poseMoveMode && !strafeActive && !command.strafeSet){
+        /**
+         * blend out the current profile: the new profile starts at the current target
+         * and the remainder of the current profile is added on top of it
+         */
+        blendProfile = baseProfile;
+        blendScaleL = profileScaleL;
+        blendScaleR = profileScaleR;
+        blendStartTime = profileStartTime;
+        profileStartL = targetEncdL;
+        profileStartR = targetEncdR;
+      }
+      else{
+        /** the new profile starts where the setpoint currently is, so it never jumps */
+        blendScaleL = blendScaleR = 0;
+        profileStartL = setpointEncdL;
+        profileStartR = setpointEncdR;
+      }
+      targetEncdL += command.deltaL;
+      targetEncdR += command.deltaR;
+      double distL = targetEncdL - profileStartL;
+      double distR = targetEncdR - profileStartR;
+      /** a holonomic translation also strafes: its fastest wheel travels the strafe on top of its side */
+      strafeActive = command.strafeSet;
+      double distS = 0;
+      if(strafeActive){
+        strafeAxis = command.strafeAxis;
+        profileStartS = lateralOffset(getPose(), strafeAxis);
+        targetS = profileStartS + command.strafe;
+        distS = command.strafe;
+      }
+      double dist = fmax(fabs(distL), fabs(distR))*inPerDeg + fabs(distS);
+      profileScaleL = dist > 0? distL/dist : 0;
+      profileScaleR = dist > 0? distR/dist : 0;
+      profileScaleS = dist > 0? distS/dist : 0;
+      double kp = command.kp, kd = command.kd;
+      lqrGains = BASE_LQR_GAINS && !command.turn && kp == GAIN_SCHEDULED && kd == GAIN_SCHEDULED;
+      /** live parameters: scales of the scheduled gains and the straight profile limits */
+      const ParamTable *params = getParams();
+      if(kp == GAIN_SCHEDULED || kd == GAIN_SCHEDULED){
+        /** size of the movement: inches of travel, or degrees of a turn (each side travels dist) */
+        GainBand gains = getScheduledGains(command.turn, command.turn? dist*2/baseWidth*toDeg : dist);
+        if(kp == GAIN_SCHEDULED) kp = gains.kp*params->values[PARAM_GAIN_KP_SCALE];
+        if(kd == GAIN_SCHEDULED) kd = gains.kd*params->values[PARAM_GAIN_KD_SCALE];
+      }
+      double maxVel = params->values[PARAM_PROFILE_MAX_VEL], maxAcc = params->values[PARAM_PROFILE_MAX_ACC], maxJerk = PROFILE_MAX_JERK;
+      if(command.turn){
+        maxVel = PROFILE_TURN_MAX_VEL;
+        maxAcc = PROFILE_TURN_MAX_ACC;
+        maxJerk = PROFILE_TURN_MAX_JERK;
+      }
+      else if(command.arc){
+        maxVel = PROFILE_ARC_MAX_VEL;
+        maxAcc = PROFILE_ARC_MAX_ACC;
+        maxJerk = PROFILE_ARC_MAX_JERK;
+      }
+      baseProfile.generate(dist, maxVel, maxAcc, maxJerk, command.shape);
+      double duration = baseProfile.getDuration();
+      if(command.duration > duration && duration > 0){
+        /** stretched (stretchBaseMotion): a profile slowed down by s takes 1/s as long at s, s^2 and s^3 the limits */
+        double s = duration/command.duration;
+        baseProfile.generate(dist, maxVel*s, maxAcc*s*s, maxJerk*s*s*s, command.shape);
+      }
+      baseTrajectory = NULL;
+      pursuitMode = false;
+      poseGoal = command.poseGoal;
+      poseGoalActive = command.poseGoalSet;
+      /** pose control steers on its own */
+      heldHeading = command.heading;
+      headingActive = command.headingSet && !command.poseGoalSet;
+      headingTurn = command.headingTurn;
+      turnImuAligned = false;
+      pivotSide = command.pivot;
+      kP = kp;
+      kD = kd;
+      outputMode = command.output;
+      break;
+    }
+    case BASE_COMMAND_TRAJECTORY:{
+      int length = command.trajectory->length;
+      profileStartL = setpointEncdL;
+      profileStartR = setpointEncdR;
+      targetEncdL = profileStartL + decodeSegment(*command.trajectory, getSegment(*command.trajectory, false, length-1)).position/inPerDeg;
+      targetEncdR = profileStartR + decodeSegment(*command.trajectory, getSegment(*command.trajectory, true, length-1)).position/inPerDeg;
+      blendScaleL = blendScaleR = 0;
+      baseTrajectory = command.trajectory;
+      ramseteMode = false;
+      pursuitMode = false;
+      poseGoalActive = false;
+      headingActive = false;
+      pivotSide = BASE_SIDE_NONE;
+      lqrGains = BASE_LQR_GAINS && command.kp == GAIN_SCHEDULED && command.kd == GAIN_SCHEDULED;
+      learningId = findTrajectory(command.trajectory->name);
+      startLearningRun(learningId);
+      kP = command.kp;
+      kD = command.kd;
+      if(lqrGains) getLqrPD(0, kP, kD);
+      outputMode = command.output;
+      break;
+    }
+    case BASE_COMMAND_RAMSETE:
+    case BASE_COMMAND_MPC:
+      blendScaleL = blendScaleR = 0;
+      baseTrajectory = command.trajectory;
+      ramseteMode = true;
+      mpcMode = command.type == BASE_COMMAND_MPC;
+      resetMpc();
+      pursuitMode = false;
+      poseGoalActive = false;
+      headingActive = false;
+      pivotSide = BASE_SIDE_NONE;
+      outputMode = BASE_OUTPUT_VELOCITY;
+      break;
+    case BASE_COMMAND_PURSUIT:
+      baseTrajectory = NULL;
+      blendScaleL = blendScaleR = 0;
+      pursuitMode = true;
+      poseGoalActive = false;
+      headingActive = false;
+      pivotSide = BASE_SIDE_NONE;
+      outputMode = command.output;
+      break;
+    case BASE_COMMAND_MOVE_POSE:
+      baseTrajectory = NULL;
+      blendScaleL = blendScaleR = 0;
+      pursuitMode = false;
+      poseMove = command.poseMove;
+      poseGoalActive = false;
+      headingActive = false;
+      pivotSide = BASE_SIDE_NONE;
+      outputMode = command.output;
+      break;
+    case BASE_COMMAND_STOP:
+      targetEncdL = profileStartL = setpointEncdL = drivetrain.getLeftPosition();
+      targetEncdR = profileStartR = setpointEncdR = drivetrain.getRightPosition();
+      profileScaleL = profileScaleR = 0;
+      blendScaleL = blendScaleR = 0;
+      baseTrajectory = NULL;
+      pursuitMode = false;
+      poseGoalActive = false;
+      headingActive = false;
+      pivotSide = BASE_SIDE_NONE;
+      break;
+    case BASE_COMMAND_RESET:
+      targetEncdL = 0;
+      targetEncdR = 0;
+      setpointEncdL = setpointEncdR = 0;
+      profileStartL = profileStartR = 0;
+      profileScaleL = profileScaleR = 0;
+      blendScaleL = blendScaleR = 0;
+      baseTrajectory = NULL;
+      pursuitMode = false;
+      /** the goals were on the old coordinates */
+      poseGoalActive = false;
+      headingActive = false;
+      pivotSide = BASE_SIDE_NONE;
+      baseProfile.generate(0, PROFILE_MAX_VEL, PROFILE_MAX_ACC, PROFILE_MAX_JERK, command.shape);
+      break;
+  }
+  poseMoveMode = command.type == BASE_COMMAND_MOVE_POSE;
+  if(command.type != BASE_COMMAND_PROFILE) strafeActive = false;
+  profileStartTime = command.time;
+  appliedMotionId = command.id;
+  publishBaseTargets();
+}
+/**
+ * Apply the commands waiting for the control task, in order. baseControl task only.
+ */
+void applyBaseCommands(){
+  BaseCommand command;
+  while(baseCommands.take(command)) applyBaseCommand(command);
+}
+/**
+ * Start a new movement: number it (so it has to settle again) and hand it to the baseControl task.
+ * On the control task itself (e.g. from the motion queue) it is applied at once, after any waiting
+ * command; otherwise the task applies it at the start of its next cycle. The caller waits a cycle
+ * at a time while BASE_COMMAND_QUEUE commands are waiting.
+ * @param command
+ * the command; its id and time are set here
+ */
+void submitBaseCommand(BaseCommand &command){
+  command.id = ++baseMotionId;
+  command.time = micros();
+  /** the base is about to move: track it at full rate from now on */
+  wakeOdometry();
+  if(pros::c::task_get_current() == baseControlTask.load()){
+    applyBaseCommands();
+    applyBaseCommand(command);
+    return;
+  }
+  while(!baseCommands.post(command)) delay(BASE_CONTROL_DT);
+}
+/**
+ * @param type
+ * command type
+ *
+ * @return
+ * a command of the type with the output mode and profile shape of the following movements
+ */
+BaseCommand makeBaseCommand(BaseCommandType type){
+  BaseCommand command = {};
+  command.type = type;
+  command.shape = profileShape;
+  command.output = nextOutputMode;
+  return command;
+}
+/**
+ * Start a movement: move the target encoder values and plan a profile
+ * from the current setpoint to the new target.
+ * @param deltaL
+ * change of the left target in encoder degrees
+ *
+ * @param deltaR
+ * change of the right target in encoder degrees
+ *
+ * @param kp
+ * proportional constant (GAIN_SCHEDULED: from the gain schedule)
+ *
+ * @param kd
+ * derivative constant (GAIN_SCHEDULED: from the gain schedule)
+ *
+ * @param turn
+ * whether to use the turn (true) or straight (false) profile limits and gain schedule
+ *
+ * @param arc
+ * whether to use the arc profile limits instead (with the straight gain schedule)
+ *
+ * @param pivot
+ * side held in place (swing turn), BASE_SIDE_NONE otherwise
+ */
+void startBaseMotion(double deltaL, double deltaR, double kp, double kd, bool turn, bool arc, BaseSide pivot){
+  BaseCommand command = makeBaseCommand(BASE_COMMAND_PROFILE);
+  command.deltaL = deltaL;
+  command.deltaR = deltaR;
+  command.kp = kp;
+  command.kd = kd;
+  command.turn = turn;
+  command.arc = arc;
+  command.pivot = pivot;
+  command.chain = chainBase;
+  chainBase = false;
+  command.duration = nextDuration;
+  nextDuration = 0;
+  /** take over the staged goal pose (none if the movement was not staged) */
+  command.poseGoal = nextPoseGoal;
+  command.poseGoalSet = nextPoseGoalSet;
+  nextPoseGoalSet = false;
+  command.heading = nextHeading;
+  command.headingSet = nextHeadingSet;
+  command.headingTurn = nextHeadingTurn;
+  nextHeadingSet = nextHeadingTurn = false;
+  command.strafe = nextStrafe;
+  command.strafeAxis = nextStrafeAxis;
+  command.strafeSet = nextStrafeSet;
+  nextStrafeSet = false;
+  stopPursuit();
+  submitBaseCommand(command);
+}
+/**
+ * Start replaying a cached trajectory (refer to trajectoryCache.hpp).
+ * The segments are decoded and tracked by time from the current setpoint, replacing the motion profile.
+ * @param trajectory
+ * the trajectory (kept in the cache while it is replayed)
+ *
+ * @param kp
+ * proportional constant
+ *
+ * @param kd
+ * derivative constant
+ */
+void startBaseTrajectory(const CachedTrajectory *trajectory, double kp, double kd){
+  if(trajectory->length < 1) return;
+  BaseCommand command = makeBaseCommand(BASE_COMMAND_TRAJECTORY);
+  command.trajectory = trajectory;
+  command.kp = kp;
+  command.kd = kd;
+  stopPursuit();
+  submitBaseCommand(command);
+}
+/**
+ * Start following a cached trajectory with the RAMSETE controller (refer to ramsete.hpp).
+ * The control task commands the side velocities through the motors' velocity loop
+ * (BASE_OUTPUT_VELOCITY) until the end of the trajectory, then holds the base where it stopped.
+ * @param trajectory
+ * the trajectory (kept in the cache while it is followed)
+ */
+void startBaseRamsete(const CachedTrajectory *trajectory){
+  if(trajectory->length < 1) return;
+  BaseCommand command = makeBaseCommand(BASE_COMMAND_RAMSETE);
+  command.trajectory = trajectory;
+  stopPursuit();
+  submitBaseCommand(command);
+}
+/**
+ * Start following a cached trajectory with the MPC tracker (refer to mpcTracker.hpp), as startBaseRamsete.
+ * @param trajectory
+ * the trajectory (kept in the cache while it is followed)
+ */
+void startBaseMpc(const CachedTrajectory *trajectory){
+  if(trajectory->length < 1) return;
+  prepareMpc();
+  BaseCommand command = makeBaseCommand(BASE_COMMAND_MPC);
+  command.trajectory = trajectory;
+  stopPursuit();
+  submitBaseCommand(command);
+}
+/**
+ * Start following the path set by setPursuitPath (refer to purePursuit.cpp).
+ * The control task drives the side velocities from pure pursuit until the path is finished,
+ * then holds the base where it stopped.
+ */
+void startBasePursuit(){
+  BaseCommand command = makeBaseCommand(BASE_COMMAND_PURSUIT);
+  submitBaseCommand(command);
+}
+/**
+ * Start driving to a pose (refer to moveToPose.cpp).
+ * The control task drives the side velocities from the move-to-pose controller until the goal is
+ * reached, then holds the base where it stopped.
+ * @param goal
+ * the goal pose and the parameters of the movement
+ */
+void startBaseMoveToPose(const PoseMoveGoal &goal){
+  BaseCommand command = makeBaseCommand(BASE_COMMAND_MOVE_POSE);
+  command.poseMove = goal;
+  stopPursuit();
+  submitBaseCommand(command);
+}
+/**
+ * Time elapsed since a start time, clamped to 0 if the start is after now.
+ * @param now
+ * current time (micros)
+ *
+ * @param start
+ * start time (micros)
+ *
+ * @return
+ * elapsed time in seconds
+ */
+double elapsedTime(uint64_t now, uint64_t start){
+  int64_t elapsed = (int64_t)(now - start);
+  return elapsed > 0? elapsed/1000000.0 : 0;
+}
+/**
+ * Time elapsed since the start of the current movement.
+ * A movement may start after the sensors of the current cycle were read,
+ * so negative elapsed times are clamped to 0.
+ * @param now
+ * time of the current cycle (micros)
+ *
+ * @return
+ * elapsed time in seconds
+ */
+double movementTime(uint64_t now){
+  return elapsedTime(now, profileStartTime);
+}
+/**
+ * Whether the next movement can be chained onto the current one:
+ * the current movement follows a motion profile that has started decelerating,
+ * and no earlier movement is still being blended out.
+ * @param now
+ * time of the current cycle (micros)
+ *
+ * @return
+ * true if chaining now keeps the setpoints continuous
+ */
+bool canChainBase(uint64_t now){
+  if(baseTrajectory != NULL || pursuitMode || poseMoveMode || strafeActive) return false;
+  bool blending = (blendScaleL != 0 || blendScaleR != 0) && elapsedTime(now, blendStartTime) < blendProfile.getDuration();
+  return !blending && movementTime(now) >= baseProfile.getDecelStart();
+}
+/**
+ * What is left of the current movement (baseControl task only, refer to the early exit of motionQueue.cpp).
+ * @param frame
+ * control frame of the current cycle
+ *
+ * @param distance
+ * set to the distance left in inches: to the target of the side furthest from it (plus the strafe left of a
+ * holonomic translation), to the end of the pure-pursuit path, or to the goal of a move to pose
+ *
+ * @param time
+ * set to the time left on the profile or trajectory in ms (INFINITY for pure pursuit and move to pose)
+ */
+void getBaseRemaining(const BaseControlFrame &frame, double &distance, double &time){
+  time = INFINITY;
+  if(pursuitMode){
+    distance = getPathRemaining();
+    return;
+  }
+  if(poseMoveMode){
+    PoseSnapshot pose = getPose();
+    distance = hypot(poseMove.x - pose.x, poseMove.y - pose.y);
+    return;
+  }
+  distance = fmax(fabs(targetEncdL - frame.encdL), fabs(targetEncdR - frame.encdR))*inPerDeg;
+  if(strafeActive) distance += fabs(targetS - frame.lateralS);
+  double duration = baseTrajectory != NULL? baseTrajectory->length*baseTrajectory->dt : baseProfile.getDuration();
+  time = fmax(0, duration - movementTime(frame.readTime))*1000;
+}
+/**
+ * Pose the next movement is planned from.
+ * When chaining, the base has not reached the current target yet,
+ * so the pose is projected along the arc that the remaining encoder travel describes.
+ * @return
+ * pose at the end of the current movement (chaining), or the current pose
+ */
+PoseSnapshot getBasePlanPose(){
+  PoseSnapshot pose = getPose();
+  if(!chainBase) return pose;
+  SensorFrame sensors = getSensorFrame();
+  double targetL, targetR;
+  getBaseTargets(targetL, targetR);
+  double remainingL = (targetL - sensors.motorL)*inPerDeg;
+  double remainingR = (targetR - sensors.motorR)*inPerDeg;
+  /** refer to Odometry Documentation.docx: same arc approximation as the odometry task */
+  double deltaAngle = (remainingL - remainingR)/baseWidth;
+  double forward = (remainingL + remainingR)/2;
+  pose.x += forward*sin(pose.angle + deltaAngle/2);
+  pose.y += forward*cos(pose.angle + deltaAngle/2);
+  pose.angle += deltaAngle;
+  return pose;
+}
 /**
  * Move straight.
  * @param dis
@@ -41,20 +792,22 @@ double kP,kD;
  * derivative constant
  */
 void baseMove(double dis, double kp, double kd){
+  if(poseControl || headingHold){
+    /** goal: dis along the current bearing */
+    PoseSnapshot pose = getBasePlanPose();
+    stageBasePoseGoal(pose.x + dis*sin(pose.angle), pose.y + dis*cos(pose.angle), pose.angle, true, dis < 0? -1 : 1);
+    stageBaseHeading(pose.angle);
+  }
   /** convert dis in inches to encoder degrees */
-  targetEncdL += dis/inPerDeg;
-  targetEncdR += dis/inPerDeg;
-  /** assign custom values to kP and kD */
-  kP = kp;
-  kD = kd;
+  startBaseMotion(dis/inPerDeg, dis/inPerDeg, kp, kd, false);
 }
 /**
- * Move straight using default values of kP and kD.
+ * Move straight using the gain schedule.
  * @param dis
  * distance in inches
  */
 void baseMove(double dis){
-  baseMove(dis, DEFAULT_KP, DEFAULT_KD);
+  baseMove(dis, GAIN_SCHEDULED, GAIN_SCHEDULED);
 }
 /**
  * Move straight towards a coordinate.
@@ -71,12 +824,18 @@ void baseMove(double dis){
  * derivative constant
  *
  * @note
- * There must be a baseTurn(x, y) before baseMove(x, y).
+ * There must be a baseTurn(x, y) before baseMove(x, y) (a holonomic base translates instead, refer to baseTranslate).
  *
  */
 void baseMove(double x, double y, double kp, double kd){
-	double errorX = x-position.x;
-  double errorY = y-position.y;
+  if(HOLONOMIC_BASE){
+    baseTranslate(x, y, kp, kd);
+    return;
+  }
+  /** consistent copy of the pose from the odometry task (projected when chaining) */
+  PoseSnapshot pose = getBasePlanPose();
+	double errorX = x-pose.x;
+  double errorY = y-pose.y;
   /** calculate Pythagorean distance */
 	double distance = sqrt(errorX * errorX + errorY * errorY);
   /**
@@ -97,16 +856,16 @@ void baseMove(double x, double y, double kp, double kd){
    * If reverse = 1, the robot should move forward, else reverse.
    */
 	int reverse = 1;
-  if(fabs(targAngle-position.angle) >= halfPI) reverse = -1;
+  if(fabs(angleDiff(targAngle, pose.angle)) >= halfPI) reverse = -1;
+  /** the bearing held, on the continuous heading like every staged bearing (refer to correctBasePose) */
+  double bearing = pose.angle + angleDiff(reverse > 0? targAngle : targAngle + PI, pose.angle);
+  stageBasePoseGoal(x, y, bearing, true, reverse);
+  stageBaseHeading(bearing);
   /** convert dis in inches to encoder degrees */
-  targetEncdL += distance/inPerDeg*reverse;
-  targetEncdR += distance/inPerDeg*reverse;
-  /** assign custom values to kP and kD */
-  kP = kp;
-  kD = kd;
+  startBaseMotion(distance/inPerDeg*reverse, distance/inPerDeg*reverse, kp, kd, false);
 }
 /**
- * Move straight towards a coordinate using default kP and kD values.
+ * Move straight towards a coordinate using the gain schedule.
  * @param x
  * x-coordinate of the target
  *
@@ -114,7 +873,74 @@ void baseMove(double x, double y, double kp, double kd){
  * y-coordinate of the target
  */
 void baseMove(double x, double y){
-  baseMove(x, y, DEFAULT_KP, DEFAULT_KD);
+  baseMove(x, y, GAIN_SCHEDULED, GAIN_SCHEDULED);
+}
+/**
+ * Translate straight to a coordinate (holonomic base): the base holds its bearing, drives the way along it on
+ * its sides and strafes the way across it, on one profile, so there is no turn to face the point first.
+ * A tank base cannot strafe: it moves as baseMove(x, y).
+ * @param x
+ * x-coordinate of the target
+ *
+ * @param y
+ * y-coordinate of the target
+ *
+ * @param kp
+ * proportional constant (of the sides and of the strafe)
+ *
+ * @param kd
+ * derivative constant
+ */
+void baseTranslate(double x, double y, double kp, double kd){
+  if(!HOLONOMIC_BASE){
+    baseMove(x, y, kp, kd);
+    return;
+  }
+  PoseSnapshot pose = getPose();
+  double errorX = x - pose.x, errorY = y - pose.y;
+  double forward = errorX*sin(pose.angle) + errorY*cos(pose.angle);
+  double lateral = errorX*cos(pose.angle) - errorY*sin(pose.angle);
+  stageBasePoseGoal(x, y, pose.angle, false, forward < 0? -1 : 1);
+  stageBaseHeading(pose.angle);
+  stageBaseStrafe(lateral, pose.angle);
+  startBaseMotion(forward/inPerDeg, forward/inPerDeg, kp, kd, false);
+}
+/**
+ * Translate straight to a coordinate using the gain schedule.
+ * @param x
+ * x-coordinate of the target
+ *
+ * @param y
+ * y-coordinate of the target
+ */
+void baseTranslate(double x, double y){
+  baseTranslate(x, y, GAIN_SCHEDULED, GAIN_SCHEDULED);
+}
+/**
+ * Strafe sideways, holding the bearing (holonomic base; a tank base does not move).
+ * @param dis
+ * distance in inches (positive: to the right)
+ *
+ * @param kp
+ * proportional constant
+ *
+ * @param kd
+ * derivative constant
+ */
+void baseStrafe(double dis, double kp, double kd){
+  PoseSnapshot pose = getPose();
+  stageBasePoseGoal(pose.x + dis*cos(pose.angle), pose.y - dis*sin(pose.angle), pose.angle, false, 1);
+  stageBaseHeading(pose.angle);
+  stageBaseStrafe(dis, pose.angle);
+  startBaseMotion(0, 0, kp, kd, false);
+}
+/**
+ * Strafe sideways using the gain schedule.
+ * @param dis
+ * distance in inches (positive: to the right)
+ */
+void baseStrafe(double dis){
+  baseStrafe(dis, GAIN_SCHEDULED, GAIN_SCHEDULED);
 }
 /**
  * Turn to an absolute bearing.
@@ -126,24 +952,34 @@ void baseMove(double x, double y){
  *
  * @param kd
  * derivative constant
+ *
+ * @param direction
+ * way round (refer to TurnDirection)
  */
-void baseTurn(double angleDeg, double kp, double kd){
-	double error = angleDeg*toRad - position.angle;
+void baseTurn(double angleDeg, double kp, double kd, TurnDirection direction){
+	/** shortest way round: the bearing of the pose is not bounded */
+  PoseSnapshot pose = getBasePlanPose();
+	double error = angleDiff(angleDeg*toRad, pose.angle);
+  /** a directed turn goes the long way round when the short one is against it */
+  if(direction == TURN_CLOCKWISE && error < 0) error += twoPI;
+  if(direction == TURN_COUNTERCLOCKWISE && error > 0) error -= twoPI;
+  /** turn on the spot: the goal point is where the turn starts */
+  stageBasePoseGoal(pose.x, pose.y, pose.angle + error, false, 1);
+  stageBaseTurn(pose.angle + error);
   /** refer to Odometry Documentation for mathematical proof */
 	double diff = error*baseWidth/inPerDeg;
-	targetEncdL += diff/2;
-	targetEncdR += -diff/2;
-  /** assign custom values to kP and kD */
-	kP = kp;
-	kD = kd;
+  startBaseMotion(diff/2, -diff/2, kp, kd, true);
 }
 /**
- * Turn to an absolute bearing using default turn kP and kD values.
+ * Turn to an absolute bearing using the gain schedule.
  * @param angleDeg
  * bearing (absolute angle) in degrees
+ *
+ * @param direction
+ * way round (refer to TurnDirection)
  */
-void baseTurn(double angleDeg){
-  baseTurn(angleDeg, DEFAULT_TURN_KP, DEFAULT_TURN_KD);
+void baseTurn(double angleDeg, TurnDirection direction){
+  baseTurn(angleDeg, GAIN_SCHEDULED, GAIN_SCHEDULED, direction);
 }
 /**
  * Turn to a coordinate.
@@ -167,30 +1003,29 @@ void baseTurn(double angleDeg){
  * Use baseTurn(x, y) before baseMove(x, y).
  */
 void baseTurn(double x, double y, double kp, double kd, bool reverse = false){
+  /** consistent copy of the pose from the odometry task (projected when chaining) */
+  PoseSnapshot pose = getBasePlanPose();
   /** same concept as above in baseMove(x, y, kp, kd). */
-	double targAngle = atan2((x-position.x),(y-position.y));
+	double targAngle = atan2((x-pose.x),(y-pose.y));
   /**
    * If backward movement:
    * The back faces targAngle so the front should face (targAngle + PI)
    */
 	if(reverse) targAngle += PI;
   /**
-   * Prevent turns that span over PI rad (which we can just turn the other way)
-   * Mathematically: handle cases in which |targAngle - position.angle| >= PI
+   * Prevent turns that span over PI rad (which we can just turn the other way),
+   * however many turns the bearing has accumulated
    */
-	if(targAngle-position.angle > PI) targAngle -= twoPI;
-	if(targAngle-position.angle < -PI) targAngle += twoPI;
+  double error = angleDiff(targAngle, pose.angle);
+  stageBasePoseGoal(pose.x, pose.y, pose.angle + error, false, 1);
+  stageBaseTurn(pose.angle + error);
   /** refer to Odometry Documentation.docx for mathematical proof */
-  double diff = (targAngle - position.angle)*baseWidth/inPerDeg;
+  double diff = error*baseWidth/inPerDeg;
 	//printf("%f, %f\n", targAngle, diff);
-  targetEncdL += diff/2;
-  targetEncdR += -diff/2;
-  /** assign custom values for kP and kD */
-  kP = kp;
-  kD = kd;
+  startBaseMotion(diff/2, -diff/2, kp, kd, true);
 }
 /**
- * Turn to a coordinate using default turn kP and kD values.
+ * Turn to a coordinate using the gain schedule.
  * @param x
  * x-coordinate of the target
  *
@@ -202,7 +1037,7 @@ void baseTurn(double x, double y, double kp, double kd, bool reverse = false){
  * false: forward movement
  */
 void baseTurn(double x, double y, bool reverse = false){
-  baseTurn(x, y, DEFAULT_TURN_KP, DEFAULT_TURN_KD, reverse);
+  baseTurn(x, y, GAIN_SCHEDULED, GAIN_SCHEDULED, reverse);
 }
 /**
  * Turn a relative angle.
@@ -216,47 +1051,163 @@ void baseTurn(double x, double y, bool reverse = false){
  * derivative constant
  */
 void baseTurnRelative(double angle, double kp, double kd){
+  if(poseControl || turnImu){
+    PoseSnapshot pose = getBasePlanPose();
+    stageBasePoseGoal(pose.x, pose.y, pose.angle + angle*toRad, false, 1);
+    stageBaseTurn(pose.angle + angle*toRad);
+  }
   /** refer to Odometry Documentation.docx for mathematical proof */
   double diff = angle*toRad*baseWidth/inPerDeg;
-  targetEncdL += diff/2;
-  targetEncdR += -diff/2;
-  /** assign custom kP and kD values */
-  kP = kp;
-  kD = kd;
+  startBaseMotion(diff/2, -diff/2, kp, kd, true);
+}
+/**
+ * Drive along an arc of constant curvature: the targets of the sides are their travel around the center of
+ * the arc, followed on one profile (scaled per side, the outer side at the straight limits), so the robot
+ * turns while it drives instead of stopping for a point turn. No pose goal is staged (pose control would
+ * steer for the straight line).
+ * @param radius
+ * radius of the arc of the robot's center in inches (positive: forwards, negative: backwards)
+ *
+ * @param angleDeg
+ * change of the bearing in degrees (positive: clockwise)
+ *
+ * @param kp
+ * proportional constant
+ *
+ * @param kd
+ * derivative constant
+ */
+void baseArc(double radius, double angleDeg, double kp, double kd){
+  double angle = angleDeg*toRad;
+  /** refer to Odometry Documentation.docx: side travel of a turn, on top of the travel of the center */
+  double center = radius*fabs(angle);
+  startBaseMotion((center + angle*baseWidth/2)/inPerDeg, (center - angle*baseWidth/2)/inPerDeg, kp, kd, false, true);
 }
 /**
+ * Drive along an arc using the gain schedule.
+ * @param radius
+ * radius of the arc in inches (negative: backwards)
+ *
+ * @param angleDeg
+ * change of the bearing in degrees (positive: clockwise)
+ */
+void baseArc(double radius, double angleDeg){
+  baseArc(radius, angleDeg, GAIN_SCHEDULED, GAIN_SCHEDULED);
+}
+/**
+ * Drive along the arc that leaves tangent to the current bearing and ends at a point (backwards if the
+ * point is behind the robot). The bearing turns by twice the angle between the bearing and the chord to
+ * the point; two arcs make an S-curve, with no point turn and no path to generate.
+ * @param x
+ * x-coordinate of the target
+ *
+ * @param y
+ * y-coordinate of the target
+ *
+ * @param kp
+ * proportional constant
+ *
+ * @param kd
+ * derivative constant
+ */
+void baseArcTo(double x, double y, double kp, double kd){
+  /** consistent copy of the pose from the odometry task (projected when chaining) */
+  PoseSnapshot pose = getBasePlanPose();
+  double errorX = x - pose.x, errorY = y - pose.y;
+  double chord = hypot(errorX, errorY), bearing = atan2(errorX, errorY);
+  int direction = 1;
+  double alpha = angleDiff(bearing, pose.angle);
+  if(fabs(alpha) >= halfPI){
+    direction = -1;
+    alpha = angleDiff(bearing, pose.angle + PI);
+  }
+  /** radius chord/(2 sin alpha) over a turn of 2 alpha; a straight line for alpha = 0 */
+  double center = direction*(fabs(alpha) < 1e-6? chord : chord*alpha/sin(alpha));
+  startBaseMotion((center + alpha*baseWidth)/inPerDeg, (center - alpha*baseWidth)/inPerDeg, kp, kd, false, true);
+}
+/**
+ * Drive along the arc to a point using the gain schedule.
+ * @param x
+ * x-coordinate of the target
+ *
+ * @param y
+ * y-coordinate of the target
+ */
+void baseArcTo(double x, double y){
+  baseArcTo(x, y, GAIN_SCHEDULED, GAIN_SCHEDULED);
+}
+/**
+ * Swing turn: turn about one side, which is held in place (hold brake mode, refer to BASE_SWING_HOLD_TOL),
+ * while the other side drives around it on a profile (the arc limits). For pivoting against a wall or a
+ * goal; unlike timerBase with unequal powers, the turn is profiled and ends at its angle.
+ * @param angleDeg
+ * change of the bearing in degrees (positive: clockwise)
+ *
+ * @param pivot
+ * side held in place (BASE_SIDE_LEFT or BASE_SIDE_RIGHT)
+ *
+ * @param kp
+ * proportional constant
+ *
+ * @param kd
+ * derivative constant
+ */
+void baseSwing(double angleDeg, BaseSide pivot, double kp, double kd){
+  /** refer to Odometry Documentation.docx: the other side travels around the pivot at the base width */
+  double travel = angleDeg*toRad*baseWidth/inPerDeg;
+  if(pivot == BASE_SIDE_LEFT) startBaseMotion(0, -travel, kp, kd, false, true, pivot);
+  else startBaseMotion(travel, 0, kp, kd, false, true, BASE_SIDE_RIGHT);
+}
+/**
+ * Swing turn using the gain schedule.
+ * @param angleDeg
+ * change of the bearing in degrees (positive: clockwise)
+ *
+ * @param pivot
+ * side held in place (BASE_SIDE_LEFT or BASE_SIDE_RIGHT)
+ */
+void baseSwing(double angleDeg, BaseSide pivot){
+  baseSwing(angleDeg, pivot, GAIN_SCHEDULED, GAIN_SCHEDULED);
+}
+/**
+ * Wait until the current movement has settled: both sides within the settle error from
+ * their targets, not moving faster than the settle derivative, for the settle time.
+ * The baseControl task notifies this task as soon as that happens,
+ * so it wakes within one control cycle.
  * Introduce a cutoff to base movements to interfere with the task when it takes too long
- * to reach a target (e.g. due to too small DISTANCE_LEEWAY or too small kP).
+ * to reach a target (e.g. due to too small a settle error or too small kP).
  * @param cutoff
  * cutoff duration in milliseconds
  */
 void waitBase(double cutoff){
   /** start the timer */
-	double start = millis();
-  /**
-   * while the encoder values are not within DISTANCE_LEEWAY from the target encoder values yet,
-   * or time has not run out:
-   * delay 20 ms
-   */
-	while(fabs(targetEncdL - BL.get_position()) > DISTANCE_LEEWAY && fabs(targetEncdR - BR.get_position()) > DISTANCE_LEEWAY && (millis()-start) < cutoff) delay(20);
+	Timer timer;
+  /** drop notifications left over from earlier waits, then register as the waiting task */
+  pros::c::task_notify_take(true, 0);
+  baseWaiter = pros::c::task_get_current();
+  recordTimeline(TIMELINE_WAIT_BEGIN, TIMELINE_WAIT_BASE);
+  while(!isBaseSettled() && !isBaseAborted()){
+    uint32_t elapsed = timer.elapsed();
+    if(elapsed >= cutoff) break;
+    pros::c::task_notify_take(true, cutoff - elapsed);
+  }
+  baseWaiter = NULL;
+  recordTimeline(TIMELINE_WAIT_END, TIMELINE_WAIT_BASE, !isBaseSettled() && !isBaseAborted());
   /** stop the motors */
-	FL.move(0);
-	BL.move(0);
-	FR.move(0);
-	BR.move(0);
+  drivetrain.stop();
 }
-/** boolean flag for whether there is a cap on base motor powers */
-bool basePowCapped = false;
+/** boolean flag for whether there is a cap on base motor powers (set after the cap, read by the baseControl task) */
+std::atomic<bool> basePowCapped(false);
 /** value of power cap */
-double absPowerCap;
+std::atomic<float> absPowerCap(MAX_POW);
 /**
- * Cap base motor powers.
+ * Cap base motor powers (the motor health derating may lower the cap further, refer to motorHealth.hpp).
  * @param cap
  * power cap
  */
 void capBasePow(double cap){
-	basePowCapped = true;
 	absPowerCap = cap;
+	basePowCapped = true;
 }
 /**
  * Remove the base motor power cap.
@@ -266,7 +1217,7 @@ void rmBaseCap(){
 	basePowCapped = false;
 }
 /** boolean flag for whether basePowerControl controls base motor powers (for timing movements) */
-bool basePaused = false;
+std::atomic<bool> basePaused(false);
 /**
  * Set the value of basePaused.
  * @param pause
@@ -275,6 +1226,32 @@ bool basePaused = false;
 void pauseBase(bool pause = true){
   basePaused = pause;
 }
+/**
+ * Mode of the base (refer to BaseControlMode): the one asked for, and the one the baseControl task
+ * switched to (it switches at the start of a cycle, refer to switchBaseMode)
+ */
+std::atomic<int> requestedBaseMode(BASE_MODE_AUTON), baseMode(BASE_MODE_AUTON);
+/**
+ * Hand the base to autonomous, to the driver, or to a driver assist. The current movement and the
+ * motion queue are dropped at the switch. While the base controller runs, the caller waits (up to
+ * REGISTRY_HANDOVER_TIMEOUT) for it to switch, so e.g. opcontrol only writes the motors once the
+ * controller has let them go, and an assist movement is only submitted once the controller drives.
+ * @param mode
+ * the new mode (with BASE_MODE_ASSIST, start the movement after this returns)
+ */
+void setBaseControlMode(BaseControlMode mode){
+  requestedBaseMode = mode;
+  if(pros::c::task_get_current() == baseControlTask.load() || !isTaskActive(ROBOT_CONTROL)) return;
+  Timer timer;
+  while(baseMode.load() != mode && !timer.passed(REGISTRY_HANDOVER_TIMEOUT)) pros::delay(1);
+}
+/**
+ * @return
+ * the mode the base controller drives the base in
+ */
+BaseControlMode getBaseControlMode(){
+  return (BaseControlMode)baseMode.load();
+}
 /**
  * Movement by raw power and timing.
  * @param powL
@@ -290,17 +1267,12 @@ void pauseBase(bool pause = true){
  * Obsolete. Do not use unless in desperate times.
  */
 void timerBase(double powL, double powR, double time){
-  double start = millis();
+  Timer timer;
   pauseBase();
-  FL.move(powL);
-  BL.move(powL);
-  FR.move(powR);
-  BR.move(powR);
-  while(millis() - start < time) delay(20);
-	FL.move(0);
-	BL.move(0);
-	FR.move(0);
-	BR.move(0);
+  wakeOdometry();
+  drivetrain.setPower(powL, powR);
+  while(!timer.passed(time)) delay(20);
+  drivetrain.stop();
 	pauseBase(false);
 }
 /**
@@ -313,71 +1285,1170 @@ void timerBase(double powL, double powR, double time){
  *
  * @param angleDeg
  * bearing of position in degrees
+ *
+ * @param keep
+ * coordinates that keep their uncertainty (refer to setCoords)
  */
-void resetCoords(double x, double y, double angleDeg){
-  /** set position */
-  position.setCoords(x, y, angleDeg);
+void resetCoords(double x, double y, double angleDeg, uint8_t keep){
+  /** set position (applied by the odometry task) */
+  setCoords(x, y, angleDeg, keep);
   /** tare all motors */
-  FL.tare_position();
-	FR.tare_position();
-	BL.tare_position();
-	BR.tare_position();
-  /** reset target encoder values */
-  targetEncdL = 0;
-  targetEncdR = 0;
-}
-/** Set target motor powers using a PD loop. */
+  drivetrain.tare();
+  /** reset target encoder values and the profile (applied by the baseControl task) */
+  stopPursuit();
+  BaseCommand command = makeBaseCommand(BASE_COMMAND_RESET);
+  submitBaseCommand(command);
+}
+/**
+ * Square the base to a field wall: drive into it until both sides are seated (refer to WALL_CONTACT_RULE),
+ * then reset the coordinates: the bearing square to the wall, the coordinate across the wall from the
+ * bumper touching it, and the coordinate along the wall from the odometry.
+ * Replaces timerBase followed by resetCoords, and ends as soon as the base is seated.
+ * @param wall
+ * the wall driven into
+ *
+ * @param power
+ * power of both sides: positive drives the front into the wall, negative the back
+ *
+ * @param timeout
+ * give up after this many ms
+ *
+ * @return
+ * false if both sides were not seated in time, or not square to the wall (the coordinates are not changed)
+ */
+bool baseSquareToWall(FieldWall wall, double power, uint32_t timeout){
+  const StallRule rule = WALL_CONTACT_RULE;
+  StallDetector contacts[BASE_MOTORS];
+  for(int i = 0; i < BASE_MOTORS; i++) contacts[i].setRule(rule);
+  bool moved[2] = {false, false}, seated[2] = {false, false};
+  Timer timer;
+  pauseBase();
+  wakeOdometry();
+  drivetrain.setPower(power, power);
+  while(!(seated[0] && seated[1]) && !timer.passed(timeout)){
+    delay(BASE_CONTROL_DT);
+    uint64_t now = micros();
+    bool armed = timer.passed(WALL_ARM_TIME);
+    MotorSnapshot snapshot = getMotorSnapshot();
+    for(int side = 0; side < 2; side++){
+      /** left: the front & back left motors, right: the front & back right motors */
+      BaseMotor front = side == 0? BASE_FRONT_LEFT : BASE_FRONT_RIGHT, back = side == 0? BASE_BACK_LEFT : BASE_BACK_RIGHT;
+      double velFront = snapshot.velocity[front], velBack = snapshot.velocity[back];
+      moved[side] = moved[side] || fmin(fabs(velFront), fabs(velBack)) > WALL_MOVING_VELOCITY;
+      /** both detectors are fed every cycle, so a contact needs the whole time on both motors */
+      bool contactFront = contacts[front].isStalled(power, snapshot.current[front], velFront, now);
+      bool contactBack = contacts[back].isStalled(power, snapshot.current[back], velBack, now);
+      if((moved[side] || armed) && contactFront && contactBack) seated[side] = true;
+    }
+  }
+  drivetrain.stop();
+  pauseBase(false);
+  if(!(seated[0] && seated[1])) return false;
+  /** bearing facing the wall (the back faces it when reversing), on the current turn of the heading */
+  double facing = wall*90.0 + (power < 0? 180 : 0);
+  PoseSnapshot pose = getPose();
+  double error = angleDiffDeg(facing, pose.angle*toDeg);
+  if(fabs(error) > WALL_MAX_ANGLE) return false;
+  double angleDeg = pose.angle*toDeg + error;
+  double offset = power < 0? backOffset : frontOffset;
+  double x = pose.x, y = pose.y;
+  switch(wall){
+    case WALL_TOP: y = WALL_FIELD_SIZE - WALL_ORIGIN_Y - offset; break;
+    case WALL_RIGHT: x = WALL_FIELD_SIZE - WALL_ORIGIN_X - offset; break;
+    case WALL_BOTTOM: y = offset - WALL_ORIGIN_Y; break;
+    case WALL_LEFT: x = offset - WALL_ORIGIN_X; break;
+  }
+  /** the coordinate along the wall still comes from the odometry, and so does its uncertainty */
+  resetCoords(x, y, angleDeg, wall == WALL_TOP || wall == WALL_BOTTOM? ODOM_KEEP_X : ODOM_KEEP_Y);
+  return true;
+}
+/**
+ * Square the base to a field wall (baseSquareToWall) only if the pose has drifted (isPoseUncertain at the
+ * default thresholds), so a routine can place a relocalization wherever one may be needed and only spend
+ * the time when it is.
+ * @param wall, power, timeout
+ * refer to baseSquareToWall
+ *
+ * @return
+ * true if the pose was certain enough or the base was squared
+ */
+bool baseRelocalize(FieldWall wall, double power, uint32_t timeout){
+  if(!isPoseUncertain()) return true;
+  return baseSquareToWall(wall, power, timeout);
+}
+/**
+ * Stop the current movement: the base brakes and holds where it is (e.g. when an action group race ends).
+ */
+void stopBase(){
+  stopPursuit();
+  BaseCommand command = makeBaseCommand(BASE_COMMAND_STOP);
+  submitBaseCommand(command);
+}
+/** latency of the last control cycle, from sensor read to motor write, in microseconds */
+uint64_t baseControlLatency = 0;
+/**
+ * Retrieve the end-to-end latency of the last control cycle.
+ * @return
+ * time from reading the sensors to writing the motors in microseconds
+ */
+uint64_t getBaseControlLatency(){
+  return baseControlLatency;
+}
+/** version of the sensor frame used by the last control cycle */
+uint32_t lastSensorVersion = 0;
+/** base failsafes of the watchdog handled so far (baseControl task only) */
+uint32_t handledFailsafes = 0;
+/**
+ * Stage 1: take one snapshot of the base sensors.
+ * The snapshot is the sensor frame published by the odometry tick that woke the cycle,
+ * so no sensor is read twice. If odometry has not published a new frame
+ * (e.g. the task is not running) the sensors are read directly instead.
+ * Every later stage of the cycle works on this snapshot only.
+ * @param frame
+ * control frame of the current cycle
+ */
+HOT_PATH void readBaseSensors(BaseControlFrame &frame){
+  frame.readTime = micros();
+  uint32_t version;
+  SensorFrame sensors = getSensorFrame(&version);
+  if(version == lastSensorVersion) sensors = readSensorFrame();
+  lastSensorVersion = version;
+  frame.sensors = sensors;
+  frame.encdL = sensors.motorL;
+  frame.encdR = sensors.motorR;
+}
+/**
+ * Stage 2: sample the motion profile (or the replayed trajectory, or the pure-pursuit path)
+ * for the setpoints of this cycle, and of the strafe of a holonomic base. The velocities and accelerations
+ * are sampled BASE_LOOKAHEAD ahead of the positions, so the feedforward leads the actuation latency.
+ * @param frame
+ * control frame of the current cycle
+ */
+HOT_PATH void sampleBaseProfile(BaseControlFrame &frame){
+  frame.trackPosition = true;
+  frame.strafe = false;
+  frame.output = outputMode;
+  frame.kp = kP;
+  frame.kd = kD;
+  learningBin = -1;
+  BaseModel model = getBaseModel();
+  frame.ffL = model.left;
+  frame.ffR = model.right;
+  /** the cap of capBasePow (or of the parameter table), lowered further by the motor health derating (refer to motorHealth.hpp) */
+  const ParamTable *params = getParams();
+  frame.powerCap = fmin(basePowCapped? absPowerCap.load() : params->values[PARAM_MAX_POW], getBaseDerateCap());
+  frame.rampPow = params->values[PARAM_RAMPING_POW];
+  if(pursuitMode){
+    /** pure pursuit commands the side velocities (and the strafe) only */
+    if(computePurePursuit(getPose(), frame.setpointVelL, frame.setpointVelR, frame.setpointVelS)){
+      frame.trackPosition = false;
+      frame.strafe = HOLONOMIC_BASE;
+      return;
+    }
+    /** end of the path: hold the base where it is */
+    pursuitMode = false;
+    targetEncdL = profileStartL = frame.encdL;
+    targetEncdR = profileStartR = frame.encdR;
+    profileScaleL = profileScaleR = 0;
+  }
+  if(poseMoveMode){
+    /** a move to pose commands the side velocities (and the strafe) only */
+    PoseSnapshot pose = getPose();
+    if(computeMoveToPose(pose, poseMove, frame.setpointVelL, frame.setpointVelR, frame.setpointVelS)){
+      frame.trackPosition = false;
+      frame.strafe = HOLONOMIC_BASE;
+      return;
+    }
+    /**
+     * at the goal: hold the base on the goal along its heading and at the goal bearing (it is still rolling,
+     * so holding where it is would leave the roll as an error)
+     */
+    poseMoveMode = false;
+    double distance = (poseMove.x - pose.x)*sin(pose.angle) + (poseMove.y - pose.y)*cos(pose.angle);
+    double headingError = angleDiff(poseMove.angle, pose.angle);
+    /** refer to Odometry Documentation.docx: side travel of a turn */
+    targetEncdL = profileStartL = frame.encdL + (distance + headingError*baseWidth/2)/inPerDeg;
+    targetEncdR = profileStartR = frame.encdR + (distance - headingError*baseWidth/2)/inPerDeg;
+    profileScaleL = profileScaleR = 0;
+  }
+  if(baseTrajectory != NULL){
+    /**
+     * setpoints at the time elapsed since the start (the sensor frame's timestamp, not the count of cycles),
+     * interpolated between the segments around it
+     */
+    double t = movementTime(frame.readTime), end = (baseTrajectory->length - 1)*baseTrajectory->dt;
+    double fraction;
+    int i = trajectoryIndex(*baseTrajectory, t, fraction);
+    bool finished = t >= end;
+    /** a streamed trajectory reads the chunks from here on (refer to trajectoryStream.hpp) */
+    advanceStream(*baseTrajectory, i);
+    TrajectorySample left = sampleTrajectory(*baseTrajectory, false, t);
+    TrajectorySample right = sampleTrajectory(*baseTrajectory, true, t);
+    /** BASE_LOOKAHEAD ahead, for the velocities and accelerations */
+    double ahead = t + BASE_LOOKAHEAD/1000.0;
+    bool finishedAhead = ahead >= end;
+    TrajectorySample leftAhead = BASE_LOOKAHEAD? sampleTrajectory(*baseTrajectory, false, ahead) : left;
+    TrajectorySample rightAhead = BASE_LOOKAHEAD? sampleTrajectory(*baseTrajectory, true, ahead) : right;
+    if(ramseteMode){
+      if(!finished){
+        /** RAMSETE commands the side velocities only, on the centre's reference pose and velocities */
+        if(mpcMode) computeMpc(getPose(), *baseTrajectory, t, frame.setpointVelL, frame.setpointVelR);
+        else{
+          PackedPose reference = sampleTrajectoryPose(*baseTrajectory, t);
+          computeRamsete(getPose(), reference.x, reference.y, reference.angle, (left.velocity + right.velocity)/2,
+                         (left.velocity - right.velocity)/baseWidth, frame.setpointVelL, frame.setpointVelR);
+        }
+        frame.setpointAccL = leftAhead.acceleration;
+        frame.setpointAccR = rightAhead.acceleration;
+        frame.trackPosition = false;
+        return;
+      }
+      /** end of the trajectory: hold the base where it is */
+      baseTrajectory = NULL;
+      ramseteMode = false;
+      targetEncdL = profileStartL = frame.encdL;
+      targetEncdR = profileStartR = frame.encdR;
+      profileScaleL = profileScaleR = 0;
+    }
+    else{
+      if(LEARNED_FEEDFORWARD){
+        learningBin = t*1000/BASE_CONTROL_DT;
+        getLearnedFeedforward(learningId, learningBin, frame.learnedL, frame.learnedR);
+      }
+      setpointEncdL = profileStartL + left.position/inPerDeg;
+      setpointEncdR = profileStartR + right.position/inPerDeg;
+      frame.setpointEncdL = setpointEncdL;
+      frame.setpointEncdR = setpointEncdR;
+      frame.setpointVelL = finishedAhead? 0 : leftAhead.velocity;
+      frame.setpointVelR = finishedAhead? 0 : rightAhead.velocity;
+      frame.setpointAccL = finishedAhead? 0 : leftAhead.acceleration;
+      frame.setpointAccR = finishedAhead? 0 : rightAhead.acceleration;
+      return;
+    }
+  }
+  double t = movementTime(frame.readTime);
+  ProfileSetpoint setpoint = baseProfile.sample(t);
+  ProfileSetpoint ahead = BASE_LOOKAHEAD? baseProfile.sample(t + BASE_LOOKAHEAD/1000.0) : setpoint;
+  setpointEncdL = profileStartL + profileScaleL*setpoint.pos;
+  setpointEncdR = profileStartR + profileScaleR*setpoint.pos;
+  /** profile velocity of each side in inches per second */
+  frame.setpointVelL = profileScaleL*ahead.vel*inPerDeg;
+  frame.setpointVelR = profileScaleR*ahead.vel*inPerDeg;
+  frame.setpointAccL = profileScaleL*ahead.acc*inPerDeg;
+  frame.setpointAccR = profileScaleR*ahead.acc*inPerDeg;
+  if(strafeActive){
+    /** strafe setpoints in inches across the bearing held */
+    frame.strafe = true;
+    frame.setpointS = profileStartS + profileScaleS*setpoint.pos;
+    frame.setpointVelS = profileScaleS*ahead.vel;
+    frame.setpointAccS = profileScaleS*ahead.acc;
+    frame.lateralS = lateralOffset(getPose(), strafeAxis);
+  }
+  if(blendScaleL != 0 || blendScaleR != 0){
+    /** remainder of the chained-from profile (negative distance still to go, tending to 0) */
+    double blendTime = elapsedTime(frame.readTime, blendStartTime);
+    ProfileSetpoint blend = blendProfile.sample(blendTime);
+    ProfileSetpoint blendAhead = BASE_LOOKAHEAD? blendProfile.sample(blendTime + BASE_LOOKAHEAD/1000.0) : blend;
+    double remaining = blend.pos - blendProfile.getDistance();
+    setpointEncdL += blendScaleL*remaining;
+    setpointEncdR += blendScaleR*remaining;
+    frame.setpointVelL += blendScaleL*blendAhead.vel*inPerDeg;
+    frame.setpointVelR += blendScaleR*blendAhead.vel*inPerDeg;
+    frame.setpointAccL += blendScaleL*blendAhead.acc*inPerDeg;
+    frame.setpointAccR += blendScaleR*blendAhead.acc*inPerDeg;
+    if(remaining == 0) blendScaleL = blendScaleR = 0;
+  }
+  frame.setpointEncdL = setpointEncdL;
+  frame.setpointEncdR = setpointEncdR;
+}
+/**
+ * Stage 2b (pose control): move the targets of the current movement to where the live pose
+ * puts its goal. The distance to go is the goal point projected on the bearing, and the heading
+ * error is taken towards the goal point (or the goal bearing, for turns and close to the point).
+ * The profile is shifted with the targets, so it keeps its shape and the setpoints stay continuous;
+ * errors of earlier movements and odometry corrections are taken out instead of adding up.
+ * Goal bearings are staged on the continuous heading (the pose's bearing plus the turn to make), so the error
+ * to one is not wrapped: a turn over half a turn (baseTurnRelative, a directed baseTurn) keeps its way round.
+ * @param frame
+ * control frame of the current cycle
+ */
+HOT_PATH void correctBasePose(BaseControlFrame &frame){
+  if(!poseGoalActive || pursuitMode || poseMoveMode || baseTrajectory != NULL) return;
+  PoseSnapshot pose = getPose();
+  double errorX = poseGoal.x - pose.x, errorY = poseGoal.y - pose.y;
+  double distance = errorX*sin(pose.angle) + errorY*cos(pose.angle);
+  double headingError = poseGoal.angle - pose.angle;
+  if(poseGoal.toPoint && hypot(errorX, errorY) > POSE_AIM_DIST){
+    headingError = angleDiff(atan2(errorX, errorY) + (poseGoal.direction < 0? PI : 0), pose.angle);
+  }
+  /** refer to Odometry Documentation.docx: side travel of a turn */
+  double shiftL = frame.encdL + (distance + headingError*baseWidth/2)/inPerDeg - targetEncdL;
+  double shiftR = frame.encdR + (distance - headingError*baseWidth/2)/inPerDeg - targetEncdR;
+  targetEncdL += shiftL;
+  targetEncdR += shiftR;
+  profileStartL += shiftL;
+  profileStartR += shiftR;
+  setpointEncdL += shiftL;
+  setpointEncdR += shiftR;
+  frame.setpointEncdL = setpointEncdL;
+  frame.setpointEncdR = setpointEncdR;
+}
+/**
+ * Stage 2c (heading hold, IMU turns): measure the heading error of a straight movement holding its bearing, or
+ * of a turn closed on the heading. A turn holds its goal bearing less the turn its profile has left, on the
+ * IMU's turn since its start (the odometry heading while the IMU does not respond). Both bearings are continuous
+ * (refer to correctBasePose), so the error is not wrapped.
+ * @param frame
+ * control frame of the current cycle
+ */
+HOT_PATH void measureBaseHeading(BaseControlFrame &frame){
+  frame.holdHeading = headingActive && frame.trackPosition;
+  frame.pivot = frame.trackPosition? pivotSide : BASE_SIDE_NONE;
+  frame.headingError = 0;
+  frame.headingGain = headingTurn? BASE_TURN_HEADING_GAIN : BASE_HEADING_GAIN;
+  if(!frame.holdHeading) return;
+  double heading = getPose().angle, held = heldHeading;
+  if(headingTurn){
+    const SensorFrame &sensors = frame.sensors;
+    if(sensors.imuValid && !turnImuAligned){
+      turnImuOffset = heading - sensors.imuRotation*toRad;
+      turnImuAligned = true;
+    }
+    if(sensors.imuValid) heading = sensors.imuRotation*toRad + turnImuOffset;
+    /** refer to Odometry Documentation.docx: turn of the side travel left */
+    held -= ((targetEncdL - setpointEncdL) - (targetEncdR - setpointEncdR))*inPerDeg/baseWidth;
+  }
+  frame.headingError = held - heading;
+}
+/**
+ * Abort the current movement (baseControl task only): the base holds where it is from this cycle on,
+ * as after stopBase, and the task waiting on the movement is woken.
+ * @param frame
+ * control frame of the current cycle
+ */
+void abortBaseMovement(BaseControlFrame &frame){
+  stopPursuit();
+  targetEncdL = profileStartL = setpointEncdL = frame.encdL;
+  targetEncdR = profileStartR = setpointEncdR = frame.encdR;
+  profileScaleL = profileScaleR = 0;
+  blendScaleL = blendScaleR = 0;
+  baseTrajectory = NULL;
+  pursuitMode = false;
+  poseMoveMode = false;
+  poseGoalActive = false;
+  headingActive = false;
+  pivotSide = BASE_SIDE_NONE;
+  strafeActive = false;
+  frame.trackPosition = true;
+  frame.strafe = false;
+  frame.setpointVelS = frame.setpointAccS = 0;
+  frame.setpointEncdL = frame.encdL;
+  frame.setpointEncdR = frame.encdR;
+  frame.setpointVelL = frame.setpointVelR = 0;
+  frame.setpointAccL = frame.setpointAccR = 0;
+  frame.holdHeading = false;
+  frame.headingError = 0;
+  frame.pivot = BASE_SIDE_NONE;
+  abortedMotionId = appliedMotionId;
+  pros::task_t waiter = baseWaiter.exchange(NULL);
+  if(waiter != NULL) pros::c::task_notify(waiter);
+}
+/**
+ * Stage 1b: the watchdog stopped the base (a task it depends on faulted, refer to watchdog.hpp): abort the
+ * movement, so the base holds where it is instead of resuming it, and waitBase returns.
+ * @param frame
+ * control frame of the current cycle
+ */
+void failsafeBase(BaseControlFrame &frame){
+  uint32_t failsafes = getBaseFailsafeCount();
+  if(failsafes == handledFailsafes) return;
+  handledFailsafes = failsafes;
+  abortBaseMovement(frame);
+}
+/** last motion id applied when the base switched mode (baseControl task only) */
+uint32_t modeMotionId = 0;
+/**
+ * Stage 1c: switch to the mode asked for by setBaseControlMode. The movement is aborted, so the base
+ * holds where it is and the task waiting on it goes on, and the motion queue is dropped; the brake modes
+ * are set again once the controller writes the motors. An assist returns the base to the driver once a
+ * movement submitted after the switch has settled or aborted.
+ * @param frame
+ * control frame of the current cycle
+ *
+ * @return
+ * the mode of the cycle
+ */
+BaseControlMode switchBaseMode(BaseControlFrame &frame){
+  int mode = baseMode.load();
+  int assisted = BASE_MODE_ASSIST;
+  if(mode == BASE_MODE_ASSIST && appliedMotionId != modeMotionId && (isBaseSettled() || isBaseAborted()) && isMotionQueueIdle()){
+    requestedBaseMode.compare_exchange_strong(assisted, BASE_MODE_DRIVER);
+  }
+  int requested = requestedBaseMode.load();
+  if(requested == mode) return (BaseControlMode)mode;
+  abortBaseMovement(frame);
+  clearMotionQueue();
+  updateMotionQueue(frame);
+  modeMotionId = appliedMotionId;
+  baseBrakeModeL = baseBrakeModeR = -1;
+  if(requested == BASE_MODE_DRIVER) setCurrentDemand(BUDGET_BASE, CURRENT_RUNNING);
+  baseMode = requested;
+  return (BaseControlMode)requested;
+}
+/**
+ * Driver mode: record the cycle (the powers the driver pipeline wrote) instead of running the pipeline.
+ * @param frame
+ * control frame of the current cycle, with its sensors read
+ */
+void recordDriverFrame(BaseControlFrame &frame){
+  frame.writeTime = micros();
+  frame.powerCap = MAX_POW;
+  frame.powerL = frame.targetPowerL = drivetrain.getLeftVoltage()*127.0/12000;
+  frame.powerR = frame.targetPowerR = drivetrain.getRightVoltage()*127.0/12000;
+  if(frame.outer) recordFlight(RECORDER_DRIVER, frame);
+}
+/**
+ * Stage 2d (BASE_IMPACT_DETECTION, with the IMU): feed the impact detector at every new IMU sample with the
+ * horizontal acceleration, the one the movement commands (its setpoint acceleration and the centripetal
+ * acceleration of the pose) and the tilt. An impact during a movement aborts it (refer to abortBaseMovement);
+ * every impact is published (getBaseImpact, TIMELINE_IMPACT). The power increments are limited for
+ * BASE_IMPACT_RECOVERY after it, and while the tilt exceeds BASE_IMPACT_TILT.
+ * @param frame
+ * control frame of the current cycle
+ */
+HOT_PATH void detectBaseImpact(BaseControlFrame &frame){
+  frame.rampLimit = 0;
+  const SensorFrame &sensors = frame.sensors;
+  if(!BASE_IMPACT_DETECTION || !sensors.imuValid) return;
+  if(basePaused){
+    baseImpacts.reset();
+    return;
+  }
+  double tilt = fmax(fabs(sensors.imuPitch), fabs(sensors.imuRoll));
+  if(frame.readTime < impactUntil || tilt > BASE_IMPACT_TILT) frame.rampLimit = BASE_IMPACT_RAMP;
+  if(sensors.timestamp == impactSample) return;
+  impactSample = sensors.timestamp;
+  PoseSnapshot pose = getPose();
+  double accel = hypot(sensors.imuAccelX, sensors.imuAccelY);
+  double expected = hypot((frame.setpointAccL + frame.setpointAccR)/2, pose.linVel*pose.angVel)/IMPACT_G;
+  ImpactType type = baseImpacts.update(accel, expected, tilt, sensors.timestamp);
+  if(type == IMPACT_NONE) return;
+  bool moving = settledMotionId.load() != appliedMotionId && abortedMotionId.load() != appliedMotionId;
+  baseImpact.write({type, moving? appliedMotionId : 0, pose.x, pose.y, pose.angle, pose.linVel < 0, sensors.timestamp});
+  baseImpactCount++;
+  recordTimeline(TIMELINE_IMPACT, type, moving);
+  impactUntil = frame.readTime + BASE_IMPACT_RECOVERY*1000ull;
+  frame.rampLimit = BASE_IMPACT_RAMP;
+  if(moving) abortBaseMovement(frame);
+}
+/**
+ * Cross-couple the side errors of a movement holding its bearing (refer to BASE_HEADING_HOLD): the
+ * distance error (mean of the sides) is kept, and the heading error, as the side travel that turns it out,
+ * replaces the difference of the sides. The change of the heading error for the D term is taken between
+ * position loop cycles (from the encoders on the first cycle of the hold).
+ * @param frame
+ * control frame of the current cycle
+ *
+ * @param prevFrame
+ * control frame of the previous cycle
+ *
+ * @param errorL, errorR
+ * side errors (encoder degrees); updated
+ *
+ * @param deltaL, deltaR
+ * changes of the side errors (encoder degrees); updated
+ */
+HOT_PATH void holdBaseHeading(const BaseControlFrame &frame, const BaseControlFrame &prevFrame, double &errorL, double &errorR,
+                              double &deltaL, double &deltaR){
+  if(!frame.holdHeading) return;
+  /** refer to Odometry Documentation.docx: side travel of a turn */
+  double travel = frame.headingGain*baseWidth/2/inPerDeg;
+  double distance = (errorL + errorR)/2, distanceDelta = (deltaL + deltaR)/2;
+  double heading = frame.headingError*travel;
+  double headingDelta = prevFrame.holdHeading? (frame.headingError - prevFrame.headingError)*travel : (deltaL - deltaR)/2;
+  errorL = distance + heading;
+  errorR = distance - heading;
+  deltaL = distanceDelta + headingDelta;
+  deltaR = distanceDelta - headingDelta;
+}
+/**
+ * Leave the pivot of a swing turn to its motors: while its error is within BASE_SWING_HOLD_TOL it gets
+ * 0 power (and velocity), so the hold brake mode keeps it in place; beyond, the PD correction stands.
+ * @param frame
+ * control frame of the current cycle (its target powers and velocities computed)
+ */
+HOT_PATH void holdBasePivot(BaseControlFrame &frame){
+  if(frame.pivot == BASE_SIDE_LEFT && fabs(frame.errorEncdL)*inPerDeg <= BASE_SWING_HOLD_TOL){
+    frame.targetPowerL = frame.velCmdL = frame.targetVelL = 0;
+  }
+  if(frame.pivot == BASE_SIDE_RIGHT && fabs(frame.errorEncdR)*inPerDeg <= BASE_SWING_HOLD_TOL){
+    frame.targetPowerR = frame.velCmdR = frame.targetVelR = 0;
+  }
+}
+/**
+ * Feedforward power of one side from its profile setpoint: kS*sgn(v) + kV*v + kA*a.
+ * @param ff
+ * feedforward of the side
+ *
+ * @param vel
+ * setpoint velocity in inches per second
+ *
+ * @param acc
+ * setpoint acceleration in inches per second squared
+ *
+ * @return
+ * feedforward power
+ */
+HOT_PATH double baseFeedforward(const BaseFeedforward &ff, double vel, double acc){
+  double staticPower = vel > 0? ff.ks : vel < 0? -ff.ks : 0;
+  return staticPower + ff.kv*vel + ff.ka*acc;
+}
+/**
+ * Velocities of the sides from the raw motor encoder counts, over the device time between the motors'
+ * samples. The motors update their data every 10 ms on their own timeline, so differences of the
+ * positions read every cycle would sometimes span no update and sometimes two.
+ * @param frame
+ * control frame of the current cycle
+ *
+ * @param prevFrame
+ * control frame of the previous cycle (its samples and velocities)
+ */
+HOT_PATH void estimateMotorVelocity(BaseControlFrame &frame, const BaseControlFrame &prevFrame){
+  frame.motorVelL = prevFrame.motorVelL;
+  frame.motorVelR = prevFrame.motorVelR;
+  /** no previous snapshot (first cycle after a handover) */
+  if(prevFrame.sensors.timestamp == 0) return;
+  const SensorFrame &now = frame.sensors, &prev = prevFrame.sensors;
+  /** the counts of a side are the sum of its two motors */
+  int32_t dtL = now.motorTimeL - prev.motorTimeL, dtR = now.motorTimeR - prev.motorTimeR;
+  if(dtL > 0 && now.rawL != PROS_ERR && prev.rawL != PROS_ERR) frame.motorVelL = (now.rawL - prev.rawL)/(2*DRIVE_COUNTS_PER_DEG)*1000/dtL;
+  if(dtR > 0 && now.rawR != PROS_ERR && prev.rawR != PROS_ERR) frame.motorVelR = (now.rawR - prev.rawR)/(2*DRIVE_COUNTS_PER_DEG)*1000/dtR;
+}
+/**
+ * Change of the errors over a position loop cycle for the D term: the change of the setpoints less the
+ * travel of the motors at their measured velocities (refer to estimateMotorVelocity).
+ * @param frame
+ * control frame of the current cycle (its motor velocities estimated)
+ *
+ * @param prevFrame
+ * control frame of the previous cycle
+ *
+ * @param deltaL
+ * set to the change of the left error (encoder degrees)
+ *
+ * @param deltaR
+ * set to the change of the right error (encoder degrees)
+ */
+HOT_PATH void errorChange(const BaseControlFrame &frame, const BaseControlFrame &prevFrame, double &deltaL, double &deltaR){
+  deltaL = -frame.motorVelL*BASE_CONTROL_DT/1000.0;
+  deltaR = -frame.motorVelR*BASE_CONTROL_DT/1000.0;
+  /** setpoints of a tracked previous cycle only (not after a handover or pure pursuit) */
+  if(prevFrame.sensors.timestamp == 0 || !prevFrame.trackPosition) return;
+  deltaL += frame.setpointEncdL - prevFrame.setpointEncdL;
+  deltaR += frame.setpointEncdR - prevFrame.setpointEncdR;
+}
+/**
+ * Stage 2e (BASE_LQR_GAINS): take kP/kD of a movement following the LQR table from the table at the mean
+ * velocity of the side setpoints (refer to lqrGains.hpp).
+ * @param frame
+ * control frame of the current cycle
+ */
+HOT_PATH void scheduleLqrGains(BaseControlFrame &frame){
+  if(!BASE_LQR_GAINS || !lqrGains) return;
+  getLqrPD((frame.setpointVelL + frame.setpointVelR)/2, frame.kp, frame.kd);
+}
+/**
+ * Stage 3: compute the target powers using a PD loop on the profile setpoints
+ * plus the kS/kV/kA feedforward.
+ * In BASE_OUTPUT_VELOCITY the same PD correction is converted to a velocity correction
+ * (through kV) and added to the setpoint velocity instead.
+ * @param frame
+ * control frame of the current cycle
+ *
+ * @param prevFrame
+ * control frame of the previous cycle (for the D loop)
+ */
+HOT_PATH void computeBasePD(BaseControlFrame &frame, const BaseControlFrame &prevFrame){
+  double correctionL = 0, correctionR = 0;
+  estimateMotorVelocity(frame, prevFrame);
+  /** no position tracking with velocity commands only (pure pursuit) */
+  if(frame.trackPosition){
+    /** error from current encoder values to the setpoints */
+    frame.errorEncdL = frame.setpointEncdL - frame.encdL;
+    frame.errorEncdR = frame.setpointEncdR - frame.encdR;
+    /** PD loop (on the distance and the heading when holding the bearing) */
+    double errorL = frame.errorEncdL, errorR = frame.errorEncdR, deltaErrorEncdL, deltaErrorEncdR;
+    errorChange(frame, prevFrame, deltaErrorEncdL, deltaErrorEncdR);
+    holdBaseHeading(frame, prevFrame, errorL, errorR, deltaErrorEncdL, deltaErrorEncdR);
+    correctionL = frame.kp*errorL + frame.kd*deltaErrorEncdL;
+    correctionR = frame.kp*errorR + frame.kd*deltaErrorEncdR;
+  }
+  /** the learned feedforward joins the PD correction (power, or a velocity through kV) */
+  correctionL += frame.learnedL;
+  correctionR += frame.learnedR;
+  frame.targetPowerL = baseFeedforward(frame.ffL, frame.setpointVelL, frame.setpointAccL) + correctionL;
+  frame.targetPowerR = baseFeedforward(frame.ffR, frame.setpointVelR, frame.setpointAccR) + correctionR;
+  frame.velCmdL = frame.setpointVelL + correctionL/frame.ffL.kv;
+  frame.velCmdR = frame.setpointVelR + correctionR/frame.ffR.kv;
+  /** convert inches per second to motor rpm */
+  frame.targetVelL = frame.velCmdL/inPerDeg/6;
+  frame.targetVelR = frame.velCmdR/inPerDeg/6;
+  holdBasePivot(frame);
+}
+/**
+ * Stage 3d (LEARNED_FEEDFORWARD): in learning mode, record the side errors of the trajectory followed for
+ * its next learning update (refer to learnedFeedforward.hpp).
+ * @param frame
+ * control frame of the current cycle
+ */
+HOT_PATH void recordBaseLearning(const BaseControlFrame &frame){
+  if(!LEARNED_FEEDFORWARD || learningBin < 0) return;
+  recordLearning(learningId, learningBin, frame.errorEncdL*inPerDeg, frame.errorEncdR*inPerDeg);
+}
+/**
+ * Stage 3b (BASE_CASCADE): inner wheel velocity loop. The velocities commanded by the position loop
+ * (the PD correction converted through kV, as for BASE_OUTPUT_VELOCITY) are closed on the wheel
+ * velocities (refer to BASE_VEL_TICKS): power = kS/kV/kA feedforward + BASE_VEL_KP * velocity error.
+ * Runs every inner cycle, so a disturbance is countered within BASE_INNER_DT. Velocity commands are
+ * left to the motors' own velocity loop.
+ * @param frame
+ * control frame of the current cycle
+ *
+ * @param prevFrame
+ * control frame of the previous cycle (for the wheel velocities)
+ */
+HOT_PATH void computeBaseVelocity(BaseControlFrame &frame, const BaseControlFrame &prevFrame){
+  frame.wheelVelL = prevFrame.wheelVelL;
+  frame.wheelVelR = prevFrame.wheelVelR;
+#if BASE_VEL_TICKS
+  /** the estimates start over after a handover (no previous snapshot) */
+  frame.tickL = prevFrame.sensors.timestamp != 0? prevFrame.tickL : TickVelocity();
+  frame.tickR = prevFrame.sensors.timestamp != 0? prevFrame.tickR : TickVelocity();
+  double velL = stepTickVelocity(frame.tickL, frame.sensors.encdL, frame.sensors.timestamp)*inPerDeg;
+  double velR = stepTickVelocity(frame.tickR, frame.sensors.encdR, frame.sensors.timestamp)*inPerDeg;
+  if(prevFrame.sensors.timestamp != 0 && frame.sensors.timestamp > prevFrame.sensors.timestamp){
+    frame.wheelVelL += (velL - frame.wheelVelL)*BASE_VEL_FILTER;
+    frame.wheelVelR += (velR - frame.wheelVelR)*BASE_VEL_FILTER;
+  }
+#else
+  /** no previous snapshot (first cycle after a handover) or no new one: keep the last velocities */
+  if(prevFrame.sensors.timestamp != 0 && frame.sensors.timestamp > prevFrame.sensors.timestamp){
+    double dt = (frame.sensors.timestamp - prevFrame.sensors.timestamp)*1e-6;
+    frame.wheelVelL += ((frame.encdL - prevFrame.encdL)*inPerDeg/dt - frame.wheelVelL)*BASE_VEL_FILTER;
+    frame.wheelVelR += ((frame.encdR - prevFrame.encdR)*inPerDeg/dt - frame.wheelVelR)*BASE_VEL_FILTER;
+  }
+#endif
+  if(frame.output == BASE_OUTPUT_VELOCITY) return;
+  frame.targetPowerL = baseFeedforward(frame.ffL, frame.velCmdL, frame.setpointAccL) + BASE_VEL_KP*(frame.velCmdL - frame.wheelVelL);
+  frame.targetPowerR = baseFeedforward(frame.ffR, frame.velCmdR, frame.setpointAccR) + BASE_VEL_KP*(frame.velCmdR - frame.wheelVelR);
+}
+/**
+ * Stage 3c (holonomic base): the strafe. A translation closes the strafe on the pose across the bearing it holds
+ * with the PD of the movement (its gains per encoder degree, as the wheels strafe as far as they roll) on top of
+ * the feedforward of the side model; the velocity controllers command the strafe velocity only.
+ * @param frame
+ * control frame of the current cycle
+ *
+ * @param prevFrame
+ * control frame of the previous cycle (for the D term)
+ */
+HOT_PATH void computeBaseStrafe(BaseControlFrame &frame, const BaseControlFrame &prevFrame){
+  frame.errorS = 0;
+  frame.targetPowerS = frame.targetVelS = 0;
+  if(!frame.strafe) return;
+  double correction = 0;
+  if(frame.trackPosition){
+    frame.errorS = frame.setpointS - frame.lateralS;
+    /** change of the error over a position loop cycle (none on the first cycle of the strafe) */
+    double delta = prevFrame.strafe && prevFrame.trackPosition? frame.errorS - prevFrame.errorS : 0;
+    correction = (frame.kp*frame.errorS + frame.kd*delta)/inPerDeg;
+  }
+  frame.targetPowerS = baseFeedforward(frame.ffL, frame.setpointVelS, frame.setpointAccS) + correction;
+  /** convert inches per second to motor rpm */
+  frame.targetVelS = (frame.setpointVelS + correction/frame.ffL.kv)/inPerDeg/6;
+}
+/**
+ * Stage 4c (holonomic base): limit the strafe power increment to the frame's rampPow (and the impact recovery
+ * limit) and cap the strafe as the sides are capped; the drivetrain scales the mixed wheels down together.
+ * @param frame
+ * control frame of the current cycle
+ *
+ * @param prevFrame
+ * control frame of the previous cycle (strafe power that was last written)
+ */
+HOT_PATH void rampBaseStrafe(BaseControlFrame &frame, const BaseControlFrame &prevFrame){
+  double ramp = frame.rampLimit > 0? fmin(frame.rampPow, frame.rampLimit) : frame.rampPow;
+  frame.powerS = prevFrame.powerS + abscap(frame.targetPowerS - prevFrame.powerS, ramp*BASE_RAMP_SHARE);
+  frame.powerS = abscap(frame.powerS, frame.powerCap);
+  frame.targetVelS = abscap(frame.targetVelS, frame.powerCap/127*BASE_MOTOR_RPM);
+}
+/**
+ * One adaptation step of the power increment of a side (additive increase, multiplicative decrease).
+ * A slipping side has passed the traction limit: the increment backs off. A side held back by the
+ * increment that grips and accelerates in the direction of the step can take more: it grows.
+ * @param ramp
+ * increment of the previous cycle
+ *
+ * @param slip
+ * filtered slip of the side (in/s)
+ *
+ * @param acc
+ * measured ground acceleration of the side (in/s^2)
+ *
+ * @param step
+ * requested power change of the side (target power minus the last written power)
+ *
+ * @return
+ * increment of this cycle (TRACTION_RAMP_MIN to TRACTION_RAMP_MAX)
+ */
+double tractionRamp(double ramp, double slip, double acc, double step){
+  if(slip > TRACTION_SLIP_LIMIT) ramp *= TRACTION_RAMP_BACKOFF;
+  else if(fabs(step) > ramp && acc*step > 0) ramp += TRACTION_RAMP_GROW;
+  return fmin(fmax(ramp, TRACTION_RAMP_MIN), TRACTION_RAMP_MAX);
+}
+/**
+ * Stage 4a: estimate the traction of each side and adapt its power increment (BASE_TRACTION_CONTROL).
+ * The tracking wheels are unpowered, so they give the ground speed of a side; the motor encoders give
+ * its wheel speed, and the difference is slip (as in the odometry cross-check). Only the sensor
+ * snapshots of the two frames are used, so a flight record replays the same increments.
+ * @param frame
+ * control frame of the current cycle
+ *
+ * @param prevFrame
+ * control frame of the previous cycle (its traction state)
+ */
+HOT_PATH void adaptBaseRamp(BaseControlFrame &frame, const BaseControlFrame &prevFrame){
+  frame.rampL = BASE_TRACTION_CONTROL && prevFrame.rampL > 0? prevFrame.rampL : frame.rampPow;
+  frame.rampR = BASE_TRACTION_CONTROL && prevFrame.rampR > 0? prevFrame.rampR : frame.rampPow;
+  frame.groundVelL = prevFrame.groundVelL;
+  frame.groundVelR = prevFrame.groundVelR;
+  frame.slipL = prevFrame.slipL;
+  frame.slipR = prevFrame.slipR;
+#if BASE_TRACTION_CONTROL
+  /** no previous snapshot (first cycle after a handover) or no new one */
+  if(prevFrame.sensors.timestamp == 0 || frame.sensors.timestamp <= prevFrame.sensors.timestamp) return;
+  double dt = (frame.sensors.timestamp - prevFrame.sensors.timestamp)*1e-6;
+  /** ground travel of each side, at the width of the base wheels */
+  double changeL = (frame.sensors.encdL - prevFrame.sensors.encdL)*inPerDeg;
+  double changeR = (frame.sensors.encdR - prevFrame.sensors.encdR)*inPerDeg;
+  double forward = (changeL + changeR)/2;
+  double turn = (changeL - changeR)/baseWidth*motorBaseWidth/2;
+  frame.groundVelL = (forward + turn)/dt;
+  frame.groundVelR = (forward - turn)/dt;
+  double wheelVelL = (frame.sensors.motorL - prevFrame.sensors.motorL)*inPerMotorDeg/dt;
+  double wheelVelR = (frame.sensors.motorR - prevFrame.sensors.motorR)*inPerMotorDeg/dt;
+  frame.slipL += (fabs(wheelVelL - frame.groundVelL) - frame.slipL)*TRACTION_SLIP_FILTER;
+  frame.slipR += (fabs(wheelVelR - frame.groundVelR) - frame.slipR)*TRACTION_SLIP_FILTER;
+  double accL = (frame.groundVelL - prevFrame.groundVelL)/dt;
+  double accR = (frame.groundVelR - prevFrame.groundVelR)/dt;
+  frame.rampL = tractionRamp(frame.rampL, frame.slipL, accL, frame.targetPowerL - prevFrame.powerL);
+  frame.rampR = tractionRamp(frame.rampR, frame.slipR, accR, frame.targetPowerR - prevFrame.powerR);
+#endif
+}
+/**
+ * Stage 4: limit power increments to below the side's increment (the frame's rampPow, or the traction-limited
+ * increment of adaptBaseRamp) and cap the powers.
+ * Velocity commands are already limited by the profile, so they are only capped
+ * (a power cap of MAX_POW corresponds to MAX_POW/127 of BASE_MOTOR_RPM).
+ * @param frame
+ * control frame of the current cycle
+ *
+ * @param prevFrame
+ * control frame of the previous cycle (powers that were last written)
+ */
+HOT_PATH void rampBasePower(BaseControlFrame &frame, const BaseControlFrame &prevFrame){
+  adaptBaseRamp(frame, prevFrame);
+  /** recovering from an impact: the increments stay within its limit (the traction state carries on) */
+  double rampL = frame.rampLimit > 0? fmin(frame.rampL, frame.rampLimit) : frame.rampL;
+  double rampR = frame.rampLimit > 0? fmin(frame.rampR, frame.rampLimit) : frame.rampR;
+  frame.powerL = prevFrame.powerL + abscap(frame.targetPowerL - prevFrame.powerL, rampL*BASE_RAMP_SHARE);
+  frame.powerR = prevFrame.powerR + abscap(frame.targetPowerR - prevFrame.powerR, rampR*BASE_RAMP_SHARE);
+  /** handle custom speed caps */
+  frame.powerL = abscap(frame.powerL, frame.powerCap);
+  frame.powerR = abscap(frame.powerR, frame.powerCap);
+  double velCap = frame.powerCap/127*BASE_MOTOR_RPM;
+  frame.targetVelL = abscap(frame.targetVelL, velCap);
+  frame.targetVelR = abscap(frame.targetVelR, velCap);
+}
+/**
+ * Stage 3 in Q16.16 fixed point (BASE_FIXED_POINT 1), refer to computeBasePD.
+ * The errors, setpoints and gains are converted once; the PD and feedforward sums are integer.
+ * @param frame
+ * control frame of the current cycle
+ *
+ * @param prevFrame
+ * control frame of the previous cycle (for the D loop)
+ */
+HOT_PATH void computeBasePDFixed(BaseControlFrame &frame, const BaseControlFrame &prevFrame){
+  fixed_t ksL = toFixed(frame.ffL.ks), kvL = toFixed(frame.ffL.kv), kaL = toFixed(frame.ffL.ka);
+  fixed_t ksR = toFixed(frame.ffR.ks), kvR = toFixed(frame.ffR.kv), kaR = toFixed(frame.ffR.ka);
+  fixed_t correctionL = 0, correctionR = 0;
+  estimateMotorVelocity(frame, prevFrame);
+  if(frame.trackPosition){
+    frame.errorEncdL = frame.setpointEncdL - frame.encdL;
+    frame.errorEncdR = frame.setpointEncdR - frame.encdR;
+    double sideErrorL = frame.errorEncdL, sideErrorR = frame.errorEncdR, deltaL, deltaR;
+    errorChange(frame, prevFrame, deltaL, deltaR);
+    holdBaseHeading(frame, prevFrame, sideErrorL, sideErrorR, deltaL, deltaR);
+    fixed_t errorL = toFixed(sideErrorL), errorR = toFixed(sideErrorR);
+    fixed_t fixedKP = toFixed(frame.kp), fixedKD = toFixed(frame.kd);
+    correctionL = fixedMul(fixedKP, errorL) + fixedMul(fixedKD, toFixed(deltaL));
+    correctionR = fixedMul(fixedKP, errorR) + fixedMul(fixedKD, toFixed(deltaR));
+  }
+  correctionL += toFixed(frame.learnedL);
+  correctionR += toFixed(frame.learnedR);
+  fixed_t velL = toFixed(frame.setpointVelL), velR = toFixed(frame.setpointVelR);
+  fixed_t feedforwardL = (velL > 0? ksL : velL < 0? -ksL : 0) + fixedMul(kvL, velL) + fixedMul(kaL, toFixed(frame.setpointAccL));
+  fixed_t feedforwardR = (velR > 0? ksR : velR < 0? -ksR : 0) + fixedMul(kvR, velR) + fixedMul(kaR, toFixed(frame.setpointAccR));
+  frame.targetPowerL = fromFixed(feedforwardL + correctionL);
+  frame.targetPowerR = fromFixed(feedforwardR + correctionR);
+  frame.velCmdL = frame.setpointVelL + fromFixed(correctionL)/frame.ffL.kv;
+  frame.velCmdR = frame.setpointVelR + fromFixed(correctionR)/frame.ffR.kv;
+  frame.targetVelL = frame.velCmdL/inPerDeg/6;
+  frame.targetVelR = frame.velCmdR/inPerDeg/6;
+  holdBasePivot(frame);
+}
+/**
+ * Stage 4 in Q16.16 fixed point (BASE_FIXED_POINT 1), refer to rampBasePower.
+ * @param frame
+ * control frame of the current cycle
+ *
+ * @param prevFrame
+ * control frame of the previous cycle (powers that were last written)
+ */
+HOT_PATH void rampBasePowerFixed(BaseControlFrame &frame, const BaseControlFrame &prevFrame){
+  /** the traction estimate runs once per cycle, in double */
+  adaptBaseRamp(frame, prevFrame);
+  double rampL = frame.rampLimit > 0? fmin(frame.rampL, frame.rampLimit) : frame.rampL;
+  double rampR = frame.rampLimit > 0? fmin(frame.rampR, frame.rampLimit) : frame.rampR;
+  fixed_t prevL = toFixed(prevFrame.powerL), prevR = toFixed(prevFrame.powerR);
+  fixed_t powerL = prevL + fixedCap(toFixed(frame.targetPowerL) - prevL, toFixed(rampL*BASE_RAMP_SHARE));
+  fixed_t powerR = prevR + fixedCap(toFixed(frame.targetPowerR) - prevR, toFixed(rampR*BASE_RAMP_SHARE));
+  fixed_t fixedCapPow = toFixed(frame.powerCap);
+  frame.powerL = fromFixed(fixedCap(powerL, fixedCapPow));
+  frame.powerR = fromFixed(fixedCap(powerR, fixedCapPow));
+  double velCap = frame.powerCap/127*BASE_MOTOR_RPM;
+  frame.targetVelL = abscap(frame.targetVelL, velCap);
+  frame.targetVelR = abscap(frame.targetVelR, velCap);
+}
+/**
+ * Synthetic control frame for benchmarkBasePD that sweeps errors, velocities and
+ * accelerations across their usual ranges.
+ * @param i
+ * cycle number
+ *
+ * @return
+ * control frame after the profile stage
+ */
+BaseControlFrame benchmarkFrame(int i){
+  BaseControlFrame frame = {};
+  frame.trackPosition = true;
+  frame.kp = DEFAULT_KP;
+  frame.kd = DEFAULT_KD;
+  frame.ffL = frame.ffR = {PROFILE_KS, PROFILE_KV, PROFILE_KA};
+  frame.powerCap = MAX_POW;
+  frame.rampPow = RAMPING_POW;
+  frame.setpointEncdL = 200*sin(i*0.01);
+  frame.setpointEncdR = 200*cos(i*0.013);
+  frame.encdL = frame.setpointEncdL - 20*sin(i*0.07);
+  frame.encdR = frame.setpointEncdR - 20*cos(i*0.05);
+  frame.setpointVelL = 30*sin(i*0.003);
+  frame.setpointVelR = 30*cos(i*0.004);
+  frame.setpointAccL = 60*cos(i*0.003);
+  frame.setpointAccR = -60*sin(i*0.004);
+  return frame;
+}
+/**
+ * Accuracy of the fixed-point PD + ramp + cap stages against the double ones, run side by side on the
+ * synthetic frames of benchmarkBasePD.
+ * @param cycles
+ * number of control cycles compared
+ *
+ * @param rms
+ * set to the root mean square difference between their powers
+ *
+ * @return
+ * the largest difference between their powers
+ */
+double compareBasePDFixed(int cycles, double &rms){
+  BaseControlFrame prevDouble = {}, prevFixed = {};
+  double maxDiff = 0, sumSquares = 0;
+  for(int i = 0; i < cycles; i++){
+    BaseControlFrame doubleFrame = benchmarkFrame(i*37), fixedFrame = doubleFrame;
+    computeBasePD(doubleFrame, prevDouble);
+    rampBasePower(doubleFrame, prevDouble);
+    computeBasePDFixed(fixedFrame, prevFixed);
+    rampBasePowerFixed(fixedFrame, prevFixed);
+    double diffL = fabs(doubleFrame.powerL - fixedFrame.powerL), diffR = fabs(doubleFrame.powerR - fixedFrame.powerR);
+    maxDiff = fmax(maxDiff, fmax(diffL, diffR));
+    sumSquares += diffL*diffL + diffR*diffR;
+    prevDouble = doubleFrame;
+    prevFixed = fixedFrame;
+  }
+  rms = cycles > 0? sqrt(sumSquares/(2*cycles)) : 0;
+  return maxDiff;
+}
+/**
+ * Time the double and the fixed-point PD + ramp + cap stages on the same synthetic frames
+ * and print the average cost per cycle and the largest difference between their powers.
+ * The frames are built in advance so that only the stages are timed.
+ * Runs on the calling task; call it at initialization (DEBUG_MODE 5), not during a match.
+ * @param iterations
+ * number of control cycles to time per path
+ */
+void benchmarkBasePD(int iterations){
+  const int BENCHMARK_FRAMES = 64;
+  BaseControlFrame frames[BENCHMARK_FRAMES];
+  for(int i = 0; i < BENCHMARK_FRAMES; i++) frames[i] = benchmarkFrame(i*37);
+  /** double path */
+  BaseControlFrame prevFrame = {};
+  uint64_t start = micros();
+  for(int i = 0; i < iterations; i++){
+    BaseControlFrame frame = frames[i%BENCHMARK_FRAMES];
+    computeBasePD(frame, prevFrame);
+    rampBasePower(frame, prevFrame);
+    prevFrame = frame;
+  }
+  uint64_t doubleTime = micros() - start;
+  /** fixed-point path */
+  prevFrame = {};
+  start = micros();
+  for(int i = 0; i < iterations; i++){
+    BaseControlFrame frame = frames[i%BENCHMARK_FRAMES];
+    computeBasePDFixed(frame, prevFrame);
+    rampBasePowerFixed(frame, prevFrame);
+    prevFrame = frame;
+  }
+  uint64_t fixedTime = micros() - start;
+  double rms, maxDiff = compareBasePDFixed(iterations, rms);
+  printf("PD benchmark (%d cycles): double %.1f ns/cycle, fixed %.1f ns/cycle, max power difference %f\n",
+    iterations, doubleTime*1000.0/iterations, fixedTime*1000.0/iterations, maxDiff);
+}
+/**
+ * @param frame
+ * control frame of the current cycle
+ *
+ * @return
+ * whether the current movement is finished: its setpoints (and strafe setpoint) at the targets, no pursuit path
+ * or RAMSETE trajectory left
+ */
+HOT_PATH bool isBaseMotionFinished(const BaseControlFrame &frame){
+  return !pursuitMode && !poseMoveMode && !(ramseteMode && baseTrajectory != NULL) && fabs(targetEncdL - frame.setpointEncdL) <= 1e-3
+    && fabs(targetEncdR - frame.setpointEncdR) <= 1e-3 && (!strafeActive || fabs(targetS - frame.setpointS) <= 1e-3);
+}
+/**
+ * Stage 4b: end of the movement. The base coasts (BASE_MOVE_BRAKE_MODE) while the profile runs and holds
+ * (BASE_SETTLE_BRAKE_MODE) once it has finished, so the zero power of waitBase does not let it roll on.
+ * With BASE_ACTIVE_BRAKE, a side still moving in the direction of the movement when the profile finishes
+ * gets reverse power in proportion to its velocity, until it has slowed below BASE_BRAKE_MIN_VEL
+ * (at most BASE_BRAKE_TIME): the lag of the base behind the profile otherwise carries it past the target.
+ * Left alone while the base is paused (the pausing function owns the motors).
+ * @param frame
+ * control frame of the current cycle
+ */
+HOT_PATH void brakeBase(BaseControlFrame &frame){
+  if(basePaused){
+    baseBrakeModeL = baseBrakeModeR = -1;
+    return;
+  }
+  bool finished = isBaseMotionFinished(frame);
+  double velL = frame.motorVelL*inPerDeg, velR = frame.motorVelR*inPerDeg;
+  if(finished && !motionFinished){
+    finishedAt = frame.readTime;
+    finishVel = fmax(fabs(velL), fabs(velR));
+    brakeTime = 0;
+    brakeSides = 0;
+    if(BASE_ACTIVE_BRAKE && frame.output != BASE_OUTPUT_VELOCITY){
+      if(velL*(targetEncdL - profileStartL) > 0 && fabs(velL) > BASE_BRAKE_MIN_VEL) brakeSides |= 1;
+      if(velR*(targetEncdR - profileStartR) > 0 && fabs(velR) > BASE_BRAKE_MIN_VEL) brakeSides |= 2;
+    }
+  }
+  motionFinished = finished;
+  if(!finished) brakeSides = 0;
+  if(brakeSides != 0){
+    brakeTime = (frame.readTime - finishedAt)/1000;
+    if(brakeTime >= BASE_BRAKE_TIME) brakeSides = 0;
+    if((brakeSides & 1) && fabs(velL) < BASE_BRAKE_MIN_VEL) brakeSides &= ~1;
+    if((brakeSides & 2) && fabs(velR) < BASE_BRAKE_MIN_VEL) brakeSides &= ~2;
+    if(brakeSides & 1) frame.powerL = -abscap(BASE_BRAKE_GAIN*velL, BASE_BRAKE_MAX_POW);
+    if(brakeSides & 2) frame.powerR = -abscap(BASE_BRAKE_GAIN*velR, BASE_BRAKE_MAX_POW);
+  }
+  int mode = finished? BASE_SETTLE_BRAKE_MODE : BASE_MOVE_BRAKE_MODE;
+  /** the pivot of a swing turn holds throughout */
+  int modeL = pivotSide == BASE_SIDE_LEFT? pros::E_MOTOR_BRAKE_HOLD : mode;
+  int modeR = pivotSide == BASE_SIDE_RIGHT? pros::E_MOTOR_BRAKE_HOLD : mode;
+  if(modeL != baseBrakeModeL || modeR != baseBrakeModeR){
+    drivetrain.setBrakeMode((pros::motor_brake_mode_e_t)modeL, (pros::motor_brake_mode_e_t)modeR);
+    baseBrakeModeL = modeL;
+    baseBrakeModeR = modeR;
+  }
+}
+/**
+ * Stage 5: write the powers (or velocities) to the motors (unless the base is paused), with the strafe of a holonomic base.
+ * @param frame
+ * control frame of the current cycle
+ */
+HOT_PATH void writeBaseMotors(BaseControlFrame &frame){
+  if(!basePaused){
+    switch(frame.output){
+      case BASE_OUTPUT_POWER:
+        drivetrain.setPower(frame.powerL, frame.powerR, frame.powerS);
+        break;
+      case BASE_OUTPUT_VOLTAGE:
+        /** 127 power is 12000 mV */
+        drivetrain.setVoltage(frame.powerL*12000/127, frame.powerR*12000/127, frame.powerS*12000/127);
+        break;
+      case BASE_OUTPUT_VELOCITY:
+        drivetrain.setVelocity(frame.targetVelL, frame.targetVelR, frame.targetVelS);
+        break;
+    }
+  }
+  frame.writeTime = micros();
+}
+/**
+ * Stage 6: detect when the current movement has settled and wake the task waiting on it.
+ * The movement has to be finished (the setpoints at the targets, no pursuit path or RAMSETE trajectory left)
+ * before the settle detector runs on the distance of the sides from their targets.
+ * @param frame
+ * control frame of the current cycle
+ */
+HOT_PATH void updateBaseSettle(const BaseControlFrame &frame){
+  /** the targets are those of the last applied command */
+  uint32_t id = appliedMotionId;
+  if(id != lastMotionId){
+    lastMotionId = id;
+    baseSettle.setRule(baseSettleRule.read());
+  }
+  if(settledMotionId.load() == id) return;
+  if(!isBaseMotionFinished(frame)){
+    baseSettle.reset();
+    return;
+  }
+  /** holding the bearing, the sides settle on the distance and the heading (refer to holdBaseHeading) */
+  double errorL = targetEncdL - frame.encdL, errorR = targetEncdR - frame.encdR, deltaL = 0, deltaR = 0;
+  holdBaseHeading(frame, frame, errorL, errorR, deltaL, deltaR);
+  double error = fmax(fabs(errorL), fabs(errorR))*inPerDeg;
+  if(strafeActive) error = fmax(error, fabs(targetS - frame.lateralS));
+  /** a turn closed on the heading only settles at its goal bearing (refer to BASE_TURN_TOLERANCE) */
+  if(frame.holdHeading && headingTurn && fabs(frame.headingError) > BASE_TURN_TOLERANCE*toRad){
+    baseSettle.reset();
+    return;
+  }
+  if(!baseSettle.isSettled(error, frame.readTime)) return;
+  settledMotionId = id;
+  TracePoint<TRACE_CONTROL>::record(TELEMETRY_STOP, (frame.readTime - finishedAt)/1000.0, finishVel, brakeTime);
+  pros::task_t waiter = baseWaiter.exchange(NULL);
+  if(waiter != NULL) pros::c::task_notify(waiter);
+}
+/**
+ * Stage 7: state the demand of the base to the current budget (refer to currentBudget.hpp): its peak while
+ * the profile speeds either side up faster than BUDGET_LAUNCH_ACC, running while it moves, idle once settled.
+ * @param frame
+ * control frame of the current cycle
+ */
+HOT_PATH void updateBaseCurrentDemand(const BaseControlFrame &frame){
+  bool launchL = frame.setpointAccL*frame.setpointVelL >= 0 && fabs(frame.setpointAccL) > BUDGET_LAUNCH_ACC;
+  bool launchR = frame.setpointAccR*frame.setpointVelR >= 0 && fabs(frame.setpointAccR) > BUDGET_LAUNCH_ACC;
+  if(launchL || launchR) setCurrentDemand(BUDGET_BASE, CURRENT_PEAK);
+  else setCurrentDemand(BUDGET_BASE, isBaseSettled()? CURRENT_IDLE : CURRENT_RUNNING);
+}
+/**
+ * Control the base with one fixed-rate pipeline:
+ * read sensors -> profile (-> pose correction, heading) -> PD (-> strafe) -> ramp/cap -> brake -> write motors -> settle detection -> current demand,
+ * then start the next queued motion once the current one has settled (refer to motionQueue.cpp).
+ * All stages of one cycle run back to back on the same sensor snapshot,
+ * so a power command is never older than the cycle that produced it.
+ * The cycle is triggered by the odometry tick, once every BASE_CONTROL_DT.
+ * The task runs in autonomous and driver control; in BASE_MODE_DRIVER a cycle only reads the sensors and
+ * records them, as the driver pipeline writes the motors (refer to switchBaseMode).
+ * With BASE_CASCADE the cycle is triggered every BASE_INNER_DT instead: every cycle runs
+ * read sensors -> wheel velocity loop -> ramp/cap -> write motors, and the position loop stages run
+ * before the velocity loop once every BASE_CONTROL_DT (the cycles in between carry their outputs).
+ */
 void baseControl(void * ignore){
-  /** previous error in encoder values for D loop */
-  double prevErrorEncdL = 0, prevErrorEncdR = 0;
-  while(competition::is_autonomous()){
-    /** error from current encoder values to target encoder values */
-    double errorEncdL = targetEncdL - BL.get_position();
-    double errorEncdR = targetEncdR - BR.get_position();
-    /** PD loop */
-    double deltaErrorEncdL = errorEncdL - prevErrorEncdL;
-    double deltaErrorEncdR = errorEncdR - prevErrorEncdR;
-
-    prevErrorEncdL = errorEncdL;
-    prevErrorEncdR = errorEncdR;
-
-    targetPowerL = kP*errorEncdL+kD*deltaErrorEncdL;
-    targetPowerR = kP*errorEncdR+kD*deltaErrorEncdR;
-    /** print to assist debugging */
-		if(DEBUG_MODE == 2) printf("Error: %f %f\n",errorEncdL,errorEncdR);
-    /** refresh rate of Task */
-		Task::delay(20);
-  }
-}
-/** Control and set the motor powers by imposing limits and maximum ramping. */
-void baseMotorControl(void * ignore){
-  /** to-be-set values for left and right motors */
-  double powerL=0,powerR=0;
-  while(competition::is_autonomous()){
-    /** limit power increments to below RAMPING_POW */
-    double deltaPowerL = targetPowerL - powerL;
-    powerL += abscap(deltaPowerL, RAMPING_POW);
-    double deltaPowerR = targetPowerR - powerR;
-    powerR += abscap(deltaPowerR, RAMPING_POW);
-    /** handle custom speed caps */
-		if(basePowCapped){
-      powerL = abscap(powerL, absPowerCap);
-      powerR = abscap(powerR, absPowerCap);
-		}
-		else{
-			powerL = abscap(powerL, MAX_POW);
-      powerR = abscap(powerR, MAX_POW);
-		}
-    /** if baseMotorControl is not paused */
-		if(!basePaused){
-			FL.move(powerL);
-			BL.move(powerL);
-			FR.move(powerR);
-			BR.move(powerR);
-		}
-    /** print to assist debugging */
-		if(DEBUG_MODE == 3) printf("%4.0f \t %4.0f\n",powerL,powerR);
-    /** refresh rate of Task */
-    Task::delay(20);
+  /** loop period, and cycles of it per position loop cycle */
+  const uint32_t period = BASE_CASCADE? BASE_INNER_DT : BASE_CONTROL_DT;
+  const uint32_t outerDivider = BASE_CONTROL_DT/period;
+  /** previous frame for the D loop and the ramping */
+  BaseControlFrame prevFrame = {};
+  uint32_t cycle = 0;
+  baseControlTask = pros::c::task_get_current();
+  subscribeOdometry(pros::c::task_get_current(), period/ODOM_DT);
+  startTaskTiming(TIMING_CONTROL, period, true);
+  while(true){
+    if(!isTaskActive(ROBOT_CONTROL)){
+      /** the robot is disabled: stop the base, then park until the next enabled phase */
+      unsubscribeOdometry(pros::c::task_get_current());
+      drivetrain.stop();
+      setCurrentDemand(BUDGET_BASE, CURRENT_RUNNING);
+      baseBrakeModeL = baseBrakeModeR = -1;
+      waitTaskActive(ROBOT_CONTROL);
+      /** a failsafe while parked is not for the next movement */
+      handledFailsafes = getBaseFailsafeCount();
+      prevFrame = {};
+      cycle = 0;
+      subscribeOdometry(pros::c::task_get_current(), period/ODOM_DT);
+      startTaskTiming(TIMING_CONTROL, period, true);
+    }
+    /**
+     * wait for a fresh pose; the timeout keeps the base controlled
+     * (at about the usual rate) even if the odometry task is not running
+     */
+    waitOdometry(period + ODOM_DT);
+    beginTaskIteration(TIMING_CONTROL);
+    markBoot(BOOT_MARK_CONTROL);
+    bool outer = cycle++ % outerDivider == 0;
+    /** an inner cycle starts from the outputs of the last position loop cycle */
+    BaseControlFrame frame = {};
+    if(!outer) frame = prevFrame;
+    frame.outer = outer;
+    if(outer) applyBaseCommands();
+    readBaseSensors(frame);
+    failsafeBase(frame);
+    if(switchBaseMode(frame) == BASE_MODE_DRIVER){
+      recordDriverFrame(frame);
+      prevFrame = frame;
+      endTaskIteration(TIMING_CONTROL);
+      continue;
+    }
+    if(outer){
+      sampleBaseProfile(frame);
+      correctBasePose(frame);
+      measureBaseHeading(frame);
+      detectBaseImpact(frame);
+      scheduleLqrGains(frame);
+      publishBaseTargets();
+#if BASE_FIXED_POINT
+      computeBasePDFixed(frame, prevFrame);
+#else
+      computeBasePD(frame, prevFrame);
+#endif
+      if(HOLONOMIC_BASE) computeBaseStrafe(frame, prevFrame);
+      recordBaseLearning(frame);
+    }
+    if(BASE_CASCADE) computeBaseVelocity(frame, prevFrame);
+#if BASE_FIXED_POINT
+    rampBasePowerFixed(frame, prevFrame);
+#else
+    rampBasePower(frame, prevFrame);
+#endif
+    if(HOLONOMIC_BASE) rampBaseStrafe(frame, prevFrame);
+    brakeBase(frame);
+    writeBaseMotors(frame);
+    if(outer){
+      updateBaseSettle(frame);
+      updateMotionQueue(frame);
+      updateBaseCurrentDemand(frame);
+    }
+    baseControlLatency = frame.writeTime - frame.readTime;
+    recordFlight(RECORDER_AUTON, frame);
+    prevFrame = frame;
+    /** record to assist debugging (printed by the telemetry drain task) */
+    if(outer){
+      trackingErrorLock.write({frame.errorEncdL, frame.errorEncdR});
+      TracePoint<TRACE_CONTROL>::record(TELEMETRY_ERROR, frame.errorEncdL, frame.errorEncdR);
+      TracePoint<TRACE_POWER>::record(TELEMETRY_POWER, frame.powerL, frame.powerR);
+    }
+    endTaskIteration(TIMING_CONTROL);
   }
 }
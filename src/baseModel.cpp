@@ -0,0 +1,75 @@
+/**
+ * Base model functions:
+ * - Runtime feedforward of the sides and track widths
+ * - Saving & loading of the model on the microSD card
+ */
+#include "main.h"
+/** the model (refer to BaseModel); the defaults are the configured constants */
+BaseModel baseModel = {{PROFILE_KS, PROFILE_KV, PROFILE_KA}, {PROFILE_KS, PROFILE_KV, PROFILE_KA}, motorBaseWidth, baseWidth};
+/**
+ * Replace the model (e.g. after characterizing the base).
+ * Call when no movement is being started: the control task copies the feedforward into every frame.
+ * @param model
+ * the new model (a side with kv <= 0 is not accepted)
+ */
+void setBaseModel(const BaseModel &model){
+  if(model.left.kv <= 0 || model.right.kv <= 0) return;
+  baseModel = model;
+}
+/**
+ * @return
+ * the current model
+ */
+BaseModel getBaseModel(){
+  return baseModel;
+}
+/**
+ * Load the model from the microSD card (BASE_MODEL_FILE_PATH).
+ * The model is only replaced if every line is read.
+ * @return
+ * false if there is no card, no file, or the file is incomplete
+ */
+bool loadBaseModel(){
+  if(!usd::is_installed()) return false;
+  ConfigFile file;
+  if(!file.open(BASE_MODEL_FILE_PATH)) return false;
+  BaseModel model;
+  /** lines: left & right (ks, kv, ka), width (motorWidth, trackingWidth); bit i: line i was read */
+  int read = 0;
+  ConfigEntry entry;
+  while(file.next(entry)){
+    double numbers[3];
+    if(entry.key == "left" && entry.getNumbers(numbers, 3)){
+      model.left = {numbers[0], numbers[1], numbers[2]};
+      read |= 1;
+    }
+    else if(entry.key == "right" && entry.getNumbers(numbers, 3)){
+      model.right = {numbers[0], numbers[1], numbers[2]};
+      read |= 2;
+    }
+    else if(entry.key == "width" && entry.getNumbers(numbers, 2)){
+      model.motorWidth = numbers[0];
+      model.trackingWidth = numbers[1];
+      read |= 4;
+    }
+    else return false;
+  }
+  if(file.failed() || read != 7 || model.left.kv <= 0 || model.right.kv <= 0) return false;
+  setBaseModel(model);
+  return true;
+}
+/**
+ * Save the model to the microSD card (BASE_MODEL_FILE_PATH), e.g. after characterizing the base.
+ * @return
+ * false if there is no card or the file cannot be written
+ */
+bool saveBaseModel(){
+  if(!usd::is_installed()) return false;
+  FILE *file = fopen(BASE_MODEL_FILE_PATH, "w");
+  if(file == NULL) return false;
+  fprintf(file, "left %g %g %g\n", baseModel.left.ks, baseModel.left.kv, baseModel.left.ka);
+  fprintf(file, "right %g %g %g\n", baseModel.right.ks, baseModel.right.kv, baseModel.right.ka);
+  fprintf(file, "width %g %g\n", baseModel.motorWidth, baseModel.trackingWidth);
+  fclose(file);
+  return true;
+}
@@ -1,73 +1,918 @@
 /**
  * Odometry functions and task that constantly updates the robot's position
- * - Retrieve & package encoder values function
+ * - Sensor frame reading & retrieval
+ * - Pose snapshot publishing & retrieval
+ * - Odometry step (integration of a sensor frame, or a step of the pose estimator)
+ * - Cross-check of the tracking wheels against the motor encoders
+ * - Pose corrections and landmark observations
+ * - Wall ranging with the ultrasonic sensor
+ * - Tracking wheel geometry (calibrated, saved & loaded on the microSD card)
  * - Odometry task
  */
 #include "main.h"
+/** trigonometry of the odometry tick (refer to ODOM_FAST_TRIG) */
+#if ODOM_FAST_TRIG
+#define odomSin fastSin
+#define odomCos fastCos
+#else
+#define odomSin sin
+#define odomCos cos
+#endif
 /** to test odometry in opcontrol() when not in competition */
 #define COMPETITION_MODE false
-/** declare encoders */
-ADIEncoder encoderL(encdL_port, encdL_port + 1);
-ADIEncoder encoderR(encdR_port, encdR_port + 1);
-/** encdL, encdR = value of respective encoders */
-double encdL = 0, encdR = 0;
-/** position: object of class Coordinates - position of the robot */
-Coordinates position(0, 0, 0);
+/** the encoders, the IMU and the ultrasonic sensor are in the device registry (refer to devices.hpp) */
+#if ODOM_USE_ULTRASONIC
+/** median of the ultrasonic's differences to the expected ranges (odometry task only) */
+Median<ULTRASONIC_SAMPLES> rangeFilter = {};
+int rangeSamples = 0;
+FieldWall rangeWall = WALL_TOP;
+#endif
+/** encdL, encdR, encdS = value of respective encoders (inches) */
+double encdL = 0, encdR = 0, encdS = 0;
+/** sensor frame of the latest tick, shared with other tasks */
+SeqLock<SensorFrame> sensorLock;
+/** position: pose of the robot (owned by the odometry task) */
+Pose<double> position = {0, 0, 0};
+/** snapshot of position shared with other tasks */
+SeqLock<PoseSnapshot> poseLock;
+/** pose requested by setCoords, applied by the odometry task at its next tick, and the coordinates whose uncertainty it keeps */
+SeqLock<PoseSnapshot> resetLock;
+std::atomic<uint8_t> resetKeep(0);
+std::atomic<bool> resetPending(false);
+/** uncertainty of the latest pose (refer to getPoseUncertainty) */
+SeqLock<PoseUncertainty> uncertaintyLock;
+/** correction requested by correctPose (offsets in the pose fields), and the number applied so far */
+SeqLock<PoseSnapshot> correctionLock;
+std::atomic<bool> correctionPending(false);
+std::atomic<uint32_t> poseCorrections(0);
+/** landmark observations from the vision service waiting for the odometry task (refer to observeLandmark) */
+Mailbox<LandmarkObservation, ODOM_LANDMARK_QUEUE> landmarkQueue;
+/** result of the latest cross-check (refer to ODOM_MOTOR_CHECK) */
+SeqLock<OdometryHealth> healthLock;
+/** tracking wheel geometry (refer to OdometryGeometry), applied by the odometry at its next reset */
+SeqLock<OdometryGeometry> geometryLock(OdometryGeometry{inPerDeg, baseWidth});
+static_assert(ODOM_IDLE_DT % ODOM_DT == 0, "ODOM_IDLE_DT must be a multiple of ODOM_DT");
+static_assert(!ODOM_PHASE_LOCK || ODOM_DT % SENSOR_DEVICE_DT == 0, "a phase locked ODOM_DT must be a multiple of SENSOR_DEVICE_DT");
+/** the odometry task runs at ODOM_IDLE_DT, and waits for wakeOdometry between ticks (refer to ODOM_ADAPTIVE_RATE) */
+std::atomic<bool> odometryIdle(false);
+/** IMU calibrations started by recalibrateImu (the odometry aligns the IMU again after each) */
+std::atomic<uint32_t> imuResets(0);
 /**
- * Retrive encoder values.
- * @param processed
- * whether the returned values should be in inches (default) or encoder degrees
+ * Retrieve a consistent copy of the latest pose without blocking the odometry task.
+ * @return
+ * latest pose published by the odometry task
+ */
+PoseSnapshot getPose(){
+  return poseLock.read();
+}
+/**
+ * @return
+ * continuous bearing of the latest pose in radians (refer to PoseSnapshot)
+ */
+double getHeading(){
+  return poseLock.read().angle;
+}
+/**
+ * @return
+ * bearing of the latest pose in radians, within 0<=angle<twoPI
+ */
+double getWrappedHeading(){
+  return wrapRad(poseLock.read().angle);
+}
+/**
+ * Retrieve the number of poses published so far.
+ * @return
+ * pose version (changes whenever a new pose is published)
+ */
+uint32_t getPoseVersion(){
+  return poseLock.version();
+}
+/**
+ * Retrieve the uncertainty of the latest pose (refer to ODOM_UNCERTAIN_POSITION).
+ * @return
+ * standard deviations of the position and of the bearing, published with the pose (all 0 before the first tick)
+ */
+PoseUncertainty getPoseUncertainty(){
+  return uncertaintyLock.read();
+}
+/**
+ * Check whether the pose has drifted enough to be worth a relocalization (squaring to a wall, waiting for a landmark).
+ * @param position
+ * largest standard deviation of the position accepted (inches)
+ *
+ * @param angleDeg
+ * largest standard deviation of the bearing accepted (degrees)
+ *
+ * @return
+ * true if either is exceeded
+ */
+bool isPoseUncertain(double position, double angleDeg){
+  PoseUncertainty uncertainty = uncertaintyLock.read();
+  return uncertainty.position > position || uncertainty.angle*toDeg > angleDeg;
+}
+/**
+ * Retrieve the result of the latest cross-check of the tracking wheels.
+ * @return
+ * slip rates and failed tracking wheels (all 0 unless ODOM_MOTOR_CHECK)
+ */
+OdometryHealth getOdometryHealth(){
+  return healthLock.read();
+}
+/**
+ * @param source
+ * an odometry source
+ *
+ * @return
+ * its short name, for the displays
+ */
+const char *getOdometrySourceName(OdometrySource source){
+  switch(source){
+    case ODOM_SOURCE_MOTORS: return "motors";
+    case ODOM_SOURCE_MOTORS_IMU: return "motors+imu";
+    default: return "tracking";
+  }
+}
+/**
+ * Replace the tracking wheel geometry (e.g. after calibrating the odometry).
+ * The odometry applies it at its next reset (setCoords), so the pose never jumps.
+ * @param geometry
+ * the new geometry (not accepted unless both values are positive)
+ */
+void setOdometryGeometry(const OdometryGeometry &geometry){
+  if(geometry.inPerDeg <= 0 || geometry.baseWidth <= 0) return;
+  geometryLock.write(geometry);
+}
+/**
+ * @return
+ * the current tracking wheel geometry
+ */
+OdometryGeometry getOdometryGeometry(){
+  return geometryLock.read();
+}
+/**
+ * Load the geometry from the microSD card (ODOM_GEOMETRY_FILE_PATH).
+ * @return
+ * false if there is no card, no file, or the file is incomplete
+ */
+bool loadOdometryGeometry(){
+  if(!usd::is_installed()) return false;
+  ConfigFile file;
+  if(!file.open(ODOM_GEOMETRY_FILE_PATH)) return false;
+  /** both values must be in the file (0 is never valid) */
+  OdometryGeometry geometry = {0, 0};
+  ConfigEntry entry;
+  while(file.next(entry)){
+    double *value = entry.key == "inPerDeg"? &geometry.inPerDeg : entry.key == "baseWidth"? &geometry.baseWidth : NULL;
+    if(value == NULL || !entry.getNumbers(value, 1)) return false;
+  }
+  if(file.failed() || geometry.inPerDeg <= 0 || geometry.baseWidth <= 0) return false;
+  setOdometryGeometry(geometry);
+  return true;
+}
+/**
+ * Save the geometry to the microSD card (ODOM_GEOMETRY_FILE_PATH), e.g. after calibrating the odometry.
+ * @return
+ * false if there is no card or the file cannot be written
+ */
+bool saveOdometryGeometry(){
+  if(!usd::is_installed()) return false;
+  FILE *file = fopen(ODOM_GEOMETRY_FILE_PATH, "w");
+  if(file == NULL) return false;
+  OdometryGeometry geometry = geometryLock.read();
+  fprintf(file, "inPerDeg %.10g\nbaseWidth %.10g\n", geometry.inPerDeg, geometry.baseWidth);
+  fclose(file);
+  return true;
+}
+/**
+ * Request the odometry task to set the robot's position.
+ * The odometry task is the only writer of position, so the new values
+ * are applied at the start of its next tick.
+ * @param x
+ * to-be-set x-coordinate
+ *
+ * @param y
+ * to-be-set y-coordinate
+ *
+ * @param angleDeg
+ * to-be-set bearing in degrees
+ *
+ * @param keep
+ * ODOM_KEEP_X | ODOM_KEEP_Y | ODOM_KEEP_ANGLE: coordinates not measured by the reset, which keep their
+ * uncertainty (e.g. the coordinate along a squared wall); 0 for a pose known as a whole
+ */
+void setCoords(double x, double y, double angleDeg, uint8_t keep){
+  PoseSnapshot pose = {x, y, angleDeg*toRad, 0, 0, micros()};
+  resetLock.write(pose);
+  resetKeep.store(keep, std::memory_order_relaxed);
+  resetPending.store(true, std::memory_order_release);
+}
+/**
+ * Request the odometry task to correct the robot's position, at the start of its next tick.
+ * A pending correction that was not applied yet is replaced.
+ * @param dx, dy
+ * to-be-added offsets of the coordinates (inches)
+ *
+ * @param dAngle
+ * to-be-added offset of the bearing (radians)
+ *
+ * @param timestamp
+ * time of the pose the correction was computed from (micros); dropped if older than the last setCoords
+ */
+void correctPose(double dx, double dy, double dAngle, uint64_t timestamp){
+  PoseSnapshot correction = {dx, dy, dAngle, 0, 0, timestamp};
+  correctionLock.write(correction);
+  correctionPending.store(true, std::memory_order_release);
+}
+/**
+ * Queue a landmark seen by the vision sensor for the pose estimator (refer to ODOM_ESTIMATOR); the odometry
+ * task weighs it against the pose at its capture at the next tick. Only the vision service may call it.
+ * @param observation
+ * the landmark and its measured bearing and distance
+ *
+ * @return
+ * false if the queue is full (the observation is dropped)
+ */
+bool observeLandmark(const LandmarkObservation &observation){
+  return landmarkQueue.post(observation);
+}
+/**
+ * Retrieve the number of corrections applied so far (the flight recorder stores it with every record).
+ * @return
+ * number of corrections (correctPose, wall ranges and accepted landmark observations) applied to the pose
+ */
+uint32_t getPoseCorrections(){
+  return poseCorrections.load(std::memory_order_relaxed);
+}
+/**
+ * Add a correction to the pose being integrated.
+ * @param state
+ * odometry state; the pose is offset
+ *
+ * @param correction
+ * offsets of the coordinates and of the bearing (refer to correctPose)
+ */
+void applyPoseCorrection(OdometryState &state, const PoseSnapshot &correction){
+  state.x += correction.x;
+  state.y += correction.y;
+  /** the bearing follows the encoders from angleOffset; keep the IMU fusion on the corrected heading */
+  state.angleOffset += correction.angle;
+  state.angle += correction.angle;
+  state.prevAngle += correction.angle;
+  state.imuOffset += correction.angle;
+#if ODOM_ESTIMATOR
+  state.estimate.state(ESTIMATE_X, 0) += correction.x;
+  state.estimate.state(ESTIMATE_Y, 0) += correction.y;
+  state.estimate.state(ESTIMATE_ANGLE, 0) += correction.angle;
+#endif
+}
+#if ODOM_ESTIMATOR
+/**
+ * One step of the pose estimator on the tracking wheel changes of a sensor frame: the velocities of the
+ * tick update the estimate, the model predicts the pose, and a new IMU sample updates the bearing.
+ * @param state
+ * odometry state; the estimate, the pose and the velocities are updated
+ *
+ * @param frame
+ * sensor frame of the step
+ *
+ * @param forward
+ * travel of the tracking centre over the step (inches)
+ *
+ * @param deltaAngle
+ * change of the encoder bearing over the step (radians)
+ *
+ * @param lateral
+ * sideways movement to the right (inches; 0 without ODOM_THREE_WHEEL), added to the prediction
+ */
+HOT_PATH void stepEstimate(OdometryState &state, const SensorFrame &frame, double forward, double deltaAngle, double lateral){
+  PoseEstimate &estimate = state.estimate;
+  if(!estimate.initialized) resetEstimate(estimate, state.x, state.y, state.angle);
+  if(state.prevTimestamp != 0 && frame.timestamp > state.prevTimestamp){
+    double dt = (frame.timestamp - state.prevTimestamp)/1000000.0;
+    double prevAngle = estimate.state(ESTIMATE_ANGLE, 0);
+    updateVelocityEstimate(estimate, forward/dt, deltaAngle/dt);
+    predictEstimate(estimate, dt);
+    double meanAngle = (prevAngle + estimate.state(ESTIMATE_ANGLE, 0))/2;
+    estimate.state(ESTIMATE_X, 0) += lateral*odomCos(meanAngle);
+    estimate.state(ESTIMATE_Y, 0) -= lateral*odomSin(meanAngle);
+  }
+  /** the IMU bearing at every new IMU sample, on the offset taken at the first one */
+  if(frame.imuValid){
+    double imuAngle = frame.imuRotation*toRad;
+    if(!state.imuAligned){
+      state.imuOffset = estimate.state(ESTIMATE_ANGLE, 0) - imuAngle;
+      state.imuAligned = true;
+    }
+    else if(frame.imuRotation != state.prevImuRotation) updateHeadingEstimate(estimate, imuAngle + state.imuOffset);
+    state.prevImuRotation = frame.imuRotation;
+  }
+  state.x = estimate.state(ESTIMATE_X, 0);
+  state.y = estimate.state(ESTIMATE_Y, 0);
+  state.angle = estimate.state(ESTIMATE_ANGLE, 0);
+  state.linVel = estimate.state(ESTIMATE_VEL, 0);
+  state.angVel = estimate.state(ESTIMATE_ANG_VEL, 0);
+}
+/**
+ * Weigh the queued landmark observations into the estimate.
+ * @param state
+ * odometry state; the estimate is updated
+ *
+ * @param resetTime
+ * time of the last setCoords (older observations are dropped)
+ *
+ * @return
+ * true if an observation was accepted
+ */
+bool updateLandmarks(OdometryState &state, uint64_t resetTime){
+  bool accepted = false;
+  LandmarkObservation observation;
+  while(landmarkQueue.take(observation)){
+    PoseSnapshot pose;
+    if(observation.timestamp >= resetTime && getPoseAt(observation.timestamp, pose)){
+      accepted = updateLandmarkEstimate(state.estimate, pose.x, pose.y, pose.angle, observation.landmarkX,
+                                        observation.landmarkY, observation.bearing, observation.distance) || accepted;
+    }
+  }
+  return accepted;
+}
+#endif
+#if ODOM_USE_ULTRASONIC
+/**
+ * Range from the ultrasonic sensor to the field wall its beam hits.
+ * @param pose
+ * pose of the robot
+ *
+ * @param wall
+ * set to the wall hit
+ *
+ * @param incidence
+ * set to the angle between the beam and the wall's normal (radians)
+ *
+ * @return
+ * the range in inches
+ */
+double expectedWallRange(const PoseSnapshot &pose, FieldWall &wall, double &incidence){
+  double s = sin(pose.angle), c = cos(pose.angle);
+  /** the sensor and its beam, in inches from the field's bottom left corner */
+  double x = pose.x + WALL_ORIGIN_X + ultrasonicForward*s + ultrasonicLateral*c;
+  double y = pose.y + WALL_ORIGIN_Y + ultrasonicForward*c - ultrasonicLateral*s;
+  double beam = pose.angle + ultrasonicAngle*toRad;
+  double dx = sin(beam), dy = cos(beam);
+  /** the nearest wall along the beam */
+  double range = INFINITY;
+  if(dy > 0 && (WALL_FIELD_SIZE - y)/dy < range){ range = (WALL_FIELD_SIZE - y)/dy; wall = WALL_TOP; incidence = acos(dy); }
+  if(dx > 0 && (WALL_FIELD_SIZE - x)/dx < range){ range = (WALL_FIELD_SIZE - x)/dx; wall = WALL_RIGHT; incidence = acos(dx); }
+  if(dy < 0 && -y/dy < range){ range = -y/dy; wall = WALL_BOTTOM; incidence = acos(-dy); }
+  if(dx < 0 && -x/dx < range){ range = -x/dx; wall = WALL_LEFT; incidence = acos(-dx); }
+  return range;
+}
+/**
+ * Take one ultrasonic sample (refer to ODOM_USE_ULTRASONIC) and, once ULTRASONIC_SAMPLES consecutive samples
+ * on one wall are in, correct the coordinate perpendicular to it (through the estimator with ODOM_ESTIMATOR).
+ * @param state
+ * odometry state; the pose is corrected
+ *
+ * @param pose
+ * pose of the current tick
+ *
+ * @return
+ * true if the pose was corrected
+ */
+bool rangeToWall(OdometryState &state, const PoseSnapshot &pose){
+  FieldWall wall;
+  double incidence;
+  double expected = expectedWallRange(pose, wall, incidence);
+  int32_t reading = ultrasonic.get_value();
+  double measured = reading*ULTRASONIC_IN_PER_UNIT;
+  /** difference across the wall (positive: the robot is closer to the wall than the odometry) */
+  double difference = (expected - measured)*cos(incidence);
+  bool valid = reading > 0 && reading != PROS_ERR && measured >= ULTRASONIC_MIN_RANGE && measured <= ULTRASONIC_MAX_RANGE
+    && incidence*toDeg <= ULTRASONIC_MAX_INCIDENCE && fabs(difference) <= ULTRASONIC_GATE
+    && fabs(pose.angVel)*toDeg <= ULTRASONIC_MAX_ANG_VEL;
+  /** restart the samples on an invalid one or another wall */
+  if(!valid || wall != rangeWall) rangeSamples = 0;
+  rangeWall = wall;
+  if(!valid) return false;
+  rangeFilter.filter(difference);
+  if(++rangeSamples < ULTRASONIC_SAMPLES) return false;
+  /** the filter now holds only the samples of this run: correct along the wall's normal */
+  rangeSamples = 0;
+  double normalX = wall == WALL_RIGHT? 1 : wall == WALL_LEFT? -1 : 0;
+  double normalY = wall == WALL_TOP? 1 : wall == WALL_BOTTOM? -1 : 0;
+#if ODOM_ESTIMATOR
+  /** the median of the samples is a measurement of the position along the normal */
+  return updateAxisEstimate(state.estimate, normalX, normalY, rangeFilter.getOutput(), ESTIMATOR_RANGE_NOISE);
+#else
+  double shift = fmin(fmax(ULTRASONIC_GAIN*rangeFilter.getOutput(), -ULTRASONIC_MAX_SHIFT), ULTRASONIC_MAX_SHIFT);
+  PoseSnapshot correction = {shift*normalX, shift*normalY, 0, 0, 0, pose.timestamp};
+  applyPoseCorrection(state, correction);
+  return true;
+#endif
+}
+#endif
+/**
+ * Read every base sensor exactly once, at (nearly) the same moment.
+ * @return
+ * sensor frame of the current tick
+ */
+HOT_PATH SensorFrame readSensorFrame(){
+  /** a dry run reads the drivetrain model instead (refer to dryRun.hpp) */
+  if(isDryRun()) return getDryRunFrame();
+  SensorFrame frame;
+  frame.timestamp = micros();
+  frame.encdL = encoderL.get_value();
+  frame.encdR = encoderR.get_value();
+#if ODOM_THREE_WHEEL
+  frame.encdS = encoderS.get_value();
+#else
+  frame.encdS = 0;
+#endif
+  frame.motorL = drivetrain.getLeftPosition();
+  frame.motorR = drivetrain.getRightPosition();
+  frame.rawL = drivetrain.getLeftRawPosition(&frame.motorTimeL);
+  frame.rawR = drivetrain.getRightRawPosition(&frame.motorTimeR);
+#if ODOM_USE_IMU
+  /** the IMU reads PROS_ERR_F (infinity) while unplugged */
+  frame.imuValid = !imu.is_calibrating();
+  frame.imuRotation = frame.imuValid? imu.get_rotation() : 0;
+  frame.imuValid = frame.imuValid && std::isfinite(frame.imuRotation);
+  pros::c::imu_accel_s_t accel = frame.imuValid? imu.get_accel() : pros::c::imu_accel_s_t();
+  frame.imuAccelX = accel.x;
+  frame.imuAccelY = accel.y;
+  frame.imuPitch = frame.imuValid? imu.get_pitch() : 0;
+  frame.imuRoll = frame.imuValid? imu.get_roll() : 0;
+#else
+  frame.imuRotation = 0;
+  frame.imuAccelX = frame.imuAccelY = frame.imuPitch = frame.imuRoll = 0;
+  frame.imuValid = false;
+#endif
+  return frame;
+}
+/**
+ * Retrieve the sensor frame that the latest pose was computed from.
+ * @param version (optional)
+ * set to the version of the returned frame
+ *
+ * @return
+ * latest sensor frame published by the odometry task
+ */
+SensorFrame getSensorFrame(uint32_t *version){
+  return sensorLock.read(version);
+}
+/**
+ * Compare the tracking wheels with the motor encoders over one step (refer to ODOM_MOTOR_CHECK).
+ * The tracking wheels are unpowered, so they give the ground travel of each side; the difference
+ * of the motor encoders to it is wheel slip. A tracking wheel that stops counting while its side
+ * drives and the other wheel keeps counting has failed, as have both wheels if neither counts while
+ * both sides drive far (ODOM_TRACKING_BOTH_DIST) or the IMU turns (ODOM_TRACKING_IMU_TURN), and a wheel
+ * whose count jumps away from its side's motors.
+ * @param state
+ * odometry state; the slip and failure fields are updated
+ *
+ * @param changeL, changeR
+ * tracking wheel changes of the step (inches)
+ *
+ * @param motorChangeL, motorChangeR
+ * motor encoder changes of the step (inches)
+ *
+ * @param imuTurn
+ * turn of the IMU over the step (radians; NAN without a valid IMU)
+ *
+ * @param dt
+ * time since the previous step in seconds
+ *
+ * @return
+ * true if a tracking wheel failed at this step
+ */
+bool checkTrackingWheels(OdometryState &state, double changeL, double changeR, double motorChangeL, double motorChangeR,
+                         double imuTurn, double dt){
+  /** ground travel of each side, at the width of the base wheels */
+  double forward = (changeL + changeR)/2;
+  double turn = (changeL - changeR)/state.geometry.baseWidth*motorBaseWidth/2;
+  state.slipL += (fabs(motorChangeL - (forward + turn))/dt - state.slipL)*ODOM_SLIP_FILTER;
+  state.slipR += (fabs(motorChangeR - (forward - turn))/dt - state.slipR)*ODOM_SLIP_FILTER;
+  /** travel of the side's motors and of the other tracking wheel since the wheel last counted */
+  state.stuckL = changeL == 0? state.stuckL + fabs(motorChangeL) : 0;
+  state.crossL = changeL == 0? state.crossL + fabs(changeR) : 0;
+  state.stuckR = changeR == 0? state.stuckR + fabs(motorChangeR) : 0;
+  state.crossR = changeR == 0? state.crossR + fabs(changeL) : 0;
+  state.stillTurn = changeL == 0 && changeR == 0 && !std::isnan(imuTurn)? state.stillTurn + fabs(imuTurn) : 0;
+  uint8_t failed = state.trackingFailed;
+  if(state.stuckL > ODOM_TRACKING_FAIL_DIST && state.crossL > ODOM_TRACKING_FAIL_DIST/2) state.trackingFailed |= ODOM_FAILED_LEFT;
+  if(state.stuckR > ODOM_TRACKING_FAIL_DIST && state.crossR > ODOM_TRACKING_FAIL_DIST/2) state.trackingFailed |= ODOM_FAILED_RIGHT;
+  if((state.stuckL > ODOM_TRACKING_BOTH_DIST && state.stuckR > ODOM_TRACKING_BOTH_DIST) || (state.stillTurn > ODOM_TRACKING_IMU_TURN*toRad
+    && state.stuckL > ODOM_TRACKING_FAIL_DIST && state.stuckR > ODOM_TRACKING_FAIL_DIST)) state.trackingFailed |= ODOM_FAILED_LEFT | ODOM_FAILED_RIGHT;
+  /** a jump is only told from a push over a short step (a parked odometry misses the movement in between) */
+  if(dt*1000 <= ODOM_IDLE_DT){
+    if(fabs(changeL - motorChangeL) > ODOM_TRACKING_JUMP) state.trackingFailed |= ODOM_FAILED_LEFT;
+    if(fabs(changeR - motorChangeR) > ODOM_TRACKING_JUMP) state.trackingFailed |= ODOM_FAILED_RIGHT;
+  }
+  return failed == 0 && state.trackingFailed != 0;
+}
+/**
+ * Ratio of the chord of an arc to its length, 2*sin(angle/2)/angle. Below ODOM_TAYLOR_ANGLE it is
+ * the series 1 - angle^2/24 + angle^4/1920, smooth through a straight tick.
+ * @param angle
+ * angle turned along the arc (radians)
+ *
+ * @return
+ * the chord factor (1 for a straight line)
+ */
+HOT_PATH double chordFactor(double angle){
+  double square = angle*angle;
+  if(square < ODOM_TAYLOR_ANGLE*ODOM_TAYLOR_ANGLE) return 1 - square/24*(1 - square/80);
+  return 2*odomSin(angle/2)/angle;
+}
+/**
+ * Move the pose by the twist of a tick with the exponential map of SE(2): the forward and lateral
+ * travel follow an arc of constant curvature turning deltaAngle from the previous bearing, so the
+ * displacement is the travel scaled by the chord factor and rotated to the mean bearing.
+ * @param state
+ * odometry state; x & y are updated
+ *
+ * @param forward
+ * travel of the tracking centre along the arc (inches)
+ *
+ * @param lateral
+ * sideways travel to the right (inches)
+ *
+ * @param deltaAngle
+ * change of the encoder bearing over the tick (radians)
+ */
+HOT_PATH void integrateTwist(OdometryState &state, double forward, double lateral, double deltaAngle){
+  double chord = chordFactor(deltaAngle), meanAngle = state.prevAngle + deltaAngle/2;
+  double sinMean = odomSin(meanAngle), cosMean = odomCos(meanAngle);
+  state.x += chord*(forward*sinMean + lateral*cosMean);
+  state.y += chord*(forward*cosMean - lateral*sinMean);
+}
+/**
+ * One odometry step: integrate a sensor frame into the pose.
+ * @param state
+ * odometry state; updated
+ *
+ * @param frame
+ * sensor frame of the step
+ *
+ * @param reset
+ * pose requested by setCoords, applied before the integration (NULL if none)
+ *
+ * @return
+ * the new pose
+ *
+ * @note
+ * Once a tracking wheel has failed (refer to ODOM_MOTOR_CHECK), both sides are integrated from
+ * the motor encoders at motorBaseWidth; the heading carries on from the last tracking wheel step,
+ * turning with the IMU while it is valid (refer to ODOM_FAILED_IMU).
+ */
+HOT_PATH PoseSnapshot stepOdometry(OdometryState &state, const SensorFrame &frame, const PoseSnapshot *reset){
+  /** a reset (or a new state) takes the current geometry */
+  if(reset != NULL || state.geometry.inPerDeg == 0) state.geometry = geometryLock.read();
+  /** encoder values in inches */
+  double encdL = frame.encdL*state.geometry.inPerDeg;
+  double encdR = frame.encdR*state.geometry.inPerDeg;
+  double encdS = frame.encdS*state.geometry.inPerDeg;
+  double motorL = frame.motorL*inPerMotorDeg;
+  double motorR = frame.motorR*inPerMotorDeg;
+  /** the side distances that are integrated (tracking wheels unless one has failed) */
+  bool motorSource = state.trackingFailed != 0;
+  double sideL = motorSource? motorL : encdL, sideR = motorSource? motorR : encdR;
+  double width = motorSource? motorBaseWidth : state.geometry.baseWidth;
+  /** turn of the IMU since the previous step (NAN unless aligned and valid; read before the fusion moves prevImuRotation) */
+  double imuTurn = frame.imuValid && state.imuAligned && reset == NULL? (frame.imuRotation - state.prevImuRotation)*toRad : NAN;
+  /** a gap of the IMU (calibrating, unplugged) may restart its rotation: it is aligned again at its next valid sample */
+  if(!frame.imuValid) state.imuAligned = false;
+  /** apply a pending setCoords request */
+  if(reset != NULL){
+    state.x = reset->x;
+    state.y = reset->y;
+    state.angleOffset = reset->angle - (sideL - sideR)/width;
+    state.prevAngle = reset->angle;
+    state.prevEncdL = encdL;
+    state.prevEncdR = encdR;
+    state.prevEncdS = encdS;
+    state.prevMotorL = motorL;
+    state.prevMotorR = motorR;
+    state.imuAligned = false;
+    resetEstimate(state.estimate, reset->x, reset->y, reset->angle);
+  }
+#if ODOM_MOTOR_CHECK
+  /** cross-check, switching to the motor encoders if a tracking wheel fails now */
+  if(!motorSource && state.prevTimestamp != 0 && frame.timestamp > state.prevTimestamp
+    && std::isfinite(motorL - state.prevMotorL) && std::isfinite(motorR - state.prevMotorR)
+    && checkTrackingWheels(state, encdL - state.prevEncdL, encdR - state.prevEncdR, motorL - state.prevMotorL,
+                           motorR - state.prevMotorR, imuTurn, (frame.timestamp - state.prevTimestamp)/1000000.0)){
+    motorSource = true;
+    sideL = motorL;
+    sideR = motorR;
+    width = motorBaseWidth;
+    /** the turn missed while the wheel was failing is taken back from the IMU */
+    if(ODOM_FAILED_IMU && !std::isnan(imuTurn)){
+      state.prevAngle = state.prevImuRotation*toRad + state.imuOffset;
+#if ODOM_ESTIMATOR
+      state.estimate.state(ESTIMATE_ANGLE, 0) = state.prevAngle;
+#endif
+    }
+    state.angleOffset = state.prevAngle - (state.prevMotorL - state.prevMotorR)/width;
+  }
+#endif
+  /** refer to Odometry Documentation.docx for mathematical proof */
+  /** not bounded: the bearing is continuous (refer to PoseSnapshot) */
+  state.angle = (sideL - sideR)/width + state.angleOffset;
+#if !ODOM_ESTIMATOR
+  /** complementary filter: pull the heading towards the IMU at every new IMU sample */
+  if(frame.imuValid){
+    double imuAngle = frame.imuRotation*toRad;
+    if(!state.imuAligned){
+      state.imuOffset = state.angle - imuAngle;
+      state.imuAligned = true;
+    }
+    else if(frame.imuRotation != state.prevImuRotation){
+      double correction = ODOM_IMU_GAIN*(imuAngle + state.imuOffset - state.angle);
+      state.angleOffset += correction;
+      state.angle += correction;
+    }
+    state.prevImuRotation = frame.imuRotation;
+  }
+#endif
+  /** difference of current encoder values from previous encoder values */
+  double encdChangeL = sideL - (motorSource? state.prevMotorL : state.prevEncdL);
+  double encdChangeR = sideR - (motorSource? state.prevMotorR : state.prevEncdR);
+  double encdChangeS = (encdS-state.prevEncdS);
+  /** refer to Odometry Documentation.docx for mathematical proof */
+  double sumEncdChange = encdChangeL + encdChangeR;
+  double deltaAngle = (encdChangeL - encdChangeR)/width;
+  /** the IMU turns the heading in place of the motor encoders, whose wheels scrub */
+  state.imuHeading = ODOM_FAILED_IMU && motorSource && !std::isnan(imuTurn);
+  if(state.imuHeading){
+    state.angleOffset += imuTurn - deltaAngle;
+    state.angle += imuTurn - deltaAngle;
+    deltaAngle = imuTurn;
+  }
+#if ODOM_ESTIMATOR
+  /** the estimator integrates the velocities (the perpendicular wheel's movement is its input) */
+  stepEstimate(state, frame, sumEncdChange/2, deltaAngle, ODOM_THREE_WHEEL? encdChangeS + perpOffset*deltaAngle : 0);
+#elif ODOM_THREE_WHEEL
+  /**
+   * lateral movement (to the right): the perpendicular wheel change minus its travel
+   * from turning, as it sits perpOffset behind the tracking centre
+   */
+  double lateral = encdChangeS + perpOffset*deltaAngle;
+  integrateTwist(state, sumEncdChange/2, lateral, deltaAngle);
+#else
+  /** update x- and y-coordinates (refer to Odometry Documentation.docx for mathematical proof) */
+  double lateral = 0;
+  integrateTwist(state, sumEncdChange/2, lateral, deltaAngle);
+#endif
+#if !ODOM_ESTIMATOR
+  /** the estimate only carries the uncertainty of the integrated pose */
+  if(!state.estimate.initialized) resetEstimate(state.estimate, state.x, state.y, state.angle);
+  growEstimateUncertainty(state.estimate, state.prevAngle, sumEncdChange/2, lateral, deltaAngle);
+  /** velocities over the measured time since the previous step */
+  if(state.prevTimestamp != 0 && frame.timestamp > state.prevTimestamp){
+    double dt = (frame.timestamp - state.prevTimestamp)/1000000.0;
+    state.linVel = sumEncdChange/2/dt;
+    state.angVel = deltaAngle/dt;
+  }
+#if ODOM_TICK_VELOCITY
+  double tickVelL = stepTickVelocity(state.tickL, frame.encdL, frame.timestamp)*state.geometry.inPerDeg;
+  double tickVelR = stepTickVelocity(state.tickR, frame.encdR, frame.timestamp)*state.geometry.inPerDeg;
+  /** the motor encoders (a tracking wheel failed) keep the differenced velocities */
+  if(!motorSource){
+    state.linVel = (tickVelL + tickVelR)/2;
+    state.angVel = (tickVelL - tickVelR)/width;
+  }
+#endif
+#endif
+  /** Update prev variables */
+  state.prevTimestamp = frame.timestamp;
+  state.prevEncdL = encdL;
+  state.prevEncdR = encdR;
+  state.prevEncdS = encdS;
+  state.prevMotorL = motorL;
+  state.prevMotorR = motorR;
+  state.prevAngle = state.angle;
+  PoseSnapshot pose = {state.x, state.y, state.angle, state.linVel, state.angVel, frame.timestamp};
+  return pose;
+}
+/**
+ * Calibrate the IMU (about 2 s, keep the robot still) and wait for the end of the calibration.
+ * Run by the BOOT_CALIBRATION stage (refer to bootSequence.hpp); the odometry uses the encoders
+ * meanwhile and aligns the IMU at its first valid sample.
+ */
+void calibrateImu(){
+#if ODOM_USE_IMU
+  imu.reset();
+  while(imu.is_calibrating()) delay(BOOT_POLL_DT);
+#endif
+}
+/**
+ * Start a new calibration of the IMU without waiting for it (about 2 s, keep the robot still), e.g. after a long
+ * wait in the disabled phase (refer to PRECOMPUTE_IMU). The odometry uses the encoders meanwhile, and aligns the
+ * IMU again at its first valid sample (its rotation starts over at 0).
+ */
+void recalibrateImu(){
+#if ODOM_USE_IMU
+  imu.reset();
+  imuResets.fetch_add(1, std::memory_order_release);
+#endif
+}
+/**
+ * Bring the odometry back to ODOM_DT before a commanded movement starts, instead of at its first
+ * moving tick (refer to ODOM_ADAPTIVE_RATE). Cheap while the odometry runs at full rate.
+ */
+void wakeOdometry(){
+  if(!odometryIdle.load(std::memory_order_acquire)) return;
+  pros::task_t task = getTaskHandle(ROBOT_ODOMETRY);
+  if(task != NULL) pros::c::task_notify(task);
+}
+/**
+ * @return
+ * whether nothing moved between two sensor frames (refer to ODOM_IDLE_MOTOR)
+ */
+bool baseStill(const SensorFrame &frame, const SensorFrame &prev){
+  return frame.encdL == prev.encdL && frame.encdR == prev.encdR && frame.encdS == prev.encdS &&
+    frame.imuRotation == prev.imuRotation && fabs(frame.motorL - prev.motorL) <= ODOM_IDLE_MOTOR &&
+    fabs(frame.motorR - prev.motorR) <= ODOM_IDLE_MOTOR;
+}
+/**
+ * Shift of the odometry schedule towards reading every motor sample ODOM_PHASE_LAG ms after its update
+ * (refer to ODOM_PHASE_LOCK). A stale read (the update came after the tick) gives an age over
+ * SENSOR_DEVICE_DT, which wraps to a late shift.
+ * @param frame
+ * sensor frame of the tick
  *
  * @return
- * encoder values packaged in a pair
+ * shift in ms (negative: earlier), at most ODOM_PHASE_STEP either way
  */
-std::pair<double, double> getEncdVals(bool rawData = false){
-  if(!rawData) return std::make_pair((double) encoderL.get_value()*inPerDeg, (double) encoderR.get_value()*inPerDeg);
-  else return std::make_pair((double)encoderL.get_value(), (double)encoderR.get_value());
+int32_t odometryPhaseShift(const SensorFrame &frame){
+  int32_t age = (int32_t)(frame.timestamp/1000 - frame.motorTimeL);
+  int32_t error = ((age - ODOM_PHASE_LAG)%SENSOR_DEVICE_DT + SENSOR_DEVICE_DT)%SENSOR_DEVICE_DT;
+  if(error > SENSOR_DEVICE_DT/2) error -= SENSOR_DEVICE_DT;
+  return -std::max(-ODOM_PHASE_STEP, std::min(ODOM_PHASE_STEP, error));
 }
 /** Update the robot's position using side encoders values. */
 void baseOdometry(void * ignore){
-  /** previous encoder values; to be used in calculations */
-  double prevEncdL = 0;
-  double prevEncdR = 0;
-  double prevAngle = 0;
+  /** integration state (refer to stepOdometry) */
+  OdometryState state = {};
   /** indexer */
   int count = 0;
-  while(!COMPETITION_MODE || competition::is_autonomous()){
-    /** retrieve & update encoder values */
-    encdL = getEncdVals().first;
-    encdR = getEncdVals().second;
-    /** refer to Odometry Documentation.docx for mathematical proof */
-    // position.angle = boundRad((encdL - encdR)/baseWidth);
-    position.angle = (encdL - encdR)/baseWidth;
-    /** difference of current encoder values from previous encoder values */
-    double encdChangeL = (encdL-prevEncdL);
-    double encdChangeR = (encdR-prevEncdR);
-    /** refer to Odometry Documentation.docx for mathematical proof */
-    double sumEncdChange = encdChangeL + encdChangeR;
-    double deltaAngle = (encdChangeL - encdChangeR)/baseWidth;
-    /** update x- and y-coordinates */
-    if(deltaAngle == 0) {
-      /** handle 0 as the formula involves division by deltaAngle */
-      /** refer to Odometry Documentation.docx for mathematical proof */
-			position.x += sumEncdChange/2*sin(position.angle);
-			position.y += sumEncdChange/2*cos(position.angle);
-		}
-		else {
-      /** refer to Odometry Documentation.docx for mathematical proof */
-			double halfDeltaAngle = deltaAngle/2;
-			position.x += (sumEncdChange/deltaAngle)*sin(halfDeltaAngle)*sin(prevAngle+halfDeltaAngle);
-			position.y += (sumEncdChange/deltaAngle)*sin(halfDeltaAngle)*cos(prevAngle+halfDeltaAngle);
-		}
-    /** Update prev variables */
-		prevEncdL = encdL;
-		prevEncdR = encdR;
-		prevAngle = position.angle;
-    /** print to assist debugging */
-    if(!COMPETITION_MODE) position.printCoordsMaster();
-    if((DEBUG_MODE == 1) && (count++ % 10 == 0)) position.printCoordsTerminal();
-    if(DEBUG_MODE == 4) printf("Encoder values %4.0f \t %4.0f\n",getEncdVals(true).first,getEncdVals(true).second);
-    /** refresh rate of Task */
-    Task::delay(5);
+#if ODOM_MOTOR_CHECK
+  /** cross-check result of the previous tick */
+  OdometryHealth prevHealth = {};
+#endif
+  /** time of the sensor frame of the last setCoords (corrections from older poses are dropped) */
+  uint64_t resetTime = 0;
+  /** IMU calibrations started by recalibrateImu that the integration has seen */
+  uint32_t imuResetsSeen = 0;
+#if ODOM_USE_ULTRASONIC
+  /** ticks since the last ultrasonic sample */
+  int rangeTick = 0;
+#endif
+  /** period of the loop */
+  LoopRate rate(ODOM_DT);
+  /** adaptive rate (refer to ODOM_ADAPTIVE_RATE): ODOM_DT periods covered by the current tick, and time the base has stood still */
+  uint32_t ticks = 1, stillTime = 0;
+  SensorFrame prevFrame = {};
+  /** the sensors were the dry run's model at the previous tick */
+  bool dryRunSeen = false;
+  startTaskTiming(TIMING_ODOMETRY, ODOM_DT, true);
+  /** in competition mode only track during autonomous (refer to taskRegistry.cpp) */
+  if(COMPETITION_MODE) setTaskPhases(ROBOT_ODOMETRY, PHASE_AUTON);
+  while(true){
+    if(waitTaskActive(ROBOT_ODOMETRY)){
+      /** restart the period (at full rate) after being parked */
+      rate.restart();
+      ticks = 1;
+      stillTime = 0;
+      odometryIdle.store(false, std::memory_order_release);
+      startTaskTiming(TIMING_ODOMETRY, ODOM_DT, true);
+    }
+    beginTaskIteration(TIMING_ODOMETRY);
+    /** retrieve the encoder values (one read per sensor per tick), or step the dry run's model and take its frame */
+    bool dryRun = isDryRun();
+    if(dryRun) stepDryRun();
+    SensorFrame frame = dryRun? getDryRunFrame() : readSensorFrame();
+    sensorLock.write(frame);
+    /** a recalibration may have ended while the task was parked: align the IMU again at this sample */
+    uint32_t resets = imuResets.load(std::memory_order_acquire);
+    if(resets != imuResetsSeen){
+      imuResetsSeen = resets;
+      state.imuAligned = false;
+    }
+    /** integrate, applying a pending setCoords request or pose correction first */
+    PoseSnapshot reset;
+    uint8_t keep = 0;
+    bool resetting = resetPending.exchange(false, std::memory_order_acquire);
+    if(resetting){
+      reset = resetLock.read();
+      keep = resetKeep.load(std::memory_order_relaxed);
+    }
+    /** the sensors switched to or from the dry run's model: integrate on from the new frame, at the same pose (and uncertainty) */
+    if(dryRun != dryRunSeen && !resetting){
+      reset = getPose();
+      reset.timestamp = frame.timestamp;
+      resetting = true;
+      keep = ODOM_KEEP_X | ODOM_KEEP_Y | ODOM_KEEP_ANGLE;
+    }
+    dryRunSeen = dryRun;
+    if(resetting) resetTime = frame.timestamp;
+    /** apply a pending correction computed after the last reset */
+    if(correctionPending.exchange(false, std::memory_order_acquire)){
+      PoseSnapshot correction = correctionLock.read();
+      if(!resetting && correction.timestamp >= resetTime){
+        applyPoseCorrection(state, correction);
+        poseCorrections.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+#if ODOM_ESTIMATOR
+    /** landmarks seen since the previous tick (weighed against the poses at their capture) */
+    if(!resetting && updateLandmarks(state, resetTime)) poseCorrections.fetch_add(1, std::memory_order_relaxed);
+#endif
+    /** covariance before a reset, for the coordinates it keeps (nothing to keep before the first estimate) */
+    bool keeping = resetting && keep != 0 && state.estimate.initialized;
+    Matrix<ESTIMATE_SIZE, ESTIMATE_SIZE> prior = keeping? state.estimate.covariance : Matrix<ESTIMATE_SIZE, ESTIMATE_SIZE>{};
+    PoseSnapshot pose = stepOdometry(state, frame, resetting? &reset : NULL);
+    if(keeping){
+      for(int index : {ESTIMATE_X, ESTIMATE_Y, ESTIMATE_ANGLE}){
+        if(keep & (1 << index)) keepEstimateVariance(state.estimate, prior, index);
+      }
+    }
+    PoseUncertainty uncertainty = getEstimateUncertainty(state.estimate);
+    uncertainty.timestamp = pose.timestamp;
+    /** encoder values in inches, at the geometry of the integration */
+    encdL = frame.encdL*state.geometry.inPerDeg;
+    encdR = frame.encdR*state.geometry.inPerDeg;
+    encdS = frame.encdS*state.geometry.inPerDeg;
+    position = poseOf(pose);
+    /** publish the new pose to the other tasks */
+    poseLock.write(pose);
+    uncertaintyLock.write(uncertainty);
+    recordPose(pose);
+    markBoot(BOOT_MARK_ODOMETRY);
+#if ODOM_USE_ULTRASONIC
+    /** wall ranging: a correction is applied at the next tick, and counted like one from correctPose */
+    if(++rangeTick >= ULTRASONIC_TICKS){
+      rangeTick = 0;
+      if(!resetting && rangeToWall(state, pose)) poseCorrections.fetch_add(1, std::memory_order_relaxed);
+    }
+#endif
+    /** only updates the display buffer; the controllerService task sends it */
+    if(!COMPETITION_MODE) printPoseMaster(position);
+    /** record to assist debugging (printed by the telemetry drain task) */
+    /** framed telemetry is compact enough for every tick, text only every 10th */
+    if constexpr(TracePoint<TRACE_ODOM>::enabled){
+      if(TELEMETRY_FORMAT == TELEMETRY_FRAMED || TELEMETRY_FORMAT == TELEMETRY_DELTA || count++ % 10 == 0) TracePoint<TRACE_ODOM>::record(TELEMETRY_POSE, position.x, position.y, position.angle*toDeg);
+    }
+    TracePoint<TRACE_ENCODERS>::record(TELEMETRY_ENCODERS, frame.encdL, frame.encdR);
+#if ODOM_MOTOR_CHECK
+    /** publish the cross-check, reporting the start of a slip and a change of source (also shown by the dashboard) */
+    OdometrySource source = state.trackingFailed == 0? ODOM_SOURCE_TRACKING : state.imuHeading? ODOM_SOURCE_MOTORS_IMU : ODOM_SOURCE_MOTORS;
+    OdometryHealth health = {state.slipL, state.slipR, fmax(state.slipL, state.slipR) > ODOM_SLIP_RATE, state.trackingFailed, source};
+    if((health.slipping && !prevHealth.slipping) || health.trackingFailed != prevHealth.trackingFailed || health.source != prevHealth.source){
+      pushTelemetry(TELEMETRY_SLIP, health.slipL, health.slipR, health.trackingFailed, health.source);
+    }
+    healthLock.write(health);
+    prevHealth = health;
+#endif
+    /** wake the consumers of the new pose */
+    notifyOdometrySubscribers(ticks);
+    endTaskIteration(TIMING_ODOMETRY);
+#if ODOM_ADAPTIVE_RATE
+    stillTime = baseStill(frame, prevFrame)? stillTime + ticks*ODOM_DT : 0;
+    prevFrame = frame;
+    bool idle = odometryIdle.load(std::memory_order_relaxed);
+    if(idle && stillTime == 0){
+      /** the base moved: back to full rate */
+      odometryIdle.store(false, std::memory_order_release);
+      startTaskTiming(TIMING_ODOMETRY, ODOM_DT, true);
+      rate.restart();
+      ticks = 1;
+    }
+    else if(idle || stillTime >= ODOM_IDLE_TIME){
+      if(!idle){
+        /** flag idle before sleeping, so a wake in between is not lost */
+        odometryIdle.store(true, std::memory_order_release);
+        startTaskTiming(TIMING_ODOMETRY, ODOM_IDLE_DT, false);
+      }
+      /** sleep for ODOM_IDLE_DT, or until a movement is commanded */
+      Timer slept;
+      if(pros::c::task_notify_take(true, ODOM_IDLE_DT) > 0){
+        /** woken: the next tick covers the periods slept, and the following ones run at full rate */
+        odometryIdle.store(false, std::memory_order_release);
+        startTaskTiming(TIMING_ODOMETRY, ODOM_DT, true);
+        stillTime = 0;
+        ticks = (slept.elapsed() + ODOM_DT/2)/ODOM_DT;
+        if(ticks < 1) ticks = 1;
+      }
+      else ticks = ODOM_IDLE_DT/ODOM_DT;
+      rate.restart();
+      continue;
+    }
+#endif
+#if ODOM_PHASE_LOCK
+    if(frame.rawL != PROS_ERR) rate.shift(odometryPhaseShift(frame));
+#endif
+    /** refresh rate of Task (fixed period regardless of the loop body duration) */
+    rate.wait();
   }
 }
@@ -0,0 +1,76 @@
+/**
+ * Battery model functions (refer to batteryModel.hpp):
+ * - Fit of the open-circuit voltage and the internal resistance (motor health task)
+ * - Voltage predicted under a current, and the current that keeps the battery above BATTERY_MIN_VOLTAGE
+ */
+#include "main.h"
+/**
+ * Model state
+ * batteryLock: the state (written by the motor health task only)
+ * varCurrent, covVoltageCurrent: weighted variance of the current and covariance of the voltage with it (writer only)
+ * reportedResistance: resistance last pushed to the telemetry (writer only)
+ */
+SeqLock<BatteryState> batteryLock;
+double varCurrent = 0, covVoltageCurrent = 0;
+float reportedResistance = 0;
+/**
+ * Add a sample of the battery to the fit (the motor health task, every MOTOR_HEALTH_DT).
+ * @param voltage
+ * battery voltage in mV (pros::battery::get_voltage; a failed reading is ignored)
+ *
+ * @param current
+ * battery current in mA (pros::battery::get_current)
+ */
+void updateBatteryModel(int32_t voltage, int32_t current){
+  if(voltage <= 0 || voltage == PROS_ERR || current == PROS_ERR) return;
+  BatteryState state = batteryLock.read();
+  if(state.voltage == 0){
+    state.voltage = voltage;
+    state.current = current;
+  }
+  double dCurrent = current - state.current, dVoltage = voltage - state.voltage;
+  state.current += BATTERY_FILTER*dCurrent;
+  state.voltage += BATTERY_FILTER*dVoltage;
+  varCurrent = (1 - BATTERY_FILTER)*(varCurrent + BATTERY_FILTER*dCurrent*dCurrent);
+  covVoltageCurrent = (1 - BATTERY_FILTER)*(covVoltageCurrent + BATTERY_FILTER*dCurrent*dVoltage);
+  /** a steady load says nothing of the resistance: the last fit is kept */
+  if(varCurrent >= BATTERY_MIN_SPREAD*BATTERY_MIN_SPREAD){
+    double resistance = -covVoltageCurrent/varCurrent;
+    if(resistance >= BATTERY_MIN_RESISTANCE && resistance <= BATTERY_MAX_RESISTANCE) state.resistance = resistance;
+  }
+  state.openVoltage = state.voltage + state.resistance*state.current;
+  batteryLock.write(state);
+  if(state.resistance != 0 && fabs(state.resistance - reportedResistance) >= BATTERY_REPORT_CHANGE*state.resistance){
+    pushTelemetry(TELEMETRY_BATTERY, state.openVoltage, state.resistance, state.voltage, state.current);
+    reportedResistance = state.resistance;
+  }
+}
+/**
+ * @return
+ * the latest state of the model (all 0 before the first sample)
+ */
+BatteryState getBatteryState(){
+  return batteryLock.read();
+}
+/**
+ * Battery voltage under a current (cheap: the control loops call it every cycle).
+ * @param current
+ * total current of the motors in mA
+ *
+ * @return
+ * the voltage in mV, the mean measured voltage while the resistance is not known (0 before the first sample)
+ */
+HOT_PATH double predictBatteryVoltage(double current){
+  BatteryState state = batteryLock.read();
+  if(state.resistance == 0) return state.voltage;
+  return state.openVoltage - state.resistance*current;
+}
+/**
+ * @return
+ * the total current in mA that pulls the battery down to BATTERY_MIN_VOLTAGE (INT32_MAX while the resistance is not known)
+ */
+int32_t getBatteryCurrentLimit(){
+  BatteryState state = batteryLock.read();
+  if(state.resistance == 0) return INT32_MAX;
+  return (int32_t)fmax((state.openVoltage - BATTERY_MIN_VOLTAGE)/state.resistance, 0);
+}
@@ -0,0 +1,448 @@
+/**
+ * Microbenchmarks:
+ * - Timing of one kernel over precomputed inputs
+ * - Suite: boundRad, abscap, trigonometry, odometry step, PD + ramp step, lookahead search, spline query, path planning,
+ *   RAMSETE and MPC tracking (cost and tracking error),
+ *   5x5 matrix product and inverse, pose batch in double and float
+ */
+#include "main.h"
+/** results are summed here so that the compiler cannot drop the timed calls */
+volatile double benchmarkSink = 0;
+/**
+ * Print the cost of a kernel.
+ * @param name
+ * kernel name
+ *
+ * @param start
+ * micros() before the timed loop
+ *
+ * @param calls
+ * number of calls in the timed loop
+ */
+void printBenchmark(const char *name, uint64_t start, int calls){
+  double ns = (micros() - start)*1000.0/calls;
+  if(BENCHMARK_CPU_MHZ > 0) printf("%-16s %9.1f ns/call %8.0f cycles\n", name, ns, ns*BENCHMARK_CPU_MHZ/1000);
+  else printf("%-16s %9.1f ns/call\n", name, ns);
+}
+/**
+ * Time the 5x5 matrix product and inverse (the size of the pose estimator's covariance).
+ * @param iterations
+ * number of calls of each
+ */
+void benchmarkMatrix(int iterations){
+  Matrix<ESTIMATE_SIZE, ESTIMATE_SIZE> inputs[BENCHMARK_INPUTS];
+  /** diagonally dominant, so every input is invertible */
+  for(int i = 0; i < BENCHMARK_INPUTS; i++){
+    for(int r = 0; r < ESTIMATE_SIZE; r++) for(int c = 0; c < ESTIMATE_SIZE; c++) inputs[i](r, c) = r == c? 10 + i : sin(i + r*5 + c);
+  }
+  uint64_t start = micros();
+  for(int i = 0; i < iterations; i++){
+    benchmarkSink = benchmarkSink + (inputs[i%BENCHMARK_INPUTS]*inputs[(i + 1)%BENCHMARK_INPUTS])(i%ESTIMATE_SIZE, 0);
+  }
+  printBenchmark("matrix 5x5 mul", start, iterations);
+  start = micros();
+  for(int i = 0; i < iterations; i++){
+    Matrix<ESTIMATE_SIZE, ESTIMATE_SIZE> inverse = {};
+    invertMatrix(inputs[i%BENCHMARK_INPUTS], inverse);
+    benchmarkSink = benchmarkSink + inverse(i%ESTIMATE_SIZE, 0);
+  }
+  printBenchmark("matrix 5x5 inv", start, iterations);
+}
+/**
+ * Time the lookahead search of pure pursuit along a zigzag path of MAX_PURSUIT_POINTS waypoints.
+ * The path is reset between passes (outside of the timed sections).
+ * Stops the pursuit afterwards; do not run while the base is following a path.
+ * @param iterations
+ * number of calls
+ */
+void benchmarkLookahead(int iterations){
+  const int POSES = 4*BENCHMARK_INPUTS;
+  PursuitPoint points[MAX_PURSUIT_POINTS - 1];
+  for(int i = 0; i < MAX_PURSUIT_POINTS - 1; i++) points[i] = {(i%2)*12.0, i*6.0};
+  PoseSnapshot poses[POSES];
+  for(int i = 0; i < POSES; i++) poses[i] = {6 + 3*sin(i*0.3), i*(MAX_PURSUIT_POINTS - 2)*6.0/POSES, 0, 0, 0, 0};
+  uint64_t elapsed = 0;
+  int calls = 0;
+  while(calls < iterations){
+    setPursuitPath(points, MAX_PURSUIT_POINTS - 1, PURSUIT_LOOKAHEAD, PURSUIT_MAX_VEL, false);
+    PursuitPoint target;
+    uint64_t start = micros();
+    for(int i = 0; i < POSES; i++){
+      findLookahead(poses[i], target);
+      benchmarkSink = benchmarkSink + target.x;
+    }
+    elapsed += micros() - start;
+    calls += POSES;
+  }
+  stopPursuit();
+  printBenchmark("findLookahead", micros() - elapsed, calls);
+}
+/**
+ * Time the "point at distance" query of a spline path (table search and polynomial evaluation).
+ * @param iterations
+ * number of calls
+ */
+void benchmarkSpline(int iterations){
+  static SplinePath path;
+  Waypoint points[MAX_SPLINE_POINTS];
+  for(int i = 0; i < MAX_SPLINE_POINTS; i++) points[i] = {(i%2)*12.0, i*12.0, (i%2)? -0.5 : 0.5};
+  buildSplinePath(path, points, MAX_SPLINE_POINTS);
+  uint64_t start = micros();
+  for(int i = 0; i < iterations; i++){
+    benchmarkSink = benchmarkSink + splinePointAtDistance(path, (i%BENCHMARK_INPUTS)*path.length/BENCHMARK_INPUTS).x;
+  }
+  printBenchmark("splinePoint", start, iterations);
+}
+/**
+ * Time the move of a batch of BENCHMARK_INPUTS poses to the field (transformPoses), in one scalar.
+ * @param name
+ * kernel name
+ *
+ * @param iterations
+ * number of poses moved
+ */
+template<typename Scalar> void benchmarkPoseBatch(const char *name, int iterations){
+  Pose<Scalar> poses[BENCHMARK_INPUTS], moved[BENCHMARK_INPUTS];
+  for(int i = 0; i < BENCHMARK_INPUTS; i++) poses[i] = {(Scalar)(i%8), (Scalar)(i*1.5), (Scalar)(i*0.1)};
+  int calls = 0;
+  uint64_t start = micros();
+  for(int i = 0; calls < iterations; i++, calls += BENCHMARK_INPUTS){
+    Pose<Scalar> frame = {(Scalar)(i%16), (Scalar)(i%32), (Scalar)((i%64)*0.1)};
+    transformPoses(poses, moved, BENCHMARK_INPUTS, frame);
+    benchmarkSink = benchmarkSink + moved[i%BENCHMARK_INPUTS].x;
+  }
+  printBenchmark(name, start, calls);
+}
+/**
+ * Time the path planner on plans across the field, around the centre goal.
+ * @param calls
+ * number of plans
+ */
+void benchmarkPlanner(int calls){
+  PursuitPoint points[MAX_PURSUIT_POINTS - 1];
+  uint64_t start = micros();
+  for(int i = 0; i < calls; i++){
+    double side = i%2? 1 : -1;
+    benchmarkSink = benchmarkSink + planPath(-40*side, -40, 40*side, 40, points, MAX_PURSUIT_POINTS - 1);
+  }
+  printBenchmark("planPath", start, calls);
+}
+/**
+ * Time the lattice planner on the same plans as benchmarkPlanner, from rest.
+ * @param calls
+ * number of plans
+ */
+void benchmarkLattice(int calls){
+  LatticeStep steps[LATTICE_MAX_STEPS];
+  double time;
+  uint64_t start = micros();
+  for(int i = 0; i < calls; i++){
+    double side = i%2? 1 : -1;
+    benchmarkSink = benchmarkSink + planLattice(-40*side, -40, 0, 0, 40*side, 40, steps, LATTICE_MAX_STEPS, time);
+  }
+  printBenchmark("planLattice", start, calls);
+}
+/**
+ * Compare the RAMSETE and MPC trackers on an S-curve trajectory (TRACKER_BENCH_TIME long, up to
+ * TRACKER_BENCH_VEL) driven by a kinematic base whose sides reach their commands with a first-order lag of
+ * TRACKER_BENCH_LAG, from a pose TRACKER_BENCH_OFFSET off its start: prints the cost per control cycle of
+ * each, and the RMS and largest distance to the reference pose over the run.
+ * Resets the MPC tracker's warm start; do not run while the base follows a trajectory.
+ * @param calls
+ * number of timed calls of each tracker
+ */
+void benchmarkTrackers(int calls){
+  const int LENGTH = TRACKER_BENCH_TIME/TRACKER_BENCH_DT;
+  static PackedSegment left[LENGTH], right[LENGTH];
+  static PackedPose poses[LENGTH];
+  double velL[LENGTH], velR[LENGTH], largestVel = 0, largestAcc = 0;
+  /** the reference: a trapezoidal speed, weaving at up to 2 rad/s, integrated at the segment step */
+  double x = 0, y = 0, angle = 0, positionL = 0, positionR = 0;
+  for(int i = 0; i < LENGTH; i++){
+    double t = i*TRACKER_BENCH_DT;
+    double vel = TRACKER_BENCH_VEL*fmin(fmin(t, TRACKER_BENCH_TIME - TRACKER_BENCH_DT - t)/0.5, 1);
+    double turn = 2*sin(2*M_PI*t/1.5)*vel/TRACKER_BENCH_VEL;
+    velL[i] = vel + turn*baseWidth/2;
+    velR[i] = vel - turn*baseWidth/2;
+    poses[i] = {(float)x, (float)y, (float)angle};
+    left[i].position = positionL;
+    right[i].position = positionR;
+    x += vel*sin(angle)*TRACKER_BENCH_DT;
+    y += vel*cos(angle)*TRACKER_BENCH_DT;
+    angle += turn*TRACKER_BENCH_DT;
+    positionL += velL[i]*TRACKER_BENCH_DT;
+    positionR += velR[i]*TRACKER_BENCH_DT;
+    largestVel = fmax(largestVel, fmax(fabs(velL[i]), fabs(velR[i])));
+    if(i > 0) largestAcc = fmax(largestAcc, fmax(fabs(velL[i] - velL[i - 1]), fabs(velR[i] - velR[i - 1]))/TRACKER_BENCH_DT);
+  }
+  float velScale = largestVel/INT16_MAX, accScale = fmax(largestAcc, 1)/INT16_MAX;
+  for(int i = 0; i < LENGTH; i++){
+    int next = std::min(i + 1, LENGTH - 1);
+    left[i].velocity = lround(velL[i]/velScale);
+    right[i].velocity = lround(velR[i]/velScale);
+    left[i].acceleration = lround((velL[next] - velL[i])/TRACKER_BENCH_DT/accScale);
+    right[i].acceleration = lround((velR[next] - velR[i])/TRACKER_BENCH_DT/accScale);
+  }
+  CachedTrajectory trajectory = {"tracker bench", left, right, LENGTH, TRACKER_BENCH_DT, velScale, accScale, poses, false, false, 0};
+  prepareMpc();
+  const char *names[2] = {"ramsete", "mpc"};
+  for(int tracker = 0; tracker < 2; tracker++){
+    /** tracking: a control cycle every BASE_CONTROL_DT, the base integrated every millisecond */
+    resetMpc();
+    PoseSnapshot pose = {TRACKER_BENCH_OFFSET, -TRACKER_BENCH_OFFSET, TRACKER_BENCH_OFFSET*0.05, 0, 0, 0};
+    double sideL = 0, sideR = 0, commandL = 0, commandR = 0, sum = 0, largest = 0;
+    int cycles = 0;
+    for(int ms = 0; ms < TRACKER_BENCH_TIME*1000; ms++){
+      double t = ms/1000.0;
+      int i = std::min((int)(t/TRACKER_BENCH_DT), LENGTH - 1);
+      if(ms%BASE_CONTROL_DT == 0){
+        if(tracker == 0){
+          PackedPose reference = decodePose(trajectory, i);
+          computeRamsete(pose, reference.x, reference.y, reference.angle, (velL[i] + velR[i])/2, (velL[i] - velR[i])/baseWidth,
+                         commandL, commandR);
+        }
+        else computeMpc(pose, trajectory, t, commandL, commandR);
+        double error = hypot(poses[i].x - pose.x, poses[i].y - pose.y);
+        sum += error*error;
+        largest = fmax(largest, error);
+        cycles++;
+      }
+      sideL += (commandL - sideL)*0.001/TRACKER_BENCH_LAG;
+      sideR += (commandR - sideR)*0.001/TRACKER_BENCH_LAG;
+      double vel = (sideL + sideR)/2, turn = (sideL - sideR)/baseWidth;
+      pose.x += vel*sin(pose.angle)*0.001;
+      pose.y += vel*cos(pose.angle)*0.001;
+      pose.angle += turn*0.001;
+    }
+    /** cost per cycle, over poses off the reference */
+    resetMpc();
+    uint64_t start = micros();
+    for(int n = 0; n < calls; n++){
+      int i = n%LENGTH;
+      PoseSnapshot offset = {poses[i].x + sin(n*0.7), poses[i].y + cos(n*0.3), poses[i].angle + 0.05*sin(n*1.1), 0, 0, 0};
+      double outL, outR;
+      if(tracker == 0){
+        computeRamsete(offset, poses[i].x, poses[i].y, poses[i].angle, (velL[i] + velR[i])/2, (velL[i] - velR[i])/baseWidth, outL, outR);
+      }
+      else computeMpc(offset, trajectory, i*TRACKER_BENCH_DT, outL, outR);
+      benchmarkSink = benchmarkSink + outL;
+    }
+    printBenchmark(names[tracker], start, calls);
+    printf("%-16s rms %.3f in, max %.3f in\n", "", sqrt(sum/cycles), largest);
+  }
+  resetMpc();
+}
+/**
+ * Run the suite and print the cost per call of every kernel (blocking; takes about a second
+ * per million iterations on the V5). Call it at initialization, not during a match.
+ * @param iterations
+ * number of calls per kernel
+ */
+void runBenchmarks(int iterations){
+  double angles[BENCHMARK_INPUTS], values[BENCHMARK_INPUTS];
+  SensorFrame frames[BENCHMARK_INPUTS];
+  /** inputs: angles within a few turns, and an arc of the base (encoder degrees) */
+  for(int i = 0; i < BENCHMARK_INPUTS; i++){
+    angles[i] = (i - BENCHMARK_INPUTS/2)*0.4;
+    values[i] = 150*sin(i*0.7);
+    frames[i] = {};
+    frames[i].encdL = i*40;
+    frames[i].encdR = i*35;
+    frames[i].timestamp = (i + 1)*ODOM_DT*1000;
+  }
+  uint64_t start = micros();
+  for(int i = 0; i < iterations; i++) benchmarkSink = benchmarkSink + boundRad(angles[i%BENCHMARK_INPUTS]);
+  printBenchmark("boundRad", start, iterations);
+  start = micros();
+  for(int i = 0; i < iterations; i++) benchmarkSink = benchmarkSink + abscap(values[i%BENCHMARK_INPUTS], 100);
+  printBenchmark("abscap", start, iterations);
+  start = micros();
+  for(int i = 0; i < iterations; i++) benchmarkSink = benchmarkSink + sin(angles[i%BENCHMARK_INPUTS]);
+  printBenchmark("sin", start, iterations);
+  start = micros();
+  for(int i = 0; i < iterations; i++) benchmarkSink = benchmarkSink + fastSin(angles[i%BENCHMARK_INPUTS]);
+  printBenchmark("fastSin", start, iterations);
+  start = micros();
+  for(int i = 0; i < iterations; i++) benchmarkSink = benchmarkSink + atan2(values[i%BENCHMARK_INPUTS], angles[i%BENCHMARK_INPUTS]);
+  printBenchmark("atan2", start, iterations);
+  start = micros();
+  for(int i = 0; i < iterations; i++) benchmarkSink = benchmarkSink + fastAtan2(values[i%BENCHMARK_INPUTS], angles[i%BENCHMARK_INPUTS]);
+  printBenchmark("fastAtan2", start, iterations);
+  /** odometry step, restarting the arc every BENCHMARK_INPUTS steps */
+  OdometryState state = {};
+  start = micros();
+  for(int i = 0; i < iterations; i++){
+    if(i%BENCHMARK_INPUTS == 0) state = {};
+    benchmarkSink = benchmarkSink + stepOdometry(state, frames[i%BENCHMARK_INPUTS], NULL).x;
+  }
+  printBenchmark("stepOdometry", start, iterations);
+  benchmarkMatrix(iterations);
+  benchmarkLookahead(iterations);
+  benchmarkSpline(iterations);
+  /** pose batches: float is half the data of double, and the A9's NEON unit only vectorizes float */
+  benchmarkPoseBatch<double>("pose batch dbl", iterations);
+  benchmarkPoseBatch<float>("pose batch flt", iterations);
+  /** a plan costs about as much as ten thousand of the other kernels */
+  benchmarkPlanner(iterations/10000 + 1);
+  benchmarkLattice(iterations/10000 + 1);
+  benchmarkTrackers(iterations/10 + 1);
+  /** PD + ramp step, double and fixed point */
+  benchmarkBasePD(iterations);
+}
+/**
+ * Error of an approximation against its reference over a sweep
+ * max: largest absolute error (NaN if the approximation gave one); sumSquares, count: for the RMS error
+ */
+struct KernelAccuracy{
+  double max, sumSquares;
+  int count;
+};
+void addError(KernelAccuracy &accuracy, double error){
+  error = fabs(error);
+  if(!(error <= accuracy.max)) accuracy.max = error;
+  accuracy.sumSquares += error*error;
+  accuracy.count++;
+}
+/**
+ * @return
+ * sample i of an even sweep of samples from lo to hi (both included)
+ */
+double sweepInput(int i, int samples, double lo, double hi){
+  return lo + (hi - lo)*(i%samples)/(samples - 1);
+}
+/**
+ * Time a kernel on the first ACCURACY_TIMED_INPUTS samples of its sweep.
+ * @param kernel
+ * takes a sample number, returns a value (summed into benchmarkSink)
+ *
+ * @param calls
+ * number of calls
+ *
+ * @return
+ * ns per call
+ */
+template<typename Kernel> double timeKernel(Kernel kernel, int calls){
+  uint64_t start = micros();
+  for(int i = 0; i < calls; i++) benchmarkSink = benchmarkSink + kernel(i & (ACCURACY_TIMED_INPUTS - 1));
+  return (micros() - start)*1000.0/calls;
+}
+/**
+ * Print the accuracy and the cost of a kernel next to its reference.
+ * @param limit
+ * largest error allowed (refer to benchmark.hpp)
+ *
+ * @return
+ * whether the largest error is within the limit
+ */
+bool printAccuracy(const char *name, const KernelAccuracy &accuracy, double limit, double ns, const char *reference, double referenceNs){
+  bool within = accuracy.max <= limit;
+  printf("%-14s max %8.2e rms %8.2e limit %8.2e %7.1f ns (%s %7.1f ns) %s\n", name, accuracy.max,
+    sqrt(accuracy.sumSquares/accuracy.count), limit, ns, reference, referenceNs, within? "ok" : "OVER");
+  return within;
+}
+/**
+ * Sweep every approximate kernel over its input domain against its reference, and print their errors and
+ * costs (refer to benchmark.hpp). Blocking (about a second per million samples on the V5); call it at
+ * initialization, not during a match.
+ * @param samples
+ * samples of each sweep (at least ACCURACY_TIMED_INPUTS)
+ *
+ * @return
+ * whether every kernel is within its limit
+ */
+bool runAccuracySuite(int samples){
+  if(samples < ACCURACY_TIMED_INPUTS) samples = ACCURACY_TIMED_INPUTS;
+  /** the heading and position steps of the tracking wheels, and the step of the motor command */
+  const double headingStep = inPerDeg/baseWidth, positionStep = inPerDeg;
+  const double powerStep = MOTOR_VOLTAGE_COMPENSATION? 127.0/12000 : 1;
+  bool within = true;
+  /** trigonometry over four turns either way */
+  static double angles[ACCURACY_TIMED_INPUTS], ys[ACCURACY_TIMED_INPUTS], xs[ACCURACY_TIMED_INPUTS];
+  for(int i = 0; i < ACCURACY_TIMED_INPUTS; i++) angles[i] = sweepInput(i*7919, ACCURACY_TIMED_INPUTS, -4*twoPI, 4*twoPI);
+  KernelAccuracy sinError = {}, cosError = {};
+  for(int i = 0; i < samples; i++){
+    double x = sweepInput(i, samples, -4*twoPI, 4*twoPI);
+    addError(sinError, fastSin(x) - sin(x));
+    addError(cosError, fastCos(x) - cos(x));
+  }
+  double sinNs = timeKernel([](int i){ return sin(angles[i]); }, samples);
+  within = printAccuracy("fastSin", sinError, headingStep, timeKernel([](int i){ return fastSin(angles[i]); }, samples), "sin", sinNs) && within;
+  double cosNs = timeKernel([](int i){ return cos(angles[i]); }, samples);
+  within = printAccuracy("fastCos", cosError, headingStep, timeKernel([](int i){ return fastCos(angles[i]); }, samples), "cos", cosNs) && within;
+  /** atan2 around the circle, from a thousandth to a thousand in radius; the error is an angle (wrapped) */
+  for(int i = 0; i < ACCURACY_TIMED_INPUTS; i++){
+    double angle = sweepInput(i*7919, ACCURACY_TIMED_INPUTS, -PI, PI), radius = pow(10, sweepInput(i, ACCURACY_TIMED_INPUTS, -3, 3));
+    ys[i] = radius*sin(angle);
+    xs[i] = radius*cos(angle);
+  }
+  KernelAccuracy atanError = {};
+  for(int i = 0; i < samples; i++){
+    double angle = sweepInput(i, samples, -PI, PI), radius = pow(10, sweepInput(i*7919, samples, -3, 3));
+    double y = radius*sin(angle), x = radius*cos(angle);
+    addError(atanError, remainder(fastAtan2(y, x) - atan2(y, x), twoPI));
+  }
+  double atanNs = timeKernel([](int i){ return atan2(ys[i], xs[i]); }, samples);
+  within = printAccuracy("fastAtan2", atanError, headingStep, timeKernel([](int i){ return fastAtan2(ys[i], xs[i]); }, samples), "atan2", atanNs) && within;
+  /**
+   * SE(2) tick: a tick of up to an inch forward or back, a fifth of that sideways and 0.6 rad of turn (across
+   * ODOM_TAYLOR_ANGLE) from any bearing, against the exact arc in libm; the error is the distance between the ends
+   */
+  static double forwards[ACCURACY_TIMED_INPUTS], laterals[ACCURACY_TIMED_INPUTS], turns[ACCURACY_TIMED_INPUTS];
+  for(int i = 0; i < ACCURACY_TIMED_INPUTS; i++){
+    forwards[i] = sweepInput(i*31, ACCURACY_TIMED_INPUTS, -1, 1);
+    laterals[i] = sweepInput(i*97, ACCURACY_TIMED_INPUTS, -0.2, 0.2);
+    turns[i] = sweepInput(i*7919, ACCURACY_TIMED_INPUTS, -0.6, 0.6);
+  }
+  static OdometryState state;
+  auto exactTick = [](double bearing, double forward, double lateral, double turn, double &x, double &y){
+    double chord = turn == 0? 1 : 2*sin(turn/2)/turn, mean = bearing + turn/2;
+    x = chord*(forward*sin(mean) + lateral*cos(mean));
+    y = chord*(forward*cos(mean) - lateral*sin(mean));
+  };
+  KernelAccuracy tickError = {};
+  for(int i = 0; i < samples; i++){
+    double bearing = sweepInput(i, samples, -4*twoPI, 4*twoPI), forward = sweepInput(i*31, samples, -1, 1);
+    double lateral = sweepInput(i*97, samples, -0.2, 0.2), turn = sweepInput(i*7919, samples, -0.6, 0.6), x, y;
+    state.x = state.y = 0;
+    state.prevAngle = bearing;
+    integrateTwist(state, forward, lateral, turn);
+    exactTick(bearing, forward, lateral, turn, x, y);
+    addError(tickError, hypot(state.x - x, state.y - y));
+  }
+  double exactNs = timeKernel([&exactTick](int i){
+    double x, y;
+    exactTick(angles[i], forwards[i], laterals[i], turns[i], x, y);
+    return x + y;
+  }, samples);
+  double tickNs = timeKernel([](int i){
+    state.x = state.y = 0;
+    state.prevAngle = angles[i];
+    integrateTwist(state, forwards[i], laterals[i], turns[i]);
+    return state.x + state.y;
+  }, samples);
+  within = printAccuracy("integrateTwist", tickError, positionStep, tickNs, "exact", exactNs) && within;
+  /** fixed-point PD + ramp + cap: a cycle costs as much as a few hundred of the other kernels */
+  int cycles = samples/100 + 1;
+  double rms, maxDiff = compareBasePDFixed(cycles, rms);
+  KernelAccuracy pdError = {maxDiff, rms*rms*cycles, cycles};
+  BaseControlFrame frames[ACCURACY_TIMED_INPUTS], prevFrame = {};
+  for(int i = 0; i < ACCURACY_TIMED_INPUTS; i++) frames[i] = benchmarkFrame(i*37);
+  double doubleNs = timeKernel([&frames, &prevFrame](int i){
+    BaseControlFrame frame = frames[i];
+    computeBasePD(frame, prevFrame);
+    rampBasePower(frame, prevFrame);
+    prevFrame = frame;
+    return frame.powerL;
+  }, cycles);
+  prevFrame = {};
+  double fixedNs = timeKernel([&frames, &prevFrame](int i){
+    BaseControlFrame frame = frames[i];
+    computeBasePDFixed(frame, prevFrame);
+    rampBasePowerFixed(frame, prevFrame);
+    prevFrame = frame;
+    return frame.powerL;
+  }, cycles);
+  within = printAccuracy("fixed PD", pdError, powerStep, fixedNs, "double", doubleNs) && within;
+  printf("%s\n", within? "every kernel is within the quantization of what it feeds" : "a kernel is over its limit (OVER)");
+  return within;
+}
@@ -0,0 +1,151 @@
+/**
+ * Staged start:
+ * - Background task per slow stage (sensor calibration, trajectory loading, brain screen objects)
+ * - Readiness of every stage, with the time it became ready
+ * - Readiness gates: a consumer waits for a stage only while it is not ready yet
+ * - Boot timeline: the instants of the start, reported to the telemetry
+ */
+#include "main.h"
+/**
+ * Stage state
+ * bootReady: bit per BootStage, set once the stage is ready (never cleared)
+ * bootTimes: millis() when each stage became ready
+ * bootWork: work of each background stage (read by its task)
+ */
+std::atomic<uint32_t> bootReady(0);
+std::atomic<uint32_t> bootTimes[BOOT_STAGES];
+InlineFunction<void()> bootWork[BOOT_STAGES];
+/**
+ * Background task of a stage: run its work, then publish the stage. The task ends there.
+ * @param param
+ * the BootStage
+ */
+void bootStageTask(void *param){
+  BootStage stage = (BootStage)(intptr_t)param;
+  bootWork[stage]();
+  markBootReady(stage);
+}
+/**
+ * Run the work of a stage in its own task (PRIORITY_BOOT, below the sensing and control tasks),
+ * so initialize() returns right away. Call once per stage.
+ * @param stage
+ * the stage
+ *
+ * @param work
+ * its work; the stage is ready when it returns
+ */
+void startBootStage(BootStage stage, InlineFunction<void()> work){
+  bootWork[stage] = work;
+  pros::Task task(bootStageTask, (void*)(intptr_t)stage, PRIORITY_BOOT, TASK_STACK_DEPTH_DEFAULT, "bootStage");
+}
+/**
+ * Publish a stage as ready (for the stages done inline, e.g. BOOT_SENSING at the end of initialize()).
+ * @param stage
+ * the stage
+ */
+void markBootReady(BootStage stage){
+  bootTimes[stage].store(millis(), std::memory_order_relaxed);
+  bootReady.fetch_or(1u << stage, std::memory_order_release);
+}
+/**
+ * @param stage
+ * the stage
+ *
+ * @return
+ * whether it is ready; its data can then be read without waiting
+ */
+bool isBootReady(BootStage stage){
+  return (bootReady.load(std::memory_order_acquire) & (1u << stage)) != 0;
+}
+/**
+ * Wait until a stage is ready. Returns at once if it already is, so the gate costs nothing
+ * once the robot has started.
+ * @param stage
+ * the stage
+ *
+ * @param timeout
+ * longest wait in ms (BOOT_WAIT_FOREVER: no limit)
+ *
+ * @return
+ * whether the stage is ready (false: timed out)
+ */
+bool waitBootReady(BootStage stage, uint32_t timeout){
+  Timer timer;
+  while(!isBootReady(stage)){
+    if(timeout != BOOT_WAIT_FOREVER && timer.passed(timeout)) return false;
+    delay(BOOT_POLL_DT);
+  }
+  return true;
+}
+/**
+ * @param stage
+ * the stage
+ *
+ * @return
+ * millis() when it became ready (0: not ready yet)
+ */
+uint32_t getBootTime(BootStage stage){
+  return isBootReady(stage)? bootTimes[stage].load(std::memory_order_relaxed) : 0;
+}
+/**
+ * Boot timeline (refer to BootMark)
+ * bootMarked: bit per BootMark, set once the instant is recorded
+ * bootMarks: micros() of each instant
+ * bootReported: marks already pushed to the telemetry (only touched by the telemetry drain)
+ */
+std::atomic<uint32_t> bootMarked(0);
+std::atomic<uint64_t> bootMarks[BOOT_MARKS];
+uint32_t bootReported = 0;
+const char *bootMarkNames[BOOT_MARKS] = {"devices", "tare", "tasks", "initialized", "first odometry", "trajectories", "first control"};
+/**
+ * Record an instant of the start. Only the first call counts, so it can sit in a loop (one relaxed load
+ * afterwards). Each mark has a single caller.
+ * @param mark
+ * the instant
+ */
+void markBoot(BootMark mark){
+  if(bootMarked.load(std::memory_order_relaxed) & (1u << mark)) return;
+  bootMarks[mark].store(micros(), std::memory_order_relaxed);
+  bootMarked.fetch_or(1u << mark, std::memory_order_release);
+}
+/**
+ * @param mark
+ * the instant
+ *
+ * @param time
+ * set to its micros() if it was recorded
+ *
+ * @return
+ * whether it was recorded
+ */
+bool getBootMark(BootMark mark, uint64_t &time){
+  if((bootMarked.load(std::memory_order_acquire) & (1u << mark)) == 0) return false;
+  time = bootMarks[mark].load(std::memory_order_relaxed);
+  return true;
+}
+/**
+ * @return
+ * the name of an instant of the start
+ */
+const char *getBootMarkName(BootMark mark){
+  return mark < BOOT_MARKS? bootMarkNames[mark] : "boot";
+}
+/**
+ * Push a TELEMETRY_BOOT record for every instant recorded since the last call (only one task may call
+ * it; the telemetry drain does, every iteration).
+ */
+void reportBootMarks(){
+  uint32_t marked = bootMarked.load(std::memory_order_acquire);
+  if(marked == bootReported) return;
+  for(int i = 0; i < BOOT_MARKS; i++){
+    if((marked & ~bootReported & (1u << i)) == 0) continue;
+    /** time since the latest instant before it (the program start for the first one) */
+    uint64_t time = bootMarks[i].load(std::memory_order_relaxed), previous = 0;
+    for(int j = 0; j < BOOT_MARKS; j++){
+      uint64_t other = bootMarks[j].load(std::memory_order_relaxed);
+      if((marked & (1u << j)) && other <= time && other > previous && j != i) previous = other;
+    }
+    pushTelemetry(TELEMETRY_BOOT, i, time/1000.0, (time - previous)/1000.0);
+  }
+  bootReported = marked;
+}
@@ -0,0 +1,187 @@
+/**
+ * Chassis backend functions:
+ * - Backend selection (the base controller is paused while okapi drives)
+ * - Drive, turn and wait on the selected backend
+ * - A/B benchmark: settle times, end errors and control loop cost of one test sequence, on each backend
+ */
+#include "main.h"
+#if CHASSIS_OKAPI_LINKED
+/** pathfinder's mathutil.h (included by okapi) defines PI again */
+#undef PI
+#include "okapi/api.hpp"
+/**
+ * The okapi chassis, built on first use: the base motors (right side reversed) and the tracking wheels
+ * (the right one mirrored), scaled by the odometry geometry (robotConfig.hpp). okapi constructs its
+ * own device objects on the ports of devices.cpp.
+ */
+std::shared_ptr<okapi::ChassisController> okapiChassis;
+/**
+ * @return
+ * the okapi chassis
+ */
+okapi::ChassisController &getOkapiChassis(){
+  if(okapiChassis == nullptr){
+    okapiChassis = okapi::ChassisControllerBuilder()
+      .withMotors({(int8_t)FLPort, (int8_t)BLPort}, {(int8_t)-FRPort, (int8_t)-BRPort})
+      .withSensors(okapi::ADIEncoder(encdL_port, encdL_port + 1, false), okapi::ADIEncoder(encdR_port, encdR_port + 1, true))
+      .withGains(CHASSIS_OKAPI_DISTANCE_GAINS, CHASSIS_OKAPI_TURN_GAINS, CHASSIS_OKAPI_ANGLE_GAINS)
+      .withDimensions(okapi::AbstractMotor::gearset::green,
+        okapi::ChassisScales({2*toDeg*inPerDeg*okapi::inch, baseWidth*okapi::inch}, okapi::quadEncoderTPR))
+      .build();
+  }
+  return *okapiChassis;
+}
+#endif
+/** the selected backend */
+ChassisBackend chassisBackend = CHASSIS_8059;
+/**
+ * Select the backend of the chassis calls. okapi takes the base from the base controller, which is paused;
+ * back on the 8059 backend, the base controller holds where okapi left the base.
+ * @param backend
+ * the backend
+ *
+ * @return
+ * false if it is not available (CHASSIS_OKAPI without okapilib.a), the backend is then unchanged
+ */
+bool setChassisBackend(ChassisBackend backend){
+  if(backend == CHASSIS_OKAPI && !CHASSIS_OKAPI_LINKED) return false;
+  if(backend == chassisBackend) return true;
+#if CHASSIS_OKAPI_LINKED
+  if(backend == CHASSIS_OKAPI){
+    pauseBase(true);
+    getOkapiChassis();
+  }
+  else{
+    getOkapiChassis().stop();
+    drivetrain.stop();
+    stopBase();
+    pauseBase(false);
+  }
+#endif
+  chassisBackend = backend;
+  return true;
+}
+/**
+ * @return
+ * the selected backend
+ */
+ChassisBackend getChassisBackend(){
+  return chassisBackend;
+}
+/**
+ * @param backend
+ * a backend
+ *
+ * @return
+ * its name
+ */
+const char *getChassisBackendName(ChassisBackend backend){
+  return backend == CHASSIS_OKAPI? "okapi" : "8059";
+}
+/**
+ * Start driving a distance straight (refer to baseMove).
+ * @param dis
+ * distance in inches (negative: backward)
+ */
+void chassisMove(double dis){
+#if CHASSIS_OKAPI_LINKED
+  if(chassisBackend == CHASSIS_OKAPI){
+    getOkapiChassis().moveDistanceAsync(dis*okapi::inch);
+    return;
+  }
+#endif
+  baseMove(dis);
+}
+/**
+ * Start turning in place by an angle (refer to baseTurnRelative).
+ * @param angleDeg
+ * angle in degrees (positive: clockwise)
+ */
+void chassisTurn(double angleDeg){
+#if CHASSIS_OKAPI_LINKED
+  if(chassisBackend == CHASSIS_OKAPI){
+    getOkapiChassis().turnAngleAsync(angleDeg*okapi::degree);
+    return;
+  }
+#endif
+  baseTurnRelative(angleDeg, GAIN_SCHEDULED, GAIN_SCHEDULED);
+}
+/**
+ * Wait for the movement to settle.
+ * @param cutoff
+ * longest wait in ms on the 8059 backend (okapi waits for its own settle, without a cutoff)
+ *
+ * @return
+ * whether it settled
+ */
+bool chassisWait(double cutoff){
+#if CHASSIS_OKAPI_LINKED
+  if(chassisBackend == CHASSIS_OKAPI){
+    getOkapiChassis().waitUntilSettled();
+    return true;
+  }
+#endif
+  waitBase(cutoff);
+  return isBaseSettled();
+}
+/**
+ * Test sequence of the benchmark: {distance in inches, turn in degrees} per movement, back to the start
+ */
+const double chassisBenchMoves[][2] = {{24, 0}, {0, 90}, {24, 0}, {0, 90}, {0, 180}, {24, 0}, {0, -90}, {24, 0}, {0, 90}};
+/**
+ * Run the test sequence on a backend from the current pose, then select the 8059 backend again.
+ * The pose is tracked by the odometry whatever the backend.
+ * @param backend
+ * the backend
+ *
+ * @param result
+ * set to the measurements
+ *
+ * @return
+ * false if the backend is not available
+ */
+bool runChassisBenchmark(ChassisBackend backend, ChassisBenchResult &result){
+  result = {};
+  if(!setChassisBackend(backend)) return false;
+  PoseSnapshot pose = getPose();
+  double x = pose.x, y = pose.y, angle = pose.angle;
+  for(const double *move : chassisBenchMoves){
+    uint32_t start = millis();
+    if(move[0] != 0) chassisMove(move[0]);
+    else chassisTurn(move[1]);
+    if(chassisWait(CHASSIS_BENCH_CUTOFF)) result.settled++;
+    uint32_t time = millis() - start;
+    result.moves++;
+    result.totalTime += time;
+    result.maxTime = std::max(result.maxTime, time);
+    angle += move[1]*toRad;
+    x += move[0]*sin(angle);
+    y += move[0]*cos(angle);
+    pose = getPose();
+    result.maxError = fmax(result.maxError, hypot(pose.x - x, pose.y - y));
+  }
+  setChassisBackend(CHASSIS_8059);
+  if(backend == CHASSIS_8059){
+    TaskTimingSummary timing = getTaskTiming(TIMING_CONTROL);
+    result.p99Exec = timing.p99Exec;
+    result.maxExec = timing.maxExec;
+  }
+  return true;
+}
+/**
+ * Run the benchmark on each backend linked in the build, one after the other from the current pose
+ * (the sequence ends where it starts), and print the results (e.g. from a routine, or `./bin/sim chassis`).
+ */
+void compareChassisBackends(){
+  for(ChassisBackend backend : {CHASSIS_8059, CHASSIS_OKAPI}){
+    ChassisBenchResult result;
+    if(!runChassisBenchmark(backend, result)){
+      printf("%-6s not linked in this build\n", getChassisBackendName(backend));
+      continue;
+    }
+    printf("%-6s %u/%u settled, %5.2fs total, %4ums max, end error %.2fin", getChassisBackendName(backend),
+      result.settled, result.moves, result.totalTime/1000.0, result.maxTime, result.maxError);
+    if(result.maxExec > 0) printf(", control loop p99 %uus max %uus", result.p99Exec, result.maxExec);
+    printf("\n");
+  }
+}
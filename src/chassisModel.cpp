@@ -0,0 +1,57 @@
+/**
+ * Chassis kinematics functions:
+ * - Side and strafe commands to the four base motors (tank drive, X-drive)
+ * - Robot velocities to the side and strafe velocities of a holonomic base
+ */
+#include "main.h"
+/**
+ * Mix the side and strafe commands into the commands of the four base motors (as okapi's XDriveModel:
+ * front left = left + strafe, back left = left - strafe, front right = right - strafe, back right = right + strafe).
+ * A tank drive ignores the strafe. Wheels beyond the limit are scaled down together, so the base keeps
+ * the direction of its movement instead of each wheel clipping on its own.
+ * @param left, right, strafe
+ * commands of the sides and of the strafe (strafe positive to the right)
+ *
+ * @param limit
+ * largest command of a motor
+ *
+ * @return
+ * the commands of the motors
+ */
+WheelCommands mixChassis(double left, double right, double strafe, double limit){
+  if(!HOLONOMIC_BASE) return {left, left, right, right};
+  WheelCommands wheels = {left + strafe, left - strafe, right - strafe, right + strafe};
+  double fastest = fmax(fmax(fabs(wheels.frontLeft), fabs(wheels.backLeft)), fmax(fabs(wheels.frontRight), fabs(wheels.backRight)));
+  if(fastest > limit){
+    double scale = limit/fastest;
+    wheels = {wheels.frontLeft*scale, wheels.backLeft*scale, wheels.frontRight*scale, wheels.backRight*scale};
+  }
+  return wheels;
+}
+/**
+ * Side and strafe velocities of a holonomic base that drives at a velocity in the robot's frame while it
+ * turns, within the velocity limit of its fastest wheel (refer to mixChassis).
+ * @param forward, lateral
+ * velocity along and across the heading (in/s, lateral positive to the right)
+ *
+ * @param angular
+ * angular velocity (rad/s, clockwise)
+ *
+ * @param maxVel
+ * velocity limit of a wheel (in/s)
+ *
+ * @param velL, velR, velS
+ * set to the velocities of the sides and of the strafe (in/s)
+ */
+void splitHolonomicVelocity(double forward, double lateral, double angular, double maxVel, double &velL, double &velR, double &velS){
+  /** refer to Odometry Documentation.docx: side velocities of a turn */
+  velL = forward + angular*baseWidth/2;
+  velR = forward - angular*baseWidth/2;
+  velS = lateral;
+  double fastest = fmax(fabs(velL), fabs(velR)) + fabs(velS);
+  if(fastest > maxVel){
+    velL *= maxVel/fastest;
+    velR *= maxVel/fastest;
+    velS *= maxVel/fastest;
+  }
+}
@@ -0,0 +1,154 @@
+/**
+ * Configuration file functions:
+ * - Reading of a whole file into the shared buffer
+ * - Single-pass splitting into sections, keys and values, in place
+ * - Number conversion of the values
+ */
+#include "main.h"
+/** the file buffer (one '\0' past the largest file) and whether a ConfigFile holds it */
+char configBuffer[CONFIG_FILE_SIZE + 1];
+std::atomic<bool> configBufferTaken(false);
+/**
+ * @return
+ * whether the character separates the words of a line
+ */
+bool isConfigSeparator(char c){
+  return c == ' ' || c == '\t' || c == '\r' || c == ',' || c == '=';
+}
+/**
+ * Convert the values of the entry to numbers.
+ * @param numbers
+ * written with the values
+ *
+ * @param count
+ * number of values the entry must have
+ *
+ * @return
+ * false if the entry has another number of values or one is not a number
+ */
+bool ConfigEntry::getNumbers(double *numbers, int count) const{
+  if(valueCount != count) return false;
+  for(int i = 0; i < count; i++){
+    char *end;
+    numbers[i] = strtod(values[i].data(), &end);
+    if(end != values[i].data() + values[i].size()) return false;
+  }
+  return true;
+}
+/**
+ * Default initialization of a ConfigFile: no file open.
+ */
+ConfigFile::ConfigFile() : cursor(NULL), end(NULL), line(0), errorLine(0), holding(false){}
+/**
+ * Release the buffer if a file is open.
+ */
+ConfigFile::~ConfigFile(){
+  close();
+}
+/**
+ * Read a file into the buffer (waits while another ConfigFile holds it).
+ * @param path
+ * the file
+ *
+ * @return
+ * false if the file cannot be read or is larger than CONFIG_FILE_SIZE
+ */
+bool ConfigFile::open(const char *path){
+  close();
+  section = std::string_view();
+  line = errorLine = 0;
+  while(configBufferTaken.exchange(true)) delay(1);
+  holding = true;
+  FILE *file = fopen(path, "r");
+  if(file == NULL){
+    close();
+    return false;
+  }
+  size_t size = fread(configBuffer, 1, CONFIG_FILE_SIZE + 1, file);
+  fclose(file);
+  if(size > CONFIG_FILE_SIZE){
+    errorLine = -1;
+    close();
+    return false;
+  }
+  configBuffer[size] = '\0';
+  cursor = configBuffer;
+  end = configBuffer + size;
+  return true;
+}
+/**
+ * Read the next entry (blank and comment lines are skipped).
+ * @param entry
+ * written with the entry
+ *
+ * @return
+ * false at the end of the file, or at a malformed line (an unclosed section or more than CONFIG_MAX_VALUES
+ * values; refer to failed)
+ */
+bool ConfigFile::next(ConfigEntry &entry){
+  while(cursor < end){
+    line++;
+    char *p = cursor, *lineEnd = (char *)memchr(cursor, '\n', end - cursor);
+    if(lineEnd == NULL) lineEnd = end;
+    cursor = lineEnd < end? lineEnd + 1 : end;
+    *lineEnd = '\0';
+    for(char *c = p; c < lineEnd; c++) if(*c == '#' || *c == ';') lineEnd = c;
+    while(p < lineEnd && isConfigSeparator(*p)) p++;
+    if(p < lineEnd && *p == '['){
+      char *close = (char *)memchr(p, ']', lineEnd - p);
+      if(close == NULL){
+        errorLine = line;
+        break;
+      }
+      *close = '\0';
+      section = std::string_view(p + 1, close - p - 1);
+      continue;
+    }
+    /** each word is cut with a '\0' at its first separator */
+    int words = 0;
+    entry.valueCount = 0;
+    while(p < lineEnd){
+      char *word = p;
+      while(p < lineEnd && !isConfigSeparator(*p)) p++;
+      std::string_view view(word, p - word);
+      *p = '\0';
+      if(words++ == 0) entry.key = view;
+      else if(entry.valueCount == CONFIG_MAX_VALUES) break;
+      else entry.values[entry.valueCount++] = view;
+      if(p < lineEnd) p++;
+      while(p < lineEnd && isConfigSeparator(*p)) p++;
+    }
+    if(words > CONFIG_MAX_VALUES + 1){
+      errorLine = line;
+      break;
+    }
+    if(words == 0) continue;
+    entry.section = section;
+    entry.line = line;
+    return true;
+  }
+  cursor = end;
+  return false;
+}
+/**
+ * @return
+ * whether reading stopped at a malformed line or the file was too large
+ */
+bool ConfigFile::failed() const{
+  return errorLine != 0;
+}
+/**
+ * @return
+ * line reading stopped at, -1 if the file was too large, 0 if there was no error
+ */
+int ConfigFile::getErrorLine() const{
+  return errorLine;
+}
+/**
+ * Release the buffer (the entries read become invalid).
+ */
+void ConfigFile::close(){
+  if(holding) configBufferTaken = false;
+  holding = false;
+  cursor = end = NULL;
+}
@@ -0,0 +1,74 @@
+/**
+ * Controller display:
+ * - Desired text of each controller line (set by any task, never blocks)
+ * - Sending of one changed line per controller update slot (by the controllerService task)
+ */
+#include "main.h"
+/**
+ * desiredLines: text the tasks want on the screen (one writer task per line)
+ * shownLines: text last sent to the controller (only used by the controllerService task)
+ * shownValid: false when the controller content is unknown (after a clear or a failed send)
+ */
+SeqLock<DisplayLine> desiredLines[DISPLAY_LINES];
+DisplayLine shownLines[DISPLAY_LINES];
+bool shownValid[DISPLAY_LINES] = {};
+std::atomic<bool> clearPending(false);
+/**
+ * Set the text of a controller line. Only copies the text; the display task sends it.
+ * Each line should be set by one task only.
+ * @param line
+ * line number (0 - 2)
+ *
+ * @param fmt
+ * printf format string, followed by its arguments
+ * (cut to, or padded with spaces to, DISPLAY_WIDTH characters)
+ */
+void setDisplayLine(int line, const char *fmt, ...){
+  if(line < 0 || line >= DISPLAY_LINES) return;
+  DisplayLine text;
+  va_list args;
+  va_start(args, fmt);
+  int length = vsnprintf(text.text, sizeof(text.text), fmt, args);
+  va_end(args);
+  if(length < 0) length = 0;
+  /** pad so that the new text overwrites all of the old one */
+  for(int i = length; i < DISPLAY_WIDTH; i++) text.text[i] = ' ';
+  text.text[DISPLAY_WIDTH] = '\0';
+  desiredLines[line].write(text);
+}
+/**
+ * Clear the controller screen (replaces master.clear(), which blocks): every line is set blank.
+ */
+void clearDisplay(){
+  clearPending = true;
+}
+/** next line to check for changes (only used by the controllerService task) */
+int nextLine = 0;
+/**
+ * Send one controller screen update: a pending clear, else the next line (in turn) whose desired
+ * text differs from what is shown. Unchanged lines cost nothing.
+ * Called by the controllerService task every DISPLAY_DT, after its input sample.
+ */
+void sendDisplayUpdate(){
+  /** a clear blanks every line, sent like any change (master.clear() would hold up the input samples) */
+  if(clearPending.exchange(false)){
+    DisplayLine blank;
+    memset(blank.text, ' ', DISPLAY_WIDTH);
+    blank.text[DISPLAY_WIDTH] = '\0';
+    for(int i = 0; i < DISPLAY_LINES; i++){
+      desiredLines[i].write(blank);
+      shownValid[i] = false;
+    }
+  }
+  for(int i = 0; i < DISPLAY_LINES; i++){
+    int line = (nextLine + i)%DISPLAY_LINES;
+    if(desiredLines[line].version() == 0) continue;
+    DisplayLine text = desiredLines[line].read();
+    if(shownValid[line] && strcmp(text.text, shownLines[line].text) == 0) continue;
+    /** one line per slot; resend it next slot if the controller rejected it */
+    shownValid[line] = master.set_text(line, 0, text.text) == 1;
+    shownLines[line] = text;
+    nextLine = line + 1;
+    break;
+  }
+}
@@ -0,0 +1,131 @@
+/**
+ * Controller service:
+ * - Fixed rate sampling of the master & partner controllers into timestamped snapshots
+ * - Button edges published on the input event queues
+ * - The only task talking to the controllers: it also sends the display lines (master only)
+ * - Arbitration of the mechanism buttons between the controllers
+ */
+#include "main.h"
+/** the last sample of each controller (written only by the service task) */
+SeqLock<ControllerState> controllerStates[CONTROLLERS];
+/**
+ * @param axis
+ * a stick axis
+ *
+ * @return
+ * its value in the sample (-127 to 127)
+ */
+int32_t ControllerState::axis(pros::controller_analog_e_t axis) const{
+  return axes[axis];
+}
+/**
+ * @param button
+ * a button
+ *
+ * @return
+ * whether it was held at the sample
+ */
+bool ControllerState::held(pros::controller_digital_e_t button) const{
+  return buttons & buttonBit(button);
+}
+/**
+ * Whether a button was pressed between two samples (replaces Controller::get_digital_new_press,
+ * without its hidden state, so any number of readers can each keep their own previous sample).
+ * @param prev
+ * the reader's previous sample
+ *
+ * @param button
+ * a button
+ *
+ * @return
+ * true if the button was pressed after prev was taken
+ */
+bool ControllerState::pressedSince(const ControllerState &prev, pros::controller_digital_e_t button) const{
+  int i = button - DIGITAL_L1;
+  return presses[i] != prev.presses[i];
+}
+/**
+ * @param button
+ * a button
+ *
+ * @param id
+ * the controller
+ *
+ * @return
+ * mask of subscribeInputs for the edges of the button
+ */
+uint32_t controllerInputMask(pros::controller_digital_e_t button, pros::controller_id_e_t id){
+  return 1u << (CONTROLLER_INPUT_BASE + id*CONTROLLER_BUTTONS + button - DIGITAL_L1);
+}
+/**
+ * @param id
+ * the controller
+ *
+ * @return
+ * its last sample (all zero until the first)
+ */
+ControllerState getControllerState(pros::controller_id_e_t id){
+  return controllerStates[id].read();
+}
+/**
+ * Pick the controller whose mechanism buttons count this cycle (refer to MECHANISM_CONTROL).
+ * @param master, partner
+ * samples of the controllers
+ *
+ * @return
+ * one of them
+ */
+const ControllerState &mechanismController(const ControllerState &master, const ControllerState &partner){
+  if(MECHANISM_CONTROL == MECHANISM_MASTER || !partner.connected) return master;
+  if(MECHANISM_CONTROL == MECHANISM_PARTNER || (partner.buttons & MECHANISM_BUTTONS)) return partner;
+  return master;
+}
+/**
+ * Sample a controller and publish its button edges.
+ * @param controller
+ * the controller
+ *
+ * @param id
+ * its id
+ *
+ * @param state
+ * its previous sample, updated to the new one
+ */
+void sampleController(pros::Controller &controller, int id, ControllerState &state){
+  state.time = micros();
+  state.connected = controller.is_connected() == 1;
+  for(int i = 0; i < CONTROLLER_AXES; i++) state.axes[i] = controller.get_analog((pros::controller_analog_e_t)i);
+  uint16_t buttons = 0;
+  for(int i = 0; i < CONTROLLER_BUTTONS; i++){
+    if(controller.get_digital((pros::controller_digital_e_t)(DIGITAL_L1 + i)) == 1) buttons |= 1u << i;
+  }
+  uint16_t changed = buttons ^ state.buttons;
+  state.buttons = buttons;
+  for(int i = 0; i < CONTROLLER_BUTTONS; i++){
+    if(!(changed & (1u << i))) continue;
+    bool pressed = buttons & (1u << i);
+    if(pressed) state.presses[i]++;
+    InputEvent event = {(uint8_t)(CONTROLLER_INPUT_BASE + id*CONTROLLER_BUTTONS + i), pressed, state.time};
+    publishInputEvent(event);
+  }
+  controllerStates[id].write(state);
+}
+/**
+ * Controller service task: samples both controllers every CONTROLLER_DT and publishes the button edges,
+ * then, every DISPLAY_DT, sends one display line. The send comes after the sample, so it only uses
+ * the slack before the next one.
+ * Runs above the competition tasks, which read its samples.
+ */
+void controllerService(void * ignore){
+  ControllerState states[CONTROLLERS] = {};
+  LoopRate rate(CONTROLLER_DT);
+  startTaskTiming(TIMING_CONTROLLER, CONTROLLER_DT, true);
+  while(true){
+    beginTaskIteration(TIMING_CONTROLLER);
+    sampleController(master, pros::E_CONTROLLER_MASTER, states[pros::E_CONTROLLER_MASTER]);
+    sampleController(partner, pros::E_CONTROLLER_PARTNER, states[pros::E_CONTROLLER_PARTNER]);
+    if(rate.getTicks() % (DISPLAY_DT/CONTROLLER_DT) == 0) sendDisplayUpdate();
+    endTaskIteration(TIMING_CONTROLLER);
+    rate.wait();
+  }
+}
@@ -0,0 +1,299 @@
+/**
+ * Coprocessor link (refer to coprocessor.hpp for the frame format):
+ * - Receive: the port's bytes are read straight into a free slot, decoded in place and published
+ * - Requests from the robot's tasks, and their responses, matched by id
+ * - Pose stream
+ */
+#include "main.h"
+#include "pros/serial.h"
+/**
+ * Slot states: FREE (the task may receive into it), FILLING (the task is receiving into it), READY (a frame
+ * is waiting to be taken), HELD (a task took it and releases it with coprocRelease)
+ */
+enum CoprocSlotState{
+  COPROC_SLOT_FREE,
+  COPROC_SLOT_FILLING,
+  COPROC_SLOT_READY,
+  COPROC_SLOT_HELD
+};
+/** received frames and their states (READY to HELD by the taker, every other change by the coprocessor task) */
+CoprocFrame coprocSlots[COPROC_RX_SLOTS];
+std::atomic<uint8_t> coprocSlotStates[COPROC_RX_SLOTS];
+/** requests from one requesting task to the coprocessor task, and the id of the last one */
+Mailbox<CoprocRequest, COPROC_TX_QUEUE> coprocRequests;
+uint16_t coprocRequestId = 0;
+/** link counters */
+std::atomic<uint32_t> coprocReceived(0), coprocCorrupt(0), coprocExpired(0), coprocPosesSent(0), coprocRequestsSent(0);
+/**
+ * Queue a request (from one task only). Returns immediately; the coprocessor task sends it.
+ * @param kind
+ * what is asked (agreed with the coprocessor)
+ *
+ * @param data
+ * its data
+ *
+ * @param length
+ * bytes of data (up to COPROC_MAX_BODY - 1)
+ *
+ * @return
+ * its id (the response carries it), 0 if it was refused (too long, or the queue is full)
+ */
+uint16_t coprocRequest(uint8_t kind, const void *data, int length){
+  if(length < 0 || length > COPROC_MAX_BODY - 1) return 0;
+  CoprocRequest request;
+  /** ids go round from 1; 0 means refused */
+  if(++coprocRequestId == 0) coprocRequestId = 1;
+  request.id = coprocRequestId;
+  request.kind = kind;
+  request.length = length;
+  memcpy(request.data, data, length);
+  return coprocRequests.post(request)? request.id : 0;
+}
+/**
+ * Take the first waiting frame of a type (and of an id).
+ * @param id
+ * id to match, -1 for any
+ *
+ * @return
+ * the frame, held until coprocRelease; NULL if none is waiting
+ */
+const CoprocFrame *coprocTake(uint8_t type, int32_t id){
+  for(int i = 0; i < COPROC_RX_SLOTS; i++){
+    if(coprocSlotStates[i].load(std::memory_order_acquire) != COPROC_SLOT_READY) continue;
+    if(coprocSlots[i].type != type || (id >= 0 && coprocSlots[i].id != id)) continue;
+    /** the coprocessor task may expire it meanwhile */
+    uint8_t ready = COPROC_SLOT_READY;
+    if(coprocSlotStates[i].compare_exchange_strong(ready, COPROC_SLOT_HELD, std::memory_order_acquire)) return &coprocSlots[i];
+  }
+  return NULL;
+}
+/**
+ * Take the response to a request, if it arrived. Any task may call it.
+ * @param id
+ * id of the request
+ *
+ * @return
+ * the response (its body is read in place), held until coprocRelease; NULL if it has not arrived
+ */
+const CoprocFrame *coprocTakeResponse(uint16_t id){
+  return coprocTake(COPROC_RESPONSE, id);
+}
+/**
+ * Wait for the response to a request (from a task that may block, e.g. autonomous).
+ * @param id
+ * id of the request
+ *
+ * @param timeout
+ * maximum wait in ms
+ *
+ * @return
+ * refer to coprocTakeResponse; NULL at the timeout
+ */
+const CoprocFrame *coprocWaitResponse(uint16_t id, uint32_t timeout){
+  Timer timer;
+  while(true){
+    const CoprocFrame *frame = coprocTakeResponse(id);
+    if(frame != NULL || timer.passed(timeout)) return frame;
+    delay(COPROC_DT);
+  }
+}
+/**
+ * Take the oldest unsolicited message, if one arrived. Any task may call it.
+ * @return
+ * refer to coprocTakeResponse
+ */
+const CoprocFrame *coprocTakeMessage(){
+  const CoprocFrame *oldest = NULL;
+  for(int i = 0; i < COPROC_RX_SLOTS; i++){
+    if(coprocSlotStates[i].load(std::memory_order_acquire) != COPROC_SLOT_READY || coprocSlots[i].type != COPROC_MESSAGE) continue;
+    if(oldest == NULL || (int32_t)(coprocSlots[i].time - oldest->time) < 0) oldest = &coprocSlots[i];
+  }
+  return oldest == NULL? NULL : coprocTake(COPROC_MESSAGE, oldest->id);
+}
+/**
+ * Give a taken frame's slot back (its body is invalid afterwards).
+ * @param frame
+ * a frame from coprocTakeResponse, coprocWaitResponse or coprocTakeMessage (NULL is ignored)
+ */
+void coprocRelease(const CoprocFrame *frame){
+  if(frame == NULL) return;
+  coprocSlotStates[frame - coprocSlots].store(COPROC_SLOT_FREE, std::memory_order_release);
+}
+/**
+ * @return
+ * the link counters
+ */
+CoprocStats getCoprocStats(){
+  return {coprocReceived.load(), coprocCorrupt.load(), coprocExpired.load(),
+    coprocPosesSent.load(), coprocRequestsSent.load(), coprocRequests.dropped()};
+}
+/**
+ * Claim a free slot to receive into (coprocessor task only).
+ * @return
+ * its index, -1 if every slot is taken
+ */
+int claimCoprocSlot(){
+  for(int i = 0; i < COPROC_RX_SLOTS; i++){
+    if(coprocSlotStates[i].load(std::memory_order_acquire) != COPROC_SLOT_FREE) continue;
+    coprocSlotStates[i].store(COPROC_SLOT_FILLING, std::memory_order_relaxed);
+    return i;
+  }
+  return -1;
+}
+/**
+ * Decode a received frame in place and publish it (coprocessor task only).
+ * @param slot
+ * its slot, FILLING; READY if the frame is published
+ *
+ * @param length
+ * bytes received before the delimiter
+ *
+ * @return
+ * true if it was published
+ */
+bool publishCoprocFrame(int slot, int length){
+  CoprocFrame &frame = coprocSlots[slot];
+  length = cobsDecode(frame.data, length);
+  if(length < 5 || crc16(frame.data, length - 2) != (frame.data[length - 2] | frame.data[length - 1] << 8)
+    || (frame.data[0] != COPROC_RESPONSE && frame.data[0] != COPROC_MESSAGE)){
+    coprocCorrupt++;
+    return false;
+  }
+  frame.type = frame.data[0];
+  frame.id = frame.data[1] | frame.data[2] << 8;
+  frame.body = frame.data + 3;
+  frame.length = length - 5;
+  frame.time = millis();
+  coprocReceived++;
+  coprocSlotStates[slot].store(COPROC_SLOT_READY, std::memory_order_release);
+  return true;
+}
+/**
+ * Frame a payload and write it to the port, if the port can take it whole (coprocessor task only).
+ * @param payload
+ * type, id and body, with 2 bytes of room for the CRC
+ *
+ * @param length
+ * bytes of type, id and body
+ *
+ * @return
+ * true if it was written
+ */
+bool writeCoprocFrame(uint8_t *payload, int length){
+  uint8_t frame[COPROC_FRAME_BYTES];
+  uint16_t crc = crc16(payload, length);
+  payload[length++] = crc & 0xFF;
+  payload[length++] = crc >> 8;
+  length = cobsEncode(payload, length, frame);
+  frame[length++] = 0;
+  if(pros::c::serial_get_write_free(COPROC_PORT) < length) return false;
+  pros::c::serial_write(COPROC_PORT, frame, length);
+  return true;
+}
+/**
+ * Append a little endian float to a payload.
+ * @return
+ * index after it
+ */
+int putCoprocFloat(uint8_t *payload, int index, float value){
+  uint32_t bits;
+  memcpy(&bits, &value, 4);
+  for(int i = 0; i < 4; i++) payload[index++] = bits >> (8*i);
+  return index;
+}
+/**
+ * Serve the coprocessor link every COPROC_DT: receive, send the queued requests, stream the pose.
+ * Without a coprocessor (COPROC_PORT 0) the task sleeps for good.
+ */
+void coprocessor(void * ignore){
+  if(COPROC_PORT == 0) while(true) pros::c::task_notify_take(true, TIMEOUT_MAX);
+  pros::c::serial_enable(COPROC_PORT);
+  pros::c::serial_set_baudrate(COPROC_PORT, COPROC_BAUDRATE);
+  /** slot being received into (-1: none free), bytes in it, and whether the rest of an overlong frame is skipped */
+  int slot = -1, filled = 0;
+  bool skipping = false;
+  uint16_t poseCount = 0;
+  uint32_t poseTime = 0;
+  LoopRate rate(COPROC_DT);
+  startTaskTiming(TIMING_COPROC, COPROC_DT, true);
+  while(true){
+    if(waitTaskActive(ROBOT_COPROC)){
+      rate.restart();
+      startTaskTiming(TIMING_COPROC, COPROC_DT, true);
+    }
+    beginTaskIteration(TIMING_COPROC);
+    /** receive: read into the slot in place; bytes after a delimiter move to the next slot */
+    while(true){
+      if(slot < 0 && (slot = claimCoprocSlot()) < 0) break;
+      uint8_t *data = coprocSlots[slot].data;
+      int avail = pros::c::serial_get_read_avail(COPROC_PORT);
+      int count = std::min(avail, COPROC_FRAME_BYTES - filled);
+      if(count <= 0){
+        if(avail <= 0) break;
+        /** a frame longer than any valid one: skip it up to its delimiter */
+        skipping = true;
+        filled = 0;
+        continue;
+      }
+      count = pros::c::serial_read(COPROC_PORT, data + filled, count);
+      if(count <= 0) break;
+      int end = filled + count, start = filled;
+      filled = end;
+      uint8_t *delimiter = (uint8_t *)memchr(data + start, 0, end - start);
+      if(delimiter == NULL){
+        if(skipping) filled = 0;
+        continue;
+      }
+      int length = delimiter - data, rest = end - length - 1;
+      bool published = !skipping && length > 0 && publishCoprocFrame(slot, length);
+      skipping = false;
+      int next = published? claimCoprocSlot() : slot;
+      if(next < 0){
+        /** no free slot for the rest: it is dropped, and read again once a slot is released */
+        slot = -1;
+        filled = 0;
+        if(rest > 0) coprocCorrupt++;
+        break;
+      }
+      memmove(coprocSlots[next].data, delimiter + 1, rest);
+      slot = next;
+      filled = rest;
+    }
+    /** frames nobody took */
+    for(int i = 0; i < COPROC_RX_SLOTS; i++){
+      uint8_t ready = COPROC_SLOT_READY;
+      if(coprocSlotStates[i].load(std::memory_order_relaxed) == COPROC_SLOT_READY && millis() - coprocSlots[i].time >= COPROC_EXPIRY
+        && coprocSlotStates[i].compare_exchange_strong(ready, COPROC_SLOT_FREE)) coprocExpired++;
+    }
+    /** send: the queued requests, as long as the port takes them whole */
+    uint8_t payload[3 + COPROC_MAX_BODY + 2];
+    const CoprocRequest *request;
+    while((request = coprocRequests.peek()) != NULL){
+      payload[0] = COPROC_REQUEST;
+      payload[1] = request->id & 0xFF;
+      payload[2] = request->id >> 8;
+      payload[3] = request->kind;
+      memcpy(payload + 4, request->data, request->length);
+      if(!writeCoprocFrame(payload, 4 + request->length)) break;
+      coprocRequests.pop();
+      coprocRequestsSent++;
+    }
+    /** stream the pose */
+    if(millis() - poseTime >= COPROC_POSE_DT){
+      poseTime = millis();
+      PoseSnapshot pose = getPose();
+      payload[0] = COPROC_POSE;
+      payload[1] = poseCount & 0xFF;
+      payload[2] = poseCount >> 8;
+      int index = 3;
+      for(double value : {pose.x, pose.y, pose.angle, pose.linVel, pose.angVel}) index = putCoprocFloat(payload, index, value);
+      for(int i = 0; i < 4; i++) payload[index++] = (uint32_t)pose.timestamp >> (8*i);
+      if(writeCoprocFrame(payload, index)){
+        poseCount++;
+        coprocPosesSent++;
+      }
+    }
+    endTaskIteration(TIMING_COPROC);
+    rate.wait();
+  }
+}
@@ -0,0 +1,147 @@
+/**
+ * Current budget functions:
+ * - Split of the budget by demand and priority
+ * - Demands of the subsystems, set by the tasks driving them
+ * - Current limits of the motors, sent when the split or the battery's reach changes
+ */
+#include "main.h"
+/** subsystem of each motor (HealthMotor order) */
+const BudgetSubsystem budgetSubsystems[HEALTH_MOTORS] = {BUDGET_BASE, BUDGET_BASE, BUDGET_BASE, BUDGET_BASE,
+  BUDGET_ROLLERS, BUDGET_ROLLERS, BUDGET_INDEXER, BUDGET_SHOOTER};
+/**
+ * Arbiter state
+ * currentDemands: demand of each subsystem (written by the task driving it)
+ * budgetDirty: a demand changed since the limits were last sent
+ * budgetBusy: a task is sending the limits (the others leave the new demands to it)
+ * currentLimits: limit last sent to each motor (HEALTH_CURRENT_LIMIT, the firmware's default, until then)
+ * budgetTotal: total the limits were last split from
+ * plannedCurrent: sum of the limits of the motors of the subsystems not idle (mA)
+ */
+std::atomic<uint8_t> currentDemands[BUDGET_SUBSYSTEMS];
+std::atomic<bool> budgetDirty(false), budgetBusy(false);
+std::atomic<int32_t> currentLimits[HEALTH_MOTORS] = {HEALTH_CURRENT_LIMIT, HEALTH_CURRENT_LIMIT, HEALTH_CURRENT_LIMIT,
+  HEALTH_CURRENT_LIMIT, HEALTH_CURRENT_LIMIT, HEALTH_CURRENT_LIMIT, HEALTH_CURRENT_LIMIT, HEALTH_CURRENT_LIMIT};
+std::atomic<int32_t> budgetTotal(BUDGET_TOTAL_CURRENT), plannedCurrent(0);
+/**
+ * @return
+ * current the motors may share: BUDGET_TOTAL_CURRENT, or less if that would pull the battery below
+ * BATTERY_MIN_VOLTAGE (never less than every motor at BUDGET_IDLE_CURRENT)
+ */
+int32_t batteryBudgetTotal(){
+  return std::max(std::min(BUDGET_TOTAL_CURRENT, getBatteryCurrentLimit()), HEALTH_MOTORS*BUDGET_IDLE_CURRENT);
+}
+/**
+ * Split a total among the subsystems: every motor gets BUDGET_IDLE_CURRENT, then the subsystems
+ * at their peak are raised to HEALTH_CURRENT_LIMIT, the running ones to BUDGET_RUNNING_CURRENT, and what is
+ * left is shared up to HEALTH_CURRENT_LIMIT by priority. At each step the subsystems are served in priority
+ * order, and the motors of a subsystem get the same limit.
+ * @param demands
+ * demand of each subsystem (BudgetSubsystem order)
+ *
+ * @param total
+ * current to split in mA (BUDGET_TOTAL_CURRENT, unless the battery cannot supply it)
+ *
+ * @param limits
+ * written with the limit of each subsystem's motors in mA
+ */
+void allocateCurrentBudget(const CurrentDemand *demands, int32_t total, int32_t *limits){
+  int motors[BUDGET_SUBSYSTEMS] = {};
+  for(BudgetSubsystem subsystem : budgetSubsystems) motors[subsystem]++;
+  int32_t left = total;
+  for(int i = 0; i < BUDGET_SUBSYSTEMS; i++){
+    limits[i] = BUDGET_IDLE_CURRENT;
+    left -= motors[i]*BUDGET_IDLE_CURRENT;
+  }
+  /** the peaks, the running subsystems, then everyone with the leftover */
+  const int32_t stepLimits[3] = {HEALTH_CURRENT_LIMIT, BUDGET_RUNNING_CURRENT, HEALTH_CURRENT_LIMIT};
+  const int stepDemands[3] = {CURRENT_PEAK, CURRENT_RUNNING, CURRENT_IDLE};
+  for(int step = 0; step < 3; step++){
+    for(int i = 0; i < BUDGET_SUBSYSTEMS && left > 0; i++){
+      if(step < 2 && demands[i] != stepDemands[step]) continue;
+      int32_t raise = std::min(stepLimits[step] - limits[i], left/motors[i]);
+      if(raise <= 0) continue;
+      limits[i] += raise;
+      left -= raise*motors[i];
+    }
+  }
+}
+/**
+ * Send the limits of the current demands to the motors whose limit changed.
+ * Runs in the task that changed a demand; if another task is already sending, that task picks up the
+ * change (it sends again while budgetDirty is set), so no caller ever waits.
+ */
+void applyCurrentBudget(){
+  while(budgetDirty){
+    if(budgetBusy.exchange(true)) return;
+    budgetDirty = false;
+    CurrentDemand demands[BUDGET_SUBSYSTEMS];
+    int32_t limits[BUDGET_SUBSYSTEMS];
+    for(int i = 0; i < BUDGET_SUBSYSTEMS; i++) demands[i] = (CurrentDemand)currentDemands[i].load();
+    int32_t total = batteryBudgetTotal();
+    allocateCurrentBudget(demands, total, limits);
+    budgetTotal = total;
+    const pros::Motor *mechMotors[] = {&lRoller, &rRoller, &indexer, &shooter};
+    int32_t planned = 0;
+    for(int i = 0; i < HEALTH_MOTORS; i++){
+      int32_t limit = limits[budgetSubsystems[i]];
+      if(demands[budgetSubsystems[i]] != CURRENT_IDLE) planned += limit;
+      if(limit == currentLimits[i]) continue;
+      if(i < HEALTH_LEFT_ROLLER) drivetrain.setCurrentLimit((BaseMotor)i, limit);
+      else mechMotors[i - HEALTH_LEFT_ROLLER]->set_current_limit(limit);
+      currentLimits[i] = limit;
+    }
+    plannedCurrent = planned;
+    budgetBusy = false;
+  }
+}
+/**
+ * Set the demand of a subsystem, and resend the limits if it changed. Cheap when it does not,
+ * so the control loops call it every cycle.
+ * @param subsystem
+ * the subsystem
+ *
+ * @param demand
+ * its demand
+ */
+void setCurrentDemand(BudgetSubsystem subsystem, CurrentDemand demand){
+  if(currentDemands[subsystem].exchange(demand) == demand) return;
+  budgetDirty = true;
+  applyCurrentBudget();
+}
+/**
+ * Resend the limits if the current the battery can supply moved by BUDGET_TOTAL_STEP since the last split
+ * (the motor health task, after each battery sample).
+ */
+void refreshCurrentBudget(){
+  if(abs(batteryBudgetTotal() - budgetTotal) < BUDGET_TOTAL_STEP) return;
+  budgetDirty = true;
+  applyCurrentBudget();
+}
+/**
+ * @param subsystem
+ * a subsystem
+ *
+ * @return
+ * its demand (CURRENT_IDLE until set)
+ */
+CurrentDemand getCurrentDemand(BudgetSubsystem subsystem){
+  return (CurrentDemand)currentDemands[subsystem].load();
+}
+/**
+ * @param motor
+ * a motor
+ *
+ * @return
+ * the current limit last sent to it in mA
+ */
+int32_t getCurrentLimit(HealthMotor motor){
+  return currentLimits[motor];
+}
+/**
+ * @return
+ * current the subsystems at work may draw together in mA: the sum of the limits of the motors of the subsystems
+ * not idle (0 until a demand is set)
+ */
+int32_t getPlannedCurrent(){
+  return plannedCurrent;
+}
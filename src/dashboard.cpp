@@ -0,0 +1,252 @@
+/**
+ * Dashboard functions:
+ * - Field map with the robot marker, its heading and the planned path
+ * - Pose, loop timing and scoring throughput labels
+ * - Task dashboard: redraws only what changed, so LVGL only flushes those regions, within a budget per frame
+ * - Display construction (every object created once) and its memory footprint
+ */
+#include "main.h"
+#include "display/lvgl.h"
+/** the dashboard screen and its objects (NULL until the task builds them) */
+lv_obj_t *dashboardScreen = NULL, *fieldMap = NULL, *robotMarker = NULL;
+lv_obj_t *headingLine = NULL, *pathLine = NULL, *poseLabel = NULL, *timingLabel = NULL;
+lv_obj_t *cycleLabel = NULL;
+lv_style_t fieldStyle, pathStyle, headingStyle;
+/** points of the lines (LVGL keeps the pointers, so they must stay valid) */
+lv_point_t headingPoints[2], pathPoints[MAX_PURSUIT_POINTS];
+/** what is drawn, so unchanged objects are not invalidated */
+lv_coord_t shownRobotX = -1, shownRobotY = -1, shownHeadX = -1, shownHeadY = -1;
+uint32_t shownPathVersion = 0;
+/** text of the labels (lv_label_set_static_text: LVGL reads them in place and never allocates) */
+char shownPose[48], shownTiming[320], shownCycles[48];
+std::atomic<bool> dashboardShowPending(true);
+/** drawing jobs of a frame, in their usual order */
+enum DashboardJob{
+  DASHBOARD_ROBOT,
+  DASHBOARD_PATH,
+  DASHBOARD_POSE,
+  DASHBOARD_STATS,
+  DASHBOARD_JOBS
+};
+/** kernel heap taken by buildDisplay in bytes */
+uint32_t displayFootprint = 0;
+/**
+ * Pixel of a field point on the map.
+ * @param x, y
+ * field point in inches (odometry coordinates)
+ *
+ * @return
+ * pixel relative to the map's top left corner
+ */
+lv_point_t fieldPixel(double x, double y){
+  const double scale = (double)DASHBOARD_FIELD_PX/DASHBOARD_FIELD_SIZE;
+  lv_point_t pixel;
+  pixel.x = (lv_coord_t)round((DASHBOARD_ORIGIN_X + x)*scale);
+  pixel.y = (lv_coord_t)round(DASHBOARD_FIELD_PX - (DASHBOARD_ORIGIN_Y + y)*scale);
+  return pixel;
+}
+/**
+ * Bring the dashboard to the front at its next refresh (e.g. after the autonomous selector).
+ */
+void showDashboard(){
+  dashboardShowPending = true;
+}
+/**
+ * Create the dashboard screen: the field map on the left, the labels on the right.
+ */
+void buildDashboard(){
+  dashboardScreen = lv_obj_create(NULL, NULL);
+  lv_style_copy(&fieldStyle, &lv_style_plain);
+  fieldStyle.body.main_color = fieldStyle.body.grad_color = LV_COLOR_HEX(0x404040);
+  fieldStyle.body.border.color = LV_COLOR_WHITE;
+  fieldStyle.body.border.width = 1;
+  fieldMap = lv_obj_create(dashboardScreen, NULL);
+  lv_obj_set_style(fieldMap, &fieldStyle);
+  lv_obj_set_size(fieldMap, DASHBOARD_FIELD_PX, DASHBOARD_FIELD_PX);
+  lv_obj_set_pos(fieldMap, 0, 0);
+  lv_style_copy(&pathStyle, &lv_style_plain);
+  pathStyle.line.color = LV_COLOR_YELLOW;
+  pathStyle.line.width = 2;
+  pathLine = lv_line_create(fieldMap, NULL);
+  lv_line_set_style(pathLine, &pathStyle);
+  lv_obj_set_pos(pathLine, 0, 0);
+  lv_style_copy(&headingStyle, &lv_style_plain);
+  headingStyle.line.color = LV_COLOR_RED;
+  headingStyle.line.width = 2;
+  headingLine = lv_line_create(fieldMap, NULL);
+  lv_line_set_style(headingLine, &headingStyle);
+  lv_obj_set_pos(headingLine, 0, 0);
+  robotMarker = lv_obj_create(fieldMap, NULL);
+  lv_obj_set_style(robotMarker, &lv_style_plain_color);
+  lv_obj_set_size(robotMarker, DASHBOARD_ROBOT_PX, DASHBOARD_ROBOT_PX);
+  poseLabel = lv_label_create(dashboardScreen, NULL);
+  lv_obj_set_pos(poseLabel, DASHBOARD_FIELD_PX + 8, 4);
+  lv_label_set_static_text(poseLabel, shownPose);
+  timingLabel = lv_label_create(dashboardScreen, NULL);
+  lv_obj_set_pos(timingLabel, DASHBOARD_FIELD_PX + 8, 40);
+  lv_label_set_static_text(timingLabel, shownTiming);
+  cycleLabel = lv_label_create(dashboardScreen, NULL);
+  lv_obj_set_pos(cycleLabel, DASHBOARD_FIELD_PX + 130, 4);
+  lv_label_set_static_text(cycleLabel, shownCycles);
+}
+/**
+ * Create every object of the brain screen (the autonomous selector, the dashboard and the tuning panel) and measure
+ * the kernel heap they take. Run once by the BOOT_UI stage of initialize() (refer to bootSequence.hpp).
+ */
+void buildDisplay(){
+  if(dashboardScreen != NULL) return;
+  uint32_t before = getKernelHeapUsage().free;
+  buildAutonSelector();
+  buildDashboard();
+  buildTuningPanel();
+  uint32_t after = getKernelHeapUsage().free;
+  displayFootprint = before > after? before - after : 0;
+}
+/**
+ * @return
+ * kernel heap taken by the brain screen objects in bytes
+ */
+uint32_t getDisplayFootprint(){
+  return displayFootprint;
+}
+/**
+ * Redraw the robot marker and its heading line if they moved by a pixel.
+ * @param pose
+ * the robot's pose
+ */
+void drawRobot(const PoseSnapshot &pose){
+  lv_point_t centre = fieldPixel(pose.x, pose.y);
+  if(centre.x != shownRobotX || centre.y != shownRobotY){
+    lv_obj_set_pos(robotMarker, centre.x - DASHBOARD_ROBOT_PX/2, centre.y - DASHBOARD_ROBOT_PX/2);
+    shownRobotX = centre.x;
+    shownRobotY = centre.y;
+  }
+  lv_coord_t headX = centre.x + (lv_coord_t)round(sin(pose.angle)*DASHBOARD_HEADING_PX);
+  lv_coord_t headY = centre.y - (lv_coord_t)round(cos(pose.angle)*DASHBOARD_HEADING_PX);
+  if(headX != shownHeadX || headY != shownHeadY){
+    headingPoints[0] = centre;
+    headingPoints[1].x = headX;
+    headingPoints[1].y = headY;
+    lv_line_set_points(headingLine, headingPoints, 2);
+    shownHeadX = headX;
+    shownHeadY = headY;
+  }
+}
+/**
+ * Redraw the planned path when a new one has been set.
+ */
+void drawPath(){
+  PursuitPoint points[MAX_PURSUIT_POINTS];
+  uint32_t version;
+  int count = getPursuitPath(points, version);
+  if(version == shownPathVersion) return;
+  for(int i = 0; i < count; i++) pathPoints[i] = fieldPixel(points[i].x, points[i].y);
+  lv_line_set_points(pathLine, pathPoints, count);
+  shownPathVersion = version;
+}
+/**
+ * Set a label's text if it differs from what it shows.
+ * @param label
+ * the label
+ *
+ * @param shown
+ * text it shows (updated), of size `size`
+ *
+ * @param text
+ * new text
+ */
+void setLabelText(lv_obj_t *label, char *shown, int size, const char *text){
+  if(strcmp(shown, text) == 0) return;
+  snprintf(shown, size, "%s", text);
+  /** the label shows the buffer in place: redraw it at its new size */
+  lv_label_set_static_text(label, shown);
+}
+/**
+ * Draw the source of the odometry (a failed tracking wheel shows here), the timing of the sensing and
+ * control tasks (refer to TaskTimingSummary), the display memory and the boot time (refer to BootMark).
+ */
+void drawTiming(){
+  const TimedTask tasks[] = {TIMING_ODOMETRY, TIMING_CONTROL, TIMING_INPUT};
+  const char *names[] = {"odom", "control", "input"};
+  char text[sizeof(shownTiming)];
+  int length = snprintf(text, sizeof(text), "odom from %s\n", getOdometrySourceName(getOdometryHealth().source));
+  for(int i = 0; i < 3 && length < (int)sizeof(text); i++){
+    TaskTimingSummary timing = getTaskTiming(tasks[i]);
+    length += snprintf(text + length, sizeof(text) - length, "%s exec %u us\n late %u/%u us miss %u\n",
+      names[i], timing.p99Exec, timing.p99Late, timing.maxLate, timing.misses);
+  }
+  HeapUsage kernel = getKernelHeapUsage();
+  if(length < (int)sizeof(text)) length += snprintf(text + length, sizeof(text) - length, "display %u B\nkernel %u free %u least",
+    displayFootprint, kernel.free, kernel.minFree);
+  /** boot: initialize() and the first control cycle, in ms since the program start */
+  uint64_t initialized, control;
+  if(length < (int)sizeof(text) && getBootMark(BOOT_MARK_INITIALIZED, initialized)){
+    if(getBootMark(BOOT_MARK_CONTROL, control)) snprintf(text + length, sizeof(text) - length, "\nboot %u ms, control %u ms",
+      (unsigned)(initialized/1000), (unsigned)(control/1000));
+    else snprintf(text + length, sizeof(text) - length, "\nboot %u ms", (unsigned)(initialized/1000));
+  }
+  setLabelText(timingLabel, shownTiming, sizeof(shownTiming), text);
+}
+/**
+ * Draw the scoring throughput (refer to ShooterMetrics): balls shot of those taken in, the mean goal cycle and
+ * the time stalled in the latest one.
+ */
+void drawCycles(){
+  ShooterMetrics metrics = getShooterMetrics();
+  char text[sizeof(shownCycles)];
+  snprintf(text, sizeof(text), "shot %u/%u\ncycle %.1f s\nstall %.1f s", (unsigned)metrics.shot, (unsigned)metrics.intaken,
+    metrics.meanCycle/1000.0, metrics.stalled/1000.0);
+  setLabelText(cycleLabel, shownCycles, sizeof(shownCycles), text);
+}
+/**
+ * Draw the dashboard every DASHBOARD_DT while its screen is in front.
+ * Run at the lowest priority: the refresh only queues invalidated areas, the flush is done by the
+ * LVGL task, and a late refresh only delays the picture. The jobs of a frame stop once it has drawn
+ * for DASHBOARD_FRAME_BUDGET; the next frame starts with the first job left out, so none is starved.
+ */
+void dashboard(void * ignore){
+  LoopRate rate(DASHBOARD_DT);
+  Timer statsTimer;
+  RobotPhase shownPhase = getPhase();
+  int firstJob = DASHBOARD_ROBOT;
+  startTaskTiming(TIMING_DASHBOARD, DASHBOARD_DT, true);
+  while(true){
+    beginTaskIteration(TIMING_DASHBOARD);
+    /** the objects are created by buildDisplay (BOOT_UI stage), never here */
+    if(!isBootReady(BOOT_UI)){
+      endTaskIteration(TIMING_DASHBOARD);
+      rate.wait();
+      continue;
+    }
+    /** the autonomous selector takes the screen before the match; take it back once enabled (the tuning panel stays) */
+    RobotPhase phase = getPhase();
+    if(phase != shownPhase && phase != PHASE_DISABLED && !isTuningPanelShown()) showDashboard();
+    shownPhase = phase;
+    if(dashboardShowPending.exchange(false)) lv_scr_load(dashboardScreen);
+    if(lv_scr_act() == dashboardScreen){
+      PoseSnapshot pose = getPose();
+      uint64_t start = micros();
+      for(int i = 0; i < DASHBOARD_JOBS; i++){
+        int job = (firstJob + i)%DASHBOARD_JOBS;
+        if(i > 0 && micros() - start >= DASHBOARD_FRAME_BUDGET){
+          firstJob = job;
+          break;
+        }
+        if(job == DASHBOARD_ROBOT) drawRobot(pose);
+        else if(job == DASHBOARD_PATH) drawPath();
+        else if(job == DASHBOARD_POSE){
+          char text[sizeof(shownPose)];
+          snprintf(text, sizeof(text), "x %6.1f in\ny %6.1f in\nangle %6.1f", pose.x, pose.y, wrapDeg(pose.angle*toDeg));
+          setLabelText(poseLabel, shownPose, sizeof(shownPose), text);
+        }
+        else if(statsTimer.passed(DASHBOARD_STATS_DT)){
+          drawTiming();
+          drawCycles();
+          statsTimer.reset();
+        }
+      }
+    }
+    endTaskIteration(TIMING_DASHBOARD);
+    rate.wait();
+  }
+}
@@ -0,0 +1,30 @@
+/**
+ * Device registry:
+ * - Construction and configuration of every motor, sensor and controller of the robot, once
+ */
+#include "main.h"
+/** the base (green cartridge, degrees, right side reversed) */
+Drivetrain drivetrain(FLPort, BLPort, FRPort, BRPort);
+/** mechanisms: green rollers, blue indexer and shooter */
+pros::Motor lRoller(lRollerPort, pros::E_MOTOR_GEARSET_18, false, pros::E_MOTOR_ENCODER_DEGREES);
+pros::Motor rRoller(rRollerPort, pros::E_MOTOR_GEARSET_18, true, pros::E_MOTOR_ENCODER_DEGREES);
+pros::Motor indexer(indexerPort, pros::E_MOTOR_GEARSET_06, false, pros::E_MOTOR_ENCODER_DEGREES);
+pros::Motor shooter(shooterPort, pros::E_MOTOR_GEARSET_06, true, pros::E_MOTOR_ENCODER_DEGREES);
+/** tracking wheels (the right wheel is mounted mirrored) */
+pros::ADIEncoder encoderL(encdL_port, encdL_port + 1, false);
+pros::ADIEncoder encoderR(encdR_port, encdR_port + 1, true);
+#if ODOM_THREE_WHEEL
+pros::ADIEncoder encoderS(encdS_port, encdS_port + 1, false);
+#endif
+#if ODOM_USE_IMU
+pros::Imu imu(imuPort);
+#endif
+#if ODOM_USE_ULTRASONIC
+pros::ADIUltrasonic ultrasonic(ultrasonicPort, ultrasonicPort + 1);
+#endif
+pros::ADIAnalogIn color(colorPort);
+pros::Vision vision(visionPort);
+pros::Controller master(pros::E_CONTROLLER_MASTER);
+pros::Controller partner(pros::E_CONTROLLER_PARTNER);
+/** every device above is constructed (refer to BootMark) */
+bool devicesConstructed = (markBoot(BOOT_MARK_DEVICES), true);
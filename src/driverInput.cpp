@@ -0,0 +1,263 @@
+/**
+ * Driver input functions:
+ * - Response table (deadband & curve) generated at compile time
+ * - Arcade & tank mixing
+ * - Slew limiting of each side
+ * - Driver assists: heading hold and goal aim on the odometry heading (on the vision target when it is seen)
+ * - Driver controls: one cycle of the button bindings on controller samples
+ */
+#include "main.h"
+/**
+ * Exponential computed by its Taylor series, for generating the table at compile time.
+ * @param x
+ * exponent within 0<=x<=DRIVE_EXPO_K
+ *
+ * @return
+ * e^x, accurate to double precision for small x
+ */
+constexpr double taylorExp(double x){
+  double term = 1, sum = 1;
+  for(int n = 1; n < 40; n++){
+    term *= x/n;
+    sum += term;
+  }
+  return sum;
+}
+/**
+ * Response curve of a stick travel (refer to ResponseCurve).
+ * @param x
+ * stick travel past the deadband, 0 to 1
+ *
+ * @return
+ * power fraction, 0 to 1
+ */
+constexpr double responseCurve(double x){
+  if(DRIVE_CURVE == CURVE_EXPONENTIAL) return (taylorExp(DRIVE_EXPO_K*x) - 1)/(taylorExp(DRIVE_EXPO_K) - 1);
+  if(DRIVE_CURVE == CURVE_CUBIC) return (1 - DRIVE_CUBIC_WEIGHT)*x + DRIVE_CUBIC_WEIGHT*x*x*x;
+  return x;
+}
+/** power of every stick value, index: stick + 128 (stick -128 to 127) */
+struct ResponseTable{
+  int8_t value[256];
+};
+/**
+ * Generate the response table at compile time.
+ * @return
+ * the response table
+ */
+constexpr ResponseTable makeResponseTable(){
+  ResponseTable table = {};
+  for(int i = 0; i < 256; i++){
+    int stick = i - 128;
+    int magnitude = stick < 0? -stick : stick;
+    if(magnitude > 127) magnitude = 127;
+    double x = magnitude <= DRIVE_DEADBAND? 0 : (double)(magnitude - DRIVE_DEADBAND)/(127 - DRIVE_DEADBAND);
+    int power = (int)(127*responseCurve(x) + 0.5);
+    table.value[i] = stick < 0? -power : power;
+  }
+  return table;
+}
+constexpr ResponseTable driveResponse = makeResponseTable();
+static_assert(driveResponse.value[255] == 127 && driveResponse.value[1] == -127, "the response must reach full power");
+static_assert(driveResponse.value[128 + DRIVE_DEADBAND] == 0, "the deadband must give 0");
+/** powers last sent to the sides (slew limiting) */
+int32_t drivePowerL = 0, drivePowerR = 0;
+/**
+ * Assist state
+ * assistMode: assist of the previous call (a change restarts the heading controller)
+ * holdActive, holdHeading: heading held by ASSIST_HOLD_HEADING in radians
+ * prevAssistError, prevAssistTime: previous heading error (degrees) and its time (micros), for the D term
+ * aimAhead, aimX, aimY: ASSIST_AIM_GOAL found a field goal in front as it engaged, and its point (inches)
+ */
+DriverAssist assistMode = ASSIST_NONE;
+bool holdActive = false;
+double holdHeading = 0, assistGoalX = ASSIST_GOAL_X, assistGoalY = ASSIST_GOAL_Y;
+double prevAssistError = 0;
+bool aimAhead = false;
+double aimX = 0, aimY = 0;
+uint64_t prevAssistTime = 0;
+/**
+ * Shape a stick value: deadband and response curve, one table lookup.
+ * @param stick
+ * value of Controller::get_analog (-127 to 127)
+ *
+ * @return
+ * power (-127 to 127)
+ */
+int32_t shapeStick(int32_t stick){
+  if(stick > 127) stick = 127;
+  if(stick < -128) stick = -128;
+  return driveResponse.value[stick + 128];
+}
+/**
+ * Forget the powers of the previous calls (the slew limiting starts from rest).
+ * Call when the driver takes the base over.
+ */
+void resetDriverInput(){
+  drivePowerL = drivePowerR = 0;
+  assistMode = ASSIST_NONE;
+  holdActive = false;
+}
+/**
+ * Set the point ASSIST_AIM_GOAL turns to.
+ * @param x, y
+ * goal point in inches (odometry coordinates)
+ */
+void setAssistGoal(double x, double y){
+  assistGoalX = x;
+  assistGoalY = y;
+}
+/**
+ * Turn power of an assist (PD on the heading error).
+ * @param error
+ * target - current heading in degrees (positive: clockwise)
+ *
+ * @param restart
+ * first call of an engagement (no D term)
+ *
+ * @return
+ * turn power, positive clockwise (-ASSIST_MAX_TURN to ASSIST_MAX_TURN)
+ */
+int32_t assistTurn(double error, bool restart){
+  uint64_t now = micros();
+  double dt = (now - prevAssistTime)*1e-6;
+  double turn = ASSIST_KP*error;
+  if(!restart && dt > 0) turn += ASSIST_KD*(error - prevAssistError)/dt;
+  prevAssistError = error;
+  prevAssistTime = now;
+  if(turn > ASSIST_MAX_TURN) turn = ASSIST_MAX_TURN;
+  if(turn < -ASSIST_MAX_TURN) turn = -ASSIST_MAX_TURN;
+  return (int32_t)round(turn);
+}
+/**
+ * Limit the change of a side's power to DRIVE_SLEW per call.
+ * @param power
+ * power last sent to the side; updated
+ *
+ * @param target
+ * requested power
+ */
+void slewSide(int32_t &power, int32_t target){
+  if(target > 127) target = 127;
+  if(target < -127) target = -127;
+  if(target > power + DRIVE_SLEW) power += DRIVE_SLEW;
+  else if(target < power - DRIVE_SLEW) power -= DRIVE_SLEW;
+  else power = target;
+}
+/**
+ * Drive the base from arcade sticks.
+ * @param forward
+ * forward stick (-127 to 127)
+ *
+ * @param turn
+ * turn stick, positive clockwise (-127 to 127)
+ *
+ * @param assist
+ * assist closing the turn on the odometry heading (refer to DriverAssist)
+ */
+void driveArcade(int32_t forward, int32_t turn, DriverAssist assist){
+  int32_t y = shapeStick(forward), x = shapeStick(turn)*DRIVE_TURN_SCALE;
+  bool restart = assist != assistMode;
+  assistMode = assist;
+  if(assist == ASSIST_HOLD_HEADING){
+    /** the driver turning moves the held heading along */
+    if(x != 0) holdActive = false;
+    else{
+      PoseSnapshot pose = getPose();
+      if(!holdActive) holdHeading = pose.angle;
+      x = assistTurn(angleDiff(holdHeading, pose.angle)*toDeg, restart || !holdActive);
+      holdActive = true;
+    }
+  }
+  else if(assist == ASSIST_AIM_GOAL){
+    PoseSnapshot pose = getPose();
+    /** the goal the vision sensor sees, else the field goal in front as the assist engaged, else the set goal point */
+    if(restart){
+      FieldHit hit = {};
+      aimAhead = fieldElementAhead(FIELD_GOAL, pose.x, pose.y, pose.angle, ASSIST_AIM_RANGE, ASSIST_AIM_CONE*toRad, hit);
+      aimX = hit.x;
+      aimY = hit.y;
+    }
+    VisionTarget target;
+    double goalX = aimAhead? aimX : assistGoalX, goalY = aimAhead? aimY : assistGoalY;
+    if(getVisionTarget(VISION_GOAL, target)){
+      goalX = target.x;
+      goalY = target.y;
+    }
+    double bearing = atan2(goalX - pose.x, goalY - pose.y);
+    x = assistTurn(angleDiff(bearing, pose.angle)*toDeg, restart);
+  }
+  if(assist != ASSIST_HOLD_HEADING) holdActive = false;
+  slewSide(drivePowerL, y + x);
+  slewSide(drivePowerR, y - x);
+  if(drivePowerL != 0 || drivePowerR != 0) wakeOdometry();
+  drivetrain.setPower(drivePowerL, drivePowerR);
+}
+/**
+ * Drive the base from tank sticks.
+ * @param left, right
+ * sticks of the sides (-127 to 127)
+ */
+void driveTank(int32_t left, int32_t right){
+  slewSide(drivePowerL, shapeStick(left));
+  slewSide(drivePowerR, shapeStick(right));
+  if(drivePowerL != 0 || drivePowerR != 0) wakeOdometry();
+  drivetrain.setPower(drivePowerL, drivePowerR);
+}
+/**
+ * Start the driver pipeline: arcade drive, the slew limiting from rest, and new presses counted from a sample.
+ * @param controls
+ * the pipeline state
+ *
+ * @param master
+ * the current master sample (a button held already does not count as a new press)
+ */
+void resetDriverControls(DriverControls &controls, const ControllerState &master){
+  controls.tankDrive = false;
+  controls.prev = master;
+  controls.assisted = false;
+  resetDriverInput();
+}
+/**
+ * One cycle of the driver controls: the master drives the base, the mechanisms follow the controller
+ * chosen by mechanismController. The samples are live in opcontrol, or replayed by playMacro.
+ * While a movement drives the base (BASE_MODE_ASSIST) the base is left alone, unless a drive stick
+ * is beyond DRIVE_ASSIST_OVERRIDE: the movement is then aborted and the driver drives.
+ * @param controls
+ * the pipeline state
+ *
+ * @param master, partner
+ * samples of the controllers
+ */
+void runDriverControls(DriverControls &controls, const ControllerState &master, const ControllerState &partner){
+  /** toggle tank drive */
+  if(master.pressedSince(controls.prev, DRIVE_TANK_BUTTON)) controls.tankDrive = !controls.tankDrive;
+  controls.prev = master;
+  int32_t turnStick = controls.tankDrive? master.axis(ANALOG_RIGHT_Y) : master.axis(ANALOG_RIGHT_X);
+  bool assisted = getBaseControlMode() == BASE_MODE_ASSIST;
+  if(assisted && (abs(master.axis(ANALOG_LEFT_Y)) > DRIVE_ASSIST_OVERRIDE || abs(turnStick) > DRIVE_ASSIST_OVERRIDE)){
+    setBaseControlMode(BASE_MODE_DRIVER);
+    assisted = false;
+  }
+  /** the driver takes the base back from rest, in the driver's brake mode */
+  if(controls.assisted && !assisted){
+    resetDriverInput();
+    drivetrain.setBrakeMode(DRIVE_BRAKE_MODE);
+  }
+  controls.assisted = assisted;
+  if(controls.tankDrive && !assisted) driveTank(master.axis(ANALOG_LEFT_Y), turnStick);
+  else if(!assisted){
+    /** held assist buttons close the turn on the odometry heading (aim wins over hold) */
+    DriverAssist assist = ASSIST_NONE;
+    if(master.held(ASSIST_HOLD_BUTTON)) assist = ASSIST_HOLD_HEADING;
+    if(master.held(ASSIST_AIM_BUTTON)) assist = ASSIST_AIM_GOAL;
+    driveArcade(master.axis(ANALOG_LEFT_Y), turnStick, assist);
+  }
+  /** the mechanisms follow the master or the partner controller (refer to MECHANISM_CONTROL) */
+  const ControllerState &mech = mechanismController(master, partner);
+  intakeMove((mech.held(DIGITAL_R1) - mech.held(DIGITAL_R2)) * 127);
+  setDiscard(mech.held(DIGITAL_L2));
+  /** holding L1 keeps cycling, one queued cycle at a time */
+  if(mech.held(DIGITAL_L1) && getShooterPending() == 0) cycle();
+  if(master.held(DIGITAL_X) || (partner.connected && partner.held(DIGITAL_X))) forceStop();
+}
@@ -0,0 +1,287 @@
+/**
+ * Drivetrain functions:
+ * - Construction and configuration of the base motors
+ * - Side writes (power, voltage, velocity) through the motor output layer, with the strafe of a holonomic base
+ * - Averaged side readings and per-motor readings
+ */
+#include "main.h"
+/**
+ * Construct the base motors: green cartridge, positions in degrees, right side reversed.
+ * @param frontLeft, backLeft, frontRight, backRight
+ * smart ports of the motors
+ */
+Drivetrain::Drivetrain(uint8_t frontLeft, uint8_t backLeft, uint8_t frontRight, uint8_t backRight)
+  : frontLeft(frontLeft, pros::E_MOTOR_GEARSET_18, false, pros::E_MOTOR_ENCODER_DEGREES),
+    backLeft(backLeft, pros::E_MOTOR_GEARSET_18, false, pros::E_MOTOR_ENCODER_DEGREES),
+    frontRight(frontRight, pros::E_MOTOR_GEARSET_18, true, pros::E_MOTOR_ENCODER_DEGREES),
+    backRight(backRight, pros::E_MOTOR_GEARSET_18, true, pros::E_MOTOR_ENCODER_DEGREES){}
+/**
+ * Set the power of each side.
+ * @param left, right
+ * power of the sides (-127 to 127)
+ */
+void Drivetrain::setPower(int32_t left, int32_t right){
+  setMotorPower(frontLeft, left);
+  setMotorPower(backLeft, left);
+  setMotorPower(frontRight, right);
+  setMotorPower(backRight, right);
+}
+/**
+ * Set the power of each side and the strafe (mixed per motor, refer to mixChassis; a tank drive ignores the strafe).
+ * @param left, right, strafe
+ * power of the sides and of the strafe (-127 to 127, strafe positive to the right)
+ */
+void Drivetrain::setPower(int32_t left, int32_t right, int32_t strafe){
+  if(!HOLONOMIC_BASE){
+    setPower(left, right);
+    return;
+  }
+  WheelCommands wheels = mixChassis(left, right, strafe, 127);
+  setMotorPower(frontLeft, wheels.frontLeft);
+  setMotorPower(backLeft, wheels.backLeft);
+  setMotorPower(frontRight, wheels.frontRight);
+  setMotorPower(backRight, wheels.backRight);
+}
+/**
+ * Set the voltage of each side.
+ * @param left, right
+ * voltage of the sides in mV (-12000 to 12000)
+ */
+void Drivetrain::setVoltage(int32_t left, int32_t right){
+  setMotorVoltage(frontLeft, left);
+  setMotorVoltage(backLeft, left);
+  setMotorVoltage(frontRight, right);
+  setMotorVoltage(backRight, right);
+}
+/**
+ * Set the voltage of each side and the strafe (refer to the strafing setPower).
+ * @param left, right, strafe
+ * voltage of the sides and of the strafe in mV (-12000 to 12000)
+ */
+void Drivetrain::setVoltage(int32_t left, int32_t right, int32_t strafe){
+  if(!HOLONOMIC_BASE){
+    setVoltage(left, right);
+    return;
+  }
+  WheelCommands wheels = mixChassis(left, right, strafe, 12000);
+  setMotorVoltage(frontLeft, wheels.frontLeft);
+  setMotorVoltage(backLeft, wheels.backLeft);
+  setMotorVoltage(frontRight, wheels.frontRight);
+  setMotorVoltage(backRight, wheels.backRight);
+}
+/**
+ * Set the velocity of each side (the motors' internal velocity loop).
+ * @param left, right
+ * velocity of the sides in rpm
+ */
+void Drivetrain::setVelocity(int32_t left, int32_t right){
+  setMotorVelocity(frontLeft, left);
+  setMotorVelocity(backLeft, left);
+  setMotorVelocity(frontRight, right);
+  setMotorVelocity(backRight, right);
+}
+/**
+ * Set the velocity of each side and the strafe (refer to the strafing setPower).
+ * @param left, right, strafe
+ * velocity of the sides and of the strafe in rpm
+ */
+void Drivetrain::setVelocity(int32_t left, int32_t right, int32_t strafe){
+  if(!HOLONOMIC_BASE){
+    setVelocity(left, right);
+    return;
+  }
+  WheelCommands wheels = mixChassis(left, right, strafe, BASE_MOTOR_RPM);
+  setMotorVelocity(frontLeft, wheels.frontLeft);
+  setMotorVelocity(backLeft, wheels.backLeft);
+  setMotorVelocity(frontRight, wheels.frontRight);
+  setMotorVelocity(backRight, wheels.backRight);
+}
+/**
+ * Stop the base (0 power).
+ */
+void Drivetrain::stop(){
+  setPower(0, 0);
+}
+/**
+ * Set what the base motors do at 0 power.
+ * @param mode
+ * E_MOTOR_BRAKE_COAST, E_MOTOR_BRAKE_BRAKE or E_MOTOR_BRAKE_HOLD
+ */
+void Drivetrain::setBrakeMode(pros::motor_brake_mode_e_t mode){
+  frontLeft.set_brake_mode(mode);
+  backLeft.set_brake_mode(mode);
+  frontRight.set_brake_mode(mode);
+  backRight.set_brake_mode(mode);
+}
+/**
+ * Set what the motors of each side do at 0 power.
+ * @param left, right
+ * E_MOTOR_BRAKE_COAST, E_MOTOR_BRAKE_BRAKE or E_MOTOR_BRAKE_HOLD
+ */
+void Drivetrain::setBrakeMode(pros::motor_brake_mode_e_t left, pros::motor_brake_mode_e_t right){
+  frontLeft.set_brake_mode(left);
+  backLeft.set_brake_mode(left);
+  frontRight.set_brake_mode(right);
+  backRight.set_brake_mode(right);
+}
+/**
+ * Set the current limit of a base motor (refer to currentBudget.hpp).
+ * @param motor
+ * which base motor
+ *
+ * @param limit
+ * current limit in mA (0 to 2500)
+ */
+void Drivetrain::setCurrentLimit(BaseMotor motor, int32_t limit){
+  getMotor(motor).set_current_limit(limit);
+}
+/**
+ * Tare the integrated encoders of all base motors.
+ */
+void Drivetrain::tare(){
+  frontLeft.tare_position();
+  frontRight.tare_position();
+  backLeft.tare_position();
+  backRight.tare_position();
+}
+/**
+ * Integrated encoder position of a side: the average of its motors, or the one that responds
+ * (a motor reads PROS_ERR_F, infinity, while unplugged).
+ * @param front, back
+ * the motors of the side
+ *
+ * @return
+ * position in encoder degrees (not finite if neither motor responds)
+ */
+double sidePosition(const pros::Motor &front, const pros::Motor &back){
+  double positionFront = front.get_position(), positionBack = back.get_position();
+  if(!std::isfinite(positionFront)) return positionBack;
+  if(!std::isfinite(positionBack)) return positionFront;
+  return (positionFront + positionBack)/2;
+}
+/**
+ * @return
+ * average integrated encoder position of the left side (encoder degrees, refer to sidePosition)
+ */
+double Drivetrain::getLeftPosition() const{
+  return sidePosition(frontLeft, backLeft);
+}
+/**
+ * @return
+ * average integrated encoder position of the right side (encoder degrees, refer to sidePosition)
+ */
+double Drivetrain::getRightPosition() const{
+  return sidePosition(frontRight, backRight);
+}
+/**
+ * Raw encoder counts of a side as the motors sampled them, with the device time of the sample
+ * (the smart motors update their data on their own timeline, not when it is read).
+ * @param front
+ * front motor of the side (gives the time)
+ *
+ * @param back
+ * back motor of the side
+ *
+ * @param timestamp
+ * set to the device time of the front motor's sample (ms)
+ *
+ * @return
+ * sum of the counts of both motors, PROS_ERR if either does not respond
+ */
+int32_t sideRawPosition(const pros::Motor &front, const pros::Motor &back, uint32_t *timestamp){
+  uint32_t backTime;
+  int32_t countFront = front.get_raw_position(timestamp), countBack = back.get_raw_position(&backTime);
+  if(countFront == PROS_ERR || countBack == PROS_ERR) return PROS_ERR;
+  return countFront + countBack;
+}
+/**
+ * refer to sideRawPosition
+ */
+int32_t Drivetrain::getLeftRawPosition(uint32_t *timestamp) const{
+  return sideRawPosition(frontLeft, backLeft, timestamp);
+}
+/**
+ * refer to sideRawPosition
+ */
+int32_t Drivetrain::getRightRawPosition(uint32_t *timestamp) const{
+  return sideRawPosition(frontRight, backRight, timestamp);
+}
+/**
+ * @return
+ * voltage applied to the left side in mV (front motor)
+ */
+int32_t Drivetrain::getLeftVoltage() const{
+  return frontLeft.get_voltage();
+}
+/**
+ * @return
+ * voltage applied to the right side in mV (front motor)
+ */
+int32_t Drivetrain::getRightVoltage() const{
+  return frontRight.get_voltage();
+}
+/**
+ * @param motor
+ * which base motor
+ *
+ * @return
+ * the motor
+ */
+const pros::Motor &Drivetrain::getMotor(BaseMotor motor) const{
+  switch(motor){
+    case BASE_FRONT_LEFT: return frontLeft;
+    case BASE_BACK_LEFT: return backLeft;
+    case BASE_FRONT_RIGHT: return frontRight;
+    default: return backRight;
+  }
+}
+/**
+ * @param motor
+ * which base motor
+ *
+ * @return
+ * current draw of the motor in mA
+ */
+int32_t Drivetrain::getCurrent(BaseMotor motor) const{
+  return getMotor(motor).get_current_draw();
+}
+/**
+ * @param motor
+ * which base motor
+ *
+ * @return
+ * integrated encoder position of the motor (encoder degrees)
+ */
+double Drivetrain::getPosition(BaseMotor motor) const{
+  return getMotor(motor).get_position();
+}
+/**
+ * @param motor
+ * which base motor
+ *
+ * @return
+ * velocity of the motor in rpm (positive: driving forward)
+ */
+double Drivetrain::getVelocity(BaseMotor motor) const{
+  return getMotor(motor).get_actual_velocity();
+}
+/**
+ * @param motor
+ * which base motor
+ *
+ * @return
+ * temperature of the motor in C (reported in 5 C steps)
+ */
+double Drivetrain::getTemperature(BaseMotor motor) const{
+  return getMotor(motor).get_temperature();
+}
+/**
+ * @param motor
+ * which base motor
+ *
+ * @return
+ * whether the motor reports over temperature (the firmware limits its current)
+ */
+bool Drivetrain::isOverTemp(BaseMotor motor) const{
+  return getMotor(motor).is_over_temp() == 1;
+}
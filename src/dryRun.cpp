@@ -0,0 +1,250 @@
+/**
+ * Dry run functions:
+ * - Drivetrain model of the sides, stepped by the odometry task from the held motor commands
+ * - Sensor frames of the model (tracking wheels, motor encoders and IMU), continuing the last real frame
+ * - Log of the motions and waits of the routine (from the timeline events), and its printout
+ */
+#include "main.h"
+/**
+ * Model state (written by the odometry task only, once the run started)
+ * start: the last real sensor frame before the run, which the model frames continue
+ * left, right: feedforward of the sides; geometry: tracking wheel geometry
+ * posL, posR, velL, velR: travel (inches) and speed (in/s) of the base wheels of each side
+ * trackL, trackR: travel of the tracking wheels (inches); angle: turn (radians, clockwise)
+ * accel: forward acceleration of the latest step (in/s^2)
+ * time: micros() of the latest step
+ */
+struct DryRunModel{
+  SensorFrame start;
+  BaseFeedforward left, right;
+  OdometryGeometry geometry;
+  double posL, posR, velL, velR;
+  double trackL, trackR, angle;
+  double accel;
+  uint64_t time;
+};
+DryRunModel dryRunModel;
+std::atomic<bool> dryRunActive(false);
+/** latest frame of the model, read by readSensorFrame during the run */
+SeqLock<SensorFrame> dryRunFrame;
+/** the log: actions by start, and the motion and the wait of the routine being logged (-1: none) */
+DryRunAction dryRunActions[DRY_RUN_ACTIONS];
+std::atomic<int> dryRunActionCount(0), openMotion(-1), openWait(-1);
+/**
+ * Start a dry run: hold the motors at 0 and switch the base sensors to the model, from the last real frame at rest.
+ */
+void startDryRun(){
+  if(dryRunActive) return;
+  BaseModel model = getBaseModel();
+  dryRunModel = {};
+  dryRunModel.start = getSensorFrame();
+  dryRunModel.left = model.left;
+  dryRunModel.right = model.right;
+  dryRunModel.geometry = getOdometryGeometry();
+  dryRunModel.time = micros();
+  dryRunFrame.write(dryRunModel.start);
+  dryRunActionCount = 0;
+  openMotion = openWait = -1;
+  holdMotorOutputs(true);
+  dryRunActive = true;
+}
+/**
+ * End the dry run: the base sensors are read again and the motors take their next command.
+ */
+void stopDryRun(){
+  if(!dryRunActive) return;
+  dryRunActive = false;
+  holdMotorOutputs(false);
+}
+/**
+ * @return
+ * whether a dry run is on
+ */
+bool isDryRun(){
+  return dryRunActive.load(std::memory_order_relaxed);
+}
+/**
+ * Power a side of the model is driven with.
+ * @param port
+ * front motor of the side
+ *
+ * @param side
+ * its feedforward
+ *
+ * @param vel
+ * its speed (in/s)
+ *
+ * @return
+ * the power of its held command (a velocity command as the motor's own loop would power it)
+ */
+double dryRunPower(uint8_t port, const BaseFeedforward &side, double vel){
+  MotorCommandMode mode;
+  int32_t value;
+  if(!getMotorCommand(port, mode, value)) return 0;
+  double power = 0;
+  if(mode == MOTOR_COMMAND_POWER) power = value;
+  else if(mode == MOTOR_COMMAND_VOLTAGE) power = value*127.0/12000;
+  else if(mode == MOTOR_COMMAND_VELOCITY){
+    double target = value*6*inPerMotorDeg;
+    power = (target > 0? side.ks : target < 0? -side.ks : 0) + side.kv*target + DRY_RUN_VELOCITY_KP*(target - vel);
+  }
+  return fmax(-127, fmin(127, power));
+}
+/**
+ * Step a side of the model: power = ks*sgn(v) + kv*v + ka*a, static friction holding it at rest.
+ * @param port
+ * front motor of the side
+ *
+ * @param side
+ * its feedforward
+ *
+ * @param vel, pos
+ * its speed (in/s) and travel (inches); updated
+ *
+ * @param dt
+ * step (s)
+ *
+ * @return
+ * its acceleration (in/s^2)
+ */
+double stepDryRunSide(uint8_t port, const BaseFeedforward &side, double &vel, double &pos, double dt){
+  double power = dryRunPower(port, side, vel), prev = vel;
+  if(vel == 0 && fabs(power) <= side.ks) return 0;
+  /** friction opposes the motion (at rest: the power), and stops a side rather than reverse it */
+  double friction = (vel != 0? vel : power) > 0? side.ks : -side.ks;
+  vel += (power - friction - side.kv*vel)/side.ka*dt;
+  if(vel*prev < 0 && fabs(power) <= side.ks) vel = 0;
+  pos += (prev + vel)/2*dt;
+  return (vel - prev)/dt;
+}
+/**
+ * Step the model to now and publish its sensor frame (the odometry task, before its sensor read).
+ */
+void stepDryRun(){
+  if(!dryRunActive) return;
+  DryRunModel &m = dryRunModel;
+  uint64_t now = micros();
+  while(m.time + DRY_RUN_STEP <= now){
+    const double dt = DRY_RUN_STEP/1e6;
+    double prevL = m.posL, prevR = m.posR;
+    double accelL = stepDryRunSide(FLPort, m.left, m.velL, m.posL, dt);
+    double accelR = stepDryRunSide(FRPort, m.right, m.velR, m.posR, dt);
+    double forward = (m.posL - prevL + m.posR - prevR)/2, turn = (m.posL - prevL - (m.posR - prevR))/motorBaseWidth;
+    m.trackL += forward + turn*m.geometry.baseWidth/2;
+    m.trackR += forward - turn*m.geometry.baseWidth/2;
+    m.angle += turn;
+    m.accel = (accelL + accelR)/2;
+    m.time += DRY_RUN_STEP;
+  }
+  /** the frame continues the last real one, so the control loop's motor targets hold across the switch */
+  SensorFrame frame = m.start;
+  frame.timestamp = m.time;
+  frame.encdL = m.start.encdL + lround(m.trackL/m.geometry.inPerDeg);
+  frame.encdR = m.start.encdR + lround(m.trackR/m.geometry.inPerDeg);
+  frame.motorL = m.start.motorL + m.posL/inPerMotorDeg;
+  frame.motorR = m.start.motorR + m.posR/inPerMotorDeg;
+  /** the raw count of a side is the sum of its two motors */
+  frame.rawL = m.start.rawL + lround(2*m.posL/inPerMotorDeg*DRIVE_COUNTS_PER_DEG);
+  frame.rawR = m.start.rawR + lround(2*m.posR/inPerMotorDeg*DRIVE_COUNTS_PER_DEG);
+  frame.motorTimeL = frame.motorTimeR = m.time/1000;
+  frame.imuRotation = m.start.imuRotation + m.angle*toDeg;
+  frame.imuValid = ODOM_USE_IMU;
+  /** IMU accelerations in g: x forward, y to the right (the centripetal one of a clockwise turn) */
+  frame.imuAccelX = m.accel/386.09;
+  frame.imuAccelY = (m.velL + m.velR)/2*(m.velL - m.velR)/motorBaseWidth/386.09;
+  frame.imuPitch = frame.imuRoll = 0;
+  dryRunFrame.write(frame);
+}
+/**
+ * @return
+ * the latest sensor frame of the model (readSensorFrame during a dry run)
+ */
+SensorFrame getDryRunFrame(){
+  return dryRunFrame.read();
+}
+/**
+ * Log a timeline event of the routine (recordTimeline, from any task, during a dry run): a motion starting or
+ * ending, a wait of the routine beginning or ending; other events are left out.
+ * @param type
+ * TimelineType of the event
+ *
+ * @param id, arg
+ * refer to TimelineType
+ *
+ * @param time
+ * micros() of the event (lower 32 bits)
+ */
+void logDryRunEvent(int type, int id, int arg, uint32_t time){
+  bool starts = type == TIMELINE_MOTION_START || type == TIMELINE_WAIT_BEGIN;
+  bool skipped = type == TIMELINE_MOTION_END && arg == TIMELINE_SKIPPED;
+  if(starts || skipped){
+    int slot = dryRunActionCount.fetch_add(1);
+    if(slot >= DRY_RUN_ACTIONS) return;
+    dryRunActions[slot] = {time, time, (uint8_t)(type == TIMELINE_WAIT_BEGIN? TIMELINE_WAIT_BEGIN : TIMELINE_MOTION_START),
+                           (uint8_t)id, (uint8_t)arg, skipped};
+    if(type == TIMELINE_MOTION_START) openMotion = slot;
+    else if(type == TIMELINE_WAIT_BEGIN) openWait = slot;
+    return;
+  }
+  int slot = type == TIMELINE_MOTION_END? openMotion.exchange(-1) : type == TIMELINE_WAIT_END? openWait.exchange(-1) : -1;
+  if(slot < 0) return;
+  dryRunActions[slot].end = time;
+  dryRunActions[slot].outcome = arg;
+  dryRunActions[slot].done = true;
+}
+/**
+ * Print the predicted timeline of the last dry run: per action its start and duration (seconds from the
+ * first action) and how it ended, then the total.
+ * @param name
+ * name of the routine
+ *
+ * @param total
+ * time from the start of the routine until its motions were done (ms)
+ */
+void printDryRun(const char *name, uint32_t total){
+  int count = std::min(dryRunActionCount.load(), DRY_RUN_ACTIONS);
+  uint32_t origin = count > 0? dryRunActions[0].start : 0;
+  printf("Dry run of %s: %d actions\n", name, dryRunActionCount.load());
+  for(int i = 0; i < count; i++){
+    const DryRunAction &action = dryRunActions[i];
+    bool motion = action.type == TIMELINE_MOTION_START;
+    const char *ending = !action.done? "not ended" : motion? timelineEndNames[action.outcome] : action.outcome? "timed out" : "done";
+    printf("%7.2f s %6.2f s  %-6s %-16s %s\n", (action.start - origin)/1e6, action.done? (action.end - action.start)/1e6 : 0.0,
+      motion? "motion" : "wait", motion? timelineMotionNames[action.id] : timelineWaitNames[action.id], ending);
+  }
+  PoseSnapshot pose = getPose();
+  printf("Predicted duration %.2f s, end (%.1f, %.1f, %.1f)\n", total/1000.0, pose.x, pose.y, pose.angle*toDeg);
+}
+/**
+ * Dry run a routine of the table (e.g. from opcontrol with DRY_RUN_BUTTON): the robot stays still while the
+ * routine runs on the model from the current pose, then the pose, the phase and the base mode are put back and
+ * the timeline is printed. Blocks for as long as the routine takes.
+ * @param id
+ * index into the routine table
+ *
+ * @return
+ * predicted duration of the routine (ms), 0 if there is no such routine
+ */
+uint32_t dryRunAuton(int id){
+  if(id < 0 || id >= getAutonCount()) return 0;
+  RobotPhase phase = getPhase();
+  BaseControlMode mode = getBaseControlMode();
+  PoseSnapshot before = getPose();
+  startDryRun();
+  enterPhase(PHASE_AUTON);
+  setBaseControlMode(BASE_MODE_AUTON);
+  uint64_t start = micros();
+  startMatchClock();
+  runAuton(id);
+  waitMotionQueue(DRY_RUN_TIMEOUT);
+  Timer timer;
+  while(!isBaseSettled() && !timer.passed(DRY_RUN_TIMEOUT)) delay(BASE_CONTROL_DT);
+  uint32_t total = (micros() - start)/1000;
+  printDryRun(getAutonName(id), total);
+  clearMotionQueue();
+  setBaseControlMode(mode);
+  enterPhase(phase);
+  stopDryRun();
+  setCoords(before.x, before.y, before.angle*toDeg);
+  return total;
+}
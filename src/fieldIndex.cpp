@@ -0,0 +1,189 @@
+/**
+ * Field index functions:
+ * - Field elements and their grid index, generated at compile time
+ * - Nearest element of a type to a point (a cell's candidates)
+ * - Elements within a range, and the nearest one in front of the robot (the cells the range covers)
+ */
+#include "main.h"
+/** the goals of the field (Change Up: corners, wall centres and field centre) */
+constexpr FieldElement fieldElements[FIELD_ELEMENTS] = {
+  {FIELD_GOAL, 6, 6}, {FIELD_GOAL, 6, 72}, {FIELD_GOAL, 6, 138},
+  {FIELD_GOAL, 72, 6}, {FIELD_GOAL, 72, 72}, {FIELD_GOAL, 72, 138},
+  {FIELD_GOAL, 138, 6}, {FIELD_GOAL, 138, 72}, {FIELD_GOAL, 138, 138}
+};
+/**
+ * @param position
+ * inches from the field's bottom left corner, along a side
+ *
+ * @return
+ * the cell of the grid along that side (the edge cells take the positions off the field)
+ */
+constexpr int fieldCell(double position){
+  int cell = (int)(position/FIELD_INDEX_CELL);
+  return cell < 0? 0 : cell >= FIELD_INDEX_GRID? FIELD_INDEX_GRID - 1 : cell;
+}
+/**
+ * @return
+ * the square of the distance from a point to the nearest (farthest false) or the farthest (true) point of an
+ * interval, along one side
+ */
+constexpr double intervalSquare(double position, double low, double high, bool farthest){
+  double gap = farthest? (position - low > high - position? position - low : high - position)
+                       : position < low? low - position : position > high? position - high : 0;
+  return gap*gap;
+}
+/**
+ * Generate the index at compile time.
+ * @return
+ * the index
+ */
+constexpr FieldIndex makeFieldIndex(){
+  FieldIndex index = {};
+  const int cells = FIELD_INDEX_GRID*FIELD_INDEX_GRID;
+  /** elements by cell: counted, then placed after the elements of the cells before */
+  for(int i = 0; i < FIELD_ELEMENTS; i++){
+    index.cellStart[fieldCell(fieldElements[i].y)*FIELD_INDEX_GRID + fieldCell(fieldElements[i].x) + 1]++;
+  }
+  for(int c = 0; c < cells; c++) index.cellStart[c + 1] += index.cellStart[c];
+  uint8_t placed[cells] = {};
+  for(int i = 0; i < FIELD_ELEMENTS; i++){
+    int c = fieldCell(fieldElements[i].y)*FIELD_INDEX_GRID + fieldCell(fieldElements[i].x);
+    index.cellElements[index.cellStart[c] + placed[c]++] = i;
+  }
+  /** nearest candidates: no element can be nearer to a point of the cell than the closest one's farthest corner */
+  for(int type = 0; type < FIELD_ELEMENT_TYPES; type++){
+    for(int c = 0; c < cells; c++){
+      double lowX = (c%FIELD_INDEX_GRID)*FIELD_INDEX_CELL, lowY = (c/FIELD_INDEX_GRID)*FIELD_INDEX_CELL;
+      double highX = lowX + FIELD_INDEX_CELL, highY = lowY + FIELD_INDEX_CELL;
+      double bound = -1;
+      for(int i = 0; i < FIELD_ELEMENTS; i++){
+        if(fieldElements[i].type != type) continue;
+        double farthest = intervalSquare(fieldElements[i].x, lowX, highX, true)
+          + intervalSquare(fieldElements[i].y, lowY, highY, true);
+        if(bound < 0 || farthest < bound) bound = farthest;
+      }
+      int count = 0;
+      for(int i = 0; i < FIELD_ELEMENTS; i++){
+        if(fieldElements[i].type != type) continue;
+        double nearest = intervalSquare(fieldElements[i].x, lowX, highX, false)
+          + intervalSquare(fieldElements[i].y, lowY, highY, false);
+        if(nearest > bound) continue;
+        if(count == FIELD_INDEX_CANDIDATES) index.overflow = true;
+        else index.nearest[type][c][count++] = i;
+      }
+      for(; count < FIELD_INDEX_CANDIDATES; count++) index.nearest[type][c][count] = FIELD_ELEMENTS;
+    }
+  }
+  return index;
+}
+constexpr FieldIndex fieldIndex = makeFieldIndex();
+static_assert(!fieldIndex.overflow, "a cell has too many nearest candidates: raise FIELD_INDEX_CANDIDATES or shrink FIELD_INDEX_CELL");
+static_assert(FIELD_ELEMENTS < 256, "elements are indexed by a uint8_t");
+/**
+ * Fill a hit.
+ * @param i
+ * index of the element
+ *
+ * @param x, y
+ * point of the query (odometry coordinates)
+ */
+HOT_PATH void fieldHit(int i, double x, double y, FieldHit &hit){
+  hit.element = i;
+  hit.x = fieldElements[i].x - FIELD_ORIGIN_X;
+  hit.y = fieldElements[i].y - FIELD_ORIGIN_Y;
+  hit.distance = hypot(hit.x - x, hit.y - y);
+}
+/**
+ * Nearest element of a type to a point (exact on the field; a point off it takes the candidates of the edge cell).
+ * @param type
+ * type of the element
+ *
+ * @param x, y
+ * the point in inches (odometry coordinates)
+ *
+ * @param hit
+ * set to the element
+ *
+ * @return
+ * false if the field has no element of the type
+ */
+HOT_PATH bool nearestFieldElement(FieldElementType type, double x, double y, FieldHit &hit){
+  if(type < 0 || type >= FIELD_ELEMENT_TYPES) return false;
+  const uint8_t *candidates = fieldIndex.nearest[type][fieldCell(y + FIELD_ORIGIN_Y)*FIELD_INDEX_GRID + fieldCell(x + FIELD_ORIGIN_X)];
+  bool found = false;
+  for(int k = 0; k < FIELD_INDEX_CANDIDATES && candidates[k] < FIELD_ELEMENTS; k++){
+    FieldHit candidate;
+    fieldHit(candidates[k], x, y, candidate);
+    if(!found || candidate.distance < hit.distance) hit = candidate;
+    found = true;
+  }
+  return found;
+}
+/**
+ * Elements of a type within a range of a point.
+ * @param type
+ * type of the elements
+ *
+ * @param x, y
+ * the point in inches (odometry coordinates)
+ *
+ * @param range
+ * largest distance in inches
+ *
+ * @param hits
+ * set to the elements found, in the order of the index (not by distance)
+ *
+ * @param size
+ * size of hits
+ *
+ * @return
+ * number of elements found (at most size)
+ */
+HOT_PATH int fieldElementsInRange(FieldElementType type, double x, double y, double range, FieldHit *hits, int size){
+  int count = 0;
+  int firstX = fieldCell(x + FIELD_ORIGIN_X - range), lastX = fieldCell(x + FIELD_ORIGIN_X + range);
+  int firstY = fieldCell(y + FIELD_ORIGIN_Y - range), lastY = fieldCell(y + FIELD_ORIGIN_Y + range);
+  for(int cy = firstY; cy <= lastY; cy++){
+    for(int cx = firstX; cx <= lastX; cx++){
+      int c = cy*FIELD_INDEX_GRID + cx;
+      for(int k = fieldIndex.cellStart[c]; k < fieldIndex.cellStart[c + 1] && count < size; k++){
+        int i = fieldIndex.cellElements[k];
+        if(fieldElements[i].type != type) continue;
+        fieldHit(i, x, y, hits[count]);
+        if(hits[count].distance <= range) count++;
+      }
+    }
+  }
+  return count;
+}
+/**
+ * Nearest element of a type in front of the robot.
+ * @param type
+ * type of the element
+ *
+ * @param x, y, angle
+ * pose of the robot (odometry coordinates, heading in radians)
+ *
+ * @param range
+ * largest distance in inches
+ *
+ * @param halfAngle
+ * largest bearing from the heading in radians, either side
+ *
+ * @param hit
+ * set to the element
+ *
+ * @return
+ * false if there is none in the range and the angle
+ */
+HOT_PATH bool fieldElementAhead(FieldElementType type, double x, double y, double angle, double range, double halfAngle, FieldHit &hit){
+  FieldHit hits[FIELD_ELEMENTS];
+  int count = fieldElementsInRange(type, x, y, range, hits, FIELD_ELEMENTS);
+  bool found = false;
+  for(int i = 0; i < count; i++){
+    if(fabs(angleDiff(atan2(hits[i].x - x, hits[i].y - y), angle)) > halfAngle) continue;
+    if(!found || hits[i].distance < hit.distance) hit = hits[i];
+    found = true;
+  }
+  return found;
+}
@@ -0,0 +1,231 @@
+/**
+ * Flight recorder:
+ * - Recording of control frames into double buffers (control tasks, never block)
+ * - Block writer task (opens the run files, writes full buffers and the timelines)
+ */
+#include "main.h"
+/**
+ * Two block buffers: the control task fills buffers[activeBuffer]; a full buffer is handed
+ * to the writer task (pendingBuffer) and the other one becomes active.
+ * If the writer still holds the other buffer, the record is dropped instead of waiting.
+ */
+struct RecorderBuffer{
+  uint8_t data[RECORDER_BLOCK];
+  int used;
+};
+RecorderBuffer recorderBuffers[2];
+int activeBuffer = 0;
+std::atomic<int> pendingBuffer(-1);
+/**
+ * recording: records are accepted (set by startRecorder, cleared by stopRecorder)
+ * producerBusy: a control task is inside recordFlight (lets the writer take over the active buffer)
+ * startRequested & stopRequested: requests handled by the writer task
+ */
+std::atomic<bool> recording(false), producerBusy(false);
+std::atomic<bool> startRequested(false), stopRequested(false);
+std::atomic<uint32_t> recorderDrops(0);
+/**
+ * Delta coder state (the recording task only; reset by the writer task while nothing records):
+ * words of the previous record and the records since the last keyframe (0: the next one is a keyframe)
+ */
+uint64_t recorderPrev[RECORDER_WORDS];
+int recorderSinceKeyframe = 0;
+pros::task_t recorderTask = NULL;
+/** wake the writer task */
+void wakeRecorder(){
+  if(recorderTask != NULL) pros::c::task_notify(recorderTask);
+}
+/**
+ * Start recording into a new file. The file is opened by the writer task.
+ */
+void startRecorder(){
+  startRequested = true;
+  wakeRecorder();
+}
+/**
+ * Stop recording. The writer task writes what is buffered and closes the file.
+ */
+void stopRecorder(){
+  stopRequested = true;
+  wakeRecorder();
+}
+/**
+ * Record one control frame. Only the baseControl task records (RECORDER_DRIVER frames in
+ * BASE_MODE_DRIVER). Never blocks: codes the record into the active buffer.
+ * @param mode
+ * RECORDER_AUTON or RECORDER_DRIVER
+ *
+ * @param frame
+ * the control frame
+ *
+ * @return
+ * false if the recorder is off or the record was dropped
+ */
+bool recordFlight(RecorderMode mode, const BaseControlFrame &frame){
+  /** announce the access before checking recording, so stopRecorder never races it */
+  producerBusy = true;
+  if(!recording){
+    producerBusy = false;
+    return false;
+  }
+  RecorderBuffer *buffer = &recorderBuffers[activeBuffer];
+  if(buffer->used + (int)RECORDER_MAX_CODED > RECORDER_BLOCK){
+    if(pendingBuffer.load() != -1){
+      /** the writer is still busy with the other buffer; the next record must not depend on this one */
+      recorderDrops++;
+      recorderSinceKeyframe = 0;
+      producerBusy = false;
+      return false;
+    }
+    pendingBuffer = activeBuffer;
+    activeBuffer = 1 - activeBuffer;
+    buffer = &recorderBuffers[activeBuffer];
+    buffer->used = 0;
+    wakeRecorder();
+  }
+  FlightRecord record = {(uint32_t)mode, frame, getPose(), getPoseCorrections()};
+  uint64_t words[RECORDER_WORDS];
+  memcpy(words, &record, sizeof(record));
+  bool keyframe = recorderSinceKeyframe == 0;
+  if(keyframe) memset(recorderPrev, 0, sizeof(recorderPrev));
+  recorderSinceKeyframe = (recorderSinceKeyframe + 1) % RECORDER_KEYFRAME_INTERVAL;
+  uint8_t *coded = buffer->data + buffer->used;
+  int length = deltaEncode(words, recorderPrev, RECORDER_WORDS, coded + 3);
+  coded[0] = keyframe ? RECORDER_KEYFRAME : RECORDER_DELTA;
+  coded[1] = length & 0xFF;
+  coded[2] = length >> 8;
+  buffer->used += 3 + length;
+  producerBusy = false;
+  return true;
+}
+/**
+ * @return
+ * number of records dropped because the card was too slow
+ */
+uint32_t getRecorderDrops(){
+  return recorderDrops;
+}
+/**
+ * Read the next record of a run file (after its header). Deltas before the first keyframe,
+ * and records of another kind, are skipped.
+ * @param reader
+ * the file and the decoding state (start with synced false)
+ *
+ * @param record
+ * set to the record
+ *
+ * @return
+ * false at the end of the file (or a truncated record)
+ */
+bool readFlightRecord(FlightRecordReader &reader, FlightRecord &record){
+  uint8_t coded[RECORDER_MAX_CODED];
+  while(fread(coded, 1, 3, reader.file) == 3){
+    int length = coded[1] | coded[2] << 8;
+    if(length > (int)RECORDER_MAX_CODED - 3 || fread(coded + 3, 1, length, reader.file) != (size_t)length) return false;
+    if(coded[0] == RECORDER_KEYFRAME){
+      memset(reader.prev, 0, sizeof(reader.prev));
+      reader.synced = true;
+    }
+    else if(coded[0] != RECORDER_DELTA || !reader.synced) continue;
+    if(deltaDecode(coded + 3, length, reader.prev, RECORDER_WORDS) != length){
+      reader.synced = false;
+      continue;
+    }
+    memcpy(&record, reader.prev, sizeof(record));
+    return true;
+  }
+  return false;
+}
+/**
+ * Open the next free run file (RECORDER_PATH) and write its header.
+ * @param run
+ * set to the number of the file
+ *
+ * @return
+ * the file, or NULL if there is no card
+ */
+FILE *openRunFile(int &run){
+  if(!usd::is_installed()) return NULL;
+  char path[64];
+  for(int i = 0; i < 1000; i++){
+    snprintf(path, sizeof(path), RECORDER_PATH, i);
+    FILE *existing = fopen(path, "rb");
+    if(existing != NULL){
+      fclose(existing);
+      continue;
+    }
+    FILE *file = fopen(path, "wb");
+    if(file == NULL) return NULL;
+    RecorderFileHeader header = {RECORDER_FILE_MAGIC, RECORDER_FILE_VERSION, sizeof(FlightRecord), getOdometryGeometry()};
+    fwrite(&header, sizeof(header), 1, file);
+    run = i;
+    return file;
+  }
+  return NULL;
+}
+/**
+ * Write a buffer to the file and make it persistent
+ * (the robot may be switched off without stopRecorder).
+ */
+void writeRecorderBuffer(FILE *file, RecorderBuffer &buffer){
+  if(file != NULL && buffer.used > 0){
+    fwrite(buffer.data, 1, buffer.used, file);
+    fflush(file);
+  }
+  buffer.used = 0;
+}
+/**
+ * Close the timeline of a run and, with TIMELINE_EXPORT, export its trace (refer to timeline.hpp).
+ */
+void closeRunTimeline(FILE *timelineFile, int run){
+  if(timelineFile == NULL) return;
+  closeTimelineFile(timelineFile);
+  if(TIMELINE_EXPORT){
+    char path[64], tracePath[64];
+    snprintf(path, sizeof(path), TIMELINE_PATH, run);
+    snprintf(tracePath, sizeof(tracePath), TIMELINE_TRACE_PATH, run);
+    exportTimeline(path, tracePath);
+  }
+}
+/**
+ * Write the recorder buffers and the timeline to the microSD card and handle start/stop requests.
+ * The only task that touches the card for the recorder, so fwrite latency stays here.
+ * Run at low priority.
+ */
+void flightRecorder(void * ignore){
+  recorderTask = pros::c::task_get_current();
+  FILE *file = NULL, *timelineFile = NULL;
+  int run = 0;
+  startTaskTiming(TIMING_RECORDER, RECORDER_DT, false);
+  while(true){
+    pros::c::task_notify_take(true, RECORDER_DT);
+    beginTaskIteration(TIMING_RECORDER);
+    /** write the buffer handed over by the control task */
+    int pending = pendingBuffer.load();
+    if(pending != -1){
+      writeRecorderBuffer(file, recorderBuffers[pending]);
+      pendingBuffer = -1;
+    }
+    if(timelineFile != NULL) writeTimeline(timelineFile);
+    if(stopRequested.exchange(false) || startRequested.load()){
+      /** stop the producer, then take over its active buffer once it has left recordFlight */
+      recording = false;
+      while(producerBusy) pros::delay(1);
+      pending = pendingBuffer.exchange(-1);
+      if(pending != -1) writeRecorderBuffer(file, recorderBuffers[pending]);
+      writeRecorderBuffer(file, recorderBuffers[activeBuffer]);
+      if(file != NULL) fclose(file);
+      file = NULL;
+      closeRunTimeline(timelineFile, run);
+      timelineFile = NULL;
+    }
+    if(startRequested.exchange(false)){
+      file = openRunFile(run);
+      recorderBuffers[0].used = recorderBuffers[1].used = 0;
+      recorderSinceKeyframe = 0;
+      recording = file != NULL;
+      if(file != NULL) timelineFile = openTimelineFile(run);
+    }
+    endTaskIteration(TIMING_RECORDER);
+  }
+}
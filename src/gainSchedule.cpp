@@ -0,0 +1,112 @@
+/**
+ * Gain schedule functions:
+ * - Schedule tables of the movement types
+ * - Lookup by movement size
+ * - Battery voltage compensation
+ * - Saving & loading of the schedule on the microSD card
+ */
+#include "main.h"
+/** schedule tables (refer to MOVE_GAIN_SCHEDULE & TURN_GAIN_SCHEDULE) */
+GainBand moveGains[GAIN_BANDS] = MOVE_GAIN_SCHEDULE, turnGains[GAIN_BANDS] = TURN_GAIN_SCHEDULE;
+/**
+ * Replace the schedule of a movement type (e.g. after tuning in the pits).
+ * Call when no movement is being started.
+ * @param turn
+ * true: turns, false: moves
+ *
+ * @param bands
+ * GAIN_BANDS bands, by increasing maxSize
+ */
+void setGainSchedule(bool turn, const GainBand *bands){
+  GainBand *table = turn? turnGains : moveGains;
+  for(int i = 0; i < GAIN_BANDS; i++) table[i] = bands[i];
+}
+/**
+ * Change the gains of the band a movement size fits in.
+ * @param turn
+ * true: turns, false: moves
+ *
+ * @param size
+ * movement size (moves: inches of travel, turns: degrees)
+ *
+ * @param kp, kd
+ * new gains of the band
+ */
+void setGainBand(bool turn, double size, double kp, double kd){
+  GainBand *table = turn? turnGains : moveGains;
+  int i = 0;
+  while(i < GAIN_BANDS - 1 && fabs(size) > table[i].maxSize) i++;
+  table[i].kp = kp;
+  table[i].kd = kd;
+}
+/**
+ * Load the schedule from the microSD card (GAIN_FILE_PATH).
+ * The schedule is only replaced if every band is read.
+ * @return
+ * false if there is no card, no file, or the file is incomplete
+ */
+bool loadGainSchedule(){
+  if(!usd::is_installed()) return false;
+  ConfigFile file;
+  if(!file.open(GAIN_FILE_PATH)) return false;
+  /** lines: move or turn, then maxSize, kp and kd of the band */
+  GainBand bands[2*GAIN_BANDS];
+  int counts[2] = {0, 0};
+  ConfigEntry entry;
+  while(file.next(entry)){
+    bool turn = entry.key == "turn";
+    double numbers[3];
+    if((!turn && entry.key != "move") || counts[turn] == GAIN_BANDS || !entry.getNumbers(numbers, 3)) return false;
+    bands[turn*GAIN_BANDS + counts[turn]++] = {numbers[0], numbers[1], numbers[2]};
+  }
+  if(file.failed() || counts[0] < GAIN_BANDS || counts[1] < GAIN_BANDS) return false;
+  setGainSchedule(false, bands);
+  setGainSchedule(true, bands + GAIN_BANDS);
+  return true;
+}
+/**
+ * Save the schedule to the microSD card (GAIN_FILE_PATH), e.g. after autotuning.
+ * @return
+ * false if there is no card or the file cannot be written
+ */
+bool saveGainSchedule(){
+  if(!usd::is_installed()) return false;
+  FILE *file = fopen(GAIN_FILE_PATH, "w");
+  if(file == NULL) return false;
+  for(int i = 0; i < GAIN_BANDS; i++) fprintf(file, "move %g %g %g\n", moveGains[i].maxSize, moveGains[i].kp, moveGains[i].kd);
+  for(int i = 0; i < GAIN_BANDS; i++) fprintf(file, "turn %g %g %g\n", turnGains[i].maxSize, turnGains[i].kp, turnGains[i].kd);
+  fclose(file);
+  return true;
+}
+/**
+ * Scale of the gains for the current battery voltage (refer to GAIN_BATTERY_COMP).
+ * @return
+ * GAIN_BATTERY_NOMINAL / battery voltage within the scale limits (1 if off or the reading fails)
+ */
+double getBatteryGainScale(){
+  if(!GAIN_BATTERY_COMP) return 1;
+  int32_t voltage = pros::battery::get_voltage();
+  if(voltage <= 0 || voltage == PROS_ERR) return 1;
+  return fmax(GAIN_BATTERY_MIN_SCALE, fmin(GAIN_BATTERY_MAX_SCALE, (double)GAIN_BATTERY_NOMINAL/voltage));
+}
+/**
+ * Look up the gains of a movement.
+ * @param turn
+ * true: turn, false: move
+ *
+ * @param size
+ * size of the movement (moves: inches of travel, turns: degrees; sign ignored)
+ *
+ * @return
+ * gains of the band the movement fits in, battery compensated (maxSize is the band's)
+ */
+GainBand getScheduledGains(bool turn, double size){
+  const GainBand *table = turn? turnGains : moveGains;
+  int i = 0;
+  while(i < GAIN_BANDS - 1 && fabs(size) > table[i].maxSize) i++;
+  GainBand gains = table[i];
+  double scale = getBatteryGainScale();
+  gains.kp *= scale;
+  gains.kd *= scale;
+  return gains;
+}
@@ -0,0 +1,129 @@
+/**
+ * GainTuner functions:
+ * - Test movement & scoring
+ * - Particle swarm search over kP & kD
+ * - Tuning run of the base (moves & turns), saved to the gain schedule file
+ */
+#include "main.h"
+/**
+ * One dimension of a particle: position, velocity and the particle's best position
+ */
+struct TunerParticle{
+  double pos, vel, best;
+};
+/**
+ * Random number in a range.
+ * @return
+ * uniform random number in [min, max]
+ */
+double tunerRandom(double min, double max){
+  return min + (max - min)*rand()/RAND_MAX;
+}
+/**
+ * Initialization of a GainTuner.
+ * @param turn
+ * true: tune turns (baseTurnRelative), false: moves (baseMove)
+ *
+ * @param size
+ * test movement (moves: inches, turns: degrees); the gains go to the band of this size
+ *
+ * @param kPMin, kPMax, kDMin, kDMax
+ * search bounds of the gains
+ *
+ * @param iterations (optional)
+ * number of swarm iterations
+ *
+ * @param particles (optional)
+ * number of particles (at most TUNER_MAX_PARTICLES)
+ */
+GainTuner::GainTuner(bool turn, double size, double kPMin, double kPMax, double kDMin, double kDMax, int iterations, int particles)
+  : turn(turn), size(size), kPMin(kPMin), kPMax(kPMax), kDMin(kDMin), kDMax(kDMax), iterations(iterations),
+    particles(particles < TUNER_MAX_PARTICLES? particles : TUNER_MAX_PARTICLES){}
+/**
+ * Run one test movement and score it.
+ * @param kp, kd
+ * gains of the movement
+ *
+ * @param size
+ * movement (moves: inches, turns: degrees); negative to come back
+ *
+ * @return
+ * TUNER_K_SETTLE * settle time (s) + TUNER_K_OVERSHOOT * overshoot (in)
+ */
+double GainTuner::runTest(double kp, double kd, double size){
+  if(turn) baseTurnRelative(size, kp, kd);
+  else baseMove(size, kp, kd);
+  /** direction of each side towards its target (a turn drives the sides apart) */
+  double dirL = size > 0? 1 : -1, dirR = turn? -dirL : dirL;
+  Timer timer;
+  double overshoot = 0;
+  while(!isBaseSettled() && !timer.passed(TUNER_TIMEOUT)){
+    delay(BASE_CONTROL_DT);
+    SensorFrame sensors = getSensorFrame();
+    double targetL, targetR;
+    getBaseTargets(targetL, targetR);
+    overshoot = fmax(overshoot, fmax(dirL*(sensors.motorL - targetL), dirR*(sensors.motorR - targetR))*inPerDeg);
+  }
+  double settleTime = isBaseSettled()? timer.elapsed()/1000.0 : TUNER_TIMEOUT/1000.0;
+  return TUNER_K_SETTLE*settleTime + TUNER_K_OVERSHOOT*overshoot;
+}
+/**
+ * Search the gains: every particle runs the test movement out and back with its gains,
+ * then moves towards its own and the swarm's best gains.
+ * @return
+ * best gains found (maxSize: the test movement size)
+ */
+GainBand GainTuner::autotune(){
+  TunerParticle kp[TUNER_MAX_PARTICLES], kd[TUNER_MAX_PARTICLES];
+  double bestScore[TUNER_MAX_PARTICLES];
+  double swarmKP = (kPMin + kPMax)/2, swarmKD = (kDMin + kDMax)/2, swarmScore = INFINITY;
+  for(int i = 0; i < particles; i++){
+    kp[i] = {tunerRandom(kPMin, kPMax), tunerRandom(-1, 1)*(kPMax - kPMin)/4, 0};
+    kd[i] = {tunerRandom(kDMin, kDMax), tunerRandom(-1, 1)*(kDMax - kDMin)/4, 0};
+    bestScore[i] = INFINITY;
+  }
+  for(int iteration = 0; iteration < iterations; iteration++){
+    for(int i = 0; i < particles; i++){
+      double score = runTest(kp[i].pos, kd[i].pos, size) + runTest(kp[i].pos, kd[i].pos, -size);
+      if(score < bestScore[i]){
+        bestScore[i] = score;
+        kp[i].best = kp[i].pos;
+        kd[i].best = kd[i].pos;
+      }
+      if(score < swarmScore){
+        swarmScore = score;
+        swarmKP = kp[i].pos;
+        swarmKD = kd[i].pos;
+      }
+    }
+    for(int i = 0; i < particles; i++){
+      kp[i].vel = TUNER_INERTIA*kp[i].vel + TUNER_CONF_SELF*tunerRandom(0, 1)*(kp[i].best - kp[i].pos)
+                + TUNER_CONF_SWARM*tunerRandom(0, 1)*(swarmKP - kp[i].pos);
+      kd[i].vel = TUNER_INERTIA*kd[i].vel + TUNER_CONF_SELF*tunerRandom(0, 1)*(kd[i].best - kd[i].pos)
+                + TUNER_CONF_SWARM*tunerRandom(0, 1)*(swarmKD - kd[i].pos);
+      kp[i].pos = fmax(kPMin, fmin(kPMax, kp[i].pos + kp[i].vel));
+      kd[i].pos = fmax(kDMin, fmin(kDMax, kd[i].pos + kd[i].vel));
+    }
+    printf("Tuner %s iteration %d: kP %.3f kD %.3f score %.3f\n", turn? "turn" : "move", iteration, swarmKP, swarmKD, swarmScore);
+  }
+  GainBand best = {size, swarmKP, swarmKD};
+  return best;
+}
+/**
+ * Tune the moves (TUNER_MOVE_SIZE) and the turns (TUNER_TURN_SIZE) of the base, put the gains
+ * in their bands of the gain schedule and save the schedule for the next boot.
+ * The search bounds are a quarter to twice the current gains of the bands.
+ * The test movements run at the current battery voltage, so the battery compensation is taken
+ * out of the best gains before they are saved (refer to GAIN_BATTERY_COMP).
+ */
+void autotuneBase(){
+  for(int turn = 0; turn <= 1; turn++){
+    double size = turn? TUNER_TURN_SIZE : TUNER_MOVE_SIZE;
+    GainBand current = getScheduledGains(turn, size);
+    GainTuner tuner(turn, size, current.kp/4, current.kp*2, current.kd/4, current.kd*2);
+    GainBand best = tuner.autotune();
+    double scale = getBatteryGainScale();
+    setGainBand(turn, size, best.kp/scale, best.kd/scale);
+  }
+  saveGainSchedule();
+}
@@ -0,0 +1,67 @@
+/**
+ * ImpactDetector functions:
+ * - Impact rule setting
+ * - Collision detection (jerk and unexplained horizontal acceleration)
+ * - Tip detection (tilt, time beyond it)
+ */
+#include "main.h"
+/**
+ * Default initialization of an ImpactDetector: the default impact rule.
+ */
+ImpactDetector::ImpactDetector(){
+  ImpactRule defaultRule = DEFAULT_IMPACT_RULE;
+  setRule(defaultRule);
+}
+/**
+ * Change the impact rule. Restarts the detection.
+ * @param rule
+ * the new impact rule
+ */
+void ImpactDetector::setRule(const ImpactRule &rule){
+  this->rule = rule;
+  reset();
+}
+/**
+ * Feed a new IMU sample.
+ * @param accel
+ * horizontal acceleration measured (g, magnitude of the IMU's x and y accelerations)
+ *
+ * @param expected
+ * horizontal acceleration the movement commands (g, magnitude)
+ *
+ * @param tilt
+ * tilt of the robot (degrees, the larger of |pitch| and |roll|)
+ *
+ * @param now
+ * time of the sample (micros)
+ *
+ * @return
+ * IMPACT_COLLISION if the acceleration jumped beyond the rule's jerk to beyond the expected acceleration by the
+ * rule's accel, IMPACT_TIP if the tilt has been beyond the rule's for its time, IMPACT_NONE otherwise (and within
+ * the rule's holdoff of the last impact)
+ */
+ImpactType ImpactDetector::update(double accel, double expected, double tilt, uint64_t now){
+  double jerk = prevTime != 0 && now > prevTime? fabs(accel - prevAccel)/((now - prevTime)*1e-6) : 0;
+  prevAccel = accel;
+  prevTime = now;
+  if(tilt <= rule.tilt) tiltedSince = 0;
+  else if(tiltedSince == 0) tiltedSince = now;
+  if(lastImpact != 0 && now - lastImpact < rule.holdoff*1000ull) return IMPACT_NONE;
+  ImpactType impact = IMPACT_NONE;
+  if(jerk >= rule.jerk && accel - expected >= rule.accel) impact = IMPACT_COLLISION;
+  else if(tiltedSince != 0 && now - tiltedSince >= rule.tiltTime*1000ull) impact = IMPACT_TIP;
+  if(impact != IMPACT_NONE){
+    lastImpact = now;
+    tiltedSince = 0;
+  }
+  return impact;
+}
+/**
+ * Forget the samples and the impacts so far (e.g. when the base is handed over).
+ */
+void ImpactDetector::reset(){
+  prevAccel = 0;
+  prevTime = 0;
+  tiltedSince = 0;
+  lastImpact = 0;
+}
@@ -0,0 +1,222 @@
+/**
+ * Driver input macros:
+ * - Recording of the controller samples of opcontrol (a frame per change, and a keyframe per MACRO_KEYFRAME_DT)
+ * - Saving & loading of the recording on the microSD card
+ * - Playback through the driver pipeline, and resampling of the pose trace into pure pursuit waypoints
+ */
+#include "main.h"
+/**
+ * The recording (written by the recording task, or by loadMacro; read by the playback)
+ * macroFrames & macroCount: the frames
+ * macroRecording: a recording is running, started at macroStart (millis)
+ */
+MacroFrame macroFrames[MACRO_MAX_FRAMES];
+int macroCount = 0;
+bool macroRecording = false;
+uint32_t macroStart = 0;
+/**
+ * Start recording a macro (the previous recording in memory is dropped).
+ */
+void startMacroRecording(){
+  macroCount = 0;
+  macroStart = millis();
+  macroRecording = true;
+}
+/**
+ * @return
+ * whether a macro is being recorded
+ */
+bool isMacroRecording(){
+  return macroRecording;
+}
+/**
+ * Add a frame to the recording, if the inputs changed since the last frame or its keyframe is due.
+ * Call once per opcontrol cycle while recording.
+ * @param master, partner
+ * samples of the controllers of this cycle
+ */
+void recordMacroFrame(const ControllerState &master, const ControllerState &partner){
+  if(!macroRecording) return;
+  MacroFrame frame;
+  frame.time = millis() - macroStart;
+  for(int i = 0; i < CONTROLLER_AXES; i++) frame.axes[i] = master.axes[i];
+  frame.buttons = master.buttons;
+  frame.partnerButtons = partner.connected? partner.buttons | MACRO_PARTNER_CONNECTED : 0;
+  PoseSnapshot pose = getPose();
+  frame.x = (int16_t)round(pose.x*MACRO_POSE_SCALE);
+  frame.y = (int16_t)round(pose.y*MACRO_POSE_SCALE);
+  if(macroCount > 0){
+    const MacroFrame &last = macroFrames[macroCount - 1];
+    bool same = memcmp(last.axes, frame.axes, sizeof(frame.axes)) == 0
+      && last.buttons == frame.buttons && last.partnerButtons == frame.partnerButtons;
+    if(same && frame.time - last.time < MACRO_KEYFRAME_DT) return;
+  }
+  macroFrames[macroCount++] = frame;
+  if(macroCount == MACRO_MAX_FRAMES) stopMacroRecording();
+}
+/**
+ * Stop recording and save the macro to the microSD card (MACRO_FILE_PATH).
+ * A last frame with every input released ends the playback with the base stopped.
+ * @return
+ * false if no macro was recorded, there is no card, or the file cannot be written
+ */
+bool stopMacroRecording(){
+  if(!macroRecording) return false;
+  macroRecording = false;
+  if(macroCount > 0){
+    MacroFrame end = macroFrames[macroCount - 1];
+    end.time = millis() - macroStart;
+    memset(end.axes, 0, sizeof(end.axes));
+    end.buttons = end.partnerButtons = 0;
+    if(macroCount == MACRO_MAX_FRAMES) macroFrames[macroCount - 1] = end;
+    else macroFrames[macroCount++] = end;
+  }
+  if(macroCount == 0 || !usd::is_installed()) return false;
+  FILE *file = fopen(MACRO_FILE_PATH, "wb");
+  if(file == NULL) return false;
+  MacroFileHeader header = {MACRO_FILE_MAGIC, MACRO_FILE_VERSION, sizeof(MacroFrame), (uint32_t)macroCount};
+  bool written = fwrite(&header, sizeof(header), 1, file) == 1
+    && fwrite(macroFrames, sizeof(MacroFrame), macroCount, file) == (size_t)macroCount;
+  fclose(file);
+  return written;
+}
+/**
+ * Load the macro from the microSD card (MACRO_FILE_PATH).
+ * @return
+ * false if there is no card, no file, or the file is not a complete macro of this format
+ */
+bool loadMacro(){
+  if(!usd::is_installed()) return false;
+  FILE *file = fopen(MACRO_FILE_PATH, "rb");
+  if(file == NULL) return false;
+  MacroFileHeader header;
+  bool valid = fread(&header, sizeof(header), 1, file) == 1 && header.magic == MACRO_FILE_MAGIC
+    && header.version == MACRO_FILE_VERSION && header.frameSize == sizeof(MacroFrame)
+    && header.frames > 0 && header.frames <= MACRO_MAX_FRAMES
+    && fread(macroFrames, sizeof(MacroFrame), header.frames, file) == header.frames;
+  fclose(file);
+  macroCount = valid? header.frames : 0;
+  return valid;
+}
+/**
+ * @return
+ * number of frames of the macro in memory
+ */
+int getMacroFrames(){
+  return macroCount;
+}
+/**
+ * Set controller samples to the inputs of a frame, counting the presses since the previous frame.
+ * @param frame
+ * the frame
+ *
+ * @param master, partner
+ * samples of the previous frame; updated
+ */
+void applyMacroFrame(const MacroFrame &frame, ControllerState &master, ControllerState &partner){
+  uint16_t partnerButtons = frame.partnerButtons & ~MACRO_PARTNER_CONNECTED;
+  for(int i = 0; i < CONTROLLER_BUTTONS; i++){
+    if((frame.buttons & ~master.buttons) & (1u << i)) master.presses[i]++;
+    if((partnerButtons & ~partner.buttons) & (1u << i)) partner.presses[i]++;
+  }
+  for(int i = 0; i < CONTROLLER_AXES; i++) master.axes[i] = frame.axes[i];
+  master.buttons = frame.buttons;
+  master.connected = true;
+  partner.buttons = partnerButtons;
+  partner.connected = frame.partnerButtons & MACRO_PARTNER_CONNECTED;
+  master.time = partner.time = micros();
+}
+/**
+ * Replay the macro in memory through the driver pipeline, at the controller sample rate, on the
+ * recorded timing. The base controller is paused for the playback and holds where the base stops.
+ * Blocks until the last frame; call from autonomous with the robot where the recording started.
+ */
+void playMacro(){
+  if(macroCount == 0) return;
+  ControllerState master = {}, partner = {};
+  DriverControls controls;
+  resetDriverControls(controls, master);
+  drivetrain.setBrakeMode(DRIVE_BRAKE_MODE);
+  pauseBase(true);
+  int next = 0;
+  Timer timer;
+  LoopRate rate(CONTROLLER_DT);
+  while(next < macroCount){
+    uint32_t elapsed = timer.elapsed();
+    while(next < macroCount && macroFrames[next].time <= elapsed) applyMacroFrame(macroFrames[next++], master, partner);
+    runDriverControls(controls, master, partner);
+    rate.wait();
+  }
+  drivetrain.stop();
+  intakeMove(0);
+  setDiscard(false);
+  /** hold where the base stopped, not at the targets of the last movement */
+  stopBase();
+  pauseBase(false);
+}
+/**
+ * Resample the pose trace of the macro into waypoints for the pure pursuit follower.
+ * Points are at least `spacing` apart along the trace (the spacing grows if the trace needs more than
+ * maxPoints), and the last point is the end of the trace. The trace does not tell reversing apart,
+ * so it suits routes driven forwards.
+ * @param points
+ * set to the waypoints (odometry coordinates of the recording)
+ *
+ * @param maxPoints
+ * size of points (at least 2)
+ *
+ * @param spacing
+ * spacing of the points in inches
+ *
+ * @return
+ * number of waypoints, 0 if there is no macro
+ */
+int getMacroWaypoints(PursuitPoint *points, int maxPoints, double spacing){
+  if(macroCount == 0 || maxPoints < 2) return 0;
+  double length = 0;
+  for(int i = 1; i < macroCount; i++){
+    length += hypot(macroFrames[i].x - macroFrames[i - 1].x, macroFrames[i].y - macroFrames[i - 1].y)/MACRO_POSE_SCALE;
+  }
+  spacing = fmax(spacing, length/(maxPoints - 1));
+  int count = 0;
+  points[count++] = {(double)macroFrames[0].x/MACRO_POSE_SCALE, (double)macroFrames[0].y/MACRO_POSE_SCALE};
+  for(int i = 1; i < macroCount; i++){
+    PursuitPoint point = {(double)macroFrames[i].x/MACRO_POSE_SCALE, (double)macroFrames[i].y/MACRO_POSE_SCALE};
+    bool last = i == macroCount - 1;
+    double gap = hypot(point.x - points[count - 1].x, point.y - points[count - 1].y);
+    if(gap < spacing && !(last && gap > 0)) continue;
+    /** the spacing keeps the last point in bounds; replace the previous one if rounding did not */
+    if(count == maxPoints) count--;
+    points[count++] = point;
+  }
+  return count;
+}
+/**
+ * Selector preparation of the macro routines: load the macro saved on the microSD card.
+ */
+void prepareMacro(){
+  loadMacro();
+}
+/**
+ * Selector routine: replay the macro (the one prepared, or the last one recorded).
+ */
+void runMacro(){
+  playMacro();
+}
+/**
+ * Selector routine: follow the path of the macro (the one prepared, or the last one recorded) with
+ * pure pursuit, shifted to start at the robot's position (the mechanisms are not replayed).
+ */
+void runMacroPath(){
+  PursuitPoint points[MAX_PURSUIT_POINTS];
+  int count = getMacroWaypoints(points, MAX_PURSUIT_POINTS);
+  if(count < 2) return;
+  PoseSnapshot pose = getPose();
+  double dx = pose.x - points[0].x, dy = pose.y - points[0].y;
+  for(int i = 0; i < count; i++){
+    points[i].x += dx;
+    points[i].y += dy;
+  }
+  basePursuit(points, count);
+  waitBase(macroFrames[macroCount - 1].time + MACRO_PATH_TIMEOUT);
+}
@@ -0,0 +1,153 @@
+/**
+ * ADI input service:
+ * - Registration of digital inputs and of subscriber tasks
+ * - Service task sampling and debouncing the inputs every INPUT_DT
+ * - Edge event queues, polled or waited on by the subscribers (also fed by the controllerService task)
+ */
+#include "main.h"
+/**
+ * Registered inputs: ADI port, debounced level, and the samples the raw level has differed from it
+ * (with the time of the first of them). Only the service task writes the levels.
+ */
+uint8_t inputPorts[MAX_DIGITAL_INPUTS];
+std::atomic<bool> inputStates[MAX_DIGITAL_INPUTS];
+int inputChanges[MAX_DIGITAL_INPUTS];
+uint64_t inputChangeTime[MAX_DIGITAL_INPUTS];
+std::atomic<int> inputCount(0);
+InputSubscriber inputSubscribers[MAX_INPUT_SUBSCRIBERS];
+/**
+ * Register a digital input (a limit switch, a bumper, ...). Call from one task at a time,
+ * e.g. at the start of the task using it.
+ * @param port
+ * ADI port (1 to 8)
+ *
+ * @return
+ * input number for the other functions, -1 if MAX_DIGITAL_INPUTS are registered
+ */
+int addDigitalInput(uint8_t port){
+  int input = inputCount.load();
+  for(int i = 0; i < input; i++) if(inputPorts[i] == port) return i;
+  if(input >= MAX_DIGITAL_INPUTS) return -1;
+  pros::c::adi_port_set_config(port, E_ADI_DIGITAL_IN);
+  inputPorts[input] = port;
+  inputStates[input] = pros::c::adi_digital_read(port) == 1;
+  inputChanges[input] = 0;
+  /** publish the input to the service task only after it is set up */
+  inputCount = input + 1;
+  return input;
+}
+/**
+ * @param input
+ * a registered input, or a controller button input
+ *
+ * @return
+ * its debounced level (a button: held at the last controller sample)
+ */
+bool getInputState(int input){
+  if(input >= CONTROLLER_INPUT_BASE){
+    int button = input - CONTROLLER_INPUT_BASE;
+    return getControllerState((pros::controller_id_e_t)(button/CONTROLLER_BUTTONS)).buttons & (1u << button%CONTROLLER_BUTTONS);
+  }
+  return inputStates[input];
+}
+/**
+ * Subscribe the calling task to the edges of some inputs.
+ * @param inputMask
+ * bit i set: events of input i
+ *
+ * @return
+ * subscriber number for popInputEvent and waitInputEvent, -1 if there is no free slot
+ */
+int subscribeInputs(uint32_t inputMask){
+  for(int i = 0; i < MAX_INPUT_SUBSCRIBERS; i++){
+    pros::task_t empty = NULL;
+    /** set the mask before claiming the slot so the service task never sees a stale one */
+    if(inputSubscribers[i].task.load() != NULL) continue;
+    inputSubscribers[i].inputMask = inputMask;
+    if(!inputSubscribers[i].task.compare_exchange_strong(empty, pros::c::task_get_current())) continue;
+    inputSubscribers[i].events.setReceiver(pros::c::task_get_current());
+    return i;
+  }
+  return -1;
+}
+/**
+ * Take the oldest queued event of a subscriber without blocking.
+ * @param subscriber
+ * the caller's subscriber number
+ *
+ * @param event
+ * set to the event
+ *
+ * @return
+ * false if no event is queued
+ */
+bool popInputEvent(int subscriber, InputEvent &event){
+  return inputSubscribers[subscriber].events.take(event);
+}
+/**
+ * Take the oldest queued event of a subscriber, blocking until there is one.
+ * @param subscriber
+ * the caller's subscriber number
+ *
+ * @param event
+ * set to the event
+ *
+ * @param timeout
+ * maximum wait in ms
+ *
+ * @return
+ * false at the timeout
+ */
+bool waitInputEvent(int subscriber, InputEvent &event, uint32_t timeout){
+  return inputSubscribers[subscriber].events.wait(event, timeout);
+}
+/**
+ * @param subscriber
+ * a subscriber number
+ *
+ * @return
+ * events dropped because its queue was full
+ */
+uint32_t getInputDrops(int subscriber){
+  return inputSubscribers[subscriber].events.dropped();
+}
+/**
+ * Queue an event to every subscriber of its input and wake them.
+ * Called by the service tasks only (this one and controllerService).
+ */
+void publishInputEvent(const InputEvent &event){
+  for(int i = 0; i < MAX_INPUT_SUBSCRIBERS; i++){
+    InputSubscriber &sub = inputSubscribers[i];
+    if(sub.task.load() == NULL || !(sub.inputMask & (1u << event.input))) continue;
+    sub.events.post(event);
+  }
+}
+/**
+ * Input service task: samples every registered input once per INPUT_DT.
+ * A new level counts once it has held for INPUT_DEBOUNCE samples;
+ * its event is stamped with the time of the first of them.
+ */
+void inputService(void * ignore){
+  LoopRate rate(INPUT_DT);
+  startTaskTiming(TIMING_INPUT, INPUT_DT, true);
+  while(true){
+    beginTaskIteration(TIMING_INPUT);
+    int count = inputCount;
+    uint64_t time = micros();
+    for(int i = 0; i < count; i++){
+      bool level = pros::c::adi_digital_read(inputPorts[i]) == 1;
+      if(level == inputStates[i].load(std::memory_order_relaxed)){
+        inputChanges[i] = 0;
+        continue;
+      }
+      if(inputChanges[i]++ == 0) inputChangeTime[i] = time;
+      if(inputChanges[i] < INPUT_DEBOUNCE) continue;
+      inputChanges[i] = 0;
+      inputStates[i] = level;
+      InputEvent event = {(uint8_t)i, level, inputChangeTime[i]};
+      publishInputEvent(event);
+    }
+    endTaskIteration(TIMING_INPUT);
+    rate.wait();
+  }
+}
@@ -0,0 +1,106 @@
+/**
+ * Actuation latency probe:
+ * - Power steps on the base, timed with micros()
+ * - Response times of the velocity and the encoder of every base motor
+ * - Distributions per port, printed and sent through telemetry
+ */
+#include "main.h"
+#include <algorithm>
+/** smart ports of the base motors, for the report (BaseMotor order) */
+const uint8_t latencyPorts[BASE_MOTORS] = {FLPort, BLPort, FRPort, BRPort};
+/**
+ * Quantile of sorted samples.
+ * @param samples
+ * sorted samples
+ *
+ * @param count
+ * number of samples (0 gives 0)
+ *
+ * @param q
+ * quantile (0 to 1)
+ *
+ * @return
+ * the sample at the quantile
+ */
+uint32_t latencyQuantile(const uint32_t *samples, int count, double q){
+  if(count == 0) return 0;
+  return samples[(int)((count - 1)*q)];
+}
+/**
+ * Measure the actuation latency of the base motors: step the base to LATENCY_POWER from rest, poll
+ * every motor each LATENCY_POLL_DT and time its first response from the command, then stop and rest.
+ * The base controller is paused for the run, so call it with room in front of and behind the robot.
+ * @param stats
+ * set to the distribution of each base motor (BaseMotor order)
+ *
+ * @param pulses (optional)
+ * number of steps (at most LATENCY_MAX_PULSES)
+ */
+void measureBaseLatency(LatencyStats stats[BASE_MOTORS], int pulses){
+  if(pulses > LATENCY_MAX_PULSES) pulses = LATENCY_MAX_PULSES;
+  uint32_t velLatency[BASE_MOTORS][LATENCY_MAX_PULSES], posLatency[BASE_MOTORS][LATENCY_MAX_PULSES];
+  int samples[BASE_MOTORS] = {};
+  pauseBase(true);
+  wakeOdometry();
+  drivetrain.stop();
+  delay(LATENCY_REST);
+  for(int pulse = 0; pulse < pulses; pulse++){
+    double startPos[BASE_MOTORS];
+    uint32_t velTime[BASE_MOTORS], posTime[BASE_MOTORS];
+    for(int i = 0; i < BASE_MOTORS; i++){
+      startPos[i] = drivetrain.getPosition((BaseMotor)i);
+      velTime[i] = posTime[i] = 0;
+    }
+    int power = pulse % 2 == 0? LATENCY_POWER : -LATENCY_POWER;
+    uint64_t command = micros();
+    drivetrain.setPower(power, power);
+    int waiting = BASE_MOTORS;
+    while(waiting > 0 && micros() - command < LATENCY_TIMEOUT*1000ull){
+      delay(LATENCY_POLL_DT);
+      uint32_t elapsed = micros() - command;
+      for(int i = 0; i < BASE_MOTORS; i++){
+        if(velTime[i] != 0 && posTime[i] != 0) continue;
+        BaseMotor motor = (BaseMotor)i;
+        if(velTime[i] == 0 && fabs(drivetrain.getVelocity(motor)) >= LATENCY_VEL_THRESHOLD) velTime[i] = elapsed;
+        if(posTime[i] == 0 && fabs(drivetrain.getPosition(motor) - startPos[i]) >= LATENCY_POS_THRESHOLD) posTime[i] = elapsed;
+        if(velTime[i] != 0 && posTime[i] != 0){
+          waiting--;
+          velLatency[i][samples[i]] = velTime[i];
+          posLatency[i][samples[i]] = posTime[i];
+          samples[i]++;
+        }
+      }
+    }
+    drivetrain.stop();
+    delay(LATENCY_REST);
+  }
+  pauseBase(false);
+  for(int i = 0; i < BASE_MOTORS; i++){
+    int n = samples[i];
+    std::sort(velLatency[i], velLatency[i] + n);
+    std::sort(posLatency[i], posLatency[i] + n);
+    stats[i].port = latencyPorts[i];
+    stats[i].samples = n;
+    stats[i].velMedian = latencyQuantile(velLatency[i], n, 0.5);
+    stats[i].velP90 = latencyQuantile(velLatency[i], n, 0.9);
+    stats[i].velMax = latencyQuantile(velLatency[i], n, 1);
+    stats[i].posMedian = latencyQuantile(posLatency[i], n, 0.5);
+    stats[i].posP90 = latencyQuantile(posLatency[i], n, 0.9);
+    stats[i].posMax = latencyQuantile(posLatency[i], n, 1);
+  }
+}
+/**
+ * Run the probe and print the latency of each base motor; with a binary telemetry format the
+ * distributions are also sent as TELEMETRY_LATENCY records (without the encoder's P90 and maximum).
+ */
+void probeBaseLatency(){
+  LatencyStats stats[BASE_MOTORS];
+  measureBaseLatency(stats);
+  for(int i = 0; i < BASE_MOTORS; i++){
+    const LatencyStats &s = stats[i];
+    printf("Latency port %d (%d steps): velocity %.1f/%.1f/%.1f ms, encoder %.1f/%.1f/%.1f ms (median/p90/max)\n",
+           s.port, (int)s.samples, s.velMedian/1000.0, s.velP90/1000.0, s.velMax/1000.0,
+           s.posMedian/1000.0, s.posP90/1000.0, s.posMax/1000.0);
+    if(TELEMETRY_FORMAT != TELEMETRY_TEXT) pushTelemetry(TELEMETRY_LATENCY, s.port, s.samples, s.velMedian, s.velP90, s.velMax, s.posMedian);
+  }
+}
@@ -0,0 +1,439 @@
+/**
+ * Lattice planner functions:
+ * - Primitive table generated at compile time (geometry, swept grid cells, durations between the speeds)
+ * - A* search over the lattice poses on time (indexed binary heap)
+ * - Plans into pursuit waypoints, and a planned pursuit from the live pose
+ */
+#include "main.h"
+// Grid cells between two lattice points
+#define LATTICE_STEP (LATTICE_CELL/PLANNER_CELL)
+#define LATTICE_STATES (LATTICE_GRID*LATTICE_GRID*LATTICE_HEADINGS*LATTICE_SPEEDS)
+static_assert(LATTICE_CELL%PLANNER_CELL == 0, "the lattice points must be grid cells");
+static_assert(LATTICE_STATES <= 32767, "a lattice state must fit in the heap index");
+// Component of a diagonal heading's unit vector
+#define LATTICE_DIAGONAL 0.70710678118654752
+/** unit vectors of the lattice headings (bearings: x is the sine, y the cosine) */
+constexpr double latticeUnitX[LATTICE_HEADINGS] = {0, LATTICE_DIAGONAL, 1, LATTICE_DIAGONAL, 0, -LATTICE_DIAGONAL, -1, -LATTICE_DIAGONAL};
+constexpr double latticeUnitY[LATTICE_HEADINGS] = {1, LATTICE_DIAGONAL, 0, -LATTICE_DIAGONAL, -1, -LATTICE_DIAGONAL, 0, LATTICE_DIAGONAL};
+/** A base primitive: end point (lattice points) and the headings at its start and end */
+struct LatticeBase{
+  int8_t dx, dy;
+  uint8_t heading, endHeading;
+};
+/**
+ * The base primitives: from heading 0, straights of one and two points and arcs of 45 and 90 degrees
+ * either way; from heading 1, a straight and arcs of 45 and 90 degrees either way
+ */
+constexpr LatticeBase latticeBases[LATTICE_BASE_PRIMITIVES] = {
+  {0, 1, 0, 0}, {0, 2, 0, 0}, {1, 2, 0, 1}, {-1, 2, 0, 7}, {2, 2, 0, 2}, {-2, 2, 0, 6},
+  {1, 1, 1, 1}, {2, 1, 1, 2}, {1, 2, 1, 0}, {2, 0, 1, 3}, {0, 2, 1, 7}
+};
+/**
+ * Square root by Newton's method, for the tables generated at compile time (std::sqrt is not constexpr).
+ */
+constexpr double latticeSqrt(double x){
+  if(x <= 0) return 0;
+  double root = x > 1? x : 1;
+  for(int i = 0; i < 40; i++) root = (root + x/root)/2;
+  return root;
+}
+constexpr int latticeFloor(double x){
+  int i = (int)x;
+  return x < i? i - 1 : i;
+}
+/**
+ * Point of a primitive's path: the cubic Hermite curve (as pathfinder's FIT_HERMITE_CUBIC) from its start point
+ * to its end point along its headings, with tangents as long as the chord.
+ * @param dx, dy, heading, endHeading
+ * the primitive (refer to LatticePrimitive)
+ *
+ * @param t
+ * parameter along the curve, 0 to 1
+ *
+ * @param x, y
+ * set to the point in inches from the start point
+ *
+ * @param vx, vy, ax, ay
+ * set to the first and second derivatives of the point
+ */
+constexpr void latticeHermite(int dx, int dy, int heading, int endHeading, double t, double &x, double &y,
+  double &vx, double &vy, double &ax, double &ay){
+  double px = dx*LATTICE_CELL, py = dy*LATTICE_CELL, chord = latticeSqrt(px*px + py*py);
+  double m0x = latticeUnitX[heading]*chord, m0y = latticeUnitY[heading]*chord;
+  double m1x = latticeUnitX[endHeading]*chord, m1y = latticeUnitY[endHeading]*chord;
+  double t2 = t*t, t3 = t2*t;
+  /** basis functions of the start tangent, the end point and the end tangent (the start point is the origin) */
+  double h10 = t3 - 2*t2 + t, h01 = 3*t2 - 2*t3, h11 = t3 - t2;
+  double d10 = 3*t2 - 4*t + 1, d01 = 6*t - 6*t2, d11 = 3*t2 - 2*t;
+  double s10 = 6*t - 4, s01 = 6 - 12*t, s11 = 6*t - 2;
+  x = h10*m0x + h01*px + h11*m1x;
+  y = h10*m0y + h01*py + h11*m1y;
+  vx = d10*m0x + d01*px + d11*m1x;
+  vy = d10*m0y + d01*py + d11*m1y;
+  ax = s10*m0x + s01*px + s11*m1x;
+  ay = s10*m0y + s01*py + s11*m1y;
+}
+/**
+ * @return
+ * the speed of a speed class in inches per second
+ */
+constexpr double latticeSpeed(int speed){
+  return (double)speed*LATTICE_MAX_VEL/(LATTICE_SPEEDS - 1);
+}
+/**
+ * Duration of a drive along a primitive: a trapezoidal profile from the start speed to the end speed at
+ * LATTICE_MAX_ACC, capped at the primitive's top speed.
+ * @param length, maxVel
+ * length (inches) and top speed (in/s) of the primitive
+ *
+ * @param v0, v1
+ * speeds at its start and end (in/s)
+ *
+ * @return
+ * duration in seconds, INFINITY if a speed is above the top speed or the change of speed needs a longer primitive
+ */
+constexpr float latticeDriveTime(double length, double maxVel, double v0, double v1){
+  double change = v1*v1 - v0*v0, reach = 2*LATTICE_MAX_ACC*length;
+  if(v0 > maxVel || v1 > maxVel || change > reach || -change > reach) return INFINITY;
+  double peak = latticeSqrt(LATTICE_MAX_ACC*length + (v0*v0 + v1*v1)/2);
+  if(peak > maxVel) peak = maxVel;
+  double ramps = (2*peak*peak - v0*v0 - v1*v1)/(2*LATTICE_MAX_ACC);
+  return (2*peak - v0 - v1)/LATTICE_MAX_ACC + (length - ramps)/peak;
+}
+/** The primitive table, and whether every primitive's swept cells fit in it */
+struct LatticeTable{
+  LatticePrimitive primitives[LATTICE_PRIMITIVES];
+  bool fits;
+};
+/**
+ * Generate the primitive table at compile time: every base primitive turned by 0, 90, 180 and 270 degrees
+ * (the primitives of heading h are the LATTICE_AXIS_PRIMITIVES or the others of turn h/2), each with the
+ * length, curvature and swept grid cells of its sampled path and its durations between the speed classes.
+ * @return
+ * the table
+ */
+constexpr LatticeTable makeLatticeTable(){
+  LatticeTable table = {};
+  table.fits = true;
+  for(int turn = 0; turn < 4; turn++){
+    for(int b = 0; b < LATTICE_BASE_PRIMITIVES; b++){
+      LatticePrimitive &primitive = table.primitives[turn*LATTICE_BASE_PRIMITIVES + b];
+      int dx = latticeBases[b].dx, dy = latticeBases[b].dy;
+      /** a quarter turn clockwise takes +y to +x */
+      for(int i = 0; i < turn; i++){
+        int x = dx;
+        dx = dy;
+        dy = -x;
+      }
+      primitive.dx = dx;
+      primitive.dy = dy;
+      primitive.heading = (latticeBases[b].heading + 2*turn)%LATTICE_HEADINGS;
+      primitive.endHeading = (latticeBases[b].endHeading + 2*turn)%LATTICE_HEADINGS;
+      double length = 0, curvature = 0, prevX = 0, prevY = 0;
+      for(int i = 0; i <= LATTICE_SAMPLES; i++){
+        double x = 0, y = 0, vx = 0, vy = 0, ax = 0, ay = 0;
+        latticeHermite(dx, dy, primitive.heading, primitive.endHeading, (double)i/LATTICE_SAMPLES, x, y, vx, vy, ax, ay);
+        length += latticeSqrt((x - prevX)*(x - prevX) + (y - prevY)*(y - prevY));
+        prevX = x;
+        prevY = y;
+        double speed = latticeSqrt(vx*vx + vy*vy), cross = vx*ay - vy*ax;
+        double sampleCurvature = (cross < 0? -cross : cross)/(speed*speed*speed);
+        if(sampleCurvature > curvature) curvature = sampleCurvature;
+        /** grid cell of the sample, from the grid cell of the start point (the start point is at its centre) */
+        int cellX = latticeFloor((x + PLANNER_CELL/2.0)/PLANNER_CELL), cellY = latticeFloor((y + PLANNER_CELL/2.0)/PLANNER_CELL);
+        bool seen = false;
+        for(int j = 0; j < primitive.sweptCount; j++) seen = seen || (primitive.swept[j][0] == cellX && primitive.swept[j][1] == cellY);
+        if(seen) continue;
+        if(primitive.sweptCount == LATTICE_MAX_SWEPT){
+          table.fits = false;
+          continue;
+        }
+        primitive.swept[primitive.sweptCount][0] = cellX;
+        primitive.swept[primitive.sweptCount][1] = cellY;
+        primitive.sweptCount++;
+      }
+      /** refer to Odometry Documentation.docx: the outer side travels (1 + curvature*baseWidth/2) times the centre */
+      double maxVel = LATTICE_MAX_VEL/(1 + curvature*baseWidth/2);
+      primitive.length = length;
+      primitive.maxVel = maxVel;
+      for(int v0 = 0; v0 < LATTICE_SPEEDS; v0++){
+        for(int v1 = 0; v1 < LATTICE_SPEEDS; v1++) primitive.time[v0][v1] = latticeDriveTime(length, maxVel, latticeSpeed(v0), latticeSpeed(v1));
+      }
+    }
+  }
+  return table;
+}
+constexpr LatticeTable latticeTable = makeLatticeTable();
+static_assert(latticeTable.fits, "a primitive sweeps more than LATTICE_MAX_SWEPT grid cells");
+/**
+ * @param index
+ * index of a primitive
+ *
+ * @return
+ * the primitive, NULL if there is none of that index
+ */
+const LatticePrimitive *getLatticePrimitive(int index){
+  if(index < 0 || index >= LATTICE_PRIMITIVES) return NULL;
+  return &latticeTable.primitives[index];
+}
+/**
+ * Search state, static so a plan uses no stack or heap (one plan at a time)
+ * latticeCost: time from the start (s); latticeParent: previous state on the fastest plan, and latticeVia: the
+ * primitive driven from it (-1: a point turn)
+ * latticeHeap: open states ordered by estimated total time; latticeHeapIndex: position of a state in it (-1: none)
+ * latticeClosed: bit-packed
+ */
+float latticeCost[LATTICE_STATES], latticeEstimate[LATTICE_STATES];
+uint16_t latticeParent[LATTICE_STATES], latticeHeap[LATTICE_STATES];
+int16_t latticeHeapIndex[LATTICE_STATES];
+int8_t latticeVia[LATTICE_STATES];
+uint64_t latticeClosed[(LATTICE_STATES + 63)/64];
+int latticeHeapSize = 0;
+/** states expanded by the last plan */
+int latticeExpanded = 0;
+/** heap helpers: restore the order after a state's estimate decreased, and pop the best state */
+void latticeHeapUp(int i){
+  uint16_t state = latticeHeap[i];
+  while(i > 0){
+    int parent = (i - 1)/2;
+    if(latticeEstimate[latticeHeap[parent]] <= latticeEstimate[state]) break;
+    latticeHeap[i] = latticeHeap[parent];
+    latticeHeapIndex[latticeHeap[i]] = i;
+    i = parent;
+  }
+  latticeHeap[i] = state;
+  latticeHeapIndex[state] = i;
+}
+uint16_t latticeHeapPop(){
+  uint16_t best = latticeHeap[0];
+  latticeHeapIndex[best] = -1;
+  uint16_t state = latticeHeap[--latticeHeapSize];
+  int i = 0;
+  while(latticeHeapSize > 0){
+    int child = 2*i + 1;
+    if(child >= latticeHeapSize) break;
+    if(child + 1 < latticeHeapSize && latticeEstimate[latticeHeap[child + 1]] < latticeEstimate[latticeHeap[child]]) child++;
+    if(latticeEstimate[state] <= latticeEstimate[latticeHeap[child]]) break;
+    latticeHeap[i] = latticeHeap[child];
+    latticeHeapIndex[latticeHeap[i]] = i;
+    i = child;
+  }
+  if(latticeHeapSize > 0){
+    latticeHeap[i] = state;
+    latticeHeapIndex[state] = i;
+  }
+  return best;
+}
+/** lattice state of a lattice pose */
+int latticeState(int x, int y, int heading, int speed){
+  return ((y*LATTICE_GRID + x)*LATTICE_HEADINGS + heading)*LATTICE_SPEEDS + speed;
+}
+/**
+ * Open or improve a state reached at a time.
+ * @return
+ * false if the state is closed or was already reached as fast
+ */
+bool openLatticeState(int state, float cost, float heuristic, int parent, int via){
+  if(((latticeClosed[state/64] >> (state%64)) & 1) || cost >= latticeCost[state]) return false;
+  latticeCost[state] = cost;
+  latticeEstimate[state] = cost + heuristic;
+  latticeParent[state] = parent;
+  latticeVia[state] = via;
+  if(latticeHeapIndex[state] < 0){
+    latticeHeap[latticeHeapSize] = state;
+    latticeHeapUp(latticeHeapSize++);
+  }
+  else latticeHeapUp(latticeHeapIndex[state]);
+  return true;
+}
+/**
+ * @param field
+ * field coordinate in inches from the bottom left corner
+ *
+ * @return
+ * the nearest lattice point along it (may be off the lattice)
+ */
+int latticeIndex(double field){
+  return (int)lround((field/PLANNER_CELL - 0.5)/LATTICE_STEP);
+}
+/**
+ * @return
+ * field coordinate of a lattice point in inches from the bottom left corner
+ */
+double latticeField(int index){
+  return (index*LATTICE_STEP + 0.5)*PLANNER_CELL;
+}
+/**
+ * Time of a point turn between two lattice headings (the shorter way), a trapezoidal profile of the side
+ * travel at LATTICE_TURN_VEL and LATTICE_TURN_ACC.
+ */
+float latticeTurnTime(int from, int to){
+  int steps = abs(to - from);
+  if(steps > LATTICE_HEADINGS/2) steps = LATTICE_HEADINGS - steps;
+  double travel = steps*PI/4*baseWidth/2, vel = LATTICE_TURN_VEL, acc = LATTICE_TURN_ACC;
+  return travel < vel*vel/acc? 2*sqrt(travel/acc) : travel/vel + vel/acc;
+}
+/**
+ * Plan the fastest chain of primitives from a pose to a point, ending at rest (any heading). The start and
+ * the goal are taken to the nearest lattice points, the start heading to the nearest lattice heading and the
+ * start speed to the nearest speed class; from rest the plan may start with a point turn.
+ * @param startX, startY
+ * start in odometry coordinates (inches); may be in a blocked cell (e.g. against a goal)
+ *
+ * @param startAngle
+ * bearing at the start in radians
+ *
+ * @param startVel
+ * forward velocity at the start in inches per second (backward counts as at rest)
+ *
+ * @param goalX, goalY
+ * goal in odometry coordinates (inches); its lattice point must be in a free cell
+ *
+ * @param steps
+ * set to the steps of the plan, in order
+ *
+ * @param maxSteps
+ * size of steps
+ *
+ * @param time
+ * set to the duration of the plan in seconds
+ *
+ * @return
+ * number of steps (0: the start is the goal, at rest), or -1 if there is no plan (or it needs more than maxSteps steps)
+ */
+int planLattice(double startX, double startY, double startAngle, double startVel, double goalX, double goalY,
+  LatticeStep *steps, int maxSteps, double &time){
+  latticeExpanded = 0;
+  int sx = latticeIndex(startX + PLANNER_ORIGIN_X), sy = latticeIndex(startY + PLANNER_ORIGIN_Y);
+  int gx = latticeIndex(goalX + PLANNER_ORIGIN_X), gy = latticeIndex(goalY + PLANNER_ORIGIN_Y);
+  if(sx < 0 || sy < 0 || sx >= LATTICE_GRID || sy >= LATTICE_GRID || gx < 0 || gy < 0 || gx >= LATTICE_GRID || gy >= LATTICE_GRID) return -1;
+  if(!isPlannerCellFree(gx*LATTICE_STEP, gy*LATTICE_STEP) || maxSteps < 0) return -1;
+  int heading = (int)(lround(startAngle/(PI/4))%LATTICE_HEADINGS);
+  if(heading < 0) heading += LATTICE_HEADINGS;
+  int speed = (int)fmin(LATTICE_SPEEDS - 1, fmax(0, lround(startVel/latticeSpeed(1))));
+  for(int i = 0; i < LATTICE_STATES; i++){
+    latticeCost[i] = INFINITY;
+    latticeHeapIndex[i] = -1;
+  }
+  memset(latticeClosed, 0, sizeof(latticeClosed));
+  latticeHeapSize = 0;
+  /** admissible: the straight line at the top speed */
+  auto heuristic = [gx, gy](int x, int y){ return (float)(hypot(gx - x, gy - y)*LATTICE_CELL/LATTICE_MAX_VEL); };
+  int start = latticeState(sx, sy, heading, speed);
+  openLatticeState(start, 0, heuristic(sx, sy), start, -1);
+  /** from rest, a point turn to any other heading */
+  for(int h = 0; h < LATTICE_HEADINGS && speed == 0; h++){
+    if(h != heading) openLatticeState(latticeState(sx, sy, h, 0), latticeTurnTime(heading, h), heuristic(sx, sy), start, -1);
+  }
+  int goal = -1;
+  while(latticeHeapSize > 0){
+    int state = latticeHeapPop();
+    int v0 = state%LATTICE_SPEEDS, h = state/LATTICE_SPEEDS%LATTICE_HEADINGS, point = state/(LATTICE_SPEEDS*LATTICE_HEADINGS);
+    int x = point%LATTICE_GRID, y = point/LATTICE_GRID;
+    if(x == gx && y == gy && v0 == 0){
+      goal = state;
+      break;
+    }
+    latticeClosed[state/64] |= 1ull << (state%64);
+    latticeExpanded++;
+    int first = h/2*LATTICE_BASE_PRIMITIVES + (h%2? LATTICE_AXIS_PRIMITIVES : 0);
+    int count = h%2? LATTICE_BASE_PRIMITIVES - LATTICE_AXIS_PRIMITIVES : LATTICE_AXIS_PRIMITIVES;
+    for(int i = first; i < first + count; i++){
+      const LatticePrimitive &primitive = latticeTable.primitives[i];
+      int nx = x + primitive.dx, ny = y + primitive.dy;
+      if(nx < 0 || ny < 0 || nx >= LATTICE_GRID || ny >= LATTICE_GRID) continue;
+      /** the first swept cell is the start point's, checked when the search reached it */
+      bool free = true;
+      for(int j = 1; j < primitive.sweptCount && free; j++){
+        free = isPlannerCellFree(x*LATTICE_STEP + primitive.swept[j][0], y*LATTICE_STEP + primitive.swept[j][1]);
+      }
+      if(!free) continue;
+      float remaining = heuristic(nx, ny);
+      for(int v1 = 0; v1 < LATTICE_SPEEDS; v1++){
+        float duration = primitive.time[v0][v1];
+        if(std::isinf(duration)) continue;
+        openLatticeState(latticeState(nx, ny, primitive.endHeading, v1), latticeCost[state] + duration, remaining, state, i);
+      }
+    }
+  }
+  if(goal < 0) return -1;
+  /** walk back from the goal */
+  int count = 0;
+  for(int state = goal; state != start; state = latticeParent[state]) count++;
+  if(count > maxSteps) return -1;
+  time = latticeCost[goal];
+  for(int state = goal, i = count; state != start; state = latticeParent[state]){
+    int point = state/(LATTICE_SPEEDS*LATTICE_HEADINGS);
+    steps[--i] = {latticeVia[state], (uint8_t)(point%LATTICE_GRID), (uint8_t)(point/LATTICE_GRID),
+      (uint8_t)(state/LATTICE_SPEEDS%LATTICE_HEADINGS), (uint8_t)(state%LATTICE_SPEEDS), latticeCost[state] - latticeCost[latticeParent[state]]};
+  }
+  return count;
+}
+/**
+ * @return
+ * states expanded by the last planLattice
+ */
+int getLatticeExpansions(){
+  return latticeExpanded;
+}
+/**
+ * Turn the steps of a plan into waypoints for basePursuit: the end of every primitive (runs of straights
+ * merged) and the middle of every arc. Point turns give no waypoint.
+ * @param steps, count
+ * the plan (refer to planLattice)
+ *
+ * @param points
+ * set to the waypoints in odometry coordinates (the start is not included, the goal is the last one)
+ *
+ * @param maxPoints
+ * size of points
+ *
+ * @return
+ * number of waypoints, or -1 if more than maxPoints are needed
+ */
+int latticeWaypoints(const LatticeStep *steps, int count, PursuitPoint *points, int maxPoints){
+  int used = 0;
+  /** the last waypoint ends a straight, which a following straight (of the same heading) extends */
+  bool straight = false;
+  for(int i = 0; i < count; i++){
+    if(steps[i].primitive < 0) continue;
+    const LatticePrimitive &primitive = latticeTable.primitives[steps[i].primitive];
+    double endX = latticeField(steps[i].x) - PLANNER_ORIGIN_X, endY = latticeField(steps[i].y) - PLANNER_ORIGIN_Y;
+    bool turns = primitive.heading != primitive.endHeading;
+    if(!turns && straight){
+      points[used - 1] = {endX, endY};
+      continue;
+    }
+    if(used + (turns? 2 : 1) > maxPoints) return -1;
+    if(turns){
+      double x, y, vx, vy, ax, ay;
+      latticeHermite(primitive.dx, primitive.dy, primitive.heading, primitive.endHeading, 0.5, x, y, vx, vy, ax, ay);
+      points[used++] = {endX - primitive.dx*LATTICE_CELL + x, endY - primitive.dy*LATTICE_CELL + y};
+    }
+    points[used++] = {endX, endY};
+    straight = !turns;
+  }
+  return used;
+}
+/** waypoints of the last baseLatticePursuit (a queued pursuit reads them when it starts) */
+PursuitPoint latticePursuitPoints[MAX_PURSUIT_POINTS - 1];
+/**
+ * Plan from the live pose to a point on the lattice and follow the plan with pure pursuit. A plan that starts
+ * with a point turn is handed to the motion queue (the turn, then the pursuit); otherwise the pursuit starts at once.
+ * @param x, y
+ * goal in odometry coordinates (inches)
+ *
+ * @return
+ * false if there is no plan, nothing to drive, or the motion queue is full (the base does not move)
+ */
+bool baseLatticePursuit(double x, double y){
+  PoseSnapshot pose = getPose();
+  LatticeStep steps[LATTICE_MAX_STEPS];
+  double time;
+  int count = planLattice(pose.x, pose.y, pose.angle, pose.linVel, x, y, steps, LATTICE_MAX_STEPS, time);
+  int points = count > 0? latticeWaypoints(steps, count, latticePursuitPoints, MAX_PURSUIT_POINTS - 1) : -1;
+  if(points < 1) return false;
+  if(steps[0].primitive < 0) return queueTurn(steps[0].heading*45.0) && queuePursuit(latticePursuitPoints, points);
+  basePursuit(latticePursuitPoints, points);
+  return true;
+}
@@ -0,0 +1,253 @@
+/**
+ * Learned feedforward of the cached trajectories (refer to learnedFeedforward.hpp):
+ * - Preparation: corrections (from the microSD card) and an error record per trajectory in the arena
+ * - Control task: the corrections of a bin, and the record of its errors in learning mode
+ * - After a run: the learning update of every complete record, saved to the card
+ */
+#include "main.h"
+/**
+ * Learned state of a cached trajectory (same id)
+ * correctionL, correctionR: power per bin; errorL, errorR: errors of the run (inches) per bin
+ * bins: bins of the trajectory (0: not prepared); runs: runs learned from
+ * lastBin: latest bin recorded in the run (control task only; -1 before the first)
+ * complete: the run recorded every bin, and is not learned from yet
+ */
+struct LearnedTrajectory{
+  float *correctionL, *correctionR, *errorL, *errorR;
+  int bins, runs, lastBin;
+  std::atomic<bool> complete;
+};
+LearnedTrajectory learned[MAX_TRAJECTORIES];
+std::atomic<bool> learningMode(false);
+/**
+ * @param name
+ * identifier of the trajectory
+ *
+ * @param path
+ * buffer for the path of its learning file
+ *
+ * @param size
+ * size of the buffer
+ */
+void learningFilePath(const char *name, char *path, int size){
+  snprintf(path, size, "%s%s.ilc", TRAJECTORY_DIR, name);
+}
+/**
+ * Header a learning file of a trajectory must have (magic to bins; runs is left to the caller)
+ * @param trajectory
+ * the trajectory
+ *
+ * @param bins
+ * its bins
+ */
+LearningFileHeader learningHeader(const CachedTrajectory &trajectory, int bins){
+  float endL = decodeSegment(trajectory, trajectory.left[trajectory.length - 1]).position;
+  float endR = decodeSegment(trajectory, trajectory.right[trajectory.length - 1]).position;
+  return {LEARNING_FILE_MAGIC, LEARNING_FILE_VERSION, trajectory.hash, trajectory.length, bins, 0, endL, endR};
+}
+/**
+ * Load the corrections of a trajectory from the microSD card.
+ * @param trajectory
+ * the trajectory
+ *
+ * @param entry
+ * its learned state, with the corrections zeroed
+ *
+ * @return
+ * false if there is no card, no file, or the file is of another trajectory or corrupt (the corrections stay 0)
+ */
+bool loadLearning(const CachedTrajectory &trajectory, LearnedTrajectory &entry){
+  if(!usd::is_installed()) return false;
+  char path[64];
+  learningFilePath(trajectory.name, path, sizeof(path));
+  FILE *file = fopen(path, "rb");
+  if(file == NULL) return false;
+  LearningFileHeader header, expected = learningHeader(trajectory, entry.bins);
+  bool valid = fread(&header, sizeof(header), 1, file) == 1 && header.magic == expected.magic
+    && header.version == expected.version && header.hash == expected.hash && header.length == expected.length
+    && header.bins == expected.bins && header.endL == expected.endL && header.endR == expected.endR
+    && fread(entry.correctionL, sizeof(float), entry.bins, file) == (size_t)entry.bins
+    && fread(entry.correctionR, sizeof(float), entry.bins, file) == (size_t)entry.bins;
+  fclose(file);
+  if(!valid){
+    memset(entry.correctionL, 0, entry.bins*sizeof(float));
+    memset(entry.correctionR, 0, entry.bins*sizeof(float));
+    return false;
+  }
+  entry.runs = header.runs;
+  return true;
+}
+/**
+ * Prepare the learned state of a cached trajectory (when it is generated, loaded or derived): the corrections
+ * saved on the microSD card for it, or none.
+ * @param id
+ * id of the trajectory
+ */
+void prepareLearning(int id){
+  const CachedTrajectory *trajectory = getTrajectory(id);
+  if(!LEARNED_FEEDFORWARD || trajectory == NULL) return;
+  LearnedTrajectory &entry = learned[id];
+  entry.bins = entry.runs = 0;
+  entry.lastBin = -1;
+  entry.complete = false;
+  /** a streamed trajectory would need arena space by its length (refer to trajectoryStream.hpp) */
+  if(trajectory->stream != NULL) return;
+  int bins = ceil(trajectory->length*trajectory->dt*1000/BASE_CONTROL_DT);
+  float *data = (float*) arenaAlloc(4*bins*sizeof(float));
+  if(data == NULL) return;
+  memset(data, 0, 4*bins*sizeof(float));
+  entry.correctionL = data;
+  entry.correctionR = data + bins;
+  entry.errorL = data + 2*bins;
+  entry.errorR = data + 3*bins;
+  entry.bins = bins;
+  loadLearning(*trajectory, entry);
+}
+/**
+ * Drop the learned state of every trajectory (with clearTrajectories).
+ */
+void clearLearning(){
+  for(int id = 0; id < MAX_TRAJECTORIES; id++){
+    learned[id].bins = 0;
+    learned[id].complete = false;
+  }
+}
+/**
+ * Record the errors of the trajectories followed (practice runs), for updateLearning.
+ * @param value
+ * true to learn
+ */
+void setLearningMode(bool value){
+  learningMode = value;
+}
+/**
+ * @return
+ * whether the errors of the trajectories followed are recorded
+ */
+bool isLearningMode(){
+  return learningMode;
+}
+/**
+ * Start the record of a run of a trajectory (control task, as it starts following it).
+ * @param id
+ * id of the trajectory
+ */
+void startLearningRun(int id){
+  if(id < 0 || id >= MAX_TRAJECTORIES || learned[id].bins == 0) return;
+  learned[id].lastBin = -1;
+  learned[id].complete = false;
+}
+/**
+ * @param id
+ * id of the trajectory followed
+ *
+ * @param bin
+ * control cycles since it started
+ *
+ * @param powerL, powerR
+ * set to the learned corrections of the bin (0 beyond the trajectory, or without corrections)
+ */
+HOT_PATH void getLearnedFeedforward(int id, int bin, double &powerL, double &powerR){
+  powerL = powerR = 0;
+  if(id < 0 || id >= MAX_TRAJECTORIES || bin < 0 || bin >= learned[id].bins) return;
+  powerL = learned[id].correctionL[bin];
+  powerR = learned[id].correctionR[bin];
+}
+/**
+ * Record the errors of a bin in learning mode (control task). A bin skipped by a late cycle takes the errors of
+ * the next one; the record is complete once the last bin is in.
+ * @param id
+ * id of the trajectory followed
+ *
+ * @param bin
+ * control cycles since it started
+ *
+ * @param errorL, errorR
+ * side errors (inches, setpoint less measured)
+ */
+HOT_PATH void recordLearning(int id, int bin, double errorL, double errorR){
+  if(!learningMode || id < 0 || id >= MAX_TRAJECTORIES) return;
+  LearnedTrajectory &entry = learned[id];
+  if(bin >= entry.bins || bin <= entry.lastBin || entry.complete) return;
+  for(int j = entry.lastBin + 1; j <= bin; j++){
+    entry.errorL[j] = errorL;
+    entry.errorR[j] = errorR;
+  }
+  entry.lastBin = bin;
+  if(bin == entry.bins - 1) entry.complete = true;
+}
+/**
+ * Learning update of a side (refer to learnedFeedforward.hpp).
+ * @param correction
+ * corrections of the side; updated
+ *
+ * @param error
+ * errors of the run
+ *
+ * @param bins
+ * number of bins
+ *
+ * @param moved
+ * scratch for the moved corrections (bins)
+ */
+void learnSide(float *correction, const float *error, int bins, float *moved){
+  const double dt = BASE_CONTROL_DT/1000.0;
+  for(int j = 0; j < bins; j++){
+    int ahead = std::min(j + LEARNING_LEAD, bins - 1);
+    double change = ahead > 0? (error[ahead] - error[ahead - 1])/dt : 0;
+    moved[j] = LEARNING_FORGET*(correction[j] + LEARNING_KP*error[ahead] + LEARNING_KD*change);
+  }
+  /** smoothed, so the noise of one run is not learned */
+  for(int j = 0; j < bins; j++){
+    int first = std::max(j - 1, 0), last = std::min(j + 1, bins - 1);
+    double sum = 0;
+    for(int k = first; k <= last; k++) sum += moved[k];
+    correction[j] = abscap(sum/(last - first + 1), LEARNING_MAX_POWER);
+  }
+}
+/**
+ * Learn from every trajectory followed to the end in learning mode since the last update, and save the
+ * corrections to the microSD card (after the run, e.g. from disabled(); not while the base follows one).
+ * @return
+ * number of trajectories learned from
+ */
+int updateLearning(){
+  int count = 0;
+  for(int id = 0; id < MAX_TRAJECTORIES; id++){
+    LearnedTrajectory &entry = learned[id];
+    const CachedTrajectory *trajectory = getTrajectory(id);
+    if(!entry.complete || trajectory == NULL) continue;
+    uint32_t scratch = getScratchMark();
+    float *moved = (float*) arenaScratch(entry.bins*sizeof(float));
+    if(moved == NULL) continue;
+    learnSide(entry.correctionL, entry.errorL, entry.bins, moved);
+    learnSide(entry.correctionR, entry.errorR, entry.bins, moved);
+    releaseScratch(scratch);
+    entry.runs++;
+    entry.complete = false;
+    count++;
+    if(!usd::is_installed()) continue;
+    char path[64];
+    learningFilePath(trajectory->name, path, sizeof(path));
+    FILE *file = fopen(path, "wb");
+    if(file == NULL) continue;
+    LearningFileHeader header = learningHeader(*trajectory, entry.bins);
+    header.runs = entry.runs;
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(entry.correctionL, sizeof(float), entry.bins, file);
+    fwrite(entry.correctionR, sizeof(float), entry.bins, file);
+    fclose(file);
+  }
+  return count;
+}
+/**
+ * @param id
+ * id of a cached trajectory
+ *
+ * @return
+ * the runs its corrections were learned from (0: none)
+ */
+int getLearningRuns(int id){
+  if(id < 0 || id >= MAX_TRAJECTORIES || learned[id].bins == 0) return 0;
+  return learned[id].runs;
+}
@@ -0,0 +1,101 @@
+/**
+ * LQR gains of the base's position loop (refer to lqrGains.hpp):
+ * - Host step: the discrete Riccati equation of a side per velocity band, written to lqrTable.hpp
+ * - Control loop: the gains at a velocity, interpolated between the bands of the table
+ */
+#include "main.h"
+#include "8059MotionProfileLib/include/lqrTable.hpp"
+static_assert(sizeof(lqrTable)/sizeof(lqrTable[0]) == LQR_BANDS, "lqrTable.hpp is out of date: generate it again (make lqr)");
+/**
+ * Solve the LQR of a side at a velocity.
+ * @param side
+ * feedforward of the side
+ *
+ * @param vel
+ * velocity of the band (in/s)
+ *
+ * @return
+ * the gains of the band (kp in power per inch, kd in power per in/s)
+ */
+LqrBand computeLqrGains(const BaseFeedforward &side, double vel){
+  const double dt = BASE_CONTROL_DT/1000.0;
+  /** exact discretization of x' = [0 1; 0 -rate] x + [0; 1/ka] u, the input held over a cycle */
+  double rate = side.kv/side.ka;
+  double decay = exp(-rate*dt), rise = (1 - decay)/rate;
+  Matrix<2, 2> a = {};
+  a(0, 0) = 1;
+  a(0, 1) = rise;
+  a(1, 1) = decay;
+  Matrix<2, 1> b;
+  b(0, 0) = (dt - rise)/rate/side.ka;
+  b(1, 0) = rise/side.ka;
+  /** Bryson's rule: the errors worth full power, full power being the headroom above the feedforward */
+  Matrix<2, 2> q = {};
+  q(0, 0) = 1/(LQR_MAX_ERROR*LQR_MAX_ERROR);
+  q(1, 1) = 1/(LQR_MAX_VEL_ERROR*LQR_MAX_VEL_ERROR);
+  double headroom = fmax(MAX_POW - side.ks - side.kv*fabs(vel), LQR_MIN_HEADROOM);
+  double r = 1/(headroom*headroom);
+  /** Riccati iteration: p = q + a'p(a - bk), k = (r + b'pb)^-1 b'pa */
+  Matrix<2, 2> p = q, aT = transpose(a);
+  Matrix<1, 2> k = {}, bT = transpose(b);
+  for(int iteration = 0; iteration < LQR_ITERATIONS; iteration++){
+    Matrix<1, 2> bTpa = bT*p*a;
+    k = (1/(r + (bT*p*b)(0, 0)))*bTpa;
+    p = q + aT*p*(a - b*k);
+  }
+  return {fabs(vel), k(0, 0), k(0, 1)};
+}
+/**
+ * Solve the bands of the current drivetrain model (both sides averaged: the position loop has one pair of gains)
+ * and write them to a header as the constexpr lqrTable.
+ * @param path
+ * header to write (include/8059MotionProfileLib/include/lqrTable.hpp, for `make lqr`)
+ *
+ * @return
+ * false if the model is not usable or the file cannot be written
+ */
+bool writeLqrTable(const char *path){
+  BaseModel model = getBaseModel();
+  BaseFeedforward side = {(model.left.ks + model.right.ks)/2, (model.left.kv + model.right.kv)/2,
+                          (model.left.ka + model.right.ka)/2};
+  if(side.kv <= 0 || side.ka <= 0 || side.ks >= MAX_POW) return false;
+  FILE *file = fopen(path, "w");
+  if(file == NULL) return false;
+  double topSpeed = (MAX_POW - side.ks)/side.kv;
+  fprintf(file, "/**\n");
+  fprintf(file, " * LQR gains of the base's position loop by velocity (refer to lqrGains.hpp)\n");
+  fprintf(file, " * Generated by `make lqr` from the drivetrain model ks %g, kv %g, ka %g (the sides averaged); do not\n",
+          side.ks, side.kv, side.ka);
+  fprintf(file, " * edit, generate it again after characterizing the base or changing the weights\n");
+  fprintf(file, " * Bands: vel (in/s), kp (power per inch), kd (power per in/s)\n");
+  fprintf(file, " */\n");
+  fprintf(file, "#ifndef _8059_MOTION_PROFILE_LIB_LQR_TABLE_HPP_\n");
+  fprintf(file, "#define _8059_MOTION_PROFILE_LIB_LQR_TABLE_HPP_\n");
+  fprintf(file, "#include \"8059MotionProfileLib/include/lqrGains.hpp\"\n");
+  fprintf(file, "constexpr LqrBand lqrTable[] = {\n");
+  for(int band = 0; band < LQR_BANDS; band++){
+    LqrBand gains = computeLqrGains(side, topSpeed*band/(LQR_BANDS - 1));
+    fprintf(file, "  {%.4g, %.6g, %.6g}%s\n", gains.vel, gains.kp, gains.kd, band < LQR_BANDS - 1? "," : "");
+  }
+  fprintf(file, "};\n\n#endif\n");
+  return fclose(file) == 0;
+}
+/**
+ * @param vel
+ * velocity of the setpoints (in/s, either sign)
+ *
+ * @return
+ * the gains of the table at the velocity (linear between its bands, those of the end bands beyond them)
+ */
+HOT_PATH LqrBand getLqrGains(double vel){
+  vel = fabs(vel);
+  if(vel <= lqrTable[0].vel) return lqrTable[0];
+  for(int band = 1; band < LQR_BANDS; band++){
+    const LqrBand &lower = lqrTable[band - 1], &upper = lqrTable[band];
+    if(vel < upper.vel){
+      double s = (vel - lower.vel)/(upper.vel - lower.vel);
+      return {vel, lower.kp + s*(upper.kp - lower.kp), lower.kd + s*(upper.kd - lower.kd)};
+    }
+  }
+  return lqrTable[LQR_BANDS - 1];
+}
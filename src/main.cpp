@@ -1,4 +1,21 @@
 #include "main.h"
+/**
+ * Background stages of initialize() (refer to bootSequence.hpp)
+ * calibrateSensors: the robot must stay still until BOOT_CALIBRATION is ready
+ * loadDefaultAuton: the selected routine's trajectories (the default, or the routine of a resumed checkpoint) and the gains of the last tuning run, before
+ * the match instead of during autonomous (the selector prepares another routine when it is chosen), and the
+ * QPs of the MPC tracker
+ */
+void calibrateSensors(){
+	calibrateImu();
+	/** the color sensor is calibrated while the indexer is empty (refer to mech_lib.hpp) */
+	calibrateColor();
+}
+void loadDefaultAuton(){
+	prepareAuton(getSelectedAuton());
+	prepareMpc();
+	markBoot(BOOT_MARK_TRAJECTORIES);
+}
 /**
  * Runs initialization code. This occurs as soon as the program is started.
  *
@@ -6,38 +23,46 @@
  * to keep execution time for this mode under a few seconds.
  */
 void initialize() {
-	/** declaration and initialization of motors, encoders and controller */
-	Motor FL (FLPort, E_MOTOR_GEARSET_18, false, E_MOTOR_ENCODER_DEGREES);
-	Motor BL (BLPort, E_MOTOR_GEARSET_18, false, E_MOTOR_ENCODER_DEGREES);
-	Motor FR (FRPort, E_MOTOR_GEARSET_18, true, E_MOTOR_ENCODER_DEGREES);
-	Motor BR (BRPort, E_MOTOR_GEARSET_18, true, E_MOTOR_ENCODER_DEGREES);
+	/** the motors, sensors and controller are constructed and configured once by the device registry (refer to devices.hpp) */
+	/** tare all motors and reset encoder counts */
+	drivetrain.tare();
+	encoderL.reset();
+	encoderR.reset();
+	markBoot(BOOT_MARK_TARE);
 
-	Motor lRoller (lRollerPort, E_MOTOR_GEARSET_18, false, E_MOTOR_ENCODER_DEGREES);
-	Motor rRoller (rRollerPort, E_MOTOR_GEARSET_18, true, E_MOTOR_ENCODER_DEGREES);
-	Motor indexer (indexerPort, E_MOTOR_GEARSET_06, false, E_MOTOR_ENCODER_DEGREES);
-	Motor shooter (shooterPort, E_MOTOR_GEARSET_06, true, E_MOTOR_ENCODER_DEGREES);
+	/** hand the routine table and the baked trajectories (hot package, auton_sets.cpp) to the library (cold package) */
+	setAutonRoutines(autonRoutines, AUTON_COUNT);
+	setBakedTrajectories(trajectoryBlob, trajectoryBlobSize);
 
-	ADIEncoder encoderL (encdL_port,encdL_port+1,false);
-	ADIEncoder encoderR (encdR_port,encdR_port+1,true);
-	ADIDigitalIn limit (limitPort);
-	ADIAnalogIn color (colorPort);
+	/** print the cost of the hot kernels, and the accuracy of the approximate ones */
+	if(DEBUG_MODE == 5){
+		runBenchmarks(100000);
+		runAccuracySuite(ACCURACY_SAMPLES);
+	}
 
-	Controller master(E_CONTROLLER_MASTER);
+	/** create the asynchronous Tasks (the registry keeps their handles, refer to taskRegistry.cpp) */
+	startRobotTasks();
+	enterPhase(PHASE_DISABLED);
+	markBootReady(BOOT_SENSING);
+	markBoot(BOOT_MARK_TASKS);
 
-	/** tare all motors and reset encoder counts */
-	FL.tare_position();
-	FR.tare_position();
-	BL.tare_position();
-	BR.tare_position();
-	encoderL.reset();
-	encoderR.reset();
+	/** started while the field has the robot enabled: the program restarted during the match, carry on from the last checkpoint (refer to poseCheckpoint.hpp) */
+	bool resumed = pros::competition::is_connected() && !pros::competition::is_disabled() && resumeCheckpoint();
+
+	/**
+	 * the slow stages run in the background, so initialize() returns at once; autonomous and the
+	 * selector wait for a stage only while it is not ready (refer to bootSequence.hpp)
+	 * the brain screen objects are created once, so the screen never allocates during the match (refer to dashboard.hpp)
+	 */
+	/** the robot is moving after a restart in the match: the odometry keeps the IMU as it is, and the color sensor its calibration */
+	if(resumed) markBootReady(BOOT_CALIBRATION);
+	else startBootStage(BOOT_CALIBRATION, calibrateSensors);
+	startBootStage(BOOT_TRAJECTORIES, loadDefaultAuton);
+	startBootStage(BOOT_UI, buildDisplay);
 
-	/** declaration and initialization of asynchronous Tasks */
-	Task baseOdometryTask(baseOdometry, (void*)"PROS", TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT);
-	Task baseControlTask(baseControl, (void*)"PROS", TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT);
-	Task baseMotorControlTask(baseMotorControl, (void*)"PROS", TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT);
-	Task shooterControlTask(shooterControl, (void*)"PROS", TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT);
-	// Task shooterMotorControlTask(shooterMotorControl, (void*)"PROS", TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT);
+	/** from here on, a heap allocation in a real-time task is flagged (ALLOC_GUARD builds, refer to allocGuard.hpp) */
+	armAllocGuard();
+	markBoot(BOOT_MARK_INITIALIZED);
 }
 
 /**
@@ -45,7 +70,17 @@ void initialize() {
  * the VEX Competition Switch, following either autonomous or opcontrol. When
  * the robot is enabled, this task will exit.
  */
-void disabled() {}
+void disabled() {
+	enterPhase(PHASE_DISABLED);
+	/** close the run file, so it is complete even if the robot is switched off */
+	stopRecorder();
+	/** learn from the trajectories of a practice run followed in learning mode (refer to learnedFeedforward.hpp) */
+	updateLearning();
+	/** save a macro still being recorded */
+	if(isMacroRecording()) stopMacroRecording();
+	/** the precompute task runs while disabled: keep the selected routine prepared and its trajectories in the cache (refer to precompute.hpp) */
+	queuePrecompute(PRECOMPUTE_PREPARE);
+}
 
 /**
  * Runs after initialize(), and before autonomous when connected to the Field
@@ -56,7 +91,16 @@ void disabled() {}
  * This task will exit when the robot is enabled and autonomous or opcontrol
  * starts.
  */
-void competition_initialize() {}
+void competition_initialize() {
+	/** choose the routine on the brain screen and prepare it as soon as it is chosen (refer to autonSelector.hpp) */
+	showAutonSelector();
+	/** the robot waits on the field until the match: recalibrate the IMU once it stands still */
+	queuePrecompute(PRECOMPUTE_IMU);
+	while(true){
+		updateAutonSelector();
+		pros::delay(20);
+	}
+}
 
 /**
  * Runs the user autonomous code. This function will be started in its own task
@@ -70,15 +114,15 @@ void competition_initialize() {}
  * from where it left off.
  */
 void autonomous() {
-	/** numerical choice of which autonomous set to run */
-	int autonNum = 0;
-	switch (autonNum){
-		case 0: skills(); break;
-		case 1: blueLeft(); break;
-		case 2: blueRight(); break;
-		case 3: redLeft(); break;
-		case 4: redRight(); break;
-	}
+	/** start the base controller (it parks once the robot is disabled), and give it the base */
+	enterPhase(PHASE_AUTON);
+	setBaseControlMode(BASE_MODE_AUTON);
+	/** log the run to the microSD card */
+	startRecorder();
+	/** scoring throughput of this run only (refer to ShooterMetrics) */
+	resetShooterMetrics();
+	/** the routine chosen on the selector, prepared during competition_initialize (refer to auton_sets.cpp) */
+	runSelectedAuton();
 }
 
 /**
@@ -95,45 +139,40 @@ void autonomous() {
  * task, not resume it from where it left off.
  */
 void opcontrol() {
-	/** set the value to a small non-zero value (e.g. 5) to brake (see movement mechanism below)  */
-	double BRAKE_POW = 0;
-
-	/** declare reference to motors and controller */
-	Motor FL (FLPort);
-	Motor BL (BLPort);
-	Motor FR (FRPort);
-	Motor BR (BRPort);
-	Motor lRoller (lRollerPort);
-	Motor rRoller (rRollerPort);
-	Motor indexer (indexerPort);
-	Controller master(E_CONTROLLER_MASTER);
-	master.clear();
-
-	/** boolean flag for whether the driver uses tank drive or not */
-	bool tankDrive = false;
+	/**
+	 * take the base over from the base controller, which keeps running (the odometry, the assist
+	 * movements and the flight record stay live; the devices are in the registry, refer to devices.hpp)
+	 */
+	enterPhase(PHASE_DRIVER);
+	setBaseControlMode(BASE_MODE_DRIVER);
+	clearDisplay();
+	/**
+	 * stick response, slew limiting, button bindings and brake mode of the driver (refer to driverInput.hpp);
+	 * the controllers are sampled by the controllerService task
+	 */
+	DriverControls controls;
+	resetDriverControls(controls, getControllerState());
+	drivetrain.setBrakeMode(DRIVE_BRAKE_MODE);
+	/** log the driver run to the microSD card (the base controller records it, at its rate) */
+	startRecorder();
+	/** its loop is timed like the tasks, so its CPU share is in the load report (refer to taskTiming.hpp) */
+	startTaskTiming(TIMING_OPCONTROL, 5, false);
 	while (true) {
-		/** toggle tank drive */
-		if(master.get_digital_new_press(DIGITAL_Y)) tankDrive = !tankDrive;
-		/** handle tankDrive */
-		if(tankDrive){
-      int l = master.get_analog(ANALOG_LEFT_Y);
-      int r = master.get_analog(ANALOG_RIGHT_Y);
-      FL.move(l-BRAKE_POW);
-      BL.move(l+BRAKE_POW);
-      FR.move(r-BRAKE_POW);
-      BR.move(r+BRAKE_POW);
-    } else{
-      int y = master.get_analog(ANALOG_LEFT_Y);
-      int x = master.get_analog(ANALOG_RIGHT_X);
-      FL.move(y+x-BRAKE_POW);
-      BL.move(y+x+BRAKE_POW);
-      FR.move(y-x-BRAKE_POW);
-      BR.move(y-x+BRAKE_POW);
-    }
-		intakeMove((master.get_digital(DIGITAL_R1) - master.get_digital(DIGITAL_R2)) * 127);
-		setDiscard(master.get_digital(DIGITAL_L2));
-		if(master.get_digital(DIGITAL_L1)) cycle();
-		if(master.get_digital(DIGITAL_X)) forceStop();
+		beginTaskIteration(TIMING_OPCONTROL);
+		ControllerState pad = getControllerState(), partnerPad = getControllerState(CONTROLLER_PARTNER);
+		/** off the competition switch, MACRO_RECORD_BUTTON starts and stops recording a macro (refer to inputMacro.hpp) */
+		if(pad.pressedSince(controls.prev, MACRO_RECORD_BUTTON) && !pros::competition::is_connected()){
+			if(isMacroRecording()) stopMacroRecording();
+			else startMacroRecording();
+		}
+		if(isMacroRecording()) recordMacroFrame(pad, partnerPad);
+		/** off the competition switch, DRY_RUN_BUTTON times the selected routine with the robot still (refer to dryRun.hpp) */
+		if(pad.pressedSince(controls.prev, DRY_RUN_BUTTON) && !pros::competition::is_connected()){
+			dryRunAuton(getSelectedAuton());
+			resetDriverControls(controls, getControllerState());
+		}
+		runDriverControls(controls, pad, partnerPad);
+		endTaskIteration(TIMING_OPCONTROL);
 		pros::delay(5);
 	}
 }
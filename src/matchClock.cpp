@@ -0,0 +1,46 @@
+/**
+ * Match clock functions:
+ * - Start of the autonomous period
+ * - Time elapsed and left, and whether an action still fits
+ */
+#include "main.h"
+/** start of the period (millis) and its length in ms (0: the clock was never started) */
+std::atomic<uint32_t> matchStart(0), matchPeriod(0);
+/**
+ * Start the match clock. Called by the routine runner (runSelectedAuton) as autonomous() starts.
+ * @param period
+ * length of the period in ms
+ *
+ * @param elapsed
+ * ms of the period already run (a routine resumed after a restart, refer to poseCheckpoint.hpp)
+ */
+void startMatchClock(uint32_t period, uint32_t elapsed){
+  matchStart = millis() - elapsed;
+  matchPeriod = period;
+}
+/**
+ * @return
+ * ms since the start of the period (0 if the clock was never started)
+ */
+uint32_t getMatchTime(){
+  return matchPeriod == 0? 0 : millis() - matchStart;
+}
+/**
+ * @return
+ * ms left in the period, negative once it is over (AUTON_PERIOD if the clock was never started,
+ * e.g. a routine run from opcontrol for testing)
+ */
+int32_t getMatchTimeLeft(){
+  return matchPeriod == 0? AUTON_PERIOD : (int32_t)(matchPeriod - getMatchTime());
+}
+/**
+ * Whether an action still fits in the period.
+ * @param estimate
+ * ms the action takes
+ *
+ * @return
+ * true if the time left covers the estimate and MATCH_TIME_MARGIN
+ */
+bool hasMatchTime(uint32_t estimate){
+  return getMatchTimeLeft() >= (int32_t)(estimate + MATCH_TIME_MARGIN);
+}
@@ -1,7 +1,8 @@
 /**
  * Mathematical functions:
- * - angle bounding functions
+ * - angle bounding functions (inline wrapping & shortest difference in mathUtils.hpp)
  * - capping function
+ * - fast trigonometry (sine table generated at compile time, atan2 polynomial)
  */
 #include "main.h"
 /**
@@ -13,6 +14,14 @@
  * angle in radians bounded within 0<=angle<twoPI
  */
 double boundRad(double rad){
+  /** usual case: at most one turn out of range */
+  if(rad >= 0 && rad < twoPI) return rad;
+  if(rad >= -twoPI && rad < 0){
+    double res = rad + twoPI;
+    /** rad + twoPI rounds up to twoPI for tiny negative angles */
+    return res < twoPI? res : 0;
+  }
+  if(rad >= twoPI && rad < 2*twoPI) return rad - twoPI;
   double res = fmod(rad, twoPI);
   if(res < 0) res += twoPI;
   return res;
@@ -26,6 +35,13 @@ double boundRad(double rad){
  * angle in degrees bounded within 0<=angle<360
  */
 double boundDeg(double deg){
+  /** usual case: at most one turn out of range */
+  if(deg >= 0 && deg < 360) return deg;
+  if(deg >= -360 && deg < 0){
+    double res = deg + 360;
+    return res < 360? res : 0;
+  }
+  if(deg >= 360 && deg < 720) return deg - 360;
   double res = fmod(deg, 360);
   if(res < 0) res += 360;
   return res;
@@ -51,3 +67,91 @@ double abscap(double x, double abscap){
   else if(x < -abscap) return -abscap;
   else return x;
 }
+/**
+ * Sine computed by its Taylor series, for generating the table at compile time.
+ * @param x
+ * angle in radians within -PI<=x<=PI
+ *
+ * @return
+ * sin(x), accurate to double precision
+ */
+constexpr double taylorSin(double x){
+  double term = x, sum = x;
+  for(int n = 1; n < 20; n++){
+    term *= -x*x/((2*n)*(2*n + 1));
+    sum += term;
+  }
+  return sum;
+}
+/** sine of TRIG_TABLE_SIZE + 1 evenly spaced angles over 0<=angle<=twoPI */
+struct TrigTable{
+  double value[TRIG_TABLE_SIZE + 1];
+};
+/**
+ * Generate the sine table at compile time.
+ * @return
+ * the sine table
+ */
+constexpr TrigTable makeSinTable(){
+  TrigTable table = {};
+  for(int i = 0; i <= TRIG_TABLE_SIZE; i++){
+    double x = twoPI*i/TRIG_TABLE_SIZE;
+    if(x > PI) x -= twoPI;
+    table.value[i] = taylorSin(x);
+  }
+  return table;
+}
+constexpr TrigTable sinTable = makeSinTable();
+/**
+ * Sine from the table with linear interpolation (no fmod or libm call).
+ * @param x
+ * angle in radians (any value)
+ *
+ * @return
+ * sin(x) within 4.8e-6
+ */
+HOT_PATH double fastSin(double x){
+  double u = x*(TRIG_TABLE_SIZE/twoPI);
+  /** floor without libm: truncation rounds negative values up */
+  int64_t k = (int64_t)u;
+  if(u < k) k--;
+  double frac = u - k;
+  int i = k & (TRIG_TABLE_SIZE - 1);
+  return sinTable.value[i] + frac*(sinTable.value[i + 1] - sinTable.value[i]);
+}
+/**
+ * Cosine from the sine table.
+ * @param x
+ * angle in radians (any value)
+ *
+ * @return
+ * cos(x) within 4.8e-6
+ */
+HOT_PATH double fastCos(double x){
+  return fastSin(x + halfPI);
+}
+/**
+ * Polynomial approximation of atan2 (no libm call).
+ * The argument is reduced to an octant so that the polynomial only has to cover 0<=z<=1.
+ * @param y
+ * y-component
+ *
+ * @param x
+ * x-component
+ *
+ * @return
+ * angle of (x, y) wrt the x-axis in radians within -PI<=angle<=PI, within 2e-6 rad
+ */
+HOT_PATH double fastAtan2(double y, double x){
+  double absX = fabs(x), absY = fabs(y);
+  if(absX == 0 && absY == 0) return 0;
+  /** z = min/max is within 0<=z<=1 */
+  bool swap = absY > absX;
+  double z = swap? absX/absY : absY/absX;
+  double z2 = z*z;
+  /** minimax polynomial of atan(z) on 0<=z<=1 */
+  double angle = z*(0.99997726 + z2*(-0.33262347 + z2*(0.19354346 + z2*(-0.11643287 + z2*(0.05265332 + z2*(-0.01172120))))));
+  if(swap) angle = halfPI - angle;
+  if(x < 0) angle = PI - angle;
+  return y < 0? -angle : angle;
+}
@@ -1,55 +1,804 @@
 #include "main.h"
 #include "mech_lib.hpp"
-Motor lRoller (lRollerPort);
-Motor rRoller (rRollerPort);
-Motor indexer (indexerPort);
-Motor shooter (shooterPort);
-ADIDigitalIn limit (limitPort);
-ADIAnalogIn color (colorPort);
-
-double cycleSpeed = 127;
-bool cycleTrigger = false, isDiscard = false, forceStopTrigger = false, limitOccupied = false;
-// double targetIndexerPower = 0, targetShooterPower = 0;
-// double indexerKP = 1, shooterKP = 1;
+/** the motors and the color sensor are in the device registry (refer to devices.hpp) */
 
+/**
+ * Shooter commands from the opcontrol or autonomous task to the shooterControl task,
+ * which is woken by every command
+ */
+Mailbox<ShooterCommand, SHOOTER_QUEUE_SIZE> shooterCommands;
+/** last discard request (producer only, so setDiscard queues changes only) */
+bool discardRequested = false;
+/**
+ * cycles queued (moved by the producer) and finished, given up or dropped (moved by the consumer),
+ * and the state (written by the shooterControl task only)
+ */
+std::atomic<uint32_t> cyclesQueued(0), cyclesDone(0);
+std::atomic<ShooterState> shooterState(SHOOTER_IDLE);
+/** names of the states in the exported timelines (refer to timeline.hpp) */
+const char *shooterStateNames[] = {"idle", "indexing", "firing", "discarding", "jam recovery"};
+/** shooter velocity controller (only used by the shooterControl task), its velocity and readiness */
+VelocityController shooterVelocity(360, SHOOTER_KP, SHOOTER_KD, SHOOTER_KV, SHOOTER_READY_RULE);
+std::atomic<bool> shooterReady(false);
+std::atomic<float> shooterRpm(0);
+/**
+ * speed table (refer to SHOOTER_SPEED_TABLE), the goal the speed is aimed at (active: a goal is set;
+ * x, y: its position in inches) and the current speed target (written by the shooterControl task only)
+ */
+const ShooterSpeedPoint shooterSpeedTable[] = SHOOTER_SPEED_TABLE;
+#define SHOOTER_SPEED_POINTS (int)(sizeof(shooterSpeedTable)/sizeof(*shooterSpeedTable))
+struct ShooterGoal {
+  bool active;
+  double x, y;
+};
+SeqLock<ShooterGoal> shooterGoal(ShooterGoal{false, 0, 0});
+std::atomic<float> shooterTarget(SHOOTER_RPM);
+/** balls per second of the last burst (written by the shooterControl task only) */
+std::atomic<float> burstRate(0);
+/** alliance color (balls of the other color are ejected), last classified ball and sensor reading */
+std::atomic<BallColor> sortColor(BALL_NONE), ballColor(BALL_NONE);
+std::atomic<int> colorReading(0);
+/** ball occupancy: BallSlot bits and balls in the robot (written by the shooterControl task only) */
+std::atomic<uint32_t> ballSlots(0);
+std::atomic<int> ballCount(0);
+/** throughput (written by the shooterControl task only), and a reset asked for by resetShooterMetrics */
+SeqLock<ShooterMetrics> shooterMetrics(ShooterMetrics{});
+std::atomic<bool> metricsResetPending(false);
+
+bool queueShooterCommand(ShooterCommand command) {
+  return shooterCommands.post(command);
+}
+
+/**
+ * roller power requested by intakeMove, or the rollers synchronized with the base by intakeSync (applied by
+ * the shooterControl task, with the jam recovery), and the stall detectors of the rollers and the indexer
+ * (used by the shooterControl task only)
+ */
+std::atomic<int> intakePower(0);
+std::atomic<bool> intakeSynced(false);
+StallDetector lRollerStall, rRollerStall, indexerStall;
+
+/**
+ * Run the rollers; the shooterControl task applies the power and clears roller jams.
+ * @param speed
+ * roller power (-127 to 127)
+ */
 void intakeMove(int speed) {
-  lRoller.move(speed);
-  rRoller.move(speed);
+  intakeSynced = false;
+  intakePower = speed;
+}
+
+/**
+ * Run the rollers at a surface speed that follows the forward speed of the robot (refer to INTAKE_SYNC_RATIO),
+ * until the next intakeMove.
+ */
+void intakeSync() {
+  intakeSynced = true;
+}
+
+/**
+ * Roller speed of intakeSync.
+ * @param velocity
+ * forward speed of the robot (inches per second)
+ *
+ * @return
+ * roller motor speed in rpm
+ */
+double intakeSyncSpeed(double velocity) {
+  double surface = INTAKE_SYNC_RATIO * std::max(velocity, 0.0) + INTAKE_SYNC_OFFSET;
+  return std::min(surface * 60 / INTAKE_SURFACE_PER_REV, (double)INTAKE_MAX_RPM);
+}
+
+/**
+ * Check a motor for a stall and report it to telemetry.
+ * @param snapshot
+ * the latest motor snapshot (refer to motorSnapshot.hpp)
+ *
+ * @return
+ * true if the motor is jammed
+ */
+bool checkJam(const MotorSnapshot &snapshot, HealthMotor motor, StallDetector &detector, int power, uint64_t now) {
+  double current = snapshot.current[motor], velocity = snapshot.velocity[motor];
+  if(!detector.isStalled(power, current, velocity, now)) return false;
+  pushTelemetry(TELEMETRY_JAM, healthPorts[motor], current, velocity);
+  detector.reset();
+  return true;
+}
+
+/**
+ * Queue one shooting cycle. Returns immediately.
+ * @return
+ * false if the queue is full (the cycle is dropped)
+ */
+bool cycle() {
+  /** count it first, so the shooter task never finishes a cycle that is not counted yet */
+  cyclesQueued++;
+  if(queueShooterCommand(SHOOTER_CYCLE)) return true;
+  cyclesQueued--;
+  return false;
 }
 
-void cycle() {
-  cycleTrigger = true;
+/**
+ * Queue a burst: the balls fire back to back at the least safe spacing (refer to SHOOTER_BURST_SPACING),
+ * each next ball staged while the previous one leaves. Returns immediately.
+ * @param count
+ * number of balls
+ *
+ * @return
+ * false if the queue is full (the rest of the burst is dropped)
+ */
+bool burst(int count) {
+  for(int i = 0; i < count; i++) {
+    cyclesQueued++;
+    if(!queueShooterCommand(SHOOTER_BURST_CYCLE)) {
+      cyclesQueued--;
+      return false;
+    }
+  }
+  return true;
 }
 
 void setDiscard(bool value) {
-  isDiscard = value;
-  forceStopTrigger = value;
+  if(value == discardRequested) return;
+  if(queueShooterCommand(value ? SHOOTER_DISCARD_ON : SHOOTER_DISCARD_OFF)) discardRequested = value;
 }
 
 void forceStop() {
-  forceStopTrigger = true;
+  queueShooterCommand(SHOOTER_STOP);
+}
+
+/**
+ * Keep the shooter at speed between cycles (e.g. before autonomous reaches the goal), so a cycle
+ * fires as soon as its ball is staged.
+ * @param value
+ * true: spin while idle
+ */
+void setShooterSpin(bool value) {
+  queueShooterCommand(value ? SHOOTER_SPIN_ON : SHOOTER_SPIN_OFF);
+}
+
+/**
+ * @return
+ * number of cycles queued or running
+ */
+int getShooterPending() {
+  return cyclesQueued - cyclesDone;
+}
+
+ShooterState getShooterState() {
+  return shooterState;
+}
+
+/**
+ * @return
+ * true if the shooter is at its target speed (within SHOOTER_READY_RULE)
+ */
+bool isShooterReady() {
+  return shooterReady;
+}
+
+/**
+ * @return
+ * estimated shooter velocity in rpm
+ */
+double getShooterVelocity() {
+  return shooterRpm;
+}
+
+/**
+ * Shooter speed for a shot from a distance, from SHOOTER_SPEED_TABLE.
+ * @param distance
+ * distance to the goal (inches)
+ *
+ * @return
+ * speed in rpm, rounded to SHOOTER_SPEED_STEP
+ */
+double shooterSpeedAt(double distance) {
+  const ShooterSpeedPoint *table = shooterSpeedTable;
+  double rpm = table[SHOOTER_SPEED_POINTS - 1].rpm;
+  if(distance <= table[0].distance) rpm = table[0].rpm;
+  else for(int i = 1; i < SHOOTER_SPEED_POINTS; i++) {
+    if(distance > table[i].distance) continue;
+    double f = (distance - table[i - 1].distance) / (table[i].distance - table[i - 1].distance);
+    rpm = table[i - 1].rpm + f * (table[i].rpm - table[i - 1].rpm);
+    break;
+  }
+  return round(rpm / SHOOTER_SPEED_STEP) * SHOOTER_SPEED_STEP;
+}
+
+/**
+ * Aim the shooter speed at a goal: the speed follows the distance from the live pose (refer to
+ * SHOOTER_SPEED_TABLE), and the shooter spins up to it while idle, so it is at speed when the robot arrives.
+ * @param x, y
+ * position of the goal (inches)
+ */
+void setShooterGoal(double x, double y) {
+  shooterGoal.write({true, x, y});
+}
+
+/**
+ * Go back to SHOOTER_RPM, spinning while idle only as setShooterSpin says.
+ */
+void clearShooterGoal() {
+  shooterGoal.write({false, 0, 0});
+}
+
+/**
+ * @return
+ * current shooter speed target in rpm (SHOOTER_RPM, or the speed for the distance to the goal)
+ */
+double getShooterTarget() {
+  return shooterTarget;
+}
+
+/**
+ * @return
+ * balls per second of the last burst, from the first ball out to the last (0 before a burst of two)
+ */
+double getBurstRate() {
+  return burstRate;
+}
+
+/**
+ * Wait until every queued cycle has run (instead of a fixed delay in autonomous).
+ * @param timeout
+ * maximum wait in ms
+ *
+ * @return
+ * false if cycles were still pending at the timeout
+ */
+bool waitShooter(uint32_t timeout) {
+  Timer timer;
+  recordTimeline(TIMELINE_WAIT_BEGIN, TIMELINE_WAIT_SHOOTER);
+  while(getShooterPending() > 0) {
+    if(timer.passed(timeout)) {
+      recordTimeline(TIMELINE_WAIT_END, TIMELINE_WAIT_SHOOTER, 1);
+      return false;
+    }
+    delay(SHOOTER_DT);
+  }
+  recordTimeline(TIMELINE_WAIT_END, TIMELINE_WAIT_SHOOTER);
+  return true;
+}
+
+/**
+ * Calibrate the color sensor with the indexer empty (blocks for about 0.5 s; call from initialize).
+ */
+void calibrateColor() {
+  color.calibrate();
+}
+
+/**
+ * Eject balls of the other alliance's color automatically.
+ * @param alliance
+ * color of the balls to keep (BALL_NONE: keep every ball)
+ */
+void setSortColor(BallColor alliance) {
+  sortColor = alliance;
+}
+
+BallColor getBallColor() {
+  return ballColor;
+}
+
+int getColorReading() {
+  return colorReading;
+}
+
+/**
+ * Classify the ball in front of the color sensor.
+ * @param reading
+ * calibrated high resolution reading
+ *
+ * @return
+ * its color (BALL_NONE if no ball)
+ */
+BallColor classifyBall(int reading) {
+  if(reading < COLOR_RED_THRESHOLD) return BALL_RED;
+  if(reading < COLOR_BALL_THRESHOLD) return BALL_BLUE;
+  return BALL_NONE;
+}
+
+/**
+ * @return
+ * balls in the robot: counted in at the color sensor and out at the limit switch, plus one in the rollers
+ */
+int getBallCount() {
+  return ballCount;
+}
+
+/**
+ * @return
+ * BallSlot bits of the positions holding a ball
+ */
+uint32_t getBallSlots() {
+  return ballSlots;
+}
+
+bool isRobotFull() {
+  return ballCount >= BALL_CAPACITY;
+}
+
+/**
+ * Wait until the robot holds a number of balls (e.g. stop intaking once full).
+ * @param count
+ * number of balls
+ *
+ * @param timeout
+ * maximum wait in ms
+ *
+ * @return
+ * false at the timeout
+ */
+bool waitBallCount(int count, uint32_t timeout) {
+  Timer timer;
+  while(ballCount < count) {
+    if(timer.passed(timeout)) return false;
+    delay(SHOOTER_DT);
+  }
+  return true;
+}
+
+/**
+ * @return
+ * the throughput counters and the times of the latest goal cycle (refer to ShooterMetrics)
+ */
+ShooterMetrics getShooterMetrics() {
+  return shooterMetrics.read();
+}
+
+/**
+ * Start the throughput over (e.g. at the start of a skills run); the shooterControl task clears it at its next tick.
+ */
+void resetShooterMetrics() {
+  metricsResetPending = true;
+}
+
+/**
+ * Throughput accounting of the shooterControl task (refer to ShooterMetrics)
+ * metrics: what is published
+ * intakeTimes: intake times (millis) of the balls in the robot, oldest first (queued of them)
+ * cycleStart: end of the previous goal cycle (millis); lastShot: time of the latest shot (millis)
+ * volleyShots, volleyLatency: shots since the previous goal cycle, and the sum of their intake to shot times (ms)
+ * intakeToShotSum, cycleSum: sums of the means (ms)
+ * indexing, spinup, firing, stalled: stage times of the current goal cycle (ms)
+ */
+struct ThroughputTracker {
+  ShooterMetrics metrics;
+  uint32_t intakeTimes[BALL_CAPACITY];
+  int queued;
+  uint32_t cycleStart, lastShot;
+  uint32_t volleyShots, volleyLatency;
+  uint64_t intakeToShotSum, cycleSum;
+  uint32_t indexing, spinup, firing, stalled;
+};
+
+/**
+ * Start the accounting over.
+ * @param now
+ * millis
+ */
+void resetThroughput(ThroughputTracker &tracker, uint32_t now) {
+  tracker = {};
+  tracker.cycleStart = now;
+}
+
+/**
+ * Count a ball taken in.
+ * @param now
+ * millis
+ */
+void countIntake(ThroughputTracker &tracker, uint32_t now) {
+  tracker.metrics.intaken++;
+  /** more balls than the capacity: the oldest was missed on its way out */
+  if(tracker.queued == BALL_CAPACITY) {
+    memmove(tracker.intakeTimes, tracker.intakeTimes + 1, (BALL_CAPACITY - 1) * sizeof(uint32_t));
+    tracker.queued--;
+  }
+  tracker.intakeTimes[tracker.queued++] = now;
+}
+
+/**
+ * Count balls out of the robot (the oldest ones in).
+ * @param count
+ * number of balls
+ *
+ * @param discarded
+ * true: ejected, false: shot
+ *
+ * @param now
+ * millis
+ */
+void countBallsOut(ThroughputTracker &tracker, int count, bool discarded, uint32_t now) {
+  ShooterMetrics &metrics = tracker.metrics;
+  for(int i = 0; i < count; i++) {
+    /** intake time of the ball (none if it came in unseen, e.g. preloaded) */
+    bool timed = tracker.queued > 0;
+    uint32_t intake = timed ? tracker.intakeTimes[0] : now;
+    if(timed) memmove(tracker.intakeTimes, tracker.intakeTimes + 1, --tracker.queued * sizeof(uint32_t));
+    if(discarded) {
+      metrics.discarded++;
+      continue;
+    }
+    metrics.shot++;
+    tracker.lastShot = now;
+    tracker.volleyShots++;
+    if(!timed) continue;
+    metrics.lastIntakeToShot = now - intake;
+    tracker.intakeToShotSum += metrics.lastIntakeToShot;
+    tracker.volleyLatency += metrics.lastIntakeToShot;
+    metrics.meanIntakeToShot = tracker.intakeToShotSum / metrics.shot;
+  }
+}
+
+/**
+ * Add a tick to the stage times of the goal cycle, and finish the cycle once its volley is over
+ * (SHOOTER_VOLLEY_GAP after its last shot; reported to the telemetry as TELEMETRY_CYCLE).
+ * @param state
+ * state of the shooter in the tick
+ *
+ * @param staged
+ * a ball is at the limit switch
+ *
+ * @param stalled
+ * the rollers run a jam reverse pulse
+ *
+ * @param dt
+ * length of the tick (ms)
+ *
+ * @param now
+ * millis
+ */
+void stepThroughput(ThroughputTracker &tracker, ShooterState state, bool staged, bool stalled, uint32_t dt, uint32_t now) {
+  if(state == SHOOTER_JAM_RECOVERY || stalled) tracker.stalled += dt;
+  else if(state == SHOOTER_INDEXING) (staged ? tracker.spinup : tracker.indexing) += dt;
+  else if(state == SHOOTER_FIRING) tracker.firing += dt;
+  if(tracker.volleyShots == 0 || now - tracker.lastShot < SHOOTER_VOLLEY_GAP) return;
+  ShooterMetrics &metrics = tracker.metrics;
+  metrics.lastCycle = tracker.lastShot - tracker.cycleStart;
+  metrics.lastShots = tracker.volleyShots;
+  tracker.cycleSum += metrics.lastCycle;
+  metrics.meanCycle = tracker.cycleSum / ++metrics.cycles;
+  metrics.indexing = tracker.indexing;
+  metrics.spinup = tracker.spinup;
+  metrics.firing = tracker.firing;
+  metrics.stalled = tracker.stalled;
+  pushTelemetry(TELEMETRY_CYCLE, metrics.lastCycle, metrics.lastShots, tracker.volleyLatency / tracker.volleyShots,
+                metrics.indexing, metrics.spinup, metrics.stalled);
+  tracker.cycleStart = tracker.lastShot;
+  tracker.volleyShots = tracker.volleyLatency = 0;
+  tracker.indexing = tracker.spinup = tracker.firing = tracker.stalled = 0;
+}
+
+/**
+ * Move of the indexer (INDEXER_POSITION_CONTROL, used by the shooterControl task only)
+ * profile: the move of one slot, in degrees; start: its starting time (micros)
+ * origin, target: encoder positions in degrees at its start and end (the target is held between moves)
+ * moving: the move is not done yet
+ */
+struct IndexerMove {
+  MotionProfile profile;
+  uint64_t start;
+  double origin, target;
+  bool moving;
+};
+
+/**
+ * Hold the indexer where it is, dropping the move (e.g. after running it open loop).
+ * @param position
+ * encoder position in degrees
+ */
+void syncIndexerMove(IndexerMove &move, double position) {
+  move.origin = move.target = position;
+  move.moving = false;
+}
+
+/**
+ * Start a move of one slot from the held position.
+ * @param now
+ * micros
+ */
+void startIndexerMove(IndexerMove &move, uint64_t now) {
+  move.profile.generate(INDEXER_SLOT, INDEXER_MAX_VEL, INDEXER_MAX_ACC, 1, PROFILE_TRAPEZOIDAL);
+  move.origin = move.target;
+  move.target += INDEXER_SLOT;
+  move.start = now;
+  move.moving = true;
+}
+
+/**
+ * Follow the move, or hold its target once it is done.
+ * @param position
+ * encoder position in degrees
+ *
+ * @param now
+ * micros
+ *
+ * @return
+ * velocity command in rpm: the velocity of the move plus INDEXER_KP times the position error
+ */
+double stepIndexerMove(IndexerMove &move, double position, uint64_t now) {
+  double setpoint = move.target, velocity = 0;
+  if(move.moving) {
+    double t = (now - move.start)*1e-6;
+    ProfileSetpoint sample = move.profile.sample(t);
+    setpoint = move.origin + sample.pos;
+    velocity = sample.vel;
+    if(t >= move.profile.getDuration() && fabs(move.target - position) < INDEXER_SETTLE) move.moving = false;
+  }
+  /** degrees per second to rpm, capped at the 600 rpm cartridge */
+  return std::max(std::min(velocity/6 + INDEXER_KP*(setpoint - position), 600.0), -600.0);
 }
 
 void shooterControl(void * ignore) {
   shooter.set_brake_mode(MOTOR_BRAKE_HOLD);
+  shooterCommands.setReceiver(pros::c::task_get_current());
+  setTimelineMechanism(SHOOTER_TIMELINE, "shooter", shooterStateNames, sizeof(shooterStateNames)/sizeof(*shooterStateNames));
+  ShooterState state = SHOOTER_IDLE;
+  bool discard = false, spin = false;
+  int pending = 0, retries = 0;
+  /**
+   * burst fire: cycles of the pending ones that are part of a burst, and when the last ball left,
+   * the first ball of the burst left and the balls out so far (millis)
+   */
+  int burstPending = 0, burstShots = 0;
+  uint32_t lastShot = 0, burstStart = 0;
+  Timer stateTimer;
+  /** color sorting: the readings' median, candidate color, its consecutive samples, and the end of the current ejection */
+  Median<COLOR_MEDIAN_SAMPLES> colorFilter = {};
+  BallColor seenColor = BALL_NONE;
+  int seenSamples = 0;
+  uint32_t ejectUntil = 0;
+  /** ball tracking: sensor states of the previous tick and the ball count */
+  bool wasAtColor = false;
+  int balls = 0;
+  /** the limit switch is sampled and debounced by the input service (refer to inputService.hpp) */
+  int limitInput = addDigitalInput(limitPort);
+  int limitEvents = subscribeInputs(1u << limitInput);
+  /** jam recovery: end of the current roller reverse pulse, and the indexer power of the last tick */
+  uint32_t rollerReverseUntil = 0;
+  int indexerPower = 0;
+  /** position-controlled indexing: the move in progress (refer to INDEXER_POSITION_CONTROL) */
+  IndexerMove indexerMove;
+  syncIndexerMove(indexerMove, indexer.get_position());
+  /** throughput: the accounting, and the time of the previous tick (millis) */
+  ThroughputTracker throughput;
+  uint32_t lastTick = millis();
+  resetThroughput(throughput, lastTick);
+  startTaskTiming(TIMING_SHOOTER, SHOOTER_DT, false);
   while(true) {
-    shooter.move(0);
-    if (isDiscard) {
-      indexer.move(cycleSpeed / 2);
-      shooter.move(-cycleSpeed);
-    }else if(cycleTrigger) {
-      forceStopTrigger = false;
-      indexer.move(cycleSpeed);
-      shooter.move(cycleSpeed);
-
-      while(!limit.get_value() && !forceStopTrigger) delay(5);
-      while(limit.get_value() && !forceStopTrigger) delay(5);
-
-      cycleTrigger = false;
-    }else {
-      indexer.move(0);
-      shooter.move(0);
-    }
-    delay(5);
+    if(waitTaskActive(ROBOT_SHOOTER)) startTaskTiming(TIMING_SHOOTER, SHOOTER_DT, false);
+    beginTaskIteration(TIMING_SHOOTER);
+    /** take the queued commands */
+    bool abort = false;
+    ShooterCommand command;
+    while(shooterCommands.take(command)) {
+      switch(command) {
+        case SHOOTER_CYCLE: pending++; break;
+        case SHOOTER_BURST_CYCLE:
+          if(burstPending == 0) burstShots = 0;
+          pending++;
+          burstPending++;
+          break;
+        case SHOOTER_DISCARD_ON: discard = true; break;
+        case SHOOTER_DISCARD_OFF: discard = false; break;
+        case SHOOTER_SPIN_ON: spin = true; break;
+        case SHOOTER_SPIN_OFF: spin = false; break;
+        case SHOOTER_STOP:
+          cyclesDone += pending;
+          pending = 0;
+          abort = true;
+          break;
+      }
+    }
+    /** limit switch edges since the last tick (a ball can pass the switch between two ticks) */
+    int ballsLeft = 0;
+    InputEvent event;
+    while(popInputEvent(limitEvents, event)) if(!event.rising) ballsLeft++;
+    bool staged = getInputState(limitInput);
+    uint32_t now = millis();
+    if(metricsResetPending.exchange(false)) resetThroughput(throughput, now);
+    /** color sorting: eject a confirmed ball of the wrong color before it reaches the shooter */
+    int reading = color.get_value_calibrated_HR();
+    BallColor sample = classifyBall(colorFilter.filter(reading));
+    seenSamples = sample == seenColor ? seenSamples + 1 : 1;
+    seenColor = sample;
+    if(seenSamples == COLOR_CONFIRM_SAMPLES) ballColor = seenColor;
+    BallColor keep = sortColor;
+    if(seenSamples >= COLOR_CONFIRM_SAMPLES && keep != BALL_NONE && seenColor != BALL_NONE && seenColor != keep) {
+      ejectUntil = millis() + SORT_EJECT_TIME;
+    }
+    colorReading = reading;
+    /** ball tracking: in when a ball reaches the color sensor, out when one leaves the shooter */
+    bool atColor = seenSamples >= COLOR_CONFIRM_SAMPLES && seenColor != BALL_NONE;
+    if(atColor && !wasAtColor && balls < BALL_CAPACITY) {
+      balls++;
+      countIntake(throughput, now);
+    }
+    if(state == SHOOTER_INDEXING || state == SHOOTER_FIRING || state == SHOOTER_DISCARDING) {
+      if(ballsLeft > 0) countBallsOut(throughput, ballsLeft, state == SHOOTER_DISCARDING, now);
+      balls = std::max(balls - ballsLeft, 0);
+    }
+    wasAtColor = atColor;
+    MotorSnapshot snapshot = getMotorSnapshot();
+    uint32_t slots = (snapshot.current[HEALTH_LEFT_ROLLER] > BALL_INTAKE_CURRENT ? BALL_SLOT_INTAKE : 0)
+      | (atColor ? BALL_SLOT_INDEXER : 0) | (staged ? BALL_SLOT_STAGED : 0);
+    /** never fewer balls past the rollers than the sensors see (corrects missed edges) */
+    int seen = __builtin_popcount(slots & ~BALL_SLOT_INTAKE);
+    if(balls < seen) balls = seen;
+    ballSlots = slots;
+    ballCount = std::min(balls + ((slots & BALL_SLOT_INTAKE) ? 1 : 0), BALL_CAPACITY);
+    /** rollers: run as requested, with a reverse pulse when either side jams (| so both sides are checked) */
+    uint64_t nowMicros = micros();
+    int intake = intakePower;
+    bool synced = intakeSynced;
+    double intakeRpm = 0;
+    if(synced) {
+      intakeRpm = intakeSyncSpeed(getPose().linVel);
+      /** the equivalent power, for the stall detector and the current budget */
+      intake = lround(intakeRpm * 127 / INTAKE_MAX_RPM);
+    }
+    bool rollerReverse = (int32_t)(rollerReverseUntil - millis()) > 0;
+    if(!rollerReverse && (checkJam(snapshot, HEALTH_LEFT_ROLLER, lRollerStall, intake, nowMicros)
+      | checkJam(snapshot, HEALTH_RIGHT_ROLLER, rRollerStall, intake, nowMicros))) {
+      rollerReverseUntil = millis() + ROLLER_JAM_REVERSE;
+      rollerReverse = true;
+      throughput.metrics.jams++;
+    }
+    if(synced) {
+      setMotorVelocity(lRoller, lround(rollerReverse ? -intakeRpm : intakeRpm));
+      setMotorVelocity(rRoller, lround(rollerReverse ? -intakeRpm : intakeRpm));
+    }
+    else {
+      setMotorPower(lRoller, rollerReverse ? -intake : intake);
+      setMotorPower(rRoller, rollerReverse ? -intake : intake);
+    }
+    bool indexerJam = checkJam(snapshot, HEALTH_INDEXER, indexerStall, indexerPower, nowMicros);
+    /** transitions */
+    ShooterState next = state;
+    uint32_t elapsed = stateTimer.elapsed();
+    if(discard || (int32_t)(ejectUntil - millis()) > 0) next = SHOOTER_DISCARDING;
+    else if(abort || state == SHOOTER_DISCARDING) next = SHOOTER_IDLE;
+    else switch(state) {
+      case SHOOTER_IDLE:
+        if(pending > 0) {
+          retries = 0;
+          next = SHOOTER_INDEXING;
+        }
+        break;
+      case SHOOTER_INDEXING:
+        if(ballsLeft > 0 && !staged) {
+          /** the ball went through between two ticks: the cycle is done */
+          pending--;
+          cyclesDone++;
+          retries = 0;
+          next = SHOOTER_IDLE;
+        }
+        else if(staged) {
+          /** ball staged: fire once the shooter is at speed (in a burst: recovered enough, and spaced from the last ball) */
+          bool ready = shooterVelocity.isAtSpeed();
+          if(burstPending > 0) ready = shooterVelocity.getVelocity() >= shooterVelocity.getTarget() - SHOOTER_BURST_DROP
+            && millis() - lastShot >= SHOOTER_BURST_SPACING;
+          if(ready || elapsed > SHOOTER_SPINUP_TIMEOUT) next = SHOOTER_FIRING;
+        }
+        else if(indexerJam) {
+          if(retries++ < SHOOTER_JAM_RETRIES) next = SHOOTER_JAM_RECOVERY;
+          else {
+            pending--;
+            cyclesDone++;
+            next = SHOOTER_IDLE;
+          }
+        }
+        else if(elapsed > SHOOTER_INDEX_TIMEOUT) {
+          /** no ball came up: give the cycle up */
+          pending--;
+          cyclesDone++;
+          next = SHOOTER_IDLE;
+        }
+        break;
+      case SHOOTER_FIRING:
+        if(!staged || ballsLeft > 0) {
+          /** the ball is out (the next one can be staged by the same tick): start the next queued cycle right away */
+          lastShot = millis();
+          if(burstPending > 0) {
+            /** the rate of the burst, from its first ball out */
+            if(burstShots++ == 0) burstStart = lastShot;
+            else burstRate = lastShot > burstStart ? (burstShots - 1) * 1000.0 / (lastShot - burstStart) : 0;
+            burstPending--;
+          }
+          pending--;
+          cyclesDone++;
+          retries = 0;
+          next = pending > 0 ? SHOOTER_INDEXING : SHOOTER_IDLE;
+        }
+        else if(indexerJam || elapsed > SHOOTER_FIRE_TIMEOUT) {
+          if(retries++ < SHOOTER_JAM_RETRIES) next = SHOOTER_JAM_RECOVERY;
+          else {
+            pending--;
+            cyclesDone++;
+            next = SHOOTER_IDLE;
+          }
+        }
+        break;
+      case SHOOTER_JAM_RECOVERY:
+        if(elapsed > SHOOTER_JAM_REVERSE) next = SHOOTER_INDEXING;
+        break;
+      case SHOOTER_DISCARDING: break;
+    }
+    /** a burst ends with its cycles given up or dropped too */
+    burstPending = std::min(burstPending, pending);
+    if(next != state) {
+      stateTimer.reset();
+      if(next == SHOOTER_JAM_RECOVERY) throughput.metrics.jams++;
+      recordTimeline(TIMELINE_MECHANISM, SHOOTER_TIMELINE, next);
+    }
+    state = next;
+    stepThroughput(throughput, state, staged, rollerReverse, now - lastTick, now);
+    lastTick = now;
+    shooterMetrics.write(throughput.metrics);
+    /**
+     * shooter velocity: closed loop while cycling (or spinning, or aimed at a goal), open loop otherwise,
+     * at the speed for the distance to the goal if one is set
+     */
+    ShooterGoal goal = shooterGoal.read();
+    double target = SHOOTER_RPM;
+    if(goal.active) {
+      PoseSnapshot pose = getPose();
+      target = shooterSpeedAt(hypot(goal.x - pose.x, goal.y - pose.y));
+    }
+    shooterTarget = target;
+    bool closedLoop = state == SHOOTER_INDEXING || state == SHOOTER_FIRING || (state == SHOOTER_IDLE && (spin || goal.active));
+    shooterVelocity.setTarget(closedLoop ? target : 0);
+    double shooterPower = shooterVelocity.step(shooter.get_position(), micros());
+    shooterReady = shooterVelocity.isAtSpeed();
+    shooterRpm = shooterVelocity.getVelocity();
+    /** outputs, at the indexer power of the parameter table (refer to paramTable.hpp) */
+    double cycleSpeed = getParam(PARAM_CYCLE_SPEED);
+    switch(state) {
+      case SHOOTER_IDLE:
+        indexerPower = 0;
+        break;
+      case SHOOTER_INDEXING:
+        indexerPower = staged ? 0 : cycleSpeed;
+        break;
+      case SHOOTER_FIRING:
+        indexerPower = cycleSpeed;
+        break;
+      case SHOOTER_DISCARDING:
+        indexerPower = cycleSpeed / 2;
+        shooterPower = -cycleSpeed;
+        break;
+      case SHOOTER_JAM_RECOVERY:
+        indexerPower = -cycleSpeed / 2;
+        shooterPower = -cycleSpeed / 2;
+        break;
+    }
+    if(INDEXER_POSITION_CONTROL && state != SHOOTER_DISCARDING && state != SHOOTER_JAM_RECOVERY) {
+      /**
+       * one slot per advance: a ball is brought up while none is staged, and the staged one is pushed
+       * into the shooter (which brings the next one up) while firing
+       */
+      bool advance = (state == SHOOTER_INDEXING && !staged) || state == SHOOTER_FIRING;
+      if(advance && !indexerMove.moving) startIndexerMove(indexerMove, nowMicros);
+      double indexerRpm = stepIndexerMove(indexerMove, indexer.get_position(), nowMicros);
+      /** the equivalent power, for the stall detector and the current budget */
+      indexerPower = lround(indexerRpm * 127 / 600);
+      setMotorVelocity(indexer, lround(indexerRpm));
+    }
+    else {
+      /** run open loop, and hold wherever the indexer ends up */
+      if(INDEXER_POSITION_CONTROL) syncIndexerMove(indexerMove, indexer.get_position());
+      setMotorPower(indexer, indexerPower);
+    }
+    setMotorPower(shooter, shooterPower);
+    /** current budget (refer to currentBudget.hpp): the shooter peaks while spinning up and firing */
+    setCurrentDemand(BUDGET_SHOOTER, state == SHOOTER_INDEXING || state == SHOOTER_FIRING ? CURRENT_PEAK
+      : shooterPower != 0 ? CURRENT_RUNNING : CURRENT_IDLE);
+    setCurrentDemand(BUDGET_INDEXER, indexerPower != 0 ? CURRENT_RUNNING : CURRENT_IDLE);
+    setCurrentDemand(BUDGET_ROLLERS, intake != 0 ? CURRENT_RUNNING : CURRENT_IDLE);
+    shooterState = state;
+    endTaskIteration(TIMING_SHOOTER);
+    /** next tick, or earlier on a limit switch edge or a new command */
+    pros::c::task_notify_take(true, SHOOTER_DT);
   }
 }
@@ -0,0 +1,129 @@
+/**
+ * Motion arena:
+ * - Persistent (bottom) and scratch (top) bump allocation in a static region
+ * - Marks to roll either end back, and a bulk reset between routines
+ * - Usage statistics (reported by the resource monitor)
+ */
+#include "main.h"
+/** the region, and both ends packed in one word (low: bottom offset, high: top offset) */
+alignas(ARENA_ALIGN) uint8_t arenaMemory[ARENA_SIZE];
+std::atomic<uint64_t> arenaEnds((uint64_t)ARENA_SIZE << 32);
+std::atomic<uint32_t> arenaPeak(0), arenaFailures(0);
+/**
+ * Pack both ends of the arena into one word.
+ * @param bottom
+ * bottom offset (end of the persistent allocations)
+ *
+ * @param top
+ * top offset (start of the scratch allocations)
+ *
+ * @return
+ * the packed ends
+ */
+uint64_t packArenaEnds(uint32_t bottom, uint32_t top){
+  return (uint64_t)top << 32 | bottom;
+}
+/**
+ * Take bytes from one end of the arena.
+ * @param size
+ * bytes to take
+ *
+ * @param scratch
+ * true to take them from the top, false from the bottom
+ *
+ * @return
+ * the allocation, or NULL if it does not fit
+ */
+void *takeArena(uint32_t size, bool scratch){
+  size = (size + ARENA_ALIGN - 1) & ~(uint32_t)(ARENA_ALIGN - 1);
+  uint64_t ends = arenaEnds.load(std::memory_order_relaxed), next;
+  uint32_t bottom, top, offset;
+  do{
+    bottom = (uint32_t)ends;
+    top = (uint32_t)(ends >> 32);
+    if(size > top - bottom){
+      arenaFailures++;
+      return NULL;
+    }
+    offset = scratch ? top - size : bottom;
+    next = scratch ? packArenaEnds(bottom, offset) : packArenaEnds(bottom + size, top);
+  }while(!arenaEnds.compare_exchange_weak(ends, next, std::memory_order_relaxed));
+  uint32_t taken = ARENA_SIZE - (top - bottom) + size;
+  uint32_t peak = arenaPeak.load(std::memory_order_relaxed);
+  while(taken > peak && !arenaPeak.compare_exchange_weak(peak, taken, std::memory_order_relaxed));
+  return arenaMemory + offset;
+}
+/**
+ * Allocate persistent memory (kept until releaseArena or resetArena).
+ * @param size
+ * bytes
+ *
+ * @return
+ * the allocation (ARENA_ALIGN aligned), or NULL if the arena is full
+ */
+void *arenaAlloc(uint32_t size){
+  return takeArena(size, false);
+}
+/**
+ * Allocate scratch memory for the duration of a computation (release it with releaseScratch).
+ * @param size
+ * bytes
+ *
+ * @return
+ * the allocation (ARENA_ALIGN aligned), or NULL if the arena is full
+ */
+void *arenaScratch(uint32_t size){
+  return takeArena(size, true);
+}
+/**
+ * @return
+ * mark of the persistent end, to roll back a failed series of allocations with releaseArena
+ */
+uint32_t getArenaMark(){
+  return (uint32_t)arenaEnds.load(std::memory_order_relaxed);
+}
+/**
+ * Free every persistent allocation made after a mark.
+ * @param mark
+ * from getArenaMark
+ */
+void releaseArena(uint32_t mark){
+  uint64_t ends = arenaEnds.load(std::memory_order_relaxed);
+  while(!arenaEnds.compare_exchange_weak(ends, packArenaEnds(mark, (uint32_t)(ends >> 32)), std::memory_order_relaxed));
+}
+/**
+ * @return
+ * mark of the scratch end, to free the scratch allocations of a computation with releaseScratch
+ */
+uint32_t getScratchMark(){
+  return (uint32_t)(arenaEnds.load(std::memory_order_relaxed) >> 32);
+}
+/**
+ * Free every scratch allocation made after a mark.
+ * @param mark
+ * from getScratchMark
+ */
+void releaseScratch(uint32_t mark){
+  uint64_t ends = arenaEnds.load(std::memory_order_relaxed);
+  while(!arenaEnds.compare_exchange_weak(ends, packArenaEnds((uint32_t)ends, mark), std::memory_order_relaxed));
+}
+/**
+ * Free the whole arena (between routines). The owners of the allocations must drop them first
+ * (e.g. clearTrajectories).
+ */
+void resetArena(){
+  arenaEnds = packArenaEnds(0, ARENA_SIZE);
+}
+/**
+ * @return
+ * arena usage
+ */
+ArenaUsage getArenaUsage(){
+  uint64_t ends = arenaEnds.load(std::memory_order_relaxed);
+  ArenaUsage usage;
+  usage.used = (uint32_t)ends;
+  usage.scratch = ARENA_SIZE - (uint32_t)(ends >> 32);
+  usage.peak = arenaPeak;
+  usage.failures = arenaFailures;
+  return usage;
+}
@@ -0,0 +1,153 @@
+/**
+ * MotionProfile functions:
+ * - Profile generation (trapezoidal & S-curve)
+ * - Setpoint sampling
+ */
+#include "main.h"
+/**
+ * Default initialization of a MotionProfile: an empty (zero distance) movement.
+ */
+MotionProfile::MotionProfile(){
+  generate(0, 1, 1, 1, PROFILE_TRAPEZOIDAL);
+}
+/**
+ * Distance covered while accelerating from rest to peak velocity v.
+ * @param v
+ * peak velocity
+ *
+ * @param maxAcc
+ * maximum acceleration
+ *
+ * @param maxJerk
+ * maximum jerk
+ *
+ * @param shape
+ * shape of the profile
+ *
+ * @param jerkTime
+ * pointer to the time spent ramping the acceleration (0 for trapezoidal); updated
+ *
+ * @param peakAcc
+ * pointer to the acceleration actually reached; updated
+ *
+ * @return
+ * distance required to reach v
+ */
+double rampDistance(double v, double maxAcc, double maxJerk, ProfileShape shape, double *jerkTime, double *peakAcc){
+  double a = maxAcc;
+  double tj = 0;
+  if(v <= 0){
+    *jerkTime = 0;
+    *peakAcc = 0;
+    return 0;
+  }
+  if(shape == PROFILE_SCURVE){
+    /** if v is too low to reach maxAcc the acceleration is a triangle instead */
+    if(v < maxAcc*maxAcc/maxJerk) a = sqrt(v*maxJerk);
+    tj = a/maxJerk;
+  }
+  *jerkTime = tj;
+  *peakAcc = a;
+  /** the ramp is symmetric, so the average velocity is v/2 over v/a + tj */
+  return v*(v/a + tj)/2;
+}
+/**
+ * Generate a rest-to-rest profile.
+ * @param distance
+ * signed distance of the movement (inches)
+ *
+ * @param maxVel
+ * maximum velocity (inches per second)
+ *
+ * @param maxAcc
+ * maximum acceleration (inches per second squared)
+ *
+ * @param maxJerk
+ * maximum jerk (inches per second cubed), only used by PROFILE_SCURVE
+ *
+ * @param shape
+ * PROFILE_TRAPEZOIDAL or PROFILE_SCURVE (PROFILE_NONE gives a zero-duration profile)
+ */
+void MotionProfile::generate(double distance, double maxVel, double maxAcc, double maxJerk, ProfileShape shape){
+  sign = distance < 0? -1 : 1;
+  double d = fabs(distance);
+  double v = maxVel, tj, a;
+  /** if the movement is too short to reach maxVel, search for the highest reachable peak velocity */
+  if(2*rampDistance(v, maxAcc, maxJerk, shape, &tj, &a) > d){
+    double low = 0, high = maxVel;
+    for(int i = 0; i < 40; i++){
+      double mid = (low + high)/2;
+      if(2*rampDistance(mid, maxAcc, maxJerk, shape, &tj, &a) > d) high = mid;
+      else low = mid;
+    }
+    v = low;
+  }
+  double rampDis = rampDistance(v, maxAcc, maxJerk, shape, &tj, &a);
+  /** duration of each segment */
+  double constAccTime = (a > 0)? fmax(v/a - tj, 0) : 0;
+  double cruiseTime = (v > 0)? (d - 2*rampDis)/v : 0;
+  if(shape == PROFILE_NONE) tj = constAccTime = cruiseTime = 0;
+  double durations[7] = {tj, constAccTime, tj, cruiseTime, tj, constAccTime, tj};
+  double jerk = (tj > 0)? a/tj : 0;
+  double jerks[7] = {jerk, 0, -jerk, 0, -jerk, 0, jerk};
+  /** acceleration at the start of each segment (prescribed, so tj = 0 gives a trapezoid) */
+  double startAcc[7] = {0, a, a, 0, 0, -a, -a};
+  segTime[0] = segPos[0] = segVel[0] = 0;
+  for(int i = 0; i < 7; i++){
+    double t = durations[i];
+    segJerk[i] = jerks[i];
+    segAcc[i] = startAcc[i];
+    segTime[i+1] = segTime[i] + t;
+    segVel[i+1] = segVel[i] + segAcc[i]*t + segJerk[i]*t*t/2;
+    segPos[i+1] = segPos[i] + segVel[i]*t + segAcc[i]*t*t/2 + segJerk[i]*t*t*t/6;
+  }
+  segAcc[7] = 0;
+  /** remove integration round-off so that the profile ends exactly on the target */
+  segVel[7] = 0;
+  segPos[7] = d;
+}
+/**
+ * Sample the profile.
+ * @param t
+ * time since the start of the movement (seconds)
+ *
+ * @return
+ * setpoint (position, velocity, acceleration) at time t
+ */
+ProfileSetpoint MotionProfile::sample(double t) const{
+  ProfileSetpoint setpoint;
+  if(t >= segTime[7]){
+    setpoint.pos = sign*segPos[7];
+    setpoint.vel = setpoint.acc = 0;
+    return setpoint;
+  }
+  if(t < 0) t = 0;
+  int i = 0;
+  while(i < 6 && t >= segTime[i+1]) i++;
+  double dt = t - segTime[i];
+  setpoint.pos = sign*(segPos[i] + segVel[i]*dt + segAcc[i]*dt*dt/2 + segJerk[i]*dt*dt*dt/6);
+  setpoint.vel = sign*(segVel[i] + segAcc[i]*dt + segJerk[i]*dt*dt/2);
+  setpoint.acc = sign*(segAcc[i] + segJerk[i]*dt);
+  return setpoint;
+}
+/**
+ * @return
+ * duration of the profile (seconds)
+ */
+double MotionProfile::getDuration() const{
+  return segTime[7];
+}
+/**
+ * @return
+ * signed distance of the profile (inches)
+ */
+double MotionProfile::getDistance() const{
+  return sign*segPos[7];
+}
+/**
+ * @return
+ * time at which the profile starts decelerating towards the target (seconds)
+ */
+double MotionProfile::getDecelStart() const{
+  return segTime[4];
+}
@@ -0,0 +1,465 @@
+/**
+ * Motion command queue:
+ * - Queueing functions (called from autonomous code, never block)
+ * - Dispatching of queued motions (called by the baseControl task every cycle)
+ * - Queue status & waiting functions
+ */
+#include "main.h"
+/** queued motions, from the autonomous task to the baseControl task (which polls it every cycle) */
+Mailbox<MotionCommand, MOTION_QUEUE_SIZE> motionQueue;
+/** requests the consumer to drop all motions (the producer cannot take them) */
+std::atomic<bool> motionClearPending(false);
+/** whether newly queued motions are chained onto the motion before them */
+bool motionChaining = false;
+/** early exit of newly queued motions (inches and ms left, 0: off) */
+double motionExitDistance = 0;
+uint32_t motionExitTime = 0;
+/** motor output mode of newly queued motions */
+BaseOutputMode motionOutputMode = BASE_OUTPUT_MODE;
+/** deadline and estimate of the next queued motion only (0: none) */
+uint32_t nextMotionDeadline = 0, nextMotionEstimate = 0;
+/**
+ * Motion being executed by the baseControl task and when it was started (millis).
+ * motionActive is only cleared by the baseControl task.
+ */
+MotionCommand activeMotion;
+uint32_t activeMotionStart = 0;
+std::atomic<bool> motionActive(false);
+/**
+ * Add a motion to the end of the queue. Returns immediately.
+ * @param command
+ * motion to queue
+ *
+ * @return
+ * false if the queue is full (the motion is dropped, the deadline and estimate stay set for the next try)
+ */
+bool queueMotion(const MotionCommand &command){
+  if(!motionQueue.post(command)) return false;
+  nextMotionDeadline = nextMotionEstimate = 0;
+  return true;
+}
+/**
+ * Turn chaining on or off for the motions queued afterwards. A chained motion starts
+ * while the one before it is decelerating and blends into it, so the base does not stop
+ * between them; it is planned from the pose the previous motion is heading to.
+ * Pursuit paths and trajectories are never chained.
+ * @param chain
+ * true: chain the following motions
+ */
+void setMotionChaining(bool chain){
+  motionChaining = chain;
+}
+/**
+ * Set the early exit of the motions queued afterwards: a motion with a motion queued after it ends
+ * (and the next one starts) as soon as it is within the distance or the time of its end, instead of
+ * waiting to settle. For intermediate waypoints; the last motion of the queue always settles.
+ * Unlike chaining, the next motion starts from where the base is, with no blending.
+ * @param distance
+ * inches left (refer to getBaseRemaining), 0: off
+ *
+ * @param time
+ * ms left on the profile or trajectory (pure pursuit and move to pose only exit on the distance), 0: off
+ */
+void setMotionEarlyExit(double distance, uint32_t time){
+  motionExitDistance = distance;
+  motionExitTime = time;
+}
+/**
+ * Select the motor output mode of the motions queued afterwards
+ * (refer to BaseOutputMode in baseControl.hpp).
+ * @param mode
+ * BASE_OUTPUT_POWER, BASE_OUTPUT_VOLTAGE or BASE_OUTPUT_VELOCITY
+ */
+void setMotionOutputMode(BaseOutputMode mode){
+  motionOutputMode = mode;
+}
+/**
+ * Give the next queued motion a deadline on the match clock (refer to matchClock.hpp): a profiled
+ * motion (not a pure-pursuit path, a trajectory or a move to pose) is slowed down to arrive at the
+ * deadline instead of early, sparing the mechanisms and the accuracy when there is time to spare.
+ * The time left is taken when the motion starts; a motion that is already late runs at full speed.
+ * Its settle timeout is extended by the time it is given.
+ * @param matchTime
+ * match time in ms to arrive by
+ */
+void setNextMotionDeadline(uint32_t matchTime){
+  nextMotionDeadline = matchTime;
+}
+/**
+ * Make the next queued motion optional: it is skipped, without starting, when the match clock has
+ * less than its estimate (and MATCH_TIME_MARGIN) left as it comes up, so the scoring motions queued
+ * after it still have time. The queue runs ahead of the autonomous code, hence the decision at dispatch.
+ * @param estimate
+ * expected duration of the motion in ms
+ */
+void setNextMotionOptional(uint32_t estimate){
+  nextMotionEstimate = estimate;
+}
+/**
+ * Build a motion command with no path and no trajectory.
+ * @return
+ * the motion command
+ */
+MotionCommand makeMotion(MotionType type, double x, double y, double angle, bool reverse, double kp, double kd, SettleRule settle){
+  MotionCommand command = {};
+  command.type = type;
+  command.x = x;
+  command.y = y;
+  command.angle = angle;
+  command.reverse = reverse;
+  command.kp = kp;
+  command.kd = kd;
+  command.settle = settle;
+  command.chain = motionChaining;
+  command.exitDistance = motionExitDistance;
+  command.exitTime = motionExitTime;
+  command.output = motionOutputMode;
+  command.deadline = nextMotionDeadline;
+  command.estimate = nextMotionEstimate;
+  return command;
+}
+/**
+ * Queue a straight movement (analogous to baseMove(dis, kp, kd)).
+ * @param dis
+ * distance in inches
+ *
+ * @param kp, kd (optional)
+ * proportional & derivative constants (default: GAIN_SCHEDULED, refer to gainSchedule.hpp)
+ *
+ * @param settle (optional)
+ * settle rule of the motion
+ *
+ * @return
+ * false if the queue is full
+ */
+bool queueMove(double dis, double kp, double kd, SettleRule settle){
+  return queueMotion(makeMotion(MOTION_MOVE, dis, 0, 0, false, kp, kd, settle));
+}
+/**
+ * Queue a movement to a point (analogous to baseMove(x, y, kp, kd)).
+ * The distance is computed from the pose when the motion starts, not when it is queued.
+ * @param x, y
+ * coordinates of the target point
+ *
+ * @return
+ * false if the queue is full
+ */
+bool queueMoveTo(double x, double y, double kp, double kd, SettleRule settle){
+  return queueMotion(makeMotion(MOTION_MOVE_TO, x, y, 0, false, kp, kd, settle));
+}
+/**
+ * Queue a turn to a bearing (analogous to baseTurn(angleDeg, kp, kd)).
+ * @param angleDeg
+ * bearing in degrees
+ *
+ * @return
+ * false if the queue is full
+ */
+bool queueTurn(double angleDeg, double kp, double kd, SettleRule settle){
+  return queueMotion(makeMotion(MOTION_TURN, 0, 0, angleDeg, false, kp, kd, settle));
+}
+/**
+ * Queue a turn to face a point (analogous to baseTurn(x, y, kp, kd, reverse)).
+ * @param x, y
+ * coordinates of the point to face
+ *
+ * @param reverse (optional. default = false)
+ * true: face the point with the back of the robot
+ *
+ * @return
+ * false if the queue is full
+ */
+bool queueTurnTo(double x, double y, bool reverse, double kp, double kd, SettleRule settle){
+  return queueMotion(makeMotion(MOTION_TURN_TO, x, y, 0, reverse, kp, kd, settle));
+}
+/**
+ * Queue a relative turn (analogous to baseTurnRelative(angle, kp, kd)).
+ * @param angleDeg
+ * angle to turn, in degrees (positive: clockwise)
+ *
+ * @return
+ * false if the queue is full
+ */
+bool queueTurnRelative(double angleDeg, double kp, double kd, SettleRule settle){
+  return queueMotion(makeMotion(MOTION_TURN_RELATIVE, 0, 0, angleDeg, false, kp, kd, settle));
+}
+/**
+ * Queue an arc (analogous to baseArc(radius, angleDeg, kp, kd)).
+ * @param radius
+ * radius of the arc in inches (negative: backwards)
+ *
+ * @param angleDeg
+ * change of the bearing in degrees (positive: clockwise)
+ *
+ * @return
+ * false if the queue is full
+ */
+bool queueArc(double radius, double angleDeg, double kp, double kd, SettleRule settle){
+  return queueMotion(makeMotion(MOTION_ARC, radius, 0, angleDeg, false, kp, kd, settle));
+}
+/**
+ * Queue an arc to a point (analogous to baseArcTo(x, y, kp, kd)).
+ * The arc is computed from the pose when the motion starts, not when it is queued.
+ * @param x, y
+ * coordinates of the target point
+ *
+ * @return
+ * false if the queue is full
+ */
+bool queueArcTo(double x, double y, double kp, double kd, SettleRule settle){
+  return queueMotion(makeMotion(MOTION_ARC_TO, x, y, 0, false, kp, kd, settle));
+}
+/**
+ * Queue a swing turn (analogous to baseSwing(angleDeg, pivot, kp, kd)).
+ * @param angleDeg
+ * change of the bearing in degrees (positive: clockwise)
+ *
+ * @param pivot
+ * side held in place (BASE_SIDE_LEFT or BASE_SIDE_RIGHT)
+ *
+ * @return
+ * false if the queue is full
+ */
+bool queueSwing(double angleDeg, BaseSide pivot, double kp, double kd, SettleRule settle){
+  MotionCommand command = makeMotion(MOTION_SWING, 0, 0, angleDeg, false, kp, kd, settle);
+  command.pivot = pivot;
+  return queueMotion(command);
+}
+/**
+ * Queue a move to pose (analogous to baseMoveToPose(x, y, angleDeg, reverse)).
+ * @param x, y
+ * goal point in field coordinates
+ *
+ * @param angleDeg
+ * bearing on arrival in degrees
+ *
+ * @return
+ * false if the queue is full
+ */
+bool queueMoveToPose(double x, double y, double angleDeg, bool reverse, SettleRule settle){
+  return queueMotion(makeMotion(MOTION_MOVE_TO_POSE, x, y, angleDeg, reverse, 0, 0, settle));
+}
+/**
+ * Queue a pure-pursuit path (analogous to basePursuit(points, count, reverse)).
+ * The path is copied when the motion starts, so points must stay valid until then.
+ * @param points
+ * waypoints in field coordinates
+ *
+ * @param count
+ * number of waypoints
+ *
+ * @return
+ * false if the queue is full
+ */
+bool queuePursuit(const PursuitPoint *points, int count, bool reverse, SettleRule settle){
+  MotionCommand command = makeMotion(MOTION_PURSUIT, 0, 0, 0, reverse, 0, 0, settle);
+  command.points = points;
+  command.count = count;
+  return queueMotion(command);
+}
+/**
+ * Queue a pure-pursuit path with path triggers (analogous to basePursuit(points, count, triggers, triggerCount, reverse)).
+ * The path and the triggers are copied when the motion starts, so they must stay valid until then.
+ * @param triggers, triggerCount
+ * triggers of the path (refer to PathTrigger)
+ *
+ * @return
+ * false if the queue is full
+ */
+bool queuePursuit(const PursuitPoint *points, int count, const PathTrigger *triggers, int triggerCount, bool reverse, SettleRule settle){
+  MotionCommand command = makeMotion(MOTION_PURSUIT, 0, 0, 0, reverse, 0, 0, settle);
+  command.points = points;
+  command.count = count;
+  command.triggers = triggers;
+  command.triggerCount = triggerCount;
+  return queueMotion(command);
+}
+/**
+ * Queue the replay of a cached trajectory (analogous to followTrajectory(name, kp, kd)).
+ * @param name
+ * identifier of the trajectory (must stay valid until the motion starts)
+ *
+ * @return
+ * false if the queue is full
+ */
+bool queueTrajectory(const char *name, double kp, double kd, SettleRule settle){
+  MotionCommand command = makeMotion(MOTION_TRAJECTORY, 0, 0, 0, false, kp, kd, settle);
+  command.name = name;
+  return queueMotion(command);
+}
+/**
+ * Drop all queued motions. The motion in progress is given up at the next control cycle;
+ * the base then holds where its setpoint is.
+ */
+void clearMotionQueue(){
+  motionClearPending = true;
+}
+/**
+ * @return
+ * true if no motion is queued or in progress
+ */
+bool isMotionQueueIdle(){
+  return !motionActive && !motionClearPending && motionQueue.empty();
+}
+/**
+ * Position of the queue in motion numbers (motions are numbered in queueing order from 0 at boot).
+ * @param queued
+ * set to the number of motions queued so far (the number of the next queued motion)
+ *
+ * @param started
+ * set to the number of motions started or dropped by a clear
+ *
+ * @return
+ * whether motion started - 1 is running
+ */
+bool getMotionSequence(uint32_t &queued, uint32_t &started){
+  bool active = motionActive;
+  started = motionQueue.taken();
+  queued = motionQueue.posted();
+  return active;
+}
+/**
+ * Wait until all queued motions have finished.
+ * @param cutoff
+ * maximum waiting time in milliseconds
+ *
+ * @return
+ * false if the cutoff ran out first
+ */
+bool waitMotionQueue(uint32_t cutoff){
+  Timer timer;
+  recordTimeline(TIMELINE_WAIT_BEGIN, TIMELINE_WAIT_QUEUE);
+  while(!isMotionQueueIdle()){
+    if(timer.passed(cutoff)){
+      recordTimeline(TIMELINE_WAIT_END, TIMELINE_WAIT_QUEUE, 1);
+      return false;
+    }
+    delay(BASE_CONTROL_DT);
+  }
+  recordTimeline(TIMELINE_WAIT_END, TIMELINE_WAIT_QUEUE);
+  return true;
+}
+/**
+ * @param type
+ * motion primitive
+ *
+ * @return
+ * true if the primitive follows a motion profile (and so can be chained)
+ */
+bool isProfileMotion(MotionType type){
+  return type != MOTION_PURSUIT && type != MOTION_TRAJECTORY && type != MOTION_MOVE_TO_POSE;
+}
+/**
+ * @param command
+ * the next queued motion
+ *
+ * @return
+ * true if it is a turn to face the point the motion after it moves to: a holonomic base translates to the
+ * point from any bearing (refer to baseTranslate), so the turn is skipped
+ */
+bool isTurnBeforeTranslation(const MotionCommand &command){
+  if(!HOLONOMIC_BASE || command.type != MOTION_TURN_TO) return false;
+  const MotionCommand *move = motionQueue.peek(1);
+  return move != NULL && move->type == MOTION_MOVE_TO && move->x == command.x && move->y == command.y;
+}
+/**
+ * Whether the motion in progress has reached its early exit (refer to setMotionEarlyExit).
+ * @param frame
+ * control frame of the current cycle
+ */
+bool isMotionExiting(const BaseControlFrame &frame){
+  if(activeMotion.exitDistance <= 0 && activeMotion.exitTime == 0) return false;
+  double distance, time;
+  getBaseRemaining(frame, distance, time);
+  return distance <= activeMotion.exitDistance || time <= activeMotion.exitTime;
+}
+/**
+ * Start a motion by calling the matching movement function with its settle rule.
+ * Only called from the baseControl task.
+ * @param command
+ * motion to start
+ */
+void startMotion(const MotionCommand &command){
+  setBaseSettleRule(command.settle);
+  setBaseOutputMode(command.output);
+  switch(command.type){
+    case MOTION_MOVE: baseMove(command.x, command.kp, command.kd); break;
+    case MOTION_MOVE_TO: baseMove(command.x, command.y, command.kp, command.kd); break;
+    case MOTION_TURN: baseTurn(command.angle, command.kp, command.kd); break;
+    case MOTION_TURN_TO: baseTurn(command.x, command.y, command.kp, command.kd, command.reverse); break;
+    case MOTION_TURN_RELATIVE: baseTurnRelative(command.angle, command.kp, command.kd); break;
+    case MOTION_PURSUIT: basePursuit(command.points, command.count, command.triggers, command.triggerCount, command.reverse); break;
+    case MOTION_TRAJECTORY: followTrajectory(command.name, command.kp, command.kd); break;
+    case MOTION_ARC: baseArc(command.x, command.angle, command.kp, command.kd); break;
+    case MOTION_ARC_TO: baseArcTo(command.x, command.y, command.kp, command.kd); break;
+    case MOTION_SWING: baseSwing(command.angle, command.pivot, command.kp, command.kd); break;
+    case MOTION_MOVE_TO_POSE: baseMoveToPose(command.x, command.y, command.angle, command.reverse); break;
+  }
+}
+/**
+ * Stage 7 of the baseControl pipeline: finish the motion in progress when it has settled
+ * or timed out, then start the next queued motion. Motions therefore run back to back
+ * without the autonomous task waiting on them. A motion aborted by an impact clears the queue.
+ * @param frame
+ * control frame of the current cycle
+ */
+void updateMotionQueue(const BaseControlFrame &frame){
+  if(motionClearPending){
+    motionQueue.clear();
+    if(motionActive) recordTimeline(TIMELINE_MOTION_END, activeMotion.type, TIMELINE_CLEARED);
+    if(motionActive && activeMotion.type == MOTION_PURSUIT) stopPursuit();
+    motionActive = false;
+    motionClearPending = false;
+    return;
+  }
+  const MotionCommand *next = motionQueue.peek();
+  bool chain = false, exited = false;
+  if(motionActive && !isBaseSettled() && !isBaseAborted() && millis() - activeMotionStart < activeMotion.settle.timeout){
+    if(next == NULL) return;
+    /** a chained motion starts as soon as the current profile is decelerating */
+    chain = next->chain && isProfileMotion(next->type) && isProfileMotion(activeMotion.type) && canChainBase(frame.readTime);
+    /** otherwise, a motion with an early exit ends once it is close enough to its end */
+    exited = !chain && isMotionExiting(frame);
+    if(!chain && !exited) return;
+  }
+  if(motionActive){
+    bool aborted = !chain && !exited && isBaseAborted();
+    recordTimeline(TIMELINE_MOTION_END, activeMotion.type, chain ? TIMELINE_CHAINED : exited ? TIMELINE_EXITED
+      : aborted ? TIMELINE_ABORTED : isBaseSettled() ? TIMELINE_SETTLED : TIMELINE_TIMED_OUT);
+    /** an impact aborted it: the motions after it were planned from where it would have ended */
+    if(aborted){
+      motionQueue.clear();
+      motionActive = false;
+      return;
+    }
+  }
+  /**
+   * optional motions the match clock has no time left for, and the turns of a holonomic base before a translation,
+   * are taken without starting
+   */
+  while(next != NULL && ((next->estimate > 0 && !hasMatchTime(next->estimate)) || isTurnBeforeTranslation(*next))){
+    motionActive = true;
+    recordTimeline(TIMELINE_MOTION_END, next->type, TIMELINE_SKIPPED);
+    motionQueue.take(activeMotion);
+    next = motionQueue.peek();
+    chain = false;
+  }
+  if(next == NULL){
+    motionActive = false;
+    return;
+  }
+  activeMotionStart = millis();
+  /** mark the motion active before freeing its slot so the queue never looks idle in between */
+  motionActive = true;
+  recordTimeline(TIMELINE_MOTION_START, next->type, motionQueue.taken());
+  motionQueue.take(activeMotion);
+  if(chain) chainBaseMotion();
+  if(activeMotion.deadline > 0 && isProfileMotion(activeMotion.type)){
+    int32_t available = (int32_t)(activeMotion.deadline - getMatchTime());
+    if(available > 0){
+      stretchBaseMotion(available/1000.0);
+      activeMotion.settle.timeout += available;
+    }
+  }
+  startMotion(activeMotion);
+}
@@ -0,0 +1,113 @@
+/**
+ * Motor health monitor:
+ * - Temperature, current draw and over-temperature flag of the eight motors every MOTOR_HEALTH_DT (from the motor snapshot)
+ * - Derating model: power fraction allowed by the temperature and the load of each motor
+ * - Base power cap (slew limited, and within the battery's reach), applied by the power-cap stage
+ *   of the base controller together with capBasePow
+ * - Battery samples for the battery model, and the current budget kept within the battery's reach
+ */
+#include "main.h"
+/**
+ * Monitor state
+ * healthLocks: last sample of each motor (written by the monitor task only)
+ * baseDerateCap: base power cap of the model (MAX_POW until the first sample)
+ */
+SeqLock<MotorHealth> healthLocks[HEALTH_MOTORS];
+std::atomic<float> baseDerateCap(MAX_POW);
+/** smart ports of the monitored motors, for the telemetry (HealthMotor order) */
+const uint8_t healthPorts[HEALTH_MOTORS] = {FLPort, BLPort, FRPort, BRPort, lRollerPort, rRollerPort, indexerPort, shooterPort};
+/**
+ * Derating model: full power up to HEALTH_DERATE_START, then a linear drop to HEALTH_DERATE_MIN at
+ * HEALTH_DERATE_END. The load leads the reading by up to HEALTH_CURRENT_LEAD degrees, since a motor
+ * at its current limit keeps heating until its next 5 degree step.
+ * @param temperature
+ * reported temperature in degrees C
+ *
+ * @param current
+ * average current draw in mA
+ *
+ * @param overTemp
+ * the motor reports over temperature
+ *
+ * @return
+ * power fraction allowed (HEALTH_DERATE_MIN to 1)
+ */
+double thermalScale(double temperature, double current, bool overTemp){
+  if(overTemp) return HEALTH_DERATE_MIN;
+  double load = fmin(fabs(current)/HEALTH_CURRENT_LIMIT, 1);
+  double effective = temperature + HEALTH_CURRENT_LEAD*load*load;
+  double t = (effective - HEALTH_DERATE_START)/(HEALTH_DERATE_END - HEALTH_DERATE_START);
+  return 1 - (1 - HEALTH_DERATE_MIN)*fmin(fmax(t, 0), 1);
+}
+/**
+ * @param motor
+ * a monitored motor
+ *
+ * @return
+ * its last sample (all 0 before the first)
+ */
+MotorHealth getMotorHealth(HealthMotor motor){
+  return healthLocks[motor].read();
+}
+/**
+ * @return
+ * base power cap of the derating model (0 to 127; MAX_POW for a cool base on a full battery)
+ */
+double getBaseDerateCap(){
+  return baseDerateCap.load(std::memory_order_relaxed);
+}
+/**
+ * Sample the motors every MOTOR_HEALTH_DT and update the base power cap.
+ * The cap fraction follows the hottest base motor at HEALTH_CAP_SLEW per second (at once when a motor
+ * reports over temperature, since the firmware is already limiting it), so a path slows down
+ * gradually. A motor whose model changes by a step is reported through telemetry.
+ */
+void motorHealth(void * ignore){
+  LoopRate rate(MOTOR_HEALTH_DT);
+  double fraction = 1;
+  float reportedScale[HEALTH_MOTORS];
+  HealthCurrentFilter currentFilters[HEALTH_MOTORS] = {};
+  for(int i = 0; i < HEALTH_MOTORS; i++) reportedScale[i] = 1;
+  startTaskTiming(TIMING_HEALTH, MOTOR_HEALTH_DT, true);
+  while(true){
+    beginTaskIteration(TIMING_HEALTH);
+    double baseScale = 1;
+    bool baseOverTemp = false;
+    /** the readings come from the motor snapshot (refer to motorSnapshot.hpp) */
+    MotorSnapshot snapshot = getMotorSnapshot();
+    for(int i = 0; i < HEALTH_MOTORS; i++){
+      double temperature = snapshot.temperature[i], current = snapshot.current[i];
+      bool overTemp = snapshot.overTemp[i];
+      MotorHealth health = healthLocks[i].read();
+      health.current = currentFilters[i].filter(current);
+      health.temperature = temperature;
+      health.overTemp = overTemp;
+      health.scale = thermalScale(temperature, health.current, overTemp);
+      healthLocks[i].write(health);
+      if(i < HEALTH_LEFT_ROLLER){
+        baseScale = fmin(baseScale, health.scale);
+        baseOverTemp = baseOverTemp || overTemp;
+      }
+      if(fabs(health.scale - reportedScale[i]) >= 0.05 || (health.scale == 1) != (reportedScale[i] == 1)){
+        pushTelemetry(TELEMETRY_MOTOR, healthPorts[i], health.temperature, health.current, health.scale);
+        reportedScale[i] = health.scale;
+      }
+    }
+    fraction += abscap(baseScale - fraction, HEALTH_CAP_SLEW*MOTOR_HEALTH_DT/1000.0);
+    if(baseOverTemp) fraction = fmin(fraction, baseScale);
+    /** on a low battery, full power is out of reach: cap at what the motors can get */
+    int32_t battery = pros::battery::get_voltage();
+    updateBatteryModel(battery, pros::battery::get_current());
+    refreshCurrentBudget();
+    double voltageCap = 127*fmin((battery - HEALTH_VOLTAGE_HEADROOM)/(double)MOTOR_REFERENCE_VOLTAGE, 1);
+    if(getBatteryState().resistance != 0){
+      /** the sag is predicted: the voltage left with the base at its full current limits */
+      int32_t baseCurrent = 0;
+      for(int i = 0; i < HEALTH_LEFT_ROLLER; i++) baseCurrent += getCurrentLimit((HealthMotor)i);
+      voltageCap = 127*fmin(predictBatteryVoltage(baseCurrent)/MOTOR_REFERENCE_VOLTAGE, 1);
+    }
+    baseDerateCap.store(fmax(fmin(MAX_POW*fraction, voltageCap), 0), std::memory_order_relaxed);
+    endTaskIteration(TIMING_HEALTH);
+    rate.wait();
+  }
+}
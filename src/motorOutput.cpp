@@ -0,0 +1,163 @@
+/**
+ * Motor output layer:
+ * - Cache of the last command of every smart port
+ * - Command functions sending only changes and keep-alives
+ * - Battery voltage compensation of the power and voltage commands
+ * - Outputs held at 0 during a dry run (refer to dryRun.hpp)
+ * - Bus traffic statistics
+ */
+#include "main.h"
+/**
+ * Last command of a port and when it was sent (millis).
+ * A port is written by one task at a time (the base is handed over by the task registry),
+ * so the fields only need to be individually atomic.
+ */
+struct MotorOutput{
+  std::atomic<uint8_t> mode;
+  std::atomic<int32_t> value;
+  std::atomic<uint32_t> sentAt;
+};
+MotorOutput motorOutputs[MOTOR_PORTS + 1];
+std::atomic<uint32_t> motorCommandsSent(0), motorCommandsSkipped(0);
+/** the commands are cached but a 0 power is sent in their place (refer to holdMotorOutputs) */
+std::atomic<bool> motorOutputsHeld(false);
+/**
+ * Compensation state
+ * batteryVoltage: moving average of the battery voltage in mV (0 until the first reading)
+ * batteryReadAt: when the battery was last read (millis)
+ */
+std::atomic<float> batteryVoltage(0);
+std::atomic<uint32_t> batteryReadAt(0);
+/**
+ * Check a command against the cache of its port and record it if it has to be sent.
+ * @return
+ * true if the command differs from the last one or the keep-alive is due
+ */
+bool updateMotorOutput(const pros::Motor &motor, MotorCommandMode mode, int32_t value){
+  uint8_t port = motor.get_port();
+  if(port > MOTOR_PORTS) return true;
+  MotorOutput &output = motorOutputs[port];
+  uint32_t now = millis();
+  if(output.mode == mode && output.value == value && now - output.sentAt < MOTOR_KEEPALIVE){
+    motorCommandsSkipped++;
+    return false;
+  }
+  output.mode = mode;
+  output.value = value;
+  output.sentAt = now;
+  motorCommandsSent++;
+  return true;
+}
+/**
+ * Scale a voltage command for the battery (refer to MOTOR_VOLTAGE_COMPENSATION).
+ * The battery is read by whichever task commands a motor once MOTOR_BATTERY_DT has passed;
+ * a failed reading keeps the last average. Once the battery model knows the battery's resistance, the command is
+ * scaled for the voltage predicted under the current the arbiter plans for (refer to getPlannedCurrent), so it
+ * holds as the subsystems start drawing instead of catching up after the sag.
+ * @param voltage
+ * voltage in mV (-12000 to 12000) meant for a battery at MOTOR_REFERENCE_VOLTAGE
+ *
+ * @return
+ * the command giving that voltage on the current battery (-12000 to 12000)
+ */
+int32_t compensateMotorVoltage(int32_t voltage){
+  if(!MOTOR_VOLTAGE_COMPENSATION) return voltage;
+  uint32_t now = millis(), readAt = batteryReadAt;
+  double battery = batteryVoltage.load(std::memory_order_relaxed);
+  if((battery == 0 || now - readAt >= MOTOR_BATTERY_DT) && batteryReadAt.compare_exchange_strong(readAt, now)){
+    int32_t reading = pros::battery::get_voltage();
+    if(reading > 0 && reading != PROS_ERR){
+      battery = battery == 0 ? reading : battery + MOTOR_BATTERY_FILTER*(reading - battery);
+      batteryVoltage.store(battery, std::memory_order_relaxed);
+    }
+  }
+  if(getBatteryState().resistance != 0) battery = predictBatteryVoltage(getPlannedCurrent());
+  if(battery <= 0) return voltage;
+  return lround(fmax(-12000, fmin(12000, voltage*MOTOR_REFERENCE_VOLTAGE/battery)));
+}
+/**
+ * Motor::move through the cache (as a compensated voltage command when MOTOR_VOLTAGE_COMPENSATION is on).
+ * @param motor
+ * the motor
+ *
+ * @param power
+ * power (-127 to 127)
+ */
+void setMotorPower(const pros::Motor &motor, int32_t power){
+  if(MOTOR_VOLTAGE_COMPENSATION) setMotorVoltage(motor, power*12000/127);
+  else if(updateMotorOutput(motor, MOTOR_COMMAND_POWER, power)) motor.move(motorOutputsHeld? 0 : power);
+}
+/**
+ * Motor::move_voltage through the cache, battery compensated.
+ * @param motor
+ * the motor
+ *
+ * @param voltage
+ * voltage in mV (-12000 to 12000)
+ */
+void setMotorVoltage(const pros::Motor &motor, int32_t voltage){
+  /** a held command is cached as asked, for the dry run's model */
+  bool held = motorOutputsHeld;
+  if(!held) voltage = compensateMotorVoltage(voltage);
+  if(updateMotorOutput(motor, MOTOR_COMMAND_VOLTAGE, voltage)) motor.move_voltage(held? 0 : voltage);
+}
+/**
+ * Motor::move_velocity through the cache.
+ * @param motor
+ * the motor
+ *
+ * @param velocity
+ * velocity in rpm (within the cartridge's range)
+ */
+void setMotorVelocity(const pros::Motor &motor, int32_t velocity){
+  if(!updateMotorOutput(motor, MOTOR_COMMAND_VELOCITY, velocity)) return;
+  if(motorOutputsHeld) motor.move(0);
+  else motor.move_velocity(velocity);
+}
+/**
+ * Forget the cached command of a motor, so the next command is sent
+ * (e.g. after commanding it directly through pros::Motor).
+ * @param motor
+ * the motor
+ */
+void resendMotorOutput(const pros::Motor &motor){
+  uint8_t port = motor.get_port();
+  if(port <= MOTOR_PORTS) motorOutputs[port].mode = MOTOR_COMMAND_NONE;
+}
+/**
+ * Hold every motor at 0 power (a dry run), or release them. Held commands are still cached (refer to getMotorCommand),
+ * and 0 is sent in their place; a motor stops at its next command or keep-alive. Released, every port sends its next
+ * command.
+ * @param hold
+ * true to hold
+ */
+void holdMotorOutputs(bool hold){
+  motorOutputsHeld = hold;
+  if(hold) return;
+  for(int port = 1; port <= MOTOR_PORTS; port++) motorOutputs[port].mode = MOTOR_COMMAND_NONE;
+}
+/**
+ * Last command of a port (sent or held).
+ * @param port
+ * smart port (1 to MOTOR_PORTS)
+ *
+ * @param mode, value
+ * set to the command
+ *
+ * @return
+ * false if the port was not commanded
+ */
+bool getMotorCommand(uint8_t port, MotorCommandMode &mode, int32_t &value){
+  if(port < 1 || port > MOTOR_PORTS) return false;
+  mode = (MotorCommandMode)motorOutputs[port].mode.load();
+  value = motorOutputs[port].value;
+  return mode != MOTOR_COMMAND_NONE;
+}
+/**
+ * @return
+ * commands sent and skipped since the start
+ */
+MotorOutputStats getMotorOutputStats(){
+  MotorOutputStats stats = {motorCommandsSent, motorCommandsSkipped};
+  return stats;
+}
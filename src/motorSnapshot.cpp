@@ -0,0 +1,55 @@
+/**
+ * Motor snapshot functions (refer to motorSnapshot.hpp):
+ * - Task motorSampler: the data of the eight motors into the snapshot
+ * - The latest snapshot, for the tasks that read the motors
+ */
+#include "main.h"
+/** the latest snapshot (written by Task motorSampler only) */
+SeqLock<MotorSnapshot> snapshotLock;
+/**
+ * @return
+ * the latest snapshot of the motors (all 0 before the first read)
+ */
+MotorSnapshot getMotorSnapshot(){
+  return snapshotLock.read();
+}
+/**
+ * Read the motors every MOTOR_SNAPSHOT_DT, their temperatures every MOTOR_SNAPSHOT_SLOW_DT, and publish the
+ * snapshot. Runs in every phase (refer to taskRegistry.hpp).
+ */
+void motorSampler(void * ignore){
+  LoopRate rate(MOTOR_SNAPSHOT_DT);
+  const pros::Motor *mechMotors[] = {&lRoller, &rRoller, &indexer, &shooter};
+  MotorSnapshot snapshot;
+  memset(&snapshot, 0, sizeof(snapshot));
+  startTaskTiming(TIMING_SNAPSHOT, MOTOR_SNAPSHOT_DT, true);
+  while(true){
+    beginTaskIteration(TIMING_SNAPSHOT);
+    uint32_t now = millis();
+    bool slow = snapshot.slowTime == 0 || now - snapshot.slowTime >= MOTOR_SNAPSHOT_SLOW_DT;
+    for(int i = 0; i < HEALTH_MOTORS; i++){
+      if(i < HEALTH_LEFT_ROLLER){
+        BaseMotor motor = (BaseMotor)i;
+        snapshot.position[i] = drivetrain.getPosition(motor);
+        snapshot.velocity[i] = drivetrain.getVelocity(motor);
+        snapshot.current[i] = drivetrain.getCurrent(motor);
+        if(!slow) continue;
+        snapshot.temperature[i] = drivetrain.getTemperature(motor);
+        snapshot.overTemp[i] = drivetrain.isOverTemp(motor);
+        continue;
+      }
+      const pros::Motor &mech = *mechMotors[i - HEALTH_LEFT_ROLLER];
+      snapshot.position[i] = mech.get_position();
+      snapshot.velocity[i] = mech.get_actual_velocity();
+      snapshot.current[i] = mech.get_current_draw();
+      if(!slow) continue;
+      snapshot.temperature[i] = mech.get_temperature();
+      snapshot.overTemp[i] = mech.is_over_temp() == 1;
+    }
+    snapshot.fastTime = now;
+    if(slow) snapshot.slowTime = now;
+    snapshotLock.write(snapshot);
+    endTaskIteration(TIMING_SNAPSHOT);
+    rate.wait();
+  }
+}
@@ -0,0 +1,136 @@
+/**
+ * Move-to-pose controller (refer to moveToPose.hpp):
+ * - Carrot point of the goal pose at the distance left
+ * - Forward and angular velocities towards it, split into side velocities
+ * - Straight translation and concurrent turn of a holonomic base
+ * - Move-to-pose movement functions
+ */
+#include "main.h"
+/**
+ * Side and strafe velocities that bring a holonomic base to the goal pose: it translates straight at the
+ * goal point while it turns to the goal bearing, so there is no carrot to curve in on (the lead and the
+ * direction of the goal do not apply).
+ * @param pose
+ * live pose
+ *
+ * @param goal
+ * the goal pose and the parameters of the movement
+ *
+ * @param velL, velR, velS
+ * set to the side and strafe velocities (in/s)
+ *
+ * @return
+ * false once the robot is within MOVE_POSE_END_DIST and MOVE_POSE_END_ANGLE of the goal (velocities 0)
+ */
+bool computeHolonomicMoveToPose(const PoseSnapshot &pose, const PoseMoveGoal &goal, double &velL, double &velR, double &velS){
+  velL = velR = velS = 0;
+  double dx = goal.x - pose.x, dy = goal.y - pose.y;
+  double distance = hypot(dx, dy);
+  double angleError = angleDiff(goal.angle, pose.angle);
+  if(distance < MOVE_POSE_END_DIST && fabs(angleError)*toDeg < MOVE_POSE_END_ANGLE) return false;
+  /** slow down for the goal */
+  double speed = fmin(fmin(goal.maxVel, sqrt(2*MOVE_POSE_MAX_DECEL*distance)), MOVE_POSE_LIN_GAIN*distance);
+  double vel = distance > 1e-6? speed/distance : 0;
+  /** the way to the goal point along and across the heading */
+  splitHolonomicVelocity(vel*(dx*sin(pose.angle) + dy*cos(pose.angle)), vel*(dx*cos(pose.angle) - dy*sin(pose.angle)),
+                         MOVE_POSE_ANG_GAIN*angleError, goal.maxVel, velL, velR, velS);
+  return true;
+}
+/**
+ * Side velocities that bring the robot to the goal pose: far from the goal it steers towards the
+ * carrot, set back from the goal point along the goal bearing by goal.lead times the distance left, so
+ * the path curves in and arrives along the bearing; within MOVE_POSE_CLOSE_DIST it turns to the bearing
+ * and closes the distance along its heading. Bearings are clockwise.
+ * @param pose
+ * live pose
+ *
+ * @param goal
+ * the goal pose and the parameters of the movement
+ *
+ * @param velL, velR
+ * set to the side velocities (in/s)
+ *
+ * @param velS
+ * set to the strafe velocity (in/s; a holonomic base translates instead, refer to computeHolonomicMoveToPose)
+ *
+ * @return
+ * false once the robot is within MOVE_POSE_END_DIST (along its heading) and MOVE_POSE_END_ANGLE of the goal
+ * (velocities 0)
+ */
+bool computeMoveToPose(const PoseSnapshot &pose, const PoseMoveGoal &goal, double &velL, double &velR, double &velS){
+  if(HOLONOMIC_BASE) return computeHolonomicMoveToPose(pose, goal, velL, velR, velS);
+  velL = velR = velS = 0;
+  double distance = hypot(goal.x - pose.x, goal.y - pose.y);
+  /** when reversing, the back of the robot is the front, and it arrives back first */
+  double heading = goal.reverse? pose.angle + PI : pose.angle;
+  double arrival = goal.reverse? goal.angle + PI : goal.angle;
+  double linVel, angleError;
+  if(distance > MOVE_POSE_CLOSE_DIST){
+    double carrotX = goal.x - goal.lead*distance*sin(arrival), carrotY = goal.y - goal.lead*distance*cos(arrival);
+    angleError = angleDiff(atan2(carrotX - pose.x, carrotY - pose.y), heading);
+    /** slow down while facing away from the carrot, turn on the spot beyond 90 degrees */
+    linVel = distance*fmax(0, cos(angleError));
+  }
+  else{
+    /** the offset across the heading is left (as after a turn, a drive and a turn) */
+    angleError = angleDiff(arrival, heading);
+    linVel = (goal.x - pose.x)*sin(heading) + (goal.y - pose.y)*cos(heading);
+    if(fabs(linVel) < MOVE_POSE_END_DIST && fabs(angleError)*toDeg < MOVE_POSE_END_ANGLE) return false;
+  }
+  /** slow down for the goal */
+  double maxLinVel = fmin(goal.maxVel, sqrt(2*MOVE_POSE_MAX_DECEL*distance));
+  linVel = fmax(-maxLinVel, fmin(maxLinVel, MOVE_POSE_LIN_GAIN*linVel));
+  double angVel = MOVE_POSE_ANG_GAIN*angleError;
+  /** refer to Odometry Documentation.docx: side velocities of a turn */
+  double left = linVel + angVel*baseWidth/2;
+  double right = linVel - angVel*baseWidth/2;
+  /** keep the outer side within the velocity limit */
+  double fastest = fmax(fabs(left), fabs(right));
+  if(fastest > goal.maxVel){
+    left *= goal.maxVel/fastest;
+    right *= goal.maxVel/fastest;
+  }
+  /** reversed: the front's left side is the robot's right side */
+  velL = goal.reverse? -right : left;
+  velR = goal.reverse? -left : right;
+  return true;
+}
+/**
+ * Drive to a point and arrive at a bearing in one movement.
+ * @param x, y
+ * goal point in field coordinates
+ *
+ * @param angleDeg
+ * bearing on arrival in degrees (of the front of the robot, also when reversing)
+ *
+ * @param lead
+ * carrot set back by this share of the distance to the goal (refer to MOVE_POSE_LEAD)
+ *
+ * @param maxVel
+ * maximum velocity in inches per second
+ *
+ * @param reverse
+ * true: backward movement
+ * false: forward movement
+ *
+ * @note
+ * Use waitBase(cutoff) to wait until the goal is reached.
+ */
+void baseMoveToPose(double x, double y, double angleDeg, double lead, double maxVel, bool reverse){
+  startBaseMoveToPose({x, y, angleDeg*toRad, lead, maxVel, reverse});
+}
+/**
+ * Drive to a point and arrive at a bearing using the default lead and velocity.
+ * @param x, y
+ * goal point in field coordinates
+ *
+ * @param angleDeg
+ * bearing on arrival in degrees
+ *
+ * @param reverse (optional. default = false)
+ * true: backward movement
+ * false: forward movement
+ */
+void baseMoveToPose(double x, double y, double angleDeg, bool reverse){
+  baseMoveToPose(x, y, angleDeg, MOVE_POSE_LEAD, MOVE_POSE_MAX_VEL, reverse);
+}
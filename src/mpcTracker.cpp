@@ -0,0 +1,168 @@
+/**
+ * Model-predictive tracker (refer to mpcTracker.hpp):
+ * - QP of every entry of the linearization grid, built once
+ * - A control cycle: error in the robot's frame, velocity bounds over the horizon, projected fast gradient
+ */
+#include "main.h"
+/** QPs of the grid (speed class major), built by prepareMpc */
+MpcStructure mpcStructures[MPC_SPEED_CLASSES*MPC_TURN_CLASSES];
+bool mpcPrepared = false;
+/** solution of the previous control cycle, the warm start of the next (control task only) */
+Matrix<MPC_INPUTS, 1> mpcSolution = {};
+/**
+ * Build the QP of the model linearized about a reference velocity and turn rate.
+ * @param vel
+ * reference velocity (in/s)
+ *
+ * @param turn
+ * reference turn rate (rad/s clockwise)
+ *
+ * @param structure
+ * set to the QP
+ */
+void buildMpcStructure(double vel, double turn, MpcStructure &structure){
+  Matrix<3, 3> a = identityMatrix<3>();
+  a(0, 1) = turn*MPC_DT;
+  a(1, 0) = -turn*MPC_DT;
+  a(1, 2) = vel*MPC_DT;
+  Matrix<3, 2> b = {};
+  b(0, 0) = b(0, 1) = -MPC_DT/2;
+  b(2, 0) = -MPC_DT/baseWidth;
+  b(2, 1) = MPC_DT/baseWidth;
+  /** power[k] = a^k */
+  Matrix<3, 3> power[MPC_HORIZON + 1];
+  power[0] = identityMatrix<3>();
+  for(int k = 1; k <= MPC_HORIZON; k++) power[k] = a*power[k - 1];
+  /**
+   * prediction of the errors after steps 1 to MPC_HORIZON: E = free*e + inputs*U, the error of step k being
+   * a^k e + the sum over j < k of a^(k-1-j) b u_j; weighted is inputs with its rows weighted by the cost
+   */
+  Matrix<3*MPC_HORIZON, MPC_INPUTS> inputs = {}, weighted = {};
+  Matrix<3*MPC_HORIZON, 3> weightedFree = {};
+  const double weights[3] = {MPC_Q_FORWARD, MPC_Q_LATERAL, MPC_Q_ANGLE};
+  for(int k = 1; k <= MPC_HORIZON; k++){
+    for(int j = 0; j < k; j++){
+      Matrix<3, 2> block = power[k - 1 - j]*b;
+      for(int r = 0; r < 3; r++) for(int c = 0; c < 2; c++) inputs(3*(k - 1) + r, 2*j + c) = block(r, c);
+    }
+    for(int r = 0; r < 3; r++){
+      for(int c = 0; c < MPC_INPUTS; c++) weighted(3*(k - 1) + r, c) = weights[r]*inputs(3*(k - 1) + r, c);
+      for(int c = 0; c < 3; c++) weightedFree(3*(k - 1) + r, c) = weights[r]*power[k](r, c);
+    }
+  }
+  Matrix<MPC_INPUTS, 3*MPC_HORIZON> inputsT = transpose(inputs);
+  structure.hessian = inputsT*weighted + MPC_R*identityMatrix<MPC_INPUTS>();
+  structure.gradient = inputsT*weightedFree;
+  /** largest eigenvalue of the hessian by power iteration */
+  Matrix<MPC_INPUTS, 1> x;
+  for(int i = 0; i < MPC_INPUTS; i++) x(i, 0) = 1;
+  double largest = MPC_R;
+  for(int iteration = 0; iteration < 64; iteration++){
+    Matrix<MPC_INPUTS, 1> y = structure.hessian*x;
+    double norm = 0;
+    for(int i = 0; i < MPC_INPUTS; i++) norm += y(i, 0)*y(i, 0);
+    norm = sqrt(norm);
+    if(norm == 0) break;
+    largest = 0;
+    for(int i = 0; i < MPC_INPUTS; i++){
+      largest += x(i, 0)*y(i, 0);
+      x(i, 0) = y(i, 0)/norm;
+    }
+    largest = fmax(largest, MPC_R);
+  }
+  /** the power iteration approaches the eigenvalue from below: a 10% margin keeps the step stable */
+  structure.step = 1/(1.1*largest);
+  double ratio = sqrt(MPC_R/(1.1*largest));
+  structure.momentum = (1 - ratio)/(1 + ratio);
+}
+/**
+ * Build the QPs of the linearization grid (once; about a millisecond on the V5). Called at boot, and by
+ * startBaseMpc if it has not run.
+ */
+void prepareMpc(){
+  if(mpcPrepared) return;
+  for(int speed = 0; speed < MPC_SPEED_CLASSES; speed++){
+    for(int turn = 0; turn < MPC_TURN_CLASSES; turn++){
+      double vel = -MPC_MAX_VEL + 2.0*MPC_MAX_VEL*speed/(MPC_SPEED_CLASSES - 1);
+      double rate = -MPC_MAX_TURN + 2.0*MPC_MAX_TURN*turn/(MPC_TURN_CLASSES - 1);
+      buildMpcStructure(vel, rate, mpcStructures[speed*MPC_TURN_CLASSES + turn]);
+    }
+  }
+  mpcPrepared = true;
+}
+/**
+ * @param vel
+ * reference velocity (in/s)
+ *
+ * @param turn
+ * reference turn rate (rad/s clockwise)
+ *
+ * @return
+ * the QP of the nearest grid entry (prepareMpc must have run)
+ */
+const MpcStructure *getMpcStructure(double vel, double turn){
+  int speed = lround((vel + MPC_MAX_VEL)/(2*MPC_MAX_VEL)*(MPC_SPEED_CLASSES - 1));
+  int rate = lround((turn + MPC_MAX_TURN)/(2*MPC_MAX_TURN)*(MPC_TURN_CLASSES - 1));
+  speed = std::min(std::max(speed, 0), MPC_SPEED_CLASSES - 1);
+  rate = std::min(std::max(rate, 0), MPC_TURN_CLASSES - 1);
+  return &mpcStructures[speed*MPC_TURN_CLASSES + rate];
+}
+/**
+ * Forget the previous solution (at the start of a trajectory).
+ */
+void resetMpc(){
+  mpcSolution = {};
+}
+/**
+ * Side velocities that bring the robot onto a trajectory, from the solution of the QP at the reference
+ * velocities of the time (interpolated between the segments, refer to sampleTrajectory).
+ * @param pose
+ * live pose
+ *
+ * @param trajectory
+ * the trajectory (with poses)
+ *
+ * @param t
+ * time along the trajectory (s)
+ *
+ * @param velL, velR
+ * set to the side velocities (in/s)
+ */
+HOT_PATH void computeMpc(const PoseSnapshot &pose, const CachedTrajectory &trajectory, double t, double &velL, double &velR){
+  TrajectorySample left = sampleTrajectory(trajectory, false, t);
+  TrajectorySample right = sampleTrajectory(trajectory, true, t);
+  PackedPose reference = sampleTrajectoryPose(trajectory, t);
+  double dx = reference.x - pose.x, dy = reference.y - pose.y;
+  double sinAngle = sin(pose.angle), cosAngle = cos(pose.angle);
+  Matrix<3, 1> error;
+  error(0, 0) = dx*sinAngle + dy*cosAngle;
+  error(1, 0) = dx*cosAngle - dy*sinAngle;
+  error(2, 0) = angleDiff(reference.angle, pose.angle);
+  const MpcStructure &qp = *getMpcStructure((left.velocity + right.velocity)/2, (left.velocity - right.velocity)/baseWidth);
+  Matrix<MPC_INPUTS, 1> linear = qp.gradient*error;
+  /** the corrections keep each side within MPC_MAX_VEL at the reference velocities of its step */
+  double lower[MPC_INPUTS], upper[MPC_INPUTS];
+  for(int k = 0; k < MPC_HORIZON; k++){
+    double refL = k == 0? left.velocity : sampleTrajectory(trajectory, false, t + k*MPC_DT).velocity;
+    double refR = k == 0? right.velocity : sampleTrajectory(trajectory, true, t + k*MPC_DT).velocity;
+    lower[2*k] = -MPC_MAX_VEL - refL;
+    upper[2*k] = MPC_MAX_VEL - refL;
+    lower[2*k + 1] = -MPC_MAX_VEL - refR;
+    upper[2*k + 1] = MPC_MAX_VEL - refR;
+  }
+  /** projected fast gradient from the previous solution */
+  Matrix<MPC_INPUTS, 1> solution, extrapolated;
+  for(int n = 0; n < MPC_INPUTS; n++) solution(n, 0) = extrapolated(n, 0) = fmin(fmax(mpcSolution(n, 0), lower[n]), upper[n]);
+  for(int iteration = 0; iteration < MPC_ITERATIONS; iteration++){
+    Matrix<MPC_INPUTS, 1> gradient = qp.hessian*extrapolated + linear;
+    MATRIX_LOOP
+    for(int n = 0; n < MPC_INPUTS; n++){
+      double next = fmin(fmax(extrapolated(n, 0) - qp.step*gradient(n, 0), lower[n]), upper[n]);
+      extrapolated(n, 0) = next + qp.momentum*(next - solution(n, 0));
+      solution(n, 0) = next;
+    }
+  }
+  mpcSolution = solution;
+  velL = left.velocity + solution(0, 0);
+  velR = right.velocity + solution(1, 0);
+}
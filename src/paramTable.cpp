@@ -0,0 +1,203 @@
+/**
+ * Live parameter table:
+ * - Double-buffered table, published by an atomic pointer swap
+ * - Changes by name, with limits
+ * - Saving & loading of the parameters on the microSD card
+ * - Commands from the serial terminal (polled by the telemetry drain task)
+ */
+#include "main.h"
+#include "pros/apix.h"
+/** default values, in the order of TunableParam */
+#define PARAM_DEFAULTS {DEFAULT_KP, DEFAULT_KD, RAMPING_POW, MAX_POW, 1, 1, PROFILE_MAX_VEL, PROFILE_MAX_ACC, PURSUIT_LOOKAHEAD, 127}
+/**
+ * Name and limits of a parameter (a change outside the limits is refused)
+ */
+struct ParamInfo{
+  const char *name;
+  double min, max;
+};
+const ParamInfo paramInfo[PARAMS] = {
+  {"trajectoryKp", 0, 10},
+  {"trajectoryKd", 0, 50},
+  {"rampingPow", 1, 127},
+  {"maxPow", 0, 127},
+  {"kpScale", 0.1, 10},
+  {"kdScale", 0.1, 10},
+  {"profileMaxVel", 1, 80},
+  {"profileMaxAcc", 1, 400},
+  {"pursuitLookahead", 2, 48},
+  {"cycleSpeed", 0, 127}
+};
+const double paramDefaults[PARAMS] = PARAM_DEFAULTS;
+/**
+ * The two tables: paramTable points to the published one, the other is the spare the next change is written into.
+ * A change is made by one writer at a time (paramWriter), at least PARAM_GRACE ms after the previous one (paramPublished).
+ */
+ParamTable paramTables[2] = {{PARAM_DEFAULTS, 0}, {PARAM_DEFAULTS, 0}};
+std::atomic<const ParamTable *> paramTable(&paramTables[0]);
+std::atomic<bool> paramWriter(false);
+uint32_t paramPublished = 0;
+/** command line being received from the serial terminal (telemetry drain task only) */
+char paramLine[PARAM_LINE];
+int paramLineLength = 0;
+/**
+ * @param name
+ * name of a parameter
+ *
+ * @return
+ * the parameter (TunableParam), -1 if there is none of that name
+ */
+int findParam(const char *name){
+  for(int i = 0; i < PARAMS; i++) if(strcmp(paramInfo[i].name, name) == 0) return i;
+  return -1;
+}
+/**
+ * @param param
+ * a parameter
+ *
+ * @return
+ * its name (in the parameter file and the serial commands)
+ */
+const char *getParamName(TunableParam param){
+  return paramInfo[param].name;
+}
+/**
+ * Change several parameters at once: the control loops see all the changes or none of them.
+ * Blocks for up to PARAM_GRACE ms (call from a task that may wait, never from a control loop).
+ * @param params
+ * the parameters
+ *
+ * @param values
+ * their new values
+ *
+ * @param count
+ * number of parameters
+ *
+ * @return
+ * false if a value is outside the limits of its parameter (nothing is changed)
+ */
+bool setParams(const TunableParam *params, const double *values, int count){
+  for(int i = 0; i < count; i++){
+    if(params[i] < 0 || params[i] >= PARAMS || !(values[i] >= paramInfo[params[i]].min && values[i] <= paramInfo[params[i]].max)) return false;
+  }
+  while(paramWriter.exchange(true)) delay(1);
+  /** the spare table may still be read until PARAM_GRACE after it was replaced */
+  while(millis() - paramPublished < PARAM_GRACE) delay(1);
+  const ParamTable *published = paramTable.load(std::memory_order_relaxed);
+  ParamTable *spare = published == &paramTables[0] ? &paramTables[1] : &paramTables[0];
+  *spare = *published;
+  for(int i = 0; i < count; i++) spare->values[params[i]] = values[i];
+  spare->version = published->version + 1;
+  paramTable.store(spare, std::memory_order_release);
+  paramPublished = millis();
+  paramWriter = false;
+  return true;
+}
+/**
+ * Change a parameter (refer to setParams).
+ * @return
+ * false if the value is outside the limits of the parameter
+ */
+bool setParam(TunableParam param, double value){
+  return setParams(&param, &value, 1);
+}
+/**
+ * Put every parameter back to its default value.
+ */
+void resetParams(){
+  TunableParam params[PARAMS];
+  double values[PARAMS];
+  for(int i = 0; i < PARAMS; i++){
+    params[i] = (TunableParam)i;
+    values[i] = paramDefaults[i];
+  }
+  setParams(params, values, PARAMS);
+}
+/**
+ * Load the parameters from the microSD card (PARAM_FILE_PATH), as one change.
+ * @return
+ * false if there is no card, no file, or a line names an unknown parameter or holds a value outside its limits
+ * (nothing is changed)
+ */
+bool loadParams(){
+  if(!usd::is_installed()) return false;
+  ConfigFile file;
+  if(!file.open(PARAM_FILE_PATH)) return false;
+  TunableParam params[PARAMS];
+  double values[PARAMS];
+  int count = 0;
+  ConfigEntry entry;
+  while(file.next(entry)){
+    int param = findParam(entry.key.data());
+    if(param < 0 || count == PARAMS || !entry.getNumbers(&values[count], 1)) return false;
+    params[count++] = (TunableParam)param;
+  }
+  /** the buffer is released before waiting on the table */
+  file.close();
+  return !file.failed() && setParams(params, values, count);
+}
+/**
+ * Save the published parameters to the microSD card (PARAM_FILE_PATH), e.g. at the end of a tuning session.
+ * @return
+ * false if there is no card or the file cannot be written
+ */
+bool saveParams(){
+  if(!usd::is_installed()) return false;
+  FILE *file = fopen(PARAM_FILE_PATH, "w");
+  if(file == NULL) return false;
+  const ParamTable *table = getParams();
+  for(int i = 0; i < PARAMS; i++) fprintf(file, "%s %g\n", paramInfo[i].name, table->values[i]);
+  fclose(file);
+  return true;
+}
+/**
+ * Run a command line from the serial terminal:
+ * "name value" changes a parameter, "name" prints it, "list" prints them all,
+ * "load" & "save" load and save the parameter file, "reset" restores the defaults.
+ * The replies are only printed with TELEMETRY_TEXT (they would break the frames of the binary formats).
+ * @param line
+ * the command
+ *
+ * @return
+ * false if the command is unknown or refused
+ */
+bool runParamCommand(const char *line){
+  char name[32];
+  double value;
+  int fields = sscanf(line, "%31s %lf", name, &value);
+  if(fields < 1) return false;
+  int param = findParam(name);
+  bool done = true, list = param < 0;
+  if(param >= 0) done = fields < 2 || setParam((TunableParam)param, value);
+  else if(strcmp(name, "load") == 0) done = loadParams();
+  else if(strcmp(name, "save") == 0) done = saveParams();
+  else if(strcmp(name, "reset") == 0) resetParams();
+  else done = strcmp(name, "list") == 0;
+  if(TELEMETRY_FORMAT == TELEMETRY_TEXT){
+    if(!done) printf("param: %s refused\n", line);
+    else if(list) for(int i = 0; i < PARAMS; i++) printf("%s %g\n", paramInfo[i].name, getParam((TunableParam)i));
+    else printf("%s %g\n", name, getParam((TunableParam)param));
+  }
+  return done;
+}
+/**
+ * Take the bytes received from the serial terminal (without blocking) and run each complete line.
+ * Called by the telemetry drain task, which owns the serial link.
+ */
+void pollParamCommands(){
+  while(true){
+    int c = -1;
+    if(TELEMETRY_SERIAL_PORT == 0){
+      if(pros::c::fdctl(fileno(stdin), DEVCTL_FIONREAD, NULL) > 0) c = getchar();
+    }
+    else if(pros::c::serial_get_read_avail(TELEMETRY_SERIAL_PORT) > 0) c = pros::c::serial_read_byte(TELEMETRY_SERIAL_PORT);
+    if(c < 0) return;
+    if(c == '\n' || c == '\r'){
+      paramLine[paramLineLength] = 0;
+      if(paramLineLength > 0) runParamCommand(paramLine);
+      paramLineLength = 0;
+    }
+    /** an overlong line is cut */
+    else if(paramLineLength < PARAM_LINE - 1) paramLine[paramLineLength++] = c;
+  }
+}
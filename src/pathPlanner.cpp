@@ -0,0 +1,638 @@
+/**
+ * Path planner functions:
+ * - Occupancy grid generated at compile time
+ * - Obstacles added at run time (e.g. a robot seen on the way)
+ * - A* search (8-connected, octile heuristic, indexed binary heap)
+ * - D* Lite incremental search, repaired on the changed cells instead of replanned
+ * - Line of sight smoothing into pursuit waypoints
+ */
+#include "main.h"
+// Cost of a diagonal move (a straight move costs 1)
+#define PLANNER_DIAGONAL 1.41421356f
+// Keys of the incremental search closer than this are tied (float rounding of the path costs)
+#define PLANNER_KEY_TIE 1e-3f
+/** the goals of the field (Change Up: corners, wall centres and field centre) */
+constexpr FieldObstacle fieldObstacles[FIELD_OBSTACLES] = {
+  {6, 6, 7}, {6, 72, 7}, {6, 138, 7},
+  {72, 6, 7}, {72, 72, 7}, {72, 138, 7},
+  {138, 6, 7}, {138, 72, 7}, {138, 138, 7}
+};
+/**
+ * Generate the occupancy grid at compile time: a cell is blocked if its centre is within
+ * the clearance of a wall or of an obstacle's edge.
+ * @return
+ * the grid
+ */
+constexpr OccupancyGrid makeOccupancyGrid(){
+  OccupancyGrid grid = {};
+  const double size = PLANNER_GRID*PLANNER_CELL;
+  for(int y = 0; y < PLANNER_GRID; y++){
+    for(int x = 0; x < PLANNER_GRID; x++){
+      double cx = (x + 0.5)*PLANNER_CELL, cy = (y + 0.5)*PLANNER_CELL;
+      bool blocked = cx < PLANNER_CLEARANCE || cy < PLANNER_CLEARANCE || cx > size - PLANNER_CLEARANCE || cy > size - PLANNER_CLEARANCE;
+      for(int i = 0; i < FIELD_OBSTACLES && !blocked; i++){
+        double dx = cx - fieldObstacles[i].x, dy = cy - fieldObstacles[i].y;
+        double reach = fieldObstacles[i].radius + PLANNER_CLEARANCE;
+        blocked = dx*dx + dy*dy < reach*reach;
+      }
+      if(blocked) grid.rows[y] |= 1ull << x;
+    }
+  }
+  return grid;
+}
+constexpr OccupancyGrid plannerGrid = makeOccupancyGrid();
+static_assert(PLANNER_GRID <= 64, "a grid row must fit in a uint64_t");
+/** cells blocked at run time (setPlannerObstacle), on top of plannerGrid */
+OccupancyGrid plannerObstacles = {};
+/**
+ * Cells changed since the incremental search last ran (refer to replanPath); on overflow the
+ * search starts over instead
+ */
+uint16_t plannerChanges[PLANNER_MAX_CHANGES];
+int plannerChangeCount = 0;
+bool plannerChangesLost = false;
+/**
+ * @param x, y
+ * cell
+ *
+ * @return
+ * whether the cell is on the field and not blocked
+ */
+bool isPlannerCellFree(int x, int y){
+  if(x < 0 || y < 0 || x >= PLANNER_GRID || y >= PLANNER_GRID) return false;
+  return (((plannerGrid.rows[y] | plannerObstacles.rows[y]) >> x) & 1) == 0;
+}
+/**
+ * Block or free the cells around a round obstacle seen at run time (inflated by the clearance, as
+ * the field obstacles are). Both searches avoid it from then on; a path being followed is repaired
+ * by repairPlannedPursuit. Call from the task that plans.
+ * @param x, y
+ * centre of the obstacle in odometry coordinates (inches)
+ *
+ * @param radius
+ * radius of the obstacle in inches
+ *
+ * @param blocked
+ * true: block the cells, false: free them again (the field obstacles stay)
+ *
+ * @return
+ * number of cells changed
+ */
+int setPlannerObstacle(double x, double y, double radius, bool blocked){
+  double fieldX = x + PLANNER_ORIGIN_X, fieldY = y + PLANNER_ORIGIN_Y, reach = radius + PLANNER_CLEARANCE;
+  int x0 = (int)floor(fmax(0, fieldX - reach)/PLANNER_CELL), x1 = (int)fmin(PLANNER_GRID - 1, floor((fieldX + reach)/PLANNER_CELL));
+  int y0 = (int)floor(fmax(0, fieldY - reach)/PLANNER_CELL), y1 = (int)fmin(PLANNER_GRID - 1, floor((fieldY + reach)/PLANNER_CELL));
+  int changed = 0;
+  for(int cy = y0; cy <= y1; cy++){
+    for(int cx = x0; cx <= x1; cx++){
+      double dx = (cx + 0.5)*PLANNER_CELL - fieldX, dy = (cy + 0.5)*PLANNER_CELL - fieldY;
+      uint64_t bit = 1ull << cx;
+      if(dx*dx + dy*dy >= reach*reach || ((plannerObstacles.rows[cy] & bit) != 0) == blocked) continue;
+      plannerObstacles.rows[cy] ^= bit;
+      if(plannerChangeCount < PLANNER_MAX_CHANGES) plannerChanges[plannerChangeCount++] = cy*PLANNER_GRID + cx;
+      else plannerChangesLost = true;
+      changed++;
+    }
+  }
+  return changed;
+}
+/**
+ * Free every cell blocked at run time.
+ */
+void clearPlannerObstacles(){
+  for(int cy = 0; cy < PLANNER_GRID; cy++){
+    for(int cx = 0; cx < PLANNER_GRID; cx++){
+      if(((plannerObstacles.rows[cy] >> cx) & 1) == 0) continue;
+      if(plannerChangeCount < PLANNER_MAX_CHANGES) plannerChanges[plannerChangeCount++] = cy*PLANNER_GRID + cx;
+      else plannerChangesLost = true;
+    }
+    plannerObstacles.rows[cy] = 0;
+  }
+}
+/**
+ * Search state, static so a plan uses no stack or heap (one plan at a time)
+ * planCost: cost from the start (cells); planParent: previous cell on the best path
+ * planHeap: open cells ordered by estimated total cost; planHeapIndex: position of a cell in it (-1: none)
+ * planClosed: bit-packed like the grid
+ */
+#define PLANNER_CELLS (PLANNER_GRID*PLANNER_GRID)
+float planCost[PLANNER_CELLS], planEstimate[PLANNER_CELLS];
+uint16_t planParent[PLANNER_CELLS], planHeap[PLANNER_CELLS];
+int16_t planHeapIndex[PLANNER_CELLS];
+uint64_t planClosed[PLANNER_GRID];
+int planHeapSize = 0;
+/** cells of the last path found, from the goal back to the start (refer to smoothPlanCells) */
+uint16_t planPathCells[PLANNER_CELLS + 1];
+/** heap helpers: restore the order after a cell's estimate decreased, and pop the best cell */
+void planHeapUp(int i){
+  uint16_t cell = planHeap[i];
+  while(i > 0){
+    int parent = (i - 1)/2;
+    if(planEstimate[planHeap[parent]] <= planEstimate[cell]) break;
+    planHeap[i] = planHeap[parent];
+    planHeapIndex[planHeap[i]] = i;
+    i = parent;
+  }
+  planHeap[i] = cell;
+  planHeapIndex[cell] = i;
+}
+uint16_t planHeapPop(){
+  uint16_t best = planHeap[0];
+  planHeapIndex[best] = -1;
+  uint16_t cell = planHeap[--planHeapSize];
+  int i = 0;
+  while(planHeapSize > 0){
+    int child = 2*i + 1;
+    if(child >= planHeapSize) break;
+    if(child + 1 < planHeapSize && planEstimate[planHeap[child + 1]] < planEstimate[planHeap[child]]) child++;
+    if(planEstimate[cell] <= planEstimate[planHeap[child]]) break;
+    planHeap[i] = planHeap[child];
+    planHeapIndex[planHeap[i]] = i;
+    i = child;
+  }
+  if(planHeapSize > 0){
+    planHeap[i] = cell;
+    planHeapIndex[cell] = i;
+  }
+  return best;
+}
+/**
+ * Octile distance between two cells (the exact cost of an 8-connected move on an empty grid).
+ */
+float octile(int x0, int y0, int x1, int y1){
+  int dx = abs(x1 - x0), dy = abs(y1 - y0);
+  return dx + dy + (PLANNER_DIAGONAL - 2)*(dx < dy? dx : dy);
+}
+/**
+ * @param x0, y0, x1, y1
+ * field points in inches from the bottom left corner
+ *
+ * @return
+ * whether the segment between them only crosses free cells (sampled every half cell)
+ */
+bool lineOfSight(double x0, double y0, double x1, double y1){
+  double length = hypot(x1 - x0, y1 - y0);
+  int steps = (int)(length/(0.5*PLANNER_CELL)) + 1;
+  for(int i = 0; i <= steps; i++){
+    double t = (double)i/steps;
+    if(!isPlannerCellFree((int)floor((x0 + t*(x1 - x0))/PLANNER_CELL), (int)floor((y0 + t*(y1 - y0))/PLANNER_CELL))) return false;
+  }
+  return true;
+}
+/**
+ * Turn the cells of a path (planPathCells, from the goal back to the start) into waypoints,
+ * keeping only the cells the previous kept point cannot see past.
+ * @param cellCount
+ * number of cells (the goal and the start included, even if they are the same cell)
+ *
+ * @param fieldStartX, fieldStartY, fieldGoalX, fieldGoalY
+ * exact start and goal in inches from the bottom left corner
+ *
+ * @param points, maxPoints
+ * as for planPath
+ *
+ * @return
+ * number of waypoints, or -1 if more than maxPoints are needed
+ */
+int smoothPlanCells(int cellCount, double fieldStartX, double fieldStartY, double fieldGoalX, double fieldGoalY,
+  PursuitPoint *points, int maxPoints){
+  PursuitPoint reversed[MAX_PURSUIT_POINTS];
+  int count = 0;
+  reversed[count++] = {fieldGoalX, fieldGoalY};
+  double anchorX = fieldGoalX, anchorY = fieldGoalY;
+  for(int k = 1; k < cellCount; k++){
+    int cell = planPathCells[k], prev = planPathCells[k - 1];
+    double cx = (cell%PLANNER_GRID + 0.5)*PLANNER_CELL, cy = (cell/PLANNER_GRID + 0.5)*PLANNER_CELL;
+    if(k == cellCount - 1){
+      cx = fieldStartX;
+      cy = fieldStartY;
+    }
+    if(!lineOfSight(anchorX, anchorY, cx, cy)){
+      if(count >= maxPoints || count >= MAX_PURSUIT_POINTS) return -1;
+      anchorX = (prev%PLANNER_GRID + 0.5)*PLANNER_CELL;
+      anchorY = (prev/PLANNER_GRID + 0.5)*PLANNER_CELL;
+      reversed[count++] = {anchorX, anchorY};
+    }
+  }
+  for(int i = 0; i < count; i++) points[i] = {reversed[count - 1 - i].x - PLANNER_ORIGIN_X, reversed[count - 1 - i].y - PLANNER_ORIGIN_Y};
+  return count;
+}
+/**
+ * Plan a path around the field obstacles.
+ * @param startX, startY
+ * start in odometry coordinates (inches); may be in a blocked cell (e.g. against a goal)
+ *
+ * @param goalX, goalY
+ * goal in odometry coordinates (inches); must be in a free cell
+ *
+ * @param points
+ * set to the waypoints for basePursuit (the start is not included, the goal is the last one)
+ *
+ * @param maxPoints
+ * size of points
+ *
+ * @return
+ * number of waypoints, or -1 if there is no path (or it needs more than maxPoints waypoints)
+ */
+int planPath(double startX, double startY, double goalX, double goalY, PursuitPoint *points, int maxPoints){
+  double fieldStartX = startX + PLANNER_ORIGIN_X, fieldStartY = startY + PLANNER_ORIGIN_Y;
+  double fieldGoalX = goalX + PLANNER_ORIGIN_X, fieldGoalY = goalY + PLANNER_ORIGIN_Y;
+  int sx = (int)floor(fieldStartX/PLANNER_CELL), sy = (int)floor(fieldStartY/PLANNER_CELL);
+  int gx = (int)floor(fieldGoalX/PLANNER_CELL), gy = (int)floor(fieldGoalY/PLANNER_CELL);
+  if(!isPlannerCellFree(gx, gy) || sx < 0 || sy < 0 || sx >= PLANNER_GRID || sy >= PLANNER_GRID || maxPoints < 1) return -1;
+  for(int i = 0; i < PLANNER_CELLS; i++){
+    planCost[i] = INFINITY;
+    planHeapIndex[i] = -1;
+  }
+  memset(planClosed, 0, sizeof(planClosed));
+  int start = sy*PLANNER_GRID + sx, goal = gy*PLANNER_GRID + gx;
+  planCost[start] = 0;
+  planEstimate[start] = octile(sx, sy, gx, gy);
+  planParent[start] = start;
+  planHeap[0] = start;
+  planHeapIndex[start] = 0;
+  planHeapSize = 1;
+  bool found = false;
+  while(planHeapSize > 0){
+    int cell = planHeapPop();
+    if(cell == goal){
+      found = true;
+      break;
+    }
+    int x = cell%PLANNER_GRID, y = cell/PLANNER_GRID;
+    planClosed[y] |= 1ull << x;
+    for(int dy = -1; dy <= 1; dy++){
+      for(int dx = -1; dx <= 1; dx++){
+        int nx = x + dx, ny = y + dy;
+        if((dx == 0 && dy == 0) || !isPlannerCellFree(nx, ny) || ((planClosed[ny] >> nx) & 1)) continue;
+        /** no corner cutting: a diagonal move needs both cells beside it free */
+        if(dx != 0 && dy != 0 && (!isPlannerCellFree(x + dx, y) || !isPlannerCellFree(x, y + dy))) continue;
+        int next = ny*PLANNER_GRID + nx;
+        float cost = planCost[cell] + (dx != 0 && dy != 0? PLANNER_DIAGONAL : 1.0f);
+        if(cost >= planCost[next]) continue;
+        planCost[next] = cost;
+        planEstimate[next] = cost + octile(nx, ny, gx, gy);
+        planParent[next] = cell;
+        if(planHeapIndex[next] < 0){
+          planHeap[planHeapSize] = next;
+          planHeapUp(planHeapSize++);
+        }
+        else planHeapUp(planHeapIndex[next]);
+      }
+    }
+  }
+  if(!found) return -1;
+  /** walk back from the goal */
+  int cellCount = 0;
+  planPathCells[cellCount++] = goal;
+  for(int cell = planParent[goal]; ; cell = planParent[cell]){
+    planPathCells[cellCount++] = cell;
+    if(cell == start) break;
+  }
+  return smoothPlanCells(cellCount, fieldStartX, fieldStartY, fieldGoalX, fieldGoalY, points, maxPoints);
+}
+/**
+ * D* Lite state, kept between plans so a change of the grid only repairs the part of the search it
+ * affects. The search runs from the goal towards the robot, so a moving robot keeps the search valid.
+ * replanG: cost to the goal as last expanded; replanRhs: one-step lookahead of it (equal when consistent)
+ * replanHeap: inconsistent cells ordered by replanKey (lexicographic pair); replanHeapIndex: position (-1: none)
+ * replanKm: heuristic offset accumulated as the robot moves
+ */
+float replanG[PLANNER_CELLS], replanRhs[PLANNER_CELLS], replanKey[PLANNER_CELLS][2];
+uint16_t replanHeap[PLANNER_CELLS];
+int16_t replanHeapIndex[PLANNER_CELLS];
+int replanHeapSize = 0, replanStart = -1, replanGoal = -1;
+float replanKm = 0;
+double replanGoalX = 0, replanGoalY = 0;
+/** cells expanded by the last search (initial or repair) */
+int replanExpanded = 0;
+/** heap helpers: order by the key pair, move a cell up or down, insert and remove */
+bool replanKeyLess(const float *a, const float *b){
+  return a[0] < b[0] || (a[0] == b[0] && a[1] < b[1]);
+}
+void replanHeapSet(int i, uint16_t cell){
+  replanHeap[i] = cell;
+  replanHeapIndex[cell] = i;
+}
+void replanHeapUp(int i){
+  uint16_t cell = replanHeap[i];
+  while(i > 0){
+    int parent = (i - 1)/2;
+    if(!replanKeyLess(replanKey[cell], replanKey[replanHeap[parent]])) break;
+    replanHeapSet(i, replanHeap[parent]);
+    i = parent;
+  }
+  replanHeapSet(i, cell);
+}
+void replanHeapDown(int i){
+  uint16_t cell = replanHeap[i];
+  while(true){
+    int child = 2*i + 1;
+    if(child >= replanHeapSize) break;
+    if(child + 1 < replanHeapSize && replanKeyLess(replanKey[replanHeap[child + 1]], replanKey[replanHeap[child]])) child++;
+    if(!replanKeyLess(replanKey[replanHeap[child]], replanKey[cell])) break;
+    replanHeapSet(i, replanHeap[child]);
+    i = child;
+  }
+  replanHeapSet(i, cell);
+}
+void replanHeapRemove(int cell){
+  int i = replanHeapIndex[cell];
+  replanHeapIndex[cell] = -1;
+  if(--replanHeapSize == i) return;
+  uint16_t moved = replanHeap[replanHeapSize];
+  replanHeapSet(i, moved);
+  replanHeapUp(i);
+  replanHeapDown(replanHeapIndex[moved]);
+}
+/**
+ * Cost of the move between two neighbouring cells, as in planPath. Only the robot's cell may be
+ * blocked at the start of a move (e.g. the robot against a goal).
+ * @return
+ * 1 or PLANNER_DIAGONAL, INFINITY if the move is blocked
+ */
+float replanMoveCost(int from, int to){
+  int x = from%PLANNER_GRID, y = from/PLANNER_GRID, nx = to%PLANNER_GRID, ny = to/PLANNER_GRID;
+  int dx = nx - x, dy = ny - y;
+  if(!isPlannerCellFree(nx, ny) || (from != replanStart && !isPlannerCellFree(x, y))) return INFINITY;
+  if(dx != 0 && dy != 0){
+    if(!isPlannerCellFree(x + dx, y) || !isPlannerCellFree(x, y + dy)) return INFINITY;
+    return PLANNER_DIAGONAL;
+  }
+  return 1.0f;
+}
+/**
+ * Neighbours of a cell on the grid.
+ * @param neighbours
+ * set to the neighbouring cells
+ *
+ * @return
+ * their number (3 to 8)
+ */
+int replanNeighbours(int cell, int *neighbours){
+  int x = cell%PLANNER_GRID, y = cell/PLANNER_GRID, count = 0;
+  for(int dy = -1; dy <= 1; dy++){
+    for(int dx = -1; dx <= 1; dx++){
+      int nx = x + dx, ny = y + dy;
+      if((dx == 0 && dy == 0) || nx < 0 || ny < 0 || nx >= PLANNER_GRID || ny >= PLANNER_GRID) continue;
+      neighbours[count++] = ny*PLANNER_GRID + nx;
+    }
+  }
+  return count;
+}
+/** key of a cell: estimated cost of the path through it from the robot, then its cost to the goal */
+void replanCalculateKey(int cell, float *key){
+  float best = fmin(replanG[cell], replanRhs[cell]);
+  key[0] = best + octile(cell%PLANNER_GRID, cell/PLANNER_GRID, replanStart%PLANNER_GRID, replanStart/PLANNER_GRID) + replanKm;
+  key[1] = best;
+}
+/** queue a cell with its current key if it is inconsistent, take it out of the queue otherwise */
+void replanQueueCell(int cell){
+  if(replanHeapIndex[cell] >= 0) replanHeapRemove(cell);
+  if(replanG[cell] != replanRhs[cell]){
+    replanCalculateKey(cell, replanKey[cell]);
+    replanHeapSet(replanHeapSize, cell);
+    replanHeapUp(replanHeapSize++);
+  }
+}
+/**
+ * Recompute the lookahead of a cell from its neighbours (the goal's stays 0) and queue it if it is inconsistent.
+ */
+void replanUpdateCell(int cell){
+  if(cell != replanGoal){
+    float rhs = INFINITY;
+    int neighbours[8], count = replanNeighbours(cell, neighbours);
+    for(int i = 0; i < count; i++) rhs = fmin(rhs, replanMoveCost(cell, neighbours[i]) + replanG[neighbours[i]]);
+    replanRhs[cell] = rhs;
+  }
+  replanQueueCell(cell);
+}
+/**
+ * Expand the inconsistent cells until the robot's cell is consistent and no queued cell can improve it.
+ * Cells whose key ties with the robot's (within PLANNER_KEY_TIE, float costs) are expanded too: a tied
+ * cell may still hold a stale cost, which would mislead the descent that reads the path.
+ */
+void replanComputePath(){
+  replanExpanded = 0;
+  float startKey[2];
+  replanCalculateKey(replanStart, startKey);
+  while(replanHeapSize > 0 && (replanKey[replanHeap[0]][0] < startKey[0] + PLANNER_KEY_TIE || replanRhs[replanStart] != replanG[replanStart])){
+    int cell = replanHeap[0];
+    float key[2];
+    replanCalculateKey(cell, key);
+    replanExpanded++;
+    if(replanKeyLess(replanKey[cell], key)){
+      /** the robot has moved since the cell was queued: requeue it with its current key */
+      replanKey[cell][0] = key[0];
+      replanKey[cell][1] = key[1];
+      replanHeapDown(0);
+    }
+    else{
+      int neighbours[8], count = replanNeighbours(cell, neighbours);
+      if(replanG[cell] > replanRhs[cell]){
+        /** cheaper: the neighbours can only improve through the cell */
+        replanG[cell] = replanRhs[cell];
+        replanHeapRemove(cell);
+        for(int i = 0; i < count; i++){
+          int next = neighbours[i];
+          if(next != replanGoal) replanRhs[next] = fmin(replanRhs[next], replanMoveCost(next, cell) + replanG[cell]);
+          replanQueueCell(next);
+        }
+      }
+      else{
+        /** dearer: only the neighbours whose lookahead came through the cell need recomputing */
+        float old = replanG[cell];
+        replanG[cell] = INFINITY;
+        replanUpdateCell(cell);
+        for(int i = 0; i < count; i++){
+          int next = neighbours[i];
+          if(replanRhs[next] == replanMoveCost(next, cell) + old) replanUpdateCell(next);
+        }
+      }
+    }
+    replanCalculateKey(replanStart, startKey);
+  }
+}
+/**
+ * Start an incremental plan to a goal: a full D* Lite search from the goal to the start, whose state
+ * is kept for replanPath.
+ * @param startX, startY
+ * start in odometry coordinates (inches); may be in a blocked cell
+ *
+ * @param goalX, goalY
+ * goal in odometry coordinates (inches); must be in a free cell
+ *
+ * @param points, maxPoints
+ * as for planPath
+ *
+ * @return
+ * number of waypoints, or -1 if there is no path
+ */
+int startReplanning(double startX, double startY, double goalX, double goalY, PursuitPoint *points, int maxPoints){
+  int gx = (int)floor((goalX + PLANNER_ORIGIN_X)/PLANNER_CELL), gy = (int)floor((goalY + PLANNER_ORIGIN_Y)/PLANNER_CELL);
+  int sx = (int)floor((startX + PLANNER_ORIGIN_X)/PLANNER_CELL), sy = (int)floor((startY + PLANNER_ORIGIN_Y)/PLANNER_CELL);
+  replanGoal = -1;
+  if(!isPlannerCellFree(gx, gy) || sx < 0 || sy < 0 || sx >= PLANNER_GRID || sy >= PLANNER_GRID) return -1;
+  for(int i = 0; i < PLANNER_CELLS; i++){
+    replanG[i] = replanRhs[i] = INFINITY;
+    replanHeapIndex[i] = -1;
+  }
+  replanHeapSize = 0;
+  replanKm = 0;
+  replanGoal = gy*PLANNER_GRID + gx;
+  replanGoalX = goalX;
+  replanGoalY = goalY;
+  replanStart = sy*PLANNER_GRID + sx;
+  replanRhs[replanGoal] = 0;
+  replanUpdateCell(replanGoal);
+  plannerChangeCount = 0;
+  plannerChangesLost = false;
+  return replanPath(startX, startY, points, maxPoints);
+}
+/**
+ * Plan again to the goal of startReplanning from a new start: the search is repaired where the grid
+ * changed since the last plan (setPlannerObstacle, clearPlannerObstacles) and around the robot's move,
+ * reusing the rest of it, so a few cells are expanded instead of a whole A* search.
+ * @param startX, startY
+ * start in odometry coordinates (inches)
+ *
+ * @param points, maxPoints
+ * as for planPath
+ *
+ * @return
+ * number of waypoints, or -1 if there is no path (or startReplanning was not called)
+ */
+int replanPath(double startX, double startY, PursuitPoint *points, int maxPoints){
+  if(replanGoal < 0 || maxPoints < 1) return -1;
+  double fieldStartX = startX + PLANNER_ORIGIN_X, fieldStartY = startY + PLANNER_ORIGIN_Y;
+  int sx = (int)floor(fieldStartX/PLANNER_CELL), sy = (int)floor(fieldStartY/PLANNER_CELL);
+  if(sx < 0 || sy < 0 || sx >= PLANNER_GRID || sy >= PLANNER_GRID) return -1;
+  if(plannerChangesLost){
+    /** too many changes to track: search from scratch */
+    plannerChangesLost = false;
+    return startReplanning(startX, startY, replanGoalX, replanGoalY, points, maxPoints);
+  }
+  int start = sy*PLANNER_GRID + sx, previous = replanStart;
+  if(start != previous){
+    replanKm += octile(previous%PLANNER_GRID, previous/PLANNER_GRID, sx, sy);
+    replanStart = start;
+    /** the old and new start cells may be blocked: only the robot's cell may be */
+    replanUpdateCell(previous);
+    replanUpdateCell(start);
+  }
+  /** a changed cell changes the moves into it and the diagonals past it: update it and its neighbours */
+  for(int i = 0; i < plannerChangeCount; i++){
+    int neighbours[8], count = replanNeighbours(plannerChanges[i], neighbours);
+    replanUpdateCell(plannerChanges[i]);
+    for(int j = 0; j < count; j++) replanUpdateCell(neighbours[j]);
+  }
+  plannerChangeCount = 0;
+  replanComputePath();
+  if(std::isinf(replanG[start])) return -1;
+  /** descend the cost to the goal from the start, then reverse into planPathCells' order */
+  int cellCount = 0;
+  planPathCells[cellCount++] = start;
+  for(int cell = start; cell != replanGoal; ){
+    int neighbours[8], count = replanNeighbours(cell, neighbours), next = -1;
+    float best = INFINITY;
+    for(int i = 0; i < count; i++){
+      float cost = replanMoveCost(cell, neighbours[i]) + replanG[neighbours[i]];
+      if(cost < best){
+        best = cost;
+        next = neighbours[i];
+      }
+    }
+    if(next < 0 || cellCount >= PLANNER_CELLS) return -1;
+    planPathCells[cellCount++] = next;
+    cell = next;
+  }
+  if(cellCount == 1) planPathCells[cellCount++] = start;
+  for(int i = 0; i < cellCount/2; i++){
+    uint16_t cell = planPathCells[i];
+    planPathCells[i] = planPathCells[cellCount - 1 - i];
+    planPathCells[cellCount - 1 - i] = cell;
+  }
+  return smoothPlanCells(cellCount, fieldStartX, fieldStartY, replanGoalX + PLANNER_ORIGIN_X, replanGoalY + PLANNER_ORIGIN_Y, points, maxPoints);
+}
+/**
+ * @return
+ * cells expanded by the last incremental search (startReplanning or replanPath)
+ */
+int getReplanExpansions(){
+  return replanExpanded;
+}
+/**
+ * Plan from the live pose to a point and follow the path with pure pursuit.
+ * @param x, y
+ * goal in odometry coordinates (inches)
+ *
+ * @param reverse (optional. default = false)
+ * true: backward movement
+ *
+ * @return
+ * false if there is no path (the base does not move)
+ */
+bool basePlannedPursuit(double x, double y, bool reverse){
+  PoseSnapshot pose = getPose();
+  PursuitPoint points[MAX_PURSUIT_POINTS - 1];
+  int count = planPath(pose.x, pose.y, x, y, points, MAX_PURSUIT_POINTS - 1);
+  if(count < 1) return false;
+  basePursuit(points, count, reverse);
+  return true;
+}
+/**
+ * Plan from the live pose to a point with the incremental planner (refer to startReplanning) and follow
+ * the path with pure pursuit; call repairPlannedPursuit when obstacles are added on the way.
+ * @param x, y
+ * goal in odometry coordinates (inches)
+ *
+ * @param reverse (optional. default = false)
+ * true: backward movement
+ *
+ * @return
+ * false if there is no path (the base does not move)
+ */
+bool baseReplannedPursuit(double x, double y, bool reverse){
+  PoseSnapshot pose = getPose();
+  PursuitPoint points[MAX_PURSUIT_POINTS - 1];
+  int count = startReplanning(pose.x, pose.y, x, y, points, MAX_PURSUIT_POINTS - 1);
+  if(count < 1) return false;
+  basePursuit(points, count, reverse);
+  return true;
+}
+/**
+ * Repair the path of baseReplannedPursuit after the grid changed (setPlannerObstacle, clearPlannerObstacles)
+ * and hand it to the follower without stopping (refer to replacePursuitPath).
+ * Nothing is done if no cell changed since the last plan.
+ * @return
+ * false if the path was not replaced: no change, no path being followed, or no path around the obstacles
+ * (the robot keeps following the old path; stop it if it is blocked)
+ */
+bool repairPlannedPursuit(){
+  if(plannerChangeCount == 0 && !plannerChangesLost) return false;
+  if(!isPursuitActive()) return false;
+  PoseSnapshot pose = getPose();
+  PursuitPoint points[MAX_PURSUIT_POINTS - 1];
+  int count = replanPath(pose.x, pose.y, points, MAX_PURSUIT_POINTS - 1);
+  return count >= 1 && replacePursuitPath(points, count);
+}
+/**
+ * Go on after a collision aborted a pursuit of baseReplannedPursuit (refer to BASE_IMPACT_DETECTION): the robot
+ * hit is marked on the grid ahead of the bumper the base drove with (PLANNER_IMPACT_RADIUS, PLANNER_IMPACT_GAP
+ * cells out) and the incremental planner's path to the same goal is followed from the live pose.
+ * @return
+ * false if the last impact is not a collision, nothing was planned with startReplanning, or there is no path
+ */
+bool replanAroundImpact(){
+  BaseImpact impact = getBaseImpact();
+  if(impact.type != IMPACT_COLLISION || replanGoal < 0) return false;
+  double reach = PLANNER_IMPACT_RADIUS + PLANNER_CLEARANCE + PLANNER_IMPACT_GAP*PLANNER_CELL;
+  if(impact.reverse) reach = -reach;
+  setPlannerObstacle(impact.x + reach*sin(impact.angle), impact.y + reach*cos(impact.angle), PLANNER_IMPACT_RADIUS);
+  PoseSnapshot pose = getPose();
+  PursuitPoint points[MAX_PURSUIT_POINTS - 1];
+  int count = replanPath(pose.x, pose.y, points, MAX_PURSUIT_POINTS - 1);
+  if(count < 1) return false;
+  basePursuit(points, count, impact.reverse);
+  return true;
+}
@@ -0,0 +1,136 @@
+/**
+ * Pose checkpoint functions (refer to poseCheckpoint.hpp):
+ * - Resume: the newest valid checkpoint back into the odometry, the selector and the routine runner
+ * - Task poseCheckpoint: a checkpoint per CHECKPOINT_DT while the robot is enabled
+ */
+#include "main.h"
+/**
+ * State of a resume (set by resumeCheckpoint, taken by the routine runner)
+ * resumeStep: first step of the resumed routine (0: none to resume; -1: the routine cannot be resumed)
+ * resumeMatchTime: match time of the checkpoint in ms (0: none)
+ * checkpointSequence: number of the newest checkpoint (the task numbers its checkpoints on from it)
+ */
+std::atomic<int> resumeStep(0);
+std::atomic<uint32_t> resumeMatchTime(0);
+uint32_t checkpointSequence = 0;
+/**
+ * @param checkpoint
+ * a checkpoint
+ *
+ * @return
+ * crc16 of its fields before the crc
+ */
+uint16_t checkpointCrc(const PoseCheckpoint &checkpoint){
+  return crc16((const uint8_t*)&checkpoint, offsetof(PoseCheckpoint, crc));
+}
+/**
+ * Read a checkpoint file.
+ * @param slot
+ * slot of the file (0 or 1)
+ *
+ * @param checkpoint
+ * set to its checkpoint
+ *
+ * @return
+ * false if there is no file, or it is of another version or corrupt
+ */
+bool readCheckpoint(int slot, PoseCheckpoint &checkpoint){
+  char path[64];
+  snprintf(path, sizeof(path), CHECKPOINT_PATH, slot);
+  FILE *file = fopen(path, "rb");
+  if(file == NULL) return false;
+  bool valid = fread(&checkpoint, sizeof(checkpoint), 1, file) == 1;
+  fclose(file);
+  return valid && checkpoint.magic == CHECKPOINT_FILE_MAGIC && checkpoint.version == CHECKPOINT_FILE_VERSION
+    && checkpoint.crc == checkpointCrc(checkpoint);
+}
+/**
+ * Carry on from the newest checkpoint after a restart during a match (call from initialize(), after the tasks are
+ * started, and only when the robot is enabled on a field): the odometry is set to its pose, its routine is selected
+ * and, if it was saved in autonomous, the next autonomous() resumes the routine at its step and match time.
+ * @return
+ * false if there is no card or no valid checkpoint (nothing is changed)
+ */
+bool resumeCheckpoint(){
+  if(!usd::is_installed()) return false;
+  PoseCheckpoint slots[2], *newest = NULL;
+  for(int slot = 0; slot < 2; slot++){
+    if(readCheckpoint(slot, slots[slot]) && (newest == NULL || slots[slot].sequence > newest->sequence)) newest = &slots[slot];
+  }
+  if(newest == NULL) return false;
+  checkpointSequence = newest->sequence;
+  setCoords(newest->x, newest->y, newest->angle*toDeg);
+  setSelectedAuton(newest->routine);
+  if(newest->phase == PHASE_AUTON){
+    resumeStep = newest->step;
+    resumeMatchTime = newest->matchTime;
+  }
+  return true;
+}
+/**
+ * @return
+ * first step of the routine to resume (0: none to resume; -1: a routine that cannot be resumed)
+ */
+int getResumeStep(){
+  return resumeStep;
+}
+/**
+ * Take the step to resume (a resume happens once; called by the runner of a static routine or a script).
+ * @return
+ * first step of the routine to run (0 if none is resumed)
+ */
+int takeResumeStep(){
+  return std::max(resumeStep.exchange(0), 0);
+}
+/**
+ * Take the match time to resume (once; called by runSelectedAuton to start the match clock).
+ * @return
+ * ms of the autonomous period already run (0 if none is resumed)
+ */
+uint32_t takeResumeMatchTime(){
+  return resumeMatchTime.exchange(0);
+}
+/**
+ * Save a checkpoint of the latest pose, the routine and its step into the next slot (one open, write and close,
+ * so the file is complete as soon as it returns).
+ */
+void writeCheckpoint(){
+  PoseSnapshot pose = getPose();
+  PoseCheckpoint checkpoint;
+  memset(&checkpoint, 0, sizeof(checkpoint));
+  checkpoint.magic = CHECKPOINT_FILE_MAGIC;
+  checkpoint.version = CHECKPOINT_FILE_VERSION;
+  checkpoint.sequence = ++checkpointSequence;
+  checkpoint.phase = getPhase();
+  checkpoint.routine = getSelectedAuton();
+  checkpoint.step = getRoutineResumeStep();
+  checkpoint.matchTime = getMatchTime();
+  checkpoint.x = pose.x;
+  checkpoint.y = pose.y;
+  checkpoint.angle = pose.angle;
+  checkpoint.crc = checkpointCrc(checkpoint);
+  char path[64];
+  snprintf(path, sizeof(path), CHECKPOINT_PATH, (int)(checkpoint.sequence & 1));
+  FILE *file = fopen(path, "wb");
+  if(file == NULL) return;
+  fwrite(&checkpoint, sizeof(checkpoint), 1, file);
+  fclose(file);
+}
+/**
+ * Save a checkpoint every CHECKPOINT_DT, the first one as soon as the robot is enabled (so a checkpoint of an
+ * earlier match is never resumed). Runs in autonomous and driver control (refer to taskRegistry.hpp).
+ */
+void poseCheckpoint(void * ignore){
+  LoopRate rate(CHECKPOINT_DT);
+  startTaskTiming(TIMING_CHECKPOINT, CHECKPOINT_DT, true);
+  while(true){
+    if(waitTaskActive(ROBOT_CHECKPOINT)){
+      rate.restart();
+      startTaskTiming(TIMING_CHECKPOINT, CHECKPOINT_DT, true);
+    }
+    beginTaskIteration(TIMING_CHECKPOINT);
+    if(usd::is_installed()) writeCheckpoint();
+    endTaskIteration(TIMING_CHECKPOINT);
+    rate.wait();
+  }
+}
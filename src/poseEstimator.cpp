@@ -0,0 +1,261 @@
+/**
+ * Pose estimator functions (extended Kalman filter, refer to poseEstimator.hpp):
+ * - Reset to a pose
+ * - Prediction with the constant velocity model
+ * - Measurement updates: tracking wheel velocities, IMU bearing, vision landmark, wall range
+ * - Uncertainty of the pose: its growth under dead reckoning, the variances kept across a reset, its summary
+ */
+#include "main.h"
+/**
+ * Set the estimate to a pose at rest.
+ * @param estimate
+ * the filter
+ *
+ * @param x, y, angle
+ * the pose (inches, radians)
+ */
+void resetEstimate(PoseEstimate &estimate, double x, double y, double angle){
+  estimate.state = {};
+  estimate.state(ESTIMATE_X, 0) = x;
+  estimate.state(ESTIMATE_Y, 0) = y;
+  estimate.state(ESTIMATE_ANGLE, 0) = angle;
+  estimate.covariance = {};
+  estimate.covariance(ESTIMATE_X, ESTIMATE_X) = ESTIMATOR_INITIAL_POSITION*ESTIMATOR_INITIAL_POSITION;
+  estimate.covariance(ESTIMATE_Y, ESTIMATE_Y) = ESTIMATOR_INITIAL_POSITION*ESTIMATOR_INITIAL_POSITION;
+  estimate.covariance(ESTIMATE_ANGLE, ESTIMATE_ANGLE) = ESTIMATOR_INITIAL_ANGLE*toRad*ESTIMATOR_INITIAL_ANGLE*toRad;
+  estimate.initialized = true;
+}
+/**
+ * Move the state and its covariance forward by dt with the constant velocity model
+ * (the robot drives along an arc at the estimated velocities).
+ * @param estimate
+ * the filter
+ *
+ * @param dt
+ * time step in seconds
+ */
+void predictEstimate(PoseEstimate &estimate, double dt){
+  Matrix<ESTIMATE_SIZE, 1> &state = estimate.state;
+  double linVel = state(ESTIMATE_VEL, 0), angVel = state(ESTIMATE_ANG_VEL, 0);
+  /** the displacement of the step, along the mean bearing */
+  double mean = state(ESTIMATE_ANGLE, 0) + angVel*dt/2;
+  double sinMean = sin(mean), cosMean = cos(mean);
+  state(ESTIMATE_X, 0) += linVel*dt*sinMean;
+  state(ESTIMATE_Y, 0) += linVel*dt*cosMean;
+  state(ESTIMATE_ANGLE, 0) += angVel*dt;
+  /** Jacobian of the model */
+  Matrix<ESTIMATE_SIZE, ESTIMATE_SIZE> jacobian = identityMatrix<ESTIMATE_SIZE>();
+  jacobian(ESTIMATE_X, ESTIMATE_ANGLE) = linVel*dt*cosMean;
+  jacobian(ESTIMATE_X, ESTIMATE_VEL) = dt*sinMean;
+  jacobian(ESTIMATE_X, ESTIMATE_ANG_VEL) = linVel*dt*cosMean*dt/2;
+  jacobian(ESTIMATE_Y, ESTIMATE_ANGLE) = -linVel*dt*sinMean;
+  jacobian(ESTIMATE_Y, ESTIMATE_VEL) = dt*cosMean;
+  jacobian(ESTIMATE_Y, ESTIMATE_ANG_VEL) = -linVel*dt*sinMean*dt/2;
+  jacobian(ESTIMATE_ANGLE, ESTIMATE_ANG_VEL) = dt;
+  /** process noise: the accelerations, and the drift of the pose with the distance travelled and turned */
+  Matrix<ESTIMATE_SIZE, ESTIMATE_SIZE> noise = {};
+  double travel = fabs(linVel)*dt, turn = fabs(angVel)*dt;
+  noise(ESTIMATE_X, ESTIMATE_X) = ESTIMATOR_SLIP_NOISE*ESTIMATOR_SLIP_NOISE*travel;
+  noise(ESTIMATE_Y, ESTIMATE_Y) = ESTIMATOR_SLIP_NOISE*ESTIMATOR_SLIP_NOISE*travel;
+  noise(ESTIMATE_ANGLE, ESTIMATE_ANGLE) = ESTIMATOR_SCRUB_NOISE*ESTIMATOR_SCRUB_NOISE*turn;
+  noise(ESTIMATE_VEL, ESTIMATE_VEL) = ESTIMATOR_ACC_NOISE*dt*ESTIMATOR_ACC_NOISE*dt;
+  noise(ESTIMATE_ANG_VEL, ESTIMATE_ANG_VEL) = ESTIMATOR_ANG_ACC_NOISE*dt*ESTIMATOR_ANG_ACC_NOISE*dt;
+  estimate.covariance = jacobian*estimate.covariance*transpose(jacobian) + noise;
+}
+/**
+ * Kalman update with M measurements.
+ * @param estimate
+ * the filter
+ *
+ * @param innovation
+ * measurements minus their predictions
+ *
+ * @param jacobian
+ * derivatives of the predicted measurements by the state
+ *
+ * @param noise
+ * covariance of the measurements
+ *
+ * @param gated
+ * reject the measurements if their Mahalanobis distance is above ESTIMATOR_GATE
+ *
+ * @return
+ * false if the measurements were rejected
+ */
+template<int M> bool updateEstimate(PoseEstimate &estimate, const Matrix<M, 1> &innovation,
+                                    const Matrix<M, ESTIMATE_SIZE> &jacobian, const Matrix<M, M> &noise, bool gated){
+  Matrix<ESTIMATE_SIZE, M> crossCovariance = estimate.covariance*transpose(jacobian);
+  Matrix<M, M> innovationCovariance = jacobian*crossCovariance + noise, inverse;
+  if(!invertMatrix(innovationCovariance, inverse)) return false;
+  if(gated && (transpose(innovation)*inverse*innovation)(0, 0) > ESTIMATOR_GATE) return false;
+  Matrix<ESTIMATE_SIZE, M> gain = crossCovariance*inverse;
+  estimate.state = estimate.state + gain*innovation;
+  /** Joseph form: the covariance stays symmetric and positive despite rounding */
+  Matrix<ESTIMATE_SIZE, ESTIMATE_SIZE> factor = identityMatrix<ESTIMATE_SIZE>() - gain*jacobian;
+  estimate.covariance = factor*estimate.covariance*transpose(factor) + gain*noise*transpose(gain);
+  return true;
+}
+/**
+ * Update with the velocities measured by the tracking wheels over the last tick (never gated:
+ * the wheels are the primary sensor, and a rejected tick would leave the velocities behind).
+ * @param estimate
+ * the filter
+ *
+ * @param linVel, angVel
+ * forward velocity (in/s) and angular velocity (rad/s, clockwise)
+ *
+ * @return
+ * true
+ */
+bool updateVelocityEstimate(PoseEstimate &estimate, double linVel, double angVel){
+  Matrix<2, 1> innovation = {};
+  innovation(0, 0) = linVel - estimate.state(ESTIMATE_VEL, 0);
+  innovation(1, 0) = angVel - estimate.state(ESTIMATE_ANG_VEL, 0);
+  Matrix<2, ESTIMATE_SIZE> jacobian = {};
+  jacobian(0, ESTIMATE_VEL) = 1;
+  jacobian(1, ESTIMATE_ANG_VEL) = 1;
+  Matrix<2, 2> noise = {};
+  noise(0, 0) = ESTIMATOR_VEL_NOISE*ESTIMATOR_VEL_NOISE;
+  noise(1, 1) = ESTIMATOR_ANG_VEL_NOISE*ESTIMATOR_ANG_VEL_NOISE;
+  return updateEstimate(estimate, innovation, jacobian, noise, false);
+}
+/**
+ * Update with a bearing measured by the IMU.
+ * @param estimate
+ * the filter
+ *
+ * @param angle
+ * the bearing (radians, on the same turn as the estimate: the IMU rotation is continuous)
+ *
+ * @return
+ * false if the measurement was rejected
+ */
+bool updateHeadingEstimate(PoseEstimate &estimate, double angle){
+  Matrix<1, 1> innovation = {{{angle - estimate.state(ESTIMATE_ANGLE, 0)}}};
+  Matrix<1, ESTIMATE_SIZE> jacobian = {};
+  jacobian(0, ESTIMATE_ANGLE) = 1;
+  Matrix<1, 1> noise = {{{ESTIMATOR_IMU_NOISE*toRad*ESTIMATOR_IMU_NOISE*toRad}}};
+  return updateEstimate(estimate, innovation, jacobian, noise, true);
+}
+/**
+ * Update with the bearing and distance of a landmark seen by the vision sensor. The measurement was
+ * taken at a past pose (the capture), so it is predicted from that pose and the correction is applied
+ * to the current state.
+ * @param estimate
+ * the filter
+ *
+ * @param x, y, angle
+ * pose at the capture (from the pose history)
+ *
+ * @param landmarkX, landmarkY
+ * the landmark (odometry coordinates)
+ *
+ * @param bearing, distance
+ * measured bearing (radians, clockwise from the heading) and distance (inches)
+ *
+ * @return
+ * false if the measurement was rejected
+ */
+bool updateLandmarkEstimate(PoseEstimate &estimate, double x, double y, double angle,
+                            double landmarkX, double landmarkY, double bearing, double distance){
+  double dx = landmarkX - x, dy = landmarkY - y;
+  double squared = dx*dx + dy*dy, range = sqrt(squared);
+  if(range < 1) return false;
+  Matrix<2, 1> innovation = {};
+  innovation(0, 0) = angleDiff(bearing, atan2(dx, dy) - angle);
+  innovation(1, 0) = distance - range;
+  Matrix<2, ESTIMATE_SIZE> jacobian = {};
+  jacobian(0, ESTIMATE_X) = -dy/squared;
+  jacobian(0, ESTIMATE_Y) = dx/squared;
+  jacobian(0, ESTIMATE_ANGLE) = -1;
+  jacobian(1, ESTIMATE_X) = -dx/range;
+  jacobian(1, ESTIMATE_Y) = -dy/range;
+  Matrix<2, 2> noise = {};
+  noise(0, 0) = ESTIMATOR_BEARING_NOISE*toRad*ESTIMATOR_BEARING_NOISE*toRad;
+  noise(1, 1) = ESTIMATOR_DISTANCE_NOISE*distance*ESTIMATOR_DISTANCE_NOISE*distance;
+  return updateEstimate(estimate, innovation, jacobian, noise, true);
+}
+/**
+ * Update with a measured position along one axis (e.g. the distance to a wall across it).
+ * @param estimate
+ * the filter
+ *
+ * @param normalX, normalY
+ * unit vector of the axis
+ *
+ * @param innovation
+ * measured minus estimated position along the axis (inches)
+ *
+ * @param sigma
+ * standard deviation of the measurement (inches)
+ *
+ * @return
+ * false if the measurement was rejected
+ */
+bool updateAxisEstimate(PoseEstimate &estimate, double normalX, double normalY, double innovation, double sigma){
+  Matrix<1, 1> difference = {{{innovation}}};
+  Matrix<1, ESTIMATE_SIZE> jacobian = {};
+  jacobian(0, ESTIMATE_X) = normalX;
+  jacobian(0, ESTIMATE_Y) = normalY;
+  Matrix<1, 1> noise = {{{sigma*sigma}}};
+  return updateEstimate(estimate, difference, jacobian, noise, true);
+}
+/**
+ * Grow the covariance of the pose by one step of dead reckoning (without ODOM_ESTIMATOR, where the arc
+ * integration moves the pose and the estimate only carries its covariance): the step's Jacobian, and the
+ * drift with the distance travelled and turned of predictEstimate.
+ * @param estimate
+ * the filter (its state is not moved)
+ *
+ * @param angle
+ * bearing at the start of the step (radians)
+ *
+ * @param forward, lateral
+ * movement of the step, forward and to the right (inches)
+ *
+ * @param deltaAngle
+ * turn of the step (radians, clockwise)
+ */
+void growEstimateUncertainty(PoseEstimate &estimate, double angle, double forward, double lateral, double deltaAngle){
+  double mean = angle + deltaAngle/2;
+  double sinMean = sin(mean), cosMean = cos(mean);
+  Matrix<ESTIMATE_SIZE, ESTIMATE_SIZE> jacobian = identityMatrix<ESTIMATE_SIZE>();
+  jacobian(ESTIMATE_X, ESTIMATE_ANGLE) = forward*cosMean - lateral*sinMean;
+  jacobian(ESTIMATE_Y, ESTIMATE_ANGLE) = -forward*sinMean - lateral*cosMean;
+  Matrix<ESTIMATE_SIZE, ESTIMATE_SIZE> noise = {};
+  double travel = hypot(forward, lateral), turn = fabs(deltaAngle);
+  noise(ESTIMATE_X, ESTIMATE_X) = ESTIMATOR_SLIP_NOISE*ESTIMATOR_SLIP_NOISE*travel;
+  noise(ESTIMATE_Y, ESTIMATE_Y) = ESTIMATOR_SLIP_NOISE*ESTIMATOR_SLIP_NOISE*travel;
+  noise(ESTIMATE_ANGLE, ESTIMATE_ANGLE) = ESTIMATOR_SCRUB_NOISE*ESTIMATOR_SCRUB_NOISE*turn;
+  estimate.covariance = jacobian*estimate.covariance*transpose(jacobian) + noise;
+}
+/**
+ * Keep the variance of one coordinate across a reset that did not measure it (e.g. the coordinate along a
+ * squared wall, which comes from the odometry): the reset's variance is raised back to the prior one.
+ * Only the diagonal is restored (the reset cleared the covariances), so the covariance stays positive.
+ * @param estimate
+ * the filter, just reset
+ *
+ * @param prior
+ * its covariance before the reset
+ *
+ * @param index
+ * the coordinate (ESTIMATE_X, ESTIMATE_Y or ESTIMATE_ANGLE)
+ */
+void keepEstimateVariance(PoseEstimate &estimate, const Matrix<ESTIMATE_SIZE, ESTIMATE_SIZE> &prior, int index){
+  estimate.covariance(index, index) = fmax(estimate.covariance(index, index), prior(index, index));
+}
+/**
+ * @param estimate
+ * the filter
+ *
+ * @return
+ * standard deviations of its pose (refer to PoseUncertainty; the timestamp is left 0)
+ */
+PoseUncertainty getEstimateUncertainty(const PoseEstimate &estimate){
+  double varX = estimate.covariance(ESTIMATE_X, ESTIMATE_X), varY = estimate.covariance(ESTIMATE_Y, ESTIMATE_Y);
+  double cov = estimate.covariance(ESTIMATE_X, ESTIMATE_Y);
+  /** largest eigenvalue of the symmetric 2x2 block */
+  double largest = (varX + varY)/2 + hypot((varX - varY)/2, cov);
+  return {sqrt(fmax(largest, 0)), sqrt(fmax(estimate.covariance(ESTIMATE_ANGLE, ESTIMATE_ANGLE), 0)), 0};
+}
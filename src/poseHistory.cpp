@@ -0,0 +1,82 @@
+/**
+ * Pose history:
+ * - Recording of the odometry poses (odometry task only)
+ * - Interpolated pose queries at past timestamps (any task, never blocks the odometry task)
+ */
+#include "main.h"
+/**
+ * Ring buffer of poses. Each slot is a SeqLock, so a reader always gets a consistent pose;
+ * poseCount is the number of poses recorded so far (the newest is in slot poseCount-1).
+ */
+SeqLock<PoseSnapshot> poseHistory[POSE_HISTORY_SIZE];
+std::atomic<uint32_t> poseCount(0);
+/**
+ * Record a pose. Only called by the odometry task (single writer).
+ * @param pose
+ * the pose just published
+ */
+void recordPose(const PoseSnapshot &pose){
+  uint32_t count = poseCount.load(std::memory_order_relaxed);
+  poseHistory[count%POSE_HISTORY_SIZE].write(pose);
+  poseCount.store(count + 1, std::memory_order_release);
+}
+/**
+ * Interpolate between two poses.
+ * @param older
+ * pose before t
+ *
+ * @param newer
+ * pose after t
+ *
+ * @param t
+ * timestamp (micros) within older.timestamp <= t <= newer.timestamp
+ *
+ * @return
+ * linearly interpolated pose (the bearing is continuous, so it needs no wrapping)
+ */
+PoseSnapshot interpolatePose(const PoseSnapshot &older, const PoseSnapshot &newer, uint64_t t){
+  if(newer.timestamp <= older.timestamp) return newer;
+  double k = (double)(t - older.timestamp)/(newer.timestamp - older.timestamp);
+  PoseSnapshot pose;
+  pose.x = older.x + k*(newer.x - older.x);
+  pose.y = older.y + k*(newer.y - older.y);
+  pose.angle = older.angle + k*(newer.angle - older.angle);
+  pose.linVel = older.linVel + k*(newer.linVel - older.linVel);
+  pose.angVel = older.angVel + k*(newer.angVel - older.angVel);
+  pose.timestamp = t;
+  return pose;
+}
+/**
+ * Retrieve the pose at a past time, interpolated between the two recorded poses around it.
+ * Timestamps after the newest pose give the newest pose (no extrapolation).
+ * @param timestamp
+ * time of interest (micros, same clock as micros())
+ *
+ * @param pose
+ * set to the pose at that time
+ *
+ * @return
+ * false if the time is older than the history (or nothing is recorded yet)
+ */
+bool getPoseAt(uint64_t timestamp, PoseSnapshot &pose){
+  uint32_t count = poseCount.load(std::memory_order_acquire);
+  if(count == 0) return false;
+  PoseSnapshot newer = poseHistory[(count - 1)%POSE_HISTORY_SIZE].read();
+  if(timestamp >= newer.timestamp){
+    pose = newer;
+    return true;
+  }
+  /** walk back from the newest pose; the oldest slot may be overwritten meanwhile, so keep one spare */
+  uint32_t available = count < POSE_HISTORY_SIZE? count : POSE_HISTORY_SIZE - 1;
+  for(uint32_t i = 2; i <= available; i++){
+    PoseSnapshot older = poseHistory[(count - i)%POSE_HISTORY_SIZE].read();
+    /** a slot overwritten by a newer pose: the history has moved past the query */
+    if(older.timestamp > newer.timestamp) return false;
+    if(older.timestamp <= timestamp){
+      pose = interpolatePose(older, newer, timestamp);
+      return true;
+    }
+    newer = older;
+  }
+  return false;
+}
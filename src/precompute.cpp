@@ -0,0 +1,127 @@
+/**
+ * Background precomputation:
+ * - Queue of the jobs of the disabled phase (a bit per PrecomputeJob)
+ * - Task running the jobs a step at a time, parked outside PHASE_DISABLED (which cancels the job in progress)
+ * - The jobs: prepare the selected routine, read its trajectories through, recalibrate the IMU
+ */
+#include "main.h"
+/**
+ * Queue state
+ * precomputeQueue: bit per queued PrecomputeJob (a job is queued once however often it is asked for; the running
+ *   job's bit is cleared when it starts, so it runs again if it is queued meanwhile)
+ * precomputeBusy: a step is running (refer to waitPrecompute)
+ */
+std::atomic<uint32_t> precomputeQueue(0);
+std::atomic<bool> precomputeBusy(false);
+/** sink of the trajectory reads, so they are not optimized out */
+volatile float precomputeSink = 0;
+/** PRECOMPUTE_IMU: IMU rotation at the start of the still time, and the time it has stood still */
+double stillRotation = 0;
+Timer stillTimer;
+/**
+ * Queue a job for the next disabled phase (or the current one). Callable from any task.
+ * @param job
+ * the job
+ */
+void queuePrecompute(PrecomputeJob job){
+  precomputeQueue.fetch_or(1u << job, std::memory_order_release);
+}
+/**
+ * @param job
+ * a job
+ *
+ * @return
+ * whether it is queued and has not started (or was cancelled)
+ */
+bool isPrecomputeQueued(PrecomputeJob job){
+  return (precomputeQueue.load(std::memory_order_acquire) & (1u << job)) != 0;
+}
+/**
+ * Wait for the step in progress. Call once the disabled phase has ended (e.g. runSelectedAuton): the task parks
+ * after that step, so the data of the jobs can be used without a race. Returns at once if no step runs.
+ */
+void waitPrecompute(){
+  while(precomputeBusy) delay(BOOT_POLL_DT);
+}
+/**
+ * A step of each job (refer to PrecomputeJob)
+ * @param step
+ * steps of the job done so far (0: the job starts)
+ *
+ * @return
+ * whether the job is done
+ */
+bool prepareStep(int step){
+  if(!isBootReady(BOOT_TRAJECTORIES)) return false;
+  int id = getSelectedAuton();
+  if(id != getPreparedAuton()) prepareAuton(id);
+  queuePrecompute(PRECOMPUTE_WARM);
+  return true;
+}
+bool warmStep(int step){
+  const CachedTrajectory *trajectory = getTrajectory(step);
+  if(trajectory == NULL) return true;
+  /** only the first chunk of a streamed trajectory is in memory, and read at once */
+  if(trajectory->stream != NULL) return false;
+  float sum = 0;
+  for(int i = 0; i < trajectory->length; i++){
+    sum += trajectory->left[i].position + trajectory->right[i].position;
+    if(trajectory->poses != NULL) sum += trajectory->poses[i].x;
+  }
+  precomputeSink = sum;
+  return false;
+}
+bool imuStep(int step){
+#if ODOM_USE_IMU
+  double rotation = imu.get_rotation();
+  /** the still time starts over while the boot calibration runs or the robot is moved */
+  if(step == 0 || !isBootReady(BOOT_CALIBRATION) || imu.is_calibrating() || !std::isfinite(rotation)
+    || fabs(rotation - stillRotation) > PRECOMPUTE_IMU_DRIFT){
+    stillRotation = rotation;
+    stillTimer.reset();
+    return false;
+  }
+  if(!stillTimer.passed(PRECOMPUTE_IMU_STILL)) return false;
+  recalibrateImu();
+#endif
+  return true;
+}
+/** steps of the jobs, indexed by PrecomputeJob */
+bool (*const precomputeSteps[PRECOMPUTE_JOBS])(int step) = {prepareStep, warmStep, imuStep};
+/**
+ * Run the queued jobs in the disabled phase, a step every PRECOMPUTE_DT (the task is registered for PHASE_DISABLED
+ * only, refer to taskRegistry.cpp).
+ */
+void precompute(void * ignore){
+  /** job in progress (-1: none) and its steps done */
+  int job = -1, step = 0;
+  while(true){
+    if(waitTaskActive(ROBOT_PRECOMPUTE) && job >= 0){
+      /** the phase ended during the job: it starts over in the next disabled phase */
+      queuePrecompute((PrecomputeJob)job);
+      job = -1;
+    }
+    /** the first queued job, unless the job in progress comes before it */
+    uint32_t queued = precomputeQueue.load(std::memory_order_acquire);
+    int next = queued == 0? -1 : __builtin_ctz(queued);
+    if(next >= 0 && (job < 0 || next < job)){
+      if(job >= 0) queuePrecompute((PrecomputeJob)job);
+      job = next;
+      step = 0;
+      precomputeQueue.fetch_and(~(1u << job), std::memory_order_acq_rel);
+    }
+    if(job < 0){
+      delay(PRECOMPUTE_DT);
+      continue;
+    }
+    /** flag the step, then check the phase again: a phase change in between is seen here or by waitPrecompute */
+    precomputeBusy = true;
+    if(!isTaskActive(ROBOT_PRECOMPUTE)){
+      precomputeBusy = false;
+      continue;
+    }
+    if(precomputeSteps[job](step++)) job = -1;
+    precomputeBusy = false;
+    delay(PRECOMPUTE_DT);
+  }
+}
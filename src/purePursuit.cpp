@@ -0,0 +1,553 @@
+/**
+ * Pure-pursuit path follower:
+ * - Path setting (waypoints or a spline path)
+ * - Lookahead point search
+ * - Side (and strafe) velocity computation from the live pose
+ * - Path progress and path triggers
+ */
+#include "main.h"
+/** current path (copied, so the caller's array does not need to stay valid) */
+PursuitPoint pursuitPath[MAX_PURSUIT_POINTS];
+int pursuitCount = 0;
+double pursuitLookahead = PURSUIT_LOOKAHEAD, pursuitMaxVel = PURSUIT_MAX_VEL;
+bool pursuitReverse = false;
+/** bearing held by a holonomic base along the path: its heading when the path was set (radians) */
+double pursuitHeading = 0;
+/** index of the path segment the last lookahead point was found on */
+int pursuitSegment = 0;
+/**
+ * Spline path being followed (NULL: the waypoints of pursuitPath); pursuitPath then holds
+ * samples of the spline, for display and for ordering the region triggers.
+ * splineParameter: parameter of the robot's last projection on the spline
+ */
+const SplinePath *pursuitSpline = NULL;
+double splineParameter = 0;
+std::atomic<bool> pursuitActive(false);
+/**
+ * Progress along the path
+ * pursuitLength: path length from the first waypoint to each waypoint (inches)
+ * progressSegment: segment the robot was last projected on; pathProgress: inches along the path
+ */
+double pursuitLength[MAX_PURSUIT_POINTS];
+int progressSegment = 0;
+double pathProgress = 0;
+/** triggers of the current path, sorted by order, and the next one to fire */
+PathTrigger pathTriggers[MAX_PATH_TRIGGERS];
+int pathTriggerCount = 0, nextPathTrigger = 0;
+/** number of paths set (so readers of the path can tell a new one) */
+std::atomic<uint32_t> pursuitVersion(0);
+/** path staged by replacePursuitPath, adopted by the control task at its next cycle */
+PursuitPoint replacementPath[MAX_PURSUIT_POINTS - 1];
+int replacementCount = 0;
+std::atomic<bool> replacementPending(false);
+/**
+ * Trigger at a distance along the path (refer to PathTrigger).
+ * @param distance
+ * inches along the path from the robot's position when the path starts
+ *
+ * @param callback
+ * called once by the control task
+ */
+PathTrigger atPathDistance(double distance, InlineFunction<void()> callback){
+  return {PATH_TRIGGER_DISTANCE, distance, 0, 0, 0, callback, distance};
+}
+/**
+ * Trigger on entering a circular region (refer to PathTrigger).
+ * @param x, y
+ * centre of the region in field coordinates
+ *
+ * @param radius
+ * radius of the region in inches
+ *
+ * @param callback
+ * called once by the control task
+ */
+PathTrigger inPathRegion(double x, double y, double radius, InlineFunction<void()> callback){
+  return {PATH_TRIGGER_REGION, 0, x, y, radius, callback, 0};
+}
+/**
+ * Position along the current path of the point closest to a point.
+ * @param x, y
+ * the point
+ *
+ * @return
+ * inches along the path
+ */
+double closestPathDistance(double x, double y){
+  double best = INFINITY, distance = 0;
+  for(int i = 0; i < pursuitCount - 1; i++){
+    PursuitPoint start = pursuitPath[i], end = pursuitPath[i+1];
+    double dx = end.x - start.x, dy = end.y - start.y, a = dx*dx + dy*dy;
+    double t = a > 0? fmin(fmax(((x - start.x)*dx + (y - start.y)*dy)/a, 0), 1) : 0;
+    double gap = hypot(start.x + t*dx - x, start.y + t*dy - y);
+    if(gap < best){
+      best = gap;
+      distance = pursuitLength[i] + t*sqrt(a);
+    }
+  }
+  return distance;
+}
+/**
+ * Set the path to follow. The path starts being followed at the next control cycle.
+ * @param points
+ * waypoints in field coordinates; the robot's current position does not need to be included
+ *
+ * @param count
+ * number of waypoints
+ *
+ * @param lookahead
+ * lookahead distance in inches
+ *
+ * @param maxVel
+ * maximum velocity in inches per second
+ *
+ * @param reverse
+ * true: drive the path backwards
+ *
+ * @param triggers, triggerCount (optional. default = none)
+ * triggers of the path (copied)
+ *
+ * @return
+ * false if the path is empty or too long, or has too many triggers
+ */
+bool setPursuitPath(const PursuitPoint *points, int count, double lookahead, double maxVel, bool reverse,
+  const PathTrigger *triggers, int triggerCount){
+  if(count < 1 || count + 1 > MAX_PURSUIT_POINTS || triggerCount > MAX_PATH_TRIGGERS) return false;
+  pursuitActive = false;
+  /** start the path from the current position so the first segment is always valid */
+  PoseSnapshot pose = getPose();
+  pursuitPath[0] = {pose.x, pose.y};
+  for(int i = 0; i < count; i++) pursuitPath[i+1] = points[i];
+  pursuitCount = count + 1;
+  pursuitSpline = NULL;
+  startPursuitPath(lookahead, maxVel, reverse, triggers, triggerCount);
+  return true;
+}
+/**
+ * Set a spline path to follow (refer to splinePath.hpp). The path starts being followed at the
+ * next control cycle, from its first point: build it from the robot's position.
+ * @param path
+ * the spline path (not copied: it must stay valid while it is followed)
+ *
+ * @param lookahead
+ * lookahead distance along the path in inches
+ *
+ * @param maxVel
+ * maximum velocity in inches per second
+ *
+ * @param reverse
+ * true: drive the path backwards
+ *
+ * @param triggers, triggerCount (optional. default = none)
+ * triggers of the path (copied); distances are from the start of the spline
+ *
+ * @return
+ * false if the path is empty or has too many triggers
+ */
+bool setPursuitSpline(const SplinePath *path, double lookahead, double maxVel, bool reverse,
+  const PathTrigger *triggers, int triggerCount){
+  if(path->count < 1 || triggerCount > MAX_PATH_TRIGGERS) return false;
+  pursuitActive = false;
+  for(int i = 0; i < MAX_PURSUIT_POINTS; i++){
+    pursuitPath[i] = splinePointAtDistance(*path, path->length*i/(MAX_PURSUIT_POINTS - 1));
+  }
+  pursuitCount = MAX_PURSUIT_POINTS;
+  pursuitSpline = path;
+  splineParameter = 0;
+  startPursuitPath(lookahead, maxVel, reverse, triggers, triggerCount);
+  return true;
+}
+/**
+ * Start following pursuitPath (or pursuitSpline): reset the progress, sort the triggers and
+ * publish the new path.
+ * @param lookahead, maxVel, reverse, triggers, triggerCount
+ * as for setPursuitPath
+ */
+void startPursuitPath(double lookahead, double maxVel, bool reverse, const PathTrigger *triggers, int triggerCount){
+  pursuitLength[0] = 0;
+  for(int i = 1; i < pursuitCount; i++){
+    pursuitLength[i] = pursuitLength[i-1] + hypot(pursuitPath[i].x - pursuitPath[i-1].x, pursuitPath[i].y - pursuitPath[i-1].y);
+  }
+  progressSegment = 0;
+  pathProgress = 0;
+  /** sort the triggers by path position (insertion sort: a handful of triggers), so each tick checks one */
+  for(int i = 0; i < triggerCount; i++){
+    PathTrigger trigger = triggers[i];
+    if(trigger.type == PATH_TRIGGER_REGION) trigger.order = closestPathDistance(trigger.x, trigger.y);
+    int j = i;
+    for(; j > 0 && pathTriggers[j-1].order > trigger.order; j--) pathTriggers[j] = pathTriggers[j-1];
+    pathTriggers[j] = trigger;
+  }
+  pathTriggerCount = triggerCount;
+  nextPathTrigger = 0;
+  pursuitLookahead = lookahead;
+  pursuitMaxVel = maxVel;
+  pursuitReverse = reverse;
+  pursuitHeading = getPose().angle;
+  pursuitSegment = 0;
+  pursuitVersion++;
+  replacementPending = false;
+  pursuitActive = true;
+}
+/**
+ * Replace the path being followed without stopping (e.g. a path repaired around an obstacle, refer to
+ * repairPlannedPursuit): the control task switches to it at its next cycle, from the robot's position,
+ * keeping the lookahead, velocity and direction. The triggers that have not fired carry over: region
+ * triggers are placed on the new path, distance triggers keep the distance left to them.
+ * @param points
+ * waypoints in field coordinates (copied)
+ *
+ * @param count
+ * number of waypoints
+ *
+ * @return
+ * false if no path is being followed, the path is empty or too long, or a replacement is still pending
+ */
+bool replacePursuitPath(const PursuitPoint *points, int count){
+  if(!pursuitActive || replacementPending || count < 1 || count + 1 > MAX_PURSUIT_POINTS) return false;
+  for(int i = 0; i < count; i++) replacementPath[i] = points[i];
+  replacementCount = count;
+  replacementPending = true;
+  return true;
+}
+/**
+ * Switch to the staged replacement path (control task, refer to replacePursuitPath).
+ * @param pose
+ * current pose, the start of the new path
+ */
+void adoptReplacementPath(const PoseSnapshot &pose){
+  double travelled = pathProgress;
+  pursuitPath[0] = {pose.x, pose.y};
+  for(int i = 0; i < replacementCount; i++) pursuitPath[i+1] = replacementPath[i];
+  pursuitCount = replacementCount + 1;
+  pursuitSpline = NULL;
+  pursuitLength[0] = 0;
+  for(int i = 1; i < pursuitCount; i++){
+    pursuitLength[i] = pursuitLength[i-1] + hypot(pursuitPath[i].x - pursuitPath[i-1].x, pursuitPath[i].y - pursuitPath[i-1].y);
+  }
+  /** re-place the triggers left and sort them again (insertion sort, as in startPursuitPath) */
+  for(int i = nextPathTrigger; i < pathTriggerCount; i++){
+    PathTrigger trigger = pathTriggers[i];
+    if(trigger.type == PATH_TRIGGER_REGION) trigger.order = closestPathDistance(trigger.x, trigger.y);
+    else trigger.order = trigger.distance = fmax(0, trigger.distance - travelled);
+    int j = i;
+    for(; j > nextPathTrigger && pathTriggers[j-1].order > trigger.order; j--) pathTriggers[j] = pathTriggers[j-1];
+    pathTriggers[j] = trigger;
+  }
+  progressSegment = 0;
+  pathProgress = 0;
+  pursuitSegment = 0;
+  pursuitVersion++;
+  replacementPending = false;
+}
+/**
+ * @return
+ * whether a path is being followed
+ */
+bool isPursuitActive(){
+  return pursuitActive;
+}
+/**
+ * Copy the last path set (for display; a path set during the copy may be torn until the next call).
+ * @param points
+ * array of MAX_PURSUIT_POINTS, set to the waypoints (starting at the robot's position when it was set)
+ *
+ * @param version
+ * set to the number of paths set so far (0: none)
+ *
+ * @return
+ * number of waypoints
+ */
+int getPursuitPath(PursuitPoint *points, uint32_t &version){
+  version = pursuitVersion;
+  int count = pursuitCount;
+  for(int i = 0; i < count; i++) points[i] = pursuitPath[i];
+  return count;
+}
+/**
+ * @return
+ * inches travelled along the current path (the robot's projection on it)
+ */
+double getPathProgress(){
+  return pathProgress;
+}
+/**
+ * @return
+ * inches left along the current path (0 when no path is followed)
+ */
+double getPathRemaining(){
+  if(!pursuitActive) return 0;
+  double length = pursuitSpline != NULL? pursuitSpline->length : pursuitLength[pursuitCount-1];
+  return fmax(0, length - pathProgress);
+}
+/**
+ * Project the robot on the path, moving forward from the last segment it was on
+ * (at most PURSUIT_SEARCH_WINDOW segments per call; the rest is caught up at the next cycles).
+ * @param pose
+ * current pose
+ */
+void updatePathProgress(const PoseSnapshot &pose){
+  if(pursuitSpline != NULL){
+    /** Newton steps on the parameter towards the robot's projection, never backwards */
+    for(int i = 0; i < SPLINE_PROJECTION_STEPS; i++){
+      PursuitPoint point = splinePoint(*pursuitSpline, splineParameter);
+      PursuitPoint tangent = splineTangent(*pursuitSpline, splineParameter);
+      double a = tangent.x*tangent.x + tangent.y*tangent.y;
+      if(a == 0) break;
+      double step = ((pose.x - point.x)*tangent.x + (pose.y - point.y)*tangent.y)/a;
+      splineParameter = fmin(fmax(splineParameter + fmin(step, SPLINE_PROJECTION_MAX_STEP), splineParameter), pursuitSpline->count);
+    }
+    pathProgress = fmax(pathProgress, splineDistanceAt(*pursuitSpline, splineParameter));
+    return;
+  }
+  for(int searched = 1; ; searched++){
+    PursuitPoint start = pursuitPath[progressSegment], end = pursuitPath[progressSegment+1];
+    double dx = end.x - start.x, dy = end.y - start.y, a = dx*dx + dy*dy;
+    double t = a > 0? ((pose.x - start.x)*dx + (pose.y - start.y)*dy)/a : 1;
+    if(t >= 1 && progressSegment < pursuitCount - 2 && searched < PURSUIT_SEARCH_WINDOW){
+      progressSegment++;
+      continue;
+    }
+    t = fmin(fmax(t, 0), 1);
+    pathProgress = fmax(pathProgress, pursuitLength[progressSegment] + t*sqrt(a));
+    return;
+  }
+}
+/**
+ * Fire the path triggers that are due, in path order (only the next trigger is checked per tick).
+ * @param pose
+ * current pose
+ *
+ * @param finished
+ * the path has just been finished: fire every trigger left
+ */
+void firePathTriggers(const PoseSnapshot &pose, bool finished){
+  while(nextPathTrigger < pathTriggerCount){
+    const PathTrigger &trigger = pathTriggers[nextPathTrigger];
+    bool due = finished;
+    if(trigger.type == PATH_TRIGGER_DISTANCE) due = due || pathProgress >= trigger.distance;
+    else{
+      due = due || hypot(trigger.x - pose.x, trigger.y - pose.y) <= trigger.radius
+        || pathProgress >= trigger.order + trigger.radius;
+    }
+    if(!due) return;
+    nextPathTrigger++;
+    trigger.callback();
+  }
+}
+/** Stop following the current path. */
+void stopPursuit(){
+  pursuitActive = false;
+  replacementPending = false;
+}
+/**
+ * Find the lookahead point: the furthest intersection of the lookahead circle
+ * with the path, searching forward from the last segment (and never from behind the robot's
+ * projection) so that the robot never steers back towards a part of the path it has already passed.
+ * At most PURSUIT_SEARCH_WINDOW segments are searched: on a dense path the point may fall short
+ * of the circle for a cycle, and the search resumes from there at the next one.
+ * On a spline path: the point a lookahead further along the path than the robot's projection.
+ * @param pose
+ * current pose
+ *
+ * @param target
+ * set to the lookahead point
+ */
+void findLookahead(const PoseSnapshot &pose, PursuitPoint &target){
+  if(pursuitSpline != NULL){
+    /** the point a lookahead ahead of the robot's projection along the spline */
+    target = splinePointAtDistance(*pursuitSpline, pathProgress + pursuitLookahead);
+    return;
+  }
+  if(pursuitSegment < progressSegment) pursuitSegment = progressSegment;
+  int last = pursuitSegment + PURSUIT_SEARCH_WINDOW < pursuitCount - 1 ? pursuitSegment + PURSUIT_SEARCH_WINDOW : pursuitCount - 1;
+  /** if no intersection is found, steer at the end of the last segment searched */
+  target = pursuitPath[last];
+  int i = pursuitSegment;
+  for(; i < last; i++){
+    PursuitPoint start = pursuitPath[i], end = pursuitPath[i+1];
+    double dx = end.x - start.x, dy = end.y - start.y;
+    double fx = start.x - pose.x, fy = start.y - pose.y;
+    /** solve |start + t*d - pose| = lookahead for t in [0, 1] */
+    double a = dx*dx + dy*dy;
+    if(a == 0) continue;
+    double b = 2*(fx*dx + fy*dy);
+    double c = fx*fx + fy*fy - pursuitLookahead*pursuitLookahead;
+    double discriminant = b*b - 4*a*c;
+    if(discriminant < 0){
+      /** the whole segment is outside the circle: steer at its start */
+      if(i == pursuitSegment) target = start;
+      break;
+    }
+    double t = (-b + sqrt(discriminant))/(2*a);
+    if(t >= 0 && t <= 1){
+      target = {start.x + t*dx, start.y + t*dy};
+      pursuitSegment = i;
+    }
+    /** the segment ends outside the circle, so later segments are further away */
+    else if(t < 0) break;
+  }
+  /** the window ended inside the circle: resume from its last segment */
+  if(i == last && last < pursuitCount - 1) pursuitSegment = last - 1;
+}
+/**
+ * Compute the side velocities that steer the robot along the path.
+ * Called by the control task once per cycle; fires the path triggers that are due.
+ * A holonomic base (HOLONOMIC_BASE) does not steer: it translates straight at the lookahead point,
+ * holding the bearing it had when the path was set, so it needs no slowing for the curvature.
+ * @param pose
+ * current pose from the odometry task
+ *
+ * @param velL
+ * set to the left side velocity in inches per second
+ *
+ * @param velR
+ * set to the right side velocity in inches per second
+ *
+ * @param velS
+ * set to the strafe velocity in inches per second (0 on a tank base)
+ *
+ * @return
+ * false if no path is being followed (or the path has just been finished)
+ */
+bool computePurePursuit(const PoseSnapshot &pose, double &velL, double &velR, double &velS){
+  velL = velR = velS = 0;
+  if(!pursuitActive) return false;
+  if(replacementPending) adoptReplacementPath(pose);
+  PursuitPoint end = pursuitPath[pursuitCount-1];
+  double distToEnd = hypot(end.x - pose.x, end.y - pose.y);
+  updatePathProgress(pose);
+  /** steering at the end point already */
+  bool lastSegment = pursuitSpline != NULL ? pathProgress + pursuitLookahead >= pursuitSpline->length
+    : pursuitSegment == pursuitCount - 2;
+  if(lastSegment && distToEnd < PURSUIT_END_LEEWAY){
+    firePathTriggers(pose, true);
+    pursuitActive = false;
+    return false;
+  }
+  firePathTriggers(pose, false);
+  PursuitPoint target;
+  findLookahead(pose, target);
+  if(HOLONOMIC_BASE){
+    double dx = target.x - pose.x, dy = target.y - pose.y;
+    double distance = fmax(hypot(dx, dy), 1e-6);
+    double vel = fmin(pursuitMaxVel, sqrt(2*PURSUIT_MAX_DECEL*distToEnd))/distance;
+    /** the way to the lookahead point along and across the heading */
+    splitHolonomicVelocity(vel*(dx*sin(pose.angle) + dy*cos(pose.angle)), vel*(dx*cos(pose.angle) - dy*sin(pose.angle)),
+                           HOLONOMIC_HEADING_GAIN*angleDiff(pursuitHeading, pose.angle), pursuitMaxVel, velL, velR, velS);
+    return true;
+  }
+  /** when reversing, the back of the robot is the front */
+  double heading = pursuitReverse? pose.angle + PI : pose.angle;
+  double dx = target.x - pose.x, dy = target.y - pose.y;
+  /** lateral offset of the lookahead point, positive to the right (clockwise) */
+  double lateral = dx*cos(heading) - dy*sin(heading);
+  double distance = fmax(hypot(dx, dy), 1e-6);
+  double curvature = 2*lateral/(distance*distance);
+  /** slow down for the end of the path and for sharp curves */
+  double vel = fmin(pursuitMaxVel, sqrt(2*PURSUIT_MAX_DECEL*distToEnd));
+  if(fabs(curvature) > 1e-6) vel = fmin(vel, sqrt(PURSUIT_MAX_LAT_ACC/fabs(curvature)));
+  double left = vel*(1 + curvature*baseWidth/2);
+  double right = vel*(1 - curvature*baseWidth/2);
+  /** keep the outer side within the velocity limit */
+  double fastest = fmax(fabs(left), fabs(right));
+  if(fastest > pursuitMaxVel){
+    left *= pursuitMaxVel/fastest;
+    right *= pursuitMaxVel/fastest;
+  }
+  /** reversed: the front's left side is the robot's right side */
+  velL = pursuitReverse? -right : left;
+  velR = pursuitReverse? -left : right;
+  return true;
+}
+/**
+ * Follow a path with pure pursuit.
+ * @param points
+ * waypoints in field coordinates
+ *
+ * @param count
+ * number of waypoints
+ *
+ * @param lookahead
+ * lookahead distance in inches
+ *
+ * @param maxVel
+ * maximum velocity in inches per second
+ *
+ * @param reverse
+ * true: backward movement
+ * false: forward movement
+ *
+ * @note
+ * Use waitBase(cutoff) to wait until the end of the path.
+ */
+void basePursuit(const PursuitPoint *points, int count, double lookahead, double maxVel, bool reverse){
+  if(setPursuitPath(points, count, lookahead, maxVel, reverse)) startBasePursuit();
+}
+/**
+ * Follow a path with pure pursuit using the default lookahead and velocity, with path triggers
+ * (instead of waitBase followed by the mechanism calls).
+ * @param points
+ * waypoints in field coordinates
+ *
+ * @param count
+ * number of waypoints
+ *
+ * @param triggers
+ * triggers of the path (refer to PathTrigger)
+ *
+ * @param triggerCount
+ * number of triggers
+ *
+ * @param reverse (optional. default = false)
+ * true: backward movement
+ * false: forward movement
+ */
+void basePursuit(const PursuitPoint *points, int count, const PathTrigger *triggers, int triggerCount, bool reverse){
+  if(setPursuitPath(points, count, getParam(PARAM_PURSUIT_LOOKAHEAD), PURSUIT_MAX_VEL, reverse, triggers, triggerCount)) startBasePursuit();
+}
+/**
+ * Follow a path with pure pursuit using the default lookahead and velocity.
+ * @param points
+ * waypoints in field coordinates
+ *
+ * @param count
+ * number of waypoints
+ *
+ * @param reverse (optional. default = false)
+ * true: backward movement
+ * false: forward movement
+ */
+void basePursuit(const PursuitPoint *points, int count, bool reverse){
+  basePursuit(points, count, getParam(PARAM_PURSUIT_LOOKAHEAD), PURSUIT_MAX_VEL, reverse);
+}
+/**
+ * Follow a spline path with pure pursuit (refer to setPursuitSpline).
+ * @param path
+ * the spline path, built from the robot's position (must stay valid while it is followed)
+ *
+ * @param lookahead
+ * lookahead distance along the path in inches
+ *
+ * @param maxVel
+ * maximum velocity in inches per second
+ *
+ * @param reverse
+ * true: backward movement
+ * false: forward movement
+ */
+void baseSplinePursuit(const SplinePath *path, double lookahead, double maxVel, bool reverse){
+  if(setPursuitSpline(path, lookahead, maxVel, reverse)) startBasePursuit();
+}
+/**
+ * Follow a spline path with pure pursuit using the default lookahead and velocity.
+ * @param path
+ * the spline path, built from the robot's position (must stay valid while it is followed)
+ *
+ * @param reverse (optional. default = false)
+ * true: backward movement
+ * false: forward movement
+ */
+void baseSplinePursuit(const SplinePath *path, bool reverse){
+  baseSplinePursuit(path, getParam(PARAM_PURSUIT_LOOKAHEAD), PURSUIT_MAX_VEL, reverse);
+}
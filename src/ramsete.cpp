@@ -0,0 +1,37 @@
+/**
+ * RAMSETE tracking controller (refer to ramsete.hpp):
+ * - Error of the live pose to the reference pose, in the robot's frame
+ * - Nonlinear feedback on the reference velocities, split into side velocities
+ */
+#include "main.h"
+/**
+ * Side velocities that bring the robot onto the reference pose of a trajectory.
+ * Bearings are clockwise, so this is the textbook law mirrored: the lateral error is taken to the
+ * right of the robot, and the angular velocity is clockwise.
+ * @param pose
+ * live pose
+ *
+ * @param refX, refY, refAngle
+ * reference pose (inches, radians)
+ *
+ * @param refLinVel, refAngVel
+ * reference velocities (in/s, rad/s clockwise)
+ *
+ * @param velL, velR
+ * set to the side velocities (in/s)
+ */
+void computeRamsete(const PoseSnapshot &pose, double refX, double refY, double refAngle, double refLinVel, double refAngVel,
+                    double &velL, double &velR){
+  double dx = refX - pose.x, dy = refY - pose.y;
+  double sinAngle = sin(pose.angle), cosAngle = cos(pose.angle);
+  double errorForward = dx*sinAngle + dy*cosAngle;
+  double errorRight = dx*cosAngle - dy*sinAngle;
+  double errorAngle = angleDiff(refAngle, pose.angle);
+  double sinc = fabs(errorAngle) < 1e-6? 1 : sin(errorAngle)/errorAngle;
+  double k = 2*RAMSETE_ZETA*sqrt(refAngVel*refAngVel + RAMSETE_B*refLinVel*refLinVel);
+  double linVel = refLinVel*cos(errorAngle) + k*errorForward;
+  double angVel = refAngVel + k*errorAngle + RAMSETE_B*refLinVel*sinc*errorRight;
+  /** refer to Odometry Documentation.docx: side velocities of a turn */
+  velL = linVel + angVel*baseWidth/2;
+  velR = linVel - angVel*baseWidth/2;
+}
@@ -0,0 +1,128 @@
+/**
+ * Resource monitor:
+ * - Stack high-water marks of the watched tasks
+ * - Heap usage (current and minimum free) of the user heap and of the kernel heap
+ * - Motion arena usage
+ * - Allocation tripwire report (refer to allocGuard.hpp)
+ * - Monitor task reporting both through telemetry
+ */
+#include "main.h"
+#include <malloc.h>
+/**
+ * FreeRTOS keeps a high-water mark for every task stack; PROS 3.2 does not wrap it,
+ * so declare the kernel function that libpros.a already links against.
+ * @return
+ * least free stack of the task since it started, in words
+ */
+extern "C" uint32_t uxTaskGetStackHighWaterMark(pros::task_t task);
+/**
+ * The kernel heap (task stacks, LVGL objects: kmalloc) is FreeRTOS' heap, separate from the
+ * user heap (malloc, new); FreeRTOS keeps its free size and its least free size since boot.
+ * @return
+ * bytes
+ */
+extern "C" size_t xPortGetFreeHeapSize(void);
+extern "C" size_t xPortGetMinimumEverFreeHeapSize(void);
+/** watched task handles (NULL if not watched) and their stack sizes in words */
+std::atomic<pros::task_t> watchedTasks[TIMING_TASKS];
+uint32_t watchedDepths[TIMING_TASKS];
+/** least free heap seen so far, in bytes */
+std::atomic<uint32_t> heapMinFree(MONITOR_HEAP_SIZE);
+/**
+ * Watch the stack of a task.
+ * @param task
+ * which task
+ *
+ * @param handle
+ * its handle (a pros::Task converts to one)
+ *
+ * @param stackDepth
+ * the stack depth it was created with, in words (e.g. TASK_STACK_DEPTH_DEFAULT)
+ */
+void watchTaskStack(TimedTask task, pros::task_t handle, uint32_t stackDepth){
+  watchedDepths[task] = stackDepth;
+  watchedTasks[task] = handle;
+}
+/**
+ * @param task
+ * a watched task
+ *
+ * @return
+ * its stack usage (0 if it is not watched)
+ */
+StackUsage getStackUsage(TimedTask task){
+  StackUsage usage = {0, 0};
+  pros::task_t handle = watchedTasks[task];
+  if(handle == NULL) return usage;
+  usage.depth = watchedDepths[task]*4;
+  usage.minFree = uxTaskGetStackHighWaterMark(handle)*4;
+  return usage;
+}
+/**
+ * @param handle
+ * a task handle (e.g. pros::c::task_get_current())
+ *
+ * @return
+ * the watched task (TimedTask) of that handle, -1 if it is not watched
+ */
+int findWatchedTask(pros::task_t handle){
+  if(handle == NULL) return -1;
+  for(int i = 0; i < TIMING_TASKS; i++) if(watchedTasks[i].load(std::memory_order_relaxed) == handle) return i;
+  return -1;
+}
+/**
+ * Sample the heap usage and update the minimum.
+ * @return
+ * heap usage
+ */
+HeapUsage getHeapUsage(){
+#ifdef __GLIBC__
+  /** host simulation build */
+  uint32_t used = mallinfo2().uordblks;
+#else
+  uint32_t used = mallinfo().uordblks;
+#endif
+  HeapUsage usage;
+  usage.free = used < MONITOR_HEAP_SIZE ? MONITOR_HEAP_SIZE - used : 0;
+  if(usage.free < heapMinFree) heapMinFree = usage.free;
+  usage.minFree = heapMinFree;
+  return usage;
+}
+/**
+ * @return
+ * kernel heap usage
+ */
+HeapUsage getKernelHeapUsage(){
+  HeapUsage usage;
+  usage.free = xPortGetFreeHeapSize();
+  usage.minFree = xPortGetMinimumEverFreeHeapSize();
+  return usage;
+}
+/**
+ * Sample the stacks and the heaps every MONITOR_DT and push them to the telemetry buffer
+ * (TRACE_RESOURCES, e.g. DEBUG_MODE 7). Run at low priority.
+ */
+void resourceMonitor(void * ignore){
+  LoopRate rate(MONITOR_DT);
+  startTaskTiming(TIMING_MONITOR, MONITOR_DT, true);
+  while(true){
+    beginTaskIteration(TIMING_MONITOR);
+    HeapUsage heap = getHeapUsage();
+    if(ALLOC_GUARD) reportAllocGuard();
+    if constexpr(TracePoint<TRACE_RESOURCES>::enabled){
+      for(int i = 0; i < TIMING_TASKS; i++){
+        StackUsage stack = getStackUsage((TimedTask)i);
+        if(stack.depth > 0) pushTelemetry(TELEMETRY_STACK, i, stack.minFree, stack.depth);
+      }
+      pushTelemetry(TELEMETRY_HEAP, heap.free, heap.minFree);
+      HeapUsage kernel = getKernelHeapUsage();
+      pushTelemetry(TELEMETRY_DISPLAY, getDisplayFootprint(), kernel.free, kernel.minFree);
+      ArenaUsage arena = getArenaUsage();
+      pushTelemetry(TELEMETRY_ARENA, arena.used, arena.peak, arena.failures);
+      StreamStats stream = getStreamStats();
+      pushTelemetry(TELEMETRY_STREAM, stream.chunks, stream.underruns, stream.failures, stream.slowest);
+    }
+    endTaskIteration(TIMING_MONITOR);
+    rate.wait();
+  }
+}
@@ -0,0 +1,261 @@
+/**
+ * Skills route functions:
+ * - Reading & writing of route and goals files
+ * - Time model of a leg (the cache's velocity planning along the leg's spline)
+ * - Branch-and-bound search of the fastest visiting order (host tool, `./bin/sim route`)
+ * - Generation of the legs into the trajectory cache (from the baked route if there is one) and the run of the route (robot)
+ */
+#include "main.h"
+/** route of the skills run (read by prepareRoute) and its number of generated legs */
+SkillsRoute skillsRoute;
+int routeLegs = 0;
+/** names of the legs in the trajectory cache (static, as the cache keeps the pointers) */
+char routeLegNames[ROUTE_MAX_GOALS][8];
+/**
+ * Read a route or goals file.
+ * @param path
+ * file to read
+ *
+ * @param route
+ * written with the start pose and the goals in file order
+ *
+ * @return
+ * false if the file cannot be read, has an unknown line, no start, no goal or more than ROUTE_MAX_GOALS goals
+ */
+bool loadRoute(const char *path, SkillsRoute &route){
+  ConfigFile file;
+  if(!file.open(path)) return false;
+  bool started = false;
+  route.count = 0;
+  ConfigEntry entry;
+  while(file.next(entry)){
+    bool start = entry.key == "start";
+    double numbers[3];
+    if((!start && entry.key != "goal") || !entry.getNumbers(numbers, 3)) return false;
+    RouteGoal goal = {numbers[0], numbers[1], numbers[2]*toRad};
+    if(start){
+      route.start = goal;
+      started = true;
+    }
+    else if(route.count == ROUTE_MAX_GOALS) return false;
+    else route.goals[route.count++] = goal;
+  }
+  return !file.failed() && started && route.count > 0;
+}
+/**
+ * Write a route file.
+ * @param path
+ * file to write
+ *
+ * @param route
+ * the route, goals in visiting order
+ *
+ * @param time
+ * total time of its legs in seconds (written in the header comment)
+ *
+ * @return
+ * false if the file cannot be written
+ */
+bool saveRoute(const char *path, const SkillsRoute &route, double time){
+  FILE *file = fopen(path, "w");
+  if(file == NULL) return false;
+  fprintf(file, "# skills route: %d goals, %.2f s of trajectories (written by ./bin/sim route)\n", route.count, time);
+  fprintf(file, "start %g %g %g\n", route.start.x, route.start.y, route.start.angle*toDeg);
+  for(int i = 0; i < route.count; i++){
+    const RouteGoal &goal = route.goals[i];
+    fprintf(file, "goal %g %g %g\n", goal.x, goal.y, goal.angle*toDeg);
+  }
+  fclose(file);
+  return true;
+}
+/**
+ * Time a leg as the trajectory cache would drive it: the leg's cubic Hermite path (the fit of
+ * pathfinder's FIT_HERMITE_CUBIC, refer to buildSplinePath) is planned by retimeTrajectory with the
+ * default limits, and the planned duration is the leg's time. Pathfinder itself only runs on the V5,
+ * so this is also the time model of the host tool.
+ * @param from, to
+ * poses at both ends of the leg
+ *
+ * @return
+ * time of the leg in seconds, or -1 if it cannot be planned (the goals are at the same point, or the arena is full)
+ */
+double timeRouteLeg(const RouteGoal &from, const RouteGoal &to){
+  Waypoint points[2] = {{from.x, from.y, from.angle}, {to.x, to.y, to.angle}};
+  uint32_t scratch = getScratchMark();
+  Segment *center, *retimed;
+  int count = splineCenter(points, 2, &center);
+  double time = -1;
+  if(count > 0){
+    int length = retimeTrajectory(center, count, TRAJECTORY_MAX_VEL, TRAJECTORY_MAX_ACC, &retimed);
+    if(length > 0) time = (length - 1)*TRAJECTORY_DT;
+  }
+  releaseScratch(scratch);
+  return time;
+}
+/**
+ * State of the branch-and-bound search
+ * cost, count: time of each leg (refer to solveRouteOrder)
+ * minIn: cheapest leg into each goal (a goal left to visit takes at least this long)
+ * path: goals of the branch being searched
+ * best, bestTime: fastest complete order found so far
+ */
+struct RouteSearch{
+  const double (*cost)[ROUTE_MAX_GOALS + 1];
+  int count;
+  double minIn[ROUTE_MAX_GOALS + 1];
+  int path[ROUTE_MAX_GOALS], best[ROUTE_MAX_GOALS];
+  double bestTime;
+};
+/**
+ * Extend a branch by every goal not visited yet, cheapest leg first, pruning the branches whose
+ * lower bound (time so far plus the cheapest leg into every goal left) cannot beat the best order.
+ * @param depth
+ * number of goals on the branch
+ *
+ * @param last
+ * node the branch ends at (0: start, i: goal i)
+ *
+ * @param visited
+ * bit i set if goal i is on the branch
+ *
+ * @param time, bound
+ * time of the branch and the sum of minIn over the goals left
+ */
+void searchRoute(RouteSearch &search, int depth, int last, uint32_t visited, double time, double bound){
+  if(depth == search.count){
+    if(time < search.bestTime){
+      search.bestTime = time;
+      memcpy(search.best, search.path, sizeof(search.best));
+    }
+    return;
+  }
+  /** the goals left, sorted by the leg from the end of the branch (insertion sort of at most ROUTE_MAX_GOALS) */
+  int next[ROUTE_MAX_GOALS], nextCount = 0;
+  for(int j = 1; j <= search.count; j++){
+    if((visited >> j) & 1 || search.cost[last][j] < 0) continue;
+    int k = nextCount++;
+    while(k > 0 && search.cost[last][next[k - 1]] > search.cost[last][j]){
+      next[k] = next[k - 1];
+      k--;
+    }
+    next[k] = j;
+  }
+  for(int k = 0; k < nextCount; k++){
+    int j = next[k];
+    double legTime = time + search.cost[last][j], legBound = bound - search.minIn[j];
+    if(legTime + legBound >= search.bestTime) continue;
+    search.path[depth] = j;
+    searchRoute(search, depth + 1, j, visited | 1u << j, legTime, legBound);
+  }
+}
+/**
+ * Find the visiting order of the goals with the shortest total time (exact, by branch and bound).
+ * @param cost
+ * cost[i][j]: time of the leg from node i to goal j in seconds (node 0: start, i: goal i), negative if the
+ * leg cannot be driven
+ *
+ * @param count
+ * number of goals (at most ROUTE_MAX_GOALS)
+ *
+ * @param order
+ * written with the goals (1 to count) in visiting order
+ *
+ * @return
+ * total time of the order, or -1 if no order can be driven
+ */
+double solveRouteOrder(const double cost[][ROUTE_MAX_GOALS + 1], int count, int *order){
+  if(count < 1 || count > ROUTE_MAX_GOALS) return -1;
+  RouteSearch search;
+  search.cost = cost;
+  search.count = count;
+  search.bestTime = INFINITY;
+  double bound = 0;
+  for(int j = 1; j <= count; j++){
+    search.minIn[j] = INFINITY;
+    for(int i = 0; i <= count; i++) if(i != j && cost[i][j] >= 0) search.minIn[j] = fmin(search.minIn[j], cost[i][j]);
+    bound += search.minIn[j];
+  }
+  if(std::isinf(bound)) return -1;
+  searchRoute(search, 0, 0, 0, 0, bound);
+  if(std::isinf(search.bestTime)) return -1;
+  memcpy(order, search.best, count*sizeof(int));
+  return search.bestTime;
+}
+/**
+ * Reorder the goals of a route into the fastest visiting order, timing every leg (refer to timeRouteLeg).
+ * Host tool only: generates (count + 1) * count trajectories.
+ * @param route
+ * the route; its goals are reordered if an order is found
+ *
+ * @param givenTime
+ * written with the total time of the goals in their given order (-1 if it cannot be driven)
+ *
+ * @return
+ * total time of the fastest order in seconds, or -1 if no order can be driven
+ */
+double optimizeRoute(SkillsRoute &route, double &givenTime){
+  static double cost[ROUTE_MAX_GOALS + 1][ROUTE_MAX_GOALS + 1];
+  for(int i = 0; i <= route.count; i++){
+    const RouteGoal &from = i == 0? route.start : route.goals[i - 1];
+    for(int j = 1; j <= route.count; j++) cost[i][j] = i == j? -1 : timeRouteLeg(from, route.goals[j - 1]);
+  }
+  givenTime = 0;
+  for(int j = 1; j <= route.count && givenTime >= 0; j++) givenTime = cost[j - 1][j] < 0? -1 : givenTime + cost[j - 1][j];
+  int order[ROUTE_MAX_GOALS];
+  double time = solveRouteOrder(cost, route.count, order);
+  if(time < 0) return -1;
+  RouteGoal goals[ROUTE_MAX_GOALS];
+  for(int i = 0; i < route.count; i++) goals[i] = route.goals[order[i] - 1];
+  memcpy(route.goals, goals, route.count*sizeof(RouteGoal));
+  return time;
+}
+/**
+ * Read the route of the skills run (ROUTE_FILE_PATH) and generate its legs into the trajectory cache
+ * ("route1" to the last goal's leg; loaded from the microSD card when unchanged). Call from the routine's prepare.
+ * A baked route (refer to bakedTrajectories.hpp) is taken instead of the file, without parsing, and its legs
+ * are found baked; bake again to change it.
+ * @return
+ * false if there is no route or a leg cannot be generated (the legs before it are kept)
+ */
+bool prepareRoute(){
+  routeLegs = 0;
+  const SkillsRoute *baked = getBakedRoute();
+  if(baked != NULL) skillsRoute = *baked;
+  else if(!usd::is_installed() || !loadRoute(ROUTE_FILE_PATH, skillsRoute)) return false;
+  for(int i = 0; i < skillsRoute.count; i++){
+    const RouteGoal &from = i == 0? skillsRoute.start : skillsRoute.goals[i - 1], &to = skillsRoute.goals[i];
+    Waypoint points[2] = {{from.x, from.y, from.angle}, {to.x, to.y, to.angle}};
+    snprintf(routeLegNames[i], sizeof(routeLegNames[i]), "route%d", i + 1);
+    if(generateTrajectory(routeLegNames[i], points, 2) < 0) return false;
+    routeLegs++;
+  }
+  return true;
+}
+/**
+ * @return
+ * number of legs generated by prepareRoute
+ */
+int getRouteLegs(){
+  return routeLegs;
+}
+/**
+ * @return
+ * the route prepared by prepareRoute, NULL if it is not prepared (no route, or a leg could not be generated)
+ */
+const SkillsRoute *getPreparedRoute(){
+  return routeLegs > 0 && routeLegs == skillsRoute.count? &skillsRoute : NULL;
+}
+/**
+ * Drive the prepared route, leg by leg, from its start pose (the odometry must start there).
+ * @return
+ * false if no route is prepared or a leg did not settle within ROUTE_LEG_TIMEOUT
+ */
+bool runRoute(){
+  bool settled = routeLegs > 0;
+  for(int i = 0; i < routeLegs; i++){
+    if(!followTrajectory(routeLegNames[i])) return false;
+    waitBase(ROUTE_LEG_TIMEOUT);
+    settled = settled && isBaseSettled();
+  }
+  return settled;
+}
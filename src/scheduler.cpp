@@ -0,0 +1,87 @@
+/**
+ * Tick scheduler:
+ * - (Un)subscription of tasks to the odometry tick
+ * - Notification of subscribers after every published pose
+ * - Waiting for a fresh pose
+ */
+#include "main.h"
+/** a task that wants to run once every divider odometry ticks (empty slot if task is NULL) */
+struct OdometrySubscriber{
+  std::atomic<pros::task_t> task;
+  std::atomic<uint32_t> divider;
+};
+OdometrySubscriber odomSubscribers[MAX_ODOM_SUBSCRIBERS];
+/** task of a slot claimed by subscribeOdometry while it stores the divider (not a task: the notifier skips it) */
+const pros::task_t odomSlotClaimed = (pros::task_t)odomSubscribers;
+/** number of poses published since the odometry task started */
+std::atomic<uint32_t> odomTick(0);
+/**
+ * Subscribe a task to the odometry tick.
+ * @param task
+ * task to be notified
+ *
+ * @param divider
+ * the task is notified once every divider ticks (e.g. 2 for a 20ms loop on a 10ms odometry)
+ *
+ * @return
+ * whether there was a free subscriber slot
+ */
+bool subscribeOdometry(pros::task_t task, uint32_t divider){
+  for(int i = 0; i < MAX_ODOM_SUBSCRIBERS; i++){
+    pros::task_t empty = NULL;
+    /** claim the slot first, then publish the task only once its divider is stored, so the odometry task never pairs it with another subscriber's */
+    if(!odomSubscribers[i].task.compare_exchange_strong(empty, odomSlotClaimed)) continue;
+    odomSubscribers[i].divider.store(divider < 1? 1 : divider);
+    odomSubscribers[i].task.store(task);
+    return true;
+  }
+  return false;
+}
+/**
+ * Unsubscribe a task from the odometry tick.
+ * Must be called before the task exits, since notifying a deleted task is undefined.
+ * @param task
+ * task to be removed
+ */
+void unsubscribeOdometry(pros::task_t task){
+  for(int i = 0; i < MAX_ODOM_SUBSCRIBERS; i++){
+    pros::task_t current = task;
+    odomSubscribers[i].task.compare_exchange_strong(current, NULL);
+  }
+}
+/**
+ * Notify the subscribed tasks that a new pose has been published.
+ * Called by the odometry task once per tick.
+ * @param ticks
+ * ODOM_DT periods since the previous pose (more than 1 while the odometry runs at ODOM_IDLE_DT):
+ * a subscriber is notified when the count passes a multiple of its divider
+ */
+void notifyOdometrySubscribers(uint32_t ticks){
+  uint32_t prevTick = odomTick.fetch_add(ticks);
+  uint32_t tick = prevTick + ticks;
+  for(int i = 0; i < MAX_ODOM_SUBSCRIBERS; i++){
+    pros::task_t task = odomSubscribers[i].task.load();
+    if(task == NULL || task == odomSlotClaimed) continue;
+    uint32_t divider = odomSubscribers[i].divider.load();
+    if(tick/divider != prevTick/divider) pros::c::task_notify(task);
+  }
+}
+/**
+ * Block the calling (subscribed) task until the next pose is published.
+ * @param timeout
+ * maximum waiting time in ms
+ *
+ * @return
+ * true if woken by a new pose, false on timeout
+ */
+bool waitOdometry(uint32_t timeout){
+  return pros::c::task_notify_take(true, timeout) > 0;
+}
+/**
+ * Retrive the number of ODOM_DT periods covered by the poses published so far.
+ * @return
+ * odometry tick count
+ */
+uint32_t getOdometryTick(){
+  return odomTick.load();
+}
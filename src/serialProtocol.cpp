@@ -0,0 +1,405 @@
+/**
+ * Framed binary telemetry protocol (refer to serialProtocol.hpp for the frame format):
+ * - CRC & COBS encoding and decoding
+ * - Varint & delta coding (also used by the flight recorder)
+ * - Record packing (plain or delta coded) & framing
+ * - Serial output
+ */
+#include "main.h"
+#include "pros/apix.h"
+#include "pros/serial.h"
+/**
+ * CRC-16/CCITT-FALSE.
+ * @param data
+ * bytes to check
+ *
+ * @param length
+ * number of bytes
+ *
+ * @return
+ * CRC of the bytes
+ */
+uint16_t crc16(const uint8_t *data, int length){
+  uint16_t crc = 0xFFFF;
+  for(int i = 0; i < length; i++){
+    crc ^= (uint16_t)data[i] << 8;
+    for(int bit = 0; bit < 8; bit++) crc = (crc & 0x8000)? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+/**
+ * Consistent Overhead Byte Stuffing: remove every 0x00 from the data
+ * so that 0x00 can delimit frames. Adds 1 byte per 254 bytes of data.
+ * @param data
+ * bytes to encode (at most 254)
+ *
+ * @param length
+ * number of bytes
+ *
+ * @param out
+ * encoded bytes (length + 1 bytes); updated
+ *
+ * @return
+ * number of encoded bytes
+ */
+int cobsEncode(const uint8_t *data, int length, uint8_t *out){
+  int codeIndex = 0, outIndex = 1;
+  uint8_t code = 1;
+  for(int i = 0; i < length; i++){
+    if(data[i] == 0){
+      out[codeIndex] = code;
+      codeIndex = outIndex++;
+      code = 1;
+    }
+    else{
+      out[outIndex++] = data[i];
+      code++;
+    }
+  }
+  out[codeIndex] = code;
+  return outIndex;
+}
+/**
+ * Decode COBS in place (refer to cobsEncode).
+ * @param data
+ * encoded bytes, without the 0x00 delimiter; updated with the decoded bytes
+ *
+ * @param length
+ * number of encoded bytes
+ *
+ * @return
+ * number of decoded bytes, -1 if the bytes are not COBS
+ */
+int cobsDecode(uint8_t *data, int length){
+  int in = 0, out = 0;
+  while(in < length){
+    uint8_t code = data[in++];
+    if(code == 0 || in + code - 1 > length) return -1;
+    for(int i = 1; i < code; i++) data[out++] = data[in++];
+    if(code < 0xFF && in < length) data[out++] = 0;
+  }
+  return out;
+}
+/**
+ * Quantize the values of a record into the integer fields of its payload
+ * (refer to serialProtocol.hpp for the layout).
+ * @param record
+ * the record
+ *
+ * @param fields
+ * at least 6 fields; updated
+ *
+ * @param widths
+ * at least 6 widths in bytes (1, 2 or 4); updated
+ *
+ * @return
+ * number of fields
+ */
+int quantizeTelemetry(const TelemetryRecord &record, int64_t *fields, uint8_t *widths){
+  int n = 0;
+  /** int16 fields saturate, int32 fields keep the low 32 bits, byte fields the low 8 bits */
+  auto int16 = [&](double value){ widths[n] = 2; fields[n++] = lround(abscap(value, 32767)); };
+  auto int32 = [&](uint32_t value){ widths[n] = 4; fields[n++] = (int32_t)value; };
+  auto byte = [&](double value){ widths[n] = 1; fields[n++] = (uint8_t)value; };
+  const float *v = record.values;
+  switch(record.type){
+    case TELEMETRY_POSE:
+      int16(v[0]*100);
+      int16(v[1]*100);
+      int16(angleDiffDeg(v[2], 0)*100);
+      break;
+    case TELEMETRY_ERROR:
+      int16(v[0]*10);
+      int16(v[1]*10);
+      break;
+    case TELEMETRY_POWER:
+      int16(v[0]*100);
+      int16(v[1]*100);
+      break;
+    case TELEMETRY_ENCODERS:
+      int32((uint32_t)(int32_t)v[0]);
+      int32((uint32_t)(int32_t)v[1]);
+      break;
+    case TELEMETRY_TIMING:
+      byte(v[0]);
+      for(int i = 1; i < 6; i++) int32((uint32_t)v[i]);
+      break;
+    case TELEMETRY_STACK:
+      byte(v[0]);
+      int32((uint32_t)v[1]);
+      int32((uint32_t)v[2]);
+      break;
+    case TELEMETRY_HEAP:
+      int32((uint32_t)v[0]);
+      int32((uint32_t)v[1]);
+      break;
+    case TELEMETRY_DISPLAY:
+    case TELEMETRY_ARENA:
+      for(int i = 0; i < 3; i++) int32((uint32_t)v[i]);
+      break;
+    case TELEMETRY_STREAM:
+      for(int i = 0; i < 4; i++) int32((uint32_t)v[i]);
+      break;
+    case TELEMETRY_BATTERY:
+      int16(v[0]);
+      int16(v[1]*1000);
+      int16(v[2]);
+      int16(v[3]);
+      break;
+    case TELEMETRY_DEADLINE:
+      byte(v[0]);
+      for(int i = 1; i < 4; i++) int32((uint32_t)v[i]);
+      break;
+    case TELEMETRY_JAM:
+      byte(v[0]);
+      int16(v[1]);
+      int16(v[2]);
+      break;
+    case TELEMETRY_SLIP:
+      int16(v[0]*100);
+      int16(v[1]*100);
+      byte(v[2]);
+      byte(v[3]);
+      break;
+    case TELEMETRY_MOTOR:
+      byte(v[0]);
+      int16(v[1]);
+      int16(v[2]);
+      int16(v[3]*1000);
+      break;
+    case TELEMETRY_LATENCY:
+      byte(v[0]);
+      byte(v[1]);
+      for(int i = 2; i < 6; i++) int32((uint32_t)v[i]);
+      break;
+    case TELEMETRY_STOP:
+      int32((uint32_t)v[0]);
+      int16(v[1]*100);
+      int16(v[2]);
+      break;
+    case TELEMETRY_WATCHDOG:
+      byte(v[0]);
+      byte(v[1]);
+      int32((uint32_t)v[2]);
+      int16(v[3]);
+      byte(v[4]);
+      break;
+    case TELEMETRY_LOAD:
+      byte(v[0]);
+      int16(v[1]*100);
+      int16(v[2]*100);
+      break;
+    case TELEMETRY_BOOT:
+      byte(v[0]);
+      int32((uint32_t)(v[1]*1000));
+      int32((uint32_t)(v[2]*1000));
+      break;
+    case TELEMETRY_CYCLE:
+      int32((uint32_t)v[0]);
+      byte(v[1]);
+      for(int i = 2; i < 6; i++) int32((uint32_t)v[i]);
+      break;
+  }
+  return n;
+}
+/**
+ * Append a little endian integer to a buffer.
+ * @param width
+ * number of bytes (the low bytes of x)
+ *
+ * @return
+ * index after the value
+ */
+int putInt(uint8_t *buffer, int index, uint64_t x, int width){
+  for(int i = 0; i < width; i++) buffer[index + i] = (x >> (8*i)) & 0xFF;
+  return index + width;
+}
+/**
+ * Append a varint to a buffer: 7 bits per byte, least significant first,
+ * the high bit set on every byte but the last.
+ * @return
+ * index after the value
+ */
+int putVarint(uint8_t *buffer, int index, uint64_t x){
+  while(x >= 0x80){
+    buffer[index++] = (x & 0x7F) | 0x80;
+    x >>= 7;
+  }
+  buffer[index++] = x;
+  return index;
+}
+/**
+ * Read a varint from a buffer.
+ * @param length
+ * bytes in the buffer
+ *
+ * @param x
+ * set to the value
+ *
+ * @return
+ * index after the value, -1 if the buffer ends inside it
+ */
+int getVarint(const uint8_t *buffer, int length, int index, uint64_t &x){
+  x = 0;
+  for(int shift = 0; shift < 64 && index < length; shift += 7){
+    uint8_t b = buffer[index++];
+    x |= (uint64_t)(b & 0x7F) << shift;
+    if(!(b & 0x80)) return index;
+  }
+  return -1;
+}
+/**
+ * Delta-code values against the previous ones: each difference (modulo 2^64) as a zig-zag varint,
+ * so a value that did not move takes one byte and a small step two or three.
+ * @param values
+ * the values
+ *
+ * @param prev
+ * the previous values (all 0 for a keyframe); set to values
+ *
+ * @param count
+ * number of values
+ *
+ * @param out
+ * at least DELTA_MAX_BYTES(count) bytes; updated
+ *
+ * @return
+ * number of encoded bytes
+ */
+int deltaEncode(const uint64_t *values, uint64_t *prev, int count, uint8_t *out){
+  int n = 0;
+  for(int i = 0; i < count; i++){
+    int64_t delta = (int64_t)(values[i] - prev[i]);
+    n = putVarint(out, n, ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+    prev[i] = values[i];
+  }
+  return n;
+}
+/**
+ * Decode values coded by deltaEncode.
+ * @param data
+ * the encoded bytes
+ *
+ * @param length
+ * number of bytes available
+ *
+ * @param prev
+ * the previous values (all 0 for a keyframe); set to the decoded values
+ *
+ * @param count
+ * number of values
+ *
+ * @return
+ * number of bytes read, -1 if the data ends early
+ */
+int deltaDecode(const uint8_t *data, int length, uint64_t *prev, int count){
+  int n = 0;
+  for(int i = 0; i < count; i++){
+    uint64_t zigzag;
+    n = getVarint(data, length, n, zigzag);
+    if(n < 0) return -1;
+    prev[i] += (zigzag >> 1) ^ (~(zigzag & 1) + 1);
+  }
+  return n;
+}
+/**
+ * Pack a record into a payload (refer to serialProtocol.hpp for the layout).
+ * @param record
+ * the record
+ *
+ * @param payload
+ * at least TELEMETRY_MAX_PAYLOAD bytes; updated
+ *
+ * @return
+ * payload length
+ */
+int packTelemetry(const TelemetryRecord &record, uint8_t *payload){
+  int64_t fields[6];
+  uint8_t widths[6];
+  int count = quantizeTelemetry(record, fields, widths);
+  payload[0] = record.type;
+  int n = putInt(payload, 1, record.timestamp, 4);
+  for(int i = 0; i < count; i++) n = putInt(payload, n, fields[i], widths[i]);
+  return n;
+}
+/**
+ * Delta coder state of the telemetry stream (drain task only): per record type, the timestamp and
+ * fields of the previous record and the records since the last keyframe
+ */
+struct TelemetryDeltaState{
+  uint64_t prev[TELEMETRY_TYPES][7];
+  uint32_t sinceKeyframe[TELEMETRY_TYPES];
+};
+TelemetryDeltaState telemetryDelta;
+/**
+ * Pack a record into a delta payload (refer to serialProtocol.hpp for the layout):
+ * its timestamp and fields against the previous record of its type, and every
+ * TELEMETRY_KEYFRAME_INTERVAL records of a type a keyframe that a reader can start from.
+ * @param record
+ * the record
+ *
+ * @param payload
+ * at least TELEMETRY_MAX_DELTA_PAYLOAD bytes; updated
+ *
+ * @return
+ * payload length
+ */
+int packTelemetryDelta(const TelemetryRecord &record, uint8_t *payload){
+  int64_t fields[6];
+  uint8_t widths[6];
+  int count = quantizeTelemetry(record, fields, widths);
+  uint64_t values[7] = {record.timestamp};
+  for(int i = 0; i < count; i++) values[i + 1] = fields[i];
+  uint64_t *prev = telemetryDelta.prev[record.type % TELEMETRY_TYPES];
+  uint32_t &since = telemetryDelta.sinceKeyframe[record.type % TELEMETRY_TYPES];
+  bool keyframe = since == 0;
+  if(keyframe) memset(prev, 0, sizeof(telemetryDelta.prev[0]));
+  since = (since + 1) % TELEMETRY_KEYFRAME_INTERVAL;
+  payload[0] = record.type | (keyframe ? TELEMETRY_KEYFRAME : 0);
+  return 1 + deltaEncode(values, prev, count + 1, payload + 1);
+}
+/**
+ * Build the complete frame of a record.
+ * @param record
+ * the record
+ *
+ * @param frame
+ * at least TELEMETRY_MAX_FRAME bytes; updated
+ *
+ * @return
+ * frame length, including the 0x00 delimiter
+ */
+int frameTelemetry(const TelemetryRecord &record, uint8_t *frame){
+  uint8_t payload[TELEMETRY_MAX_DELTA_PAYLOAD + 2];
+  int length = TELEMETRY_FORMAT == TELEMETRY_DELTA ? packTelemetryDelta(record, payload) : packTelemetry(record, payload);
+  uint16_t crc = crc16(payload, length);
+  payload[length++] = crc & 0xFF;
+  payload[length++] = crc >> 8;
+  length = cobsEncode(payload, length, frame);
+  frame[length++] = 0;
+  return length;
+}
+/**
+ * Prepare the serial link for frames. Called by the drain task before the first frame.
+ */
+void initTelemetrySerial(){
+  if(TELEMETRY_SERIAL_PORT == 0){
+    /** our frames are already delimited, so PROS must not wrap stdout in its own COBS packets */
+    pros::c::serctl(SERCTL_DISABLE_COBS, NULL);
+  }
+  else{
+    pros::c::serial_enable(TELEMETRY_SERIAL_PORT);
+    pros::c::serial_set_baudrate(TELEMETRY_SERIAL_PORT, TELEMETRY_BAUDRATE);
+  }
+}
+/**
+ * Write the frame of a record to the serial link.
+ * @param record
+ * the record
+ */
+void writeTelemetryFrame(const TelemetryRecord &record){
+  uint8_t frame[TELEMETRY_MAX_FRAME];
+  int length = frameTelemetry(record, frame);
+  if(TELEMETRY_SERIAL_PORT == 0) fwrite(frame, 1, length, stdout);
+  else pros::c::serial_write(TELEMETRY_SERIAL_PORT, frame, length);
+}
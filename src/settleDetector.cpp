@@ -0,0 +1,58 @@
+/**
+ * SettleDetector functions:
+ * - Settle rule setting
+ * - Settle detection (error, derivative, time in band)
+ */
+#include "main.h"
+/**
+ * Default initialization of a SettleDetector: the default settle rule.
+ */
+SettleDetector::SettleDetector(){
+  SettleRule defaultRule = DEFAULT_SETTLE_RULE;
+  setRule(defaultRule);
+}
+/**
+ * Change the settle rule. Restarts the detection.
+ * @param rule
+ * the new settle rule
+ */
+void SettleDetector::setRule(const SettleRule &rule){
+  this->rule = rule;
+  reset();
+}
+/**
+ * Feed the error of the current cycle.
+ * @param error
+ * distance from the target (inches, sign ignored)
+ *
+ * @param now
+ * time of the sample (micros)
+ *
+ * @return
+ * true if the error and its derivative have been in band for the rule's time
+ */
+bool SettleDetector::isSettled(double error, uint64_t now){
+  error = fabs(error);
+  double derivative = 0;
+  if(hasPrev && now > prevTime) derivative = (error - prevError)*1000000.0/(now - prevTime);
+  prevError = error;
+  prevTime = now;
+  /** the derivative is not known from the first sample, so it cannot count as in band */
+  bool inBand = hasPrev && error <= rule.error && fabs(derivative) <= rule.derivative;
+  hasPrev = true;
+  if(!inBand){
+    inBandSince = 0;
+    return false;
+  }
+  if(inBandSince == 0) inBandSince = now;
+  return now - inBandSince >= rule.time*1000ull;
+}
+/**
+ * Forget the previous samples (e.g. when a new movement starts).
+ */
+void SettleDetector::reset(){
+  prevError = 0;
+  prevTime = 0;
+  hasPrev = false;
+  inBandSince = 0;
+}
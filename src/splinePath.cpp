@@ -0,0 +1,163 @@
+/**
+ * Spline path:
+ * - Cubic Hermite segments through waypoints (field coordinates, bearings)
+ * - Arc-length table (Gauss-Legendre quadrature at build time)
+ * - Point, tangent and distance <-> parameter queries
+ */
+#include "main.h"
+/** 5-point Gauss-Legendre nodes and weights on [0, 1] */
+const double gaussNodes[5] = {0.0469100770306680, 0.2307653449471585, 0.5, 0.7692346550528415, 0.9530899229693320};
+const double gaussWeights[5] = {0.1184634425280945, 0.2393143352496832, 0.2844444444444444, 0.2393143352496832, 0.1184634425280945};
+/**
+ * Build a spline path. The tangent at each waypoint points along its bearing, with the length
+ * of the chord to the next waypoint (like pathfinder's FIT_HERMITE_CUBIC).
+ * @param path
+ * filled with the spline path
+ *
+ * @param points
+ * waypoints in field coordinates, angle: bearing in radians (clockwise from the y-axis, as for generateTrajectory)
+ *
+ * @param count
+ * number of waypoints
+ *
+ * @return
+ * false if there are fewer than 2 or more than MAX_SPLINE_POINTS waypoints
+ */
+bool buildSplinePath(SplinePath &path, const Waypoint *points, int count){
+  if(count < 2 || count > MAX_SPLINE_POINTS) return false;
+  path.count = count - 1;
+  for(int i = 0; i < path.count; i++){
+    Waypoint start = points[i], end = points[i+1];
+    double chord = hypot(end.x - start.x, end.y - start.y);
+    double t0x = chord*sin(start.angle), t0y = chord*cos(start.angle);
+    double t1x = chord*sin(end.angle), t1y = chord*cos(end.angle);
+    SplineSegment &segment = path.segments[i];
+    segment.ax = 2*start.x - 2*end.x + t0x + t1x;
+    segment.bx = -3*start.x + 3*end.x - 2*t0x - t1x;
+    segment.cx = t0x;
+    segment.dx = start.x;
+    segment.ay = 2*start.y - 2*end.y + t0y + t1y;
+    segment.by = -3*start.y + 3*end.y - 2*t0y - t1y;
+    segment.cy = t0y;
+    segment.dy = start.y;
+  }
+  /** integrate the speed |p'(u)| over every table interval */
+  double step = 1.0/SPLINE_TABLE_RESOLUTION;
+  int samples = path.count*SPLINE_TABLE_RESOLUTION;
+  path.arcLength[0] = 0;
+  for(int k = 0; k < samples; k++){
+    double interval = 0;
+    for(int g = 0; g < 5; g++){
+      PursuitPoint tangent = splineTangent(path, (k + gaussNodes[g])*step);
+      interval += gaussWeights[g]*hypot(tangent.x, tangent.y);
+    }
+    path.arcLength[k+1] = path.arcLength[k] + interval*step;
+  }
+  path.length = path.arcLength[samples];
+  return true;
+}
+/**
+ * Segment and local parameter of a path parameter.
+ * @param path
+ * the spline path
+ *
+ * @param u
+ * path parameter (clamped to [0, count])
+ *
+ * @param t
+ * set to the parameter within the segment
+ *
+ * @return
+ * the segment
+ */
+const SplineSegment &splineSegment(const SplinePath &path, double u, double &t){
+  u = fmin(fmax(u, 0), path.count);
+  int i = u < path.count ? (int)u : path.count - 1;
+  t = u - i;
+  return path.segments[i];
+}
+/**
+ * @param path
+ * the spline path
+ *
+ * @param u
+ * path parameter (0 to count)
+ *
+ * @return
+ * the point of the path
+ */
+PursuitPoint splinePoint(const SplinePath &path, double u){
+  double t;
+  const SplineSegment &s = splineSegment(path, u, t);
+  return {((s.ax*t + s.bx)*t + s.cx)*t + s.dx, ((s.ay*t + s.by)*t + s.cy)*t + s.dy};
+}
+/**
+ * @param path
+ * the spline path
+ *
+ * @param u
+ * path parameter (0 to count)
+ *
+ * @return
+ * derivative of the point by the parameter (inches per unit of u)
+ */
+PursuitPoint splineTangent(const SplinePath &path, double u){
+  double t;
+  const SplineSegment &s = splineSegment(path, u, t);
+  return {(3*s.ax*t + 2*s.bx)*t + s.cx, (3*s.ay*t + 2*s.by)*t + s.cy};
+}
+/**
+ * Distance along the path at a parameter (interpolated in the table).
+ * @param path
+ * the spline path
+ *
+ * @param u
+ * path parameter (0 to count)
+ *
+ * @return
+ * inches from the start of the path
+ */
+double splineDistanceAt(const SplinePath &path, double u){
+  double k = fmin(fmax(u, 0), path.count)*SPLINE_TABLE_RESOLUTION;
+  int i = (int)k;
+  if(i >= path.count*SPLINE_TABLE_RESOLUTION) return path.length;
+  return path.arcLength[i] + (k - i)*(path.arcLength[i+1] - path.arcLength[i]);
+}
+/**
+ * Parameter at a distance along the path (binary search in the table).
+ * @param path
+ * the spline path
+ *
+ * @param distance
+ * inches from the start of the path (clamped to [0, length])
+ *
+ * @return
+ * path parameter
+ */
+double splineParameterAt(const SplinePath &path, double distance){
+  int low = 0, high = path.count*SPLINE_TABLE_RESOLUTION;
+  if(distance <= 0) return 0;
+  if(distance >= path.length) return path.count;
+  /** invariant: arcLength[low] <= distance < arcLength[high] */
+  while(high - low > 1){
+    int middle = (low + high)/2;
+    if(path.arcLength[middle] <= distance) low = middle;
+    else high = middle;
+  }
+  double interval = path.arcLength[high] - path.arcLength[low];
+  double f = interval > 0 ? (distance - path.arcLength[low])/interval : 0;
+  return (low + f)/SPLINE_TABLE_RESOLUTION;
+}
+/**
+ * @param path
+ * the spline path
+ *
+ * @param distance
+ * inches from the start of the path
+ *
+ * @return
+ * the point of the path at that distance
+ */
+PursuitPoint splinePointAtDistance(const SplinePath &path, double distance){
+  return splinePoint(path, splineParameterAt(path, distance));
+}
@@ -0,0 +1,54 @@
+/**
+ * StallDetector functions:
+ * - Stall rule setting
+ * - Stall detection (command, current, velocity, time in band)
+ */
+#include "main.h"
+/**
+ * Default initialization of a StallDetector: the default stall rule.
+ */
+StallDetector::StallDetector(){
+  StallRule defaultRule = DEFAULT_STALL_RULE;
+  setRule(defaultRule);
+}
+/**
+ * Change the stall rule. Restarts the detection.
+ * @param rule
+ * the new stall rule
+ */
+void StallDetector::setRule(const StallRule &rule){
+  this->rule = rule;
+  reset();
+}
+/**
+ * Feed the motor state of the current tick.
+ * @param power
+ * commanded power (-127 to 127)
+ *
+ * @param current
+ * current draw in mA (Motor::get_current_draw)
+ *
+ * @param velocity
+ * velocity in rpm (Motor::get_actual_velocity)
+ *
+ * @param now
+ * time of the sample (micros)
+ *
+ * @return
+ * true if the motor has been driven, drawing current and not turning for the rule's time
+ */
+bool StallDetector::isStalled(double power, double current, double velocity, uint64_t now){
+  bool inBand = fabs(power) >= rule.power && current >= rule.current && fabs(velocity) <= rule.velocity;
+  if(!inBand){
+    stalledSince = 0;
+    return false;
+  }
+  if(stalledSince == 0) stalledSince = now;
+  return now - stalledSince >= rule.time*1000ull;
+}
+/**
+ * Forget the stall in progress (e.g. after a recovery).
+ */
+void StallDetector::reset(){
+  stalledSince = 0;
+}
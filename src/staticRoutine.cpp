@@ -0,0 +1,116 @@
+/**
+ * Static routine functions (refer to staticRoutine.hpp):
+ * - A step: to the motion queue, the mechanisms or a wait (also the step of an autonomous script)
+ * - A routine: its steps in order, from the step of a resume
+ * - Progress: the step a resume starts from (refer to poseCheckpoint.hpp)
+ */
+#include "main.h"
+/**
+ * Progress of the running routine
+ * routineStep: step the runner is on (-1: no static routine or script runs)
+ * motionResume: per motion number (modulo ROUTINE_MOTIONS, more than the queue holds), the step a resume starts from
+ *   while that motion runs or waits in the queue: the step after the routine's previous motion
+ * lastMotionStep: step of the latest motion of the routine (runner only)
+ */
+#define ROUTINE_MOTIONS (2*MOTION_QUEUE_SIZE)
+std::atomic<int> routineStep(-1);
+std::atomic<int> motionResume[ROUTINE_MOTIONS];
+int lastMotionStep = -1;
+/**
+ * Queue a motion, waiting for room in the motion queue if it is full.
+ * @param queue
+ * the queue function, called again until it succeeds
+ */
+template<typename Queue> void queueRoutineMotion(Queue queue){
+  while(!queue()) delay(BASE_CONTROL_DT);
+}
+/**
+ * Run a step: a motion goes to the motion queue (so the routine runs ahead of the base), a wait blocks until its
+ * event or timeout.
+ * @param step
+ * the step (refer to RoutineStep)
+ */
+void runRoutineStep(const RoutineStep &step){
+  switch(step.op){
+    case SCRIPT_MOVE: queueRoutineMotion([&]{return queueMove(step.a);}); break;
+    case SCRIPT_MOVE_TO: queueRoutineMotion([&]{return queueMoveTo(step.a, step.b);}); break;
+    case SCRIPT_TURN: queueRoutineMotion([&]{return queueTurn(step.a);}); break;
+    case SCRIPT_TURN_TO: queueRoutineMotion([&]{return queueTurnTo(step.a, step.b, step.option);}); break;
+    case SCRIPT_TURN_RELATIVE: queueRoutineMotion([&]{return queueTurnRelative(step.a);}); break;
+    case SCRIPT_ARC: queueRoutineMotion([&]{return queueArc(step.a, step.b);}); break;
+    case SCRIPT_ARC_TO: queueRoutineMotion([&]{return queueArcTo(step.a, step.b);}); break;
+    case SCRIPT_SWING: queueRoutineMotion([&]{return queueSwing(step.a, (BaseSide)step.option);}); break;
+    case SCRIPT_MOVE_TO_POSE: queueRoutineMotion([&]{return queueMoveToPose(step.a, step.b, step.c, step.option);}); break;
+    case SCRIPT_EARLY_EXIT: setMotionEarlyExit(step.a, step.b); break;
+    case SCRIPT_DEADLINE: setNextMotionDeadline(step.a); break;
+    case SCRIPT_OPTIONAL: setNextMotionOptional(step.a); break;
+    case SCRIPT_FOLLOW: if(step.name != NULL) queueRoutineMotion([&]{return queueTrajectory(step.name);}); break;
+    case SCRIPT_INTAKE: intakeMove(step.option); break;
+    case SCRIPT_CYCLE: cycle(); break;
+    case SCRIPT_SORT: setSortColor((BallColor)step.option); break;
+    case SCRIPT_WAIT_QUEUE: waitMotionQueue(step.a); break;
+    case SCRIPT_WAIT_BALLS: waitBallCount(step.option, step.a); break;
+    case SCRIPT_WAIT_SHOOTER: waitShooter(step.a); break;
+    case SCRIPT_DELAY: delay(step.a); break;
+    default: break;
+  }
+}
+/**
+ * Start the progress of a routine (refer to getRoutineResumeStep); called by runAuton, before the routine runs.
+ */
+void resetRoutineProgress(){
+  routineStep = -1;
+  lastMotionStep = -1;
+}
+/**
+ * Run a step of a routine that runs in steps (a static routine or a script), keeping its progress.
+ * @param step
+ * the step
+ *
+ * @param index
+ * its index in the routine
+ *
+ * @param first
+ * first step to run (the step of a resume, 0 otherwise): the steps before only apply their settings
+ */
+void runIndexedStep(const RoutineStep &step, int index, int first){
+  if(index < first){
+    if(step.op == SCRIPT_EARLY_EXIT || step.op == SCRIPT_SORT || step.op == SCRIPT_INTAKE) runRoutineStep(step);
+    if(isRoutineMotion(step)) lastMotionStep = index;
+    return;
+  }
+  routineStep = index;
+  if(isRoutineMotion(step)){
+    /** the runner is the only task queueing motions while a routine runs, so its motion takes the next number */
+    uint32_t queued, started;
+    getMotionSequence(queued, started);
+    motionResume[queued%ROUTINE_MOTIONS] = lastMotionStep + 1;
+    lastMotionStep = index;
+  }
+  runRoutineStep(step);
+}
+/**
+ * @return
+ * the step a resume of the running routine starts from: the step after the routine's last motion that finished
+ * (-1 if the routine does not run in steps)
+ */
+int getRoutineResumeStep(){
+  int step = routineStep;
+  if(step < 0) return -1;
+  uint32_t queued, started;
+  bool active = getMotionSequence(queued, started);
+  uint32_t motion = active? started - 1 : started;
+  if(motion == queued) return step;
+  return std::min(step, motionResume[motion%ROUTINE_MOTIONS].load());
+}
+/**
+ * Run a static routine (its steps are read in place; call from autonomous(), e.g. the run function of a routine).
+ * A resumed routine starts at the step of the checkpoint (refer to poseCheckpoint.hpp).
+ * @param steps, count
+ * its steps (a constexpr array checked by CHECK_ROUTINE)
+ */
+void runStaticRoutine(const RoutineStep *steps, int count){
+  int first = takeResumeStep();
+  for(int i = 0; i < count; i++) runIndexedStep(steps[i], i, first);
+  routineStep = count;
+}
@@ -1,70 +1,20 @@
 /**
- * Coordinates functions
+ * Pose input/output functions
  */
 #include "main.h"
 /**
- * Default initialization of an object of Coordinates class.
+ * Print a pose to the terminal (connected via usb), the bearing within 0 to 360 degrees.
+ * @param pose
+ * the pose
  */
-Controller master(E_CONTROLLER_MASTER);
-Coordinates::Coordinates(){
-  this -> x = 0;
-  this -> y = 0;
-  this -> angle = 0;
+void printPoseTerminal(const Pose<double> &pose){
+  printf("x: %.2f, y: %.2f, angle: %.2f\n", pose.x, pose.y, wrapDeg(pose.angle*toDeg));
 }
 /**
- * Initialization of an object of class Coordinates given (x, y).
- * @param x
- * x-coordinate
- *
- * @param y
- * y-coordinate
+ * Print a pose to the master controller (line 2, sent by the controllerService task), the bearing within 0 to 360 degrees.
+ * @param pose
+ * the pose
  */
-Coordinates::Coordinates(double x, double y){
-  this -> x = x;
-  this -> y = y;
-  this -> angle = 0;
-}
-/**
- * Initialization of an object of class Coordinates given (x, y, angleDeg).
- * @param x
- * x-coordinate
- *
- * @param y
- * y-coordinate
- *
- * @param angleDeg
- * bearing in degrees
- */
-Coordinates::Coordinates(double x, double y, double angleDeg){
-  this -> x = x;
-  this -> y = y;
-  this -> angle = boundRad(angleDeg*toRad);
-}
-/**
- * Set the coordinates.
- * @param x
- * to-be-set x-coordinate
- *
- * @param y
- * to-be-set y-coordinate
- *
- * @param angleDeg
- * to-be-set angleDeg
- */
-void Coordinates::setCoords(double x, double y, double angleDeg){
-  this -> x = x;
-  this -> y = y;
-  this -> angle = angleDeg*toRad;
-}
-/**
- * Print Coordinates to the terminal (connected via usb).
- */
-void Coordinates::printCoordsTerminal(){
-  printf("x: %.2f, y: %.2f, angle: %.2f\n",this->x, this->y, this->angle*toDeg);
-}
-/**
- * Print Coordinates to the master controller.
- */
-void Coordinates::printCoordsMaster(){
-  master.print(2,0,"%2.1f %2.1f %3f",this->x,this->y,this->angle*toDeg);
+void printPoseMaster(const Pose<double> &pose){
+  setDisplayLine(2, "%.1f %.1f %.0f", pose.x, pose.y, wrapDeg(pose.angle*toDeg));
 }
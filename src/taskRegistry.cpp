@@ -0,0 +1,132 @@
+/**
+ * Task registry:
+ * - Creates the robot's tasks once, in initialize(), and keeps their handles
+ *   (instead of pros::Task objects local to initialize())
+ * - Competition phase, set by the competition callbacks in main.cpp
+ * - Parks the tasks that do not run in the current phase, so only one task drives the base
+ */
+#include "main.h"
+/**
+ * The robot's tasks, indexed by RobotTaskId
+ * Odometry keeps tracking in every phase; the base controller runs in autonomous and driver control,
+ * and hands the base motors to opcontrol by a mode switch (refer to setBaseControlMode).
+ * The priorities are set in taskConfig.hpp.
+ */
+RobotTaskConfig robotTaskConfigs[ROBOT_TASKS] = {
+  {"baseOdometry", baseOdometry, PRIORITY_SENSING, TASK_STACK_DEPTH_DEFAULT, PHASE_ALL, TIMING_ODOMETRY},
+  {"baseControl", baseControl, PRIORITY_CONTROL, TASK_STACK_DEPTH_DEFAULT, PHASE_AUTON | PHASE_DRIVER, TIMING_CONTROL},
+  {"shooterControl", shooterControl, PRIORITY_MECHANISM, TASK_STACK_DEPTH_DEFAULT, PHASE_AUTON | PHASE_DRIVER, TIMING_SHOOTER},
+  {"telemetryDrain", telemetryDrain, PRIORITY_UI, TASK_STACK_DEPTH_DEFAULT, PHASE_ALL, TIMING_TELEMETRY},
+  {"controllerService", controllerService, PRIORITY_CONTROL, TASK_STACK_DEPTH_DEFAULT, PHASE_ALL, TIMING_CONTROLLER},
+  {"flightRecorder", flightRecorder, PRIORITY_LOGGING, TASK_STACK_DEPTH_DEFAULT, PHASE_ALL, TIMING_RECORDER},
+  {"resourceMonitor", resourceMonitor, PRIORITY_MONITOR, TASK_STACK_DEPTH_DEFAULT, PHASE_ALL, TIMING_MONITOR},
+  {"inputService", inputService, PRIORITY_SENSING, TASK_STACK_DEPTH_DEFAULT, PHASE_ALL, TIMING_INPUT},
+  {"dashboard", dashboard, PRIORITY_RENDER, TASK_STACK_DEPTH_DEFAULT, PHASE_ALL, TIMING_DASHBOARD},
+  {"visionService", visionService, PRIORITY_MECHANISM, TASK_STACK_DEPTH_DEFAULT, PHASE_AUTON | PHASE_DRIVER, TIMING_VISION},
+  {"motorHealth", motorHealth, PRIORITY_MONITOR, TASK_STACK_DEPTH_DEFAULT, PHASE_ALL, TIMING_HEALTH},
+  {"watchdog", watchdog, PRIORITY_WATCHDOG, TASK_STACK_DEPTH_DEFAULT, PHASE_ALL, TIMING_WATCHDOG},
+  {"coprocessor", coprocessor, PRIORITY_MECHANISM, TASK_STACK_DEPTH_DEFAULT, PHASE_ALL, TIMING_COPROC},
+  {"precompute", precompute, PRIORITY_BOOT, TASK_STACK_DEPTH_DEFAULT, PHASE_DISABLED, TIMING_PRECOMPUTE},
+  {"trajectoryStream", trajectoryStream, PRIORITY_STREAM, TASK_STACK_DEPTH_DEFAULT, PHASE_AUTON | PHASE_DRIVER, TIMING_STREAM},
+  {"poseCheckpoint", poseCheckpoint, PRIORITY_LOGGING, TASK_STACK_DEPTH_DEFAULT, PHASE_AUTON | PHASE_DRIVER, TIMING_CHECKPOINT},
+  {"motorSampler", motorSampler, PRIORITY_SENSING, TASK_STACK_DEPTH_DEFAULT, PHASE_ALL, TIMING_SNAPSHOT}
+};
+/** task handles (NULL until startRobotTasks) */
+pros::task_t robotTasks[ROBOT_TASKS];
+/** phases each task runs in (initially those of robotTaskConfigs) */
+std::atomic<uint32_t> robotTaskPhases[ROBOT_TASKS];
+/** whether each task is parked in waitTaskActive */
+std::atomic<bool> robotTaskParked[ROBOT_TASKS];
+std::atomic<uint32_t> robotPhase(PHASE_DISABLED);
+/**
+ * Create the registered tasks (once) and watch their stacks.
+ */
+void startRobotTasks(){
+  for(int i = 0; i < ROBOT_TASKS; i++){
+    if(robotTasks[i] != NULL) continue;
+    const RobotTaskConfig &config = robotTaskConfigs[i];
+    robotTaskPhases[i] = config.phases;
+    pros::Task task(config.function, (void*)"PROS", config.priority, config.stackDepth, config.name);
+    robotTasks[i] = task;
+    watchTaskStack(config.timing, task, config.stackDepth);
+  }
+}
+/**
+ * Switch to a competition phase, then wait (up to REGISTRY_HANDOVER_TIMEOUT) for the tasks
+ * that do not run in it to park, so e.g. the base is stopped once the robot is disabled.
+ * @param phase
+ * the new phase
+ */
+void enterPhase(RobotPhase phase){
+  robotPhase = phase;
+  pros::task_t self = pros::c::task_get_current();
+  Timer timer;
+  for(int i = 0; i < ROBOT_TASKS; i++){
+    if(robotTasks[i] == NULL || robotTasks[i] == self || isTaskActive((RobotTaskId)i)) continue;
+    while(!robotTaskParked[i] && !timer.passed(REGISTRY_HANDOVER_TIMEOUT)) delay(1);
+  }
+}
+/**
+ * @return
+ * the current competition phase
+ */
+RobotPhase getPhase(){
+  return (RobotPhase)robotPhase.load();
+}
+/**
+ * @param id
+ * a registered task
+ *
+ * @return
+ * whether it runs in the current phase
+ */
+bool isTaskActive(RobotTaskId id){
+  return (robotTaskPhases[id] & robotPhase) != 0;
+}
+/**
+ * Park the calling task until it runs in the current phase. Tasks call it at the top of their
+ * loop, where they hold no lock (a suspended seqlock writer would block its readers).
+ * @param id
+ * the calling task
+ *
+ * @return
+ * true if the task was parked, so it can reset its loop state
+ */
+bool waitTaskActive(RobotTaskId id){
+  if(isTaskActive(id)) return false;
+  robotTaskParked[id] = true;
+  while(!isTaskActive(id)) delay(REGISTRY_POLL_DT);
+  robotTaskParked[id] = false;
+  return true;
+}
+/**
+ * Change the phases a task runs in; 0 stops it (at the top of its next loop) until set again.
+ * @param id
+ * a registered task
+ *
+ * @param phases
+ * RobotPhase bits
+ */
+void setTaskPhases(RobotTaskId id, uint32_t phases){
+  robotTaskPhases[id] = phases;
+}
+/**
+ * @param id
+ * a started task
+ *
+ * @param priority
+ * its new priority (TASK_PRIORITY_MIN to TASK_PRIORITY_MAX)
+ */
+void setRobotTaskPriority(RobotTaskId id, uint32_t priority){
+  if(robotTasks[id] != NULL) pros::c::task_set_priority(robotTasks[id], priority);
+}
+/**
+ * @param id
+ * a registered task
+ *
+ * @return
+ * its handle (NULL before startRobotTasks)
+ */
+pros::task_t getTaskHandle(RobotTaskId id){
+  return robotTasks[id];
+}
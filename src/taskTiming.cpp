@@ -0,0 +1,230 @@
+/**
+ * Task timing:
+ * - Per-iteration execution time, wake-up lateness, overrun and deadline miss counts (histograms)
+ * - CPU share of every task over the last load window
+ * - Summaries for the terminal, the brain screen and the telemetry stream
+ */
+#include "main.h"
+TaskTiming taskTiming[TIMING_TASKS];
+const char *timedTaskNames[TIMING_TASKS] = {"odom", "control", "shooter", "telem", "controller", "recorder", "monitor", "input", "dash", "vision", "health", "watchdog", "opcontrol", "coproc", "precomp", "stream", "checkpt", "snapshot"};
+/** deadline misses already reported by reportDeadlineMisses (only used by its caller) */
+uint32_t reportedMisses[TIMING_TASKS];
+/**
+ * CPU share of every task over the last load window, in percent (written by sampleTaskLoad), and the
+ * busy times and the time of the previous sample (micros; only used by the caller of sampleTaskLoad)
+ */
+std::atomic<float> taskLoad[TIMING_TASKS];
+uint32_t loadBusy[TIMING_TASKS];
+uint64_t loadSampleTime = 0;
+/**
+ * Histogram bin of a time: the number of significant bits, so no division is needed.
+ * @param us
+ * time in micros
+ *
+ * @return
+ * the bin (0 to TIMING_BINS - 1)
+ */
+int timingBin(uint32_t us){
+  int bin = us == 0 ? 0 : 32 - __builtin_clz(us);
+  return bin < TIMING_BINS ? bin : TIMING_BINS - 1;
+}
+/**
+ * Count a sample. Only the owning task writes, so relaxed loads and stores are enough.
+ */
+void addTimingSample(std::atomic<uint32_t> *hist, std::atomic<uint32_t> &maximum, uint32_t us){
+  std::atomic<uint32_t> &bin = hist[timingBin(us)];
+  bin.store(bin.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  if(us > maximum.load(std::memory_order_relaxed)) maximum.store(us, std::memory_order_relaxed);
+}
+/**
+ * Start the timing of a task; call once before its loop.
+ * @param task
+ * the task
+ *
+ * @param periodMs
+ * loop period in ms
+ *
+ * @param fixedRate
+ * true if the loop uses delay_until (or a periodic notification), false if it uses delay
+ */
+void startTaskTiming(TimedTask task, uint32_t periodMs, bool fixedRate){
+  TaskTiming &timing = taskTiming[task];
+  timing.period = periodMs*1000;
+  timing.fixedRate = fixedRate;
+  timing.expectedWake = 0;
+}
+/**
+ * Mark the start of an iteration; call right after the task wakes. A fixed rate task that wakes a whole
+ * period late restarts its schedule: the periods it slept through are one deadline miss, not a miss for
+ * every iteration after it (a task woken by notifications never catches up).
+ * @param task
+ * the task
+ */
+void beginTaskIteration(TimedTask task){
+  TaskTiming &timing = taskTiming[task];
+  uint64_t now = micros();
+  if(timing.expectedWake != 0){
+    uint32_t late = now > timing.expectedWake ? now - timing.expectedWake : 0;
+    addTimingSample(timing.lateHist, timing.maxLate, late);
+  }
+  timing.wakeTime = now;
+  timing.releaseTime = timing.expectedWake != 0 ? timing.expectedWake : now;
+  if(timing.fixedRate) timing.expectedWake = (timing.expectedWake == 0 || now >= timing.expectedWake + timing.period ? now : timing.expectedWake) + timing.period;
+  if(TIMELINE_TASK_MASK & (1u << task)) recordTimeline(TIMELINE_TASK_BEGIN, task, 0, now);
+}
+/**
+ * Mark the end of an iteration; call right before the task sleeps.
+ * @param task
+ * the task
+ */
+void endTaskIteration(TimedTask task){
+  TaskTiming &timing = taskTiming[task];
+  uint64_t now = micros();
+  uint32_t exec = now - timing.wakeTime;
+  addTimingSample(timing.execHist, timing.maxExec, exec);
+  timing.iterations.store(timing.iterations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  timing.busyTime.store(timing.busyTime.load(std::memory_order_relaxed) + exec, std::memory_order_relaxed);
+  if(exec > timing.period) timing.overruns.store(timing.overruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  uint64_t deadline = timing.releaseTime + timing.period;
+  if(now > deadline){
+    timing.misses.store(timing.misses.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if(now - deadline > timing.maxMiss.load(std::memory_order_relaxed)) timing.maxMiss.store(now - deadline, std::memory_order_relaxed);
+  }
+  if(!timing.fixedRate) timing.expectedWake = now + timing.period;
+  if(TIMELINE_TASK_MASK & (1u << task)) recordTimeline(TIMELINE_TASK_END, task, 0, now);
+}
+/**
+ * @return
+ * the upper bound of the bin holding the 99th percentile of a histogram (micros)
+ */
+uint32_t timingPercentile99(const std::atomic<uint32_t> *hist){
+  uint32_t counts[TIMING_BINS], total = 0;
+  for(int i = 0; i < TIMING_BINS; i++) total += counts[i] = hist[i].load(std::memory_order_relaxed);
+  uint32_t target = total - total/100, sum = 0;
+  for(int i = 0; i < TIMING_BINS; i++){
+    sum += counts[i];
+    if(sum >= target && sum > 0) return i == 0 ? 0 : (1u << i) - 1;
+  }
+  return 0;
+}
+/**
+ * Summarize the statistics of a task (any task may call it).
+ * @param task
+ * the task
+ *
+ * @return
+ * the summary
+ */
+TaskTimingSummary getTaskTiming(TimedTask task){
+  TaskTiming &timing = taskTiming[task];
+  TaskTimingSummary summary;
+  summary.iterations = timing.iterations.load(std::memory_order_relaxed);
+  summary.overruns = timing.overruns.load(std::memory_order_relaxed);
+  summary.misses = timing.misses.load(std::memory_order_relaxed);
+  summary.maxMiss = timing.maxMiss.load(std::memory_order_relaxed);
+  summary.p99Exec = timingPercentile99(timing.execHist);
+  summary.maxExec = timing.maxExec.load(std::memory_order_relaxed);
+  summary.p99Late = timingPercentile99(timing.lateHist);
+  summary.maxLate = timing.maxLate.load(std::memory_order_relaxed);
+  return summary;
+}
+/**
+ * Read the heartbeat of a task (any task may call it).
+ * @param task
+ * the task
+ *
+ * @return
+ * its iteration and deadline miss counts, and its period
+ */
+TaskHeartbeat getTaskHeartbeat(TimedTask task){
+  TaskTiming &timing = taskTiming[task];
+  return {timing.iterations.load(std::memory_order_relaxed), timing.misses.load(std::memory_order_relaxed), timing.period};
+}
+/**
+ * Close the load window: the CPU share of every task is its execution time since the previous call over the
+ * time since then (only one task may call it; the telemetry drain does, every TIMING_REPORT_DT).
+ * The execution time runs from the wake-up to the end of the iteration, so it includes the time a task
+ * spends preempted by higher priority tasks: the shares are upper bounds, exact for the highest priority.
+ */
+void sampleTaskLoad(){
+  uint64_t now = micros();
+  for(int i = 0; i < TIMING_TASKS; i++){
+    uint32_t busy = taskTiming[i].busyTime.load(std::memory_order_relaxed);
+    if(loadSampleTime != 0 && now > loadSampleTime) taskLoad[i].store((uint32_t)(busy - loadBusy[i])*100.0/(now - loadSampleTime), std::memory_order_relaxed);
+    loadBusy[i] = busy;
+  }
+  loadSampleTime = now;
+}
+/**
+ * CPU share of a task over the last load window (any task may call it).
+ * @param task
+ * the task
+ *
+ * @return
+ * percent of the CPU time (refer to sampleTaskLoad)
+ */
+double getTaskLoad(TimedTask task){
+  return taskLoad[task].load(std::memory_order_relaxed);
+}
+/**
+ * @return
+ * summed CPU share of the instrumented tasks over the last load window, in percent (100 less it is the headroom)
+ */
+double getTotalTaskLoad(){
+  double total = 0;
+  for(int i = 0; i < TIMING_TASKS; i++) total += getTaskLoad((TimedTask)i);
+  return total;
+}
+/**
+ * Print the summaries and the execution time histograms to the terminal (blocking).
+ */
+void printTaskTiming(){
+  for(int i = 0; i < TIMING_TASKS; i++){
+    TaskTimingSummary s = getTaskTiming((TimedTask)i);
+    printf("%-8s n %u over %u miss %u (max %u) exec p99 %u max %u late p99 %u max %u cpu %.1f%%\n", timedTaskNames[i],
+      (unsigned)s.iterations, (unsigned)s.overruns, (unsigned)s.misses, (unsigned)s.maxMiss,
+      (unsigned)s.p99Exec, (unsigned)s.maxExec, (unsigned)s.p99Late, (unsigned)s.maxLate, getTaskLoad((TimedTask)i));
+    printf("  exec:");
+    for(int b = 0; b < TIMING_BINS; b++) printf(" %u", (unsigned)taskTiming[i].execHist[b].load(std::memory_order_relaxed));
+    printf("\n");
+  }
+}
+/**
+ * Show the summaries on the brain screen (one line per task).
+ */
+void showTaskTiming(){
+  if(!lcd::is_initialized()) lcd::initialize();
+  for(int i = 0; i < TIMING_TASKS; i++){
+    TaskTimingSummary s = getTaskTiming((TimedTask)i);
+    lcd::print(i, "%-8s miss %u exec %u/%u late %u/%u us", timedTaskNames[i],
+      (unsigned)s.misses, (unsigned)s.p99Exec, (unsigned)s.maxExec, (unsigned)s.p99Late, (unsigned)s.maxLate);
+  }
+}
+/**
+ * Push the summaries to the telemetry buffer (one TELEMETRY_TIMING record per task).
+ */
+void reportTaskTiming(){
+  for(int i = 0; i < TIMING_TASKS; i++){
+    TaskTimingSummary s = getTaskTiming((TimedTask)i);
+    pushTelemetry(TELEMETRY_TIMING, i, s.overruns, s.p99Exec, s.maxExec, s.p99Late, s.maxLate);
+  }
+}
+/**
+ * Push a TELEMETRY_DEADLINE record for every task that missed deadlines since the last call
+ * (only one task may call it; the telemetry drain does, every TIMING_REPORT_DT).
+ */
+void reportDeadlineMisses(){
+  for(int i = 0; i < TIMING_TASKS; i++){
+    TaskTimingSummary s = getTaskTiming((TimedTask)i);
+    if(s.misses == reportedMisses[i]) continue;
+    pushTelemetry(TELEMETRY_DEADLINE, i, s.misses - reportedMisses[i], s.misses, s.maxMiss);
+    reportedMisses[i] = s.misses;
+  }
+}
+/**
+ * Push the CPU shares of the last load window to the telemetry buffer (one TELEMETRY_LOAD record per task).
+ */
+void reportTaskLoad(){
+  double total = getTotalTaskLoad();
+  for(int i = 0; i < TIMING_TASKS; i++) pushTelemetry(TELEMETRY_LOAD, i, getTaskLoad((TimedTask)i), total);
+}
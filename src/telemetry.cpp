@@ -0,0 +1,176 @@
+/**
+ * Telemetry:
+ * - Lock-free, preallocated ring buffer of binary records (any number of producer tasks)
+ * - Drain task that formats or streams the records away from the control loops
+ */
+#include "main.h"
+/**
+ * Bounded multi-producer ring buffer: each slot carries a sequence number telling
+ * whether it is free for the producer at position pos (sequence == pos)
+ * or holds a record for the consumer (sequence == pos + 1).
+ * Producers claim positions with a compare-and-swap; a full buffer drops the record.
+ */
+struct TelemetrySlot{
+  std::atomic<uint32_t> sequence;
+  TelemetryRecord record;
+};
+struct TelemetryRing{
+  TelemetrySlot slots[TELEMETRY_SIZE];
+  std::atomic<uint32_t> pushPos;
+  /** only moved by the drain task */
+  uint32_t popPos;
+  std::atomic<uint32_t> drops;
+  TelemetryRing() : pushPos(0), popPos(0), drops(0){
+    for(uint32_t i = 0; i < TELEMETRY_SIZE; i++) slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+};
+TelemetryRing telemetry;
+/**
+ * Push a record from any task. Never blocks; takes a few hundred nanoseconds.
+ * @param type
+ * record type
+ *
+ * @param v0 - v5 (optional. default = 0)
+ * values of the record (refer to TelemetryType)
+ *
+ * @return
+ * false if the buffer is full (the record is dropped and counted)
+ */
+bool pushTelemetry(TelemetryType type, float v0, float v1, float v2, float v3, float v4, float v5){
+  uint32_t pos = telemetry.pushPos.load(std::memory_order_relaxed);
+  TelemetrySlot *slot;
+  while(true){
+    slot = &telemetry.slots[pos%TELEMETRY_SIZE];
+    int32_t diff = (int32_t)(slot->sequence.load(std::memory_order_acquire) - pos);
+    if(diff == 0){
+      /** slot free: claim the position */
+      if(telemetry.pushPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+    }
+    else if(diff < 0){
+      /** slot still holds an unread record: full */
+      telemetry.drops.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    else pos = telemetry.pushPos.load(std::memory_order_relaxed);
+  }
+  slot->record.timestamp = (uint32_t)micros();
+  slot->record.type = type;
+  float values[6] = {v0, v1, v2, v3, v4, v5};
+  for(int i = 0; i < 6; i++) slot->record.values[i] = values[i];
+  /** hand the slot to the drain task */
+  slot->sequence.store(pos + 1, std::memory_order_release);
+  return true;
+}
+/**
+ * Pop the oldest record. Only called by the drain task (single consumer).
+ * @param record
+ * set to the popped record
+ *
+ * @return
+ * false if the buffer is empty
+ */
+bool popTelemetry(TelemetryRecord &record){
+  TelemetrySlot *slot = &telemetry.slots[telemetry.popPos%TELEMETRY_SIZE];
+  if((int32_t)(slot->sequence.load(std::memory_order_acquire) - (telemetry.popPos + 1)) < 0) return false;
+  record = slot->record;
+  /** free the slot for the producer one lap later */
+  slot->sequence.store(telemetry.popPos + TELEMETRY_SIZE, std::memory_order_release);
+  telemetry.popPos++;
+  return true;
+}
+/**
+ * @return
+ * number of records dropped because the buffer was full
+ */
+uint32_t getTelemetryDrops(){
+  return telemetry.drops.load(std::memory_order_relaxed);
+}
+/**
+ * Print one record in the format of the old debugging output.
+ * @param record
+ * the record
+ */
+void printTelemetry(const TelemetryRecord &record){
+  switch(record.type){
+    case TELEMETRY_POSE: printf("x: %.2f, y: %.2f, angle: %.2f\n", record.values[0], record.values[1], record.values[2]); break;
+    case TELEMETRY_ERROR: printf("Error: %f %f\n", record.values[0], record.values[1]); break;
+    case TELEMETRY_POWER: printf("%4.0f \t %4.0f\n", record.values[0], record.values[1]); break;
+    case TELEMETRY_ENCODERS: printf("Encoder values %4d \t %4d\n", (int)record.values[0], (int)record.values[1]); break;
+    case TELEMETRY_TIMING: printf("Task %d: over %d exec %d/%d late %d/%d us\n", (int)record.values[0], (int)record.values[1],
+      (int)record.values[2], (int)record.values[3], (int)record.values[4], (int)record.values[5]); break;
+    case TELEMETRY_STACK: printf("Task %d: stack %d of %d bytes free\n", (int)record.values[0], (int)record.values[1], (int)record.values[2]); break;
+    case TELEMETRY_HEAP: printf("Heap: %.0f bytes free, %.0f least\n", record.values[0], record.values[1]); break;
+    case TELEMETRY_DEADLINE: printf("Task %d: %d deadline misses (%d total, up to %d us late)\n", (int)record.values[0],
+      (int)record.values[1], (int)record.values[2], (int)record.values[3]); break;
+    case TELEMETRY_JAM: printf("Jam on port %d: %d mA at %.0f rpm\n", (int)record.values[0], (int)record.values[1], record.values[2]); break;
+    case TELEMETRY_SLIP: printf("Slip L %.2f R %.2f in/s, failed tracking wheels %d, odometry from %s\n", record.values[0], record.values[1],
+      (int)record.values[2], getOdometrySourceName((OdometrySource)record.values[3])); break;
+    case TELEMETRY_DISPLAY: printf("Display: %.0f bytes, kernel heap %.0f bytes free, %.0f least\n", record.values[0],
+      record.values[1], record.values[2]); break;
+    case TELEMETRY_ARENA: printf("Arena: %.0f bytes used, %.0f peak, %d failed allocations\n", record.values[0],
+      record.values[1], (int)record.values[2]); break;
+    case TELEMETRY_STREAM: printf("Stream: %d chunks read, %d underruns, %d failed reads, slowest read %.0f us\n",
+      (int)record.values[0], (int)record.values[1], (int)record.values[2], record.values[3]); break;
+    case TELEMETRY_BATTERY: printf("Battery: %.0f mV open, %.0f mOhm, %.0f mV at %.0f mA\n", record.values[0], record.values[1]*1000,
+      record.values[2], record.values[3]); break;
+    case TELEMETRY_MOTOR: printf("Motor on port %d: %.0f C, %.0f mA, derated to %.2f\n", (int)record.values[0], record.values[1],
+      record.values[2], record.values[3]); break;
+    case TELEMETRY_LATENCY: printf("Latency port %d (%d steps): velocity %d/%d/%d us, encoder %d us\n", (int)record.values[0],
+      (int)record.values[1], (int)record.values[2], (int)record.values[3], (int)record.values[4], (int)record.values[5]); break;
+    case TELEMETRY_STOP: printf("Stop: settled %d ms after the profile (%.2f in/s at its end, braked %d ms)\n", (int)record.values[0],
+      record.values[1], (int)record.values[2]); break;
+    case TELEMETRY_WATCHDOG: printf("Watchdog: %s %s, %d ms since its last iteration, %d deadline misses%s\n",
+      (int)record.values[0] < TIMING_TASKS? timedTaskNames[(int)record.values[0]] : "task", record.values[1] == WATCHDOG_SILENT? "silent" : "late",
+      (int)record.values[2], (int)record.values[3], record.values[4] != 0? ", base stopped" : ""); break;
+    case TELEMETRY_LOAD: printf("Task %s: %.1f%% CPU (instrumented tasks %.1f%%)\n",
+      (int)record.values[0] < TIMING_TASKS? timedTaskNames[(int)record.values[0]] : "task", record.values[1], record.values[2]); break;
+    case TELEMETRY_BOOT: printf("Boot: %s at %.1f ms (+%.1f ms)\n", getBootMarkName((BootMark)record.values[0]),
+      record.values[1], record.values[2]); break;
+    case TELEMETRY_CYCLE: printf("Cycle: %d ms, %d shots (%d ms from intake), indexing %d ms, spin-up %d ms, stalled %d ms\n",
+      (int)record.values[0], (int)record.values[1], (int)record.values[2], (int)record.values[3], (int)record.values[4],
+      (int)record.values[5]); break;
+  }
+}
+/**
+ * Drain the telemetry buffer: the only place where telemetry is written out,
+ * so the (blocking) serial output never delays the control loops. Also takes the parameter
+ * commands received on the same link.
+ * Run at low priority.
+ */
+void telemetryDrain(void * ignore){
+  uint32_t reportedDrops = 0;
+  TelemetryRecord record;
+  uint32_t timingReport = millis();
+  if(TELEMETRY_FORMAT == TELEMETRY_FRAMED || TELEMETRY_FORMAT == TELEMETRY_DELTA) initTelemetrySerial();
+  startTaskTiming(TIMING_TELEMETRY, TELEMETRY_DRAIN_DT, false);
+  while(true){
+    beginTaskIteration(TIMING_TELEMETRY);
+    while(popTelemetry(record)){
+      if(TELEMETRY_FORMAT == TELEMETRY_FRAMED || TELEMETRY_FORMAT == TELEMETRY_DELTA) writeTelemetryFrame(record);
+      else if(TELEMETRY_FORMAT == TELEMETRY_RAW) fwrite(&record, sizeof(record), 1, stdout);
+      else printTelemetry(record);
+    }
+    uint32_t drops = getTelemetryDrops();
+    if(TELEMETRY_FORMAT == TELEMETRY_TEXT && drops != reportedDrops){
+      printf("Telemetry: %u records dropped\n", (unsigned)(drops - reportedDrops));
+      reportedDrops = drops;
+    }
+    /** parameter changes from the serial terminal (refer to paramTable.hpp) */
+    pollParamCommands();
+    /** instants of the start, once each */
+    reportBootMarks();
+    /** task timing report (the deadline misses and the CPU shares in every mode) */
+    if(millis() - timingReport >= TIMING_REPORT_DT){
+      timingReport = millis();
+      reportDeadlineMisses();
+      sampleTaskLoad();
+      if constexpr(TracePoint<TRACE_TIMING>::enabled){
+        reportTaskTiming();
+        reportTaskLoad();
+        showTaskTiming();
+      }
+    }
+    endTaskIteration(TIMING_TELEMETRY);
+    delay(TELEMETRY_DRAIN_DT);
+  }
+}
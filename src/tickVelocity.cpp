@@ -0,0 +1,50 @@
+/**
+ * Velocity estimate of an encoder from the timing of its ticks (refer to tickVelocity.hpp)
+ */
+#include "main.h"
+/**
+ * Step the estimate with a sample of the encoder.
+ * @param estimate
+ * state of the estimate (zeroed to start over)
+ *
+ * @param count
+ * count of the encoder
+ *
+ * @param time
+ * time of the sample (micros); a sample no later than the previous one changes nothing
+ *
+ * @return
+ * the estimate in ticks per second
+ */
+HOT_PATH double stepTickVelocity(TickVelocity &estimate, int32_t count, uint64_t time){
+  if(estimate.time == 0){
+    estimate = {count, count, time, time, 0};
+    return 0;
+  }
+  if(time <= estimate.time) return estimate.velocity;
+  int32_t delta = count - estimate.count;
+  if(abs(delta) >= TICK_VEL_SWITCH){
+    /** fast: the difference over the sample */
+    estimate.velocity = delta*1e6/(time - estimate.time);
+    estimate.edgeCount = count;
+    estimate.edgeTime = time;
+  }
+  else if(delta != 0){
+    /** the ticks since the latest tick, over the time between them (the tick came during the sample) */
+    uint64_t edgeTime = (estimate.time + time)/2;
+    int32_t ticks = count - estimate.edgeCount;
+    /** turned around since the latest tick: the velocity went through 0 */
+    estimate.velocity = (int64_t)ticks*delta > 0 && edgeTime > estimate.edgeTime? ticks*1e6/(edgeTime - estimate.edgeTime) : 0;
+    estimate.edgeCount = count;
+    estimate.edgeTime = edgeTime;
+  }
+  else if(time - estimate.edgeTime >= TICK_VEL_TIMEOUT) estimate.velocity = 0;
+  else{
+    /** no tick yet: the encoder is no faster than a tick over the time since the latest one */
+    double bound = 1e6/(time - estimate.edgeTime);
+    estimate.velocity = fmax(fmin(estimate.velocity, bound), -bound);
+  }
+  estimate.count = count;
+  estimate.time = time;
+  return estimate.velocity;
+}
@@ -0,0 +1,80 @@
+/**
+ * Timing functions:
+ * - microsecond timer
+ * - Stopwatch & fixed rate loop period
+ */
+#include "main.h"
+/**
+ * PROS 3.2 does not wrap the high resolution system timer,
+ * so declare the VEXos function that libpros.a already links against.
+ */
+extern "C" uint64_t vexSystemHighResTimeGet(void);
+/**
+ * Retrieve the time since the brain booted.
+ * @return
+ * time in microseconds
+ */
+uint64_t micros(){
+  return vexSystemHighResTimeGet();
+}
+/**
+ * Start the stopwatch.
+ */
+Timer::Timer() : start(millis()){}
+/**
+ * Restart the stopwatch from now.
+ */
+void Timer::reset(){
+  start = millis();
+}
+/**
+ * @return
+ * ms since the start
+ */
+uint32_t Timer::elapsed() const{
+  return millis() - start;
+}
+/**
+ * @param ms
+ * a duration in ms
+ *
+ * @return
+ * true once the duration has passed since the start
+ */
+bool Timer::passed(uint32_t ms) const{
+  return elapsed() >= ms;
+}
+/**
+ * Schedule the loop from now.
+ * @param period
+ * period in ms
+ */
+LoopRate::LoopRate(uint32_t period) : period(period), wake(millis()), ticks(0){}
+/**
+ * Schedule the next period from now (e.g. after the task was parked or slept), without a catch-up.
+ */
+void LoopRate::restart(){
+  wake = millis();
+}
+/**
+ * Wait until a period after the previous wake-up (at once if that has passed), and count a tick.
+ */
+void LoopRate::wait(){
+  Task::delay_until(&wake, period);
+  ticks++;
+}
+/**
+ * Move the schedule, e.g. to phase lock the loop to a sensor's updates.
+ * @param ms
+ * shift of the next and later wake-ups in ms (negative: earlier)
+ */
+void LoopRate::shift(int32_t ms){
+  wake += ms;
+}
+/**
+ * @return
+ * periods waited since construction
+ */
+uint32_t LoopRate::getTicks() const{
+  return ticks;
+}
@@ -0,0 +1,304 @@
+/**
+ * Timeline:
+ * - Lock-free ring buffer of timeline events (any number of producer tasks, never blocks)
+ * - Timeline files, written by the flight recorder task next to its run files
+ * - Export of a timeline file to a Chrome trace_event file
+ */
+#include "main.h"
+/**
+ * Bounded multi-producer ring buffer, same scheme as the telemetry buffer (refer to telemetry.cpp):
+ * a slot is free for the producer at position pos when its sequence is pos, and holds an event
+ * for the consumer when it is pos + 1. A full buffer drops the event.
+ */
+struct TimelineSlot{
+  std::atomic<uint32_t> sequence;
+  TimelineEvent event;
+};
+struct TimelineRing{
+  TimelineSlot slots[TIMELINE_SIZE];
+  std::atomic<uint32_t> pushPos;
+  /** only moved by the flight recorder task */
+  uint32_t popPos;
+  std::atomic<uint32_t> drops;
+  TimelineRing() : pushPos(0), popPos(0), drops(0){
+    for(uint32_t i = 0; i < TIMELINE_SIZE; i++) slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+};
+TimelineRing timeline;
+/** events are accepted (while a timeline file is open) */
+std::atomic<bool> timelineOn(false);
+/** names of the mechanisms and of their states (refer to setTimelineMechanism) */
+struct TimelineMechanism{
+  const char *name;
+  const char *const *states;
+  int stateCount;
+};
+TimelineMechanism timelineMechanisms[TIMELINE_MECHANISMS];
+const char *timelineMotionNames[] = {"move", "move to", "turn", "turn to", "turn relative", "pursuit", "trajectory", "arc", "arc to", "swing", "move to pose"};
+const char *timelineWaitNames[] = {"waitBase", "waitMotionQueue", "waitShooter"};
+const char *timelineEndNames[] = {"settled", "timed out", "chained", "cleared", "exited early", "skipped", "aborted"};
+const char *timelineImpactNames[] = {"impact", "collision", "tip"};
+const char *timelineWatchdogNames[] = {"watchdog", "watchdog: silent", "watchdog: late"};
+/**
+ * Trace tracks (Chrome thread ids): one per timed task, then the motions, the waits and the mechanisms
+ */
+#define TIMELINE_TRACK_MOTION TIMING_TASKS
+#define TIMELINE_TRACK_WAIT (TIMING_TASKS + 1)
+#define TIMELINE_TRACK_MECHANISM (TIMING_TASKS + 2)
+#define TIMELINE_TRACKS (TIMELINE_TRACK_MECHANISM + TIMELINE_MECHANISMS)
+/**
+ * Name a mechanism and its states in the exported traces (call once, e.g. when its task starts).
+ * @param id
+ * the mechanism (0 to TIMELINE_MECHANISMS - 1), the id of its TIMELINE_MECHANISM events
+ *
+ * @param name
+ * name of the mechanism
+ *
+ * @param states
+ * names of its states, indexed by the arg of its events (must stay valid)
+ *
+ * @param stateCount
+ * number of states
+ */
+void setTimelineMechanism(int id, const char *name, const char *const *states, int stateCount){
+  if(id < 0 || id >= TIMELINE_MECHANISMS) return;
+  timelineMechanisms[id] = {name, states, stateCount};
+}
+/**
+ * Push an event from any task. Never blocks; does nothing unless a run is being recorded.
+ * @param type
+ * event type
+ *
+ * @param id
+ * id of the event (refer to TimelineType)
+ *
+ * @param arg (optional. default = 0)
+ * argument of the event (refer to TimelineType)
+ *
+ * @param time (optional. default = 0)
+ * micros() of the event if the caller already has it, 0 for now
+ *
+ * @return
+ * false if nothing is recorded or the buffer is full (the event is dropped and counted)
+ */
+bool recordTimeline(TimelineType type, int id, int arg, uint32_t time){
+  /** a dry run logs the routine's motions and waits whether or not the run is recorded */
+  if(isDryRun()) logDryRunEvent(type, id, arg, time != 0 ? time : (uint32_t)micros());
+  if(!timelineOn.load(std::memory_order_relaxed)) return false;
+  uint32_t pos = timeline.pushPos.load(std::memory_order_relaxed);
+  TimelineSlot *slot;
+  while(true){
+    slot = &timeline.slots[pos%TIMELINE_SIZE];
+    int32_t diff = (int32_t)(slot->sequence.load(std::memory_order_acquire) - pos);
+    if(diff == 0){
+      if(timeline.pushPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+    }
+    else if(diff < 0){
+      timeline.drops.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    else pos = timeline.pushPos.load(std::memory_order_relaxed);
+  }
+  slot->event = {time != 0 ? time : (uint32_t)micros(), (uint8_t)type, (uint8_t)id, (uint16_t)arg};
+  slot->sequence.store(pos + 1, std::memory_order_release);
+  return true;
+}
+/**
+ * Pop the oldest event. Only called by the flight recorder task (single consumer).
+ * @return
+ * false if the buffer is empty
+ */
+bool popTimeline(TimelineEvent &event){
+  TimelineSlot *slot = &timeline.slots[timeline.popPos%TIMELINE_SIZE];
+  if((int32_t)(slot->sequence.load(std::memory_order_acquire) - (timeline.popPos + 1)) < 0) return false;
+  event = slot->event;
+  slot->sequence.store(timeline.popPos + TIMELINE_SIZE, std::memory_order_release);
+  timeline.popPos++;
+  return true;
+}
+/**
+ * @return
+ * number of events dropped because the buffer was full
+ */
+uint32_t getTimelineDrops(){
+  return timeline.drops.load(std::memory_order_relaxed);
+}
+/**
+ * Open the timeline file of a run, write its header and start accepting events.
+ * Only called by the flight recorder task.
+ * @param run
+ * number of the run file
+ *
+ * @return
+ * the file, or NULL if it cannot be opened
+ */
+FILE *openTimelineFile(int run){
+  char path[64];
+  snprintf(path, sizeof(path), TIMELINE_PATH, run);
+  FILE *file = fopen(path, "wb");
+  if(file == NULL) return NULL;
+  TimelineFileHeader header = {TIMELINE_FILE_MAGIC, TIMELINE_FILE_VERSION, sizeof(TimelineEvent)};
+  fwrite(&header, sizeof(header), 1, file);
+  /** drop the events pushed while the previous file was being closed */
+  TimelineEvent event;
+  while(popTimeline(event));
+  timelineOn = true;
+  return file;
+}
+/**
+ * Write the buffered events to the file and make them persistent.
+ * Only called by the flight recorder task.
+ */
+void writeTimeline(FILE *file){
+  TimelineEvent events[64];
+  int count = 0;
+  while(true){
+    bool more = popTimeline(events[count]);
+    if(more) count++;
+    if(count == 64 || (!more && count > 0)){
+      if(file != NULL) fwrite(events, sizeof(TimelineEvent), count, file);
+      count = 0;
+    }
+    if(!more) break;
+  }
+  if(file != NULL) fflush(file);
+}
+/**
+ * Stop accepting events, write the buffered ones and close the file.
+ * Only called by the flight recorder task.
+ */
+void closeTimelineFile(FILE *file){
+  timelineOn = false;
+  writeTimeline(file);
+  if(file != NULL) fclose(file);
+}
+/**
+ * Write one trace event.
+ * @param first
+ * whether it is the first event of the file (no separating comma)
+ *
+ * @param args
+ * JSON object of the arguments, NULL for none
+ */
+void writeTraceEvent(FILE *file, bool &first, const char *name, char phase, uint64_t ts, int track, const char *args = NULL){
+  fprintf(file, "%s\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%llu,\"pid\":1,\"tid\":%d%s%s}", first ? "" : ",", name, phase,
+    (unsigned long long)ts, track, args != NULL ? ",\"args\":" : "", args != NULL ? args : "");
+  first = false;
+}
+/**
+ * Export a timeline file to a Chrome trace_event file: a track per task with a slice per iteration
+ * (preemption shows as a slice outliving a higher priority one), then a track of the queued motions (and the impacts),
+ * one of the waits of the autonomous code and one per mechanism with a slice per state.
+ * Slices still open at the end of the file are closed at its last event.
+ * @param path
+ * the timeline file
+ *
+ * @param tracePath
+ * the trace file to write
+ *
+ * @return
+ * number of events exported, -1 if the timeline cannot be read or the trace cannot be written
+ */
+int exportTimeline(const char *path, const char *tracePath){
+  FILE *file = fopen(path, "rb");
+  if(file == NULL) return -1;
+  TimelineFileHeader header;
+  if(fread(&header, sizeof(header), 1, file) != 1 || header.magic != TIMELINE_FILE_MAGIC
+    || header.version != TIMELINE_FILE_VERSION || header.eventSize != sizeof(TimelineEvent)){
+    fclose(file);
+    return -1;
+  }
+  FILE *trace = fopen(tracePath, "w");
+  if(trace == NULL){
+    fclose(file);
+    return -1;
+  }
+  fprintf(trace, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+  bool first = true;
+  char args[64];
+  /** track names, in the order of the tracks */
+  for(int track = 0; track < TIMELINE_TRACKS; track++){
+    const char *name = track < TIMING_TASKS ? timedTaskNames[track] : track == TIMELINE_TRACK_MOTION ? "motions"
+      : track == TIMELINE_TRACK_WAIT ? "waits" : timelineMechanisms[track - TIMELINE_TRACK_MECHANISM].name;
+    if(name == NULL) continue;
+    snprintf(args, sizeof(args), "{\"name\":\"%s\"}", name);
+    writeTraceEvent(trace, first, "thread_name", 'M', 0, track, args);
+    snprintf(args, sizeof(args), "{\"sort_index\":%d}", track);
+    writeTraceEvent(trace, first, "thread_sort_index", 'M', 0, track, args);
+  }
+  /** open slice of each track, and the name it was opened with (for its end) */
+  const char *open[TIMELINE_TRACKS] = {};
+  TimelineEvent event;
+  uint32_t last = 0;
+  uint64_t ts = 0;
+  int count = 0;
+  while(fread(&event, sizeof(event), 1, file) == 1){
+    /** micros relative to the first event (the 32 bit timestamps wrap, and tasks push slightly out of order) */
+    if(count++ > 0) ts += (int32_t)(event.time - last);
+    last = event.time;
+    const char *name = NULL;
+    int track = -1;
+    switch(event.type){
+      case TIMELINE_TASK_BEGIN:
+      case TIMELINE_TASK_END:
+        if(event.id >= TIMING_TASKS) continue;
+        track = event.id;
+        name = timedTaskNames[event.id];
+        args[0] = 0;
+        break;
+      case TIMELINE_MOTION_START:
+      case TIMELINE_MOTION_END:
+        track = TIMELINE_TRACK_MOTION;
+        name = event.id < sizeof(timelineMotionNames)/sizeof(*timelineMotionNames) ? timelineMotionNames[event.id] : "motion";
+        if(event.type == TIMELINE_MOTION_START) snprintf(args, sizeof(args), "{\"motion\":%u}", (unsigned)event.arg);
+        else snprintf(args, sizeof(args), "{\"end\":\"%s\"}", event.arg < sizeof(timelineEndNames)/sizeof(*timelineEndNames) ? timelineEndNames[event.arg] : "?");
+        break;
+      case TIMELINE_WAIT_BEGIN:
+      case TIMELINE_WAIT_END:
+        track = TIMELINE_TRACK_WAIT;
+        name = event.id < sizeof(timelineWaitNames)/sizeof(*timelineWaitNames) ? timelineWaitNames[event.id] : "wait";
+        if(event.type == TIMELINE_WAIT_END) snprintf(args, sizeof(args), "{\"timed out\":%s}", event.arg ? "true" : "false");
+        else args[0] = 0;
+        break;
+      case TIMELINE_MECHANISM:{
+        if(event.id >= TIMELINE_MECHANISMS) continue;
+        const TimelineMechanism &mechanism = timelineMechanisms[event.id];
+        track = TIMELINE_TRACK_MECHANISM + event.id;
+        name = event.arg < mechanism.stateCount ? mechanism.states[event.arg] : "state";
+        args[0] = 0;
+        break;
+      }
+      case TIMELINE_IMPACT:
+        /** an instant on the motions track */
+        snprintf(args, sizeof(args), "{\"aborted\":%s}", event.arg ? "true" : "false");
+        writeTraceEvent(trace, first, event.id < sizeof(timelineImpactNames)/sizeof(*timelineImpactNames) ? timelineImpactNames[event.id]
+          : "impact", 'i', ts, TIMELINE_TRACK_MOTION, args);
+        continue;
+      case TIMELINE_WATCHDOG:
+        /** an instant on the faulted task's track */
+        if(event.id >= TIMING_TASKS) continue;
+        writeTraceEvent(trace, first, event.arg < sizeof(timelineWatchdogNames)/sizeof(*timelineWatchdogNames)
+          ? timelineWatchdogNames[event.arg] : "watchdog", 'i', ts, event.id);
+        continue;
+      default: continue;
+    }
+    bool begin = event.type == TIMELINE_TASK_BEGIN || event.type == TIMELINE_MOTION_START || event.type == TIMELINE_WAIT_BEGIN
+      || event.type == TIMELINE_MECHANISM;
+    /** a mechanism state ends where the next starts; an end without its beginning (before the file) is skipped */
+    if(open[track] != NULL && (!begin || event.type == TIMELINE_MECHANISM)){
+      writeTraceEvent(trace, first, open[track], 'E', ts, track, !begin && args[0] != 0 ? args : NULL);
+      open[track] = NULL;
+    }
+    if(begin){
+      writeTraceEvent(trace, first, name, 'B', ts, track, args[0] != 0 ? args : NULL);
+      open[track] = name;
+    }
+  }
+  for(int track = 0; track < TIMELINE_TRACKS; track++){
+    if(open[track] != NULL) writeTraceEvent(trace, first, open[track], 'E', ts, track);
+  }
+  fprintf(trace, "\n]}\n");
+  fclose(file);
+  fclose(trace);
+  return count;
+}
@@ -0,0 +1,818 @@
+/**
+ * Trajectory cache:
+ * - Generation of tank trajectories with pathfinder (initialization only)
+ * - Time-optimal velocity planning along the generated path (curvature and side limits)
+ * - Side kinematics of planned trajectories in batches (NEON on the V5)
+ * - Packing of the side trajectories (float position, scaled int16 velocity & acceleration)
+ * - Saving & loading of trajectories on the microSD card, or reading them from the baked blob
+ * - Streamed trajectories, generated to the microSD card and read back a chunk at a time (refer to trajectoryStream.hpp)
+ * - Mirrored & backwards variants that share the segments of a cached trajectory
+ * - Lookup of cached trajectories (segments in the motion arena, cleared between routines)
+ * - Sampling of cached trajectories at a time, between their segments
+ * - Replay of cached trajectories through baseControl (side profiles, or RAMSETE or the MPC tracker on the poses)
+ */
+#include "main.h"
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+/** static table of cached trajectories */
+CachedTrajectory trajectories[MAX_TRAJECTORIES];
+int trajectoryCount = 0;
+/** geometry of generated trajectories from the spline path instead of pathfinder (refer to setSplineGeneration) */
+bool splineGeneration = false;
+/**
+ * Hash the inputs of a trajectory (FNV-1a).
+ * @param points
+ * waypoints
+ *
+ * @param count
+ * number of waypoints
+ *
+ * @param maxVel
+ * maximum velocity
+ *
+ * @param maxAcc
+ * maximum acceleration
+ *
+ * @param maxJerk
+ * maximum jerk
+ *
+ * @return
+ * hash of the waypoints, limits, time step, base width and velocity planning settings
+ */
+uint32_t hashTrajectory(const Waypoint *points, int count, double maxVel, double maxAcc, double maxJerk){
+  double params[8] = {maxVel, maxAcc, maxJerk, TRAJECTORY_DT, baseWidth,
+    TRAJECTORY_VELOCITY_PLANNING, TRAJECTORY_MAX_LAT_ACC, TRAJECTORY_DS};
+  uint32_t hash = 2166136261u;
+  const unsigned char *bytes = (const unsigned char*) points;
+  for(unsigned int i = 0; i < count*sizeof(Waypoint); i++) hash = (hash ^ bytes[i])*16777619u;
+  bytes = (const unsigned char*) params;
+  for(unsigned int i = 0; i < sizeof(params); i++) hash = (hash ^ bytes[i])*16777619u;
+  return hash;
+}
+/**
+ * Build the path of the file of a trajectory.
+ * @param name
+ * identifier of the trajectory
+ *
+ * @param path
+ * buffer for the path
+ *
+ * @param size
+ * size of the buffer
+ */
+void trajectoryFilePath(const char *name, char *path, int size){
+  snprintf(path, size, "%s%s.traj", TRAJECTORY_DIR, name);
+}
+/**
+ * Load a trajectory from the microSD card.
+ * @param name
+ * identifier of the trajectory
+ *
+ * @param hash
+ * expected hash of the trajectory inputs
+ *
+ * @param trajectory
+ * filled with the loaded trajectory
+ *
+ * @return
+ * false if there is no card, no file, or the file is stale or corrupt
+ */
+bool loadTrajectory(const char *name, uint32_t hash, CachedTrajectory &trajectory){
+  if(!usd::is_installed()) return false;
+  char path[64];
+  trajectoryFilePath(name, path, sizeof(path));
+  FILE *file = fopen(path, "rb");
+  if(file == NULL) return false;
+  TrajectoryFileHeader header;
+  bool valid = fread(&header, sizeof(header), 1, file) == 1 && header.magic == TRAJECTORY_FILE_MAGIC
+    && header.version == TRAJECTORY_FILE_VERSION && header.hash == hash && header.length > 0;
+  PackedSegment *left = NULL, *right = NULL;
+  PackedPose *poses = NULL;
+  uint32_t mark = getArenaMark();
+  if(valid){
+    left = (PackedSegment*) arenaAlloc(header.length*sizeof(PackedSegment));
+    right = (PackedSegment*) arenaAlloc(header.length*sizeof(PackedSegment));
+    poses = (PackedPose*) arenaAlloc(header.length*sizeof(PackedPose));
+    valid = left != NULL && right != NULL && poses != NULL
+      && fread(left, sizeof(PackedSegment), header.length, file) == (size_t)header.length
+      && fread(right, sizeof(PackedSegment), header.length, file) == (size_t)header.length
+      && fread(poses, sizeof(PackedPose), header.length, file) == (size_t)header.length;
+  }
+  fclose(file);
+  if(!valid){
+    releaseArena(mark);
+    return false;
+  }
+  trajectory = {name, left, right, header.length, header.dt, header.velScale, header.accScale, poses};
+  return true;
+}
+/**
+ * A sample of the path for the velocity planner (every TRAJECTORY_DS)
+ * x, y, heading: interpolated from pathfinder's center trajectory
+ * vel: planned velocity, acc: acceleration limit of the center at the sample
+ * time: time at which the sample is reached
+ */
+struct PlanSample{
+  double x, y, heading;
+  double vel, acc, time;
+};
+/**
+ * Plan the time-optimal velocity along pathfinder's center trajectory and resample it
+ * at TRAJECTORY_DT. The path geometry is kept; only the timing changes.
+ * - curvature k from the heading change between samples
+ * - speed cap: the outer side (v*(1 + |k|*baseWidth/2)) within maxVel, and v^2*|k| within TRAJECTORY_MAX_LAT_ACC
+ * - forward pass from rest with the outer side's acceleration within maxAcc, then the same backward to rest
+ * @param center
+ * center trajectory from pathfinder_generate (pathfinder's axes)
+ *
+ * @param length
+ * number of segments
+ *
+ * @param maxVel
+ * maximum velocity of a side
+ *
+ * @param maxAcc
+ * maximum acceleration of a side
+ *
+ * @param result
+ * set to the retimed trajectory (arena scratch, released by the caller)
+ *
+ * @return
+ * number of segments of the retimed trajectory, or -1 if it could not be planned
+ */
+int retimeTrajectory(const Segment *center, int length, double maxVel, double maxAcc, Segment **result){
+  double distance = center[length-1].position - center[0].position;
+  if(length < 2 || distance <= 0) return -1;
+  int count = (int) ceil(distance/TRAJECTORY_DS) + 1;
+  double ds = distance/(count - 1);
+  PlanSample *samples = (PlanSample*) arenaScratch(count*sizeof(PlanSample));
+  if(samples == NULL) return -1;
+  /** geometry at even spacing along the path */
+  for(int i = 0, j = 0; i < count; i++){
+    double s = center[0].position + i*ds;
+    while(j < length - 2 && center[j+1].position < s) j++;
+    double span = center[j+1].position - center[j].position;
+    double f = span > 0 ? (s - center[j].position)/span : 0;
+    f = fmin(fmax(f, 0), 1);
+    samples[i].x = center[j].x + (center[j+1].x - center[j].x)*f;
+    samples[i].y = center[j].y + (center[j+1].y - center[j].y)*f;
+    samples[i].heading = center[j].heading + angleDiff(center[j+1].heading, center[j].heading)*f;
+  }
+  /** curvature limits */
+  for(int i = 0; i < count; i++){
+    int prev = i > 0 ? i - 1 : i, next = i < count - 1 ? i + 1 : i;
+    double curvature = fabs(angleDiff(samples[next].heading, samples[prev].heading))/((next - prev)*ds);
+    double sideScale = 1 + curvature*baseWidth/2;
+    samples[i].vel = maxVel/sideScale;
+    if(curvature > 0) samples[i].vel = fmin(samples[i].vel, sqrt(TRAJECTORY_MAX_LAT_ACC/curvature));
+    samples[i].acc = maxAcc/sideScale;
+  }
+  /** forward pass (accelerating from rest), then backward pass (braking to rest) */
+  samples[0].vel = 0;
+  for(int i = 1; i < count; i++){
+    samples[i].vel = fmin(samples[i].vel, sqrt(samples[i-1].vel*samples[i-1].vel + 2*samples[i-1].acc*ds));
+  }
+  samples[count-1].vel = 0;
+  for(int i = count - 2; i >= 0; i--){
+    samples[i].vel = fmin(samples[i].vel, sqrt(samples[i+1].vel*samples[i+1].vel + 2*samples[i+1].acc*ds));
+  }
+  /** constant acceleration between samples */
+  samples[0].time = 0;
+  for(int i = 1; i < count; i++) samples[i].time = samples[i-1].time + 2*ds/(samples[i-1].vel + samples[i].vel);
+  double duration = samples[count-1].time;
+  int segments = (int) ceil(duration/TRAJECTORY_DT) + 1;
+  Segment *retimed = (Segment*) arenaScratch(segments*sizeof(Segment));
+  if(retimed == NULL) return -1;
+  for(int k = 0, i = 0; k < segments; k++){
+    double t = fmin(k*TRAJECTORY_DT, duration);
+    while(i < count - 2 && samples[i+1].time < t) i++;
+    const PlanSample &a = samples[i], &b = samples[i+1];
+    double acc = (b.vel*b.vel - a.vel*a.vel)/(2*ds);
+    double tau = fmin(fmax(t - a.time, 0), b.time - a.time);
+    double along = fmin(a.vel*tau + acc*tau*tau/2, ds);
+    double f = along/ds;
+    Segment &segment = retimed[k];
+    segment.dt = TRAJECTORY_DT;
+    segment.x = a.x + (b.x - a.x)*f;
+    segment.y = a.y + (b.y - a.y)*f;
+    segment.position = center[0].position + i*ds + along;
+    segment.velocity = a.vel + acc*tau;
+    segment.acceleration = acc;
+    segment.jerk = k > 0 ? (acc - retimed[k-1].acceleration)/TRAJECTORY_DT : 0;
+    segment.heading = a.heading + angleDiff(b.heading, a.heading)*f;
+  }
+  *result = retimed;
+  return segments;
+}
+/**
+ * Pack the poses of a centre trajectory into the arena.
+ * @param center
+ * centre segments (pathfinder's axes: x and y are swapped, the heading is our bearing)
+ *
+ * @param length
+ * number of segments
+ *
+ * @return
+ * the poses, or NULL if the arena is full
+ */
+PackedPose *packPoses(const Segment *center, int length){
+  PackedPose *poses = (PackedPose*) arenaAlloc(length*sizeof(PackedPose));
+  if(poses == NULL) return NULL;
+  for(int i = 0; i < length; i++) poses[i] = {(float)center[i].y, (float)center[i].x, (float)center[i].heading};
+  return poses;
+}
+/**
+ * Side values of a batch of centre values: left = center + turn*halfWidth, right = center - turn*halfWidth.
+ * @param center
+ * centre velocities (or accelerations)
+ *
+ * @param turn
+ * angular velocities (or accelerations) in radians, clockwise
+ *
+ * @param count
+ * number of values (a multiple of TRAJECTORY_BATCH)
+ *
+ * @param halfWidth
+ * half of the base width
+ *
+ * @param left, right
+ * set to the side values
+ */
+void tankSides(const float *center, const float *turn, int count, float halfWidth, float *left, float *right){
+#if defined(__ARM_NEON)
+  float32x4_t half = vdupq_n_f32(halfWidth);
+  for(int i = 0; i < count; i += TRAJECTORY_BATCH){
+    float32x4_t value = vld1q_f32(center + i), offset = vmulq_f32(vld1q_f32(turn + i), half);
+    vst1q_f32(left + i, vaddq_f32(value, offset));
+    vst1q_f32(right + i, vsubq_f32(value, offset));
+  }
+#else
+  for(int i = 0; i < count; i++){
+    float offset = turn[i]*halfWidth;
+    left[i] = center[i] + offset;
+    right[i] = center[i] - offset;
+  }
+#endif
+}
+/**
+ * Pack the sides of a planned trajectory into the arena, from the centre's velocity and turn rate
+ * (refer to TRAJECTORY_BATCH).
+ * @param name
+ * identifier of the trajectory
+ *
+ * @param center
+ * centre segments at even time steps (from retimeTrajectory)
+ *
+ * @param length
+ * number of segments
+ *
+ * @param trajectory
+ * filled with the packed trajectory
+ *
+ * @return
+ * false if the arena is full
+ */
+bool packPlannedTrajectory(const char *name, const Segment *center, int length, CachedTrajectory &trajectory){
+  int padded = (length + TRAJECTORY_BATCH - 1)/TRAJECTORY_BATCH*TRAJECTORY_BATCH;
+  /** structure of arrays (arena scratch, released by the caller), padded to whole batches */
+  float *values = (float*) arenaScratch(8*padded*sizeof(float));
+  if(values == NULL) return false;
+  float *vel = values, *angVel = vel + padded, *acc = angVel + padded, *angAcc = acc + padded;
+  float *leftVel = angAcc + padded, *rightVel = leftVel + padded, *leftAcc = rightVel + padded, *rightAcc = leftAcc + padded;
+  double dt = center[0].dt;
+  /** centre values and turn rates (central differences of the heading) */
+  for(int i = 0; i < padded; i++){
+    int prev = i > 0 ? i - 1 : i, next = i < length - 1 ? i + 1 : i;
+    bool inside = i < length && next > prev;
+    vel[i] = i < length ? center[i].velocity : 0;
+    acc[i] = i < length ? center[i].acceleration : 0;
+    angVel[i] = inside ? angleDiff(center[next].heading, center[prev].heading)/((next - prev)*dt) : 0;
+  }
+  for(int i = 0; i < padded; i++){
+    int prev = i > 0 ? i - 1 : i, next = i < length - 1 ? i + 1 : i;
+    angAcc[i] = i < length && next > prev ? (angVel[next] - angVel[prev])/((next - prev)*dt) : 0;
+  }
+  tankSides(vel, angVel, padded, baseWidth/2, leftVel, rightVel);
+  tankSides(acc, angAcc, padded, baseWidth/2, leftAcc, rightAcc);
+  float maxVel = 0, maxAcc = 0;
+  for(int i = 0; i < length; i++){
+    maxVel = fmax(maxVel, fmax(fabs(leftVel[i]), fabs(rightVel[i])));
+    maxAcc = fmax(maxAcc, fmax(fabs(leftAcc[i]), fabs(rightAcc[i])));
+  }
+  trajectory = {name, NULL, NULL, length, (float)dt,
+    maxVel > 0 ? maxVel/INT16_MAX : 1, maxAcc > 0 ? maxAcc/INT16_MAX : 1};
+  trajectory.left = (PackedSegment*) arenaAlloc(length*sizeof(PackedSegment));
+  trajectory.right = (PackedSegment*) arenaAlloc(length*sizeof(PackedSegment));
+  trajectory.poses = packPoses(center, length);
+  if(trajectory.left == NULL || trajectory.right == NULL || trajectory.poses == NULL) return false;
+  /** side positions: the travel at the mean velocity of each step */
+  double positionL = 0, positionR = 0;
+  for(int i = 0; i < length; i++){
+    if(i > 0){
+      positionL += (leftVel[i-1] + leftVel[i])*dt/2;
+      positionR += (rightVel[i-1] + rightVel[i])*dt/2;
+    }
+    trajectory.left[i] = {(float)positionL, (int16_t)lround(leftVel[i]/trajectory.velScale),
+      (int16_t)lround(leftAcc[i]/trajectory.accScale)};
+    trajectory.right[i] = {(float)positionR, (int16_t)lround(rightVel[i]/trajectory.velScale),
+      (int16_t)lround(rightAcc[i]/trajectory.accScale)};
+  }
+  return true;
+}
+/**
+ * Save a trajectory to the microSD card (if there is one).
+ * @param trajectory
+ * trajectory to be saved
+ *
+ * @param hash
+ * hash of the trajectory inputs
+ *
+ * @return
+ * false if there is no card or the file could not be written
+ */
+bool saveTrajectory(const CachedTrajectory &trajectory, uint32_t hash){
+  if(!usd::is_installed()) return false;
+  char path[64];
+  trajectoryFilePath(trajectory.name, path, sizeof(path));
+  FILE *file = fopen(path, "wb");
+  if(file == NULL) return false;
+  TrajectoryFileHeader header = {TRAJECTORY_FILE_MAGIC, TRAJECTORY_FILE_VERSION, hash, trajectory.length,
+    trajectory.dt, trajectory.velScale, trajectory.accScale};
+  bool written = fwrite(&header, sizeof(header), 1, file) == 1
+    && fwrite(trajectory.left, sizeof(PackedSegment), trajectory.length, file) == (size_t)trajectory.length
+    && fwrite(trajectory.right, sizeof(PackedSegment), trajectory.length, file) == (size_t)trajectory.length
+    && fwrite(trajectory.poses, sizeof(PackedPose), trajectory.length, file) == (size_t)trajectory.length;
+  return fclose(file) == 0 && written;
+}
+/**
+ * Pack the sides of a generated trajectory into the arena.
+ * @param name
+ * identifier of the trajectory
+ *
+ * @param left
+ * left side segments from pathfinder
+ *
+ * @param right
+ * right side segments from pathfinder
+ *
+ * @param center
+ * centre segments from pathfinder
+ *
+ * @param length
+ * number of segments per side
+ *
+ * @param trajectory
+ * filled with the packed trajectory
+ *
+ * @return
+ * false if the arena is full
+ */
+bool packTrajectory(const char *name, const Segment *left, const Segment *right, const Segment *center, int length,
+                    CachedTrajectory &trajectory){
+  double maxVel = 0, maxAcc = 0;
+  for(int i = 0; i < length; i++){
+    maxVel = fmax(maxVel, fmax(fabs(left[i].velocity), fabs(right[i].velocity)));
+    maxAcc = fmax(maxAcc, fmax(fabs(left[i].acceleration), fabs(right[i].acceleration)));
+  }
+  trajectory = {name, NULL, NULL, length, (float)left[0].dt,
+    (float)(maxVel > 0 ? maxVel/INT16_MAX : 1), (float)(maxAcc > 0 ? maxAcc/INT16_MAX : 1)};
+  trajectory.left = (PackedSegment*) arenaAlloc(length*sizeof(PackedSegment));
+  trajectory.right = (PackedSegment*) arenaAlloc(length*sizeof(PackedSegment));
+  trajectory.poses = packPoses(center, length);
+  if(trajectory.left == NULL || trajectory.right == NULL || trajectory.poses == NULL) return false;
+  for(int i = 0; i < length; i++){
+    trajectory.left[i] = {(float)left[i].position, (int16_t)lround(left[i].velocity/trajectory.velScale),
+      (int16_t)lround(left[i].acceleration/trajectory.accScale)};
+    trajectory.right[i] = {(float)right[i].position, (int16_t)lround(right[i].velocity/trajectory.velScale),
+      (int16_t)lround(right[i].acceleration/trajectory.accScale)};
+  }
+  return true;
+}
+/**
+ * Sample the centre of a path with pathfinder (FIT_HERMITE_CUBIC, every TRAJECTORY_DT).
+ * @param points, count
+ * waypoints in field coordinates
+ *
+ * @param maxVel, maxAcc, maxJerk
+ * limits of pathfinder's profile
+ *
+ * @param center
+ * set to the centre segments (arena scratch, released by the caller; pathfinder's axes)
+ *
+ * @return
+ * number of segments, or -1 if it could not be generated
+ */
+int pathfinderCenter(const Waypoint *points, int count, double maxVel, double maxAcc, double maxJerk, Segment **center){
+  /**
+   * Pathfinder measures headings counterclockwise from its x-axis.
+   * Swapping x and y turns that into our bearing (clockwise from the y-axis),
+   * so the waypoints can be passed in field coordinates.
+   */
+  Waypoint path[count];
+  for(int i = 0; i < count; i++) path[i] = {points[i].y, points[i].x, points[i].angle};
+  TrajectoryCandidate candidate;
+  if(pathfinder_prepare(path, count, FIT_HERMITE_CUBIC, PATHFINDER_SAMPLES_FAST, TRAJECTORY_DT, maxVel, maxAcc, maxJerk, &candidate) < 0) return -1;
+  /** pathfinder allocates its spline arrays itself; everything else is in the arena */
+  int length = candidate.length;
+  *center = (Segment*) arenaScratch(length*sizeof(Segment));
+  bool generated = *center != NULL && pathfinder_generate(&candidate, *center) >= 0;
+  free(candidate.saptr);
+  free(candidate.laptr);
+  return generated? length : -1;
+}
+/**
+ * Sample the centre of a path on the spline path (refer to buildSplinePath: the cubic Hermite curves of
+ * pathfinder's FIT_HERMITE_CUBIC) every TRAJECTORY_DS, for the velocity planner: only the positions and headings
+ * are set. Not reentrant (initialization and host tools only).
+ * @param points, count
+ * waypoints in field coordinates
+ *
+ * @param center
+ * set to the centre samples (arena scratch, released by the caller; pathfinder's axes, as retimeTrajectory expects)
+ *
+ * @return
+ * number of samples, or -1 if the path cannot be built (the points coincide, or the arena is full)
+ */
+int splineCenter(const Waypoint *points, int count, Segment **center){
+  static SplinePath path;
+  if(!buildSplinePath(path, points, count) || path.length <= 0) return -1;
+  int samples = (int)ceil(path.length/TRAJECTORY_DS) + 1;
+  *center = (Segment*) arenaScratch(samples*sizeof(Segment));
+  if(*center == NULL) return -1;
+  /** pathfinder's axes (x and y swapped, the heading is our bearing) */
+  for(int i = 0; i < samples; i++){
+    double distance = path.length*i/(samples - 1), u = splineParameterAt(path, distance);
+    PursuitPoint point = splinePoint(path, u), tangent = splineTangent(path, u);
+    (*center)[i] = {TRAJECTORY_DT, point.y, point.x, distance, 0, 0, 0, atan2(tangent.x, tangent.y)};
+  }
+  return samples;
+}
+/**
+ * Generate the geometry of the trajectories with the spline path (splineCenter) instead of pathfinder, which is
+ * part of okapilib.a and only linked on the V5: the host tools (refer to bakeTrajectories) plan the same
+ * trajectories on the computer. Only with TRAJECTORY_VELOCITY_PLANNING (the planner keeps the geometry alone).
+ * @param value
+ * true: the spline path, false: pathfinder (the default)
+ */
+void setSplineGeneration(bool value){
+  splineGeneration = value;
+}
+/**
+ * Generate a tank trajectory into the arena (the generation of generateTrajectory and streamTrajectory).
+ * @param name
+ * identifier of the trajectory
+ *
+ * @param points
+ * waypoints in field coordinates
+ *
+ * @param count
+ * number of waypoints
+ *
+ * @param maxVel, maxAcc, maxJerk
+ * limits (refer to generateTrajectory)
+ *
+ * @param trajectory
+ * filled with the packed trajectory
+ *
+ * @return
+ * false if it could not be generated (nothing is left in the arena)
+ */
+bool buildTrajectory(const char *name, const Waypoint *points, int count, double maxVel, double maxAcc, double maxJerk,
+                     CachedTrajectory &trajectory){
+  uint32_t mark = getArenaMark(), scratch = getScratchMark();
+  Segment *center = NULL;
+  int length = TRAJECTORY_VELOCITY_PLANNING && splineGeneration? splineCenter(points, count, &center)
+    : pathfinderCenter(points, count, maxVel, maxAcc, maxJerk, &center);
+  bool generated = length > 0;
+#if TRAJECTORY_VELOCITY_PLANNING
+  /** the heading is our bearing (refer to the axis swap), so a clockwise turn speeds up the left side */
+  if(generated) length = retimeTrajectory(center, length, maxVel, maxAcc, &center);
+  bool packed = generated && length > 0 && packPlannedTrajectory(name, center, length, trajectory);
+#else
+  Segment *left = generated ? (Segment*) arenaScratch(length*sizeof(Segment)) : NULL;
+  Segment *right = left != NULL ? (Segment*) arenaScratch(length*sizeof(Segment)) : NULL;
+  /**
+   * The axis swap mirrors the field, so pathfinder's left side is our right side.
+   */
+  if(right != NULL) pathfinder_modify_tank(center, length, right, left, baseWidth);
+  bool packed = right != NULL && packTrajectory(name, left, right, center, length, trajectory);
+#endif
+  releaseScratch(scratch);
+  if(!packed) releaseArena(mark);
+  return packed;
+}
+/**
+ * Generate a tank trajectory and store it in the cache.
+ * If the baked blob holds the same trajectory (same name and hash, refer to bakedTrajectories.hpp) the cache
+ * points at it; else if the microSD card holds it, it is loaded instead;
+ * otherwise the generated trajectory is saved for the next boot.
+ * Generation costs tens of milliseconds, so only call it from initialize() or competition_initialize().
+ * @param name
+ * identifier of the trajectory (must stay valid, e.g. a string literal)
+ *
+ * @param points
+ * waypoints in field coordinates: (x, y) in inches and angle = bearing in radians
+ *
+ * @param count
+ * number of waypoints
+ *
+ * @param maxVel
+ * maximum velocity (inches per second)
+ *
+ * @param maxAcc
+ * maximum acceleration (inches per second squared)
+ *
+ * @param maxJerk
+ * maximum jerk (inches per second cubed)
+ *
+ * @return
+ * id of the trajectory, or -1 if it could not be generated
+ */
+int generateTrajectory(const char *name, const Waypoint *points, int count, double maxVel, double maxAcc, double maxJerk){
+  if(trajectoryCount >= MAX_TRAJECTORIES || count < 2) return -1;
+  uint32_t hash = hashTrajectory(points, count, maxVel, maxAcc, maxJerk);
+  if(findBakedTrajectory(name, hash, trajectories[trajectoryCount]) || loadTrajectory(name, hash, trajectories[trajectoryCount])){
+    trajectories[trajectoryCount].hash = hash;
+    int id = trajectoryCount++;
+    prepareLearning(id);
+    return id;
+  }
+  if(!buildTrajectory(name, points, count, maxVel, maxAcc, maxJerk, trajectories[trajectoryCount])) return -1;
+  trajectories[trajectoryCount].hash = hash;
+  saveTrajectory(trajectories[trajectoryCount], hash);
+  int id = trajectoryCount++;
+  prepareLearning(id);
+  return id;
+}
+/**
+ * Generate a tank trajectory with the default limits.
+ * @param name
+ * identifier of the trajectory
+ *
+ * @param points
+ * waypoints in field coordinates
+ *
+ * @param count
+ * number of waypoints
+ *
+ * @return
+ * id of the trajectory, or -1 if it could not be generated
+ */
+int generateTrajectory(const char *name, const Waypoint *points, int count){
+  return generateTrajectory(name, points, count, TRAJECTORY_MAX_VEL, TRAJECTORY_MAX_ACC, TRAJECTORY_MAX_JERK);
+}
+/**
+ * Add a tank trajectory that is streamed from the microSD card while it is followed (refer to trajectoryStream.hpp):
+ * only its first chunk takes arena space, however long it is. A baked trajectory is taken as it is (it takes no
+ * arena space either); else the file saved by an earlier boot is streamed if its inputs are the same, or the
+ * trajectory is generated, saved and streamed back. Without a card it is generated into the cache as
+ * generateTrajectory does. Only call it from initialize() or competition_initialize().
+ * @param name
+ * identifier of the trajectory (must stay valid, e.g. a string literal)
+ *
+ * @param points
+ * waypoints in field coordinates: (x, y) in inches and angle = bearing in radians
+ *
+ * @param count
+ * number of waypoints
+ *
+ * @param maxVel, maxAcc, maxJerk
+ * limits (refer to generateTrajectory)
+ *
+ * @return
+ * id of the trajectory, or -1 if it could not be generated or read back
+ */
+int streamTrajectory(const char *name, const Waypoint *points, int count, double maxVel, double maxAcc, double maxJerk){
+  if(trajectoryCount >= MAX_TRAJECTORIES || count < 2) return -1;
+  uint32_t hash = hashTrajectory(points, count, maxVel, maxAcc, maxJerk);
+  CachedTrajectory &trajectory = trajectories[trajectoryCount];
+  if(!findBakedTrajectory(name, hash, trajectory) && !openStream(name, hash, trajectory)){
+    /** the whole trajectory is in the arena only while it is generated and saved */
+    uint32_t mark = getArenaMark();
+    if(!buildTrajectory(name, points, count, maxVel, maxAcc, maxJerk, trajectory)) return -1;
+    if(saveTrajectory(trajectory, hash)){
+      releaseArena(mark);
+      if(!openStream(name, hash, trajectory)) return -1;
+    }
+  }
+  trajectory.hash = hash;
+  int id = trajectoryCount++;
+  prepareLearning(id);
+  return id;
+}
+/**
+ * Add a streamed tank trajectory with the default limits.
+ * @param name
+ * identifier of the trajectory
+ *
+ * @param points
+ * waypoints in field coordinates
+ *
+ * @param count
+ * number of waypoints
+ *
+ * @return
+ * id of the trajectory, or -1 if it could not be generated or read back
+ */
+int streamTrajectory(const char *name, const Waypoint *points, int count){
+  return streamTrajectory(name, points, count, TRAJECTORY_MAX_VEL, TRAJECTORY_MAX_ACC, TRAJECTORY_MAX_JERK);
+}
+/**
+ * Add a variant of a cached trajectory without generating it: the variant shares the segments
+ * and poses of the source (no arena space, nothing on the microSD card) and is transformed as it is decoded,
+ * the way okapi's profile controller follows a path mirrored or backwards.
+ * E.g. generate blueLeft's trajectories, then derive redLeft's with mirror = true.
+ * @param name
+ * identifier of the variant (must stay valid, e.g. a string literal)
+ *
+ * @param source
+ * identifier of the cached trajectory it is derived from
+ *
+ * @param mirror
+ * reflect the path across TRAJECTORY_MIRROR_X (the sides swap: every turn goes the other way)
+ *
+ * @param backwards
+ * drive the path back first (the sides swap and run negative; the path is reflected through its start)
+ *
+ * @return
+ * id of the variant, or -1 if the source is not cached (or is streamed) or the cache is full
+ */
+int deriveTrajectory(const char *name, const char *source, bool mirror, bool backwards){
+  const CachedTrajectory *original = getTrajectory(findTrajectory(source));
+  if(original == NULL || original->stream != NULL || trajectoryCount >= MAX_TRAJECTORIES) return -1;
+  CachedTrajectory &variant = trajectories[trajectoryCount];
+  variant = *original;
+  variant.name = name;
+  variant.mirrored = original->mirrored != mirror;
+  variant.reversed = original->reversed != backwards;
+  variant.hash = 0;
+  /** each transform swaps the sides, so two cancel out */
+  if(mirror != backwards){
+    variant.left = original->right;
+    variant.right = original->left;
+  }
+  int id = trajectoryCount++;
+  prepareLearning(id);
+  return id;
+}
+/**
+ * Drop every cached trajectory (before resetArena, so that no segment is used after it is freed).
+ */
+void clearTrajectories(){
+  trajectoryCount = 0;
+  clearLearning();
+  closeStreams();
+}
+/**
+ * Find a cached trajectory by name.
+ * @param name
+ * identifier of the trajectory
+ *
+ * @return
+ * id of the trajectory, or -1 if it is not cached
+ */
+int findTrajectory(const char *name){
+  for(int i = 0; i < trajectoryCount; i++){
+    if(strcmp(trajectories[i].name, name) == 0) return i;
+  }
+  return -1;
+}
+/**
+ * Retrieve a cached trajectory.
+ * @param id
+ * id of the trajectory
+ *
+ * @return
+ * pointer to the cached trajectory, or NULL if the id is invalid
+ */
+const CachedTrajectory *getTrajectory(int id){
+  if(id < 0 || id >= trajectoryCount) return NULL;
+  return &trajectories[id];
+}
+/**
+ * Segment of a trajectory at a time, and the share of the way to the next one.
+ * @param trajectory
+ * the trajectory
+ *
+ * @param t
+ * time along the trajectory (s; held within its start and end)
+ *
+ * @param fraction
+ * set to the share of the segment's dt elapsed (0 at the last segment)
+ *
+ * @return
+ * index of the segment
+ */
+HOT_PATH int trajectoryIndex(const CachedTrajectory &trajectory, double t, double &fraction){
+  double position = fmin(fmax(t/trajectory.dt, 0), trajectory.length - 1);
+  int i = position;
+  fraction = position - i;
+  return i;
+}
+/**
+ * Sample a side of a cached trajectory at a time: the followers look the setpoints up by the time elapsed and
+ * interpolate between the segments around it, so a late control cycle does not shift the profile, and the
+ * segments can be further apart than a control cycle (TRAJECTORY_DT).
+ * @param trajectory
+ * the trajectory
+ *
+ * @param right
+ * true for the right side
+ *
+ * @param t
+ * time along the trajectory (s; held within its start and end)
+ *
+ * @return
+ * the side's position, velocity and acceleration at the time (linear between the segments)
+ */
+HOT_PATH TrajectorySample sampleTrajectory(const CachedTrajectory &trajectory, bool right, double t){
+  double s;
+  int i = trajectoryIndex(trajectory, t, s);
+  TrajectorySample sample = decodeSegment(trajectory, getSegment(trajectory, right, i));
+  if(s == 0) return sample;
+  TrajectorySample next = decodeSegment(trajectory, getSegment(trajectory, right, i + 1));
+  return {sample.position + s*(next.position - sample.position), sample.velocity + s*(next.velocity - sample.velocity),
+          sample.acceleration + s*(next.acceleration - sample.acceleration)};
+}
+/**
+ * Sample the pose of the centre of a cached trajectory at a time (refer to sampleTrajectory).
+ * @param trajectory
+ * the trajectory
+ *
+ * @param t
+ * time along the trajectory (s; held within its start and end)
+ *
+ * @return
+ * the pose at the time (odometry coordinates; linear between the segments, the bearing the short way round)
+ */
+HOT_PATH PackedPose sampleTrajectoryPose(const CachedTrajectory &trajectory, double t){
+  double s;
+  int i = trajectoryIndex(trajectory, t, s);
+  PackedPose pose = decodePose(trajectory, i);
+  if(s == 0) return pose;
+  PackedPose next = decodePose(trajectory, i + 1);
+  return {(float)(pose.x + s*(next.x - pose.x)), (float)(pose.y + s*(next.y - pose.y)),
+          (float)(pose.angle + s*angleDiff(next.angle, pose.angle))};
+}
+/**
+ * Replay a cached trajectory (no generation at run time).
+ * @param name
+ * identifier of the trajectory
+ *
+ * @param kp
+ * proportional constant
+ *
+ * @param kd
+ * derivative constant
+ *
+ * @return
+ * false if the trajectory is not cached
+ */
+bool followTrajectory(const char *name, double kp, double kd){
+  const CachedTrajectory *trajectory = getTrajectory(findTrajectory(name));
+  if(trajectory == NULL) return false;
+  startBaseTrajectory(trajectory, kp, kd);
+  return true;
+}
+/**
+ * Replay a cached trajectory with the kP and kD of the parameter table (DEFAULT_KP and DEFAULT_KD unless changed).
+ * @param name
+ * identifier of the trajectory
+ *
+ * @return
+ * false if the trajectory is not cached
+ */
+bool followTrajectory(const char *name){
+  const ParamTable *params = getParams();
+  return followTrajectory(name, params->values[PARAM_TRAJECTORY_KP], params->values[PARAM_TRAJECTORY_KD]);
+}
+/**
+ * Follow a cached trajectory with the RAMSETE controller (refer to ramsete.hpp): the base tracks the
+ * trajectory's poses, so the robot should start at its first waypoint (odometry coordinates).
+ * @param name
+ * identifier of the trajectory
+ *
+ * @return
+ * false if the trajectory is not cached
+ */
+bool followTrajectoryRamsete(const char *name){
+  const CachedTrajectory *trajectory = getTrajectory(findTrajectory(name));
+  if(trajectory == NULL) return false;
+  startBaseRamsete(trajectory);
+  return true;
+}
+/**
+ * Follow a cached trajectory with the MPC tracker (refer to mpcTracker.hpp), as followTrajectoryRamsete.
+ * @param name
+ * identifier of the trajectory
+ *
+ * @return
+ * false if the trajectory is not cached
+ */
+bool followTrajectoryMpc(const char *name){
+  const CachedTrajectory *trajectory = getTrajectory(findTrajectory(name));
+  if(trajectory == NULL) return false;
+  startBaseMpc(trajectory);
+  return true;
+}
@@ -0,0 +1,275 @@
+/**
+ * Streamed trajectories (refer to trajectoryStream.hpp):
+ * - Opening: the header, the first chunk and the last segments of a trajectory file into the arena
+ * - Control task: segments from the first chunk or the shared buffers, the follower's position for the prefetch
+ * - Task trajectoryStream: the chunks the follower is on and enters next, read into the shared buffers
+ */
+#include "main.h"
+/** a chunk leaves a second for its read, and covers the lookahead of every follower more than twice */
+static_assert(STREAM_CHUNK*TRAJECTORY_DT >= 1, "STREAM_CHUNK leaves too little time to read the next chunk");
+static_assert(STREAM_CHUNK*TRAJECTORY_DT*1000 >= 2*std::max(BASE_LOOKAHEAD, MPC_HORIZON*MPC_STEP*BASE_CONTROL_DT),
+              "STREAM_CHUNK is shorter than the lookahead of the followers");
+/**
+ * A shared buffer
+ * tag: tag of the chunk it holds (refer to streamTag), STREAM_EMPTY while it is read (checked by the readers
+ * before and after a copy, as a seqlock)
+ */
+#define STREAM_EMPTY 0xFFFFFFFFu
+struct StreamBuffer{
+  std::atomic<uint32_t> tag;
+  StreamChunk chunk;
+};
+StreamBuffer streamBuffers[STREAM_BUFFERS];
+/** stream the task reads for (the latest one advanced), and whether it is reading */
+std::atomic<TrajectoryStream*> activeStream(NULL);
+std::atomic<bool> streamBusy(false);
+/** openings since boot (a serial per stream) */
+uint32_t streamSerial = 0;
+std::atomic<uint32_t> streamChunks(0), streamUnderruns(0), streamFailures(0), streamSlowest(0);
+/**
+ * @param stream
+ * a stream
+ *
+ * @param chunk
+ * one of its chunks
+ *
+ * @return
+ * the tag of the chunk in the shared buffers (the serial of the stream in the upper 12 bits)
+ */
+uint32_t streamTag(const TrajectoryStream &stream, int chunk){
+  return stream.tag | chunk;
+}
+/**
+ * Read a chunk of a trajectory file (every section of the file is read at the chunk's offset).
+ * @param file
+ * the open file
+ *
+ * @param length
+ * segments per side of the trajectory
+ *
+ * @param chunk
+ * the chunk
+ *
+ * @param data
+ * set to the segments and poses of the chunk
+ *
+ * @return
+ * false if the file could not be read
+ */
+bool readChunk(FILE *file, int length, int chunk, StreamChunk &data){
+  int first = chunk*STREAM_CHUNK;
+  size_t count = std::min(STREAM_CHUNK, length - first);
+  long side = length*sizeof(PackedSegment), start = sizeof(TrajectoryFileHeader);
+  return fseek(file, start + first*sizeof(PackedSegment), SEEK_SET) == 0
+    && fread(data.left, sizeof(PackedSegment), count, file) == count
+    && fseek(file, start + side + first*sizeof(PackedSegment), SEEK_SET) == 0
+    && fread(data.right, sizeof(PackedSegment), count, file) == count
+    && fseek(file, start + 2*side + first*sizeof(PackedPose), SEEK_SET) == 0
+    && fread(data.poses, sizeof(PackedPose), count, file) == count;
+}
+/**
+ * Open a trajectory file on the microSD card for streaming (initialization only): its first chunk and last
+ * segments are loaded into the arena, the rest is read while it is followed.
+ * @param name
+ * identifier of the trajectory (must stay valid, e.g. a string literal)
+ *
+ * @param hash
+ * expected hash of the trajectory inputs
+ *
+ * @param trajectory
+ * filled with the streamed trajectory (no side or pose arrays: read them with getSegment and getPackedPose)
+ *
+ * @return
+ * false if there is no card, no file, the file is stale or corrupt, or the arena is full
+ */
+bool openStream(const char *name, uint32_t hash, CachedTrajectory &trajectory){
+  if(!usd::is_installed()) return false;
+  char path[64];
+  trajectoryFilePath(name, path, sizeof(path));
+  FILE *file = fopen(path, "rb");
+  if(file == NULL) return false;
+  TrajectoryFileHeader header;
+  bool valid = fread(&header, sizeof(header), 1, file) == 1 && header.magic == TRAJECTORY_FILE_MAGIC
+    && header.version == TRAJECTORY_FILE_VERSION && header.hash == hash && header.length > 0;
+  uint32_t mark = getArenaMark();
+  TrajectoryStream *stream = valid? (TrajectoryStream*) arenaAlloc(sizeof(TrajectoryStream)) : NULL;
+  StreamChunk *last = NULL;
+  if(stream != NULL){
+    /** the last chunk is read into the scratch end of the arena for its last segments */
+    uint32_t scratch = getScratchMark();
+    int lastChunk = (header.length - 1)/STREAM_CHUNK, end = (header.length - 1)%STREAM_CHUNK;
+    last = (StreamChunk*) arenaScratch(sizeof(StreamChunk));
+    valid = last != NULL && readChunk(file, header.length, 0, stream->head) && readChunk(file, header.length, lastChunk, *last);
+    if(valid){
+      stream->name = name;
+      stream->length = header.length;
+      stream->serial = ++streamSerial;
+      stream->tag = (stream->serial & 0xFFF) << 20;
+      stream->position = 0;
+      stream->endL = stream->heldL = last->left[end];
+      stream->endR = stream->heldR = last->right[end];
+      stream->endPose = last->poses[end];
+      stream->heldPose = stream->head.poses[0];
+    }
+    releaseScratch(scratch);
+  }
+  fclose(file);
+  if(!valid){
+    releaseArena(mark);
+    return false;
+  }
+  trajectory = {name, NULL, NULL, header.length, header.dt, header.velScale, header.accScale, NULL};
+  trajectory.stream = stream;
+  return true;
+}
+/**
+ * Tell the prefetch where the follower is (control task, every cycle and as it starts following; nothing for a
+ * trajectory that is not streamed).
+ * @param trajectory
+ * the trajectory followed
+ *
+ * @param i
+ * the follower's segment
+ */
+HOT_PATH void advanceStream(const CachedTrajectory &trajectory, int i){
+  if(trajectory.stream == NULL) return;
+  trajectory.stream->position.store(i, std::memory_order_relaxed);
+  activeStream.store(trajectory.stream, std::memory_order_release);
+}
+/**
+ * Find a segment or pose in the shared buffers (control task).
+ * @param stream
+ * the stream
+ *
+ * @param i
+ * index of the segment (beyond the first chunk)
+ *
+ * @param copy
+ * copies the segment or pose out of a chunk
+ *
+ * @return
+ * false on an underrun (the chunk is not loaded, or was being replaced during the copy)
+ */
+template<typename Copy> bool readBuffer(const TrajectoryStream &stream, int i, Copy copy){
+  int chunk = i/STREAM_CHUNK;
+  StreamBuffer &buffer = streamBuffers[chunk%STREAM_BUFFERS];
+  uint32_t tag = streamTag(stream, chunk);
+  if(buffer.tag.load(std::memory_order_acquire) != tag) return false;
+  copy(buffer.chunk, i%STREAM_CHUNK);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return buffer.tag.load(std::memory_order_relaxed) == tag;
+}
+/**
+ * @param stream
+ * a streamed trajectory
+ *
+ * @param right
+ * true for the right side
+ *
+ * @param i
+ * index of the segment
+ *
+ * @return
+ * the segment, or the last one read on that side if its chunk is not loaded (control task only)
+ */
+HOT_PATH PackedSegment streamSegment(TrajectoryStream &stream, bool right, int i){
+  PackedSegment &held = right? stream.heldR : stream.heldL;
+  if(i >= stream.length - 1) held = right? stream.endR : stream.endL;
+  else if(i < STREAM_CHUNK) held = right? stream.head.right[i] : stream.head.left[i];
+  else{
+    PackedSegment segment;
+    bool loaded = readBuffer(stream, i, [&](const StreamChunk &chunk, int j){ segment = right? chunk.right[j] : chunk.left[j]; });
+    if(loaded) held = segment;
+    else streamUnderruns.fetch_add(1, std::memory_order_relaxed);
+  }
+  return held;
+}
+/**
+ * @param stream
+ * a streamed trajectory
+ *
+ * @param i
+ * index of the segment
+ *
+ * @return
+ * the pose of the segment, or the last one read if its chunk is not loaded (control task only)
+ */
+HOT_PATH PackedPose streamPose(TrajectoryStream &stream, int i){
+  if(i >= stream.length - 1) return stream.endPose;
+  if(i < STREAM_CHUNK) return stream.head.poses[i];
+  PackedPose pose;
+  if(readBuffer(stream, i, [&](const StreamChunk &chunk, int j){ pose = chunk.poses[j]; })) stream.heldPose = pose;
+  else streamUnderruns.fetch_add(1, std::memory_order_relaxed);
+  return stream.heldPose;
+}
+/**
+ * Stop streaming and empty the shared buffers (clearTrajectories, before the arena is reset).
+ */
+void closeStreams(){
+  activeStream = NULL;
+  Timer timer;
+  while(streamBusy && !timer.passed(REGISTRY_HANDOVER_TIMEOUT)) delay(1);
+  for(int i = 0; i < STREAM_BUFFERS; i++) streamBuffers[i].tag = STREAM_EMPTY;
+}
+/**
+ * @return
+ * the stream counters since boot
+ */
+StreamStats getStreamStats(){
+  return {streamChunks.load(), streamUnderruns.load(), streamFailures.load(), streamSlowest.load()};
+}
+/**
+ * Read the chunk the follower of the active stream is on, then the one it enters next, into their shared buffers
+ * (one chunk per STREAM_DT). The only task that reads the card for the streams; its file stays open while the
+ * stream is active. Runs in autonomous and driver control (refer to taskRegistry.hpp).
+ */
+void trajectoryStream(void * ignore){
+  for(int i = 0; i < STREAM_BUFFERS; i++) streamBuffers[i].tag = STREAM_EMPTY;
+  FILE *file = NULL;
+  uint32_t fileSerial = 0;
+  LoopRate rate(STREAM_DT);
+  startTaskTiming(TIMING_STREAM, STREAM_DT, true);
+  while(true){
+    if(waitTaskActive(ROBOT_STREAM)){
+      rate.restart();
+      startTaskTiming(TIMING_STREAM, STREAM_DT, true);
+    }
+    beginTaskIteration(TIMING_STREAM);
+    streamBusy = true;
+    TrajectoryStream *stream = activeStream.load(std::memory_order_acquire);
+    if(stream != NULL? stream->serial != fileSerial : fileSerial != 0){
+      if(file != NULL) fclose(file);
+      file = NULL;
+      fileSerial = 0;
+      if(stream != NULL){
+        char path[64];
+        trajectoryFilePath(stream->name, path, sizeof(path));
+        file = fopen(path, "rb");
+        fileSerial = stream->serial;
+        /** e.g. the card was taken out: the follower repeats its last segment, and the file is not tried again */
+        if(file == NULL) streamFailures++;
+      }
+    }
+    if(file != NULL){
+      int current = stream->position.load(std::memory_order_relaxed)/STREAM_CHUNK, chunks = (stream->length - 1)/STREAM_CHUNK + 1;
+      for(int chunk = std::max(current, 1); chunk <= current + 1 && chunk < chunks; chunk++){
+        StreamBuffer &buffer = streamBuffers[chunk%STREAM_BUFFERS];
+        uint32_t tag = streamTag(*stream, chunk);
+        if(buffer.tag.load(std::memory_order_relaxed) == tag) continue;
+        buffer.tag.store(STREAM_EMPTY, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        uint64_t start = micros();
+        if(readChunk(file, stream->length, chunk, buffer.chunk)){
+          buffer.tag.store(tag, std::memory_order_release);
+          streamChunks++;
+          streamSlowest = std::max(streamSlowest.load(), (uint32_t)(micros() - start));
+        }
+        else streamFailures++;
+        break;
+      }
+    }
+    streamBusy = false;
+    endTaskIteration(TIMING_STREAM);
+    rate.wait();
+  }
+}
@@ -0,0 +1,250 @@
+/**
+ * Tuning panel functions:
+ * - Panel construction (sliders, step buttons, action buttons, error chart)
+ * - Control actions (LVGL task): the slider positions, picked up by the routine
+ * - "Tune" routine: applies the changes, runs the test move and plots its tracking error
+ */
+#include "main.h"
+#include "display/lvgl.h"
+/**
+ * A slider of the panel
+ * name: text of its label
+ * min, max: range of the value
+ * step: value of one slider position (and of one press of its +/- buttons)
+ */
+struct TuningSlider{
+  const char *name;
+  double min, max, step;
+};
+/** the sliders, indexed by TuningControl */
+const TuningSlider tuningSliders[TUNING_CONTROLS] = {
+  {"kP", 0, 3, 0.01},
+  {"kD", 0, 20, 0.1},
+  {"ramp", 1, 127, 1},
+  {"cap", 20, 127, 1}
+};
+/** requests of the action buttons to the routine */
+enum TuningRequest{
+  TUNING_NONE,
+  TUNING_RUN,
+  TUNING_AUTO,
+  TUNING_SAVE
+};
+/** the panel screen and its objects (NULL until buildTuningPanel) */
+lv_obj_t *tuningScreen = NULL, *tuningChart = NULL, *tuningStatus = NULL;
+lv_obj_t *tuningSliderObjs[TUNING_CONTROLS], *tuningLabels[TUNING_CONTROLS];
+lv_chart_series_t *tuningSeries[2];
+/** text of the labels (static, refer to dashboard.cpp) */
+char tuningLabelText[TUNING_CONTROLS][16], tuningStatusText[64];
+/** slider positions: set by the LVGL task, applied by the routine (appliedSteps) */
+std::atomic<int> tuningSteps[TUNING_CONTROLS];
+int appliedSteps[TUNING_CONTROLS];
+std::atomic<int> tuningRequest(TUNING_NONE);
+/**
+ * Record a slider position and show its value.
+ * @param control
+ * the slider (TuningControl)
+ *
+ * @param step
+ * its position
+ */
+void showTuningStep(int control, int step){
+  tuningSteps[control] = step;
+  snprintf(tuningLabelText[control], sizeof(tuningLabelText[control]), "%s %.2f", tuningSliders[control].name,
+    step*tuningSliders[control].step);
+  lv_label_set_static_text(tuningLabels[control], tuningLabelText[control]);
+}
+/**
+ * Slider action (LVGL task): record the new position.
+ */
+lv_res_t moveTuningSlider(lv_obj_t *slider){
+  showTuningStep(lv_obj_get_free_num(slider), lv_slider_get_value(slider));
+  return LV_RES_OK;
+}
+/**
+ * Step button action (LVGL task): move the slider by one position.
+ * The button's free number is the control times 2, plus 1 for the + button.
+ */
+lv_res_t stepTuningSlider(lv_obj_t *button){
+  uint32_t number = lv_obj_get_free_num(button);
+  int control = number/2;
+  /** the slider keeps the position within its range */
+  lv_slider_set_value(tuningSliderObjs[control], tuningSteps[control] + (number%2? 1 : -1));
+  showTuningStep(control, lv_slider_get_value(tuningSliderObjs[control]));
+  return LV_RES_OK;
+}
+/**
+ * Action button action (LVGL task): pass the request (the button's free number) to the routine.
+ */
+lv_res_t requestTuning(lv_obj_t *button){
+  tuningRequest = lv_obj_get_free_num(button);
+  return LV_RES_OK;
+}
+/**
+ * Create a button with a text.
+ * @param x, y, width
+ * position and width in pixels (the buttons are 36 pixels high, large enough for a finger)
+ *
+ * @param number
+ * free number read by the action
+ *
+ * @return
+ * the button
+ */
+lv_obj_t *createTuningButton(const char *text, lv_coord_t x, lv_coord_t y, lv_coord_t width, uint32_t number, lv_action_t action){
+  lv_obj_t *button = lv_btn_create(tuningScreen, NULL);
+  lv_obj_set_pos(button, x, y);
+  lv_obj_set_size(button, width, 36);
+  lv_obj_set_free_num(button, number);
+  lv_btn_set_action(button, LV_BTN_ACTION_CLICK, action);
+  lv_label_set_static_text(lv_label_create(button, NULL), text);
+  return button;
+}
+/**
+ * Create the panel screen: a row per slider and the action buttons on the left, the error chart
+ * and the result of the last test on the right. Run by buildDisplay (refer to dashboard.cpp).
+ */
+void buildTuningPanel(){
+  tuningScreen = lv_obj_create(NULL, NULL);
+  for(int i = 0; i < TUNING_CONTROLS; i++){
+    lv_coord_t y = 2 + i*46;
+    tuningLabels[i] = lv_label_create(tuningScreen, NULL);
+    lv_obj_set_pos(tuningLabels[i], 48, y);
+    createTuningButton("-", 4, y + 6, 36, 2*i, stepTuningSlider);
+    createTuningButton("+", 188, y + 6, 36, 2*i + 1, stepTuningSlider);
+    tuningSliderObjs[i] = lv_slider_create(tuningScreen, NULL);
+    lv_obj_set_pos(tuningSliderObjs[i], 48, y + 24);
+    lv_obj_set_size(tuningSliderObjs[i], 132, 14);
+    lv_slider_set_range(tuningSliderObjs[i], (int16_t)round(tuningSliders[i].min/tuningSliders[i].step),
+      (int16_t)round(tuningSliders[i].max/tuningSliders[i].step));
+    lv_obj_set_free_num(tuningSliderObjs[i], i);
+    lv_slider_set_action(tuningSliderObjs[i], moveTuningSlider);
+  }
+  createTuningButton("Run", 4, 196, 70, TUNING_RUN, requestTuning);
+  createTuningButton("Auto", 79, 196, 70, TUNING_AUTO, requestTuning);
+  createTuningButton("Save", 154, 196, 70, TUNING_SAVE, requestTuning);
+  tuningChart = lv_chart_create(tuningScreen, NULL);
+  lv_obj_set_pos(tuningChart, 232, 4);
+  lv_obj_set_size(tuningChart, 244, 180);
+  lv_chart_set_type(tuningChart, LV_CHART_TYPE_LINE);
+  lv_chart_set_point_count(tuningChart, TUNING_CHART_POINTS);
+  lv_chart_set_range(tuningChart, -TUNING_CHART_RANGE, TUNING_CHART_RANGE);
+  lv_chart_set_div_line_count(tuningChart, 3, 0);
+  tuningSeries[0] = lv_chart_add_series(tuningChart, LV_COLOR_BLUE);
+  tuningSeries[1] = lv_chart_add_series(tuningChart, LV_COLOR_RED);
+  tuningStatus = lv_label_create(tuningScreen, NULL);
+  lv_obj_set_pos(tuningStatus, 232, 190);
+  lv_label_set_static_text(tuningStatus, tuningStatusText);
+}
+/**
+ * @return
+ * whether the panel is on the brain screen (the dashboard leaves it there when the phase changes)
+ */
+bool isTuningPanelShown(){
+  return tuningScreen != NULL && lv_scr_act() == tuningScreen;
+}
+/**
+ * Show a line of text under the chart.
+ */
+void setTuningStatus(const char *text){
+  snprintf(tuningStatusText, sizeof(tuningStatusText), "%s", text);
+  lv_label_set_static_text(tuningStatus, tuningStatusText);
+}
+/**
+ * Put the sliders at the current gains of the test move's band and the current parameters.
+ */
+void loadTuningControls(){
+  /** the band holds the gains before the battery compensation (refer to autotuneBase) */
+  GainBand band = getScheduledGains(false, TUNING_MOVE_SIZE);
+  double scale = getBatteryGainScale();
+  const ParamTable *params = getParams();
+  double values[TUNING_CONTROLS] = {band.kp/scale, band.kd/scale, params->values[PARAM_RAMPING_POW], params->values[PARAM_MAX_POW]};
+  for(int i = 0; i < TUNING_CONTROLS; i++){
+    const TuningSlider &slider = tuningSliders[i];
+    int step = (int)round(fmax(slider.min, fmin(slider.max, values[i]))/slider.step);
+    lv_slider_set_value(tuningSliderObjs[i], step);
+    showTuningStep(i, step);
+    /** a value between two positions is kept until its slider is moved */
+    appliedSteps[i] = step;
+  }
+}
+/**
+ * Apply the sliders moved since the last call.
+ */
+void applyTuningControls(){
+  for(int i = 0; i < TUNING_CONTROLS; i++){
+    int step = tuningSteps[i];
+    if(step == appliedSteps[i]) continue;
+    appliedSteps[i] = step;
+    double value = step*tuningSliders[i].step;
+    if(i == TUNING_RAMP) setParam(PARAM_RAMPING_POW, value);
+    else if(i == TUNING_CAP) setParam(PARAM_MAX_POW, value);
+    else{
+      GainBand band = getScheduledGains(false, TUNING_MOVE_SIZE);
+      double scale = getBatteryGainScale();
+      setGainBand(false, TUNING_MOVE_SIZE, i == TUNING_KP? value : band.kp/scale, i == TUNING_KD? value : band.kd/scale);
+    }
+  }
+}
+/**
+ * Add the tracking errors of both sides to the chart (it scrolls once full).
+ * @param left, right
+ * errors in inches
+ */
+void plotTuningError(double left, double right){
+  double errors[2] = {left, right};
+  for(int i = 0; i < 2; i++){
+    lv_coord_t point = (lv_coord_t)round(fmax(-TUNING_CHART_RANGE, fmin(TUNING_CHART_RANGE, errors[i]*10)));
+    lv_chart_set_next(tuningChart, tuningSeries[i], point);
+  }
+}
+/**
+ * Run the test move out and back, plotting the tracking error, and show the time of each leg
+ * and the largest error. A leg that does not settle within TUNING_TIMEOUT shows its timeout.
+ */
+void runTuningTest(){
+  setTuningStatus("Running...");
+  for(lv_chart_series_t *series : tuningSeries) lv_chart_init_points(tuningChart, series, 0);
+  double legTime[2], maxError = 0;
+  for(int leg = 0; leg < 2; leg++){
+    baseMove(leg == 0? TUNING_MOVE_SIZE : -TUNING_MOVE_SIZE);
+    Timer timer;
+    while(!isBaseSettled() && !timer.passed(TUNING_TIMEOUT)){
+      delay(TUNING_SAMPLE_DT);
+      double errorL, errorR;
+      getBaseTrackingError(errorL, errorR);
+      plotTuningError(errorL*inPerDeg, errorR*inPerDeg);
+      maxError = fmax(maxError, fmax(fabs(errorL), fabs(errorR))*inPerDeg);
+    }
+    legTime[leg] = isBaseSettled()? timer.elapsed()/1000.0 : TUNING_TIMEOUT/1000.0;
+  }
+  char text[sizeof(tuningStatusText)];
+  snprintf(text, sizeof(text), "out %.2f s  back %.2f s\nmax error %.2f in", legTime[0], legTime[1], maxError);
+  setTuningStatus(text);
+}
+/**
+ * "Tune" routine: show the panel and serve its buttons until the autonomous period ends.
+ * "Run" runs the test move with the sliders' values, "Auto" runs the autotuner (refer to autotuneBase)
+ * and moves the sliders to its gains, "Save" saves the gain schedule and the parameters to the microSD card.
+ */
+void tuningPanel(){
+  waitBootReady(BOOT_UI);
+  loadTuningControls();
+  char text[sizeof(tuningStatusText)];
+  snprintf(text, sizeof(text), "Run: %g in out and back", (double)TUNING_MOVE_SIZE);
+  setTuningStatus(text);
+  lv_scr_load(tuningScreen);
+  while(true){
+    applyTuningControls();
+    int request = tuningRequest.exchange(TUNING_NONE);
+    if(request == TUNING_RUN) runTuningTest();
+    else if(request == TUNING_AUTO){
+      setTuningStatus("Autotuning...");
+      autotuneBase();
+      loadTuningControls();
+      setTuningStatus("Autotuned and saved");
+    }
+    else if(request == TUNING_SAVE) setTuningStatus(saveGainSchedule() && saveParams()? "Saved" : "Cannot save (microSD card?)");
+    delay(TUNING_SAMPLE_DT);
+  }
+}
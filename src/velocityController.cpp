@@ -0,0 +1,106 @@
+/**
+ * VelocityController functions:
+ * - Target setting
+ * - Velocity estimation (position difference, averaged)
+ * - PD + feedforward step and at speed detection
+ */
+#include "main.h"
+/**
+ * Initialization of a VelocityController (target 0).
+ * @param ticksPerRev
+ * position units per revolution of the output (e.g. 360 for a motor in degrees)
+ *
+ * @param kP
+ * power per rpm of error
+ *
+ * @param kD
+ * power per rpm/s of error change
+ *
+ * @param kV
+ * feedforward power per rpm of target (about VELOCITY_MAX_POW / free speed)
+ *
+ * @param ready
+ * the band the error must stay in to be at speed (error in rpm, derivative in rpm/s)
+ */
+VelocityController::VelocityController(double ticksPerRev, double kP, double kD, double kV, const SettleRule &ready)
+  : ticksPerRev(ticksPerRev), kP(kP), kD(kD), kV(kV), target(0){
+  this->ready.setRule(ready);
+  reset();
+}
+/**
+ * Change the target. A new target restarts the at speed detection.
+ * @param rpm
+ * target velocity (0: output 0, so the motor coasts)
+ */
+void VelocityController::setTarget(double rpm){
+  if(rpm == target) return;
+  target = rpm;
+  atSpeed = false;
+  ready.reset();
+}
+/**
+ * @return
+ * target velocity in rpm
+ */
+double VelocityController::getTarget(){
+  return target;
+}
+/**
+ * Estimate the velocity from a new position and compute the output.
+ * @param position
+ * position of the motor (ticksPerRev units)
+ *
+ * @param now
+ * time of the reading (micros)
+ *
+ * @return
+ * power to apply (-VELOCITY_MAX_POW to VELOCITY_MAX_POW)
+ */
+double VelocityController::step(double position, uint64_t now){
+  if(hasPrev && now <= prevTime) return output;
+  if(hasPrev){
+    velocity = speedFilter.filter((position - prevPosition)/ticksPerRev*60000000.0/(now - prevTime));
+  }
+  double error = target - velocity;
+  double derivative = hasPrev ? (error - prevError)*1000000.0/(now - prevTime) : 0;
+  prevPosition = position;
+  prevTime = now;
+  prevError = error;
+  bool estimated = hasPrev;
+  hasPrev = true;
+  if(target == 0){
+    atSpeed = false;
+    return output = 0;
+  }
+  output = kV*target + kP*error + kD*derivative;
+  if(output > VELOCITY_MAX_POW) output = VELOCITY_MAX_POW;
+  if(output < -VELOCITY_MAX_POW) output = -VELOCITY_MAX_POW;
+  atSpeed = estimated && ready.isSettled(error, now);
+  return output;
+}
+/**
+ * @return
+ * estimated velocity in rpm
+ */
+double VelocityController::getVelocity(){
+  return velocity;
+}
+/**
+ * @return
+ * true if the velocity has been within the ready rule of a non-zero target
+ */
+bool VelocityController::isAtSpeed(){
+  return atSpeed;
+}
+/**
+ * Forget the previous samples (e.g. after the motor was driven open loop).
+ */
+void VelocityController::reset(){
+  speedFilter.reset();
+  prevPosition = 0;
+  prevTime = 0;
+  hasPrev = false;
+  velocity = prevError = output = 0;
+  atSpeed = false;
+  ready.reset();
+}
@@ -0,0 +1,259 @@
+/**
+ * Vision service:
+ * - Service task reading the signature objects every VISION_DT
+ * - Object filter (size, shape, track continuity) and target geometry from the pixels
+ * - Latency compensation with the pose history
+ * - Odometry correction against the landmarks of the field map
+ * - Closed-loop alignment of the base on a target
+ */
+#include "main.h"
+/** signature and real width of each target */
+const uint8_t visionSignatures[VISION_TARGETS] = {VISION_GOAL_SIG, VISION_BALL_SIG};
+const double visionWidths[VISION_TARGETS] = {VISION_GOAL_WIDTH, VISION_BALL_WIDTH};
+/** field map: the goals (refer to fieldObstacles in pathPlanner.cpp) */
+const VisionLandmark visionLandmarks[VISION_LANDMARKS] = {
+  {VISION_GOAL, 6, 6}, {VISION_GOAL, 6, 72}, {VISION_GOAL, 6, 138},
+  {VISION_GOAL, 72, 6}, {VISION_GOAL, 72, 72}, {VISION_GOAL, 72, 138},
+  {VISION_GOAL, 138, 6}, {VISION_GOAL, 138, 72}, {VISION_GOAL, 138, 138}
+};
+/** captures before this time (micros) predate the last correction being applied to the pose history */
+uint64_t correctionHold = 0;
+/** latest target of each type (written only by the service task) */
+SeqLock<VisionTarget> visionTargets[VISION_TARGETS];
+/** object buffer of the service task */
+vision_object_s_t visionObjects[VISION_MAX_OBJECTS];
+/**
+ * Latest target of a type.
+ * @param type
+ * which target
+ *
+ * @param target
+ * set to the target
+ *
+ * @param version (optional)
+ * set to the number of frames the target was published in (changes with every new frame)
+ *
+ * @return
+ * false if the target has not been seen for VISION_TARGET_TIMEOUT
+ */
+bool getVisionTarget(VisionTargetType type, VisionTarget &target, uint32_t *version){
+  target = visionTargets[type].read(version);
+  return target.timestamp > 0 && micros() - target.timestamp < VISION_TARGET_TIMEOUT*1000ull;
+}
+/**
+ * Bearing and distance of an object seen by the camera.
+ * @param object
+ * the object
+ *
+ * @param width
+ * real width of the object in inches
+ *
+ * @param bearing
+ * set to the bearing from the camera axis in radians (positive: clockwise)
+ *
+ * @param distance
+ * set to the distance in inches
+ */
+void measureVisionObject(const vision_object_s_t &object, double width, double &bearing, double &distance){
+  const double radPerPixel = VISION_FOV_DEG*toRad/VISION_FOV_WIDTH;
+  bearing = (object.x_middle_coord - VISION_FOV_WIDTH/2.0)*radPerPixel;
+  distance = width/(2*tan(object.width*radPerPixel/2));
+}
+/**
+ * Compare an object with the field map (refer to VISION_LANDMARK_CORRECTION).
+ * @param type
+ * target type of the object
+ *
+ * @param pose
+ * pose at the capture
+ *
+ * @param bearing, distance
+ * measured bearing (radians) and distance (inches) of the object
+ *
+ * @param capture
+ * capture time of the frame (micros)
+ *
+ * @param correction
+ * the object's correction of the pose (before the bounds) is added to it; with ODOM_ESTIMATOR, the
+ * object is sent to the estimator instead (refer to observeLandmark)
+ *
+ * @return
+ * false if no landmark is within VISION_LANDMARK_GATE of the object, or the differences are outliers
+ */
+bool matchLandmark(VisionTargetType type, const PoseSnapshot &pose, double bearing, double distance, uint64_t capture,
+                   PoseSnapshot &correction){
+  double angle = pose.angle + bearing;
+  double x = pose.x + distance*sin(angle), y = pose.y + distance*cos(angle);
+  const VisionLandmark *nearest = NULL;
+  double nearestDist = VISION_LANDMARK_GATE;
+  for(int i = 0; i < VISION_LANDMARKS; i++){
+    if(visionLandmarks[i].type != type) continue;
+    double dist = hypot(visionLandmarks[i].x - VISION_ORIGIN_X - x, visionLandmarks[i].y - VISION_ORIGIN_Y - y);
+    if(dist <= nearestDist){
+      nearest = &visionLandmarks[i];
+      nearestDist = dist;
+    }
+  }
+  if(nearest == NULL) return false;
+  /** expected line of sight to the landmark, and the differences to the observed one */
+  double dx = nearest->x - VISION_ORIGIN_X - pose.x, dy = nearest->y - VISION_ORIGIN_Y - pose.y;
+  double direction = atan2(dx, dy), expected = hypot(dx, dy);
+  double bearingError = angleDiff(direction - pose.angle, bearing);
+  double distanceError = expected - distance;
+  if(fabs(bearingError)*toDeg > VISION_LANDMARK_MAX_BEARING || fabs(distanceError) > VISION_LANDMARK_MAX_RANGE*expected) return false;
+#if ODOM_ESTIMATOR
+  LandmarkObservation observation = {nearest->x - VISION_ORIGIN_X, nearest->y - VISION_ORIGIN_Y, bearing, distance, capture};
+  return observeLandmark(observation);
+#else
+  /** the robot is closer to the landmark than the odometry: move along the line of sight */
+  double shift = VISION_CORRECTION_RANGE_GAIN*distanceError;
+  correction.x += shift*sin(direction);
+  correction.y += shift*cos(direction);
+#if ODOM_USE_IMU
+  /** the heading is right: move across the line of sight (to the right for a positive difference) */
+  double lateral = VISION_CORRECTION_ANGLE_GAIN*bearingError*expected;
+  correction.x += lateral*cos(direction);
+  correction.y -= lateral*sin(direction);
+#else
+  correction.angle += VISION_CORRECTION_ANGLE_GAIN*bearingError;
+#endif
+  return true;
+#endif
+}
+/**
+ * Average the corrections of the matched objects of a frame, bound it and send it to the odometry task
+ * (with ODOM_ESTIMATOR, the objects are already queued: only hold the next frames).
+ * @param correction
+ * sum of the objects' corrections
+ *
+ * @param matches
+ * number of objects in the sum
+ *
+ * @param capture
+ * capture time of the frame (micros)
+ */
+void requestLandmarkCorrection(PoseSnapshot correction, int matches, uint64_t capture){
+#if !ODOM_ESTIMATOR
+  const double maxAngle = VISION_CORRECTION_MAX_ANGLE*toRad;
+  double angle = fmin(fmax(correction.angle/matches, -maxAngle), maxAngle);
+  double x = correction.x/matches, y = correction.y/matches;
+  double shift = hypot(x, y);
+  if(shift > VISION_CORRECTION_MAX_SHIFT){
+    x *= VISION_CORRECTION_MAX_SHIFT/shift;
+    y *= VISION_CORRECTION_MAX_SHIFT/shift;
+  }
+  correctPose(x, y, angle, capture);
+#endif
+  /** the next frames must be captured after the odometry task applied the correction (within a tick) */
+  correctionHold = micros() + 2*ODOM_DT*1000ull;
+}
+/**
+ * Update a target from the objects of a frame: keep the plausible objects, prefer the one that
+ * continues the current track (else the largest), and place it on the field with the pose at the capture.
+ * Objects that match a landmark also correct the odometry.
+ * @param type
+ * which target
+ *
+ * @param count
+ * number of objects in visionObjects (largest first)
+ *
+ * @param capture
+ * capture time of the frame (micros)
+ */
+void updateVisionTarget(VisionTargetType type, int count, uint64_t capture){
+  PoseSnapshot pose;
+  if(!getPoseAt(capture, pose)) pose = getPose();
+  VisionTarget previous;
+  bool tracking = getVisionTarget(type, previous);
+  bool found = false, continues = false;
+  VisionTarget best = {};
+  /** landmark correction: only from frames captured after the last correction and while not turning fast */
+  bool correcting = VISION_LANDMARK_CORRECTION && capture >= correctionHold && fabs(pose.angVel)*toDeg <= VISION_CORRECTION_MAX_ANG_VEL;
+  PoseSnapshot correction = {};
+  int matches = 0;
+  for(int i = 0; i < count; i++){
+    const vision_object_s_t &object = visionObjects[i];
+    if(object.width <= 0 || object.height <= 0 || object.width*object.height < VISION_MIN_AREA) continue;
+    if(object.width > VISION_MAX_ASPECT*object.height || object.height > VISION_MAX_ASPECT*object.width) continue;
+    double bearing, distance;
+    measureVisionObject(object, visionWidths[type], bearing, distance);
+    if(correcting && matchLandmark(type, pose, bearing, distance, capture, correction)) matches++;
+    double angle = pose.angle + bearing;
+    VisionTarget candidate = {capture, (float)bearing, (float)distance,
+      (float)(pose.x + distance*sin(angle)), (float)(pose.y + distance*cos(angle))};
+    bool near = tracking && hypot(candidate.x - previous.x, candidate.y - previous.y) <= VISION_TRACK_GATE;
+    /** objects are largest first: keep the first one, unless a later one continues the track */
+    if(!found || (near && !continues)){
+      best = candidate;
+      found = true;
+      continues = near;
+    }
+  }
+  if(matches > 0) requestLandmarkCorrection(correction, matches, capture);
+  if(!found) return;
+  if(continues){
+    best.x = previous.x + VISION_SMOOTHING*(best.x - previous.x);
+    best.y = previous.y + VISION_SMOOTHING*(best.y - previous.y);
+  }
+  visionTargets[type].write(best);
+}
+/**
+ * Turn the base to a target and keep re-aiming while the target's field point moves
+ * (e.g. a ball rolling), until the base settles within VISION_ALIGN_TOLERANCE of it.
+ * @param type
+ * which target
+ *
+ * @param timeout
+ * give up after this many ms
+ *
+ * @return
+ * false if the target was not seen, or the base did not settle in time
+ */
+bool baseAlignVision(VisionTargetType type, uint32_t timeout){
+  Timer timer;
+  uint32_t version, aimedVersion = 0;
+  bool aimed = false;
+  double aimX = 0, aimY = 0;
+  while(!timer.passed(timeout)){
+    VisionTarget target;
+    if(getVisionTarget(type, target, &version) && version != aimedVersion){
+      aimedVersion = version;
+      PoseSnapshot pose = getPose();
+      double moved = angleDiff(atan2(target.x - pose.x, target.y - pose.y), atan2(aimX - pose.x, aimY - pose.y));
+      if(!aimed || fabs(moved)*toDeg > VISION_REAIM_ANGLE){
+        aimX = target.x;
+        aimY = target.y;
+        baseTurn(aimX, aimY, GAIN_SCHEDULED, GAIN_SCHEDULED, false);
+        aimed = true;
+      }
+    }
+    if(aimed && isBaseSettled()){
+      /** settled off the target (the turn's own error): correct with another turn */
+      PoseSnapshot pose = getPose();
+      double error = angleDiff(atan2(aimX - pose.x, aimY - pose.y), pose.angle);
+      if(fabs(error)*toDeg <= VISION_ALIGN_TOLERANCE) return true;
+      baseTurn(aimX, aimY, GAIN_SCHEDULED, GAIN_SCHEDULED, false);
+    }
+    delay(VISION_DT);
+  }
+  return false;
+}
+/**
+ * Read the signatures every VISION_DT and publish the targets. Run at the mechanism priority
+ * (a frame only changes every 20 ms, and reading it takes a while over the smart port).
+ */
+void visionService(void * ignore){
+  LoopRate rate(VISION_DT);
+  startTaskTiming(TIMING_VISION, VISION_DT, true);
+  while(true){
+    beginTaskIteration(TIMING_VISION);
+    for(int i = 0; i < VISION_TARGETS; i++){
+      uint64_t read = micros();
+      int count = vision.read_by_sig(0, visionSignatures[i], VISION_MAX_OBJECTS, visionObjects);
+      /** PROS_ERR (no sensor) or EDOM (no object of the signature); a frame read in the first VISION_LATENCY has no capture time */
+      if(count > 0 && count <= VISION_MAX_OBJECTS && read >= VISION_LATENCY) updateVisionTarget((VisionTargetType)i, count, read - VISION_LATENCY);
+    }
+    endTaskIteration(TIMING_VISION);
+    rate.wait();
+  }
+}
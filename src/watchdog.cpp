@@ -0,0 +1,149 @@
+/**
+ * Watchdog functions and task:
+ * - Heartbeat and deadline miss checks of the watched tasks (their taskTiming statistics)
+ * - Fault log (telemetry, timeline) and report
+ * - Base failsafe: the motors are stopped at once, and the base controller aborts the movement
+ *   at its next cycle (refer to failsafeBase)
+ */
+#include "main.h"
+/**
+ * The watched tasks. The base depends on the odometry (the pose of the pose-driven movements) and on
+ * its controller (the only writer of the base motors outside BASE_MODE_DRIVER), so their faults stop it; the
+ * mechanism tasks are only logged. A few misses are tolerated, as a busy brain can delay an iteration.
+ */
+const WatchdogRule watchdogRules[] = {
+  {ROBOT_ODOMETRY, TIMING_ODOMETRY, 5, WATCHDOG_STOP_BASE},
+  {ROBOT_CONTROL, TIMING_CONTROL, 5, WATCHDOG_STOP_BASE},
+  {ROBOT_SHOOTER, TIMING_SHOOTER, 10, WATCHDOG_LOG},
+  {ROBOT_VISION, TIMING_VISION, 5, WATCHDOG_LOG}
+};
+#define WATCHDOG_RULES (int)(sizeof(watchdogRules)/sizeof(*watchdogRules))
+/**
+ * Watch state of a task (watchdog task only)
+ * active: the task ran in the phase at the previous check
+ * iterations, beatTime: its iteration count and when it last changed (micros; pushed past the
+ * activation by WATCHDOG_GRACE)
+ * windowMisses, windowStart: its deadline misses at the start of the current WATCHDOG_WINDOW and its start (micros)
+ * fault: fault reported and not cleared yet (a task is reported once per fault)
+ */
+struct WatchState{
+  bool active;
+  uint32_t iterations;
+  uint64_t beatTime;
+  uint32_t windowMisses;
+  uint64_t windowStart;
+  WatchdogFault fault;
+};
+/** base failsafes so far (the base controller aborts its movement when it changes) */
+std::atomic<uint32_t> baseFailsafes(0);
+/** last fault and the number of faults so far */
+SeqLock<WatchdogReport> watchdogReport(WatchdogReport{ROBOT_TASKS, WATCHDOG_OK, 0, 0, false, 0});
+std::atomic<uint32_t> watchdogFaults(0);
+/**
+ * @return
+ * number of base failsafes so far (a change tells the base controller to abort its movement)
+ */
+uint32_t getBaseFailsafeCount(){
+  return baseFailsafes.load(std::memory_order_acquire);
+}
+/**
+ * Retrieve the last fault.
+ * @param count (optional)
+ * set to the number of faults so far (a new fault changes it)
+ *
+ * @return
+ * the last fault (task ROBOT_TASKS if there was none)
+ */
+WatchdogReport getWatchdogReport(uint32_t *count){
+  if(count != NULL) *count = watchdogFaults.load();
+  return watchdogReport.read();
+}
+/**
+ * Check a watched task.
+ * @param rule
+ * its rule
+ *
+ * @param state
+ * its watch state; updated
+ *
+ * @param now
+ * time of the check (micros)
+ *
+ * @param silent
+ * set to the time since its last iteration (micros)
+ *
+ * @param misses
+ * set to its deadline misses within the current window
+ *
+ * @return
+ * its fault (WATCHDOG_OK while parked)
+ */
+WatchdogFault checkWatchedTask(const WatchdogRule &rule, WatchState &state, uint64_t now, uint64_t &silent, uint32_t &misses){
+  TaskHeartbeat beat = getTaskHeartbeat(rule.timing);
+  bool active = isTaskActive(rule.task);
+  /** a task starts its watch when it becomes active (a parked task does not iterate) */
+  if(active && !state.active){
+    state.beatTime = now + WATCHDOG_GRACE*1000ull;
+    state.windowStart = now;
+    state.windowMisses = beat.misses;
+  }
+  state.active = active;
+  if(beat.iterations != state.iterations && now > state.beatTime) state.beatTime = now;
+  state.iterations = beat.iterations;
+  if(now - state.windowStart >= WATCHDOG_WINDOW*1000ull){
+    state.windowStart = now;
+    state.windowMisses = beat.misses;
+  }
+  silent = now > state.beatTime? now - state.beatTime : 0;
+  misses = beat.misses - state.windowMisses;
+  if(!active) return WATCHDOG_OK;
+  if(silent > (uint64_t)rule.misses*beat.period) return WATCHDOG_SILENT;
+  if(misses >= rule.misses) return WATCHDOG_LATE;
+  return WATCHDOG_OK;
+}
+/**
+ * Act on a new fault: log it, and stop the base if the rule says so and the base controller drives it.
+ * @param rule
+ * rule of the task
+ *
+ * @param fault
+ * its fault
+ *
+ * @param silent, misses
+ * refer to checkWatchedTask
+ *
+ * @param now
+ * time of the fault (micros)
+ */
+void reportWatchdogFault(const WatchdogRule &rule, WatchdogFault fault, uint64_t silent, uint32_t misses, uint64_t now){
+  bool stop = rule.action == WATCHDOG_STOP_BASE && isTaskActive(ROBOT_CONTROL) && getBaseControlMode() != BASE_MODE_DRIVER;
+  if(stop){
+    /** the motors stop now, even if the controller never runs again */
+    drivetrain.stop();
+    baseFailsafes.fetch_add(1, std::memory_order_release);
+  }
+  watchdogReport.write({rule.task, fault, (uint32_t)(silent/1000), misses, stop, now});
+  watchdogFaults++;
+  pushTelemetry(TELEMETRY_WATCHDOG, rule.timing, fault, silent/1000, misses, stop);
+  recordTimeline(TIMELINE_WATCHDOG, rule.timing, fault);
+}
+/** Check the watched tasks every WATCHDOG_DT (refer to WATCHDOG_ENABLED). */
+void watchdog(void * ignore){
+  WatchState states[WATCHDOG_RULES] = {};
+  LoopRate rate(WATCHDOG_DT);
+  startTaskTiming(TIMING_WATCHDOG, WATCHDOG_DT, true);
+  while(true){
+    beginTaskIteration(TIMING_WATCHDOG);
+    uint64_t now = micros();
+    for(int i = 0; WATCHDOG_ENABLED && i < WATCHDOG_RULES; i++){
+      uint64_t silent;
+      uint32_t misses;
+      WatchdogFault fault = checkWatchedTask(watchdogRules[i], states[i], now, silent, misses);
+      /** a fault is reported when it starts; the task is watched again once it recovers */
+      if(fault != WATCHDOG_OK && states[i].fault == WATCHDOG_OK) reportWatchdogFault(watchdogRules[i], fault, silent, misses, now);
+      states[i].fault = fault;
+    }
+    endTaskIteration(TIMING_WATCHDOG);
+    rate.wait();
+  }
+}